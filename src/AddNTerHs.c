@@ -3,8 +3,8 @@
 
    \file       AddNTerHs.c
    
-   \version    V1.8
-   \date       07.07.14
+   \version    V1.10
+   \date       16.10.26
    \brief      Routines to add N-terminal hydrogens and C-terminal
                oxygens.
    
@@ -65,6 +65,10 @@
 -  V1.6  03.06.05 Handles altpos
 -  V1.7  04.02.14 Use CHAINMATCH By: CTP
 -  V1.8  07.07.14 Use bl prefix for functions By: CTP
+-  V1.9  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
+-  V1.10 16.10.26 Sets the residue and atom codes of the records it
+                  names
 
 *************************************************************************/
 /* Doxygen
@@ -170,13 +174,13 @@ static PDB *KillNTerH(PDB *pdb)
          if(prev==NULL)         /* Is the first item in the list        */
          {
             prev = p->next;
-            free(p);
+            blFreePDBNode(p);
             return(prev);
          }
          else                   /* Is NOT the first item in the list    */
          {
             prev->next = p->next;
-            free(p);
+            blFreePDBNode(p);
             return(pdb);
          }
       }
@@ -216,9 +220,9 @@ static int doAddGromosNTer(PDB **ppdb, PDB *nter)
    if(blCalcTetraHCoords(nter, coor))
    {
       /* Initialise some space to store the 3 extra hydrogens           */
-      INIT(H1, PDB);
-      INIT(H2, PDB);
-      INIT(H3, PDB);
+      INITPDB(H1);
+      INITPDB(H2);
+      INITPDB(H3);
       if(H1==NULL || H2==NULL || H3==NULL) return(0);
       
       /* Initialise the hydrogens with the res info, etc.               */
@@ -239,6 +243,7 @@ static int doAddGromosNTer(PDB **ppdb, PDB *nter)
       H1->z = coor[0].z;
       strcpy(H1->atnam, "H1  ");
       strcpy(H1->atnam_raw, " H1 ");
+      H1->atcode = (short)blGetAtomCode(H1->atnam);
       H1->altpos = ' ';                   /* 03.06.05                   */
       
       H2->x = coor[1].x;
@@ -246,6 +251,7 @@ static int doAddGromosNTer(PDB **ppdb, PDB *nter)
       H2->z = coor[1].z;
       strcpy(H2->atnam, "H2  ");
       strcpy(H2->atnam_raw, " H2 ");
+      H2->atcode = (short)blGetAtomCode(H2->atnam);
       H2->altpos = ' ';                   /* 03.06.05                   */
 
       H3->x = coor[2].x;
@@ -253,6 +259,7 @@ static int doAddGromosNTer(PDB **ppdb, PDB *nter)
       H3->z = coor[2].z;
       strcpy(H3->atnam, "H3  ");
       strcpy(H3->atnam_raw, " H3 ");
+      H3->atcode = (short)blGetAtomCode(H3->atnam);
       H3->altpos = ' ';                   /* 03.06.05                   */
 
       /* Correctly link the new start into the whole linked list        */
@@ -298,9 +305,9 @@ static int doAddCharmmNTer(PDB **ppdb, PDB *nter)
    if(blCalcTetraHCoords(nter, coor))
    {
       /* Initialise some space to store the 3 extra hydrogens           */
-      INIT(H1, PDB);
-      INIT(H2, PDB);
-      INIT(H3, PDB);
+      INITPDB(H1);
+      INITPDB(H2);
+      INITPDB(H3);
       if(H1==NULL || H2==NULL || H3==NULL) return(0);
       
       /* Initialise the hydrogens with the res info, etc.               */
@@ -327,10 +334,14 @@ static int doAddCharmmNTer(PDB **ppdb, PDB *nter)
       strcpy(H2->chain,       nter->chain);
       strcpy(H2->insert,      " ");
       H2->altpos = ' ';                   /* 03.06.05                   */
+      H1->rescode = H2->rescode = (short)blGetResCode("NTER");
+      H1->atcode  = (short)blGetAtomCode(H1->atnam);
+      H2->atcode  = (short)blGetAtomCode(H2->atnam);
 
       blCopyPDB(H3, nter);
       strcpy(H3->atnam,  "HT3 ");
       strcpy(H3->atnam_raw,   " HT3");
+      H3->atcode = (short)blGetAtomCode(H3->atnam);
       H3->bval   = 20.0;
       H3->altpos = ' ';                   /* 03.06.05                   */
 
@@ -356,6 +367,7 @@ static int doAddCharmmNTer(PDB **ppdb, PDB *nter)
       /* Change the name of the Nter nitrogen                           */
       strcpy(nter->atnam, "NT  ");
       strcpy(nter->atnam_raw, " NT ");
+      nter->atcode = (short)blGetAtomCode(nter->atnam);
 
       /* Correctly link the new start into the whole linked list        */
       if(prev != NULL)
@@ -0,0 +1,693 @@
+/************************************************************************/
+/**
+
+   \file       AlignProfile.c
+   
+   \version    V1.1
+   \date       16.10.26
+   \brief      Query profiles and a vectorised score-only aligner
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   One-against-many alignment (e.g. ranking a sequence library against
+   a query) with blAffinealign() looks up each score with 
+   blCalcMDMScore(), which searches the MDM residue list for both
+   residues, and fills the matrix a cell at a time.
+
+   A query profile holds the score of every query position against 
+   every residue type in the loaded MDM, so a score is a single array
+   access. The profile is stored for the query reversed since 
+   blAffinealign() fills the matrix from the ends of the sequences.
+
+   blAffinealignScore() gives the same score as blAffinealign() without
+   the alignment. The column of the matrix for each residue of the 
+   second sequence is filled with SSE2 using 8 16-bit saturating lanes,
+   the query being striped across the lanes as described by Farrar 
+   (Bioinformatics 23:156-161, 2007). In this recurrence the gap 
+   running along the query only depends on the previous column, so 
+   Farrar's 'lazy F' correction loop is applied to that column. If the
+   scores get too close to the limits of 16 bits the column fill is 
+   repeated with 32-bit ints. Builds without SSE2 (or compiled with 
+   -DNOSIMD) always use the 32-bit code.
+
+   blAffinealignProfile() (in align.c) gives the full alignment using a
+   profile.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   ALIGNPROFILE *profile;
+   blReadMDM("pet91.mat");
+   profile = blBuildAlignProfile(query, strlen(query), FALSE, FALSE);
+   for(each library sequence)
+      score = blAffinealignScore(profile, seq, strlen(seq), 10, 2);
+   blFreeAlignProfile(profile);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Added blBuildAlignProfileCtx()
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling Sequence Data
+   #SUBGROUP Alignment
+   #FUNCTION  blBuildAlignProfile()
+   Builds a query profile from the loaded MDM for repeated alignments
+
+   #FUNCTION  blBuildAlignProfileCtx()
+   Builds a query profile from the MDM in an alignment context
+
+   #FUNCTION  blFreeAlignProfile()
+   Frees a query profile
+
+   #FUNCTION  blAffinealignScore()
+   Calculates the blAffinealign() score for a query profile against a 
+   sequence without the alignment using SIMD where available
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+
+#if defined(__SSE2__) && !defined(NOSIMD)
+#  define ALIGN_SSE2
+#  include <emmintrin.h>
+#endif
+
+#include "SysDefs.h"
+#include "macros.h"
+#include "seq.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define VECLANES  8                 /* 16-bit lanes in an SSE2 vector   */
+#define NEGINF32  (INT_MIN/2)       /* -infinity for the 32-bit code    */
+
+/************************************************************************/
+/* Prototypes
+*/
+static int  ScoreScalar(ALIGNPROFILE *profile, char *seq2, int length2,
+                        int penalty, int penext);
+#ifdef ALIGN_SSE2
+static BOOL BuildStripedProfile(ALIGNPROFILE *profile);
+static BOOL ScoreSSE2(ALIGNPROFILE *profile, char *seq2, int length2,
+                      int penalty, int penext, int *score);
+static __m128i ShiftLanes(__m128i x);
+#endif
+
+
+/************************************************************************/
+/*>ALIGNPROFILE *blBuildAlignProfileCtx(ALIGNCONTEXT *ctx, char *seq,
+                                        int length, BOOL identity, 
+                                        BOOL upcase)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *ctx       Alignment context for the MDM (NULL for the
+                             default)
+   \param[in]     *seq       Query sequence
+   \param[in]     length     Query length
+   \param[in]     identity   Use identity scores rather than the MDM
+   \param[in]     upcase     Upcase residues before using the MDM (as 
+                             blAffinealignuc())
+   \return                   Query profile (NULL if out of memory)
+
+   Builds a query profile. Unless identity is set, the MDM must have
+   been read with blReadMDMCtx() and the profile must be rebuilt if the 
+   MDM is changed. The sequence is not copied and must not be freed or
+   changed while the profile is in use.
+
+   Residues which are not in the MDM score 0 as they do with 
+   blCalcMDMScore() but no warnings are printed.
+
+-  16.10.26 Original
+-  16.10.26 Takes an alignment context. Was blBuildAlignProfile()
+*/
+ALIGNPROFILE *blBuildAlignProfileCtx(ALIGNCONTEXT *ctx, char *seq, 
+                                     int length, BOOL identity, 
+                                     BOOL upcase)
+{
+   ALIGNPROFILE *profile;
+   char         *residues = NULL;
+   int          nres      = 0,
+                qrow[256],
+                c, i, p, r, s;
+
+   if(length < 1)
+      return(NULL);
+   
+   if((profile = (ALIGNPROFILE *)malloc(sizeof(ALIGNPROFILE)))==NULL)
+      return(NULL);
+   profile->seq        = seq;
+   profile->length     = length;
+   profile->identity   = identity;
+   profile->upcase     = upcase;
+   profile->score      = NULL;
+   profile->striped    = NULL;
+   profile->stripedMem = NULL;
+   profile->maxScore   = 0;
+   profile->segLen     = 0;
+
+   /* Assign a row to each residue type. The last row is for residues
+      which always score 0
+   */
+   for(c=0; c<256; c++)
+      qrow[c] = -1;
+   profile->nrows = 0;
+   if(identity)
+   {
+      /* A row for each residue that occurs in the query                */
+      for(i=0; i<length; i++)
+      {
+         c = (unsigned char)seq[i];
+         if(qrow[c] < 0)
+            qrow[c] = profile->nrows++;
+      }
+   }
+   else
+   {
+      residues = blGetMDMResiduesCtx(ctx, &nres);
+      for(r=0; r<nres; r++)
+      {
+         c = (unsigned char)residues[r];
+         if(qrow[c] < 0)
+            qrow[c] = r;
+      }
+      profile->nrows = nres;
+   }
+   for(c=0; c<256; c++)
+   {
+      r = qrow[c];
+      if(upcase && !identity && islower(c))
+         r = qrow[toupper(c)];
+      profile->row[c] = (r < 0) ? profile->nrows : r;
+   }
+   profile->nrows++;
+
+   if((profile->score = (int *)malloc(profile->nrows * length * 
+                                      sizeof(int)))==NULL)
+   {
+      blFreeAlignProfile(profile);
+      return(NULL);
+   }
+
+   /* Fill in the scores for the reversed query                         */
+   for(r=0; r<profile->nrows; r++)
+   {
+      for(p=0; p<length; p++)
+      {
+         c = (unsigned char)seq[length-1-p];
+         s = 0;
+         if(identity)
+         {
+            s = (profile->row[c] == r) ? 1 : 0;
+         }
+         else if((r < nres) && (profile->row[c] < nres))
+         {
+            s = upcase ? blCalcMDMScoreUCCtx(ctx, (char)c, residues[r]) 
+                       : blCalcMDMScoreCtx(ctx, (char)c, residues[r]);
+         }
+         profile->score[r*length + p] = s;
+         profile->maxScore = MAX(profile->maxScore, ABS(s));
+      }
+   }
+
+#ifdef ALIGN_SSE2
+   if(!BuildStripedProfile(profile))
+   {
+      blFreeAlignProfile(profile);
+      return(NULL);
+   }
+#endif
+   
+   return(profile);
+}
+
+
+/************************************************************************/
+/*>ALIGNPROFILE *blBuildAlignProfile(char *seq, int length, 
+                                     BOOL identity, BOOL upcase)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]     *seq       Query sequence
+   \param[in]     length     Query length
+   \param[in]     identity   Use identity scores rather than the MDM
+   \param[in]     upcase     Upcase residues before using the MDM (as 
+                             blAffinealignuc())
+   \return                   Query profile (NULL if out of memory)
+
+   As blBuildAlignProfileCtx() using the MDM read by blReadMDM()
+
+-  16.10.26 Original
+*/
+ALIGNPROFILE *blBuildAlignProfile(char *seq, int length, BOOL identity,
+                                  BOOL upcase)
+{
+   return(blBuildAlignProfileCtx(NULL, seq, length, identity, upcase));
+}
+
+
+/************************************************************************/
+/*>void blFreeAlignProfile(ALIGNPROFILE *profile)
+   ----------------------------------------------
+*//**
+
+   \param[in]     *profile   Query profile
+
+   Frees a query profile
+
+-  16.10.26 Original
+*/
+void blFreeAlignProfile(ALIGNPROFILE *profile)
+{
+   if(profile != NULL)
+   {
+      if(profile->score != NULL)
+         free(profile->score);
+      if(profile->stripedMem != NULL)
+         free(profile->stripedMem);
+      free(profile);
+   }
+}
+
+
+/************************************************************************/
+/*>int blAffinealignScore(ALIGNPROFILE *profile, char *seq2, 
+                          int length2, int penalty, int penext)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *profile   Query profile
+   \param[in]     *seq2      Second sequence
+   \param[in]     length2    Second sequence length
+   \param[in]     penalty    Gap insertion penalty value
+   \param[in]     penext     Extension penalty
+   \return                   Alignment score (0 on error)
+
+   Gives the score that blAffinealign() (or blAffinealignuc() if the 
+   profile was built with upcase set) would give for the profile's 
+   query against seq2, without the alignment. Memory use is 
+   proportional to the query length. The profile is not modified so 
+   may be shared between threads.
+
+-  16.10.26 Original
+*/
+int blAffinealignScore(ALIGNPROFILE *profile, char *seq2, int length2, 
+                       int penalty, int penext)
+{
+#ifdef ALIGN_SSE2
+   int score;
+#endif
+
+   if((profile == NULL) || (length2 < 1))
+      return(0);
+
+#ifdef ALIGN_SSE2
+   if(ScoreSSE2(profile, seq2, length2, penalty, penext, &score))
+      return(score);
+#endif
+
+   return(ScoreScalar(profile, seq2, length2, penalty, penext));
+}
+
+
+/************************************************************************/
+/*>static int ScoreScalar(ALIGNPROFILE *profile, char *seq2, 
+                          int length2, int penalty, int penext)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *profile   Query profile
+   \param[in]     *seq2      Second sequence
+   \param[in]     length2    Second sequence length
+   \param[in]     penalty    Gap insertion penalty value
+   \param[in]     penext     Extension penalty
+   \return                   Alignment score (0 if out of memory)
+
+   32-bit column fill. Working on the reversed sequences (so p is 
+   length1-1-i and q is length2-1-j in blAffinealign()) each cell is
+   the residue score plus the best of the diagonal, a gap in seq2 
+   (best of column q-1 at least two rows back) and a gap in seq1 (best 
+   of row p-1 at least two columns back). The gap bests are kept as 
+   running maxima. Next to the ends, where blAffinealign() has no cells
+   to search, the gap score is 0.
+
+-  16.10.26 Original
+*/
+static int ScoreScalar(ALIGNPROFILE *profile, char *seq2, int length2,
+                       int penalty, int penext)
+{
+   int *mem,
+       *Mpp, *Mprev, *Mcur, *Dchain, *tmp, *prof,
+       n1 = profile->length,
+       p, q,
+       dia, right, down, Rchain,
+       best;
+   
+   if((mem = (int *)malloc(4 * n1 * sizeof(int)))==NULL)
+      return(0);
+   Mpp    = mem;
+   Mprev  = Mpp   + n1;
+   Mcur   = Mprev + n1;
+   Dchain = Mcur  + n1;
+
+   /* The end of seq2 is just the residue scores                        */
+   prof = profile->score + 
+          profile->row[(unsigned char)seq2[length2-1]] * n1;
+   for(p=0; p<n1; p++)
+   {
+      Mprev[p]  = prof[p];
+      Dchain[p] = NEGINF32;
+   }
+   best = Mprev[n1-1];
+
+   for(q=1; q<length2; q++)
+   {
+      prof   = profile->score + 
+               profile->row[(unsigned char)seq2[length2-1-q]] * n1;
+      Rchain = NEGINF32;
+      
+      Mcur[0] = prof[0];
+      for(p=1; p<n1; p++)
+      {
+         dia = Mprev[p-1];
+
+         if(p >= 2)
+            Rchain = MAX(Mprev[p-2] - penalty, Rchain - penext);
+         right = (p == 1) ? 0 : Rchain;
+
+         if(q >= 2)
+            Dchain[p] = MAX(Mpp[p-1] - penalty, Dchain[p] - penext);
+         down = (q == 1) ? 0 : Dchain[p];
+
+         Mcur[p] = prof[p] + MAX(dia, MAX(right, down));
+      }
+      
+      best = MAX(best, Mcur[n1-1]);
+      
+      tmp   = Mpp;
+      Mpp   = Mprev;
+      Mprev = Mcur;
+      Mcur  = tmp;
+   }
+
+   /* The start of seq2                                                 */
+   for(p=0; p<n1; p++)
+      best = MAX(best, Mprev[p]);
+
+   free(mem);
+   return(best);
+}
+
+
+#ifdef ALIGN_SSE2
+/************************************************************************/
+/*>static BOOL BuildStripedProfile(ALIGNPROFILE *profile)
+   ------------------------------------------------------
+*//**
+
+   \param[in,out] *profile   Query profile with the scores filled in
+   \return                   Success?
+
+   Builds the 16-bit striped profile. Query position p goes in lane 
+   p/segLen of vector p%segLen, padded with zeros. There are always at
+   least 2 vectors so that p-2 is never more than one lane back.
+
+-  16.10.26 Original
+*/
+static BOOL BuildStripedProfile(ALIGNPROFILE *profile)
+{
+   int  n1 = profile->length,
+        segLen, r, v, k, p;
+   long nshort;
+   
+   segLen = MAX(2, (n1 + VECLANES - 1) / VECLANES);
+   profile->segLen = segLen;
+
+   if(profile->maxScore > SHRT_MAX / 4)
+      return(TRUE);              /* Always use the 32-bit code         */
+
+   nshort = (long)profile->nrows * segLen * VECLANES;
+   if((profile->stripedMem = (char *)malloc(nshort * sizeof(short) + 16))
+      == NULL)
+      return(FALSE);
+   profile->striped = (short *)(profile->stripedMem + 
+                      (16 - ((unsigned long)profile->stripedMem % 16)) % 16);
+
+   for(r=0; r<profile->nrows; r++)
+   {
+      for(v=0; v<segLen; v++)
+      {
+         for(k=0; k<VECLANES; k++)
+         {
+            p = v + k * segLen;
+            profile->striped[((long)r * segLen + v) * VECLANES + k] = 
+               (short)((p < n1) ? profile->score[r*n1 + p] : 0);
+         }
+      }
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static __m128i ShiftLanes(__m128i x)
+   ------------------------------------
+*//**
+
+   \param[in]     x          Vector
+   \return                   x moved up one lane with -infinity in lane 0
+
+   Gives the values one query position back for vector 0 from the last
+   vector of a striped column
+
+-  16.10.26 Original
+*/
+static __m128i ShiftLanes(__m128i x)
+{
+   return(_mm_or_si128(_mm_slli_si128(x, 2), 
+                       _mm_setr_epi16(SHRT_MIN, 0, 0, 0, 0, 0, 0, 0)));
+}
+
+
+/************************************************************************/
+/*>static BOOL ScoreSSE2(ALIGNPROFILE *profile, char *seq2, int length2,
+                         int penalty, int penext, int *score)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *profile   Query profile
+   \param[in]     *seq2      Second sequence
+   \param[in]     length2    Second sequence length
+   \param[in]     penalty    Gap insertion penalty value
+   \param[in]     penext     Extension penalty
+   \param[out]    *score     Alignment score
+   \return                   FALSE if the scores may have overflowed 16
+                             bits or out of memory
+
+   As ScoreScalar() with 8 query positions in each vector. The gap in
+   seq2 is a running maximum down the previous column, done a vector at
+   a time (so for each lane independently) and then corrected for the
+   running maximum carrying over from the previous lane.
+
+-  16.10.26 Original
+*/
+static BOOL ScoreSSE2(ALIGNPROFILE *profile, char *seq2, int length2,
+                      int penalty, int penext, int *score)
+{
+   __m128i *vmem, *Mprev, *Mcur, *dia, *diaPrev, *R, *D, *tmp, *prof,
+           vPen, vExt, vNegInf, vZero, vLane0, vMax, vMin, vRight, vDown,
+           vCarry;
+   char    *mem;
+   short   lanes[VECLANES];
+   int     n1     = profile->length,
+           segLen = profile->segLen,
+           last   = n1 - 1,
+           lastV  = (n1 - 1) % segLen,
+           lastK  = (n1 - 1) / segLen,
+           margin = profile->maxScore + ABS(penalty) + ABS(penext) + 1,
+           best, hi, lo,
+           q, v, k, pass;
+   BOOL    changed;
+
+   if((profile->striped == NULL) || (margin > SHRT_MAX / 4))
+      return(FALSE);
+   
+   if((mem = (char *)malloc(6 * segLen * sizeof(__m128i) + 16))==NULL)
+      return(FALSE);
+   vmem    = (__m128i *)(mem + (16 - ((unsigned long)mem % 16)) % 16);
+   Mprev   = vmem;
+   Mcur    = Mprev   + segLen;
+   dia     = Mcur    + segLen;
+   diaPrev = dia     + segLen;
+   R       = diaPrev + segLen;
+   D       = R       + segLen;
+
+   vPen    = _mm_set1_epi16((short)penalty);
+   vExt    = _mm_set1_epi16((short)penext);
+   vNegInf = _mm_set1_epi16(SHRT_MIN);
+   vZero   = _mm_setzero_si128();
+   vLane0  = _mm_setr_epi16(-1, 0, 0, 0, 0, 0, 0, 0);
+
+   /* The end of seq2 is just the residue scores                        */
+   prof = (__m128i *)profile->striped + 
+          profile->row[(unsigned char)seq2[length2-1]] * segLen;
+   for(v=0; v<segLen; v++)
+   {
+      Mprev[v] = prof[v];
+      D[v]     = vNegInf;
+   }
+   vMax = vMin = Mprev[0];
+   _mm_storeu_si128((__m128i *)lanes, Mprev[lastV]);
+   best = lanes[lastK];
+
+   for(q=1; q<length2; q++)
+   {
+      prof = (__m128i *)profile->striped + 
+             profile->row[(unsigned char)seq2[length2-1-q]] * segLen;
+
+      /* The diagonal: previous column one position back                */
+      dia[0] = ShiftLanes(Mprev[segLen-1]);
+      for(v=1; v<segLen; v++)
+         dia[v] = Mprev[v-1];
+
+      /* Gap in seq2: running maximum of the previous column two 
+         positions back. First within each lane...
+      */
+      vCarry = vNegInf;
+      for(v=0; v<segLen; v++)
+      {
+         R[v]   = _mm_max_epi16(_mm_subs_epi16((v==0) ? 
+                                               ShiftLanes(dia[segLen-1]) :
+                                               dia[v-1], vPen), 
+                                vCarry);
+         vCarry = _mm_subs_epi16(R[v], vExt);
+      }
+      /* ...then carry over from each lane to the next until nothing 
+         changes
+      */
+      changed = TRUE;
+      for(pass=0; pass<VECLANES && changed; pass++)
+      {
+         vCarry = _mm_subs_epi16(ShiftLanes(R[segLen-1]), vExt);
+         for(v=0; v<segLen; v++)
+         {
+            if(!_mm_movemask_epi8(_mm_cmpgt_epi16(vCarry, R[v])))
+            {
+               changed = FALSE;
+               break;
+            }
+            R[v]   = _mm_max_epi16(R[v], vCarry);
+            vCarry = _mm_subs_epi16(R[v], vExt);
+         }
+      }
+
+      /* Gap in seq1: running maximum along the row one position back, 
+         i.e. of the previous diagonals
+      */
+      if(q >= 2)
+      {
+         for(v=0; v<segLen; v++)
+            D[v] = _mm_max_epi16(_mm_subs_epi16(diaPrev[v], vPen),
+                                 _mm_subs_epi16(D[v], vExt));
+      }
+
+      for(v=0; v<segLen; v++)
+      {
+         vRight = R[v];
+         /* Position 1 (lane 0 of vector 1) has no gap cells: score 0   */
+         if(v == 1)
+            vRight = _mm_andnot_si128(vLane0, vRight);
+         vDown  = (q == 1) ? vZero : D[v];
+
+         Mcur[v] = _mm_adds_epi16(prof[v], 
+                                  _mm_max_epi16(dia[v], 
+                                                _mm_max_epi16(vRight, 
+                                                              vDown)));
+         /* Position 0 is the end of the query: just the residue score  */
+         if(v == 0)
+            Mcur[0] = _mm_or_si128(_mm_and_si128(vLane0, prof[0]),
+                                   _mm_andnot_si128(vLane0, Mcur[0]));
+
+         vMax = _mm_max_epi16(vMax, Mcur[v]);
+         vMin = _mm_min_epi16(vMin, Mcur[v]);
+      }
+
+      _mm_storeu_si128((__m128i *)lanes, Mcur[lastV]);
+      best = MAX(best, lanes[lastK]);
+
+      tmp     = Mprev;
+      Mprev   = Mcur;
+      Mcur    = tmp;
+      tmp     = diaPrev;
+      diaPrev = dia;
+      dia     = tmp;
+   }
+
+   /* The start of seq2                                                 */
+   for(v=0; v<segLen; v++)
+   {
+      _mm_storeu_si128((__m128i *)lanes, Mprev[v]);
+      for(k=0; k<VECLANES; k++)
+      {
+         if(v + k * segLen <= last)
+            best = MAX(best, lanes[k]);
+      }
+   }
+
+   /* Check that nothing came near the limits of 16 bits                */
+   _mm_storeu_si128((__m128i *)lanes, vMax);
+   for(hi=lanes[0], k=1; k<VECLANES; k++)
+      hi = MAX(hi, lanes[k]);
+   _mm_storeu_si128((__m128i *)lanes, vMin);
+   for(lo=lanes[0], k=1; k<VECLANES; k++)
+      lo = MIN(lo, lanes[k]);
+   
+   free(mem);
+
+   if((hi > SHRT_MAX - margin) || (lo < SHRT_MIN + margin))
+      return(FALSE);
+
+   *score = best;
+   return(TRUE);
+}
+#endif
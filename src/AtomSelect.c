@@ -0,0 +1,1327 @@
+/************************************************************************/
+/**
+
+   \file       AtomSelect.c
+
+   \version    V1.1
+   \date       16.10.26
+   \brief      Compiled atom selections evaluated to bitsets
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   A small atom selection language. A selection is compiled once into
+   a postfix program and may then be evaluated against any number of
+   PDB linked lists. Evaluation gives a bitset with one bit per atom
+   (in linked list order); the atoms are only copied if a copy is asked
+   for.
+
+   The language is:
+
+      expr   := term { or term }
+      term   := factor { and factor }
+      factor := not factor
+              | within DIST of factor
+              | ( expr )
+              | all | none
+              | KEYWORD value [value ...]
+
+   with the keywords:
+
+      name    Atom names. ? or % matches any character and * matches
+              any trailing characters, with \ escaping a wildcard as in
+              blAtomNameMatch()
+      resname Residue names with the same wildcards
+      element Element symbols with the same wildcards
+      chain   Chain labels
+      resid   Residues or ranges of residues specified as for
+              blParseResSpec() (e.g. L24, L24A, L.24, L24-L35, L24-35,
+              24-35). A range includes all residues in the chain with
+              numbers (and insert codes) from the first to the last.
+              If no chain is given, any chain matches
+      record  Record types (ATOM or HETATM)
+
+   Keywords are not case sensitive; values are. Values continue up to
+   the next keyword or bracket. For example:
+
+      name CA C N O and chain L and resid L24-L34
+      not element H and within 4.5 of (resname HEM and record HETATM)
+
+   Names are compared as packed 4-character keys with a mask for the
+   wildcard positions, so each comparison is a single integer test.
+   Each step of the program sets the bits for one predicate over the
+   whole structure and the and/or/not steps then work a word at a time.
+   within uses a cell list over the structure.
+
+   A PDBSELECTION also holds the work space for evaluation and the
+   result so must only be used by one thread at a time.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   PDBSELECTION *sel;
+   int          *atoms   = NULL,
+                maxatoms = 0,
+                n, i;
+
+   sel = blCompilePDBSelection("name CA and chain A", NULL);
+   for(each structure)
+   {
+      blEvalPDBSelection(sel, pdb);
+      n = blGetPDBSelectionIndexes(sel, &atoms, &maxatoms);
+      ...
+   }
+   free(atoms);
+   blFreePDBSelection(sel);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 A residue with a numeric chain label and a . separator
+                  is no longer treated as being in any chain
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Manipulating the PDB linked list
+
+   #FUNCTION  blCompilePDBSelection()
+   Compiles an atom selection expression
+
+   #FUNCTION  blFreePDBSelection()
+   Frees a compiled atom selection
+
+   #FUNCTION  blEvalPDBSelection()
+   Evaluates a compiled selection over a PDB linked list to a bitset
+
+   #FUNCTION  blGetPDBSelectionIndexes()
+   Gets the indexes of the selected atoms
+
+   #FUNCTION  blCopyPDBSelection()
+   Copies the selected atoms to a new PDB linked list
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "SysDefs.h"
+#include "MathType.h"
+#include "macros.h"
+#include "general.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define SEL_ALL      0
+#define SEL_NONE     1
+#define SEL_NAME     2
+#define SEL_RESNAME  3
+#define SEL_ELEMENT  4
+#define SEL_CHAIN    5
+#define SEL_RESID    6
+#define SEL_RECORD   7
+#define SEL_AND      8
+#define SEL_OR       9
+#define SEL_NOT      10
+#define SEL_WITHIN   11
+
+#define SEL_NOTAKEY  (-1)
+#define SEL_OF       (-2)
+#define SEL_LPAREN   (-3)
+#define SEL_RPAREN   (-4)
+
+#define OP_ALLOCQUANT   16
+#define ATOM_ALLOCQUANT 64
+#define NOTSET          (REAL)9999.0
+
+#define WORDBITS        PDBSEL_WORDBITS
+#define SETBIT(b, i)    ((b)[(i)/WORDBITS] |= (1UL << ((i)%WORDBITS)))
+#define ISBITSET(b, i)  (((b)[(i)/WORDBITS] >> ((i)%WORDBITS)) & 1UL)
+
+/* A value for a predicate. Name-type values use key and mask; chains
+   use chain; residue ranges use chain, anychain, resnum and insert
+*/
+typedef struct
+{
+   unsigned long key,
+                 mask;
+   int           resnum[2];
+   char          insert[2];
+   char          chain[8];
+   BOOL          anychain;
+}  SELVALUE;
+
+struct pdbselop
+{
+   SELVALUE *values;
+   REAL     dist;
+   int      op,
+            nvalues;
+};
+
+typedef struct
+{
+   char            **tokens;
+   int             *offsets;
+   struct pdbselop *ops;
+   int             ntokens,
+                   pos,
+                   nops,
+                   maxops,
+                   depth,
+                   maxdepth,
+                   errpos;
+}  SELPARSER;
+
+/************************************************************************/
+/* Globals
+*/
+static struct
+{
+   char *word;
+   int  op;
+}  sKeywords[] =
+{
+   {"ALL",     SEL_ALL},
+   {"NONE",    SEL_NONE},
+   {"NAME",    SEL_NAME},
+   {"RESNAME", SEL_RESNAME},
+   {"ELEMENT", SEL_ELEMENT},
+   {"CHAIN",   SEL_CHAIN},
+   {"RESID",   SEL_RESID},
+   {"RECORD",  SEL_RECORD},
+   {"AND",     SEL_AND},
+   {"OR",      SEL_OR},
+   {"NOT",     SEL_NOT},
+   {"WITHIN",  SEL_WITHIN},
+   {"OF",      SEL_OF},
+   {"(",       SEL_LPAREN},
+   {")",       SEL_RPAREN},
+   {NULL,      SEL_NOTAKEY}
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static int Tokenize(char *buffer, char **tokens, int *offsets);
+static int KeywordOf(char *token);
+static BOOL ParseOr(SELPARSER *parser);
+static BOOL ParseAnd(SELPARSER *parser);
+static BOOL ParseFactor(SELPARSER *parser);
+static BOOL ParsePredicate(SELPARSER *parser, int op);
+static BOOL CompileValue(int op, char *token, SELVALUE *value);
+static BOOL CompilePattern(char *pattern, int maxlen, unsigned long *key,
+                           unsigned long *mask);
+static BOOL CompileResRange(char *spec, SELVALUE *value);
+static BOOL ParseOneRes(char *spec, char *chain, int *resnum,
+                        char *insert, BOOL *anychain);
+static BOOL EmitOp(SELPARSER *parser, int op, int push);
+static unsigned long PackName(char *name, BOOL skipSpaces);
+static BOOL MatchAtom(struct pdbselop *op, PDB *p);
+static int CompareRes(int resnum1, char insert1, int resnum2,
+                      char insert2);
+static BOOL SetWithin(PDBSELECTION *sel, PDB *pdb, PDBCELLLIST **cl,
+                      REAL dist, PDBSELBITS *ref, PDBSELBITS *out);
+
+
+/************************************************************************/
+/*>PDBSELECTION *blCompilePDBSelection(char *expr, int *errpos)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]     *expr     The selection expression
+   \param[out]    *errpos   Offset in expr of the token where an error
+                            was found (-1 if none or out of memory).
+                            May be NULL
+   \return                  The compiled selection (NULL if there was
+                            an error or memory allocation failed)
+
+   Compiles an atom selection expression (see the description at the
+   top of this file) for use with blEvalPDBSelection().
+
+-  16.10.26 Original
+*/
+PDBSELECTION *blCompilePDBSelection(char *expr, int *errpos)
+{
+   PDBSELECTION *sel    = NULL;
+   SELPARSER    parser;
+   char         *buffer = NULL;
+   int          len,
+                i;
+   BOOL         ok      = FALSE;
+
+   if(errpos != NULL)
+      *errpos = -1;
+   if(expr == NULL)
+      return(NULL);
+
+   /* Every token is at least one character, so there can't be more
+      tokens than characters. The buffer holds the expression and then
+      the tokens, each with a terminator
+   */
+   len = strlen(expr);
+   parser.tokens   = NULL;
+   parser.offsets  = NULL;
+   parser.ops      = NULL;
+   parser.pos      = 0;
+   parser.nops     = 0;
+   parser.maxops   = 0;
+   parser.depth    = 0;
+   parser.maxdepth = 0;
+   parser.errpos   = -1;
+
+   if(((buffer = (char *)malloc(3*(len+1)))==NULL) ||
+      ((parser.tokens  = (char **)malloc((len+1)*sizeof(char *)))==NULL) ||
+      ((parser.offsets = (int *)malloc((len+1)*sizeof(int)))==NULL))
+      goto done;
+   strcpy(buffer, expr);
+   parser.ntokens = Tokenize(buffer, parser.tokens, parser.offsets);
+
+   if(ParseOr(&parser))
+   {
+      if(parser.pos < parser.ntokens)
+      {
+         /* Something left over - e.g. an unmatched )                   */
+         parser.errpos = parser.offsets[parser.pos];
+      }
+      else if((sel = (PDBSELECTION *)malloc(sizeof(PDBSELECTION)))!=NULL)
+      {
+         sel->ops       = parser.ops;
+         sel->nops      = parser.nops;
+         sel->depth     = parser.maxdepth;
+         sel->work      = NULL;
+         sel->result    = NULL;
+         sel->maxwords  = 0;
+         sel->nwords    = 0;
+         sel->natoms    = 0;
+         sel->nselected = 0;
+         parser.ops     = NULL;
+         ok             = TRUE;
+      }
+   }
+
+done:
+   if(!ok)
+   {
+      for(i=0; i<parser.nops; i++)
+         free(parser.ops[i].values);
+      free(parser.ops);
+      if(errpos != NULL)
+         *errpos = parser.errpos;
+   }
+   free(parser.offsets);
+   free(parser.tokens);
+   free(buffer);
+   return(sel);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBSelection(PDBSELECTION *sel)
+   ------------------------------------------
+*//**
+
+   \param[in]     *sel      Compiled selection
+
+   Frees a compiled selection including its result bitset.
+
+-  16.10.26 Original
+*/
+void blFreePDBSelection(PDBSELECTION *sel)
+{
+   int i;
+
+   if(sel == NULL)
+      return;
+
+   for(i=0; i<sel->nops; i++)
+      free(sel->ops[i].values);
+   free(sel->ops);
+   free(sel->work);
+   free(sel);
+}
+
+
+/************************************************************************/
+/*>int blEvalPDBSelection(PDBSELECTION *sel, PDB *pdb)
+   ---------------------------------------------------
+*//**
+
+   \param[in,out] *sel      Compiled selection
+   \param[in]     *pdb      PDB linked list
+   \return                  Number of atoms selected (-1 if memory
+                            allocation failed)
+
+   Evaluates the selection over a PDB linked list. On return
+   sel->result is a bitset with bit i set if atom i (counting from 0 in
+   linked list order) is selected; use PDBSELECTED(sel, i) to test it.
+   sel->natoms and sel->nselected give the number of atoms in the list
+   and the number selected. The result is valid until the selection is
+   evaluated again or freed.
+
+   The work space is kept between calls so evaluating the same
+   selection over many structures does not normally allocate memory.
+
+-  16.10.26 Original
+*/
+int blEvalPDBSelection(PDBSELECTION *sel, PDB *pdb)
+{
+   PDBCELLLIST *cl = NULL;
+   PDBSELBITS  *top, *next;
+   PDB         *p;
+   int         natoms = 0,
+               nwords,
+               sp     = 0,
+               i, o, w;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      natoms++;
+   nwords = (int)PDBSEL_NWORDS(natoms);
+   if(nwords == 0)
+      nwords = 1;
+
+   /* Make sure there is space for the stack of bitsets                 */
+   if(sel->maxwords < nwords)
+   {
+      PDBSELBITS *work;
+
+      if((work = (PDBSELBITS *)realloc(sel->work,
+                                       nwords * sel->depth *
+                                       sizeof(PDBSELBITS)))==NULL)
+         return(-1);
+      sel->work     = work;
+      sel->maxwords = nwords;
+   }
+   sel->nwords    = nwords;
+   sel->natoms    = natoms;
+   sel->nselected = 0;
+   sel->result    = sel->work;
+
+   /* Run the program                                                   */
+   for(o=0; o<sel->nops; o++)
+   {
+      struct pdbselop *op = &(sel->ops[o]);
+
+      /* next is the first free bitset and top the one below it      */
+      next = sel->work + sp * nwords;
+      top  = (sp > 0) ? next - nwords : NULL;
+
+      switch(op->op)
+      {
+      case SEL_AND:
+         for(w=0; w<nwords; w++)
+            top[w - nwords] &= top[w];
+         sp--;
+         break;
+      case SEL_OR:
+         for(w=0; w<nwords; w++)
+            top[w - nwords] |= top[w];
+         sp--;
+         break;
+      case SEL_NOT:
+         for(w=0; w<nwords; w++)
+            top[w] = ~top[w];
+         /* Clear the bits past the last atom                           */
+         if(natoms % WORDBITS)
+            top[nwords-1] &= (1UL << (natoms % WORDBITS)) - 1UL;
+         else if(natoms == 0)
+            top[0] = 0;
+         break;
+      case SEL_WITHIN:
+         if(!SetWithin(sel, pdb, &cl, op->dist, top, next))
+         {
+            if(cl != NULL)
+               blFreePDBCellList(cl);
+            sel->natoms = 0;
+            return(-1);
+         }
+         memcpy(top, next, nwords * sizeof(PDBSELBITS));
+         break;
+      default:
+         /* A predicate - push its bitset                               */
+         memset(next, 0, nwords * sizeof(PDBSELBITS));
+         if(op->op == SEL_ALL)
+         {
+            for(i=0; i<natoms; i++)
+               SETBIT(next, i);
+         }
+         else if(op->op != SEL_NONE)
+         {
+            for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+            {
+               if(MatchAtom(op, p))
+                  SETBIT(next, i);
+            }
+         }
+         sp++;
+         break;
+      }
+   }
+
+   if(cl != NULL)
+      blFreePDBCellList(cl);
+
+   /* Count the selected atoms                                          */
+   for(w=0; w<nwords; w++)
+   {
+      PDBSELBITS bits = sel->result[w];
+      while(bits)
+      {
+         bits &= bits - 1UL;
+         sel->nselected++;
+      }
+   }
+
+   return(sel->nselected);
+}
+
+
+/************************************************************************/
+/*>int blGetPDBSelectionIndexes(PDBSELECTION *sel, int **atoms,
+                                int *maxatoms)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *sel       Evaluated selection
+   \param[in,out] **atoms    Array of atom indexes. May point to NULL
+                             on first call; it is allocated or grown
+                             as needed and may be re-used
+   \param[in,out] *maxatoms  Size of the atoms array
+   \return                   Number of atoms (-1 if out of memory)
+
+   Gets the indexes (in linked list order, counting from 0) of the atoms
+   selected by the last call to blEvalPDBSelection().
+
+-  16.10.26 Original
+*/
+int blGetPDBSelectionIndexes(PDBSELECTION *sel, int **atoms,
+                             int *maxatoms)
+{
+   int i,
+       n = 0;
+
+   if(*maxatoms < sel->nselected)
+   {
+      int newmax = sel->nselected + ATOM_ALLOCQUANT,
+          *newatoms;
+
+      if((newatoms = (int *)realloc(*atoms, newmax * sizeof(int)))==NULL)
+         return(-1);
+      *atoms    = newatoms;
+      *maxatoms = newmax;
+   }
+
+   for(i=0; i<sel->natoms; i++)
+   {
+      if(ISBITSET(sel->result, i))
+         (*atoms)[n++] = i;
+   }
+   return(n);
+}
+
+
+/************************************************************************/
+/*>PDB *blCopyPDBSelection(PDBSELECTION *sel, PDB *pdb, int *natom)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     *sel      Evaluated selection
+   \param[in]     *pdb      The PDB linked list used in the last call
+                            to blEvalPDBSelection()
+   \param[out]    *natom    Number of atoms copied
+   \return                  New PDB linked list (NULL if nothing was
+                            selected or memory allocation failed)
+
+   Copies the atoms selected by the last call to blEvalPDBSelection()
+   to a new linked list, in the same way as blSelectAtomsPDBAsCopy().
+
+-  16.10.26 Original
+*/
+PDB *blCopyPDBSelection(PDBSELECTION *sel, PDB *pdb, int *natom)
+{
+   PDB *pdbout = NULL,
+       *p,
+       *q      = NULL;
+   int i;
+
+   *natom = 0;
+   for(p=pdb, i=0; p!=NULL && i<sel->natoms; NEXT(p), i++)
+   {
+      if(!ISBITSET(sel->result, i))
+         continue;
+
+      if(pdbout == NULL)
+      {
+         INITPDB(pdbout);
+         q = pdbout;
+      }
+      else
+      {
+         ALLOCNEXTPDB(q);
+      }
+      if(q == NULL)
+      {
+         if(pdbout != NULL) FREEPDBLIST(pdbout);
+         *natom = 0;
+         return(NULL);
+      }
+
+      blCopyPDB(q, p);
+      (*natom)++;
+   }
+
+   return(pdbout);
+}
+
+
+/************************************************************************/
+/*>static int Tokenize(char *buffer, char **tokens, int *offsets)
+   --------------------------------------------------------------
+*//**
+
+   \param[in,out] *buffer   Copy of the expression followed by space
+                            for twice as many characters
+   \param[out]    **tokens  The tokens
+   \param[out]    *offsets  Offset of each token in the expression
+   \return                  Number of tokens
+
+   Splits the expression into tokens at white space and brackets. The
+   tokens are copied into the second half of the buffer.
+
+-  16.10.26 Original
+*/
+static int Tokenize(char *buffer, char **tokens, int *offsets)
+{
+   char *in,
+        *out;
+   int  ntokens = 0;
+
+   out = buffer + strlen(buffer) + 1;
+   for(in=buffer; *in; )
+   {
+      if(isspace(*in))
+      {
+         in++;
+         continue;
+      }
+
+      offsets[ntokens]  = in - buffer;
+      tokens[ntokens++] = out;
+      if((*in == '(') || (*in == ')'))
+      {
+         *(out++) = *(in++);
+      }
+      else
+      {
+         while(*in && !isspace(*in) && (*in != '(') && (*in != ')'))
+            *(out++) = *(in++);
+      }
+      *(out++) = '\0';
+   }
+   return(ntokens);
+}
+
+
+/************************************************************************/
+/*>static int KeywordOf(char *token)
+   ---------------------------------
+*//**
+
+   \param[in]     *token    A token
+   \return                  The SEL_ code for a keyword or SEL_NOTAKEY
+
+-  16.10.26 Original
+*/
+static int KeywordOf(char *token)
+{
+   int i;
+
+   for(i=0; sKeywords[i].word != NULL; i++)
+   {
+      if(!blUpstrcmp(token, sKeywords[i].word))
+         return(sKeywords[i].op);
+   }
+   return(SEL_NOTAKEY);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseOr(SELPARSER *parser)
+   --------------------------------------
+*//**
+
+   Parses   expr := term { or term }
+
+-  16.10.26 Original
+*/
+static BOOL ParseOr(SELPARSER *parser)
+{
+   if(!ParseAnd(parser))
+      return(FALSE);
+
+   while((parser->pos < parser->ntokens) &&
+         (KeywordOf(parser->tokens[parser->pos]) == SEL_OR))
+   {
+      parser->pos++;
+      if(!ParseAnd(parser) || !EmitOp(parser, SEL_OR, -1))
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseAnd(SELPARSER *parser)
+   ---------------------------------------
+*//**
+
+   Parses   term := factor { and factor }
+
+-  16.10.26 Original
+*/
+static BOOL ParseAnd(SELPARSER *parser)
+{
+   if(!ParseFactor(parser))
+      return(FALSE);
+
+   while((parser->pos < parser->ntokens) &&
+         (KeywordOf(parser->tokens[parser->pos]) == SEL_AND))
+   {
+      parser->pos++;
+      if(!ParseFactor(parser) || !EmitOp(parser, SEL_AND, -1))
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseFactor(SELPARSER *parser)
+   ------------------------------------------
+*//**
+
+   Parses a not, within, bracketed expression or predicate
+
+-  16.10.26 Original
+*/
+static BOOL ParseFactor(SELPARSER *parser)
+{
+   char *token;
+   int  key,
+        offset;
+   REAL dist;
+
+   if(parser->pos >= parser->ntokens)
+   {
+      /* Premature end - point at the end of the last token             */
+      parser->errpos = parser->ntokens ?
+         parser->offsets[parser->ntokens-1] : 0;
+      return(FALSE);
+   }
+
+   token  = parser->tokens[parser->pos];
+   offset = parser->offsets[parser->pos];
+   key    = KeywordOf(token);
+   parser->pos++;
+
+   switch(key)
+   {
+   case SEL_NOT:
+      return(ParseFactor(parser) && EmitOp(parser, SEL_NOT, 0));
+   case SEL_WITHIN:
+      /* within DIST of factor                                          */
+      if((parser->pos+1 >= parser->ntokens) ||
+         (sscanf(parser->tokens[parser->pos], "%lf", &dist) != 1) ||
+         (dist < (REAL)0.0))
+      {
+         parser->errpos = (parser->pos < parser->ntokens) ?
+            parser->offsets[parser->pos] : offset;
+         return(FALSE);
+      }
+      if(KeywordOf(parser->tokens[parser->pos+1]) != SEL_OF)
+      {
+         parser->errpos = parser->offsets[parser->pos+1];
+         return(FALSE);
+      }
+      parser->pos += 2;
+      if(!ParseFactor(parser) || !EmitOp(parser, SEL_WITHIN, 0))
+         return(FALSE);
+      parser->ops[parser->nops-1].dist = dist;
+
+      /* Needs a spare bitset above the reference atoms                 */
+      if(parser->depth + 1 > parser->maxdepth)
+         parser->maxdepth = parser->depth + 1;
+      return(TRUE);
+   case SEL_LPAREN:
+      if(!ParseOr(parser))
+         return(FALSE);
+      if((parser->pos >= parser->ntokens) ||
+         (KeywordOf(parser->tokens[parser->pos]) != SEL_RPAREN))
+      {
+         parser->errpos = (parser->pos < parser->ntokens) ?
+            parser->offsets[parser->pos] : offset;
+         return(FALSE);
+      }
+      parser->pos++;
+      return(TRUE);
+   case SEL_ALL:
+   case SEL_NONE:
+      return(EmitOp(parser, key, 1));
+   case SEL_NAME:
+   case SEL_RESNAME:
+   case SEL_ELEMENT:
+   case SEL_CHAIN:
+   case SEL_RESID:
+   case SEL_RECORD:
+      return(ParsePredicate(parser, key));
+   default:
+      break;
+   }
+
+   parser->errpos = offset;
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParsePredicate(SELPARSER *parser, int op)
+   -----------------------------------------------------
+*//**
+
+   \param[in,out] *parser   Parser
+   \param[in]     op        The predicate (SEL_NAME, etc.)
+   \return                  Success
+
+   Compiles the values following a predicate keyword.
+
+-  16.10.26 Original
+*/
+static BOOL ParsePredicate(SELPARSER *parser, int op)
+{
+   SELVALUE *values;
+   int      nvalues = 0,
+            start   = parser->pos;
+
+   while((parser->pos < parser->ntokens) &&
+         (KeywordOf(parser->tokens[parser->pos]) == SEL_NOTAKEY))
+      parser->pos++;
+
+   if(parser->pos == start)
+   {
+      parser->errpos = (start < parser->ntokens) ?
+         parser->offsets[start] : parser->offsets[start-1];
+      return(FALSE);
+   }
+
+   if((values = (SELVALUE *)malloc((parser->pos - start) *
+                                   sizeof(SELVALUE)))==NULL)
+      return(FALSE);
+
+   for(; start < parser->pos; start++)
+   {
+      if(!CompileValue(op, parser->tokens[start], &(values[nvalues++])))
+      {
+         parser->errpos = parser->offsets[start];
+         free(values);
+         return(FALSE);
+      }
+   }
+
+   if(!EmitOp(parser, op, 1))
+   {
+      free(values);
+      return(FALSE);
+   }
+   parser->ops[parser->nops-1].values  = values;
+   parser->ops[parser->nops-1].nvalues = nvalues;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL CompileValue(int op, char *token, SELVALUE *value)
+   --------------------------------------------------------------
+*//**
+
+   \param[in]     op        The predicate
+   \param[in]     *token    The value as given
+   \param[out]    *value    The compiled value
+   \return                  Valid value?
+
+-  16.10.26 Original
+*/
+static BOOL CompileValue(int op, char *token, SELVALUE *value)
+{
+   char record[8];
+
+   value->key = value->mask = 0;
+   value->anychain = FALSE;
+   value->chain[0] = '\0';
+
+   switch(op)
+   {
+   case SEL_NAME:
+   case SEL_RESNAME:
+   case SEL_ELEMENT:
+      return(CompilePattern(token, 4, &(value->key), &(value->mask)));
+   case SEL_RECORD:
+      /* Only the first 4 characters (ATOM / HETA) are compared         */
+      if(!blUpstrcmp(token, "ATOM"))
+         strcpy(record, "ATOM");
+      else if(!blUpstrcmp(token, "HETATM"))
+         strcpy(record, "HETA");
+      else
+         return(FALSE);
+      return(CompilePattern(record, 4, &(value->key), &(value->mask)));
+   case SEL_CHAIN:
+      if(strlen(token) >= sizeof(value->chain))
+         return(FALSE);
+      strcpy(value->chain, token);
+      return(TRUE);
+   case SEL_RESID:
+      return(CompileResRange(token, value));
+   default:
+      break;
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>static BOOL CompilePattern(char *pattern, int maxlen,
+                              unsigned long *key, unsigned long *mask)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *pattern  Name with optional wildcards
+   \param[in]     maxlen    Maximum length of a name (<= 4)
+   \param[out]    *key      Packed name
+   \param[out]    *mask     Bits of the packed name to compare
+   \return                  Valid pattern?
+
+   Compiles a name with the wildcards used by blAtomNameMatch() into a
+   packed key and mask. A name n then matches if
+   ((PackName(n) ^ key) & mask) == 0
+
+-  16.10.26 Original
+*/
+static BOOL CompilePattern(char *pattern, int maxlen, unsigned long *key,
+                           unsigned long *mask)
+{
+   char *p;
+   int  pos = 0;
+   BOOL star = FALSE;
+
+   *key = *mask = 0;
+   for(p=pattern; *p; p++)
+   {
+      if(star || (pos >= maxlen))
+         return(FALSE);
+
+      switch(*p)
+      {
+      case '*':
+         star = TRUE;
+         continue;
+      case '?':
+      case '%':
+         pos++;
+         continue;
+      case '\\':
+         if(!*(++p))
+            return(FALSE);
+         break;
+      default:
+         break;
+      }
+
+      *key  |= ((unsigned long)(unsigned char)*p) << (8*pos);
+      *mask |= 0xFFUL << (8*pos);
+      pos++;
+   }
+
+   /* Without a trailing * the rest of the name must be blank           */
+   if(!star)
+   {
+      for(; pos<4; pos++)
+      {
+         *key  |= ((unsigned long)' ') << (8*pos);
+         *mask |= 0xFFUL << (8*pos);
+      }
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL CompileResRange(char *spec, SELVALUE *value)
+   --------------------------------------------------------
+*//**
+
+   \param[in]     *spec     Residue or residue range (e.g. L24-L35)
+   \param[out]    *value    Compiled range
+   \return                  Valid range?
+
+   The range is split at the first - which follows a digit, so that
+   negative residue numbers may be used (e.g. L-3-L5).
+
+-  16.10.26 Original
+*/
+static BOOL CompileResRange(char *spec, SELVALUE *value)
+{
+   char buffer[64],
+        chain2[8],
+        *split = NULL,
+        *p;
+   BOOL anychain2;
+   int  i;
+
+   if(strlen(spec) >= sizeof(buffer))
+      return(FALSE);
+   strcpy(buffer, spec);
+
+   for(p=buffer+1; *p; p++)
+   {
+      if((*p == '-') && isdigit(*(p-1)))
+      {
+         split = p;
+         break;
+      }
+      /* An insert code may also end the first residue                  */
+      if((*p == '-') && isalpha(*(p-1)) && (p-buffer > 1) &&
+         isdigit(*(p-2)))
+      {
+         split = p;
+         break;
+      }
+   }
+
+   if(split != NULL)
+      *(split++) = '\0';
+
+   if(!ParseOneRes(buffer, value->chain, &(value->resnum[0]),
+                   &(value->insert[0]), &(value->anychain)))
+      return(FALSE);
+
+   if(split == NULL)
+   {
+      value->resnum[1] = value->resnum[0];
+      value->insert[1] = value->insert[0];
+      return(TRUE);
+   }
+
+   if(!ParseOneRes(split, chain2, &(value->resnum[1]),
+                   &(value->insert[1]), &anychain2))
+      return(FALSE);
+
+   /* The second residue takes the chain of the first if it has none,
+      otherwise they must be the same
+   */
+   if(!anychain2 && (value->anychain || !CHAINMATCH(chain2, value->chain)))
+      return(FALSE);
+
+   /* The range must be the right way round                             */
+   i = CompareRes(value->resnum[0], value->insert[0],
+                  value->resnum[1], value->insert[1]);
+   return(i <= 0);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseOneRes(char *spec, char *chain, int *resnum,
+                           char *insert, BOOL *anychain)
+   --------------------------------------------------------------
+*//**
+
+   \param[in]     *spec     Residue specification
+   \param[out]    *chain    Chain label
+   \param[out]    *resnum   Residue number
+   \param[out]    *insert   Insert code
+   \param[out]    *anychain No chain was given
+   \return                  Valid specification?
+
+   Parses a residue with blParseResSpec(), noting whether a chain was
+   given. A chain is given if there is a . separator (so numeric chain 
+   labels may be used) or the specification starts with a chain label.
+
+-  16.10.26 Original
+-  16.10.26 Chain is given if there is a . separator
+*/
+static BOOL ParseOneRes(char *spec, char *chain, int *resnum,
+                        char *insert, BOOL *anychain)
+{
+   char ins[8],
+        chn[64];
+
+   if(!*spec)
+      return(FALSE);
+
+   *anychain = ((strchr(spec, '.') == NULL) &&
+                (isdigit(*spec) || (*spec == '-')));
+   if(!blParseResSpec(spec, chn, resnum, ins) || (strlen(chn) >= 8))
+      return(FALSE);
+   strcpy(chain, chn);
+   *insert = ins[0];
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL EmitOp(SELPARSER *parser, int op, int push)
+   -------------------------------------------------------
+*//**
+
+   \param[in,out] *parser   Parser
+   \param[in]     op        Operation to add to the program
+   \param[in]     push      Change in the depth of the bitset stack
+   \return                  Success
+
+-  16.10.26 Original
+*/
+static BOOL EmitOp(SELPARSER *parser, int op, int push)
+{
+   if(parser->nops == parser->maxops)
+   {
+      struct pdbselop *ops;
+
+      if((ops = (struct pdbselop *)
+          realloc(parser->ops, (parser->maxops + OP_ALLOCQUANT) *
+                  sizeof(struct pdbselop)))==NULL)
+         return(FALSE);
+      parser->ops     = ops;
+      parser->maxops += OP_ALLOCQUANT;
+   }
+
+   parser->ops[parser->nops].op      = op;
+   parser->ops[parser->nops].values  = NULL;
+   parser->ops[parser->nops].nvalues = 0;
+   parser->ops[parser->nops].dist    = (REAL)0.0;
+   parser->nops++;
+
+   parser->depth += push;
+   if(parser->depth > parser->maxdepth)
+      parser->maxdepth = parser->depth;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static unsigned long PackName(char *name, BOOL skipSpaces)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]     *name       Name from a PDB record
+   \param[in]     skipSpaces  Skip leading spaces
+   \return                    Name packed into 4 bytes
+
+   Packs up to 4 characters of a name into an integer. The name is
+   padded with spaces if shorter.
+
+-  16.10.26 Original
+*/
+static unsigned long PackName(char *name, BOOL skipSpaces)
+{
+   unsigned long key = 0;
+   int           pos;
+
+   if(skipSpaces)
+   {
+      while(*name == ' ')
+         name++;
+   }
+
+   for(pos=0; pos<4; pos++)
+   {
+      unsigned char c = (*name) ? (unsigned char)*(name++) : ' ';
+      key |= ((unsigned long)c) << (8*pos);
+   }
+   return(key);
+}
+
+
+/************************************************************************/
+/*>static BOOL MatchAtom(struct pdbselop *op, PDB *p)
+   --------------------------------------------------
+*//**
+
+   \param[in]     *op       Predicate
+   \param[in]     *p        Atom
+   \return                  Does the atom match any of the values?
+
+-  16.10.26 Original
+*/
+static BOOL MatchAtom(struct pdbselop *op, PDB *p)
+{
+   unsigned long key;
+   SELVALUE      *v;
+   int           i;
+
+   switch(op->op)
+   {
+   case SEL_NAME:
+      key = PackName(p->atnam, FALSE);
+      break;
+   case SEL_RESNAME:
+      key = PackName(p->resnam, FALSE);
+      break;
+   case SEL_ELEMENT:
+      key = PackName(p->element, TRUE);
+      break;
+   case SEL_RECORD:
+      key = PackName(p->record_type, FALSE);
+      break;
+   case SEL_CHAIN:
+      for(i=0; i<op->nvalues; i++)
+      {
+         if(CHAINMATCH(p->chain, op->values[i].chain))
+            return(TRUE);
+      }
+      return(FALSE);
+   case SEL_RESID:
+      for(i=0, v=op->values; i<op->nvalues; i++, v++)
+      {
+         if((v->anychain || CHAINMATCH(p->chain, v->chain)) &&
+            (CompareRes(p->resnum, p->insert[0],
+                        v->resnum[0], v->insert[0]) >= 0) &&
+            (CompareRes(p->resnum, p->insert[0],
+                        v->resnum[1], v->insert[1]) <= 0))
+            return(TRUE);
+      }
+      return(FALSE);
+   default:
+      return(FALSE);
+   }
+
+   for(i=0, v=op->values; i<op->nvalues; i++, v++)
+   {
+      if(((key ^ v->key) & v->mask) == 0)
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>static int CompareRes(int resnum1, char insert1, int resnum2,
+                         char insert2)
+   -------------------------------------------------------------
+*//**
+
+   \return      <0, 0 or >0 as residue 1 is before, the same as or after
+                residue 2
+
+   A blank or missing insert code comes before any other.
+
+-  16.10.26 Original
+*/
+static int CompareRes(int resnum1, char insert1, int resnum2,
+                      char insert2)
+{
+   if(resnum1 != resnum2)
+      return((resnum1 < resnum2) ? -1 : 1);
+   if(insert1 == '\0') insert1 = ' ';
+   if(insert2 == '\0') insert2 = ' ';
+   return((int)insert1 - (int)insert2);
+}
+
+
+/************************************************************************/
+/*>static BOOL SetWithin(PDBSELECTION *sel, PDB *pdb, PDBCELLLIST **cl,
+                         REAL dist, PDBSELBITS *ref, PDBSELBITS *out)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]     *sel      Selection being evaluated
+   \param[in]     *pdb      PDB linked list
+   \param[in,out] **cl      Cell list over pdb (built if NULL)
+   \param[in]     dist      Distance
+   \param[in]     *ref      Bitset of reference atoms
+   \param[out]    *out      Bitset of atoms within dist of any
+                            reference atom
+   \return                  Success
+
+   The cell list is built on first use and shared by any other within
+   steps in the same evaluation. Reference atoms without coordinates
+   are ignored.
+
+-  16.10.26 Original
+*/
+static BOOL SetWithin(PDBSELECTION *sel, PDB *pdb, PDBCELLLIST **cl,
+                      REAL dist, PDBSELBITS *ref, PDBSELBITS *out)
+{
+   int  *atoms   = NULL,
+        maxatoms = 0,
+        natoms,
+        i, j;
+
+   memset(out, 0, sel->nwords * sizeof(PDBSELBITS));
+   if(sel->natoms == 0)
+      return(TRUE);
+
+   if(*cl == NULL)
+   {
+      if((*cl = blBuildPDBCellList(pdb, (dist > (REAL)0.0) ?
+                                   dist : (REAL)1.0))==NULL)
+         return(FALSE);
+   }
+
+   for(i=0; i<sel->natoms; i++)
+   {
+      PDB *p;
+
+      if(!ISBITSET(ref, i))
+         continue;
+
+      p = (*cl)->coords->atom[i];
+      if((p->x >= NOTSET) || (p->y >= NOTSET) || (p->z >= NOTSET))
+         continue;
+
+      if((natoms = blFindPDBAtomNeighbours(*cl, p, dist,
+                                           &atoms, &maxatoms)) < 0)
+      {
+         free(atoms);
+         return(FALSE);
+      }
+      for(j=0; j<natoms; j++)
+         SETBIT(out, atoms[j]);
+   }
+
+   free(atoms);
+   return(TRUE);
+}
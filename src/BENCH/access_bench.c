@@ -0,0 +1,234 @@
+/************************************************************************/
+/**
+
+   \file       access_bench.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Benchmark for the Shrake and Rupley accessibility method
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Calculates the solvent accessibility of a PDB file by the method of
+   Lee and Richards and then by the method of Shrake and Rupley with
+   60, 120, 240, 480 and 960 points per atom. For each, reports the
+   time taken and the error in the total, atom and residue 
+   accessibilities relative to Lee and Richards.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   access_bench file.pdb radii.dat [nthreads]
+
+   radii.dat is the radius file (e.g. bioplib/data/radii.dat)
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "../SysDefs.h"
+#include "../MathType.h"
+#include "../pdb.h"
+#include "../macros.h"
+#include "../access.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ELAPSED(t) ((double)(clock() - (t)) / (double)CLOCKS_PER_SEC)
+#define NPOINTSETS 5
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+static int StoreResAccess(PDB *pdb, RESRAD *resrad, REAL *resAccess, 
+                          int maxres);
+
+/************************************************************************/
+int main(int argc, char **argv)
+{
+   int      npoints[NPOINTSETS] = {60, 120, 240, 480, 960},
+            natoms,
+            nres,
+            nthreads = 1,
+            i, k;
+   REAL     *lrAtom,
+            *lrRes,
+            *srRes;
+   double   tLR,
+            t,
+            lrTotal,
+            total,
+            atomErr,
+            resErr;
+   clock_t  start;
+   FILE     *fp;
+   PDB      *pdb,
+            *p;
+   RESRAD   *resrad;
+
+   if(argc < 3)
+   {
+      fprintf(stderr,
+              "Usage: access_bench file.pdb radii.dat [nthreads]\n");
+      return(1);
+   }
+   if(argc > 3)
+      nthreads = atoi(argv[3]);
+
+   if((fp=fopen(argv[1], "r"))==NULL)
+   {
+      fprintf(stderr,"Unable to open %s\n", argv[1]);
+      return(1);
+   }
+   pdb = blReadPDBAtoms(fp, &natoms);
+   fclose(fp);
+   if(pdb == NULL)
+   {
+      fprintf(stderr,"Unable to read %s\n", argv[1]);
+      return(1);
+   }
+   
+   if((fp=fopen(argv[2], "r"))==NULL)
+   {
+      fprintf(stderr,"Unable to open %s\n", argv[2]);
+      return(1);
+   }
+   resrad = blSetAtomRadii(pdb, fp);
+   fclose(fp);
+
+   lrAtom = (REAL *)malloc(natoms * sizeof(REAL));
+   lrRes  = (REAL *)malloc(natoms * sizeof(REAL));
+   srRes  = (REAL *)malloc(natoms * sizeof(REAL));
+   if((lrAtom == NULL) || (lrRes == NULL) || (srRes == NULL))
+   {
+      fprintf(stderr,"No memory\n");
+      return(1);
+   }
+
+   /* Reference Lee and Richards calculation                            */
+   start = clock();
+   if(!blCalcAccessMethod(pdb, natoms, ACCESS_METHOD_LR, 0.0, 1.4, 
+                          TRUE, nthreads))
+   {
+      fprintf(stderr,"Lee and Richards calculation failed\n");
+      return(1);
+   }
+   tLR     = ELAPSED(start);
+   lrTotal = 0.0;
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      lrAtom[i] = p->access;
+      lrTotal  += p->access;
+   }
+   nres = StoreResAccess(pdb, resrad, lrRes, natoms);
+
+   printf("File:     %s\n", argv[1]);
+   printf("Atoms:    %d\n", natoms);
+   printf("Residues: %d\n", nres);
+   printf("Threads:  %d\n\n", nthreads);
+   printf("Method  Points  Time(s)  Speedup  Total(A^2)  Error(%%)  "
+          "Atom MAE  Res MAE\n");
+   printf("LR           -  %7.3f  %7.2f  %10.1f         -         -  "
+          "      -\n", tLR, 1.0, lrTotal);
+
+   /* Shrake and Rupley with increasing numbers of points               */
+   for(k=0; k<NPOINTSETS; k++)
+   {
+      start = clock();
+      if(!blCalcAccessMethod(pdb, natoms, ACCESS_METHOD_SR, 
+                             (REAL)npoints[k], 1.4, TRUE, nthreads))
+      {
+         fprintf(stderr,"Shrake and Rupley calculation failed\n");
+         return(1);
+      }
+      t = ELAPSED(start);
+
+      total   = 0.0;
+      atomErr = 0.0;
+      for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+      {
+         total   += p->access;
+         atomErr += fabs(p->access - lrAtom[i]);
+      }
+      StoreResAccess(pdb, resrad, srRes, natoms);
+      resErr = 0.0;
+      for(i=0; i<nres; i++)
+         resErr += fabs(srRes[i] - lrRes[i]);
+
+      printf("SR      %6d  %7.3f  %7.2f  %10.1f  %8.2f  %8.3f  %7.3f\n",
+             npoints[k], t, (t > 0.0) ? tLR / t : 0.0, total, 
+             100.0 * (total - lrTotal) / lrTotal,
+             atomErr / natoms, resErr / nres);
+   }
+
+   FREEPDBLIST(pdb);
+   free(lrAtom);
+   free(lrRes);
+   free(srRes);
+   return(0);
+}
+
+/************************************************************************/
+/*>static int StoreResAccess(PDB *pdb, RESRAD *resrad, REAL *resAccess, 
+                             int maxres)
+   ---------------------------------------------------------------------
+   Calculates the residue accessibilities and copies them into an array.
+   Returns the number of residues
+
+-  16.10.26 Original
+*/
+static int StoreResAccess(PDB *pdb, RESRAD *resrad, REAL *resAccess, 
+                          int maxres)
+{
+   RESACCESS *resacc,
+             *r;
+   int       nres = 0;
+   
+   resacc = blCalcResAccess(pdb, resrad);
+   for(r=resacc; (r!=NULL) && (nres<maxres); NEXT(r))
+      resAccess[nres++] = r->resAccess;
+   FREELIST(resacc, RESACCESS);
+   return(nres);
+}
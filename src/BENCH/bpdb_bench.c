@@ -0,0 +1,271 @@
+/************************************************************************/
+/**
+
+   \file       bpdb_bench.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Benchmark for the binary .bpdb cache format
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Converts a PDB file to PDBML and to .bpdb (written alongside the 
+   input as file.pdb.xml and file.pdb.bpdb and deleted afterwards) and
+   times loading each of them:
+
+   1. blReadWholePDB() of the PDB file
+   2. blReadWholePDB() of the PDBML file
+   3. blReadWholeBPDB()
+   4. blReadBPDB()
+   5. blOpenBPDB() followed by blBPDBToPDB() of all atoms
+   6. blOpenBPDB() alone (nothing decoded)
+
+   and checks that the .bpdb loads give identical linked lists to the 
+   PDB file.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   bpdb_bench file.pdb [repeats]
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../SysDefs.h"
+#include "../MathType.h"
+#include "../pdb.h"
+#include "../macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ELAPSED(t) ((double)(clock() - (t)) / (double)CLOCKS_PER_SEC)
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+static BOOL SameList(PDB *pdb1, PDB *pdb2);
+static long FileSize(char *filename);
+
+/************************************************************************/
+int main(int argc, char **argv)
+{
+   int      repeats = 3,
+            i,
+            natom   = 0;
+   double   tPDB     = 0.0,
+            tPDBML   = 0.0,
+            tWhole   = 0.0,
+            tBPDB    = 0.0,
+            tLazy    = 0.0,
+            tOpen    = 0.0;
+   char     xmlfile[256],
+            bpdbfile[256];
+   clock_t  start;
+   FILE     *fp;
+   WHOLEPDB *wpdb,
+            *wpdb2;
+   PDB      *pdb;
+   BPDBFILE *bpdb;
+   BOOL     same = TRUE;
+
+   if(argc < 2)
+   {
+      fprintf(stderr,"Usage: bpdb_bench file.pdb [repeats]\n");
+      return(1);
+   }
+   if(argc > 2)
+      repeats = atoi(argv[2]);
+
+   sprintf(xmlfile,  "%.240s.xml",  argv[1]);
+   sprintf(bpdbfile, "%.240s.bpdb", argv[1]);
+
+   /* Read the PDB file and write the other formats                     */
+   if((fp=fopen(argv[1], "r"))==NULL)
+   {
+      fprintf(stderr,"Unable to open %s\n", argv[1]);
+      return(1);
+   }
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   if(wpdb == NULL)
+   {
+      fprintf(stderr,"Unable to read %s\n", argv[1]);
+      return(1);
+   }
+   
+   if((fp=fopen(xmlfile, "w"))==NULL)
+   {
+      fprintf(stderr,"Unable to write %s\n", xmlfile);
+      return(1);
+   }
+   blWriteAsPDBML(fp, wpdb->pdb);
+   fclose(fp);
+   
+   if((fp=fopen(bpdbfile, "wb"))==NULL)
+   {
+      fprintf(stderr,"Unable to write %s\n", bpdbfile);
+      return(1);
+   }
+   blWriteWholeBPDB(fp, wpdb);
+   fclose(fp);
+
+   for(i=0; i<repeats; i++)
+   {
+      fp    = fopen(argv[1], "r");
+      start = clock();
+      wpdb2 = blReadWholePDB(fp);
+      tPDB += ELAPSED(start);
+      fclose(fp);
+      blFreeWholePDB(wpdb2);
+
+      fp      = fopen(xmlfile, "r");
+      start   = clock();
+      wpdb2   = blReadWholePDB(fp);
+      tPDBML += ELAPSED(start);
+      fclose(fp);
+      blFreeWholePDB(wpdb2);
+
+      fp      = fopen(bpdbfile, "rb");
+      start   = clock();
+      wpdb2   = blReadWholeBPDB(fp);
+      tWhole += ELAPSED(start);
+      fclose(fp);
+      if((wpdb2 == NULL) || !SameList(wpdb->pdb, wpdb2->pdb))
+         same = FALSE;
+      blFreeWholePDB(wpdb2);
+
+      fp     = fopen(bpdbfile, "rb");
+      start  = clock();
+      pdb    = blReadBPDB(fp, &natom);
+      tBPDB += ELAPSED(start);
+      fclose(fp);
+      if(!SameList(wpdb->pdb, pdb))
+         same = FALSE;
+      FREELIST(pdb, PDB);
+
+      start  = clock();
+      bpdb   = blOpenBPDB(bpdbfile);
+      tOpen += ELAPSED(start);
+      pdb    = blBPDBToPDB(bpdb, 0, 0, &natom);
+      tLazy += ELAPSED(start);
+      blCloseBPDB(bpdb);
+      if(!SameList(wpdb->pdb, pdb))
+         same = FALSE;
+      FREELIST(pdb, PDB);
+   }
+
+   printf("File:                 %s\n", argv[1]);
+   printf("Repeats:              %d\n", repeats);
+   printf("Atoms:                %d\n", wpdb->natoms);
+   printf("File sizes:           %ld (PDB) %ld (PDBML) %ld (BPDB)\n",
+          FileSize(argv[1]), FileSize(xmlfile), FileSize(bpdbfile));
+   printf("Lists identical:      %s\n", same ? "yes" : "NO");
+   printf("blReadWholePDB() PDB:   %8.3fs per read\n", tPDB   / repeats);
+   printf("blReadWholePDB() PDBML: %8.3fs per read\n", tPDBML / repeats);
+   printf("blReadWholeBPDB():      %8.3fs per read\n", tWhole / repeats);
+   printf("blReadBPDB():           %8.3fs per read\n", tBPDB  / repeats);
+   printf("blOpenBPDB()+ToPDB():   %8.3fs per read\n", tLazy  / repeats);
+   printf("blOpenBPDB() only:      %8.3fs per read\n", tOpen  / repeats);
+
+   blFreeWholePDB(wpdb);
+   remove(xmlfile);
+   remove(bpdbfile);
+   return(0);
+}
+
+/************************************************************************/
+/*>static BOOL SameList(PDB *pdb1, PDB *pdb2)
+   ------------------------------------------
+   Field by field comparison of two PDB linked lists including the 
+   fields that are not in PDB files
+
+-  16.10.26 Original
+*/
+static BOOL SameList(PDB *pdb1, PDB *pdb2)
+{
+   PDB *p, *q;
+   
+   for(p=pdb1, q=pdb2; p!=NULL && q!=NULL; NEXT(p), NEXT(q))
+   {
+      if((p->atnum  != q->atnum)  || (p->resnum != q->resnum) ||
+         (p->x      != q->x)      || (p->y      != q->y)      ||
+         (p->z      != q->z)      || (p->occ    != q->occ)    ||
+         (p->bval   != q->bval)   || (p->altpos != q->altpos) ||
+         (p->access != q->access) || (p->radius != q->radius) ||
+         (p->formal_charge  != q->formal_charge)              ||
+         (p->partial_charge != q->partial_charge)             ||
+         strcmp(p->record_type, q->record_type)               ||
+         strcmp(p->atnam,       q->atnam)                     ||
+         strcmp(p->atnam_raw,   q->atnam_raw)                 ||
+         strcmp(p->resnam,      q->resnam)                    ||
+         strcmp(p->chain,       q->chain)                     ||
+         strcmp(p->insert,      q->insert)                    ||
+         strcmp(p->element,     q->element))
+         return(FALSE);
+   }
+   return((p == NULL) && (q == NULL));
+}
+
+/************************************************************************/
+/*>static long FileSize(char *filename)
+   ------------------------------------
+   Size of a file in bytes
+
+-  16.10.26 Original
+*/
+static long FileSize(char *filename)
+{
+   FILE *fp;
+   long size = 0;
+   
+   if((fp=fopen(filename, "rb"))!=NULL)
+   {
+      fseek(fp, 0L, SEEK_END);
+      size = ftell(fp);
+      fclose(fp);
+   }
+   return(size);
+}
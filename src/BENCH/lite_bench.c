@@ -0,0 +1,248 @@
+/************************************************************************/
+/**
+
+   \file       lite_bench.c
+
+   \version    V1.0
+   \date       16.10.26
+   \brief      Benchmark for the compact PDBLITE atom table
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Compares the PDB linked list with the compact PDBLITE atom table.
+   Times:
+
+   1. blDoReadPDB()             - linked list
+   2. blDoReadPDBLite()         - PDBLITE filled directly
+   3. blDoReadPDBMapped()       - linked list, memory-mapped
+   4. blDoReadPDBLiteMapped()   - PDBLITE filled directly, memory-mapped
+   5. blPDBToPDBLite()          - conversion of the linked list
+   6. blPDBLiteToPDB()          - conversion back to a linked list
+
+   and checks that each PDBLITE has the same atoms as the linked list.
+   The memory used by each is reported in bytes per atom. For the linked
+   list this is sizeof(PDB); each node also has the overhead of its
+   allocation unless it comes from a PDB arena.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   lite_bench file.pdb [repeats]
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "../SysDefs.h"
+#include "../MathType.h"
+#include "../pdb.h"
+#include "../macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ELAPSED(t) ((double)(clock() - (t)) / (double)CLOCKS_PER_SEC)
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+static BOOL SameAtoms(PDBLITE *lite, PDB *pdb);
+
+/************************************************************************/
+int main(int argc, char **argv)
+{
+   int      repeats = 3,
+            i,
+            natom   = 0,
+            natom2  = 0;
+   double   tRead       = 0.0,
+            tReadLite   = 0.0,
+            tMapped     = 0.0,
+            tMappedLite = 0.0,
+            tToLite     = 0.0,
+            tFromLite   = 0.0,
+            listBytes,
+            liteBytes;
+   clock_t  start;
+   FILE     *fp;
+   PDB      *pdb,
+            *pdb2;
+   PDBLITE  *lite;
+   BOOL     same = TRUE;
+
+   if(argc < 2)
+   {
+      fprintf(stderr,"Usage: lite_bench file.pdb [repeats]\n");
+      return(1);
+   }
+   if(argc > 2)
+      repeats = atoi(argv[2]);
+
+   if((fp=fopen(argv[1], "r"))==NULL)
+   {
+      fprintf(stderr,"Unable to open %s\n", argv[1]);
+      return(1);
+   }
+   pdb = blDoReadPDB(fp, &natom, TRUE, 1, 1);
+   fclose(fp);
+   if(pdb == NULL)
+   {
+      fprintf(stderr,"Unable to read %s\n", argv[1]);
+      return(1);
+   }
+   FREELIST(pdb, PDB);
+
+   for(i=0; i<repeats; i++)
+   {
+      fp     = fopen(argv[1], "r");
+      start  = clock();
+      pdb    = blDoReadPDB(fp, &natom, TRUE, 1, 1);
+      tRead += ELAPSED(start);
+      fclose(fp);
+
+      fp         = fopen(argv[1], "r");
+      start      = clock();
+      lite       = blDoReadPDBLite(fp, TRUE, 1, 1);
+      tReadLite += ELAPSED(start);
+      fclose(fp);
+      if(!SameAtoms(lite, pdb))
+         same = FALSE;
+      blFreePDBLite(lite);
+      FREELIST(pdb, PDB);
+
+      start    = clock();
+      pdb      = blDoReadPDBMapped(argv[1], &natom, TRUE, 1, 1);
+      tMapped += ELAPSED(start);
+
+      start        = clock();
+      lite         = blDoReadPDBLiteMapped(argv[1], TRUE, 1, 1);
+      tMappedLite += ELAPSED(start);
+      if(!SameAtoms(lite, pdb))
+         same = FALSE;
+      blFreePDBLite(lite);
+
+      start    = clock();
+      lite     = blPDBToPDBLite(pdb);
+      tToLite += ELAPSED(start);
+      if(!SameAtoms(lite, pdb))
+         same = FALSE;
+
+      start      = clock();
+      pdb2       = blPDBLiteToPDB(lite, &natom2);
+      tFromLite += ELAPSED(start);
+      if(!SameAtoms(lite, pdb2))
+         same = FALSE;
+
+      blFreePDBLite(lite);
+      FREELIST(pdb2, PDB);
+      FREELIST(pdb, PDB);
+   }
+
+   listBytes = (double)sizeof(PDB);
+   liteBytes = (double)sizeof(PDBLITEATOM) + 3.0 * sizeof(REAL) +
+               (natom ? (double)sizeof(PDBLITE) / natom : 0.0);
+
+   printf("File:                      %s\n", argv[1]);
+   printf("Repeats:                   %d\n", repeats);
+   printf("Atoms:                     %d\n", natom);
+   printf("Atoms identical:           %s\n", same ? "yes" : "NO");
+   printf("Bytes per atom:            %8.1f (PDB) %8.1f (PDBLITE)\n",
+          listBytes, liteBytes);
+   printf("Total memory:              %8.1fMB (PDB) %8.1fMB (PDBLITE)\n",
+          listBytes * natom / 1048576.0, liteBytes * natom / 1048576.0);
+   printf("blDoReadPDB():             %8.3fs per read\n",
+          tRead       / repeats);
+   printf("blDoReadPDBLite():         %8.3fs per read\n",
+          tReadLite   / repeats);
+   printf("blDoReadPDBMapped():       %8.3fs per read\n",
+          tMapped     / repeats);
+   printf("blDoReadPDBLiteMapped():   %8.3fs per read\n",
+          tMappedLite / repeats);
+   printf("blPDBToPDBLite():          %8.3fs per conversion\n",
+          tToLite     / repeats);
+   printf("blPDBLiteToPDB():          %8.3fs per conversion\n",
+          tFromLite   / repeats);
+
+   return(0);
+}
+
+/************************************************************************/
+/*>static BOOL SameAtoms(PDBLITE *lite, PDB *pdb)
+   ----------------------------------------------
+   Field by field comparison of a PDBLITE with a PDB linked list for the
+   fields that the PDBLITE keeps. Occupancies and B-values are held as
+   float so are compared to the precision of a PDB file.
+
+-  16.10.26 Original
+*/
+static BOOL SameAtoms(PDBLITE *lite, PDB *pdb)
+{
+   PDB p,
+       *q;
+   int i;
+
+   if(lite == NULL)
+      return(FALSE);
+
+   for(i=0, q=pdb; i<lite->natoms && q!=NULL; i++, NEXT(q))
+   {
+      blGetPDBLiteAtom(lite, i, &p);
+      if((p.atnum  != q->atnum)  || (p.resnum != q->resnum) ||
+         (p.x      != q->x)      || (p.y      != q->y)      ||
+         (p.z      != q->z)      || (p.altpos != q->altpos) ||
+         (fabs(p.occ  - q->occ)  > 0.001)                   ||
+         (fabs(p.bval - q->bval) > 0.001)                   ||
+         (p.formal_charge != q->formal_charge)              ||
+         strcmp(p.record_type, q->record_type)              ||
+         strcmp(p.atnam,       q->atnam)                    ||
+         strcmp(p.atnam_raw,   q->atnam_raw)                ||
+         strcmp(p.resnam,      q->resnam)                   ||
+         strcmp(p.chain,       q->chain)                    ||
+         strcmp(p.insert,      q->insert)                   ||
+         strcmp(p.element,     q->element))
+         return(FALSE);
+   }
+   return((i == lite->natoms) && (q == NULL));
+}
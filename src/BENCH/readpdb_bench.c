@@ -0,0 +1,221 @@
+/************************************************************************/
+/**
+
+   \file       readpdb_bench.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Benchmark the stdio and memory-mapped PDB readers
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Times three ways of getting the ATOM/HETATM records out of a PDB 
+   file:
+
+   1. fgets() and the fsscanf() format used by blDoReadPDB() before 
+      V2.37 (decoding only - no linked list is built)
+   2. blReadPDB()
+   3. blReadPDBMapped()
+
+   and checks that 2 and 3 give identical linked lists.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   readpdb_bench file.pdb [repeats]
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../SysDefs.h"
+#include "../MathType.h"
+#include "../pdb.h"
+#include "../fsscanf.h"
+#include "../macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ELAPSED(t) ((double)(clock() - (t)) / (double)CLOCKS_PER_SEC)
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+static double TimeFsscanf(char *filename, int *nrec);
+static BOOL SameList(PDB *pdb1, PDB *pdb2);
+
+/************************************************************************/
+int main(int argc, char **argv)
+{
+   int     repeats = 3,
+           i,
+           natom1  = 0,
+           natom2  = 0,
+           nrec    = 0;
+   double  tFsscanf = 0.0,
+           tStdio   = 0.0,
+           tMapped  = 0.0;
+   clock_t start;
+   FILE    *fp;
+   PDB     *pdb1 = NULL,
+           *pdb2 = NULL;
+
+   if(argc < 2)
+   {
+      fprintf(stderr,"Usage: readpdb_bench file.pdb [repeats]\n");
+      return(1);
+   }
+   if(argc > 2)
+      repeats = atoi(argv[2]);
+   
+   for(i=0; i<repeats; i++)
+   {
+      tFsscanf += TimeFsscanf(argv[1], &nrec);
+
+      if(pdb1 != NULL) FREELIST(pdb1, PDB);
+      if((fp=fopen(argv[1], "r"))==NULL)
+      {
+         fprintf(stderr,"Unable to open %s\n", argv[1]);
+         return(1);
+      }
+      start = clock();
+      pdb1  = blReadPDB(fp, &natom1);
+      tStdio += ELAPSED(start);
+      fclose(fp);
+
+      if(pdb2 != NULL) FREELIST(pdb2, PDB);
+      start = clock();
+      pdb2  = blReadPDBMapped(argv[1], &natom2);
+      tMapped += ELAPSED(start);
+   }
+
+   printf("File:              %s\n", argv[1]);
+   printf("Repeats:           %d\n", repeats);
+   printf("Atoms:             %d (stdio) %d (mapped)\n", natom1, natom2);
+   printf("Lists identical:   %s\n", 
+          ((natom1 == natom2) && SameList(pdb1, pdb2)) ? "yes" : "NO");
+   printf("fgets()+fsscanf(): %8.3fs per read (%d records, decode only)\n",
+          tFsscanf / repeats, nrec);
+   printf("blReadPDB():       %8.3fs per read\n", tStdio  / repeats);
+   printf("blReadPDBMapped(): %8.3fs per read\n", tMapped / repeats);
+
+   FREELIST(pdb1, PDB);
+   FREELIST(pdb2, PDB);
+   return(0);
+}
+
+/************************************************************************/
+/*>static double TimeFsscanf(char *filename, int *nrec)
+   ----------------------------------------------------
+   Time to decode every ATOM/HETATM record with the old fsscanf() format
+
+-  16.10.26 Original
+*/
+static double TimeFsscanf(char *filename, int *nrec)
+{
+   FILE    *fp;
+   char    buffer[160],
+           record_type[8],
+           atnambuff[8],
+           resnam[8],
+           chain[4],
+           insert[4],
+           element_buff[4],
+           charge_buff[4];
+   int     atnum, resnum;
+   double  x, y, z, occ, bval;
+   clock_t start;
+   
+   *nrec = 0;
+   if((fp=fopen(filename, "r"))==NULL)
+      return(0.0);
+
+   start = clock();
+   while(fgets(buffer,159,fp))
+   {
+      if(fsscanf(buffer,
+         "%6s%5d%1x%5s%4s%1s%4d%1s%3x%8lf%8lf%8lf%6lf%6lf%10x%2s%2s",
+                 record_type,&atnum,atnambuff,resnam,chain,&resnum,insert,
+                 &x,&y,&z,&occ,&bval,element_buff,charge_buff) != EOF)
+      {
+         if(!strncmp(record_type,"ATOM  ",6) ||
+            !strncmp(record_type,"HETATM",6))
+            (*nrec)++;
+      }
+   }
+   fclose(fp);
+   return(ELAPSED(start));
+}
+
+/************************************************************************/
+/*>static BOOL SameList(PDB *pdb1, PDB *pdb2)
+   ------------------------------------------
+   Field by field comparison of two PDB linked lists
+
+-  16.10.26 Original
+*/
+static BOOL SameList(PDB *pdb1, PDB *pdb2)
+{
+   PDB *p, *q;
+   
+   for(p=pdb1, q=pdb2; p!=NULL && q!=NULL; NEXT(p), NEXT(q))
+   {
+      if((p->atnum  != q->atnum)  || (p->resnum != q->resnum) ||
+         (p->x      != q->x)      || (p->y      != q->y)      ||
+         (p->z      != q->z)      || (p->occ    != q->occ)    ||
+         (p->bval   != q->bval)   || (p->altpos != q->altpos) ||
+         (p->formal_charge != q->formal_charge)               ||
+         strcmp(p->record_type, q->record_type)               ||
+         strcmp(p->atnam,       q->atnam)                     ||
+         strcmp(p->atnam_raw,   q->atnam_raw)                 ||
+         strcmp(p->resnam,      q->resnam)                    ||
+         strcmp(p->chain,       q->chain)                     ||
+         strcmp(p->insert,      q->insert)                    ||
+         strcmp(p->element,     q->element))
+         return(FALSE);
+   }
+   return((p == NULL) && (q == NULL));
+}
@@ -0,0 +1,975 @@
+/************************************************************************/
+/**
+
+   \file       BPDB.c
+   
+   \version    V1.2
+   \date       16.10.26
+   \brief      Binary PDB cache files (.bpdb)
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Reads and writes a compact binary form of a PDB linked list (and
+   optionally the header and trailer lines of a WHOLEPDB) which can be
+   loaded with a single read, or memory-mapped and converted to a
+   linked list lazily, without any text parsing. This is intended as a
+   cache for PDB files which are read repeatedly.
+
+   The file starts with a 32-byte header of 4-byte integers in the 
+   byte order of the machine that wrote it:
+      "BPDB"      Magic number
+      version     BPDB_VERSION
+      0x01020304  Byte order mark
+      recsize     Size of each atom record
+      natoms      Number of atom records
+      nheader     Number of header lines
+      ntrailer    Number of trailer lines
+      reserved    0
+   This is followed by natoms fixed-size atom records:
+      x, y, z, occ, bval, access, radius, partial_charge    8-byte reals
+      atnum, resnum, formal_charge                          4-byte ints
+      record_type, atnam, atnam_raw, resnam, insert, chain, 
+      element                                               8 chars each
+      altpos                                                1 char
+      (3 bytes padding)
+   and then the header and trailer lines, each as a 4-byte length 
+   followed by the characters.
+
+   Files are not portable between machines with different byte order;
+   such files are rejected. Later versions may add fields to the end of
+   the atom record: readers skip anything beyond the fields they know.
+   The atomType and extras pointers are not stored.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   fp = fopen("file.bpdb", "wb");
+   blWriteWholeBPDB(fp, wpdb);
+   ...
+   wpdb = blReadWholeBPDB(fp);   or   pdb = blReadBPDB(fp, &natoms);
+   ...
+   bpdb = blOpenBPDB("file.bpdb");
+   pdb  = blBPDBToPDB(bpdb, first, count, &natoms);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
+-  V1.2  16.10.26 Residue, atom and element codes are set on decoded
+                  atoms
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP File IO
+
+   #FUNCTION  blWriteBPDB()
+   Writes a PDB linked list as a binary .bpdb file
+
+   #FUNCTION  blWriteWholeBPDB()
+   Writes a WHOLEPDB (atoms, header and trailer) as a binary .bpdb file
+
+   #FUNCTION  blReadBPDB()
+   Reads a .bpdb file into a PDB linked list
+
+   #FUNCTION  blReadWholeBPDB()
+   Reads a .bpdb file into a WHOLEPDB structure
+
+   #FUNCTION  blOpenBPDB()
+   Memory-maps a .bpdb file so atoms can be converted to PDB records
+   only as they are needed
+
+   #FUNCTION  blGetBPDBAtom()
+   Copies one atom from an opened .bpdb file into a PDB record
+
+   #FUNCTION  blBPDBToPDB()
+   Builds a PDB linked list from a range of atoms in an opened .bpdb 
+   file
+
+   #FUNCTION  blGetBPDBHeader()
+   Gets the header lines from an opened .bpdb file
+
+   #FUNCTION  blGetBPDBTrailer()
+   Gets the trailer lines from an opened .bpdb file
+
+   #FUNCTION  blCloseBPDB()
+   Closes an opened .bpdb file
+*/
+/************************************************************************/
+/* Includes
+*/
+#include "port.h"    /* Required before stdio.h                         */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef NOMMAP
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#include "SysDefs.h"
+#include "MathType.h"
+#include "macros.h"
+#include "general.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BPDB_MAGIC      "BPDB"
+#define BPDB_BOM        0x01020304
+#define BPDB_HEADSIZE   32
+#define BPDB_RECSIZE_V1 136
+
+/* Offsets of the fields in the atom record                             */
+#define BPDB_OFF_REAL   0     /* 8 reals                                */
+#define BPDB_OFF_INT    64    /* 3 ints                                 */
+#define BPDB_OFF_STR    76    /* 7 strings of 8 characters              */
+#define BPDB_OFF_ALTPOS 132
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL DoWriteBPDB(FILE *fp, PDB *pdb, STRINGLIST *header,
+                        STRINGLIST *trailer);
+static BOOL WriteBPDBStrings(FILE *fp, STRINGLIST *strings);
+static BOOL CheckBPDBHeader(unsigned char *head, int *natoms, 
+                            int *nheader, int *ntrailer, int *recsize);
+static void EncodeBPDBAtom(PDB *p, unsigned char *rec);
+static void DecodeBPDBAtom(unsigned char *rec, PDB *p);
+static PDB *DecodeBPDBAtoms(unsigned char *buffer, int natoms, 
+                            int recsize, int *natom);
+static STRINGLIST *ReadBPDBStrings(FILE *fp, int nstrings, BOOL *ok);
+static STRINGLIST *GetBPDBStrings(BPDBFILE *bpdb, int skip, int nstrings);
+static void PutBPDBInt(unsigned char *buffer, int value);
+static int  GetBPDBInt(unsigned char *buffer);
+
+
+/************************************************************************/
+/*>BOOL blWriteBPDB(FILE *fp, PDB *pdb)
+   ------------------------------------
+*//**
+
+   \param[in]     *fp      File opened for binary writing
+   \param[in]     *pdb     PDB linked list
+   \return                 Success
+
+   Writes a PDB linked list as a binary .bpdb file
+
+-  16.10.26 Original
+*/
+BOOL blWriteBPDB(FILE *fp, PDB *pdb)
+{
+   return(DoWriteBPDB(fp, pdb, NULL, NULL));
+}
+
+
+/************************************************************************/
+/*>BOOL blWriteWholeBPDB(FILE *fp, WHOLEPDB *wpdb)
+   -----------------------------------------------
+*//**
+
+   \param[in]     *fp      File opened for binary writing
+   \param[in]     *wpdb    WHOLEPDB structure
+   \return                 Success
+
+   Writes the atoms, header and trailer of a WHOLEPDB as a binary .bpdb
+   file
+
+-  16.10.26 Original
+*/
+BOOL blWriteWholeBPDB(FILE *fp, WHOLEPDB *wpdb)
+{
+   return(DoWriteBPDB(fp, wpdb->pdb, wpdb->header, wpdb->trailer));
+}
+
+
+/************************************************************************/
+/*>PDB *blReadBPDB(FILE *fp, int *natom)
+   -------------------------------------
+*//**
+
+   \param[in]     *fp      File opened for binary reading
+   \param[out]    *natom   Number of atoms read. -1 if error.
+   \return                 A pointer to the first allocated item of
+                           the PDB linked list
+
+   Reads a .bpdb file into a PDB linked list. All the atom records are
+   read with a single fread(). Header and trailer lines are skipped.
+
+-  16.10.26 Original
+*/
+PDB *blReadBPDB(FILE *fp, int *natom)
+{
+   unsigned char head[BPDB_HEADSIZE],
+                 *buffer;
+   int           natoms, nheader, ntrailer, recsize;
+   PDB           *pdb;
+
+   *natom = (-1);
+
+   if((fread(head, 1, BPDB_HEADSIZE, fp) != BPDB_HEADSIZE) ||
+      !CheckBPDBHeader(head, &natoms, &nheader, &ntrailer, &recsize))
+      return(NULL);
+
+   if(natoms == 0)
+   {
+      *natom = 0;
+      return(NULL);
+   }
+   
+   if((buffer = (unsigned char *)malloc((size_t)natoms * recsize))==NULL)
+      return(NULL);
+
+   if(fread(buffer, recsize, natoms, fp) != (size_t)natoms)
+   {
+      free(buffer);
+      return(NULL);
+   }
+
+   pdb = DecodeBPDBAtoms(buffer, natoms, recsize, natom);
+   free(buffer);
+   
+   return(pdb);
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *blReadWholeBPDB(FILE *fp)
+   -----------------------------------
+*//**
+
+   \param[in]     *fp      File opened for binary reading
+   \return                 WHOLEPDB structure. NULL on error
+
+   Reads a .bpdb file into a WHOLEPDB structure, including any header
+   and trailer lines.
+
+-  16.10.26 Original
+*/
+WHOLEPDB *blReadWholeBPDB(FILE *fp)
+{
+   unsigned char head[BPDB_HEADSIZE],
+                 *buffer = NULL;
+   int           natoms, nheader, ntrailer, recsize;
+   BOOL          ok = TRUE;
+   WHOLEPDB      *wpdb;
+
+   if((fread(head, 1, BPDB_HEADSIZE, fp) != BPDB_HEADSIZE) ||
+      !CheckBPDBHeader(head, &natoms, &nheader, &ntrailer, &recsize))
+      return(NULL);
+
+   if((wpdb=(WHOLEPDB *)malloc(sizeof(WHOLEPDB)))==NULL)
+      return(NULL);
+
+   wpdb->pdb     = NULL;
+   wpdb->header  = NULL;
+   wpdb->trailer = NULL;
+   wpdb->natoms  = 0;
+
+   if(natoms > 0)
+   {
+      if(((buffer = (unsigned char *)malloc((size_t)natoms * recsize))
+          ==NULL) ||
+         (fread(buffer, recsize, natoms, fp) != (size_t)natoms))
+      {
+         if(buffer != NULL) free(buffer);
+         free(wpdb);
+         return(NULL);
+      }
+      
+      wpdb->pdb = DecodeBPDBAtoms(buffer, natoms, recsize, 
+                                  &(wpdb->natoms));
+      free(buffer);
+      if(wpdb->pdb == NULL)
+      {
+         free(wpdb);
+         return(NULL);
+      }
+   }
+
+   wpdb->header = ReadBPDBStrings(fp, nheader, &ok);
+   if(ok)
+      wpdb->trailer = ReadBPDBStrings(fp, ntrailer, &ok);
+
+   if(!ok)
+   {
+      blFreeWholePDB(wpdb);
+      return(NULL);
+   }
+
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>BPDBFILE *blOpenBPDB(char *filename)
+   ------------------------------------
+*//**
+
+   \param[in]     *filename  Name of .bpdb file
+   \return                   Opened file. NULL on error or if this is 
+                             not a valid .bpdb file
+
+   Memory-maps a .bpdb file (or reads it into memory where memory 
+   mapping is not available). Nothing is decoded until atoms are
+   requested with blGetBPDBAtom() or blBPDBToPDB(), so opening is 
+   essentially instant however big the file. Close with blCloseBPDB().
+
+-  16.10.26 Original
+*/
+BPDBFILE *blOpenBPDB(char *filename)
+{
+   BPDBFILE    *bpdb;
+   struct stat statbuf;
+   int         recsize;
+#ifdef NOMMAP
+   FILE        *fp;
+#else
+   int         fd;
+#endif
+   
+   if((bpdb = (BPDBFILE *)malloc(sizeof(BPDBFILE)))==NULL)
+      return(NULL);
+   bpdb->buffer = NULL;
+   bpdb->length = 0;
+
+#ifdef NOMMAP
+   if((fp=fopen(filename, "rb"))==NULL)
+   {
+      free(bpdb);
+      return(NULL);
+   }
+   if((stat(filename, &statbuf) != 0) ||
+      ((bpdb->buffer = (unsigned char *)malloc(statbuf.st_size+1))
+       ==NULL))
+   {
+      fclose(fp);
+      free(bpdb);
+      return(NULL);
+   }
+   bpdb->length = (long)fread(bpdb->buffer, 1, statbuf.st_size, fp);
+   fclose(fp);
+#else
+   if((fd = open(filename, O_RDONLY)) == (-1))
+   {
+      free(bpdb);
+      return(NULL);
+   }
+   if((fstat(fd, &statbuf) != 0) || (statbuf.st_size < BPDB_HEADSIZE))
+   {
+      close(fd);
+      free(bpdb);
+      return(NULL);
+   }
+   bpdb->length = (long)statbuf.st_size;
+   if((bpdb->buffer = (unsigned char *)mmap(NULL, (size_t)bpdb->length,
+                                            PROT_READ, MAP_PRIVATE, 
+                                            fd, 0)) == MAP_FAILED)
+   {
+      close(fd);
+      free(bpdb);
+      return(NULL);
+   }
+   close(fd);
+#endif
+
+   if((bpdb->length < BPDB_HEADSIZE) ||
+      !CheckBPDBHeader(bpdb->buffer, &(bpdb->natoms), &(bpdb->nheader),
+                       &(bpdb->ntrailer), &recsize) ||
+      (bpdb->length < BPDB_HEADSIZE + (long)bpdb->natoms * recsize))
+   {
+      blCloseBPDB(bpdb);
+      return(NULL);
+   }
+   bpdb->recsize = recsize;
+   
+   return(bpdb);
+}
+
+
+/************************************************************************/
+/*>BOOL blGetBPDBAtom(BPDBFILE *bpdb, int atom, PDB *p)
+   ----------------------------------------------------
+*//**
+
+   \param[in]     *bpdb      Opened .bpdb file
+   \param[in]     atom       Atom number (counting from 0)
+   \param[out]    *p         PDB record to fill in
+   \return                   FALSE if atom is out of range
+
+   Decodes a single atom. p->next, p->extras and p->atomType are set
+   to NULL.
+
+-  16.10.26 Original
+*/
+BOOL blGetBPDBAtom(BPDBFILE *bpdb, int atom, PDB *p)
+{
+   if((atom < 0) || (atom >= bpdb->natoms))
+      return(FALSE);
+   
+   DecodeBPDBAtom(bpdb->buffer + BPDB_HEADSIZE + 
+                  (long)atom * bpdb->recsize, p);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>PDB *blBPDBToPDB(BPDBFILE *bpdb, int first, int count, int *natom)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     *bpdb      Opened .bpdb file
+   \param[in]     first      First atom (counting from 0)
+   \param[in]     count      Number of atoms. 0 (or too many) for all
+                             the remaining atoms
+   \param[out]    *natom     Number of atoms in the list. -1 if error
+   \return                   PDB linked list
+
+   Builds a linked list from a range of atoms in an opened .bpdb file.
+   The list is independent of the file and may be kept after 
+   blCloseBPDB().
+
+-  16.10.26 Original
+*/
+PDB *blBPDBToPDB(BPDBFILE *bpdb, int first, int count, int *natom)
+{
+   if((first < 0) || (first > bpdb->natoms))
+   {
+      *natom = (-1);
+      return(NULL);
+   }
+
+   if((count <= 0) || (count > bpdb->natoms - first))
+      count = bpdb->natoms - first;
+
+   if(count == 0)
+   {
+      *natom = 0;
+      return(NULL);
+   }
+
+   return(DecodeBPDBAtoms(bpdb->buffer + BPDB_HEADSIZE + 
+                          (long)first * bpdb->recsize,
+                          count, bpdb->recsize, natom));
+}
+
+
+/************************************************************************/
+/*>STRINGLIST *blGetBPDBHeader(BPDBFILE *bpdb)
+   -------------------------------------------
+*//**
+
+   \param[in]     *bpdb      Opened .bpdb file
+   \return                   Header lines (NULL if none)
+
+   Gets the WHOLEPDB header lines from an opened .bpdb file. Free with
+   blFreeStringList()
+
+-  16.10.26 Original
+*/
+STRINGLIST *blGetBPDBHeader(BPDBFILE *bpdb)
+{
+   return(GetBPDBStrings(bpdb, 0, bpdb->nheader));
+}
+
+
+/************************************************************************/
+/*>STRINGLIST *blGetBPDBTrailer(BPDBFILE *bpdb)
+   --------------------------------------------
+*//**
+
+   \param[in]     *bpdb      Opened .bpdb file
+   \return                   Trailer lines (NULL if none)
+
+   Gets the WHOLEPDB trailer lines from an opened .bpdb file. Free with
+   blFreeStringList()
+
+-  16.10.26 Original
+*/
+STRINGLIST *blGetBPDBTrailer(BPDBFILE *bpdb)
+{
+   return(GetBPDBStrings(bpdb, bpdb->nheader, bpdb->ntrailer));
+}
+
+
+/************************************************************************/
+/*>void blCloseBPDB(BPDBFILE *bpdb)
+   --------------------------------
+*//**
+
+   \param[in]     *bpdb      Opened .bpdb file
+
+   Unmaps and frees an opened .bpdb file
+
+-  16.10.26 Original
+*/
+void blCloseBPDB(BPDBFILE *bpdb)
+{
+   if(bpdb == NULL)
+      return;
+
+   if(bpdb->buffer != NULL)
+   {
+#ifdef NOMMAP
+      free(bpdb->buffer);
+#else
+      munmap((void *)bpdb->buffer, (size_t)bpdb->length);
+#endif
+   }
+   free(bpdb);
+}
+
+
+/************************************************************************/
+/*>static BOOL DoWriteBPDB(FILE *fp, PDB *pdb, STRINGLIST *header,
+                           STRINGLIST *trailer)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *fp        Output file
+   \param[in]     *pdb       PDB linked list
+   \param[in]     *header    Header lines (or NULL)
+   \param[in]     *trailer   Trailer lines (or NULL)
+   \return                   Success
+
+   Does the work for blWriteBPDB() and blWriteWholeBPDB()
+
+-  16.10.26 Original
+*/
+static BOOL DoWriteBPDB(FILE *fp, PDB *pdb, STRINGLIST *header,
+                        STRINGLIST *trailer)
+{
+   unsigned char head[BPDB_HEADSIZE],
+                 rec[BPDB_RECSIZE_V1];
+   int           natoms   = 0,
+                 nheader  = 0,
+                 ntrailer = 0;
+   PDB           *p;
+   STRINGLIST    *s;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      natoms++;
+   for(s=header; s!=NULL; NEXT(s))
+      nheader++;
+   for(s=trailer; s!=NULL; NEXT(s))
+      ntrailer++;
+   
+   memset(head, 0, BPDB_HEADSIZE);
+   memcpy(head, BPDB_MAGIC, 4);
+   PutBPDBInt(head+4,  BPDB_VERSION);
+   PutBPDBInt(head+8,  BPDB_BOM);
+   PutBPDBInt(head+12, BPDB_RECSIZE_V1);
+   PutBPDBInt(head+16, natoms);
+   PutBPDBInt(head+20, nheader);
+   PutBPDBInt(head+24, ntrailer);
+
+   if(fwrite(head, 1, BPDB_HEADSIZE, fp) != BPDB_HEADSIZE)
+      return(FALSE);
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      EncodeBPDBAtom(p, rec);
+      if(fwrite(rec, 1, BPDB_RECSIZE_V1, fp) != BPDB_RECSIZE_V1)
+         return(FALSE);
+   }
+
+   if(!WriteBPDBStrings(fp, header) || !WriteBPDBStrings(fp, trailer))
+      return(FALSE);
+
+   return(ferror(fp) ? FALSE : TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteBPDBStrings(FILE *fp, STRINGLIST *strings)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     *fp        Output file
+   \param[in]     *strings   Lines to write
+   \return                   Success
+
+   Writes each string as a length followed by the characters
+
+-  16.10.26 Original
+*/
+static BOOL WriteBPDBStrings(FILE *fp, STRINGLIST *strings)
+{
+   unsigned char buffer[4];
+   STRINGLIST    *s;
+   int           len;
+   
+   for(s=strings; s!=NULL; NEXT(s))
+   {
+      len = (s->string == NULL) ? 0 : strlen(s->string);
+      PutBPDBInt(buffer, len);
+      if((fwrite(buffer, 1, 4, fp) != 4) ||
+         ((len > 0) && (fwrite(s->string, 1, len, fp) != (size_t)len)))
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL CheckBPDBHeader(unsigned char *head, int *natoms, 
+                               int *nheader, int *ntrailer, int *recsize)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in]     *head      The 32-byte file header
+   \param[out]    *natoms    Number of atoms
+   \param[out]    *nheader   Number of header lines
+   \param[out]    *ntrailer  Number of trailer lines
+   \param[out]    *recsize   Size of each atom record
+   \return                   Is this a .bpdb file we can read?
+
+-  16.10.26 Original
+*/
+static BOOL CheckBPDBHeader(unsigned char *head, int *natoms, 
+                            int *nheader, int *ntrailer, int *recsize)
+{
+   if(memcmp(head, BPDB_MAGIC, 4)                ||
+      (GetBPDBInt(head+4)  <  1)                 ||
+      (GetBPDBInt(head+4)  >  BPDB_VERSION)      ||
+      (GetBPDBInt(head+8)  != BPDB_BOM)          ||
+      (GetBPDBInt(head+12) <  BPDB_RECSIZE_V1))
+      return(FALSE);
+
+   *recsize  = GetBPDBInt(head+12);
+   *natoms   = GetBPDBInt(head+16);
+   *nheader  = GetBPDBInt(head+20);
+   *ntrailer = GetBPDBInt(head+24);
+
+   return((*natoms >= 0) && (*nheader >= 0) && (*ntrailer >= 0));
+}
+
+
+/************************************************************************/
+/*>static void EncodeBPDBAtom(PDB *p, unsigned char *rec)
+   ------------------------------------------------------
+*//**
+
+   \param[in]     *p         PDB record
+   \param[out]    *rec       Binary atom record
+
+-  16.10.26 Original
+*/
+static void EncodeBPDBAtom(PDB *p, unsigned char *rec)
+{
+   double        reals[8];
+   unsigned char *str = rec + BPDB_OFF_STR;
+
+   reals[0] = (double)p->x;
+   reals[1] = (double)p->y;
+   reals[2] = (double)p->z;
+   reals[3] = (double)p->occ;
+   reals[4] = (double)p->bval;
+   reals[5] = (double)p->access;
+   reals[6] = (double)p->radius;
+   reals[7] = (double)p->partial_charge;
+   memcpy(rec + BPDB_OFF_REAL, reals, 8*sizeof(double));
+
+   PutBPDBInt(rec + BPDB_OFF_INT,     p->atnum);
+   PutBPDBInt(rec + BPDB_OFF_INT + 4, p->resnum);
+   PutBPDBInt(rec + BPDB_OFF_INT + 8, p->formal_charge);
+
+   /* strncpy() pads with nulls so the file contents are repeatable     */
+   strncpy((char *)str,    p->record_type, 8);
+   strncpy((char *)str+8,  p->atnam,       8);
+   strncpy((char *)str+16, p->atnam_raw,   8);
+   strncpy((char *)str+24, p->resnam,      8);
+   strncpy((char *)str+32, p->insert,      8);
+   strncpy((char *)str+40, p->chain,       8);
+   strncpy((char *)str+48, p->element,     8);
+
+   rec[BPDB_OFF_ALTPOS]   = (unsigned char)p->altpos;
+   rec[BPDB_OFF_ALTPOS+1] = '\0';
+   rec[BPDB_OFF_ALTPOS+2] = '\0';
+   rec[BPDB_OFF_ALTPOS+3] = '\0';
+}
+
+
+/************************************************************************/
+/*>static void DecodeBPDBAtom(unsigned char *rec, PDB *p)
+   ------------------------------------------------------
+*//**
+
+   \param[in]     *rec       Binary atom record
+   \param[out]    *p         PDB record
+
+-  16.10.26 Original
+*/
+static void DecodeBPDBAtom(unsigned char *rec, PDB *p)
+{
+   double        reals[8];
+   unsigned char *str = rec + BPDB_OFF_STR;
+
+   memcpy(reals, rec + BPDB_OFF_REAL, 8*sizeof(double));
+   p->x              = (REAL)reals[0];
+   p->y              = (REAL)reals[1];
+   p->z              = (REAL)reals[2];
+   p->occ            = (REAL)reals[3];
+   p->bval           = (REAL)reals[4];
+   p->access         = (REAL)reals[5];
+   p->radius         = (REAL)reals[6];
+   p->partial_charge = (REAL)reals[7];
+
+   p->atnum          = GetBPDBInt(rec + BPDB_OFF_INT);
+   p->resnum         = GetBPDBInt(rec + BPDB_OFF_INT + 4);
+   p->formal_charge  = GetBPDBInt(rec + BPDB_OFF_INT + 8);
+
+   memcpy(p->record_type, str,    8);
+   memcpy(p->atnam,       str+8,  8);
+   memcpy(p->atnam_raw,   str+16, 8);
+   memcpy(p->resnam,      str+24, 8);
+   memcpy(p->insert,      str+32, 8);
+   memcpy(p->chain,       str+40, 8);
+   memcpy(p->element,     str+48, 8);
+   /* Make sure strings are terminated even if the file is corrupt      */
+   p->record_type[7] = p->atnam[7]  = p->atnam_raw[7] = p->resnam[7] =
+      p->insert[7]   = p->chain[7]  = p->element[7]   = '\0';
+
+   p->altpos   = (char)rec[BPDB_OFF_ALTPOS];
+   p->extras   = NULL;
+   p->atomType = NULL;
+   p->next     = NULL;
+   blSetPDBCodes(p);
+}
+
+
+/************************************************************************/
+/*>static PDB *DecodeBPDBAtoms(unsigned char *buffer, int natoms, 
+                               int recsize, int *natom)
+   --------------------------------------------------------------
+*//**
+
+   \param[in]     *buffer    First binary atom record
+   \param[in]     natoms     Number of records
+   \param[in]     recsize    Size of each record
+   \param[out]    *natom     Number of atoms in the list. -1 on error
+   \return                   PDB linked list
+
+   Builds a linked list from consecutive binary atom records
+
+-  16.10.26 Original
+*/
+static PDB *DecodeBPDBAtoms(unsigned char *buffer, int natoms, 
+                            int recsize, int *natom)
+{
+   PDB *pdb = NULL,
+       *p   = NULL;
+   int i;
+   
+   for(i=0; i<natoms; i++)
+   {
+      if(pdb == NULL)
+      {
+         INITPDB(pdb);
+         p = pdb;
+      }
+      else
+      {
+         ALLOCNEXTPDB(p);
+      }
+      
+      if(p == NULL)
+      {
+         if(pdb != NULL) FREEPDBLIST(pdb);
+         *natom = (-1);
+         return(NULL);
+      }
+
+      DecodeBPDBAtom(buffer + (long)i * recsize, p);
+   }
+
+   *natom = natoms;
+   return(pdb);
+}
+
+
+/************************************************************************/
+/*>static STRINGLIST *ReadBPDBStrings(FILE *fp, int nstrings, BOOL *ok)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]     *fp        Input file
+   \param[in]     nstrings   Number of strings to read
+   \param[out]    *ok        Success
+   \return                   List of strings
+
+-  16.10.26 Original
+*/
+static STRINGLIST *ReadBPDBStrings(FILE *fp, int nstrings, BOOL *ok)
+{
+   STRINGLIST    *strings = NULL;
+   unsigned char buffer[4];
+   char          *string;
+   int           i, len;
+
+   *ok = TRUE;
+   for(i=0; i<nstrings; i++)
+   {
+      if((fread(buffer, 1, 4, fp) != 4) ||
+         ((len = GetBPDBInt(buffer)) < 0) ||
+         ((string = (char *)malloc((len+1) * sizeof(char)))==NULL))
+      {
+         *ok = FALSE;
+         break;
+      }
+      
+      if(fread(string, 1, len, fp) != (size_t)len)
+      {
+         free(string);
+         *ok = FALSE;
+         break;
+      }
+      string[len] = '\0';
+      
+      strings = blStoreString(strings, string);
+      free(string);
+      if(strings == NULL)
+      {
+         *ok = FALSE;
+         break;
+      }
+   }
+
+   if(!(*ok) && (strings != NULL))
+   {
+      blFreeStringList(strings);
+      strings = NULL;
+   }
+   return(strings);
+}
+
+
+/************************************************************************/
+/*>static STRINGLIST *GetBPDBStrings(BPDBFILE *bpdb, int skip, 
+                                     int nstrings)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *bpdb      Opened .bpdb file
+   \param[in]     skip       Number of strings to skip
+   \param[in]     nstrings   Number of strings to get
+   \return                   List of strings. NULL on error
+
+-  16.10.26 Original
+*/
+static STRINGLIST *GetBPDBStrings(BPDBFILE *bpdb, int skip, int nstrings)
+{
+   STRINGLIST *strings = NULL;
+   long       offset;
+   char       *string;
+   int        i, len;
+
+   offset = BPDB_HEADSIZE + (long)bpdb->natoms * bpdb->recsize;
+   for(i=0; i<skip+nstrings; i++)
+   {
+      if((offset + 4 > bpdb->length) ||
+         ((len = GetBPDBInt(bpdb->buffer + offset)) < 0) ||
+         (offset + 4 + len > bpdb->length))
+         break;
+      offset += 4;
+      
+      if(i >= skip)
+      {
+         if((string = (char *)malloc((len+1) * sizeof(char)))==NULL)
+            break;
+         memcpy(string, bpdb->buffer + offset, len);
+         string[len] = '\0';
+         strings = blStoreString(strings, string);
+         free(string);
+         if(strings == NULL)
+            return(NULL);
+      }
+      offset += len;
+   }
+
+   if((i < skip+nstrings) && (strings != NULL))
+   {
+      blFreeStringList(strings);
+      strings = NULL;
+   }
+   return(strings);
+}
+
+
+/************************************************************************/
+/*>static void PutBPDBInt(unsigned char *buffer, int value)
+   --------------------------------------------------------
+*//**
+
+   \param[out]    *buffer    Where to store the integer (4 bytes)
+   \param[in]     value      The integer
+
+   Stores a 4-byte integer in machine byte order without worrying about
+   alignment
+
+-  16.10.26 Original
+*/
+static void PutBPDBInt(unsigned char *buffer, int value)
+{
+   memcpy(buffer, &value, 4);
+}
+
+
+/************************************************************************/
+/*>static int GetBPDBInt(unsigned char *buffer)
+   --------------------------------------------
+*//**
+
+   \param[in]     *buffer    A 4-byte integer in machine byte order
+   \return                   The integer
+
+-  16.10.26 Original
+*/
+static int GetBPDBInt(unsigned char *buffer)
+{
+   int value;
+   memcpy(&value, buffer, 4);
+   return(value);
+}
@@ -3,8 +3,8 @@
 
    \file       BuildAtomNeighbourPDBList.c
    
-   \version    V1.4
-   \date       19.08.14
+   \version    V1.7
+   \date       16.10.26
    \brief      Build a new PDB linked list containing atos within a given
                distance of a specified residue
    
@@ -54,6 +54,13 @@
 -  V1.3  07.07.14 Use bl prefix for functions By: CTP
 -  V1.4  19.08.14 Renamed blBuildAtomNeighbourPDBListAsCopy to 
                   blBuildAtomNeighbourPDBListAsCopy() By: CTP
+-  V1.5  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
+-  V1.6  16.10.26 Uses a cell list rather than duplicating the structure
+                  and testing every atom
+-  V1.7  16.10.26 Scans the structure once against a box round the 
+                  residue rather than building a cell list, so atoms 
+                  with no coordinates are handled as before
 
 *************************************************************************/
 /* Doxygen
@@ -99,7 +106,14 @@
                               (NULL if allocations failed)
 
    Builds a PDB linked list of atoms neighbouring those in a specified
-   residue. The input list is unmodified.
+   residue. The input list is unmodified. The occupancy of each atom in
+   the returned list is set to 1.0.
+
+   Each atom is tested against the residue's atoms only if it lies in
+   the box round the residue, so the time is proportional to the size
+   of the structure. When neighbours of many residues are needed, build
+   a PDBCELLLIST once with blBuildPDBCellList() and use 
+   blFindPDBResidueNeighbours() instead.
 
 -  27.08.96 Original   By: ACRM
 -  17.11.05 Fixed freed memory access
@@ -109,67 +123,80 @@
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.08.14 Renamed function to blBuildAtomNeighbourPDBListAsCopy() 
             By: CTP
+-  16.10.26 Uses a cell list to find the neighbours and copies only
+            those atoms rather than duplicating the whole structure
+-  16.10.26 Scans the structure against a box round the residue rather
+            than building a cell list for a single query. Atoms with 
+            no coordinates are treated as before
 */
 PDB *blBuildAtomNeighbourPDBListAsCopy(PDB *pdb, PDB *pRes, 
                                        REAL NeighbDist)
 {
    PDB  *pdbN  = NULL,
-        *prev  = NULL,
-        *p, *q,
-        *pNext = NULL;
-   REAL DCutSq = NeighbDist * NeighbDist;
-   
-   /* First, simply duplicate the PDB linked list                       */
-   if(!(pdbN = blDupePDB(pdb)))
-      return(NULL);
-
-   /* We'll use the Occ column as a flag                                */
-   for(p=pdbN; p!=NULL; NEXT(p))
-      p->occ = 0.0;
+        *pNext,
+        *p, *q = NULL,
+        *r;
+   REAL DCutSq = NeighbDist * NeighbDist,
+        lo[3], hi[3];
+   BOOL near;
    
-   /* Find the atom after the residue in which we are interested        */
-   pNext = blFindNextResidue(pRes);
-
-   /* Look at each atom in our residue in turn flagging atoms in the
-      duplicate list which are in range
+   /* Find the atom after the residue in which we are interested and
+      the box round the residue extended by the cutoff
    */
-   for(p=pRes; p!=pNext; NEXT(p))
+   pNext = blFindNextResidue(pRes);
+   lo[0] = hi[0] = pRes->x;
+   lo[1] = hi[1] = pRes->y;
+   lo[2] = hi[2] = pRes->z;
+   for(r=pRes; r!=pNext; NEXT(r))
    {
-      for(q=pdbN; q!=NULL; NEXT(q))
-      {
-         if(DISTSQ(p,q) <= DCutSq)
-            q->occ = (REAL)1.0;
-      }
+      lo[0] = MIN(lo[0], r->x);   hi[0] = MAX(hi[0], r->x);
+      lo[1] = MIN(lo[1], r->y);   hi[1] = MAX(hi[1], r->y);
+      lo[2] = MIN(lo[2], r->z);   hi[2] = MAX(hi[2], r->z);
    }
-   
-   /* Now run through the linked list removing any items which do not
-      have the Occ flag set
-   */
-   for(p=pdbN, prev=NULL; p!=NULL;)
+   lo[0] -= NeighbDist;   hi[0] += NeighbDist;
+   lo[1] -= NeighbDist;   hi[1] += NeighbDist;
+   lo[2] -= NeighbDist;   hi[2] += NeighbDist;
+
+   /* Copy each atom in the box within range of an atom in the residue */
+   for(p=pdb; p!=NULL; NEXT(p))
    {
-      if(p->occ < (REAL)0.5)
+      if((p->x < lo[0]) || (p->x > hi[0]) ||
+         (p->y < lo[1]) || (p->y > hi[1]) ||
+         (p->z < lo[2]) || (p->z > hi[2]))
+         continue;
+
+      near = FALSE;
+      for(r=pRes; r!=pNext; NEXT(r))
       {
-         if(prev==NULL)
+         if(DISTSQ(p,r) <= DCutSq)
          {
-            pdbN = p->next;
-            free(p);
-            p=pdbN;
-            continue;
-         }
-         else
-         {
-            prev->next = p->next;
-            free(p);
-            p=prev->next;   /* 17.11.05              Fixed from p->next */
-            continue;
+            near = TRUE;
+            break;
          }
       }
-      prev = p;
-      NEXT(p);
+      if(!near)
+         continue;
+
+      if(pdbN == NULL)
+      {
+         INITPDB(pdbN);
+         q = pdbN;
+      }
+      else
+      {
+         ALLOCNEXTPDB(q);
+      }
+      if(q == NULL)
+      {
+         FREEPDBLIST(pdbN);
+         return(NULL);
+      }
+
+      blCopyPDB(q, p);
+      /* Atoms were previously flagged using the occupancy              */
+      q->occ = (REAL)1.0;
    }
 
    /* Return the reduced list                                           */
    return(pdbN);
 }
-
-
@@ -0,0 +1,637 @@
+/************************************************************************/
+/**
+
+   \file       CellList.c
+   
+   \version    V1.1
+   \date       16.10.26
+   \brief      Cell list neighbour searching for PDB linked lists
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   A uniform grid (cell list) over the atoms of a PDB linked list for
+   finding the atoms within a given distance of a point, an atom or a
+   residue. The grid is built once per structure in O(N) time using a
+   counting sort of the atoms into cells, so that each cell's atoms are
+   stored contiguously. Each query then only examines the cells that
+   overlap the search sphere.
+
+   Queries return the indexes of the matching atoms (in the order they
+   appear in the linked list) in an array which is allocated or grown
+   as needed and may be re-used between queries. The PDB node for an
+   index i is celllist->coords->atom[i].
+
+   Atoms with any coordinate of 9999.0 or more are treated as having no
+   coordinates and are not placed in the grid.
+
+   Residue queries use a per-grid marker array so must not be made from
+   more than one thread at a time. Point and atom queries do not change
+   the PDBCELLLIST and may be made from several threads at once.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   PDBCELLLIST *cl;
+   int         *atoms   = NULL,
+               maxatoms = 0,
+               n, i;
+   
+   cl = blBuildPDBCellList(pdb, 4.0);
+   for(res=pdb; res!=NULL; res=blFindNextResidue(res))
+   {
+      n = blFindPDBResidueNeighbours(cl, res, 4.0, &atoms, &maxatoms);
+      for(i=0; i<n; i++)
+         ... cl->coords->atom[atoms[i]] ...
+   }
+   free(atoms);
+   blFreePDBCellList(cl);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Point and atom queries no longer use the markers so
+                  may be made from several threads
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Searching the PDB linked list
+
+   #FUNCTION  blBuildPDBCellList()
+   Builds a cell list over the atoms of a PDB linked list
+
+   #FUNCTION  blFreePDBCellList()
+   Frees a cell list
+
+   #FUNCTION  blFindPDBPointNeighbours()
+   Finds the atoms within a distance of a point
+
+   #FUNCTION  blFindPDBAtomNeighbours()
+   Finds the atoms within a distance of an atom
+
+   #FUNCTION  blFindPDBResidueNeighbours()
+   Finds the atoms within a distance of any atom in a residue
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <math.h>
+
+#include "SysDefs.h"
+#include "MathType.h"
+#include "macros.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NOTSET        (REAL)9999.0
+#define MAXCELLFACTOR 8      /* Grid is coarsened if it has more than
+                                this many cells per atom               */
+#define MINCELLS      1000   /*    (or this many cells in total)       */
+#define ATOM_ALLOCQUANT 64
+
+#define HASCOORDS(x, y, z) ((x) < NOTSET && (y) < NOTSET && (z) < NOTSET)
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static int CellIndex(PDBCELLLIST *cl, REAL x, REAL y, REAL z);
+static void CellRange(PDBCELLLIST *cl, REAL coord, REAL min, int n, 
+                      REAL dist, int *lo, int *hi);
+static BOOL AddAtom(int atom, int **atoms, int *maxatoms, int natoms);
+static int FindNeighbours(PDBCELLLIST *cl, REAL x, REAL y, REAL z, 
+                          REAL dist, int **atoms, int *maxatoms, 
+                          int natoms, BOOL useMarks);
+static int CompareInts(const void *a, const void *b);
+static void NextStamp(PDBCELLLIST *cl);
+
+
+/************************************************************************/
+/*>PDBCELLLIST *blBuildPDBCellList(PDB *pdb, REAL cellsize)
+   -------------------------------------------------------
+*//**
+
+   \param[in]     *pdb       PDB linked list
+   \param[in]     cellsize   Edge of each cell. Normally the distance
+                             cutoff that will be used for queries
+   \return                   The cell list (NULL if out of memory or
+                             there are no atoms)
+
+   Builds a uniform grid over the atoms. Queries are most efficient
+   when the query distance is the same as cellsize, but any distance
+   may be used. If the grid would be very sparse (more than 
+   MAXCELLFACTOR cells per atom), the cell size is increased.
+
+-  16.10.26 Original
+*/
+PDBCELLLIST *blBuildPDBCellList(PDB *pdb, REAL cellsize)
+{
+   PDBCELLLIST *cl;
+   PDBCOORDS   *coords;
+   REAL        xmax, ymax, zmax;
+   int         i, c, 
+               ngrid = 0;
+   BOOL        first = TRUE;
+
+   if((cellsize <= (REAL)0.0) || 
+      ((coords = blGetPDBCoords(pdb))==NULL))
+      return(NULL);
+
+   if((cl = (PDBCELLLIST *)malloc(sizeof(PDBCELLLIST)))==NULL)
+   {
+      blFreePDBCoords(coords);
+      return(NULL);
+   }
+   cl->coords    = coords;
+   cl->cellStart = NULL;
+   cl->cellAtoms = NULL;
+   cl->cellOf    = NULL;
+   cl->mark      = NULL;
+   cl->stamp     = 0;
+   cl->xmin = cl->ymin = cl->zmin = (REAL)0.0;
+   xmax     = ymax     = zmax     = (REAL)0.0;
+
+   /* Find the bounding box of the atoms that have coordinates          */
+   for(i=0; i<coords->natoms; i++)
+   {
+      REAL x = coords->x[i],
+           y = coords->y[i],
+           z = coords->z[i];
+      
+      if(!HASCOORDS(x, y, z))
+         continue;
+      ngrid++;
+      
+      if(first)
+      {
+         cl->xmin = xmax = x;
+         cl->ymin = ymax = y;
+         cl->zmin = zmax = z;
+         first    = FALSE;
+      }
+      else
+      {
+         if(x < cl->xmin) cl->xmin = x;
+         if(y < cl->ymin) cl->ymin = y;
+         if(z < cl->zmin) cl->zmin = z;
+         if(x > xmax)     xmax     = x;
+         if(y > ymax)     ymax     = y;
+         if(z > zmax)     zmax     = z;
+      }
+   }
+
+   /* Size the grid, coarsening it if it would be too sparse            */
+   for(;;)
+   {
+      double ncells;
+      
+      cl->nx = (int)((xmax - cl->xmin) / cellsize) + 1;
+      cl->ny = (int)((ymax - cl->ymin) / cellsize) + 1;
+      cl->nz = (int)((zmax - cl->zmin) / cellsize) + 1;
+      ncells = (double)cl->nx * (double)cl->ny * (double)cl->nz;
+      if(ncells <= (double)MAX(MAXCELLFACTOR * ngrid, MINCELLS))
+         break;
+      cellsize *= (REAL)1.26;          /* Halves the number of cells    */
+   }
+   cl->cellsize = cellsize;
+   cl->ncells   = cl->nx * cl->ny * cl->nz;
+
+   /* Allocate the arrays                                               */
+   cl->cellStart = (int *)calloc(cl->ncells + 1, sizeof(int));
+   cl->cellAtoms = (int *)malloc((ngrid + 1) * sizeof(int));
+   cl->cellOf    = (int *)malloc(coords->natoms * sizeof(int));
+   cl->mark      = (unsigned int *)calloc(coords->natoms, 
+                                          sizeof(unsigned int));
+   if((cl->cellStart == NULL) || (cl->cellAtoms == NULL) ||
+      (cl->cellOf    == NULL) || (cl->mark      == NULL))
+   {
+      blFreePDBCellList(cl);
+      return(NULL);
+   }
+
+   /* Counting sort of the atoms into cells. First count the atoms in
+      each cell
+   */
+   for(i=0; i<coords->natoms; i++)
+   {
+      if(HASCOORDS(coords->x[i], coords->y[i], coords->z[i]))
+      {
+         c = CellIndex(cl, coords->x[i], coords->y[i], coords->z[i]);
+         cl->cellOf[i] = c;
+         cl->cellStart[c+1]++;
+      }
+      else
+      {
+         cl->cellOf[i] = (-1);
+      }
+   }
+
+   /* Convert the counts to start positions                             */
+   for(c=0; c<cl->ncells; c++)
+      cl->cellStart[c+1] += cl->cellStart[c];
+
+   /* Drop the atoms into place, using cellOf[] temporarily to hold the
+      next free slot in each cell. Atoms stay in list order within each
+      cell
+   */
+   {
+      int *next;
+      
+      if((next = (int *)malloc(cl->ncells * sizeof(int)))==NULL)
+      {
+         blFreePDBCellList(cl);
+         return(NULL);
+      }
+      for(c=0; c<cl->ncells; c++)
+         next[c] = cl->cellStart[c];
+      for(i=0; i<coords->natoms; i++)
+      {
+         if((c = cl->cellOf[i]) >= 0)
+            cl->cellAtoms[next[c]++] = i;
+      }
+      free(next);
+   }
+
+   return(cl);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBCellList(PDBCELLLIST *cl)
+   ---------------------------------------
+*//**
+
+   \param[in]     *cl       Cell list
+
+   Frees a cell list. The PDB linked list is not affected.
+
+-  16.10.26 Original
+*/
+void blFreePDBCellList(PDBCELLLIST *cl)
+{
+   if(cl == NULL)
+      return;
+   
+   if(cl->coords    != NULL) blFreePDBCoords(cl->coords);
+   if(cl->cellStart != NULL) free(cl->cellStart);
+   if(cl->cellAtoms != NULL) free(cl->cellAtoms);
+   if(cl->cellOf    != NULL) free(cl->cellOf);
+   if(cl->mark      != NULL) free(cl->mark);
+   free(cl);
+}
+
+
+/************************************************************************/
+/*>int blFindPDBPointNeighbours(PDBCELLLIST *cl, VEC3F point, REAL dist,
+                                int **atoms, int *maxatoms)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *cl        Cell list
+   \param[in]     point      Centre of the search
+   \param[in]     dist       Search distance
+   \param[in,out] **atoms    Array of atom indexes. This is allocated or
+                             enlarged as needed. Initialize to NULL and
+                             free() when no longer needed
+   \param[in,out] *maxatoms  Size of the atoms array. Initialize to 0
+   \return                   Number of atoms found (-1 if out of memory)
+
+   Finds the atoms within dist of a point. The indexes are returned in
+   linked list order. The cell list is not modified so several threads
+   may call this at once.
+
+-  16.10.26 Original
+*/
+int blFindPDBPointNeighbours(PDBCELLLIST *cl, VEC3F point, REAL dist,
+                             int **atoms, int *maxatoms)
+{
+   int natoms;
+
+   natoms = FindNeighbours(cl, point.x, point.y, point.z, dist, 
+                           atoms, maxatoms, 0, FALSE);
+   if(natoms > 1)
+      qsort(*atoms, natoms, sizeof(int), CompareInts);
+   return(natoms);
+}
+
+
+/************************************************************************/
+/*>int blFindPDBAtomNeighbours(PDBCELLLIST *cl, PDB *atom, REAL dist,
+                               int **atoms, int *maxatoms)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]     *cl        Cell list
+   \param[in]     *atom      The atom (need not be in the linked list
+                             used to build the cell list providing it
+                             is in the same coordinate frame)
+   \param[in]     dist       Search distance
+   \param[in,out] **atoms    Array of atom indexes (see 
+                             blFindPDBPointNeighbours())
+   \param[in,out] *maxatoms  Size of the atoms array
+   \return                   Number of atoms found (-1 if out of memory)
+
+   Finds the atoms within dist of an atom. This includes the atom itself
+   if it is in the cell list.
+
+-  16.10.26 Original
+*/
+int blFindPDBAtomNeighbours(PDBCELLLIST *cl, PDB *atom, REAL dist,
+                            int **atoms, int *maxatoms)
+{
+   VEC3F point;
+
+   point.x = atom->x;
+   point.y = atom->y;
+   point.z = atom->z;
+   return(blFindPDBPointNeighbours(cl, point, dist, atoms, maxatoms));
+}
+
+
+/************************************************************************/
+/*>int blFindPDBResidueNeighbours(PDBCELLLIST *cl, PDB *pRes, REAL dist,
+                                  int **atoms, int *maxatoms)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *cl        Cell list
+   \param[in]     *pRes      Start of the residue of interest (need not
+                             be in the linked list used to build the
+                             cell list providing it is in the same
+                             coordinate frame)
+   \param[in]     dist       Search distance
+   \param[in,out] **atoms    Array of atom indexes (see 
+                             blFindPDBPointNeighbours())
+   \param[in,out] *maxatoms  Size of the atoms array
+   \return                   Number of atoms found (-1 if out of memory)
+
+   Finds the atoms within dist of any atom in the residue. Each atom is
+   reported once and the residue's own atoms are included.
+
+-  16.10.26 Original
+*/
+int blFindPDBResidueNeighbours(PDBCELLLIST *cl, PDB *pRes, REAL dist,
+                               int **atoms, int *maxatoms)
+{
+   PDB *p,
+       *pNext;
+   int natoms = 0;
+
+   pNext = blFindNextResidue(pRes);
+   NextStamp(cl);
+   
+   for(p=pRes; p!=pNext; NEXT(p))
+   {
+      natoms = FindNeighbours(cl, p->x, p->y, p->z, dist, 
+                              atoms, maxatoms, natoms, TRUE);
+      if(natoms < 0)
+         return(natoms);
+   }
+
+   if(natoms > 1)
+      qsort(*atoms, natoms, sizeof(int), CompareInts);
+   return(natoms);
+}
+
+
+/************************************************************************/
+/*>static int FindNeighbours(PDBCELLLIST *cl, REAL x, REAL y, REAL z, 
+                             REAL dist, int **atoms, int *maxatoms, 
+                             int natoms, BOOL useMarks)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *cl        Cell list
+   \param[in]     x,y,z      Centre of the search
+   \param[in]     dist       Search distance
+   \param[in,out] **atoms    Array of atom indexes
+   \param[in,out] *maxatoms  Size of the atoms array
+   \param[in]     natoms     Number of atoms already in the array
+   \param[in]     useMarks   Skip and mark atoms using the current stamp
+   \return                   Updated number of atoms (-1 if out of 
+                             memory)
+
+   Appends to atoms[] any atoms within dist of the point. If useMarks
+   is set, atoms already marked with the current stamp are skipped and
+   those found are marked.
+
+-  16.10.26 Original
+*/
+static int FindNeighbours(PDBCELLLIST *cl, REAL x, REAL y, REAL z, 
+                          REAL dist, int **atoms, int *maxatoms, 
+                          int natoms, BOOL useMarks)
+{
+   REAL *ax    = cl->coords->x,
+        *ay    = cl->coords->y,
+        *az    = cl->coords->z,
+        distSq = dist * dist,
+        dx, dy, dz;
+   int  ilo, ihi, jlo, jhi, klo, khi,
+        i, j, k, c, a, atom;
+
+   if(!HASCOORDS(x, y, z))
+      return(natoms);
+
+   CellRange(cl, x, cl->xmin, cl->nx, dist, &ilo, &ihi);
+   CellRange(cl, y, cl->ymin, cl->ny, dist, &jlo, &jhi);
+   CellRange(cl, z, cl->zmin, cl->nz, dist, &klo, &khi);
+   
+   for(k=klo; k<=khi; k++)
+   {
+      for(j=jlo; j<=jhi; j++)
+      {
+         c = (k * cl->ny + j) * cl->nx;
+         for(i=ilo; i<=ihi; i++)
+         {
+            for(a=cl->cellStart[c+i]; a<cl->cellStart[c+i+1]; a++)
+            {
+               atom = cl->cellAtoms[a];
+               if(useMarks && (cl->mark[atom] == cl->stamp))
+                  continue;
+               
+               dx = ax[atom] - x;
+               dy = ay[atom] - y;
+               dz = az[atom] - z;
+               if(dx*dx + dy*dy + dz*dz <= distSq)
+               {
+                  if(!AddAtom(atom, atoms, maxatoms, natoms))
+                     return(-1);
+                  if(useMarks)
+                     cl->mark[atom] = cl->stamp;
+                  natoms++;
+               }
+            }
+         }
+      }
+   }
+   
+   return(natoms);
+}
+
+
+/************************************************************************/
+/*>static int CellIndex(PDBCELLLIST *cl, REAL x, REAL y, REAL z)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *cl       Cell list
+   \param[in]     x,y,z     Coordinates within the grid
+   \return                  Index of the cell
+
+-  16.10.26 Original
+*/
+static int CellIndex(PDBCELLLIST *cl, REAL x, REAL y, REAL z)
+{
+   int i, j, k;
+
+   i = (int)((x - cl->xmin) / cl->cellsize);
+   j = (int)((y - cl->ymin) / cl->cellsize);
+   k = (int)((z - cl->zmin) / cl->cellsize);
+   if(i >= cl->nx) i = cl->nx - 1;
+   if(j >= cl->ny) j = cl->ny - 1;
+   if(k >= cl->nz) k = cl->nz - 1;
+
+   return((k * cl->ny + j) * cl->nx + i);
+}
+
+
+/************************************************************************/
+/*>static void CellRange(PDBCELLLIST *cl, REAL coord, REAL min, int n, 
+                         REAL dist, int *lo, int *hi)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *cl       Cell list
+   \param[in]     coord     Coordinate of the search centre
+   \param[in]     min       Minimum of the grid in this dimension
+   \param[in]     n         Number of cells in this dimension
+   \param[in]     dist      Search distance
+   \param[out]    *lo       First cell to search
+   \param[out]    *hi       Last cell to search (less than lo if the
+                            search misses the grid)
+
+-  16.10.26 Original
+*/
+static void CellRange(PDBCELLLIST *cl, REAL coord, REAL min, int n, 
+                      REAL dist, int *lo, int *hi)
+{
+   REAL flo = floor((coord - dist - min) / cl->cellsize),
+        fhi = floor((coord + dist - min) / cl->cellsize);
+
+   *lo = (flo < (REAL)0.0) ? 0     : ((flo >= n) ? n : (int)flo);
+   *hi = (fhi >= n)        ? n - 1 : ((fhi <  0) ? -1 : (int)fhi);
+}
+
+
+/************************************************************************/
+/*>static BOOL AddAtom(int atom, int **atoms, int *maxatoms, int natoms)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     atom      Atom index to add
+   \param[in,out] **atoms   Array of atom indexes
+   \param[in,out] *maxatoms Size of the array
+   \param[in]     natoms    Number of atoms already in the array
+   \return                  Success?
+
+   Stores an atom index, growing the array if needed.
+
+-  16.10.26 Original
+*/
+static BOOL AddAtom(int atom, int **atoms, int *maxatoms, int natoms)
+{
+   if((*atoms == NULL) || (natoms >= *maxatoms))
+   {
+      int *newatoms;
+      int newmax = *maxatoms + ATOM_ALLOCQUANT;
+
+      if(newmax < 2 * (*maxatoms))
+         newmax = 2 * (*maxatoms);
+      
+      if((newatoms = (int *)realloc(*atoms, newmax * sizeof(int)))==NULL)
+         return(FALSE);
+      *atoms    = newatoms;
+      *maxatoms = newmax;
+   }
+
+   (*atoms)[natoms] = atom;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void NextStamp(PDBCELLLIST *cl)
+   --------------------------------------
+*//**
+
+   \param[in,out] *cl       Cell list
+
+   Starts a new query. Atoms are marked with the query's stamp as they
+   are found; the markers are cleared if the stamp wraps round.
+
+-  16.10.26 Original
+*/
+static void NextStamp(PDBCELLLIST *cl)
+{
+   if(++(cl->stamp) == 0)
+   {
+      int i;
+      for(i=0; i<cl->coords->natoms; i++)
+         cl->mark[i] = 0;
+      cl->stamp = 1;
+   }
+}
+
+
+/************************************************************************/
+/*>static int CompareInts(const void *a, const void *b)
+   ----------------------------------------------------
+*//**
+
+   qsort() comparison function for ints
+
+-  16.10.26 Original
+*/
+static int CompareInts(const void *a, const void *b)
+{
+   return(*(const int *)a - *(const int *)b);
+}
+
@@ -3,8 +3,8 @@
 
    \file       DupePDB.c
    
-   \version    V1.11
-   \date       07.07.14
+   \version    V1.12
+   \date       16.10.26
    \brief      PDB linked list manipulation
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-6
@@ -58,6 +58,8 @@
 -  V1.9  14.03.96 Added FindAtomInRes()
 -  V1.10 08.10.99 Initialised some variables
 -  V1.11 07.07.14 Use bl prefix for functions By: CTP
+-  V1.12 16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Doxygen
@@ -116,16 +118,16 @@ PDB *blDupePDB(PDB *in)
    {
       if(out==NULL)
       {
-         INIT(out, PDB);
+         INITPDB(out);
          q=out;
       }
       else
       {
-         ALLOCNEXT(q, PDB);
+         ALLOCNEXTPDB(q);
       }
       if(q==NULL)
       {
-         FREELIST(out, PDB);
+         FREEPDBLIST(out);
          return(NULL);
       }
       
@@ -3,8 +3,8 @@
 
    \file       DupeResiduePDB.c
    
-   \version    V1.2
-   \date       07.07.14
+   \version    V1.3
+   \date       16.10.26
    \brief      Create a new PDB linked list with a copy of a residue
    
    \copyright  (c) Dr. Andrew C. R. Martin, UCL, 1996-2007
@@ -49,6 +49,8 @@
 -  V1.0 27.08.96 Original from mutmodel  By: ACRM
 -  V1.1 08.11.07 Initialize p and q; Moved into bioplib
 -  V1.2 07.07.14 Use bl prefix for functions By: CTP
+-  V1.3  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Doxygen
@@ -108,16 +110,16 @@ PDB *blDupeResiduePDB(PDB *in)
    {
       if(out==NULL)
       {
-         INIT(out, PDB);
+         INITPDB(out);
          q=out;
       }
       else
       {
-         ALLOCNEXT(q, PDB);
+         ALLOCNEXTPDB(q);
       }
       if(q==NULL)
       {
-         FREELIST(out, PDB);
+         FREEPDBLIST(out);
          return(NULL);
       }
       
@@ -3,8 +3,8 @@
 
    \file       ExtractZonePDB.c
    
-   \version    V1.16
-   \date       19.08.14
+   \version    V1.17
+   \date       16.10.26
    \brief      PDB linked list manipulation
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2014
@@ -63,6 +63,8 @@
 -  V1.14 04.02.14 Use CHAINMATCH By: CTP
 -  V1.15 07.07.14 Use bl prefix for functions By: CTP
 -  V1.16 19.08.14 Renamed function to blExtractZonePDBAsCopy() By: CTP
+-  V1.17 16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Doxygen
@@ -166,7 +168,7 @@ PDB *blExtractZonePDBAsCopy(PDB *inpdb,
 
    if(start==NULL)
    {
-      FREELIST(pdb, PDB);
+      FREEPDBLIST(pdb);
       return(NULL);
    }
 
@@ -201,14 +203,14 @@ PDB *blExtractZonePDBAsCopy(PDB *inpdb,
 
    if(last==NULL)
    {
-      FREELIST(pdb, PDB);
+      FREEPDBLIST(pdb);
       return(NULL);
    }
 
    /* Free linked list after 'last'                                     */
    if(last->next != NULL)
    {
-      FREELIST(last->next, PDB);
+      FREEPDBLIST(last->next);
       last->next = NULL;
    }
    
@@ -218,7 +220,7 @@ PDB *blExtractZonePDBAsCopy(PDB *inpdb,
    if(prev != NULL)
    {
       prev->next = NULL;
-      FREELIST(pdb, PDB);
+      FREEPDBLIST(pdb);
    }
 
    return(start);
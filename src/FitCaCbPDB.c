@@ -3,8 +3,8 @@
 
    \file       FitCaCbPDB.c
    
-   \version    V1.4
-   \date       07.07.14
+   \version    V1.6
+   \date       16.10.26
    \brief      Fit two PDB linked lists. Also a weighted fit and support
                routines
    
@@ -56,6 +56,9 @@
                   ApplyMatrixPDB() rather than RotatePDB() since the PDB
                   linked lists are already at the origin
 -  V1.4  07.07.14 Use bl prefix for functions. By: CTP
+-  V1.5  16.10.26 Uses blQCPfit() rather than blMatfit()
+-  V1.6  16.10.26 blFitCaCbPDB() weights by the atoms in each residue 
+                  as documented
 
 *************************************************************************/
 /* Doxygen
@@ -118,6 +121,10 @@
 -  14.03.96 Changed to use ApplyMatrixPDB() rather than RotatePDB() since
             we are already at the origin
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Uses blQCPfit() rather than blMatfit()
+-  16.10.26 The residue number and insert are updated at the start of
+            each residue. Previously every atom after the first residue
+            was given a weight of 1.0
 */
 BOOL blFitCaCbPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
 {
@@ -189,8 +196,10 @@ BOOL blFitCaCbPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
             if(!strncmp(q->atnam,"CB  ",4)) weights[i] = (REAL)1.0;
             i++;
          }
-         natom = 0;
-         start = p;
+         natom  = 0;
+         start  = p;
+         resnum = p->resnum;
+         insert = p->insert[0];
       }
       natom++;
    }
@@ -205,7 +214,7 @@ BOOL blFitCaCbPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
    }
    
    /* Everything OK, go ahead with the fitting                          */
-   RetVal = blMatfit(ref_coor,fit_coor,RotMat,NCoor,weights,FALSE);
+   RetVal = blQCPfit(ref_coor,fit_coor,RotMat,NCoor,weights,FALSE);
    
    /* Now we can rotate the rotation list                               */
    if(RetVal)
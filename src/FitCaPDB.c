@@ -3,8 +3,8 @@
 
    \file       FitCaPDB.c
    
-   \version    V1.6
-   \date       19.08.14
+   \version    V1.8
+   \date       16.10.26
    \brief      Fit two PDB linked lists. Also a weighted fit and support
                routines
    
@@ -60,6 +60,8 @@
    - V1.5 07.07.14 Use bl prefix for functions By: CTP
    - V1.6 19.08.14 Fixed calls to renamed function:
                    blSelectAtomsPDBAsCopy() By: CTP
+   - V1.7 16.10.26 Uses FREEPDBLIST() to free the selected atoms
+   - V1.8 16.10.26 Uses blQCPfit() rather than blMatfit()
 
 *************************************************************************/
 /* Doxygen
@@ -113,6 +115,7 @@
 -  28.01.09 Initialize RetVal to TRUE!
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.08.14 Added AsCopy suffix to calls to blSelectAtomsPDB() By: CTP
+-  16.10.26 Uses blQCPfit() rather than blMatfit()
 */
 BOOL blFitCaPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
 {
@@ -169,7 +172,7 @@ BOOL blFitCaPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
          else
          {
             /* Everything OK, go ahead with the fitting                 */
-            if(!blMatfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE))
+            if(!blQCPfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE))
             {
                RetVal = FALSE;
             }
@@ -190,8 +193,8 @@ BOOL blFitCaPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
    /* Free the coordinate arrays and CA PDB linked lists                */
    if(ref_coor)   free(ref_coor);
    if(fit_coor)   free(fit_coor);
-   if(ref_ca_pdb) FREELIST(ref_ca_pdb, PDB);
-   if(fit_ca_pdb) FREELIST(fit_ca_pdb, PDB);
+   if(ref_ca_pdb) FREEPDBLIST(ref_ca_pdb);
+   if(fit_ca_pdb) FREEPDBLIST(fit_ca_pdb);
          
    /* Fill in the rotation matrix for output, if required               */
    if(RetVal && (rm!=NULL))
@@ -3,8 +3,8 @@
 
    \file       FitNCaCPDB.c
    
-   \version    V1.5
-   \date       19.08.14
+   \version    V1.7
+   \date       16.10.26
    \brief      Fit two PDB linked lists. Also a weighted fit and support
                routines
    
@@ -58,6 +58,9 @@
 -  V1.4  07.07.14 Use bl prefix for functions By: CTP
 -  V1.5  19.08.14 Added AsCopy suffix to calls to blSelectAtomsPDB() 
                   By: CTP
+-  V1.6  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
+-  V1.7  16.10.26 Uses blQCPfit() rather than blMatfit()
 
 *************************************************************************/
 /* Doxygen
@@ -110,6 +113,7 @@
 -  12.12.01 Original based on FitCaPDB()   By: ACRM
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.08.14 Added AsCopy suffix to calls to blSelectAtomsPDB() By: CTP
+-  16.10.26 Uses blQCPfit() rather than blMatfit()
 */
 BOOL blFitNCaCPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
 {
@@ -170,7 +174,7 @@ BOOL blFitNCaCPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
          else
          {
             /* Everything OK, go ahead with the fitting                 */
-            if(!blMatfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE))
+            if(!blQCPfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE))
             {
                RetVal = FALSE;
             }
@@ -191,8 +195,8 @@ BOOL blFitNCaCPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
    /* Free the coordinate arrays and BB PDB linked lists                */
    if(ref_coor)   free(ref_coor);
    if(fit_coor)   free(fit_coor);
-   if(ref_bb_pdb) FREELIST(ref_bb_pdb, PDB);
-   if(fit_bb_pdb) FREELIST(fit_bb_pdb, PDB);
+   if(ref_bb_pdb) FREEPDBLIST(ref_bb_pdb);
+   if(fit_bb_pdb) FREEPDBLIST(fit_bb_pdb);
          
    /* Fill in the rotation matrix for output, if required               */
    if(RetVal && (rm!=NULL))
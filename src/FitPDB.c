@@ -3,8 +3,8 @@
 
    \file       FitPDB.c
    
-   \version    V1.4
-   \date       07.07.14
+   \version    V1.5
+   \date       16.10.26
    \brief      Fit two PDB linked lists. Also a weighted fit and support
                routines
    
@@ -56,6 +56,7 @@
                   ApplyMatrixPDB() rather than RotatePDB() since the PDB
                   linked lists are already at the origin
 -  V1.4  07.07.14 Use bl prefix for functions By: CTP
+-  V1.5  16.10.26 Uses blQCPfit() rather than blMatfit()
 
 *************************************************************************/
 /* Doxygen
@@ -113,6 +114,7 @@
 -  14.03.96 Changed to use ApplyMatrixPDB() rather than RotatePDB() since
             we are already at the origin
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Uses blQCPfit() rather than blMatfit()
 */
 BOOL blFitPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
 {
@@ -152,7 +154,7 @@ BOOL blFitPDB(PDB *ref_pdb, PDB *fit_pdb, REAL rm[3][3])
    }
    
    /* Everything OK, go ahead with the fitting                          */
-   RetVal = blMatfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE);
+   RetVal = blQCPfit(ref_coor,fit_coor,RotMat,NCoor,NULL,FALSE);
    
    /* Now we can rotate the rotation list                               */
    if(RetVal)
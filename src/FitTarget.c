@@ -0,0 +1,708 @@
+/************************************************************************/
+/**
+
+   \file       FitTarget.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Repeated fitting to a pre-centred reference structure
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   blFitPDB() and friends move both structures to the origin, fit them
+   and move them back, so every call makes several passes over both
+   linked lists, allocates two coordinate arrays and modifies the 
+   reference while it works. That is wasteful when one reference is 
+   compared with many mobile structures (e.g. decoys) and means a 
+   reference cannot be shared between threads.
+
+   A FITTARGET holds the selected atoms of the reference, centred once,
+   together with the sums that QCP needs (see fit.c). Fitting a mobile 
+   structure to it is then a single pass over the mobile structure with
+   no memory allocation and neither structure is modified. The mobile
+   structure is only moved if blSuperposeOnFitTarget() is called.
+
+   The atoms used are selected as for blRMSDMatrixPDB():
+   RMSD_ATOMS_ALL   All atoms (as blFitPDB())
+   RMSD_ATOMS_CA    CA atoms (as blFitCaPDB())
+   RMSD_ATOMS_NCAC  N, CA and C atoms (as blFitNCaCPDB())
+   RMSD_ATOMS_CACB  All atoms weighted towards CA and CB (as 
+                    blFitCaCbPDB()). The weights come from the reference
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   FITTARGET *target;
+   target = blCreateFitTarget(ref, RMSD_ATOMS_CA);
+   for(each decoy)
+      blFitTargetRMSD(target, decoy, &rmsd, NULL);
+   blFreeFitTarget(target);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Fitting
+   #FUNCTION  blCreateFitTarget()
+   Creates a pre-centred fit target from selected atoms of a PDB linked
+   list
+
+   #FUNCTION  blCreateFitTargetCoor()
+   Creates a pre-centred fit target from a coordinate array
+
+   #FUNCTION  blFreeFitTarget()
+   Frees a fit target
+
+   #FUNCTION  blFitTargetRMSD()
+   Calculates the RMSD and, optionally, the rotation matrix fitting a 
+   PDB linked list to a fit target without modifying either
+
+   #FUNCTION  blFitTargetRMSDCoor()
+   Calculates the RMSD and, optionally, the rotation matrix fitting a 
+   coordinate array to a fit target without modifying either
+
+   #FUNCTION  blSuperposeOnFitTarget()
+   Fits a PDB linked list to a fit target and moves it onto the target
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "SysDefs.h"
+#include "MathType.h"
+#include "macros.h"
+#include "fit.h"
+#include "matrix.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+
+/* Sums collected over the mobile atoms                                 */
+typedef struct
+{
+   REAL  B[3][3];          /* Sum of weighted reference x mobile        */
+   VEC3F sum,              /* Sum of the mobile coordinates             */
+         wsum;             /* Sum of the weighted mobile coordinates    */
+   REAL  g;                /* Weighted sum of squares of the mobile     */
+   int   n;
+}  FITSUMS;
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL AtomSelected(const PDB *p, int atoms);
+static FITTARGET *AllocFitTarget(int ncoor, BOOL weighted);
+static void SetCaCbWeights(const PDB *pdb, FITTARGET *target);
+static void CentreFitTarget(FITTARGET *target);
+static void InitFitSums(FITSUMS *sums);
+static void AddFitSums(FITSUMS *sums, const FITTARGET *target, 
+                       REAL x, REAL y, REAL z);
+static BOOL FinishFit(const FITTARGET *target, FITSUMS *sums, 
+                      REAL *rmsd, REAL rm[3][3], VEC3F *CofG);
+static BOOL FitPDBToTarget(const FITTARGET *target, const PDB *mobile,
+                           REAL *rmsd, REAL rm[3][3], VEC3F *CofG);
+
+
+/************************************************************************/
+/*>FITTARGET *blCreateFitTarget(const PDB *ref, int atoms)
+   -------------------------------------------------------
+*//**
+
+   \param[in]     *ref      Reference PDB linked list
+   \param[in]     atoms     RMSD_ATOMS_ALL, RMSD_ATOMS_CA, 
+                            RMSD_ATOMS_NCAC or RMSD_ATOMS_CACB
+   \return                  Fit target (NULL if out of memory or fewer 
+                            than 3 atoms are selected)
+
+   Creates a fit target from the selected atoms of a reference structure.
+   The reference is not modified and need not be kept.
+
+-  16.10.26 Original
+*/
+FITTARGET *blCreateFitTarget(const PDB *ref, int atoms)
+{
+   FITTARGET *target;
+   const PDB *p;
+   int       ncoor = 0;
+
+   for(p=ref; p!=NULL; NEXT(p))
+   {
+      if(AtomSelected(p, atoms))
+         ncoor++;
+   }
+   if(ncoor < 3)
+      return(NULL);
+
+   if((target = AllocFitTarget(ncoor, (atoms==RMSD_ATOMS_CACB)))==NULL)
+      return(NULL);
+   target->atoms = atoms;
+
+   ncoor = 0;
+   for(p=ref; p!=NULL; NEXT(p))
+   {
+      if(AtomSelected(p, atoms))
+      {
+         target->coor[ncoor].x = p->x;
+         target->coor[ncoor].y = p->y;
+         target->coor[ncoor].z = p->z;
+         ncoor++;
+      }
+   }
+
+   if(target->weights != NULL)
+      SetCaCbWeights(ref, target);
+   
+   CentreFitTarget(target);
+   return(target);
+}
+
+
+/************************************************************************/
+/*>FITTARGET *blCreateFitTargetCoor(const COOR *coor, int ncoor, 
+                                    const REAL *weights)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *coor     Reference coordinates
+   \param[in]     ncoor     Number of coordinates
+   \param[in]     *weights  Weights for each coordinate (may be NULL)
+   \return                  Fit target (NULL if out of memory or fewer 
+                            than 3 coordinates)
+
+   Creates a fit target from a coordinate array. The coordinates need
+   not be centred and are copied.
+
+-  16.10.26 Original
+*/
+FITTARGET *blCreateFitTargetCoor(const COOR *coor, int ncoor, 
+                                 const REAL *weights)
+{
+   FITTARGET *target;
+   int       i;
+   
+   if(ncoor < 3)
+      return(NULL);
+   if((target = AllocFitTarget(ncoor, (weights != NULL)))==NULL)
+      return(NULL);
+   target->atoms = RMSD_ATOMS_ALL;
+
+   for(i=0; i<ncoor; i++)
+   {
+      target->coor[i] = coor[i];
+      if(weights != NULL)
+         target->weights[i] = weights[i];
+   }
+
+   CentreFitTarget(target);
+   return(target);
+}
+
+
+/************************************************************************/
+/*>void blFreeFitTarget(FITTARGET *target)
+   ---------------------------------------
+*//**
+
+   \param[in]     *target   Fit target
+
+   Frees a fit target
+
+-  16.10.26 Original
+*/
+void blFreeFitTarget(FITTARGET *target)
+{
+   if(target != NULL)
+   {
+      if(target->coor != NULL)
+         free(target->coor);
+      if(target->weights != NULL)
+         free(target->weights);
+      free(target);
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL blFitTargetRMSD(const FITTARGET *target, const PDB *mobile,
+                        REAL *rmsd, REAL rm[3][3])
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     *target   Fit target
+   \param[in]     *mobile   Mobile PDB linked list
+   \param[out]    *rmsd     RMSD over the selected atoms after fitting
+   \param[out]    rm        Rotation matrix (may be NULL)
+   \return                  Success? (FALSE if the number of selected 
+                            atoms differs from the target)
+
+   Fits the selected atoms of a mobile structure to a fit target. 
+   Neither is modified and no memory is allocated so any number of 
+   threads may use the same target. The rotation matrix is as returned 
+   by blFitPDB() and applies to the mobile structure once it has been 
+   centred on its selected atoms.
+
+-  16.10.26 Original
+*/
+BOOL blFitTargetRMSD(const FITTARGET *target, const PDB *mobile,
+                     REAL *rmsd, REAL rm[3][3])
+{
+   VEC3F CofG;
+   
+   return(FitPDBToTarget(target, mobile, rmsd, rm, &CofG));
+}
+
+
+/************************************************************************/
+/*>BOOL blFitTargetRMSDCoor(const FITTARGET *target, const COOR *coor,
+                            int ncoor, REAL *rmsd, REAL rm[3][3])
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *target   Fit target
+   \param[in]     *coor     Mobile coordinates (need not be centred)
+   \param[in]     ncoor     Number of coordinates
+   \param[out]    *rmsd     RMSD after fitting
+   \param[out]    rm        Rotation matrix (may be NULL)
+   \return                  Success? (FALSE if ncoor differs from the 
+                            target)
+
+   As blFitTargetRMSD() but for a coordinate array which must match the
+   atoms of the target one for one
+
+-  16.10.26 Original
+*/
+BOOL blFitTargetRMSDCoor(const FITTARGET *target, const COOR *coor,
+                         int ncoor, REAL *rmsd, REAL rm[3][3])
+{
+   FITSUMS sums;
+   VEC3F   CofG;
+   int     i;
+
+   if(ncoor != target->ncoor)
+      return(FALSE);
+   
+   InitFitSums(&sums);
+   for(i=0; i<ncoor; i++)
+      AddFitSums(&sums, target, coor[i].x, coor[i].y, coor[i].z);
+
+   return(FinishFit(target, &sums, rmsd, rm, &CofG));
+}
+
+
+/************************************************************************/
+/*>BOOL blSuperposeOnFitTarget(const FITTARGET *target, PDB *mobile,
+                               REAL *rmsd, REAL rm[3][3])
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]     *target   Fit target
+   \param[in,out] *mobile   Mobile PDB linked list
+   \param[out]    *rmsd     RMSD over the selected atoms after fitting
+                            (may be NULL)
+   \param[out]    rm        Rotation matrix (may be NULL)
+   \return                  Success?
+
+   Fits the selected atoms of a mobile structure to a fit target and 
+   then moves the whole of the mobile structure onto the target in a
+   single pass. This gives the same coordinates as blFitPDB(), 
+   blFitCaPDB(), etc.
+
+-  16.10.26 Original
+*/
+BOOL blSuperposeOnFitTarget(const FITTARGET *target, PDB *mobile,
+                            REAL *rmsd, REAL rm[3][3])
+{
+   REAL  RotMat[3][3],
+         myrmsd;
+   VEC3F CofG,
+         incoords,
+         outcoords;
+   PDB   *p;
+   int   i, j;
+   
+   if(!FitPDBToTarget(target, mobile, &myrmsd, RotMat, &CofG))
+      return(FALSE);
+
+   for(p=mobile; p!=NULL; NEXT(p))
+   {
+      if(p->x != 9999.0 && p->y != 9999.0 && p->z != 9999.0)
+      {
+         incoords.x = p->x - CofG.x;
+         incoords.y = p->y - CofG.y;
+         incoords.z = p->z - CofG.z;
+         blMatMult3_33(incoords, RotMat, &outcoords);
+         p->x = outcoords.x + target->CofG.x;
+         p->y = outcoords.y + target->CofG.y;
+         p->z = outcoords.z + target->CofG.z;
+      }
+   }
+
+   if(rmsd != NULL)
+      *rmsd = myrmsd;
+   if(rm != NULL)
+   {
+      for(i=0; i<3; i++)
+         for(j=0; j<3; j++)
+            rm[i][j] = RotMat[i][j];
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL FitPDBToTarget(const FITTARGET *target, const PDB *mobile,
+                              REAL *rmsd, REAL rm[3][3], VEC3F *CofG)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in]     *target   Fit target
+   \param[in]     *mobile   Mobile PDB linked list
+   \param[out]    *rmsd     RMSD after fitting
+   \param[out]    rm        Rotation matrix (may be NULL)
+   \param[out]    *CofG     Centre of geometry of the selected mobile 
+                            atoms
+   \return                  Success?
+
+   Does the work for blFitTargetRMSD() and blSuperposeOnFitTarget()
+
+-  16.10.26 Original
+*/
+static BOOL FitPDBToTarget(const FITTARGET *target, const PDB *mobile,
+                           REAL *rmsd, REAL rm[3][3], VEC3F *CofG)
+{
+   FITSUMS   sums;
+   const PDB *p;
+
+   InitFitSums(&sums);
+   for(p=mobile; p!=NULL; NEXT(p))
+   {
+      if(AtomSelected(p, target->atoms))
+      {
+         if(sums.n >= target->ncoor)
+            return(FALSE);
+         AddFitSums(&sums, target, p->x, p->y, p->z);
+      }
+   }
+   if(sums.n != target->ncoor)
+      return(FALSE);
+
+   return(FinishFit(target, &sums, rmsd, rm, CofG));
+}
+
+
+/************************************************************************/
+/*>static BOOL AtomSelected(const PDB *p, int atoms)
+   -------------------------------------------------
+*//**
+
+   \param[in]     *p        PDB record
+   \param[in]     atoms     RMSD_ATOMS_ selection
+   \return                  Is the atom used for fitting?
+
+-  16.10.26 Original
+*/
+static BOOL AtomSelected(const PDB *p, int atoms)
+{
+   switch(atoms)
+   {
+   case RMSD_ATOMS_CA:
+      return(!strncmp(p->atnam, "CA  ", 4));
+   case RMSD_ATOMS_NCAC:
+      return(!strncmp(p->atnam, "N   ", 4) ||
+             !strncmp(p->atnam, "CA  ", 4) ||
+             !strncmp(p->atnam, "C   ", 4));
+   default:
+      break;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static FITTARGET *AllocFitTarget(int ncoor, BOOL weighted)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]     ncoor     Number of coordinates
+   \param[in]     weighted  Allocate the weights array?
+   \return                  Fit target (NULL if out of memory)
+
+-  16.10.26 Original
+*/
+static FITTARGET *AllocFitTarget(int ncoor, BOOL weighted)
+{
+   FITTARGET *target;
+
+   if((target = (FITTARGET *)malloc(sizeof(FITTARGET)))==NULL)
+      return(NULL);
+
+   target->ncoor   = ncoor;
+   target->weights = NULL;
+   if((target->coor = (COOR *)malloc(ncoor * sizeof(COOR)))==NULL)
+   {
+      blFreeFitTarget(target);
+      return(NULL);
+   }
+   if(weighted && 
+      ((target->weights = (REAL *)malloc(ncoor * sizeof(REAL)))==NULL))
+   {
+      blFreeFitTarget(target);
+      return(NULL);
+   }
+
+   return(target);
+}
+
+
+/************************************************************************/
+/*>static void SetCaCbWeights(const PDB *pdb, FITTARGET *target)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *pdb      PDB linked list
+   \param[in,out] *target   Fit target with all atoms of pdb
+
+   Weights CA and CB atoms by 1.0 and all other atoms in a residue by
+   1/(number of atoms in the residue) as described for blFitCaCbPDB()
+
+-  16.10.26 Original
+*/
+static void SetCaCbWeights(const PDB *pdb, FITTARGET *target)
+{
+   const PDB *res, *nextRes, *p;
+   int       natom, 
+             i = 0;
+
+   for(res=pdb; res!=NULL && i<target->ncoor; res=nextRes)
+   {
+      /* blFitCaCbPDB() splits residues on number and insert only       */
+      for(nextRes=res, natom=0; 
+          (nextRes!=NULL) && 
+          (nextRes->resnum    == res->resnum) &&
+          (nextRes->insert[0] == res->insert[0]);
+          NEXT(nextRes))
+         natom++;
+      
+      for(p=res; p!=nextRes && i<target->ncoor; NEXT(p))
+      {
+         target->weights[i] = (REAL)(1.0/(REAL)natom);
+         if(!strncmp(p->atnam,"CA  ",4) || !strncmp(p->atnam,"CB  ",4))
+            target->weights[i] = (REAL)1.0;
+         i++;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void CentreFitTarget(FITTARGET *target)
+   ----------------------------------------------
+*//**
+
+   \param[in,out] *target   Fit target
+
+   Moves the coordinates of a fit target to their centre of geometry 
+   and calculates the sums needed for fitting
+
+-  16.10.26 Original
+*/
+static void CentreFitTarget(FITTARGET *target)
+{
+   COOR *c = target->coor;
+   int  i;
+   
+   target->CofG.x = target->CofG.y = target->CofG.z = 0.0;
+   for(i=0; i<target->ncoor; i++)
+   {
+      target->CofG.x += c[i].x;
+      target->CofG.y += c[i].y;
+      target->CofG.z += c[i].z;
+   }
+   target->CofG.x /= target->ncoor;
+   target->CofG.y /= target->ncoor;
+   target->CofG.z /= target->ncoor;
+
+   target->wsumCoor.x = target->wsumCoor.y = target->wsumCoor.z = 0.0;
+   target->g    = 0.0;
+   target->wsum = 0.0;
+   for(i=0; i<target->ncoor; i++)
+   {
+      REAL w = (target->weights != NULL) ? target->weights[i] : 1.0;
+      
+      c[i].x -= target->CofG.x;
+      c[i].y -= target->CofG.y;
+      c[i].z -= target->CofG.z;
+
+      target->wsumCoor.x += w * c[i].x;
+      target->wsumCoor.y += w * c[i].y;
+      target->wsumCoor.z += w * c[i].z;
+      target->g    += w * (c[i].x * c[i].x + 
+                           c[i].y * c[i].y + 
+                           c[i].z * c[i].z);
+      target->wsum += w;
+   }
+}
+
+
+/************************************************************************/
+/*>static void InitFitSums(FITSUMS *sums)
+   --------------------------------------
+*//**
+
+   \param[out]    *sums     Sums over the mobile atoms
+
+-  16.10.26 Original
+*/
+static void InitFitSums(FITSUMS *sums)
+{
+   int i, j;
+   
+   for(i=0; i<3; i++)
+      for(j=0; j<3; j++)
+         sums->B[i][j] = 0.0;
+   sums->sum.x  = sums->sum.y  = sums->sum.z  = 0.0;
+   sums->wsum.x = sums->wsum.y = sums->wsum.z = 0.0;
+   sums->g      = 0.0;
+   sums->n      = 0;
+}
+
+
+/************************************************************************/
+/*>static void AddFitSums(FITSUMS *sums, const FITTARGET *target, 
+                          REAL x, REAL y, REAL z)
+   --------------------------------------------------------------
+*//**
+
+   \param[in,out] *sums     Sums over the mobile atoms
+   \param[in]     *target   Fit target
+   \param[in]     x         Mobile coordinates (uncentred) of the next 
+   \param[in]     y         atom
+   \param[in]     z
+
+   Adds a mobile atom to the sums. The mobile structure is not centred 
+   first; the sums are corrected for its centre in FinishFit() so only
+   one pass is needed.
+
+-  16.10.26 Original
+*/
+static void AddFitSums(FITSUMS *sums, const FITTARGET *target, 
+                       REAL x, REAL y, REAL z)
+{
+   COOR *r = target->coor + sums->n;
+   REAL w  = (target->weights != NULL) ? target->weights[sums->n] : 1.0,
+        wx = w * x,
+        wy = w * y,
+        wz = w * z;
+
+   sums->B[0][0] += r->x * wx;
+   sums->B[0][1] += r->x * wy;
+   sums->B[0][2] += r->x * wz;
+   sums->B[1][0] += r->y * wx;
+   sums->B[1][1] += r->y * wy;
+   sums->B[1][2] += r->y * wz;
+   sums->B[2][0] += r->z * wx;
+   sums->B[2][1] += r->z * wy;
+   sums->B[2][2] += r->z * wz;
+   
+   sums->sum.x  += x;
+   sums->sum.y  += y;
+   sums->sum.z  += z;
+   sums->wsum.x += wx;
+   sums->wsum.y += wy;
+   sums->wsum.z += wz;
+   sums->g      += wx * x + wy * y + wz * z;
+   sums->n++;
+}
+
+
+/************************************************************************/
+/*>static BOOL FinishFit(const FITTARGET *target, FITSUMS *sums, 
+                         REAL *rmsd, REAL rm[3][3], VEC3F *CofG)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     *target   Fit target
+   \param[in,out] *sums     Sums over the mobile atoms
+   \param[out]    *rmsd     RMSD after fitting
+   \param[out]    rm        Rotation matrix (may be NULL)
+   \param[out]    *CofG     Centre of geometry of the mobile atoms
+   \return                  Success?
+
+   Shifts the sums to the centre of the mobile atoms and does the QCP 
+   fit. With the mobile centre c, the correlation matrix of the centred
+   mobile is B - (sum of weighted target coords) c and its sum of 
+   squares is g - 2 c.(sum of weighted coords) + wsum |c|^2
+
+-  16.10.26 Original
+*/
+static BOOL FinishFit(const FITTARGET *target, FITSUMS *sums, 
+                      REAL *rmsd, REAL rm[3][3], VEC3F *CofG)
+{
+   REAL  g2;
+   const VEC3F *wr = &(target->wsumCoor);
+   
+   CofG->x = sums->sum.x / sums->n;
+   CofG->y = sums->sum.y / sums->n;
+   CofG->z = sums->sum.z / sums->n;
+
+   sums->B[0][0] -= wr->x * CofG->x;
+   sums->B[0][1] -= wr->x * CofG->y;
+   sums->B[0][2] -= wr->x * CofG->z;
+   sums->B[1][0] -= wr->y * CofG->x;
+   sums->B[1][1] -= wr->y * CofG->y;
+   sums->B[1][2] -= wr->y * CofG->z;
+   sums->B[2][0] -= wr->z * CofG->x;
+   sums->B[2][1] -= wr->z * CofG->y;
+   sums->B[2][2] -= wr->z * CofG->z;
+
+   g2 = sums->g 
+      - 2.0 * (CofG->x * sums->wsum.x + 
+               CofG->y * sums->wsum.y + 
+               CofG->z * sums->wsum.z)
+      + target->wsum * (CofG->x * CofG->x + 
+                        CofG->y * CofG->y + 
+                        CofG->z * CofG->z);
+
+   return(blQCPInnerFit(sums->B, target->g, g2, target->wsum, 
+                        rm, FALSE, rmsd));
+}
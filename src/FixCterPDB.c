@@ -3,8 +3,8 @@
 
    \file       FixCterPDB.c
    
-   \version    V1.7
-   \date       07.07.14
+   \version    V1.9
+   \date       16.10.26
    \brief      Routine to add C-terminal oxygens.
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1994-2014
@@ -62,6 +62,10 @@
 -  V1.5  03.06.05 Handles altpos
 -  V1.6  04.02.14 Use CHAINMATCH By: CTP
 -  V1.7  07.07.14 Use bl prefix for functions By: CTP
+-  V1.8  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
+-  V1.9  16.10.26 Sets the residue and atom codes of the records it
+                  renames
 
 *************************************************************************/
 /* Doxygen
@@ -170,7 +174,7 @@ BOOL blFixCterPDB(PDB *pdb, int style)
          /* If O2 is missing, generate coordinates                      */
          if(O2 == NULL)
          {
-            INIT(O2, PDB);
+            INITPDB(O2);
             CLEAR_PDB(O2);
             if(O1 != NULL) 
                blCopyPDB(O2, O1);
@@ -182,6 +186,7 @@ BOOL blFixCterPDB(PDB *pdb, int style)
             O2->bval = 20.0;
             strcpy(O2->atnam,"OXT ");
             strcpy(O2->atnam_raw," OXT");
+            O2->atcode = (short)blGetAtomCode(O2->atnam);
             O2->altpos = ' ';         /* 03.06.05                       */
             
             if(CA==NULL || C==NULL || O1==NULL ||
@@ -288,6 +293,7 @@ static void StandardiseCTers(PDB *pdb)
          {
             strcpy(O1->atnam,"O   ");
             strcpy(O1->atnam_raw," O  ");
+            O1->atcode = (short)blGetAtomCode(O1->atnam);
             O1->altpos = ' ';         /* 03.06.05                       */
          }
          
@@ -295,6 +301,7 @@ static void StandardiseCTers(PDB *pdb)
          {
             strcpy(O2->atnam,"OXT ");
             strcpy(O2->atnam_raw," OXT");
+            O2->atcode = (short)blGetAtomCode(O2->atnam);
             O2->altpos = ' ';         /* 03.06.05                       */
          }
          
@@ -310,6 +317,7 @@ static void StandardiseCTers(PDB *pdb)
             for(p=start; p!=end; NEXT(p))
             {
                strcpy(p->resnam, prev->resnam);
+               p->rescode = prev->rescode;
                strcpy(p->insert, prev->insert);
                p->resnum = prev->resnum;
             }
@@ -379,12 +387,14 @@ static BOOL SetCterStyle(PDB *start, PDB *end, int style)
       {
          strcpy(O1->atnam,"O1  ");
          strcpy(O1->atnam_raw," O1 ");
+         O1->atcode = (short)blGetAtomCode(O1->atnam);
          O1->altpos = ' ';            /* 03.06.05                       */
       }
       if(O2 != NULL)
       {
          strcpy(O2->atnam,"O2  ");
          strcpy(O2->atnam_raw," O2 ");
+         O2->atcode = (short)blGetAtomCode(O2->atnam);
          O2->altpos = ' ';            /* 03.06.05                       */
       }
       
@@ -396,17 +406,20 @@ static BOOL SetCterStyle(PDB *start, PDB *end, int style)
       {
          strcpy(O1->atnam,"OT1 ");
          strcpy(O1->atnam_raw," OT1");
+         O1->atcode = (short)blGetAtomCode(O1->atnam);
          O1->altpos = ' ';            /* 03.06.05                       */
       }
       if(O2 != NULL)
       {
          strcpy(O2->atnam,"OT2 ");
          strcpy(O2->atnam_raw," OT2");
+         O2->atcode = (short)blGetAtomCode(O2->atnam);
          O2->altpos = ' ';            /* 03.06.05                       */
       }
 
       /* Change the name and number for O2                              */
       strcpy(O2->resnam,"CTER");
+      O2->rescode = (short)blGetResCode(O2->resnam);
       strcpy(O2->insert," ");
       O2->resnum = start->resnum + 1;
    }
@@ -3,8 +3,8 @@
 
    \file       GlyCB.c
    
-   \version    V1.1
-   \date       07.07.14
+   \version    V1.3
+   \date       16.10.26
    \brief      Add C-beta atoms to glycines as pseudo-atoms for use
                in orientating residues
    \copyright  (c) Dr. Andrew C. R. Martin, UCL, 2006-2014
@@ -50,6 +50,9 @@
    =================
 -  04.01.06 V1.0   Original  By: ACRM
 -  07.07.14 V1.1   Use bl prefix for functions By: CTP
+-  16.10.26 V1.2   PDB nodes are allocated and freed with the arena-aware
+                   blAllocPDB() and blFreePDBNode() routines
+-  16.10.26 V1.3   Sets the atom code of the new CB
 
 *************************************************************************/
 /* Doxygen
@@ -195,7 +198,7 @@ BOOL blAddCBtoGly(PDB *pdb)
    znew1=z2+BondLen*(cosa*zplus-sina*zs);
 
    /* Create a PDB record and initialize it to be the same as the O     */
-   if((cb = (PDB *)malloc(sizeof(PDB)))==NULL)
+   if((cb = blAllocPDB())==NULL)
    {
       return(FALSE);
    }
@@ -206,6 +209,7 @@ BOOL blAddCBtoGly(PDB *pdb)
    /* Change it to a CB                                                 */
    strcpy(cb->atnam, "CB  ");
    strcpy(cb->atnam_raw, " CB ");
+   cb->atcode = (short)blGetAtomCode(cb->atnam);
    /* And set the coordinates                                           */
    cb->x = xnew1;
    cb->y = ynew1;
@@ -282,7 +286,7 @@ PDB *blStripGlyCB(PDB *pdb)
             if(prev!=NULL)
             {
                prev->next = p->next;
-               free(p);
+               blFreePDBNode(p);
                p=prev->next;
             }
             else
@@ -290,7 +294,7 @@ PDB *blStripGlyCB(PDB *pdb)
                PDB *q;
                q=p;
                NEXT(p);
-               free(q);
+               blFreePDBNode(q);
                pdb = p;
             }
          }
@@ -3,8 +3,8 @@
 
    \file       HAddPDB.c
    
-   \version    V2.18
-   \date       26.08.14
+   \version    V2.20
+   \date       16.10.26
    \brief      Add hydrogens to a PDB linked list
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2014
@@ -129,6 +129,10 @@
 -  V2.18 26.08.14 Moved use of ok variable into #ifdef SCREEN_INFO and
                   cleaned up use of n and nt variables instead of literal
                   strings
+-  V2.19 16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
+-  V2.20 16.10.26 makeh() frees its unused list with FREEPDBLIST() so it
+                  is safe when an arena is current
 
 *************************************************************************/
 /* Doxygen
@@ -595,6 +599,7 @@ preceeding the last residue\n");
 -  07.07.14 Use bl prefix for functions By: CTP
 -  26.08.14 Used n and nt variables consistently instead of literal
             strings. Moved all use of 'ok' variable into SCREEN_INFO
+-  16.10.26 Allocates with INITPDB() and frees with FREEPDBLIST()
 */
 static PDB *makeh(int HType, REAL BondLen, REAL alpha, REAL beta, 
                   BOOL firstres)
@@ -632,7 +637,7 @@ static PDB *makeh(int HType, REAL BondLen, REAL alpha, REAL beta,
 
    Dummy = FALSE;
 
-   INIT(hlist_start, PDB);
+   INITPDB(hlist_start);
    if(hlist_start == NULL) return(NULL);
    
    CLEAR_PDB(hlist_start);
@@ -645,7 +650,7 @@ static PDB *makeh(int HType, REAL BondLen, REAL alpha, REAL beta,
    if(firstres && HType==4 && !strncmp(sGHName[2],n,4)) 
    {
       /* 24.05.99 Fixed memory leak                                     */
-      free(hlist_start);
+      FREEPDBLIST(hlist_start);
       return(NULL);
    }
 
@@ -762,7 +767,7 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
       }
 #endif
       /* 24.05.99 Fixed memory leak                                     */
-      FREELIST(hlist_start, PDB);
+      FREEPDBLIST(hlist_start);
       return(NULL);
    }
     
@@ -810,10 +815,10 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
       hlist->x=x5;
       hlist->y=y5;
       hlist->z=z5;
-      ALLOCNEXT(hlist,PDB);
+      ALLOCNEXTPDB(hlist);
       if(hlist == NULL)
       {
-         FREELIST(hlist_start, PDB);
+         FREEPDBLIST(hlist_start);
          return(NULL);
       }
       CLEAR_PDB(hlist);
@@ -881,10 +886,10 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
          hlist->x=x4;
          hlist->y=y4;
          hlist->z=z4;
-         ALLOCNEXT(hlist,PDB);
+         ALLOCNEXTPDB(hlist);
          if(hlist == NULL)
          {
-            FREELIST(hlist_start, PDB);
+            FREEPDBLIST(hlist_start);
             return(NULL);
          }
          CLEAR_PDB(hlist);
@@ -902,10 +907,10 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
          hlist->x=x5;
          hlist->y=y5;
          hlist->z=z5;
-         ALLOCNEXT(hlist,PDB);
+         ALLOCNEXTPDB(hlist);
          if(hlist == NULL)
          {
-            FREELIST(hlist_start, PDB);
+            FREEPDBLIST(hlist_start);
             return(NULL);
          }
          CLEAR_PDB(hlist);
@@ -983,10 +988,10 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
             hlist->x=x4;
             hlist->y=y4;
             hlist->z=z4;
-            ALLOCNEXT(hlist,PDB);
+            ALLOCNEXTPDB(hlist);
             if(hlist == NULL)
             {
-               FREELIST(hlist_start, PDB);
+               FREEPDBLIST(hlist_start);
                return(NULL);
             }
             CLEAR_PDB(hlist);
@@ -1004,10 +1009,10 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
             hlist->x=x5;
             hlist->y=y5;
             hlist->z=z5;
-            ALLOCNEXT(hlist,PDB);
+            ALLOCNEXTPDB(hlist);
             if(hlist == NULL)
             {
-               FREELIST(hlist_start, PDB);
+               FREEPDBLIST(hlist_start);
                return(NULL);
             }
             CLEAR_PDB(hlist);
@@ -1025,10 +1030,10 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
             hlist->x=x6;
             hlist->y=y6;
             hlist->z=z6;
-            ALLOCNEXT(hlist,PDB);
+            ALLOCNEXTPDB(hlist);
             if(hlist == NULL)
             {
-               FREELIST(hlist_start, PDB);
+               FREEPDBLIST(hlist_start);
                return(NULL);
             }
             CLEAR_PDB(hlist);
@@ -1066,10 +1071,10 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
             hlist->x=x4;
             hlist->y=y4;
             hlist->z=z4;
-            ALLOCNEXT(hlist,PDB);
+            ALLOCNEXTPDB(hlist);
             if(hlist == NULL)
             {
-               FREELIST(hlist_start, PDB);
+               FREEPDBLIST(hlist_start);
                return(NULL);
             }
             CLEAR_PDB(hlist);
@@ -1123,10 +1128,10 @@ required by PGP parameter for %3s %5d%c\n",sGRName,sNo,sIns);
          hlist->x=x4;
          hlist->y=y4;
          hlist->z=z4;
-         ALLOCNEXT(hlist,PDB);
+         ALLOCNEXTPDB(hlist);
          if(hlist == NULL)
          {
-            FREELIST(hlist_start, PDB);
+            FREEPDBLIST(hlist_start);
             return(NULL);
          }
          CLEAR_PDB(hlist);
@@ -1188,10 +1193,10 @@ static BOOL AddH(PDB *hlist, PDB **position, int HType)
          /* Copy the atoms from hlist into the PDB list                 */
          s=p;
          r=p->next;           /* Store the pointer to the next record   */
-         ALLOCNEXT(p,PDB);    /* Insert a record in the main list       */
+         ALLOCNEXTPDB(p);     /* Insert a record in the main list       */
          if(p == NULL)
          {
-            FREELIST(hlist, PDB);   /* 27.03.03 Fixed memory leak       */
+            FREEPDBLIST(hlist);     /* 27.03.03 Fixed memory leak       */
             return(FALSE);
          }
          
@@ -1221,10 +1226,10 @@ static BOOL AddH(PDB *hlist, PDB **position, int HType)
             NEXT(q);
             s=p;
             r=p->next;
-            ALLOCNEXT(p,PDB);
+            ALLOCNEXTPDB(p);
             if(p==NULL)
             {
-               FREELIST(hlist, PDB);   /* 27.03.03 Fixed memory leak    */
+               FREEPDBLIST(hlist);     /* 27.03.03 Fixed memory leak    */
                return(FALSE);
             }
             
@@ -1252,10 +1257,10 @@ static BOOL AddH(PDB *hlist, PDB **position, int HType)
             NEXT(q);
             s=p;
             r=p->next;
-            ALLOCNEXT(p,PDB);
+            ALLOCNEXTPDB(p);
             if(p==NULL)
             {
-               FREELIST(hlist, PDB);    /* 27.03.03 Fixed memory leak   */
+               FREEPDBLIST(hlist);      /* 27.03.03 Fixed memory leak   */
                return(FALSE);
             }
                
@@ -1278,7 +1283,7 @@ static BOOL AddH(PDB *hlist, PDB **position, int HType)
       }   /* End of matches                                             */
    }  /* End of main list                                               */
 
-   FREELIST(hlist, PDB);    /* 27.03.03 Fixed memory leak               */
+   FREEPDBLIST(hlist);      /* 27.03.03 Fixed memory leak               */
    return(TRUE);
 }
 
@@ -1418,7 +1423,12 @@ static PDB *StripDummyH(PDB *pdb, int *nhyd)
          (p->y > 9998.0)      &&
          (p->z > 9998.0))
       {
-         DELETE(pdb, p, PDB);
+         PDB *prev;
+         
+         FINDPREV(prev, pdb, p);
+         if(prev == NULL)
+            pdb = p->next;
+         p = blKillPDB(p, prev);
          (*nhyd)--;
       }
       else
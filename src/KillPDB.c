@@ -3,8 +3,8 @@
 
    \file       KillPDB.c
    
-   \version    V1.11
-   \date       07.07.14
+   \version    V1.12
+   \date       16.10.26
    \brief      
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2014
@@ -58,6 +58,8 @@
 -  V1.9  14.03.96 Added FindAtomInRes()
 -  V1.10 08.10.99 Initialised some variables
 -  V1.11 07.07.14 Use bl prefix for functions By: CTP
+-  V1.12 16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Doxygen
@@ -104,6 +106,8 @@
 -  12.05.92 Original
 -  11.03.94 Now handles prev==NULL to delete first item in a list
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Uses blFreePDBNode() so nodes from a PDBARENA are handed
+            back to the arena rather than free()'d
 */
 PDB *blKillPDB(PDB *pdb,              /* Pointer to record to kill      */
                PDB *prev)             /* Pointer to previous record     */
@@ -117,7 +121,7 @@ PDB *blKillPDB(PDB *pdb,              /* Pointer to record to kill      */
 
    if(prev!=NULL)
       prev->next = pdb->next;       /* Relink the list                  */
-   free(pdb);                       /* Free the item                    */
+   blFreePDBNode(pdb);              /* Free the item                    */
 
    return(p);
 }
@@ -0,0 +1,472 @@
+/************************************************************************/
+/**
+
+   \file       ModelIndex.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Byte-offset index of the models in a multi-model PDB file
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Builds, saves and loads an index of the file offset at which each 
+   model of a multi-model (NMR or ensemble) PDB file starts, so that a
+   model can be read by seeking straight to it rather than scanning 
+   all the models before it as blDoReadPDB() has to.
+
+   The index may be kept in a small sidecar file (the PDB filename with
+   .midx appended). This is plain text:
+      BIOPLIB MODEL INDEX V1
+      filesize nmodels
+      offset (one line per model)
+
+   Indexes can only be built for uncompressed, non-PDBML files since
+   these are the only ones on which we can seek.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   PDBMODELINDEX *index;
+   index = blGetPDBModelIndex("ensemble.pdb", TRUE);
+   fp    = fopen("ensemble.pdb", "r");
+   pdb   = blDoReadPDBIndexed(fp, index, &natoms, TRUE, 1, 3817);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP File IO
+
+   #FUNCTION  blBuildPDBModelIndex()
+   Scans a PDB file recording the offset at which each model starts
+
+   #FUNCTION  blWritePDBModelIndex()
+   Writes a model index to a file
+
+   #FUNCTION  blReadPDBModelIndex()
+   Reads a model index written by blWritePDBModelIndex()
+
+   #FUNCTION  blGetPDBModelIndex()
+   Loads the sidecar index for a PDB file if it is up to date, otherwise
+   builds (and optionally saves) it
+
+   #FUNCTION  blDoReadPDBIndexed()
+   As blDoReadPDB(), but seeks straight to the requested model using
+   an index
+
+   #FUNCTION  blFreePDBModelIndex()
+   Frees a model index
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "SysDefs.h"
+#include "macros.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF          160
+#define INDEX_ALLOCQUANT 256
+#define INDEX_EXTN       ".midx"
+#define INDEX_MAGIC      "BIOPLIB MODEL INDEX V1"
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL StoreOffset(PDBMODELINDEX *index, long offset, 
+                        int *maxmodels);
+
+
+/************************************************************************/
+/*>PDBMODELINDEX *blBuildPDBModelIndex(FILE *fp)
+   ---------------------------------------------
+*//**
+
+   \param[in]     *fp        PDB file
+   \return                   Model index. NULL if the file is compressed
+                             or PDBML, or if out of memory
+
+   Reads the PDB file from the current position, recording the offset at
+   which each model starts. Model 1 starts at the current position and 
+   each subsequent model starts immediately after an ENDMDL record, 
+   exactly as the models are counted by blDoReadPDB(). A file with no
+   ENDMDL records is a single model.
+
+   The file is left at end of file.
+
+-  16.10.26 Original
+*/
+PDBMODELINDEX *blBuildPDBModelIndex(FILE *fp)
+{
+   PDBMODELINDEX *index;
+   char          buffer[MAXBUFF];
+   int           ch,
+                 maxmodels = 0;
+   long          start;
+   BOOL          atoms     = FALSE;
+
+   /* We can't seek in compressed or PDBML files                        */
+   ch = fgetc(fp);
+   ungetc(ch, fp);
+   if((ch == 0x1F) || blCheckFileFormatPDBML(fp))
+      return(NULL);
+   
+   if((start = ftell(fp)) < 0)
+      return(NULL);
+
+   if((index = (PDBMODELINDEX *)malloc(sizeof(PDBMODELINDEX)))==NULL)
+      return(NULL);
+   index->offset   = NULL;
+   index->nmodels  = 0;
+   index->filesize = 0;
+
+   if(!StoreOffset(index, start, &maxmodels))
+   {
+      blFreePDBModelIndex(index);
+      return(NULL);
+   }
+
+   while(fgets(buffer, MAXBUFF, fp))
+   {
+      if(!strncmp(buffer, "ENDMDL", 6))
+      {
+         if(!StoreOffset(index, ftell(fp), &maxmodels))
+         {
+            blFreePDBModelIndex(index);
+            return(NULL);
+         }
+         atoms = FALSE;
+      }
+      else if(!strncmp(buffer, "ATOM  ", 6) ||
+              !strncmp(buffer, "HETATM", 6))
+      {
+         atoms = TRUE;
+      }
+   }
+   index->filesize = ftell(fp);
+
+   /* The last offset is after the final ENDMDL. Only count it as a 
+      model if it contains any atoms
+   */
+   if((index->nmodels > 1) && !atoms)
+      index->nmodels--;
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>BOOL blWritePDBModelIndex(FILE *fp, PDBMODELINDEX *index)
+   ---------------------------------------------------------
+*//**
+
+   \param[in]     *fp        Output file
+   \param[in]     *index     Model index
+   \return                   Success
+
+   Writes a model index in the format read by blReadPDBModelIndex()
+
+-  16.10.26 Original
+*/
+BOOL blWritePDBModelIndex(FILE *fp, PDBMODELINDEX *index)
+{
+   int i;
+   
+   fprintf(fp, "%s\n", INDEX_MAGIC);
+   fprintf(fp, "%ld %d\n", index->filesize, index->nmodels);
+   for(i=0; i<index->nmodels; i++)
+      fprintf(fp, "%ld\n", index->offset[i]);
+
+   return(ferror(fp) ? FALSE : TRUE);
+}
+
+
+/************************************************************************/
+/*>PDBMODELINDEX *blReadPDBModelIndex(FILE *fp)
+   --------------------------------------------
+*//**
+
+   \param[in]     *fp        Index file
+   \return                   Model index. NULL if the file is not a 
+                             valid index or out of memory
+
+   Reads a model index written by blWritePDBModelIndex()
+
+-  16.10.26 Original
+*/
+PDBMODELINDEX *blReadPDBModelIndex(FILE *fp)
+{
+   PDBMODELINDEX *index;
+   char          buffer[MAXBUFF];
+   int           i;
+
+   if(!fgets(buffer, MAXBUFF, fp) || 
+      strncmp(buffer, INDEX_MAGIC, strlen(INDEX_MAGIC)))
+      return(NULL);
+
+   if((index = (PDBMODELINDEX *)malloc(sizeof(PDBMODELINDEX)))==NULL)
+      return(NULL);
+   index->offset = NULL;
+
+   if((fscanf(fp, "%ld %d", &(index->filesize), &(index->nmodels)) != 2)
+      || (index->nmodels < 1))
+   {
+      blFreePDBModelIndex(index);
+      return(NULL);
+   }
+
+   if((index->offset = (long *)malloc(index->nmodels * sizeof(long)))
+      == NULL)
+   {
+      blFreePDBModelIndex(index);
+      return(NULL);
+   }
+   
+   for(i=0; i<index->nmodels; i++)
+   {
+      if(fscanf(fp, "%ld", &(index->offset[i])) != 1)
+      {
+         blFreePDBModelIndex(index);
+         return(NULL);
+      }
+   }
+   
+   return(index);
+}
+
+
+/************************************************************************/
+/*>PDBMODELINDEX *blGetPDBModelIndex(char *filename, BOOL save)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]     *filename  PDB filename
+   \param[in]     save       Write the sidecar index if it has to be 
+                             (re)built
+   \return                   Model index. NULL if one could not be 
+                             built
+
+   Gets the model index for a PDB file. If there is a sidecar file 
+   (filename.midx) which is no older than the PDB file and was built for
+   a file of the same size it is used. Otherwise the index is built by 
+   scanning the PDB file and, if requested, saved as the sidecar. 
+   Failure to save the sidecar (e.g. in a read-only directory) is not 
+   an error.
+
+-  16.10.26 Original
+*/
+PDBMODELINDEX *blGetPDBModelIndex(char *filename, BOOL save)
+{
+   PDBMODELINDEX *index = NULL;
+   char          *idxname;
+   struct stat   pdbstat, 
+                 idxstat;
+   FILE          *fp;
+
+   if(stat(filename, &pdbstat))
+      return(NULL);
+   
+   if((idxname = (char *)malloc((strlen(filename) + strlen(INDEX_EXTN) +
+                                 1) * sizeof(char)))==NULL)
+      return(NULL);
+   sprintf(idxname, "%s%s", filename, INDEX_EXTN);
+
+   /* Try the sidecar                                                   */
+   if(!stat(idxname, &idxstat) && (idxstat.st_mtime >= pdbstat.st_mtime))
+   {
+      if((fp = fopen(idxname, "r"))!=NULL)
+      {
+         index = blReadPDBModelIndex(fp);
+         fclose(fp);
+         
+         if((index != NULL) && (index->filesize != (long)pdbstat.st_size))
+         {
+            blFreePDBModelIndex(index);
+            index = NULL;
+         }
+      }
+   }
+
+   /* Build it                                                          */
+   if((index == NULL) && ((fp = fopen(filename, "r"))!=NULL))
+   {
+      index = blBuildPDBModelIndex(fp);
+      fclose(fp);
+      
+      if((index != NULL) && save && ((fp = fopen(idxname, "w"))!=NULL))
+      {
+         if(!blWritePDBModelIndex(fp, index))
+         {
+            fclose(fp);
+            remove(idxname);
+         }
+         else
+         {
+            fclose(fp);
+         }
+      }
+   }
+   
+   free(idxname);
+   return(index);
+}
+
+
+/************************************************************************/
+/*>PDB *blDoReadPDBIndexed(FILE *fp, PDBMODELINDEX *index, int *natom, 
+                           BOOL AllAtoms, int OccRank, int ModelNum)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *fp        PDB file from which the index was built
+   \param[in]     *index     Model index. If NULL, blDoReadPDB() is used
+   \param[out]    *natom     Number of atoms read. -1 if error.
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \param[in]     ModelNum   NMR Model number (0 = all)
+   \return                   A pointer to the first allocated item of
+                             the PDB linked list
+
+   As blDoReadPDB(), but seeks directly to the start of the model so
+   the time taken does not depend on the model number. Reading all 
+   models (ModelNum==0) is passed straight to blDoReadPDB(). A model 
+   number beyond the end of the index gives an empty list as it would 
+   with blDoReadPDB().
+
+-  16.10.26 Original
+*/
+PDB *blDoReadPDBIndexed(FILE *fp, PDBMODELINDEX *index, int *natom, 
+                        BOOL AllAtoms, int OccRank, int ModelNum)
+{
+   PDB *pdb;
+   
+   if((index == NULL) || (ModelNum < 1))
+      return(blDoReadPDB(fp, natom, AllAtoms, OccRank, ModelNum));
+
+   if(ModelNum > index->nmodels)
+   {
+      *natom = 0;
+      return(NULL);
+   }
+
+   if(fseek(fp, index->offset[ModelNum-1], SEEK_SET))
+   {
+      *natom = (-1);
+      return(NULL);
+   }
+
+   /* Reading 'model 1' from here gives us everything up to the next 
+      ENDMDL
+   */
+   pdb = blDoReadPDB(fp, natom, AllAtoms, OccRank, 1);
+   if(ModelNum > 1)
+      gPDBMultiNMR = TRUE;
+   
+   return(pdb);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBModelIndex(PDBMODELINDEX *index)
+   ----------------------------------------------
+*//**
+
+   \param[in]     *index     Model index
+
+   Frees a model index
+
+-  16.10.26 Original
+*/
+void blFreePDBModelIndex(PDBMODELINDEX *index)
+{
+   if(index != NULL)
+   {
+      if(index->offset != NULL)
+         free(index->offset);
+      free(index);
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL StoreOffset(PDBMODELINDEX *index, long offset, 
+                           int *maxmodels)
+   ----------------------------------------------------------
+*//**
+
+   \param[in,out] *index     Model index
+   \param[in]     offset     Offset of the start of a model
+   \param[in,out] *maxmodels Space allocated in the offset array
+   \return                   Success
+
+   Appends an offset to the index, growing the array as required
+
+-  16.10.26 Original
+*/
+static BOOL StoreOffset(PDBMODELINDEX *index, long offset, int *maxmodels)
+{
+   if(offset < 0)
+      return(FALSE);
+   
+   if(index->nmodels >= *maxmodels)
+   {
+      long *newoffset;
+      
+      *maxmodels += INDEX_ALLOCQUANT;
+      if((newoffset = (long *)realloc(index->offset, 
+                                      *maxmodels * sizeof(long)))==NULL)
+         return(FALSE);
+      index->offset = newoffset;
+   }
+
+   index->offset[(index->nmodels)++] = offset;
+   return(TRUE);
+}
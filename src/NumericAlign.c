@@ -3,8 +3,8 @@
 
    \file       NumericAlign.c
    
-   \version    V1.3
-   \date       07.07.14
+   \version    V1.5
+   \date       16.10.26
    \brief      Perform Needleman & Wunsch sequence alignment on two
                sequences encoded as numeric symbols.
    
@@ -67,6 +67,10 @@
                   first
 -  V1.2  06.02.03 Fixed for new version of GetWord()
 -  V1.3  07.07.14 Use bl prefix for functions By: CTP
+-  V1.4  16.10.26 Matrix is held in an alignment context. Added
+                  blNumericReadMDMCtx(), blNumericCalcMDMScoreCtx() and
+                  blNumericAffineAlignCtx()
+-  V1.5  16.10.26 Warning count is separate from those of align.c
 
 
 *************************************************************************/
@@ -85,6 +89,15 @@
    #FUNCTION  blNumericAffineAlign()
    Perform simple N&W alignment using sequences encodede as arrays of
    numeric tokens
+
+   #FUNCTION  blNumericReadMDMCtx()
+   As blNumericReadMDM() reading into an alignment context
+
+   #FUNCTION  blNumericCalcMDMScoreCtx()
+   As blNumericCalcMDMScore() using an alignment context
+
+   #FUNCTION  blNumericAffineAlignCtx()
+   As blNumericAffineAlign() using an alignment context
 */
 /************************************************************************/
 /* Includes
@@ -111,6 +124,8 @@
 
 #define MAXBUFF 2048
 
+#define CONTEXT(ctx) (((ctx)==NULL) ? &sDefaultContext : (ctx))
+
 /* Type definition to store a X,Y coordinate pair in the matrix         */
 typedef struct
 {
@@ -121,8 +136,9 @@ typedef struct
 /************************************************************************/
 /* Globals
 */
-static int  **sMDMScore;
-static int  sMDMSize = 0;
+static ALIGNCONTEXT sDefaultContext;  /* Used by the routines without a
+                                         context and when NULL is given
+                                         for the context              */
 
 /************************************************************************/
 /*
@@ -151,6 +167,12 @@ static int  NumericTraceBack(int **matrix, XY **dirn, int length1,
                              int length2, int *seq1, int *seq2, 
                              int *align1, int *align2, 
                              int *align_len);
+static int  NumericAlign(ALIGNCONTEXT *ctx, BOOL useWork, int *seq1, 
+                         int length1, int *seq2, int length2, 
+                         BOOL verbose, BOOL identity, int penalty, 
+                         int penext, int *align1, int *align2, 
+                         int *align_len);
+static BOOL NumericAllocWork(ALIGNCONTEXT *ctx, int dim);
 
 
 
@@ -233,29 +255,32 @@ static int NumericSearchForBest(int  **matrix,
 
 
 /************************************************************************/
-/*>BOOL blNumericReadMDM(char *mdmfile)
-   ------------------------------------
+/*>BOOL blNumericReadMDMCtx(ALIGNCONTEXT *ctx, char *mdmfile)
+   ----------------------------------------------------------
 *//**
 
+   \param[in,out] *ctx        Alignment context (NULL for the default)
    \param[in]     *mdmfile    Mutation data matrix filename
    \return                      Success?
    
-   Read mutation data matrix into static global arrays. The matrix may
+   Read mutation data matrix into an alignment context replacing any
+   matrix read previously. The matrix may
    have comments at the start introduced with a ! in the first column.
    The matrix must be complete (i.e. a triangular matrix will not
    work). A line describing the residue types must appear, and may
    be placed before or after the matrix itself
 
-   Identical to align.c/ReadMDM() but reads into a different static
-   2D array and doesn't read a symbol identifier line from the file
-   as the symbols are numeric and always start from 1 (0 is used as
-   the insert character)
+   Identical to align.c/ReadMDM() but doesn't read a symbol identifier
+   line from the file as the symbols are numeric and always start from
+   1 (0 is used as the insert character)
 
 -  08.03.00 Original based on align.c/ReadMDM() 26.07.95 By: ACRM
 -  06.02.03 Fixed for new version of GetWord()
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Renamed from blNumericReadMDM() and reads into an alignment
+            context
 */
-BOOL blNumericReadMDM(char *mdmfile)
+BOOL blNumericReadMDMCtx(ALIGNCONTEXT *ctx, char *mdmfile)
 {
    FILE *mdm = NULL;
    int  i, j;
@@ -264,11 +289,20 @@ BOOL blNumericReadMDM(char *mdmfile)
         *p;
    BOOL noenv;
 
+   ctx = CONTEXT(ctx);
    if((mdm=blOpenFile(mdmfile, DATAENV, "r", &noenv))==NULL)
    {
       return(FALSE);
    }
 
+   /* Free any matrix previously read into this context                 */
+   if(ctx->score != NULL)
+      blFreeArray2D((char **)ctx->score, ctx->size, ctx->size);
+   if(ctx->residues != NULL)
+      free(ctx->residues);
+   ctx->score    = NULL;
+   ctx->residues = NULL;
+
    /* Read over any comment lines                                       */
    while(fgets(buffer,MAXBUFF,mdm))
    {
@@ -279,20 +313,25 @@ BOOL blNumericReadMDM(char *mdmfile)
    }
 
    /* See how many fields there are in the buffer                       */
-   for(p = buffer, sMDMSize = 0; p!=NULL; sMDMSize++)
+   for(p = buffer, ctx->size = 0; p!=NULL; ctx->size++)
       p = blGetWord(p, word, 16);
 
 
    /* Allocate memory for the MDM and the AA List                       */
-   if((sMDMScore = (int **)blArray2D(sizeof(int),sMDMSize,sMDMSize))==NULL)
+   if((ctx->score = (int **)blArray2D(sizeof(int),ctx->size,ctx->size))
+      ==NULL)
+   {
+      fclose(mdm);
+      ctx->size = 0;
       return(FALSE);
+   }
 
    /* Fill the matrix with zeros                                        */
-   for(i=0; i<sMDMSize; i++)
+   for(i=0; i<ctx->size; i++)
    {
-      for(j=0; j<sMDMSize; j++)
+      for(j=0; j<ctx->size; j++)
       {
-         sMDMScore[i][j] = 0;
+         ctx->score[i][j] = 0;
       }
    }
    
@@ -306,10 +345,10 @@ BOOL blNumericReadMDM(char *mdmfile)
          blGetWord(buffer, word, 16);
          if(sscanf(word,"%d",&j))    /* A row of numbers                */
          {
-            for(p = buffer, j = 0; p!=NULL && j<sMDMSize; j++)
+            for(p = buffer, j = 0; p!=NULL && j<ctx->size; j++)
             {
                p = blGetWord(p, word, 16);
-               sscanf(word,"%d",&(sMDMScore[i][j]));
+               sscanf(word,"%d",&(ctx->score[i][j]));
             }
             i++;
          }
@@ -322,56 +361,101 @@ BOOL blNumericReadMDM(char *mdmfile)
 }
 
 /************************************************************************/
-/*>int blNumericCalcMDMScore(int resa, int resb)
-   ---------------------------------------------
+/*>BOOL blNumericReadMDM(char *mdmfile)
+   ------------------------------------
 *//**
 
+   \param[in]     *mdmfile    Mutation data matrix filename
+   \return                      Success?
+   
+   Read mutation data matrix for number-encoded sequences into the 
+   default alignment context. See blNumericReadMDMCtx()
+
+-  08.03.00 Original based on align.c/ReadMDM() 26.07.95 By: ACRM
+-  16.10.26 Now a wrapper to blNumericReadMDMCtx()
+*/
+BOOL blNumericReadMDM(char *mdmfile)
+{
+   return(blNumericReadMDMCtx(NULL, mdmfile));
+}
+
+/************************************************************************/
+/*>int blNumericCalcMDMScoreCtx(ALIGNCONTEXT *ctx, int resa, int resb)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in,out] *ctx      Alignment context (NULL for the default)
    \param[in]     resa      First token  
    \param[in]     resb      Second token  
    \return                  score
 
-   Calculate score from static globally stored mutation data matrix
+   Calculate score from the mutation data matrix in an alignment context
 
-   Identical to align.c/CalcMDMScore(), but uses a different static score
-   array and takes integer parameters. These are used as direct lookups
-   into the score array rather than being searched.
+   Identical to align.c/CalcMDMScore(), but takes integer parameters. 
+   These are used as direct lookups into the score array rather than 
+   being searched.
 
 -  08.03.00 Original based on align.c/CalcMDMScore() 11.07.96 By: ACRM
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Renamed from blNumericCalcMDMScore() and takes an alignment
+            context which also holds the warning count
+-  16.10.26 Has its own warning count in the context
 */
-int blNumericCalcMDMScore(int resa, int resb)
+int blNumericCalcMDMScoreCtx(ALIGNCONTEXT *ctx, int resa, int resb)
 {
    int        i,j;
-   static int NWarn = 0;
    BOOL       Warned = FALSE;
 
+   ctx = CONTEXT(ctx);
+
    i = resa-1;
    j = resb-1;
    
-   if(i>=sMDMSize) 
+   if(i>=ctx->size) 
    {
-      if(NWarn < 10)
+      if(ctx->nwarn[ALIGN_WARN_NUMERIC] < 10)
          printf("Token %d not found in matrix\n",resa);
-      else if(NWarn == 10)
+      else if(ctx->nwarn[ALIGN_WARN_NUMERIC] == 10)
          printf("More token not found in matrix...\n");
       Warned = TRUE;
    }
-   if(j>=sMDMSize) 
+   if(j>=ctx->size) 
    {
-      if(NWarn < 10)
+      if(ctx->nwarn[ALIGN_WARN_NUMERIC] < 10)
          printf("Token %d not found in matrix\n",resb);
-      else if(NWarn == 10)
+      else if(ctx->nwarn[ALIGN_WARN_NUMERIC] == 10)
          printf("More tokens not found in matrix...\n");
       Warned = TRUE;
    }
    
    if(Warned)
    { 
-      NWarn++;
+      ctx->nwarn[ALIGN_WARN_NUMERIC]++;
       return(0);
    }
 
-   return(sMDMScore[i][j]);
+   return(ctx->score[i][j]);
+}
+
+
+/************************************************************************/
+/*>int blNumericCalcMDMScore(int resa, int resb)
+   ---------------------------------------------
+*//**
+
+   \param[in]     resa      First token  
+   \param[in]     resb      Second token  
+   \return                  score
+
+   Calculate score from the mutation data matrix in the default 
+   alignment context
+
+-  08.03.00 Original based on align.c/CalcMDMScore() 11.07.96 By: ACRM
+-  16.10.26 Now a wrapper to blNumericCalcMDMScoreCtx()
+*/
+int blNumericCalcMDMScore(int resa, int resb)
+{
+   return(blNumericCalcMDMScoreCtx(NULL, resa, resb));
 }                               
 
 /************************************************************************/
@@ -408,6 +492,7 @@ int blNumericCalcMDMScore(int resa, int resb)
 
 -  08.03.00 Original based on align.c/affinealign() 06.03.00 By: ACRM
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Now a wrapper to NumericAlign() using the default context
 */
 int blNumericAffineAlign(int  *seq1, 
                          int  length1, 
@@ -420,6 +505,76 @@ int blNumericAffineAlign(int  *seq1,
                          int  *align1, 
                          int  *align2,
                          int  *align_len)
+{
+   return(NumericAlign(&sDefaultContext, FALSE, seq1, length1, seq2, 
+                       length2, verbose, identity, penalty, penext, 
+                       align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>int blNumericAffineAlignCtx(ALIGNCONTEXT *ctx, int *seq1, int length1,
+                               int *seq2, int length2, BOOL verbose, 
+                               BOOL identity, int *align1, int *align2,
+                               int *align_len)
+   ---------------------------------------------------------------------
+*//**
+
+   As blNumericAffineAlign() but uses the matrix and gap penalties from
+   an alignment context read with blNumericReadMDMCtx(). The score and 
+   path matrices are kept in the context and reused by later 
+   alignments.
+
+-  16.10.26 Original
+*/
+int blNumericAffineAlignCtx(ALIGNCONTEXT *ctx, 
+                            int  *seq1, 
+                            int  length1, 
+                            int  *seq2, 
+                            int  length2, 
+                            BOOL verbose, 
+                            BOOL identity, 
+                            int  *align1, 
+                            int  *align2,
+                            int  *align_len)
+{
+   return(NumericAlign(CONTEXT(ctx), (ctx != NULL), seq1, length1, 
+                       seq2, length2, verbose, identity, 
+                       CONTEXT(ctx)->penalty, CONTEXT(ctx)->penext,
+                       align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>static int NumericAlign(ALIGNCONTEXT *ctx, BOOL useWork, int *seq1, 
+                           int length1, int *seq2, int length2, 
+                           BOOL verbose, BOOL identity, int penalty, 
+                           int penext, int *align1, int *align2, 
+                           int *align_len)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in,out] *ctx          Alignment context for the MDM
+   \param[in]     useWork       Use the context's work space for the 
+                                score and path matrices
+
+   Other parameters and return as blNumericAffineAlign()
+
+-  16.10.26 Original from blNumericAffineAlign()
+*/
+static int NumericAlign(ALIGNCONTEXT *ctx,
+                        BOOL useWork,
+                        int  *seq1, 
+                        int  length1, 
+                        int  *seq2, 
+                        int  length2, 
+                        BOOL verbose, 
+                        BOOL identity, 
+                        int  penalty, 
+                        int  penext,
+                        int  *align1, 
+                        int  *align2,
+                        int  *align_len)
 {
    XY    **dirn   = NULL;
    int   **matrix = NULL,
@@ -435,11 +590,26 @@ int blNumericAffineAlign(int  *seq1,
    
    maxdim = MAX(length1, length2);
    
-   /* Initialise the score matrix                                       */
-   if((matrix = (int **)blArray2D(sizeof(int), maxdim, maxdim))==NULL)
-      return(0);
-   if((dirn   = (XY **)blArray2D(sizeof(XY), maxdim, maxdim))==NULL)
-      return(0);
+   /* Initialise the score matrix, reusing the context's work space if
+      required
+   */
+   if(useWork)
+   {
+      if(!NumericAllocWork(ctx, maxdim))
+         return(0);
+      matrix = ctx->matrix;
+      dirn   = (XY **)ctx->dirn;
+   }
+   else
+   {
+      if((matrix = (int **)blArray2D(sizeof(int), maxdim, maxdim))==NULL)
+         return(0);
+      if((dirn   = (XY **)blArray2D(sizeof(XY), maxdim, maxdim))==NULL)
+      {
+         blFreeArray2D((char **)matrix, maxdim, maxdim);
+         return(0);
+      }
+   }
       
    for(i=0;i<maxdim;i++)
    {
@@ -460,8 +630,9 @@ int blNumericAffineAlign(int  *seq1,
       }
       else
       {
-         matrix[length1-1][j] = blNumericCalcMDMScore(seq1[length1-1], 
-                                                      seq2[j]);
+         matrix[length1-1][j] = blNumericCalcMDMScoreCtx(ctx, 
+                                                         seq1[length1-1], 
+                                                         seq2[j]);
       }
    }
 
@@ -474,8 +645,8 @@ int blNumericAffineAlign(int  *seq1,
       }
       else
       {
-         matrix[i][length2-1] = blNumericCalcMDMScore(seq1[i], 
-                                                      seq2[length2-1]);
+         matrix[i][length2-1] = blNumericCalcMDMScoreCtx(ctx, seq1[i], 
+                                                         seq2[length2-1]);
       }
    }
 
@@ -558,7 +729,7 @@ int blNumericAffineAlign(int  *seq1,
          }
          else
          {
-            matrix[i1][j] += blNumericCalcMDMScore(seq1[i1],seq2[j]);
+            matrix[i1][j] += blNumericCalcMDMScoreCtx(ctx, seq1[i1],seq2[j]);
          }
       }
 
@@ -632,7 +803,7 @@ int blNumericAffineAlign(int  *seq1,
          }
          else
          {
-            matrix[i][j1] += blNumericCalcMDMScore(seq1[i],seq2[j1]);
+            matrix[i][j1] += blNumericCalcMDMScoreCtx(ctx, seq1[i],seq2[j1]);
          }
       }
    } 
@@ -663,12 +834,54 @@ int blNumericAffineAlign(int  *seq1,
       }
    }
     
-   blFreeArray2D((char **)matrix, maxdim, maxdim);
-   blFreeArray2D((char **)dirn,   maxdim, maxdim);
+   if(!useWork)
+   {
+      blFreeArray2D((char **)matrix, maxdim, maxdim);
+      blFreeArray2D((char **)dirn,   maxdim, maxdim);
+   }
     
    return(score);
 }
 
+
+/************************************************************************/
+/*>static BOOL NumericAllocWork(ALIGNCONTEXT *ctx, int dim)
+   --------------------------------------------------------
+*//**
+
+   \param[in,out] *ctx      Alignment context
+   \param[in]     dim       Dimension of score and path matrices needed
+   \return                  Success?
+
+   Makes sure that the work space in the context is big enough. 
+   Identical to align.c/AllocContextWork()
+
+-  16.10.26 Original
+*/
+static BOOL NumericAllocWork(ALIGNCONTEXT *ctx, int dim)
+{
+   if(ctx->workDim >= dim)
+      return(TRUE);
+
+   if(ctx->matrix != NULL)
+      blFreeArray2D((char **)ctx->matrix, ctx->workDim, ctx->workDim);
+   if(ctx->dirn != NULL)
+      blFreeArray2D(ctx->dirn, ctx->workDim, ctx->workDim);
+   ctx->dirn    = NULL;
+   ctx->workDim = 0;
+
+   if((ctx->matrix = (int **)blArray2D(sizeof(int), dim, dim))==NULL)
+      return(FALSE);
+   if((ctx->dirn = blArray2D(sizeof(XY), dim, dim))==NULL)
+   {
+      blFreeArray2D((char **)ctx->matrix, dim, dim);
+      ctx->matrix = NULL;
+      return(FALSE);
+   }
+   ctx->workDim = dim;
+   return(TRUE);
+}
+
 /************************************************************************/
 /*>static int NumericTraceBack(int **matrix, XY **dirn, 
                                int length1, int length2, 
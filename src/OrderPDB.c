@@ -3,8 +3,8 @@
 
    \file       OrderPDB.c
    
-   \version    V1.4
-   \date       07.07.14
+   \version    V1.6
+   \date       16.10.26
    \brief      Functions to modify atom order in PDB linked list
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
@@ -51,6 +51,9 @@
 -  V1.2  18.03.94 Bug fix in ShuffleResPDB().
 -  V1.3  22.06.08 Bug fix in ShuffleBB()
 -  V1.4  07.07.14 Use bl prefix for functions By: CTP
+-  V1.5  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
+-  V1.6  16.10.26 Sets the atom code of the records it adds
 
 
 *************************************************************************/
@@ -266,7 +269,7 @@ PDB *blShuffleResPDB(PDB *start, PDB *end, BOOL Pad)
 
             if(Pad && !found)
             {
-               INIT(extra,PDB);
+               INITPDB(extra);
                
                if(extra != NULL)
                {
@@ -278,6 +281,7 @@ PDB *blShuffleResPDB(PDB *start, PDB *end, BOOL Pad)
    
                   /* Set required atom name and NULL coordinates        */
                   strcpy(extra->atnam,atnam);
+                  extra->atcode = (short)blGetAtomCode(extra->atnam);
                   extra->x    = (REAL)9999.0;
                   extra->y    = (REAL)9999.0;
                   extra->z    = (REAL)9999.0;
@@ -316,7 +320,7 @@ PDB *blShuffleResPDB(PDB *start, PDB *end, BOOL Pad)
       /* Terminate the list there                                       */
       p->next = NULL;
       /* Free the discard list                                          */
-      FREELIST(start, PDB);
+      FREEPDBLIST(start);
    }
 
    /* Return start of shuffled list                                     */
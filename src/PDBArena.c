@@ -0,0 +1,635 @@
+/************************************************************************/
+/**
+
+   \file       PDBArena.c
+   
+   \version    V1.2
+   \date       16.10.26
+   \brief      Arena allocation of PDB linked-list nodes
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Arena allocation for PDB linked lists. Normally each atom read is
+   obtained with its own malloc() and the list is freed one node at a
+   time. When an arena is made current (by setting gPDBArena or calling
+   blUsePDBArena()), blAllocPDB() - and hence all the library routines
+   that build PDB linked lists - instead carve nodes from large slabs.
+   Consecutive atoms are therefore contiguous in memory and the whole
+   structure is released with a single call to blFreePDBArena().
+
+   Nodes from an arena must NOT be passed to free(). blKillPDB(),
+   blFreePDB(), FREEPDBLIST() and the library routines which delete
+   atoms check whether a node belongs to a live arena: if it does, the
+   node is kept for re-use by the arena, otherwise it is free()'d as
+   before. Code which never creates an arena is unaffected.
+
+   The check uses an index of the slabs keyed on address, so it takes 
+   the same time however many slabs exist. Each slab is entered for 
+   every 64KB range of addresses (a chunk) that it covers.
+
+   gPDBArena is local to each thread (where the compiler supports 
+   this), so threads may each read into their own arena. The address
+   index is shared and, unless the library is built with NOTHREADS 
+   defined, is protected by a mutex; programs must then be linked with
+   -lpthread. An arena itself, and the nodes allocated from it, must 
+   only be used by one thread at a time.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   PDBARENA *arena = blNewPDBArena(0);
+   PDBARENA *old   = blUsePDBArena(arena);
+   pdb = blReadPDB(fp, &natoms);
+   blUsePDBArena(old);
+   ...
+   blFreePDBArena(arena);           Frees pdb and anything else
+                                    allocated from the arena
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 blAllocPDB() clears the interned codes
+-  V1.2  16.10.26 Nodes are looked up in an address index rather than
+                  by searching every slab. gPDBArena is local to each
+                  thread and the index is protected by a mutex
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Memory management
+
+   #FUNCTION  blNewPDBArena()
+   Creates an arena from which PDB nodes may be allocated in bulk
+
+   #FUNCTION  blFreePDBArena()
+   Frees an arena and every PDB node allocated from it
+
+   #FUNCTION  blResetPDBArena()
+   Empties an arena for re-use without returning its slabs
+
+   #FUNCTION  blUsePDBArena()
+   Makes an arena the current arena used by blAllocPDB()
+
+   #FUNCTION  blAllocPDB()
+   Allocates a PDB node from the current arena or with malloc()
+
+   #FUNCTION  blPDBInArena()
+   Tests whether a PDB node was allocated from a live arena
+
+   #FUNCTION  blFreePDBNode()
+   Frees a single PDB node allocated by blAllocPDB() or malloc()
+
+   #FUNCTION  blFreePDB()
+   Frees a PDB linked list whose nodes may come from an arena
+*/
+/************************************************************************/
+/* Includes
+*/
+#ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L   /* For pthreads                     */
+#endif
+#include "port.h"
+
+#include <stdlib.h>
+#ifndef NOTHREADS
+#  include <pthread.h>
+#endif
+
+#include "SysDefs.h"
+#define PDBARENA_MAIN
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define DEF_SLABSIZE 4096
+#define CHUNKSHIFT   16      /* Address index covers 64KB per entry     */
+#define INDEXSIZE    4096    /* Hash buckets in the address index       */
+
+#define ADDRCHUNK(p) ((unsigned long)((size_t)(p) >> CHUNKSHIFT))
+#define INDEXHASH(c) ((int)((c) % INDEXSIZE))
+
+#ifdef NOTHREADS
+#  define LOCKINDEX()
+#  define UNLOCKINDEX()
+#else
+#  define LOCKINDEX()   pthread_mutex_lock(&sIndexMutex)
+#  define UNLOCKINDEX() pthread_mutex_unlock(&sIndexMutex)
+#endif
+
+/************************************************************************/
+/* Globals
+*/
+static PDBSLABENTRY *sIndex[INDEXSIZE]; /* Slabs by address chunk       */
+static long         sNSlabs = 0;        /* Live slabs in the index      */
+#ifndef NOTHREADS
+static pthread_mutex_t sIndexMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/************************************************************************/
+/* Prototypes
+*/
+static PDBSLAB *FindSlab(PDB *p);
+static PDBSLAB *NewSlab(PDBARENA *arena);
+static BOOL IndexSlab(PDBSLAB *s);
+static void UnindexSlab(PDBSLAB *s);
+
+
+/************************************************************************/
+/*>PDBARENA *blNewPDBArena(int slabsize)
+   -------------------------------------
+*//**
+
+   \param[in]     slabsize   Number of PDB nodes per slab (0 for the
+                             default)
+   \return                   The arena (NULL if out of memory)
+
+   Creates an empty arena. No memory is allocated for nodes until the
+   first call to blAllocPDB() while the arena is current.
+
+-  16.10.26 Original
+*/
+PDBARENA *blNewPDBArena(int slabsize)
+{
+   PDBARENA *arena;
+
+   if((arena = (PDBARENA *)malloc(sizeof(PDBARENA)))==NULL)
+      return(NULL);
+
+   arena->slabs    = NULL;
+   arena->freed    = NULL;
+   arena->nnodes   = 0;
+   arena->slabsize = (slabsize > 0) ? slabsize : DEF_SLABSIZE;
+
+   return(arena);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBArena(PDBARENA *arena)
+   ------------------------------------
+*//**
+
+   \param[in]     *arena    The arena
+
+   Frees the arena together with every PDB node allocated from it. Any
+   lists built from the arena must not be used afterwards. The extras
+   fields of the nodes are not freed. If the arena is current in this
+   thread, gPDBArena is cleared.
+
+-  16.10.26 Original
+-  16.10.26 Removes the slabs from the address index
+*/
+void blFreePDBArena(PDBARENA *arena)
+{
+   PDBSLAB  *s, 
+            *next;
+
+   if(arena == NULL)
+      return;
+
+   LOCKINDEX();
+   for(s=arena->slabs; s!=NULL; s=s->next)
+      UnindexSlab(s);
+   UNLOCKINDEX();
+
+   for(s=arena->slabs; s!=NULL; s=next)
+   {
+      next = s->next;
+      free(s->entries);
+      free(s->nodes);
+      free(s);
+   }
+
+   if(gPDBArena == arena)
+      gPDBArena = NULL;
+
+   free(arena);
+}
+
+
+/************************************************************************/
+/*>void blResetPDBArena(PDBARENA *arena)
+   -------------------------------------
+*//**
+
+   \param[in]     *arena    The arena
+
+   Marks every node in the arena as unused so that the memory may be
+   re-used for another structure without being returned to the system.
+   As with blFreePDBArena(), lists built from the arena are invalidated.
+
+-  16.10.26 Original
+*/
+void blResetPDBArena(PDBARENA *arena)
+{
+   PDBSLAB *s;
+
+   if(arena == NULL)
+      return;
+
+   for(s=arena->slabs; s!=NULL; s=s->next)
+      s->nused = 0;
+
+   arena->freed  = NULL;
+   arena->nnodes = 0;
+}
+
+
+/************************************************************************/
+/*>PDBARENA *blUsePDBArena(PDBARENA *arena)
+   ----------------------------------------
+*//**
+
+   \param[in]     *arena    The arena to make current (NULL to return to
+                            malloc() for each node)
+   \return                  The previously current arena
+
+   Sets gPDBArena, returning the old value so that it may be restored.
+   This only affects the calling thread.
+
+-  16.10.26 Original
+*/
+PDBARENA *blUsePDBArena(PDBARENA *arena)
+{
+   PDBARENA *old = gPDBArena;
+   gPDBArena = arena;
+   return(old);
+}
+
+
+/************************************************************************/
+/*>PDB *blAllocPDB(void)
+   ---------------------
+*//**
+
+   \return                  A new PDB node with next set to NULL and the
+                            interned codes unset (NULL if out of memory)
+
+   Allocates a PDB node. If gPDBArena is set, the node is taken from the
+   arena; otherwise it is obtained with malloc(). This is what the
+   INITPDB() and ALLOCNEXTPDB() macros call.
+
+-  16.10.26 Original
+-  16.10.26 Clears the interned codes
+*/
+PDB *blAllocPDB(void)
+{
+   PDBARENA *arena = gPDBArena;
+   PDBSLAB  *s;
+   PDB      *p;
+
+   if(arena == NULL)
+   {
+      if((p = (PDB *)malloc(sizeof(PDB)))!=NULL)
+      {
+         p->next    = NULL;
+         p->rescode = p->atcode = p->elemcode = PDBCODE_UNSET;
+      }
+      return(p);
+   }
+
+   if(arena->freed != NULL)
+   {
+      p            = arena->freed;
+      arena->freed = p->next;
+   }
+   else
+   {
+      /* Nodes come from the slab at the head of the list. When that is
+         full, any slab with room (after a reset) is moved to the head;
+         otherwise a new slab is added
+      */
+      s = arena->slabs;
+      if((s == NULL) || (s->nused >= s->nalloc))
+      {
+         PDBSLAB *prev = NULL;
+         
+         for(s=arena->slabs; s!=NULL; s=s->next)
+         {
+            if(s->nused < s->nalloc)
+               break;
+            prev = s;
+         }
+
+         if(s == NULL)
+         {
+            if((s = NewSlab(arena))==NULL)
+               return(NULL);
+         }
+         else if(prev != NULL)
+         {
+            prev->next   = s->next;
+            s->next      = arena->slabs;
+            arena->slabs = s;
+         }
+      }
+
+      p = s->nodes + s->nused++;
+   }
+
+   p->next    = NULL;
+   p->rescode = p->atcode = p->elemcode = PDBCODE_UNSET;
+   arena->nnodes++;
+   return(p);
+}
+
+
+/************************************************************************/
+/*>BOOL blPDBInArena(PDB *p)
+   -------------------------
+*//**
+
+   \param[in]     *p        A PDB node
+   \return                  Was the node allocated from a live arena?
+
+-  16.10.26 Original
+-  16.10.26 Uses the address index
+*/
+BOOL blPDBInArena(PDB *p)
+{
+   BOOL inArena;
+
+   LOCKINDEX();
+   inArena = (BOOL)(FindSlab(p) != NULL);
+   UNLOCKINDEX();
+
+   return(inArena);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBNode(PDB *p)
+   --------------------------
+*//**
+
+   \param[in]     *p        A PDB node which has been unlinked from its
+                            list
+
+   Frees a single node. Nodes from an arena are kept by that arena for
+   re-use; others are free()'d.
+
+-  16.10.26 Original
+-  16.10.26 Uses the address index
+*/
+void blFreePDBNode(PDB *p)
+{
+   PDBSLAB *s;
+
+   if(p == NULL)
+      return;
+
+   LOCKINDEX();
+   if((s = FindSlab(p)) != NULL)
+   {
+      p->next         = s->arena->freed;
+      s->arena->freed = p;
+      s->arena->nnodes--;
+   }
+   UNLOCKINDEX();
+
+   if(s == NULL)
+      free(p);
+}
+
+
+/************************************************************************/
+/*>void blFreePDB(PDB *pdb)
+   ------------------------
+*//**
+
+   \param[in]     *pdb      A PDB linked list
+
+   Frees a PDB linked list, which may be a mixture of nodes from arenas
+   and from malloc(). Use this (or FREEPDBLIST()) in place of
+   FREELIST(pdb, PDB) for any list which may have been built while an
+   arena was current. When no arena exists, this is just FREELIST().
+
+-  16.10.26 Original
+-  16.10.26 Looks up each node in the address index with one lock for
+            the whole list
+*/
+void blFreePDB(PDB *pdb)
+{
+   PDB     *next;
+   PDBSLAB *s;
+
+   LOCKINDEX();
+   while(pdb != NULL)
+   {
+      next = pdb->next;
+      if((s = FindSlab(pdb)) == NULL)
+      {
+         free(pdb);
+      }
+      else
+      {
+         pdb->next       = s->arena->freed;
+         s->arena->freed = pdb;
+         s->arena->nnodes--;
+      }
+      pdb  = next;
+   }
+   UNLOCKINDEX();
+}
+
+
+/************************************************************************/
+/*>static PDBSLAB *FindSlab(PDB *p)
+   --------------------------------
+*//**
+
+   \param[in]     *p        A PDB node
+   \return                  The live slab containing the node, or NULL
+
+   Looks up the node's address chunk in the address index. Only the
+   slabs covering that chunk are checked and the node itself is never
+   dereferenced. The caller must hold the index lock.
+
+-  16.10.26 Original
+-  16.10.26 Uses the address index rather than searching every slab.
+            The owning arena is now found from the slab
+*/
+static PDBSLAB *FindSlab(PDB *p)
+{
+   PDBSLABENTRY  *e;
+   unsigned long chunk;
+
+   if((sNSlabs == 0) || (p == NULL))
+      return(NULL);
+
+   chunk = ADDRCHUNK(p);
+   for(e=sIndex[INDEXHASH(chunk)]; e!=NULL; e=e->next)
+   {
+      if((e->chunk == chunk) &&
+         (p >= e->slab->nodes) && (p < e->slab->nodes + e->slab->nalloc))
+         return(e->slab);
+   }
+
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static PDBSLAB *NewSlab(PDBARENA *arena)
+   ----------------------------------------
+*//**
+
+   \param[in,out] *arena    The arena
+   \return                  The new slab (NULL if out of memory)
+
+   Adds an empty slab to the head of the arena's slab list and enters
+   it in the address index.
+
+-  16.10.26 Original
+-  16.10.26 Enters the slab in the address index
+*/
+static PDBSLAB *NewSlab(PDBARENA *arena)
+{
+   PDBSLAB *s;
+   BOOL    ok;
+
+   if((s = (PDBSLAB *)malloc(sizeof(PDBSLAB)))==NULL)
+      return(NULL);
+
+   if((s->nodes = (PDB *)malloc(arena->slabsize * sizeof(PDB)))==NULL)
+   {
+      free(s);
+      return(NULL);
+   }
+
+   s->nused     = 0;
+   s->nalloc    = arena->slabsize;
+   s->arena     = arena;
+
+   LOCKINDEX();
+   ok = IndexSlab(s);
+   UNLOCKINDEX();
+   if(!ok)
+   {
+      free(s->nodes);
+      free(s);
+      return(NULL);
+   }
+
+   s->next      = arena->slabs;
+   arena->slabs = s;
+
+   return(s);
+}
+
+
+/************************************************************************/
+/*>static BOOL IndexSlab(PDBSLAB *s)
+   ---------------------------------
+*//**
+
+   \param[in,out] *s        A new slab
+   \return                  Success (FALSE if out of memory)
+
+   Enters the slab in the address index once for each address chunk 
+   that it covers. The caller must hold the index lock.
+
+-  16.10.26 Original
+*/
+static BOOL IndexSlab(PDBSLAB *s)
+{
+   unsigned long first, 
+                 last;
+   int           i, 
+                 bucket;
+
+   first = ADDRCHUNK(s->nodes);
+   last  = ADDRCHUNK((char *)(s->nodes + s->nalloc) - 1);
+
+   s->nentries = (int)(last - first + 1);
+   if((s->entries = (PDBSLABENTRY *)malloc(s->nentries * 
+                                           sizeof(PDBSLABENTRY)))==NULL)
+      return(FALSE);
+
+   for(i=0; i<s->nentries; i++)
+   {
+      bucket               = INDEXHASH(first + i);
+      s->entries[i].slab   = s;
+      s->entries[i].chunk  = first + i;
+      s->entries[i].next   = sIndex[bucket];
+      sIndex[bucket]       = &(s->entries[i]);
+   }
+   sNSlabs++;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void UnindexSlab(PDBSLAB *s)
+   -----------------------------------
+*//**
+
+   \param[in]     *s        A slab which is about to be freed
+
+   Removes the slab's entries from the address index. The entries
+   themselves are freed with the slab. The caller must hold the index 
+   lock.
+
+-  16.10.26 Original
+*/
+static void UnindexSlab(PDBSLAB *s)
+{
+   PDBSLABENTRY *e,
+                *prev;
+   int          i, 
+                bucket;
+
+   for(i=0; i<s->nentries; i++)
+   {
+      bucket = INDEXHASH(s->entries[i].chunk);
+      prev   = NULL;
+      for(e=sIndex[bucket]; e!=NULL; e=e->next)
+      {
+         if(e == &(s->entries[i]))
+         {
+            if(prev == NULL)
+               sIndex[bucket] = e->next;
+            else
+               prev->next     = e->next;
+            break;
+         }
+         prev = e;
+      }
+   }
+   sNSlabs--;
+}
+
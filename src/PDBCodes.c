@@ -0,0 +1,521 @@
+/************************************************************************/
+/**
+
+   \file       PDBCodes.c
+
+   \version    V1.1
+   \date       16.10.26
+   \brief      Interned integer codes for residue names, atom names and
+               elements
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   The PDB readers set three small integer codes in each PDB record as
+   well as the usual strings:
+
+      rescode   The residue name (PDBRES_ALA, etc.). Only the first 3
+                characters are used, as in ISWATER() and blThrone()
+      atcode    The atom name (PDBATOM_N, etc.). All 4 characters are
+                used, as in strncmp(p->atnam, "CA  ", 4)
+      elemcode  The element - this is the atomic number
+
+   Names that are not in the tables get PDBCODE_OTHER. PDBCODE_UNSET
+   (0) means the codes have not been set, for example in a record built
+   by hand, so the strings must be used; ATNAMCODEMATCH() and
+   RESNAMCODEMATCH() do this. Code that changes the names in a PDB
+   record that has come from a reader must call blSetPDBCodes().
+
+   The tables are fixed, so the codes are the same in every program
+   and lookups are safe from several threads. Each table is searched
+   with a binary search on the names packed into integers.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   if(ATNAMCODEMATCH(p, PDBATOM_CA, "CA  "))
+      ...
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 The binary search uses tables of packed names rather
+                  than packing each name as it is compared
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Miscellaneous functions
+
+   #FUNCTION  blGetResCode()
+   Gets the interned code for a residue name
+
+   #FUNCTION  blGetAtomCode()
+   Gets the interned code for an atom name
+
+   #FUNCTION  blGetElementCode()
+   Gets the interned code (atomic number) for an element
+
+   #FUNCTION  blResCodeName()
+   Gets the residue name for a code
+
+   #FUNCTION  blAtomCodeName()
+   Gets the atom name for a code
+
+   #FUNCTION  blElementCodeName()
+   Gets the element symbol for a code
+
+   #FUNCTION  blSetPDBCodes()
+   Sets the interned codes in a PDB record from its strings
+
+   #FUNCTION  blSetPDBListCodes()
+   Sets the interned codes in every record of a PDB linked list
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <string.h>
+#include <ctype.h>
+
+#include "SysDefs.h"
+#include "macros.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NRESCODES   46
+#define NATOMCODES  41
+#define NELEMCODES  118
+
+/* Names packed into integers, first character in the top byte         */
+#define KEY2(a,b)      (((unsigned long)(a) << 8) | (unsigned long)(b))
+#define KEY3(a,b,c)    ((KEY2(a,b) << 8) | (unsigned long)(c))
+#define KEY4(a,b,c,d)  ((KEY3(a,b,c) << 8) | (unsigned long)(d))
+
+typedef struct
+{
+   unsigned long key;
+   short         code;
+}  CODEKEY;
+
+/************************************************************************/
+/* Globals
+*/
+
+/* Names in code order. The first NUMAAKNOWN residues are in the same
+   order as the tables in throne.c
+*/
+static char *sResNames[NRESCODES] =
+{
+   "ALA", "CYS", "ASP", "GLU", "PHE", "GLY", "HIS", "ILE", "LYS", "LEU",
+   "MET", "ASN", "PRO", "GLN", "ARG", "SER", "THR", "VAL", "TRP", "TYR",
+   "PCA", "ASX", "GLX", "PGA", "CGN", "PYL", "SEC",
+   "  A", "  T", "  C", "  G", "  U", "  I",
+   " DA", " DT", " DC", " DG", " DI", "UNK",
+   "HOH", "OH2", "OHH", "DOD", "OD2", "ODD", "WAT"
+};
+
+static char *sAtomNames[NATOMCODES] =
+{
+   "N   ", "CA  ", "C   ", "O   ", "OXT ", "CB  ", "H   ", "HA  ",
+   "CG  ", "CG1 ", "CG2 ", "CD  ", "CD1 ", "CD2 ", "CE  ", "CE1 ",
+   "CE2 ", "CE3 ", "CZ  ", "CZ2 ", "CZ3 ", "CH2 ", "ND1 ", "ND2 ",
+   "NE  ", "NE1 ", "NE2 ", "NH1 ", "NH2 ", "NZ  ", "OD1 ", "OD2 ",
+   "OE1 ", "OE2 ", "OG  ", "OG1 ", "OH  ", "SD  ", "SG  ", "OT1 ",
+   "OT2 "
+};
+
+static char *sElementNames[NELEMCODES] =
+{
+   "H ", "HE", "LI", "BE", "B ", "C ", "N ", "O ", "F ", "NE",
+   "NA", "MG", "AL", "SI", "P ", "S ", "CL", "AR", "K ", "CA",
+   "SC", "TI", "V ", "CR", "MN", "FE", "CO", "NI", "CU", "ZN",
+   "GA", "GE", "AS", "SE", "BR", "KR", "RB", "SR", "Y ", "ZR",
+   "NB", "MO", "TC", "RU", "RH", "PD", "AG", "CD", "IN", "SN",
+   "SB", "TE", "I ", "XE", "CS", "BA", "LA", "CE", "PR", "ND",
+   "PM", "SM", "EU", "GD", "TB", "DY", "HO", "ER", "TM", "YB",
+   "LU", "HF", "TA", "W ", "RE", "OS", "IR", "PT", "AU", "HG",
+   "TL", "PB", "BI", "PO", "AT", "RN", "FR", "RA", "AC", "TH",
+   "PA", "U ", "NP", "PU", "AM", "CM", "BK", "CF", "ES", "FM",
+   "MD", "NO", "LR", "RF", "DB", "SG", "BH", "HS", "MT", "DS",
+   "RG", "CN", "NH", "FL", "MC", "LV", "TS", "OG"
+};
+
+/* Packed names, in order, with their codes for the binary search.
+   Remember to update these if adding to the tables above!
+*/
+static CODEKEY sResKeys[NRESCODES] =
+{
+   {KEY3(' ',' ','A'),  28}, {KEY3(' ',' ','C'),  30},
+   {KEY3(' ',' ','G'),  31}, {KEY3(' ',' ','I'),  33},
+   {KEY3(' ',' ','T'),  29}, {KEY3(' ',' ','U'),  32},
+   {KEY3(' ','D','A'),  34}, {KEY3(' ','D','C'),  36},
+   {KEY3(' ','D','G'),  37}, {KEY3(' ','D','I'),  38},
+   {KEY3(' ','D','T'),  35}, {KEY3('A','L','A'),   1},
+   {KEY3('A','R','G'),  15}, {KEY3('A','S','N'),  12},
+   {KEY3('A','S','P'),   3}, {KEY3('A','S','X'),  22},
+   {KEY3('C','G','N'),  25}, {KEY3('C','Y','S'),   2},
+   {KEY3('D','O','D'),  43}, {KEY3('G','L','N'),  14},
+   {KEY3('G','L','U'),   4}, {KEY3('G','L','X'),  23},
+   {KEY3('G','L','Y'),   6}, {KEY3('H','I','S'),   7},
+   {KEY3('H','O','H'),  40}, {KEY3('I','L','E'),   8},
+   {KEY3('L','E','U'),  10}, {KEY3('L','Y','S'),   9},
+   {KEY3('M','E','T'),  11}, {KEY3('O','D','2'),  44},
+   {KEY3('O','D','D'),  45}, {KEY3('O','H','2'),  41},
+   {KEY3('O','H','H'),  42}, {KEY3('P','C','A'),  21},
+   {KEY3('P','G','A'),  24}, {KEY3('P','H','E'),   5},
+   {KEY3('P','R','O'),  13}, {KEY3('P','Y','L'),  26},
+   {KEY3('S','E','C'),  27}, {KEY3('S','E','R'),  16},
+   {KEY3('T','H','R'),  17}, {KEY3('T','R','P'),  19},
+   {KEY3('T','Y','R'),  20}, {KEY3('U','N','K'),  39},
+   {KEY3('V','A','L'),  18}, {KEY3('W','A','T'),  46}
+};
+
+static CODEKEY sAtomKeys[NATOMCODES] =
+{
+   {KEY4('C',' ',' ',' '),   3}, {KEY4('C','A',' ',' '),   2},
+   {KEY4('C','B',' ',' '),   6}, {KEY4('C','D',' ',' '),  12},
+   {KEY4('C','D','1',' '),  13}, {KEY4('C','D','2',' '),  14},
+   {KEY4('C','E',' ',' '),  15}, {KEY4('C','E','1',' '),  16},
+   {KEY4('C','E','2',' '),  17}, {KEY4('C','E','3',' '),  18},
+   {KEY4('C','G',' ',' '),   9}, {KEY4('C','G','1',' '),  10},
+   {KEY4('C','G','2',' '),  11}, {KEY4('C','H','2',' '),  22},
+   {KEY4('C','Z',' ',' '),  19}, {KEY4('C','Z','2',' '),  20},
+   {KEY4('C','Z','3',' '),  21}, {KEY4('H',' ',' ',' '),   7},
+   {KEY4('H','A',' ',' '),   8}, {KEY4('N',' ',' ',' '),   1},
+   {KEY4('N','D','1',' '),  23}, {KEY4('N','D','2',' '),  24},
+   {KEY4('N','E',' ',' '),  25}, {KEY4('N','E','1',' '),  26},
+   {KEY4('N','E','2',' '),  27}, {KEY4('N','H','1',' '),  28},
+   {KEY4('N','H','2',' '),  29}, {KEY4('N','Z',' ',' '),  30},
+   {KEY4('O',' ',' ',' '),   4}, {KEY4('O','D','1',' '),  31},
+   {KEY4('O','D','2',' '),  32}, {KEY4('O','E','1',' '),  33},
+   {KEY4('O','E','2',' '),  34}, {KEY4('O','G',' ',' '),  35},
+   {KEY4('O','G','1',' '),  36}, {KEY4('O','H',' ',' '),  37},
+   {KEY4('O','T','1',' '),  40}, {KEY4('O','T','2',' '),  41},
+   {KEY4('O','X','T',' '),   5}, {KEY4('S','D',' ',' '),  38},
+   {KEY4('S','G',' ',' '),  39}
+};
+
+static CODEKEY sElementKeys[NELEMCODES] =
+{
+   {KEY2('A','C'),  89}, {KEY2('A','G'),  47}, {KEY2('A','L'),  13},
+   {KEY2('A','M'),  95}, {KEY2('A','R'),  18}, {KEY2('A','S'),  33},
+   {KEY2('A','T'),  85}, {KEY2('A','U'),  79}, {KEY2('B',' '),   5},
+   {KEY2('B','A'),  56}, {KEY2('B','E'),   4}, {KEY2('B','H'), 107},
+   {KEY2('B','I'),  83}, {KEY2('B','K'),  97}, {KEY2('B','R'),  35},
+   {KEY2('C',' '),   6}, {KEY2('C','A'),  20}, {KEY2('C','D'),  48},
+   {KEY2('C','E'),  58}, {KEY2('C','F'),  98}, {KEY2('C','L'),  17},
+   {KEY2('C','M'),  96}, {KEY2('C','N'), 112}, {KEY2('C','O'),  27},
+   {KEY2('C','R'),  24}, {KEY2('C','S'),  55}, {KEY2('C','U'),  29},
+   {KEY2('D','B'), 105}, {KEY2('D','S'), 110}, {KEY2('D','Y'),  66},
+   {KEY2('E','R'),  68}, {KEY2('E','S'),  99}, {KEY2('E','U'),  63},
+   {KEY2('F',' '),   9}, {KEY2('F','E'),  26}, {KEY2('F','L'), 114},
+   {KEY2('F','M'), 100}, {KEY2('F','R'),  87}, {KEY2('G','A'),  31},
+   {KEY2('G','D'),  64}, {KEY2('G','E'),  32}, {KEY2('H',' '),   1},
+   {KEY2('H','E'),   2}, {KEY2('H','F'),  72}, {KEY2('H','G'),  80},
+   {KEY2('H','O'),  67}, {KEY2('H','S'), 108}, {KEY2('I',' '),  53},
+   {KEY2('I','N'),  49}, {KEY2('I','R'),  77}, {KEY2('K',' '),  19},
+   {KEY2('K','R'),  36}, {KEY2('L','A'),  57}, {KEY2('L','I'),   3},
+   {KEY2('L','R'), 103}, {KEY2('L','U'),  71}, {KEY2('L','V'), 116},
+   {KEY2('M','C'), 115}, {KEY2('M','D'), 101}, {KEY2('M','G'),  12},
+   {KEY2('M','N'),  25}, {KEY2('M','O'),  42}, {KEY2('M','T'), 109},
+   {KEY2('N',' '),   7}, {KEY2('N','A'),  11}, {KEY2('N','B'),  41},
+   {KEY2('N','D'),  60}, {KEY2('N','E'),  10}, {KEY2('N','H'), 113},
+   {KEY2('N','I'),  28}, {KEY2('N','O'), 102}, {KEY2('N','P'),  93},
+   {KEY2('O',' '),   8}, {KEY2('O','G'), 118}, {KEY2('O','S'),  76},
+   {KEY2('P',' '),  15}, {KEY2('P','A'),  91}, {KEY2('P','B'),  82},
+   {KEY2('P','D'),  46}, {KEY2('P','M'),  61}, {KEY2('P','O'),  84},
+   {KEY2('P','R'),  59}, {KEY2('P','T'),  78}, {KEY2('P','U'),  94},
+   {KEY2('R','A'),  88}, {KEY2('R','B'),  37}, {KEY2('R','E'),  75},
+   {KEY2('R','F'), 104}, {KEY2('R','G'), 111}, {KEY2('R','H'),  45},
+   {KEY2('R','N'),  86}, {KEY2('R','U'),  44}, {KEY2('S',' '),  16},
+   {KEY2('S','B'),  51}, {KEY2('S','C'),  21}, {KEY2('S','E'),  34},
+   {KEY2('S','G'), 106}, {KEY2('S','I'),  14}, {KEY2('S','M'),  62},
+   {KEY2('S','N'),  50}, {KEY2('S','R'),  38}, {KEY2('T','A'),  73},
+   {KEY2('T','B'),  65}, {KEY2('T','C'),  43}, {KEY2('T','E'),  52},
+   {KEY2('T','H'),  90}, {KEY2('T','I'),  22}, {KEY2('T','L'),  81},
+   {KEY2('T','M'),  69}, {KEY2('T','S'), 117}, {KEY2('U',' '),  92},
+   {KEY2('V',' '),  23}, {KEY2('W',' '),  74}, {KEY2('X','E'),  54},
+   {KEY2('Y',' '),  39}, {KEY2('Y','B'),  70}, {KEY2('Z','N'),  30},
+   {KEY2('Z','R'),  40}
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static unsigned long PackKey(char *name, int width);
+static int FindCode(unsigned long key, CODEKEY *keys, int ncodes);
+
+
+/************************************************************************/
+/*>int blGetResCode(char *resnam)
+   ------------------------------
+*//**
+
+   \param[in]     *resnam   Residue name
+   \return                  Residue code or PDBCODE_OTHER
+
+   Gets the code for a residue name. The first 3 characters are used.
+
+-  16.10.26 Original   By: ACRM
+*/
+int blGetResCode(char *resnam)
+{
+   return(FindCode(PackKey(resnam, 3), sResKeys, NRESCODES));
+}
+
+
+/************************************************************************/
+/*>int blGetAtomCode(char *atnam)
+   ------------------------------
+*//**
+
+   \param[in]     *atnam    Atom name (left justified as in PDB->atnam)
+   \return                  Atom code or PDBCODE_OTHER
+
+   Gets the code for an atom name. The first 4 characters are used so
+   the name must be padded with spaces.
+
+-  16.10.26 Original   By: ACRM
+*/
+int blGetAtomCode(char *atnam)
+{
+   return(FindCode(PackKey(atnam, 4), sAtomKeys, NATOMCODES));
+}
+
+
+/************************************************************************/
+/*>int blGetElementCode(char *element)
+   -----------------------------------
+*//**
+
+   \param[in]     *element  Element symbol
+   \return                  Atomic number or PDBCODE_OTHER
+
+   Gets the code for an element. Leading spaces are skipped and the
+   case of the symbol does not matter.
+
+-  16.10.26 Original   By: ACRM
+*/
+int blGetElementCode(char *element)
+{
+   char symbol[4];
+   int  i;
+
+   while(*element == ' ')
+      element++;
+
+   for(i=0; i<2 && element[i] && element[i] != ' '; i++)
+      symbol[i] = (char)toupper((int)element[i]);
+   if(i == 0)
+      return(PDBCODE_OTHER);
+   for(; i<2; i++)
+      symbol[i] = ' ';
+   symbol[2] = '\0';
+
+   return(FindCode(PackKey(symbol, 2), sElementKeys, NELEMCODES));
+}
+
+
+/************************************************************************/
+/*>char *blResCodeName(int code)
+   -----------------------------
+*//**
+
+   \param[in]     code      Residue code
+   \return                  Residue name (3 characters) or NULL if the
+                            code is not in the table
+
+-  16.10.26 Original   By: ACRM
+*/
+char *blResCodeName(int code)
+{
+   return((code >= 1 && code <= NRESCODES) ? sResNames[code-1] : NULL);
+}
+
+
+/************************************************************************/
+/*>char *blAtomCodeName(int code)
+   ------------------------------
+*//**
+
+   \param[in]     code      Atom code
+   \return                  Atom name (padded to 4 characters) or NULL
+                            if the code is not in the table
+
+-  16.10.26 Original   By: ACRM
+*/
+char *blAtomCodeName(int code)
+{
+   return((code >= 1 && code <= NATOMCODES) ? sAtomNames[code-1] : NULL);
+}
+
+
+/************************************************************************/
+/*>char *blElementCodeName(int code)
+   ---------------------------------
+*//**
+
+   \param[in]     code      Atomic number
+   \return                  Element symbol (padded to 2 characters) or
+                            NULL if the code is not in the table
+
+-  16.10.26 Original   By: ACRM
+*/
+char *blElementCodeName(int code)
+{
+   return((code >= 1 && code <= NELEMCODES) ?
+          sElementNames[code-1] : NULL);
+}
+
+
+/************************************************************************/
+/*>void blSetPDBCodes(PDB *p)
+   --------------------------
+*//**
+
+   \param[in,out] *p        PDB record
+
+   Sets the residue, atom and element codes from the strings in a PDB
+   record. This must be called if the names are changed.
+
+-  16.10.26 Original   By: ACRM
+*/
+void blSetPDBCodes(PDB *p)
+{
+   p->rescode  = (short)blGetResCode(p->resnam);
+   p->atcode   = (short)blGetAtomCode(p->atnam);
+   p->elemcode = (short)blGetElementCode(p->element);
+}
+
+
+/************************************************************************/
+/*>void blSetPDBListCodes(PDB *pdb)
+   --------------------------------
+*//**
+
+   \param[in,out] *pdb      PDB linked list
+
+   Sets the codes in every record of a linked list. Consecutive records
+   normally have the same residue name, so that lookup is only made
+   when it changes.
+
+-  16.10.26 Original   By: ACRM
+*/
+void blSetPDBListCodes(PDB *pdb)
+{
+   PDB *p,
+       *prev = NULL;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if((prev != NULL) && !strncmp(p->resnam, prev->resnam, 3))
+         p->rescode = prev->rescode;
+      else
+         p->rescode = (short)blGetResCode(p->resnam);
+      p->atcode   = (short)blGetAtomCode(p->atnam);
+      p->elemcode = (short)blGetElementCode(p->element);
+      prev = p;
+   }
+}
+
+
+/************************************************************************/
+/*>static unsigned long PackKey(char *name, int width)
+   ---------------------------------------------------
+*//**
+
+   \param[in]     *name     Name
+   \param[in]     width     Number of characters to use (<= 4)
+   \return                  Name packed into an integer
+
+   Packs the first width characters of a name into an integer with the
+   first character most significant, so that integers sort in the same
+   order as the names. Packing stops at the end of the string, so two
+   names give the same key exactly when strncmp(a, b, width) is 0.
+
+-  16.10.26 Original   By: ACRM
+*/
+static unsigned long PackKey(char *name, int width)
+{
+   unsigned long key = 0;
+   int           i;
+   BOOL          ended = FALSE;
+
+   for(i=0; i<width; i++)
+   {
+      if(!ended && (name[i] == '\0'))
+         ended = TRUE;
+      key <<= 8;
+      if(!ended)
+         key |= (unsigned long)(unsigned char)name[i];
+   }
+   return(key);
+}
+
+
+/************************************************************************/
+/*>static int FindCode(unsigned long key, CODEKEY *keys, int ncodes)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]     key       Packed name to find
+   \param[in]     *keys     Packed names and their codes in order
+   \param[in]     ncodes    Number of codes
+   \return                  The code or PDBCODE_OTHER
+
+-  16.10.26 Original   By: ACRM
+-  16.10.26 Searches the packed names rather than packing a name at
+            each step
+*/
+static int FindCode(unsigned long key, CODEKEY *keys, int ncodes)
+{
+   int lo = 0,
+       hi = ncodes - 1;
+
+   while(lo <= hi)
+   {
+      int           mid    = (lo + hi) / 2;
+      unsigned long midKey = keys[mid].key;
+
+      if(key == midKey)
+         return(keys[mid].code);
+      if(key < midKey)
+         hi = mid - 1;
+      else
+         lo = mid + 1;
+   }
+   return(PDBCODE_OTHER);
+}
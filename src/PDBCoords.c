@@ -0,0 +1,492 @@
+/************************************************************************/
+/**
+
+   \file       PDBCoords.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Structure-of-arrays coordinate view of a PDB linked list
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   A structure-of-arrays view of the coordinates in a PDB linked list.
+   The x, y and z coordinates are held in three separate arrays, with
+   a map from array index back to the PDB node, so the list only needs
+   to be walked once to build the view and once to write it back.
+
+   The geometry routines here are equivalents of blApplyMatrixPDB(),
+   blTranslatePDB(), blGetCofGPDB(), blOriginPDB(), blRotatePDB() and
+   blCalcRMSPDB() which work on the arrays. They treat atoms with
+   coordinates of 9999.0 in the same way as the linked list versions.
+   The inner loops are simple strided-by-one loops over the arrays which
+   the compiler is able to vectorize.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   PDBCOORDS *coords = blGetPDBCoords(pdb);
+   blRotatePDBCoords(coords, matrix);
+   blTranslatePDBCoords(coords, shift);
+   blPutPDBCoords(coords);          Copy back to the linked list
+   blFreePDBCoords(coords);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Extracting data
+
+   #FUNCTION  blGetPDBCoords()
+   Builds a structure-of-arrays coordinate view of a PDB linked list
+
+   #FUNCTION  blRefreshPDBCoords()
+   Re-reads the coordinates from the linked list into the view
+
+   #FUNCTION  blPutPDBCoords()
+   Writes the coordinates from the view back to the linked list
+
+   #FUNCTION  blFreePDBCoords()
+   Frees a coordinate view
+
+   #SUBGROUP Moving the structure
+
+   #FUNCTION  blApplyMatrixPDBCoords()
+   Applies a rotation matrix to the coordinates in a view
+
+   #FUNCTION  blTranslatePDBCoords()
+   Translates the coordinates in a view
+
+   #FUNCTION  blOriginPDBCoords()
+   Moves the coordinates in a view to have their centre of geometry at
+   the origin
+
+   #FUNCTION  blRotatePDBCoords()
+   Rotates the coordinates in a view about their centre of geometry
+
+   #SUBGROUP Calculations
+
+   #FUNCTION  blGetCofGPDBCoords()
+   Finds the centre of geometry of the coordinates in a view
+
+   #FUNCTION  blCalcRMSPDBCoords()
+   Calculates the RMS deviation between two views
+
+   #FUNCTION  blDistPDBCoords()
+   Calculates the distance between two atoms in views
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <math.h>
+
+#include "SysDefs.h"
+#include "MathType.h"
+#include "macros.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NOTSET (REAL)9999.0
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+
+
+/************************************************************************/
+/*>PDBCOORDS *blGetPDBCoords(PDB *pdb)
+   -----------------------------------
+*//**
+
+   \param[in]     *pdb      PDB linked list
+   \return                  Coordinate view (NULL if out of memory or
+                            the list is empty)
+
+   Allocates and fills in a structure-of-arrays coordinate view of the
+   linked list. The view records a pointer to each atom so must be
+   rebuilt if atoms are added to or removed from the list.
+
+-  16.10.26 Original
+*/
+PDBCOORDS *blGetPDBCoords(PDB *pdb)
+{
+   PDBCOORDS *coords;
+   PDB       *p;
+   int       natoms = 0;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      natoms++;
+   if(natoms == 0)
+      return(NULL);
+   
+   if((coords = (PDBCOORDS *)malloc(sizeof(PDBCOORDS)))==NULL)
+      return(NULL);
+
+   coords->x      = (REAL *)malloc(natoms * sizeof(REAL));
+   coords->y      = (REAL *)malloc(natoms * sizeof(REAL));
+   coords->z      = (REAL *)malloc(natoms * sizeof(REAL));
+   coords->atom   = (PDB **)malloc(natoms * sizeof(PDB *));
+   coords->natoms = natoms;
+
+   if((coords->x == NULL) || (coords->y == NULL) || (coords->z == NULL) ||
+      (coords->atom == NULL))
+   {
+      blFreePDBCoords(coords);
+      return(NULL);
+   }
+
+   for(p=pdb, natoms=0; p!=NULL; NEXT(p), natoms++)
+      coords->atom[natoms] = p;
+
+   blRefreshPDBCoords(coords);
+   return(coords);
+}
+
+
+/************************************************************************/
+/*>void blRefreshPDBCoords(PDBCOORDS *coords)
+   ------------------------------------------
+*//**
+
+   \param[in,out] *coords   Coordinate view
+
+   Copies the current coordinates from the PDB nodes into the view.
+   Used when the linked list has been moved since the view was built.
+
+-  16.10.26 Original
+*/
+void blRefreshPDBCoords(PDBCOORDS *coords)
+{
+   int i;
+   
+   for(i=0; i<coords->natoms; i++)
+   {
+      coords->x[i] = coords->atom[i]->x;
+      coords->y[i] = coords->atom[i]->y;
+      coords->z[i] = coords->atom[i]->z;
+   }
+}
+
+
+/************************************************************************/
+/*>void blPutPDBCoords(PDBCOORDS *coords)
+   --------------------------------------
+*//**
+
+   \param[in]     *coords   Coordinate view
+
+   Writes the coordinates in the view back to the PDB nodes.
+
+-  16.10.26 Original
+*/
+void blPutPDBCoords(PDBCOORDS *coords)
+{
+   int i;
+   
+   for(i=0; i<coords->natoms; i++)
+   {
+      coords->atom[i]->x = coords->x[i];
+      coords->atom[i]->y = coords->y[i];
+      coords->atom[i]->z = coords->z[i];
+   }
+}
+
+
+/************************************************************************/
+/*>void blFreePDBCoords(PDBCOORDS *coords)
+   ---------------------------------------
+*//**
+
+   \param[in]     *coords   Coordinate view
+
+   Frees a coordinate view. The PDB linked list is not affected.
+
+-  16.10.26 Original
+*/
+void blFreePDBCoords(PDBCOORDS *coords)
+{
+   if(coords == NULL)
+      return;
+   
+   if(coords->x    != NULL) free(coords->x);
+   if(coords->y    != NULL) free(coords->y);
+   if(coords->z    != NULL) free(coords->z);
+   if(coords->atom != NULL) free(coords->atom);
+   free(coords);
+}
+
+
+/************************************************************************/
+/*>void blApplyMatrixPDBCoords(PDBCOORDS *coords, REAL matrix[3][3])
+   -----------------------------------------------------------------
+*//**
+
+   \param[in,out] *coords   Coordinate view
+   \param[in]     matrix    Rotation matrix
+
+   As blApplyMatrixPDB(): applies the matrix to every atom with no
+   coordinate set to 9999.0
+
+-  16.10.26 Original
+*/
+void blApplyMatrixPDBCoords(PDBCOORDS *coords, REAL matrix[3][3])
+{
+   REAL *x = coords->x,
+        *y = coords->y,
+        *z = coords->z,
+        m00 = matrix[0][0], m01 = matrix[0][1], m02 = matrix[0][2],
+        m10 = matrix[1][0], m11 = matrix[1][1], m12 = matrix[1][2],
+        m20 = matrix[2][0], m21 = matrix[2][1], m22 = matrix[2][2],
+        xi, yi, zi;
+   int  i, 
+        natoms = coords->natoms;
+
+   for(i=0; i<natoms; i++)
+   {
+      xi = x[i];
+      yi = y[i];
+      zi = z[i];
+      if(xi != NOTSET && yi != NOTSET && zi != NOTSET)
+      {
+         x[i] = xi * m00 + yi * m10 + zi * m20;
+         y[i] = xi * m01 + yi * m11 + zi * m21;
+         z[i] = xi * m02 + yi * m12 + zi * m22;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>void blTranslatePDBCoords(PDBCOORDS *coords, VEC3F tvect)
+   ---------------------------------------------------------
+*//**
+
+   \param[in,out] *coords   Coordinate view
+   \param[in]     tvect     Translation vector
+
+   As blTranslatePDB(): translates every atom with all coordinates less
+   than 9999.0
+
+-  16.10.26 Original
+*/
+void blTranslatePDBCoords(PDBCOORDS *coords, VEC3F tvect)
+{
+   REAL *x = coords->x,
+        *y = coords->y,
+        *z = coords->z;
+   int  i, 
+        natoms = coords->natoms;
+
+   for(i=0; i<natoms; i++)
+   {
+      if(x[i] < NOTSET && y[i] < NOTSET && z[i] < NOTSET)
+      {
+         x[i] += tvect.x;
+         y[i] += tvect.y;
+         z[i] += tvect.z;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>void blGetCofGPDBCoords(PDBCOORDS *coords, VEC3F *cg)
+   -----------------------------------------------------
+*//**
+
+   \param[in]     *coords   Coordinate view
+   \param[out]    *cg       Centre of geometry
+
+   As blGetCofGPDB(): atoms with all coordinates of 9999.0 or more are
+   ignored
+
+-  16.10.26 Original
+*/
+void blGetCofGPDBCoords(PDBCOORDS *coords, VEC3F *cg)
+{
+   REAL *x = coords->x,
+        *y = coords->y,
+        *z = coords->z,
+        sx = 0.0, 
+        sy = 0.0, 
+        sz = 0.0;
+   int  i, 
+        n      = 0,
+        natoms = coords->natoms;
+
+   for(i=0; i<natoms; i++)
+   {
+      if(x[i] < NOTSET || y[i] < NOTSET || z[i] < NOTSET)
+      {
+         sx += x[i];
+         sy += y[i];
+         sz += z[i];
+         n++;
+      }
+   }
+
+   cg->x = sx / n;
+   cg->y = sy / n;
+   cg->z = sz / n;
+}
+
+
+/************************************************************************/
+/*>void blOriginPDBCoords(PDBCOORDS *coords)
+   -----------------------------------------
+*//**
+
+   \param[in,out] *coords   Coordinate view
+
+   As blOriginPDB(): moves the coordinates to have their centre of
+   geometry at the origin
+
+-  16.10.26 Original
+*/
+void blOriginPDBCoords(PDBCOORDS *coords)
+{
+   REAL  *x = coords->x,
+         *y = coords->y,
+         *z = coords->z;
+   int   i, 
+         natoms = coords->natoms;
+   VEC3F cg;
+
+   blGetCofGPDBCoords(coords, &cg);
+
+   for(i=0; i<natoms; i++)
+   {
+      if(x[i] < NOTSET || y[i] < NOTSET || z[i] < NOTSET)
+      {
+         x[i] -= cg.x;
+         y[i] -= cg.y;
+         z[i] -= cg.z;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>void blRotatePDBCoords(PDBCOORDS *coords, REAL matrix[3][3])
+   ------------------------------------------------------------
+*//**
+
+   \param[in,out] *coords   Coordinate view
+   \param[in]     matrix    Rotation matrix
+
+   As blRotatePDB(): rotates the coordinates about their centre of
+   geometry
+
+-  16.10.26 Original
+*/
+void blRotatePDBCoords(PDBCOORDS *coords, REAL matrix[3][3])
+{
+   VEC3F CofG;
+
+   blGetCofGPDBCoords(coords, &CofG);
+   blOriginPDBCoords(coords);
+   blApplyMatrixPDBCoords(coords, matrix);
+   blTranslatePDBCoords(coords, CofG);
+}
+
+
+/************************************************************************/
+/*>REAL blCalcRMSPDBCoords(PDBCOORDS *coords1, PDBCOORDS *coords2)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *coords1  First coordinate view
+   \param[in]     *coords2  Second coordinate view
+   \return                  RMS deviation
+
+   As blCalcRMSPDB(): calculates the RMS deviation over the atoms
+   common to both views, with no fitting
+
+-  16.10.26 Original
+*/
+REAL blCalcRMSPDBCoords(PDBCOORDS *coords1, PDBCOORDS *coords2)
+{
+   REAL *x1 = coords1->x, *y1 = coords1->y, *z1 = coords1->z,
+        *x2 = coords2->x, *y2 = coords2->y, *z2 = coords2->z,
+        dx, dy, dz,
+        dist = (REAL)0.0;
+   int  i, 
+        count;
+
+   count = MIN(coords1->natoms, coords2->natoms);
+   for(i=0; i<count; i++)
+   {
+      dx    = x1[i] - x2[i];
+      dy    = y1[i] - y2[i];
+      dz    = z1[i] - z2[i];
+      dist += dx*dx + dy*dy + dz*dz;
+   }
+
+   return((REAL)((count)?sqrt((double)(dist/(REAL)count)):0.0));
+}
+
+
+/************************************************************************/
+/*>REAL blDistPDBCoords(PDBCOORDS *coords1, int i, 
+                        PDBCOORDS *coords2, int j)
+   ----------------------------------------------
+*//**
+
+   \param[in]     *coords1  First coordinate view
+   \param[in]     i         Atom index in first view
+   \param[in]     *coords2  Second coordinate view (may be the same)
+   \param[in]     j         Atom index in second view
+   \return                  Distance between the atoms
+
+-  16.10.26 Original
+*/
+REAL blDistPDBCoords(PDBCOORDS *coords1, int i, PDBCOORDS *coords2, int j)
+{
+   REAL dx = coords1->x[i] - coords2->x[j],
+        dy = coords1->y[i] - coords2->y[j],
+        dz = coords1->z[i] - coords2->z[j];
+
+   return((REAL)sqrt((double)(dx*dx + dy*dy + dz*dz)));
+}
+
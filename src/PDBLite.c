@@ -0,0 +1,542 @@
+/************************************************************************/
+/**
+
+   \file       PDBLite.c
+
+   \version    V1.1
+   \date       16.10.26
+   \brief      Compact atom table for very large structures
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Each PDB record in a linked list is a separate allocation of well
+   over 100 bytes, most of it in the 8-character string fields, the
+   REAL fields that PDB files do not fill in and the pointers. For
+   assemblies of millions of atoms this is more memory than many
+   machines have.
+
+   A PDBLITE holds the same atoms as an array of 40-byte PDBLITEATOM
+   records with the coordinates in separate x[], y[] and z[] arrays
+   (which may be passed directly to routines working on coordinate
+   arrays). The names are held as 4 characters (2 for the element)
+   without terminators. The chain is a 16-bit index into the
+   PDBLITE's table of chain labels, so labels of more than one
+   character, as found in PDBML files of large assemblies, are kept; up
+   to PDBLITE_MAXCHAINS different labels may be used. The insert code
+   and alternate position are single characters. The interned residue,
+   atom and element codes are kept (see PDBCodes.c).
+
+   The following are not kept:
+
+   - access, radius, extras and atomType
+   - partial_charge (set to the formal charge when converted back, as
+     the PDB readers do)
+   - record types other than HETATM (converted back as ATOM)
+
+   Occupancies and B-values are held as float which is more than the
+   precision of a PDB file.
+
+   blPDBToPDBLite() and blPDBLiteToPDB() convert to and from a linked
+   list. blReadPDBLite() and blReadPDBLiteMapped() (in ReadPDB.c) fill
+   a PDBLITE directly from a file without building a linked list.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   PDBLITE *lite;
+   int     i;
+
+   if((lite = blReadPDBLiteMapped("4v6x.pdb"))!=NULL)
+   {
+      for(i=0; i<lite->natoms; i++)
+      {
+         if(lite->atoms[i].atcode == PDBATOM_CA)
+            printf("%s %d %.3f\n", PDBLITE_CHAIN(lite, i),
+                   lite->atoms[i].resnum, lite->x[i]);
+      }
+      blFreePDBLite(lite);
+   }
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Chain index is 16-bit and the chain label table grows
+                  as needed
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Memory management
+
+   #FUNCTION  blAllocPDBLite()
+   Allocates an empty compact atom table
+
+   #FUNCTION  blResizePDBLite()
+   Changes the space allocated in a compact atom table
+
+   #FUNCTION  blFreePDBLite()
+   Frees a compact atom table
+
+   #FUNCTION  blAppendPDBLite()
+   Adds a PDB record to the end of a compact atom table
+
+   #FUNCTION  blGetPDBLiteAtom()
+   Fills in a PDB record from an atom of a compact atom table
+
+   #FUNCTION  blPDBToPDBLite()
+   Converts a PDB linked list to a compact atom table
+
+   #FUNCTION  blPDBLiteToPDB()
+   Converts a compact atom table to a PDB linked list
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "SysDefs.h"
+#include "MathType.h"
+#include "macros.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define LITE_ALLOCQUANT 1024
+#define LITE_CHAINQUANT 16
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static int FindChainLabel(PDBLITE *lite, char *chain);
+
+
+/************************************************************************/
+/*>PDBLITE *blAllocPDBLite(int maxatoms)
+   -------------------------------------
+*//**
+
+   \param[in]     maxatoms  Number of atoms to allocate space for. The
+                            table grows as needed so this is only a
+                            hint (<1 for the default)
+   \return                  Empty table (NULL if out of memory)
+
+   Allocates an empty compact atom table
+
+-  16.10.26 Original
+*/
+PDBLITE *blAllocPDBLite(int maxatoms)
+{
+   PDBLITE *lite;
+
+   if((lite = (PDBLITE *)malloc(sizeof(PDBLITE)))==NULL)
+      return(NULL);
+
+   lite->atoms     = NULL;
+   lite->x         = NULL;
+   lite->y         = NULL;
+   lite->z         = NULL;
+   lite->natoms    = 0;
+   lite->maxatoms  = 0;
+   lite->nchains   = 0;
+   lite->maxchains = 0;
+   lite->lastchain = 0;
+   lite->chains    = NULL;
+
+   if(!blResizePDBLite(lite, (maxatoms < 1) ? LITE_ALLOCQUANT : maxatoms))
+   {
+      blFreePDBLite(lite);
+      return(NULL);
+   }
+
+   return(lite);
+}
+
+
+/************************************************************************/
+/*>BOOL blResizePDBLite(PDBLITE *lite, int maxatoms)
+   -------------------------------------------------
+*//**
+
+   \param[in,out] *lite     Compact atom table
+   \param[in]     maxatoms  Number of atoms to allocate space for.
+                            Never less than the number of atoms stored
+   \return                  Success?
+
+   Changes the space allocated in a compact atom table. May be used to
+   make space before adding a known number of atoms or to release
+   unused space when all the atoms have been added. If this fails the
+   table is still usable.
+
+-  16.10.26 Original
+*/
+BOOL blResizePDBLite(PDBLITE *lite, int maxatoms)
+{
+   PDBLITEATOM *atoms;
+   REAL        *x, *y, *z;
+   BOOL        ok = TRUE;
+
+   if(maxatoms < lite->natoms)
+      maxatoms = lite->natoms;
+   if(maxatoms < 1)
+      maxatoms = 1;
+   if(maxatoms == lite->maxatoms)
+      return(TRUE);
+
+   /* Each array that is reallocated is kept, so if one fails they are
+      all at least the smaller of the old and new sizes
+   */
+   if((atoms = (PDBLITEATOM *)realloc(lite->atoms,
+                                      maxatoms * sizeof(PDBLITEATOM)))
+      != NULL)
+      lite->atoms = atoms;
+   else
+      ok = FALSE;
+   if((x = (REAL *)realloc(lite->x, maxatoms * sizeof(REAL)))!=NULL)
+      lite->x = x;
+   else
+      ok = FALSE;
+   if((y = (REAL *)realloc(lite->y, maxatoms * sizeof(REAL)))!=NULL)
+      lite->y = y;
+   else
+      ok = FALSE;
+   if((z = (REAL *)realloc(lite->z, maxatoms * sizeof(REAL)))!=NULL)
+      lite->z = z;
+   else
+      ok = FALSE;
+
+   if(ok)
+      lite->maxatoms = maxatoms;
+   else if(maxatoms < lite->maxatoms)
+      lite->maxatoms = maxatoms;
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBLite(PDBLITE *lite)
+   ---------------------------------
+*//**
+
+   \param[in]     *lite     Compact atom table
+
+   Frees a compact atom table
+
+-  16.10.26 Original
+*/
+void blFreePDBLite(PDBLITE *lite)
+{
+   if(lite != NULL)
+   {
+      if(lite->atoms != NULL) free(lite->atoms);
+      if(lite->x     != NULL) free(lite->x);
+      if(lite->y     != NULL) free(lite->y);
+      if(lite->z     != NULL) free(lite->z);
+      if(lite->chains != NULL) free(lite->chains);
+      free(lite);
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL blAppendPDBLite(PDBLITE *lite, PDB *p)
+   -------------------------------------------
+*//**
+
+   \param[in,out] *lite     Compact atom table
+   \param[in]     *p        PDB record
+   \return                  Success? FALSE if out of memory, if a name
+                            is too long for the table or there are
+                            already PDBLITE_MAXCHAINS chain labels
+
+   Adds a PDB record to the end of a compact atom table. The space
+   allocated is doubled when it fills up.
+
+-  16.10.26 Original
+*/
+BOOL blAppendPDBLite(PDBLITE *lite, PDB *p)
+{
+   PDBLITEATOM *a;
+   int         chain;
+
+   if((strlen(p->atnam)     > 4) ||
+      (strlen(p->atnam_raw) > 4) ||
+      (strlen(p->resnam)    > 4) ||
+      (strlen(p->element)   > 2) ||
+      (strlen(p->insert)    > 1))
+      return(FALSE);
+
+   if((chain = FindChainLabel(lite, p->chain)) < 0)
+      return(FALSE);
+
+   if((lite->natoms == lite->maxatoms) &&
+      (!blResizePDBLite(lite, 2 * lite->maxatoms) ||
+       (lite->natoms == lite->maxatoms)))
+      return(FALSE);
+
+   a = lite->atoms + lite->natoms;
+   a->atnum         = p->atnum;
+   a->resnum        = p->resnum;
+   a->occ           = (float)p->occ;
+   a->bval          = (float)p->bval;
+   strncpy(a->atnam,     p->atnam,     4);
+   strncpy(a->atnam_raw, p->atnam_raw, 4);
+   strncpy(a->resnam,    p->resnam,    4);
+   strncpy(a->element,   p->element,   2);
+   a->insert        = p->insert[0];
+   a->altpos        = p->altpos;
+   a->chain         = (unsigned short)chain;
+   a->hetatm        = (unsigned char)!strncmp(p->record_type, "HETATM", 6);
+   a->formal_charge = (signed char)p->formal_charge;
+   a->rescode       = (signed char)p->rescode;
+   a->atcode        = (signed char)p->atcode;
+   a->elemcode      = (signed char)p->elemcode;
+
+   lite->x[lite->natoms] = p->x;
+   lite->y[lite->natoms] = p->y;
+   lite->z[lite->natoms] = p->z;
+   lite->natoms++;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void blGetPDBLiteAtom(PDBLITE *lite, int i, PDB *p)
+   ---------------------------------------------------
+*//**
+
+   \param[in]     *lite     Compact atom table
+   \param[in]     i         Atom number (from 0)
+   \param[out]    *p        PDB record
+
+   Fills in a PDB record from an atom of a compact atom table. All
+   fields apart from next and extras are set. This can be used to pass
+   the atoms one at a time to routines such as blWritePDBRecord()
+   without building a linked list.
+
+-  16.10.26 Original
+*/
+void blGetPDBLiteAtom(PDBLITE *lite, int i, PDB *p)
+{
+   PDBLITEATOM *a = lite->atoms + i;
+
+   p->atnum          = a->atnum;
+   p->resnum         = a->resnum;
+   p->x              = lite->x[i];
+   p->y              = lite->y[i];
+   p->z              = lite->z[i];
+   p->occ            = (REAL)a->occ;
+   p->bval           = (REAL)a->bval;
+   p->access         = (REAL)0.0;
+   p->radius         = (REAL)0.0;
+   p->formal_charge  = a->formal_charge;
+   p->partial_charge = (REAL)a->formal_charge;
+   p->atomType       = NULL;
+   p->altpos         = a->altpos;
+   p->rescode        = a->rescode;
+   p->atcode         = a->atcode;
+   p->elemcode       = a->elemcode;
+
+   strcpy(p->record_type, a->hetatm ? "HETATM" : "ATOM  ");
+   strncpy(p->atnam,     a->atnam,     4);
+   p->atnam[4]     = '\0';
+   strncpy(p->atnam_raw, a->atnam_raw, 4);
+   p->atnam_raw[4] = '\0';
+   strncpy(p->resnam,    a->resnam,    4);
+   p->resnam[4]    = '\0';
+   strncpy(p->element,   a->element,   2);
+   p->element[2]   = '\0';
+   p->insert[0]    = a->insert;
+   p->insert[1]    = '\0';
+   strcpy(p->chain, lite->chains[a->chain]);
+}
+
+
+/************************************************************************/
+/*>PDBLITE *blPDBToPDBLite(PDB *pdb)
+   ---------------------------------
+*//**
+
+   \param[in]     *pdb      PDB linked list
+   \return                  Compact atom table (NULL on error - see
+                            blAppendPDBLite())
+
+   Converts a PDB linked list to a compact atom table. The linked list
+   is not changed.
+
+-  16.10.26 Original
+*/
+PDBLITE *blPDBToPDBLite(PDB *pdb)
+{
+   PDBLITE *lite;
+   PDB     *p;
+   int     natoms = 0;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      natoms++;
+
+   if((lite = blAllocPDBLite(natoms))==NULL)
+      return(NULL);
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if(!blAppendPDBLite(lite, p))
+      {
+         blFreePDBLite(lite);
+         return(NULL);
+      }
+   }
+
+   return(lite);
+}
+
+
+/************************************************************************/
+/*>PDB *blPDBLiteToPDB(PDBLITE *lite, int *natom)
+   ----------------------------------------------
+*//**
+
+   \param[in]     *lite     Compact atom table
+   \param[out]    *natom    Number of atoms. -1 if out of memory
+   \return                  PDB linked list
+
+   Converts a compact atom table to a PDB linked list. The table is
+   not changed.
+
+-  16.10.26 Original
+*/
+PDB *blPDBLiteToPDB(PDBLITE *lite, int *natom)
+{
+   PDB *pdb = NULL,
+       *p   = NULL;
+   int i;
+
+   *natom = 0;
+
+   for(i=0; i<lite->natoms; i++)
+   {
+      if(pdb == NULL)
+      {
+         INITPDB(pdb);
+         p = pdb;
+      }
+      else
+      {
+         ALLOCNEXTPDB(p);
+      }
+
+      if(p == NULL)
+      {
+         if(pdb != NULL) FREEPDBLIST(pdb);
+         *natom = (-1);
+         return(NULL);
+      }
+
+      blGetPDBLiteAtom(lite, i, p);
+      p->next   = NULL;
+      p->extras = NULL;
+   }
+
+   *natom = lite->natoms;
+   return(pdb);
+}
+
+
+/************************************************************************/
+/*>static int FindChainLabel(PDBLITE *lite, char *chain)
+   -----------------------------------------------------
+*//**
+
+   \param[in,out] *lite     Compact atom table
+   \param[in]     *chain    Chain label
+   \return                  Index of the label in lite->chains[]. -1 if
+                            there are already PDBLITE_MAXCHAINS labels
+                            or out of memory
+
+   Finds a chain label in the table of labels, adding it if it is not
+   there. Atoms come in chains so the last label found is tried first.
+   The table of labels is doubled in size when it fills up.
+
+-  16.10.26 Original
+-  16.10.26 Table of labels grows as needed
+*/
+static int FindChainLabel(PDBLITE *lite, char *chain)
+{
+   int i;
+
+   if((lite->nchains > 0) &&
+      CHAINMATCH(lite->chains[lite->lastchain], chain))
+      return(lite->lastchain);
+
+   for(i=0; i<lite->nchains; i++)
+   {
+      if(CHAINMATCH(lite->chains[i], chain))
+      {
+         lite->lastchain = i;
+         return(i);
+      }
+   }
+
+   if(lite->nchains == PDBLITE_MAXCHAINS)
+      return(-1);
+
+   if(lite->nchains == lite->maxchains)
+   {
+      char (*chains)[8];
+      int  maxchains = (lite->maxchains ? 2 * lite->maxchains 
+                                        : LITE_CHAINQUANT);
+
+      if(maxchains > PDBLITE_MAXCHAINS)
+         maxchains = PDBLITE_MAXCHAINS;
+      if((chains = (char (*)[8])realloc(lite->chains, 
+                                         maxchains * 8 * sizeof(char)))
+         == NULL)
+         return(-1);
+      lite->chains    = chains;
+      lite->maxchains = maxchains;
+   }
+
+   strncpy(lite->chains[lite->nchains], chain, 7);
+   lite->chains[lite->nchains][7] = '\0';
+   lite->lastchain = lite->nchains;
+   return(lite->nchains++);
+}
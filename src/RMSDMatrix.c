@@ -0,0 +1,568 @@
+/************************************************************************/
+/**
+
+   \file       RMSDMatrix.c
+   
+   \version    V1.1
+   \date       16.10.26
+   \brief      All-against-all RMSD matrices for ensembles of models
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Calculates the RMSD after optimal superposition between every pair
+   of a set of models (e.g. an NMR or MD ensemble read one model at a
+   time with blDoReadPDB() or blReadNextPDBModel()). The selected atoms
+   of each model are extracted and centred once and the sum of squares
+   of each is calculated once by creating a fit target (see 
+   FitTarget.c) for each. The pairs are then done in square tiles
+   of RMSD_TILE models, so the coordinates for a tile stay in the cache,
+   using QCP (see fit.c) for each pair. The tiles are shared between
+   threads.
+
+   The atoms used mirror the fitting routines:
+   RMSD_ATOMS_ALL   All atoms (as blFitPDB())
+   RMSD_ATOMS_CA    CA atoms (as blFitCaPDB())
+   RMSD_ATOMS_NCAC  N, CA and C atoms (as blFitNCaCPDB())
+   RMSD_ATOMS_CACB  All atoms weighted towards CA and CB (as 
+                    blFitCaCbPDB()). The RMSD is the weighted RMSD
+
+**************************************************************************
+
+   Usage:
+   ======
+
+\code
+   REAL *blRMSDMatrixPDB(PDB **models, int nmodels, int atoms, 
+                         int nthreads)
+\endcode
+      Returns the upper triangle of the matrix as a flat array of 
+      nmodels*(nmodels-1)/2 values. The RMSD between models i and j 
+      (counting from 0, i<j) is at RMSDMATRIX_INDEX(i, j, nmodels)
+
+\code
+   BOOL blWriteRMSDMatrixPDB(FILE *fp, PDB **models, int nmodels, 
+                             int atoms, int nthreads)
+\endcode
+      Writes the matrix to a file as it is calculated so only 
+      RMSD_TILE rows are held in memory. Line i contains the RMSDs of 
+      model i to models i+1...nmodels
+
+   nthreads may be 0 for one thread per processor. Programs using 
+   these must be linked with -lpthread
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Uses fit targets for the models
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Fitting
+   #FUNCTION  blRMSDMatrixPDB()
+   Calculates the RMSD after fitting between every pair of models
+
+   #FUNCTION  blWriteRMSDMatrixPDB()
+   Calculates the RMSD after fitting between every pair of models and
+   writes the matrix to a file
+*/
+/************************************************************************/
+/* Includes
+*/
+#ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L   /* For pthreads and sysconf()       */
+#endif
+#include "port.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef NOTHREADS
+#  include <pthread.h>
+#  include <unistd.h>
+#endif
+
+#include "SysDefs.h"
+#include "MathType.h"
+#include "macros.h"
+#include "fit.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define RMSD_TILE 32           /* Models in each side of a tile         */
+
+/* The models and the tiles still to be done. All threads share this    */
+typedef struct
+{
+   FITTARGET **targets;        /* Centred selected atoms of each model  */
+   REAL  *matrix,              /* Packed output matrix, or              */
+         *rows;                /*    rows being written to a file       */
+   int   nmodels,
+         ntiles,               /* Tiles in the current band             */
+         firstRow,             /* First tile row in the current band    */
+         lastRow,              /* Last tile row in the current band     */
+         nextTile;             /* Next tile to hand to a thread         */
+   BOOL  ok;
+#ifndef NOTHREADS
+   pthread_mutex_t mutex;
+#endif
+}  RMSDJOB;
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL PrepareModels(RMSDJOB *job, PDB **models, int nmodels, 
+                          int atoms);
+static void FreeJob(RMSDJOB *job);
+static void RunTiles(RMSDJOB *job, int firstRow, int lastRow, 
+                     int nthreads);
+static void *RMSDWorker(void *arg);
+static void FindTile(RMSDJOB *job, int tile, int *ti, int *tj);
+static void CalcTile(RMSDJOB *job, int ti, int tj);
+
+
+/************************************************************************/
+/*>REAL *blRMSDMatrixPDB(PDB **models, int nmodels, int atoms, 
+                         int nthreads)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     **models   Array of PDB linked lists
+   \param[in]     nmodels    Number of models
+   \param[in]     atoms      RMSD_ATOMS_ALL, RMSD_ATOMS_CA, 
+                             RMSD_ATOMS_NCAC or RMSD_ATOMS_CACB
+   \param[in]     nthreads   Number of threads (0 for one per processor)
+   \return                   Upper triangle of the RMSD matrix (NULL if
+                             out of memory, the models have different
+                             numbers of atoms or there are fewer than 3
+                             atoms). free() when no longer needed
+
+   Calculates the RMSD after optimal superposition between every pair
+   of models. The RMSD between models i and j (i<j, counting from 0) is
+   at RMSDMATRIX_INDEX(i, j, nmodels). The models are not modified.
+
+-  16.10.26 Original
+*/
+REAL *blRMSDMatrixPDB(PDB **models, int nmodels, int atoms, 
+                      int nthreads)
+{
+   RMSDJOB job;
+   long    nvalues;
+   int     ntilerows;
+   
+   if(nmodels < 2)
+      return(NULL);
+   
+   nvalues = (long)nmodels * (long)(nmodels-1) / 2;
+   if(!PrepareModels(&job, models, nmodels, atoms))
+      return(NULL);
+
+   if((job.matrix = (REAL *)malloc(nvalues * sizeof(REAL)))==NULL)
+   {
+      FreeJob(&job);
+      return(NULL);
+   }
+
+   ntilerows = (nmodels + RMSD_TILE - 1) / RMSD_TILE;
+   RunTiles(&job, 0, ntilerows-1, nthreads);
+
+   FreeJob(&job);
+   if(!job.ok)
+   {
+      free(job.matrix);
+      return(NULL);
+   }
+   return(job.matrix);
+}
+
+
+/************************************************************************/
+/*>BOOL blWriteRMSDMatrixPDB(FILE *fp, PDB **models, int nmodels, 
+                             int atoms, int nthreads)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *fp        Output file
+   \param[in]     **models   Array of PDB linked lists
+   \param[in]     nmodels    Number of models
+   \param[in]     atoms      RMSD_ATOMS_ALL, RMSD_ATOMS_CA, 
+                             RMSD_ATOMS_NCAC or RMSD_ATOMS_CACB
+   \param[in]     nthreads   Number of threads (0 for one per processor)
+   \return                   Success?
+
+   As blRMSDMatrixPDB(), but the matrix is written to a file as it is
+   calculated, one row of tiles at a time, so only RMSD_TILE rows of the
+   matrix are held in memory. Line i contains the RMSDs of model i to
+   models i+1 to nmodels (counting from 1) so there are nmodels-1 lines.
+
+-  16.10.26 Original
+*/
+BOOL blWriteRMSDMatrixPDB(FILE *fp, PDB **models, int nmodels, 
+                          int atoms, int nthreads)
+{
+   RMSDJOB job;
+   int     ntilerows,
+           tr, i, j;
+   
+   if(nmodels < 2)
+      return(FALSE);
+   if(!PrepareModels(&job, models, nmodels, atoms))
+      return(FALSE);
+
+   if((job.rows = (REAL *)malloc(RMSD_TILE * nmodels * sizeof(REAL)))
+      ==NULL)
+   {
+      FreeJob(&job);
+      return(FALSE);
+   }
+
+   ntilerows = (nmodels + RMSD_TILE - 1) / RMSD_TILE;
+   for(tr=0; tr<ntilerows && job.ok; tr++)
+   {
+      int first = tr * RMSD_TILE,
+          last  = MIN(first + RMSD_TILE, nmodels - 1);
+
+      RunTiles(&job, tr, tr, nthreads);
+      
+      for(i=first; i<last && job.ok; i++)
+      {
+         REAL *row = job.rows + (i - first) * nmodels;
+
+         for(j=i+1; j<nmodels; j++)
+            fprintf(fp, "%s%.4f", (j==i+1)?"":" ", row[j]);
+         if(fputc('\n', fp) == EOF)
+            job.ok = FALSE;
+      }
+   }
+
+   free(job.rows);
+   FreeJob(&job);
+   return(job.ok);
+}
+
+
+/************************************************************************/
+/*>static BOOL PrepareModels(RMSDJOB *job, PDB **models, int nmodels, 
+                             int atoms)
+   -------------------------------------------------------------------
+*//**
+
+   \param[out]    *job       The job to be set up
+   \param[in]     **models   Array of PDB linked lists
+   \param[in]     nmodels    Number of models
+   \param[in]     atoms      Atom selection
+   \return                   Success?
+
+   Creates a fit target (see FitTarget.c) for each model, giving the
+   centred selected atoms and their sum of squares
+
+-  16.10.26 Original
+*/
+static BOOL PrepareModels(RMSDJOB *job, PDB **models, int nmodels, 
+                          int atoms)
+{
+   int i;
+   
+   job->nmodels = nmodels;
+   job->matrix  = NULL;
+   job->rows    = NULL;
+   job->ok      = TRUE;
+
+   if((job->targets = (FITTARGET **)calloc(nmodels, sizeof(FITTARGET *)))
+      ==NULL)
+      return(FALSE);
+
+   for(i=0; i<nmodels; i++)
+   {
+      if(((job->targets[i] = blCreateFitTarget(models[i], atoms))==NULL) ||
+         (job->targets[i]->ncoor != job->targets[0]->ncoor))
+      {
+         FreeJob(job);
+         return(FALSE);
+      }
+   }
+   
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void FreeJob(RMSDJOB *job)
+   ---------------------------------
+*//**
+
+   \param[in]     *job      The job
+
+   Frees the fit targets of the models. The output arrays are not
+   freed.
+
+-  16.10.26 Original
+*/
+static void FreeJob(RMSDJOB *job)
+{
+   int i;
+   
+   if(job->targets != NULL)
+   {
+      for(i=0; i<job->nmodels; i++)
+         blFreeFitTarget(job->targets[i]);
+      free(job->targets);
+      job->targets = NULL;
+   }
+}
+
+
+/************************************************************************/
+/*>static void RunTiles(RMSDJOB *job, int firstRow, int lastRow, 
+                        int nthreads)
+   -------------------------------------------------------------
+*//**
+
+   \param[in,out] *job      The job
+   \param[in]     firstRow  First row of tiles
+   \param[in]     lastRow   Last row of tiles
+   \param[in]     nthreads  Number of threads (0 for one per processor)
+
+   Calculates the tiles on and above the diagonal in a band of rows of
+   tiles, sharing the tiles between threads. job->ok is cleared if a
+   thread can't be started and there is no thread to do the work.
+
+-  16.10.26 Original
+*/
+static void RunTiles(RMSDJOB *job, int firstRow, int lastRow, 
+                     int nthreads)
+{
+   int ntilerows = (job->nmodels + RMSD_TILE - 1) / RMSD_TILE,
+       tr;
+
+   job->firstRow = firstRow;
+   job->lastRow  = lastRow;
+   job->nextTile = 0;
+   job->ntiles   = 0;
+   for(tr=firstRow; tr<=lastRow; tr++)
+      job->ntiles += ntilerows - tr;
+
+#ifdef NOTHREADS
+   nthreads = 1;
+#else
+   if(nthreads <= 0)
+   {
+      long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+      nthreads = (nproc > 0) ? (int)nproc : 1;
+   }
+   if(nthreads > job->ntiles)
+      nthreads = job->ntiles;
+#endif
+
+   if(nthreads <= 1)
+   {
+      int tile, ti, tj;
+      
+      for(tile=0; tile<job->ntiles; tile++)
+      {
+         FindTile(job, tile, &ti, &tj);
+         CalcTile(job, ti, tj);
+      }
+   }
+#ifndef NOTHREADS
+   else
+   {
+      pthread_t *threads;
+      int       nstarted = 0,
+                i;
+      
+      if((threads = (pthread_t *)malloc(nthreads * sizeof(pthread_t)))
+         == NULL)
+      {
+         job->ok = FALSE;
+         return;
+      }
+
+      pthread_mutex_init(&(job->mutex), NULL);
+      for(i=1; i<nthreads; i++)
+      {
+         if(pthread_create(&(threads[nstarted]), NULL, RMSDWorker,
+                           (void *)job) == 0)
+            nstarted++;
+      }
+      RMSDWorker((void *)job);
+      
+      for(i=0; i<nstarted; i++)
+         pthread_join(threads[i], NULL);
+
+      pthread_mutex_destroy(&(job->mutex));
+      free(threads);
+   }
+#endif
+}
+
+
+/************************************************************************/
+/*>static void *RMSDWorker(void *arg)
+   ----------------------------------
+*//**
+
+   \param[in,out] *arg      The RMSDJOB
+   \return                  NULL
+
+   Thread function. Takes tiles from the job until all are done.
+
+-  16.10.26 Original
+*/
+static void *RMSDWorker(void *arg)
+{
+#ifndef NOTHREADS
+   RMSDJOB *job = (RMSDJOB *)arg;
+   int     tile, ti, tj;
+
+   for(;;)
+   {
+      pthread_mutex_lock(&(job->mutex));
+      tile = job->nextTile++;
+      pthread_mutex_unlock(&(job->mutex));
+
+      if(tile >= job->ntiles)
+         break;
+      FindTile(job, tile, &ti, &tj);
+      CalcTile(job, ti, tj);
+   }
+#endif
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static void FindTile(RMSDJOB *job, int tile, int *ti, int *tj)
+   --------------------------------------------------------------
+*//**
+
+   \param[in]     *job      The job
+   \param[in]     tile      Tile number within the current band
+   \param[out]    *ti       Row of tiles
+   \param[out]    *tj       Column of tiles
+
+   Converts a tile number to its row and column. The tiles in each row
+   start on the diagonal.
+
+-  16.10.26 Original
+*/
+static void FindTile(RMSDJOB *job, int tile, int *ti, int *tj)
+{
+   int ntilerows = (job->nmodels + RMSD_TILE - 1) / RMSD_TILE,
+       tr;
+
+   for(tr=job->firstRow; tr<=job->lastRow; tr++)
+   {
+      if(tile < ntilerows - tr)
+         break;
+      tile -= ntilerows - tr;
+   }
+   *ti = tr;
+   *tj = tr + tile;
+}
+
+
+/************************************************************************/
+/*>static void CalcTile(RMSDJOB *job, int ti, int tj)
+   --------------------------------------------------
+*//**
+
+   \param[in,out] *job      The job
+   \param[in]     ti        Row of tiles
+   \param[in]     tj        Column of tiles
+
+   Calculates the RMSDs for the pairs of models in a tile, storing them
+   in the packed matrix or the rows being written to a file
+
+-  16.10.26 Original
+*/
+static void CalcTile(RMSDJOB *job, int ti, int tj)
+{
+   int  iFirst = ti * RMSD_TILE,
+        iLast  = MIN(iFirst + RMSD_TILE, job->nmodels),
+        jFirst = tj * RMSD_TILE,
+        jLast  = MIN(jFirst + RMSD_TILE, job->nmodels),
+        rowFirst = job->firstRow * RMSD_TILE,
+        i, j, k;
+   REAL A[3][3],
+        rmsd;
+
+   for(i=iFirst; i<iLast; i++)
+   {
+      FITTARGET *target = job->targets[i];
+      COOR      *ci  = target->coor;
+      REAL      *w   = target->weights;
+      
+      for(j=MAX(jFirst, i+1); j<jLast; j++)
+      {
+         COOR *cj = job->targets[j]->coor;
+
+         A[0][0] = A[0][1] = A[0][2] = 0.0;
+         A[1][0] = A[1][1] = A[1][2] = 0.0;
+         A[2][0] = A[2][1] = A[2][2] = 0.0;
+         
+         for(k=0; k<target->ncoor; k++)
+         {
+            REAL wx = ci[k].x,
+                 wy = ci[k].y,
+                 wz = ci[k].z;
+            
+            if(w != NULL)
+            {
+               wx *= w[k];
+               wy *= w[k];
+               wz *= w[k];
+            }
+            A[0][0] += wx * cj[k].x;
+            A[0][1] += wx * cj[k].y;
+            A[0][2] += wx * cj[k].z;
+            A[1][0] += wy * cj[k].x;
+            A[1][1] += wy * cj[k].y;
+            A[1][2] += wy * cj[k].z;
+            A[2][0] += wz * cj[k].x;
+            A[2][1] += wz * cj[k].y;
+            A[2][2] += wz * cj[k].z;
+         }
+
+         rmsd = blQCPInnerRMSD(A, target->g, job->targets[j]->g, 
+                               target->wsum);
+         
+         if(job->matrix != NULL)
+            job->matrix[RMSDMATRIX_INDEX(i, j, job->nmodels)] = rmsd;
+         else
+            job->rows[(long)(i - rowFirst) * job->nmodels + j] = rmsd;
+      }
+   }
+}
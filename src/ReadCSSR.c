@@ -3,8 +3,8 @@
 
    \file       ReadCSSR.c
    
-   \version    V1.7
-   \date       15.08.14
+   \version    V1.8
+   \date       16.10.26
    \brief      Read a CSSR file
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1991-2014
@@ -144,6 +144,8 @@
 -  V1.5  30.05.02 Changed PDB field from 'junk' to 'record_type'
 -  V1.6  07.07.14 Use bl prefix for functions By: CTP
 -  V1.7  15.08.14 Updated blReadCSSRasPDB() to use CLEAR_PDB() By: CTP
+-  V1.8  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Doxygen
@@ -439,18 +441,18 @@ PDB *blReadCSSRasPDB(FILE  *fp,
       /* Allocate space                                                 */
       if(pdb == NULL)
       {
-         INIT(pdb, PDB);
+         INITPDB(pdb);
          p = pdb;
       }
       else
       {
-         ALLOCNEXT(p, PDB);
+         ALLOCNEXTPDB(p);
       }
       
       /* Check allocation                                               */
       if(p==NULL)
       {
-         if(pdb==NULL) FREELIST(pdb, PDB);
+         if(pdb==NULL) FREEPDBLIST(pdb);
          return(NULL);
       }
 
@@ -3,8 +3,8 @@
 
    \file       ReadPDB.c
    
-   \version    V2.36
-   \date       29.09.14
+   \version    V2.42
+   \date       16.10.26
    \brief      Read coordinates from a PDB file 
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1988-2014
@@ -46,7 +46,7 @@
    pdb_entry. The structure is set up by including the file
    "pdb.h". For details of the structure, see this file.
 
-   To free the space created by this routine, call FREELIST(pdb,PDB).
+   To free the space created by this routine, call FREEPDBLIST(pdb).
 
    The parameters passed to the subroutine are:
 
@@ -202,6 +202,25 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
 -  V2.36 29.09.14 Allow single character check for filetype where ungetc()
                   fails after pushback of single character. Updates to 
                   blCheckFileFormatPDBML() and blDoReadPDB(). By: CTP
+-  V2.37 16.10.26 The body of the blDoReadPDB() loop is now in 
+                  blReadPDBLine() and the fsscanf() call has been 
+                  replaced by a fixed-column decoder. Added 
+                  blReadPDBMapped() and blDoReadPDBMapped() which 
+                  memory-map the file.
+-  V2.38 16.10.26 gzipped files are decompressed in-process with zlib
+                  (blUncompressedStream()) instead of piping through 
+                  gunzip into a temporary file. Removed popen() and
+                  pclose() prototypes which are no longer used here.
+-  V2.39 16.10.26 Added blOpenPDBModelReader(), blReadNextPDBModel() and
+                  blClosePDBModelReader(). blDoReadPDBML() split up so
+                  the document can be shared between models
+-  V2.40 16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
+-  V2.41 16.10.26 Residue, atom and element codes are set on each atom
+                  as it is stored
+-  V2.42 16.10.26 Added blReadPDBLite(), blDoReadPDBLite(),
+                  blReadPDBLiteMapped() and blDoReadPDBLiteMapped() 
+                  which fill a PDBLITE without building a linked list
 
 *************************************************************************/
 /* Doxygen
@@ -234,6 +253,35 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
    A lower level routine giving full control over reading all or only
    ATOM records, occupancy rankings and model numbers.
 
+   #FUNCTION blReadPDBMapped() 
+   As blReadPDB(), but takes a filename and reads the file through a 
+   memory map. Much faster for very large files
+
+   #FUNCTION blDoReadPDBMapped() 
+   Memory-mapped equivalent of blDoReadPDB()
+
+   #FUNCTION blReadPDBLite() 
+   Reads a PDB file into a compact atom table
+
+   #FUNCTION blDoReadPDBLite() 
+   As blDoReadPDB(), but fills a compact atom table
+
+   #FUNCTION blReadPDBLiteMapped() 
+   Memory-mapped equivalent of blReadPDBLite()
+
+   #FUNCTION blDoReadPDBLiteMapped() 
+   Memory-mapped equivalent of blDoReadPDBLite()
+
+   #FUNCTION blOpenPDBModelReader() 
+   Starts reading the models of a multi-model (NMR or ensemble) file 
+   one at a time in a single pass
+
+   #FUNCTION blReadNextPDBModel() 
+   Reads the next model from a PDBMODELREADER
+
+   #FUNCTION blClosePDBModelReader() 
+   Finishes with a PDBMODELREADER
+
    #FUNCTION blDoReadPDBML() 
    A lower level routine giving full control over reading all or only
    ATOM records, occupancy rankings and model numbers from a PDBML XML
@@ -271,6 +319,12 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
 #include <stdlib.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef NOMMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
 
 #ifdef XML_SUPPORT /* Required to read PDBML files                      */
 #include <libxml/parser.h>
@@ -289,20 +343,89 @@ BUGS:  25.01.05 Note the multiple occupancy code won't work properly for
 #define XML_BUFFER 1024
 #define XML_SAMPLE 256
 
+/* Return values from blReadPDBLine()                                   */
+#define READPDB_LINE_OK     0
+#define READPDB_LINE_DONE   1
+#define READPDB_LINE_ERROR  2
+
+/************************************************************************/
+/* Type definitions
+*/
+/* Everything blDoReadPDB() needs to remember between lines. The fields
+   read from the current record are kept here too since, as with the 
+   old fsscanf() version, a numeric field which can't be read keeps the
+   value from the previous line
+*/
+typedef struct
+{
+   PDB    *pdb,                 /* Start of list being built            */
+          *p,                   /* Last item in the list                */
+          multi[MAXPARTIAL],    /* Temporary storage for partial occ    */
+          litenode;             /* Record reused when filling a PDBLITE */
+   PDBLITE *lite;               /* Table being filled instead of a list */
+   double x, y, z,
+          occ, bval;
+   int    *natom,
+          OccRank,
+          ModelNum,
+          ModelCount,
+          NPartial,
+          CurRes,
+          atnum,
+          resnum,
+          charge;
+   BOOL   AllAtoms;
+   char   record_type[8],
+          atnambuff[8],
+          atnam_raw[8],
+          resnam[8],
+          chain[4],
+          insert[4],
+          CurAtom[8],
+          element_buff[4],
+          charge_buff[4],
+          element[4],
+          CurIns,
+          altpos;
+}  READPDBSTATE;
+
 /************************************************************************/
 /* Prototypes
 */
 static BOOL blStoreOccRankAtom(int OccRank, PDB multi[MAXPARTIAL], 
                                int NPartial, PDB **ppdb, PDB **pp, 
                                int *natom);
+static void blInitReadPDBState(READPDBSTATE *state, int *natom, 
+                               BOOL AllAtoms, int OccRank, int ModelNum);
+static int  blReadPDBLine(READPDBSTATE *state, char *buffer, int length);
+static PDB *blFinishReadPDBState(READPDBSTATE *state);
+static int  blAbortReadPDBState(READPDBSTATE *state);
+static BOOL blStorePartialAtom(READPDBSTATE *state);
+static PDB  *blListToPDBLite(PDB *pdb, int *natom, PDBLITE *lite);
+static PDB  *blReadPDBStream(FILE *fpin, int *natom, BOOL AllAtoms, 
+                             int OccRank, int ModelNum, PDBLITE *lite);
+static PDB  *blReadPDBFileMapped(char *filename, int *natom, 
+                                 BOOL AllAtoms, int OccRank, 
+                                 int ModelNum, PDBLITE *lite);
+static BOOL blReadPDBBuffer(READPDBSTATE *state, char *buffer, 
+                            long length);
+static BOOL blIsPlainPDBBuffer(char *buffer, long length);
+static void blUnmapPDBBuffer(char *buffer, long length);
+static BOOL blDecodePDBRecord(READPDBSTATE *state, char *buffer, 
+                              int length);
+static void blGetColumns(char *buffer, int length, int start, int width,
+                         char *out);
+static void blDecodeInt(char *field, int *value);
+static void blDecodeReal(char *field, double *value);
 static void blProcessElementField(char *element, char *element_field);
 static void blProcessChargeField(int *charge, char *charge_field);
-
-#if !defined(__APPLE__) && !defined(MS_WINDOWS)
-FILE *popen(char *, char *);
-#endif
-#ifndef __APPLE__
-int  pclose(FILE *);
+#ifdef XML_SUPPORT
+static xmlDoc  *blReadPDBMLDocument(FILE *fpin);
+static xmlNode *blFindPDBMLAtomSites(xmlDoc *document);
+static PDB     *blReadPDBMLModel(xmlNode *start, int *natom, 
+                                 BOOL AllAtoms, int OccRank, 
+                                 int ModelNum, xmlNode **next);
+static int     blPDBMLModelNumber(xmlNode *atom_node);
 #endif
 
 /************************************************************************/
@@ -527,6 +650,14 @@ PDB *blReadPDBAtomsOccRank(FILE *fp, int *natom, int OccRank)
                   MS Windows. By: CTP
 -  29.09.14 V2.36 Allow single character filetype check for gzipped files.
                   By: CTP
+-  16.10.26 V2.37 Each line is now handled by blReadPDBLine() which 
+                  decodes the columns directly rather than with 
+                  fsscanf()
+-  16.10.26 V2.38 gzipped files are decompressed in-process by 
+                  blUncompressedStream() rather than via gunzip and a
+                  temporary file. The temporary file is now closed
+-  16.10.26 V2.42 Body moved to blReadPDBStream() which can also fill a
+                  PDBLITE
 
 */
 PDB *blDoReadPDB(FILE *fpin,
@@ -535,351 +666,1369 @@ PDB *blDoReadPDB(FILE *fpin,
                  int  OccRank,
                  int  ModelNum)
 {
-   char     record_type[8],
-            atnambuff[8],
-            *atnam,
-            atnam_raw[8],
-            resnam[8],
-            chain[4],
-            insert[4],
-            buffer[160],
-            CurAtom[8],
-            cmd[80],
-            CurIns = ' ',
-            altpos,
-            element_buff[4] = "",
-            charge_buff[4]  = "",
-            element[4]      = "";
-   int      atnum,
-            resnum,
-            CurRes = 0,
-            NPartial,
-            ModelCount = 1,
-            charge = 0;
-   FILE     *fp = fpin;
-   double   x,y,z,
-            occ,
-            bval;
-   PDB      *pdb  = NULL,
-            *p,
-            multi[MAXPARTIAL];   /* Temporary storage for partial occ   */
-
-#if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS)
-   int      signature[3],
-            ch;
-   BOOL     gzipped_file = FALSE;
-#  ifndef SINGLE_CHAR_FILECHECK
-   int      i;
-#  endif
+   return(blReadPDBStream(fpin, natom, AllAtoms, OccRank, ModelNum, 
+                          NULL));
+}
+
+/************************************************************************/
+/*>PDB *blReadPDBMapped(char *filename, int *natom)
+   ------------------------------------------------
+*//**
+
+   \param[in]     *filename  Name of the PDB file
+   \param[out]    *natom     Number of atoms read. -1 if error.
+   \return                   A pointer to the first allocated item of
+                             the PDB linked list
+
+   As blReadPDB(), but the file is memory-mapped and ATOM/HETATM records
+   are decoded directly by column rather than via fgets() and fsscanf().
+   This is considerably faster for very large files.
+
+-  16.10.26 Original
+*/
+PDB *blReadPDBMapped(char *filename,
+                     int  *natom)
+{
+   PDB *pdb;
+   pdb = blDoReadPDBMapped(filename, natom, TRUE, 1, 1);
+   pdb = blRemoveAlternates(pdb);
+   return(pdb);
+}
+
+/************************************************************************/
+/*>PDB *blDoReadPDBMapped(char *filename, int *natom, BOOL AllAtoms, 
+                          int OccRank, int ModelNum)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *filename  Name of the PDB file
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \param[in]     ModelNum   NMR Model number (0 = all)
+   \param[out]    *natom     Number of atoms read. -1 if error.
+   \return                   A pointer to the first allocated item of
+                             the PDB linked list
+
+   Memory-mapped equivalent of blDoReadPDB(). The whole file is mapped
+   into memory and each record is decoded in place by fixed column
+   offsets. The resulting linked list, natom, gPDBPartialOcc and 
+   gPDBMultiNMR are exactly as blDoReadPDB() would give for the same 
+   file.
+
+   Compressed and PDBML files cannot be decoded in place, so these are
+   simply handed on to blDoReadPDB(). On systems without mmap() the file
+   is read into memory with a single fread().
+
+-  16.10.26 Original
+-  16.10.26 Body moved to blReadPDBFileMapped()
+*/
+PDB *blDoReadPDBMapped(char *filename,
+                       int  *natom,
+                       BOOL AllAtoms,
+                       int  OccRank,
+                       int  ModelNum)
+{
+   return(blReadPDBFileMapped(filename, natom, AllAtoms, OccRank, 
+                              ModelNum, NULL));
+}
+
+/************************************************************************/
+/*>PDBLITE *blReadPDBLite(FILE *fp)
+   --------------------------------
+*//**
+
+   \param[in]     *fp      A pointer to type FILE in which the
+                           .PDB file is stored.
+   \return                 Compact atom table. NULL on error
+
+   Reads a PDB file into a compact atom table (see PDBLite.c) without
+   building a linked list. The atoms are those blDoReadPDB() reads for
+   the first model with ATOM and HETATM records and the highest 
+   occupancy alternates. Unlike blReadPDB(), blRemoveAlternates() is 
+   not applied.
+
+-  16.10.26 Original
+*/
+PDBLITE *blReadPDBLite(FILE *fp)
+{
+   return(blDoReadPDBLite(fp, TRUE, 1, 1));
+}
+
+/************************************************************************/
+/*>PDBLITE *blDoReadPDBLite(FILE *fp, BOOL AllAtoms, int OccRank, 
+                            int ModelNum)
+   --------------------------------------------------------------
+*//**
+
+   \param[in]     *fp        A pointer to type FILE in which the
+                             .PDB file is stored.
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \param[in]     ModelNum   NMR Model number (0 = all)
+   \return                   Compact atom table. NULL on error
+
+   As blDoReadPDB(), but the atoms are stored directly in a compact 
+   atom table. No PDB records are allocated except for PDBML files and
+   partial occupancy atoms.
+
+-  16.10.26 Original
+*/
+PDBLITE *blDoReadPDBLite(FILE *fp, BOOL AllAtoms, int OccRank, 
+                         int ModelNum)
+{
+   PDBLITE *lite;
+   int     natom;
+
+   if((lite = blAllocPDBLite(0))==NULL)
+      return(NULL);
+
+   blReadPDBStream(fp, &natom, AllAtoms, OccRank, ModelNum, lite);
+   if(natom < 0)
+   {
+      blFreePDBLite(lite);
+      return(NULL);
+   }
+
+   blResizePDBLite(lite, lite->natoms);
+   return(lite);
+}
+
+/************************************************************************/
+/*>PDBLITE *blReadPDBLiteMapped(char *filename)
+   --------------------------------------------
+*//**
+
+   \param[in]     *filename  Name of the PDB file
+   \return                   Compact atom table. NULL on error
+
+   As blReadPDBLite(), but the file is memory-mapped as for 
+   blReadPDBMapped()
+
+-  16.10.26 Original
+*/
+PDBLITE *blReadPDBLiteMapped(char *filename)
+{
+   return(blDoReadPDBLiteMapped(filename, TRUE, 1, 1));
+}
+
+/************************************************************************/
+/*>PDBLITE *blDoReadPDBLiteMapped(char *filename, BOOL AllAtoms, 
+                                  int OccRank, int ModelNum)
+   --------------------------------------------------------------
+*//**
+
+   \param[in]     *filename  Name of the PDB file
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \param[in]     ModelNum   NMR Model number (0 = all)
+   \return                   Compact atom table. NULL on error
+
+   As blDoReadPDBLite(), but the file is memory-mapped as for 
+   blDoReadPDBMapped(). Space for the atoms is allocated once from the
+   size of the file and the unused space is released at the end.
+
+-  16.10.26 Original
+*/
+PDBLITE *blDoReadPDBLiteMapped(char *filename, BOOL AllAtoms, 
+                               int OccRank, int ModelNum)
+{
+   PDBLITE *lite;
+   int     natom;
+
+   if((lite = blAllocPDBLite(0))==NULL)
+      return(NULL);
+
+   blReadPDBFileMapped(filename, &natom, AllAtoms, OccRank, ModelNum,
+                       lite);
+   if(natom < 0)
+   {
+      blFreePDBLite(lite);
+      return(NULL);
+   }
+
+   blResizePDBLite(lite, lite->natoms);
+   return(lite);
+}
+
+
+/************************************************************************/
+/*>PDBMODELREADER *blOpenPDBModelReader(FILE *fp, BOOL AllAtoms, 
+                                        int OccRank)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *fp        A pointer to type FILE in which the
+                             .PDB file is stored. May be gzipped or
+                             PDBML
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \return                   Model reader. NULL on error
+
+   Sets up to read the models from a multi-model (NMR or ensemble) file
+   one at a time with blReadNextPDBModel(). Unlike calling blDoReadPDB()
+   for each model number, the file is read only once. fp must stay open
+   until blClosePDBModelReader() is called.
+
+   PDB     *pdb;
+   int     natom;
+   PDBMODELREADER *reader;
+   if((reader = blOpenPDBModelReader(fp, TRUE, 1))!=NULL)
+   {
+      while((pdb = blReadNextPDBModel(reader, &natom))!=NULL)
+      {
+         ... Do something with model reader->ModelNum ...
+         FREEPDBLIST(pdb);
+      }
+      blClosePDBModelReader(reader);
+   }
+
+-  16.10.26 Original
+*/
+PDBMODELREADER *blOpenPDBModelReader(FILE *fp, BOOL AllAtoms, 
+                                     int OccRank)
+{
+   PDBMODELREADER *reader;
+#ifdef XML_SUPPORT
+   xmlDoc         *document;
+   xmlNode        *sites_node;
+#endif
+   
+   if((reader=(PDBMODELREADER *)malloc(sizeof(PDBMODELREADER)))==NULL)
+      return(NULL);
+
+   reader->fpin     = fp;
+   reader->xmlDoc   = NULL;
+   reader->xmlNext  = NULL;
+   reader->ModelNum = 0;
+   reader->OccRank  = OccRank;
+   reader->AllAtoms = AllAtoms;
+   reader->multi    = FALSE;
+   reader->done     = FALSE;
+   
+   /* If the file is gzipped or compressed, get a stream of the 
+      uncompressed data
+   */
+   if((reader->fp = blUncompressedStream(fp, reader->tmpfile))==NULL)
+   {
+      blClosePDBModelReader(reader);
+      return(NULL);
+   }
+
+   reader->pdbml = blCheckFileFormatPDBML(reader->fp);
+   gPDBXML       = reader->pdbml;
+
+   if(reader->pdbml)
+   {
+#ifdef XML_SUPPORT
+      /* The whole document is parsed once and models are then taken 
+         from it in turn
+      */
+      if((document = blReadPDBMLDocument(reader->fp)) == NULL)
+      {
+         blClosePDBModelReader(reader);
+         return(NULL);
+      }
+      reader->xmlDoc = (void *)document;
+      
+      if((sites_node = blFindPDBMLAtomSites(document)) == NULL)
+      {
+         blClosePDBModelReader(reader);
+         return(NULL);
+      }
+      reader->xmlNext = (void *)sites_node->children;
+#else
+      /* PDBML format not supported.                                    */
+      blClosePDBModelReader(reader);
+      return(NULL);
+#endif
+   }
+   
+   return(reader);
+}
+
+/************************************************************************/
+/*>PDB *blReadNextPDBModel(PDBMODELREADER *reader, int *natom)
+   -----------------------------------------------------------
+*//**
+
+   \param[in,out] *reader    Model reader from blOpenPDBModelReader()
+   \param[out]    *natom     Number of atoms read. -1 if error, 0 if 
+                             there are no more models
+   \return                   A pointer to the first allocated item of
+                             the PDB linked list for the next model. 
+                             NULL when there are no more models or on
+                             error
+
+   Reads the next model. reader->ModelNum is set to the number of the
+   model returned, counting from 1 as for blDoReadPDB(). A file without
+   MODEL/ENDMDL records is returned as a single model. Models which 
+   contain no atoms that we want are skipped (but still counted).
+
+   gPDBPartialOcc is set as for blDoReadPDB(). gPDBMultiNMR is set once
+   a second model has been found.
+
+-  16.10.26 Original
+*/
+PDB *blReadNextPDBModel(PDBMODELREADER *reader, int *natom)
+{
+   char         buffer[160];
+   int          status;
+   BOOL         endmdl = FALSE;
+   PDB          *pdb   = NULL;
+   READPDBSTATE state;
+
+   *natom = 0;
+
+   while((pdb == NULL) && !reader->done)
+   {
+      reader->ModelNum++;
+      
+      if(reader->pdbml)
+      {
+#ifdef XML_SUPPORT
+         xmlNode *start = (xmlNode *)reader->xmlNext,
+                 *next  = NULL;
+
+         /* Skip anything that isn't an atom                            */
+         while((start != NULL) && strcmp("atom_site",(char *)start->name))
+            start = start->next;
+         
+         if(start == NULL)
+         {
+            reader->done = TRUE;
+            break;
+         }
+
+         gPDBPartialOcc = FALSE;
+         reader->ModelNum = blPDBMLModelNumber(start);
+         pdb = blReadPDBMLModel(start, natom, reader->AllAtoms, 
+                                reader->OccRank, reader->ModelNum, 
+                                &next);
+         if(pdb == NULL)
+            *natom = 0;
+         if((reader->xmlNext = (void *)next) == NULL)
+            reader->done = TRUE;
+#endif
+      }
+      else
+      {
+         blInitReadPDBState(&state, natom, reader->AllAtoms, 
+                            reader->OccRank, 0);
+         gPDBMultiNMR = reader->multi;
+         endmdl       = FALSE;
+
+         /* Read up to and including the ENDMDL                         */
+         while(fgets(buffer,159,reader->fp))
+         {
+            status = blReadPDBLine(&state, buffer, strlen(buffer));
+            if(status == READPDB_LINE_ERROR)
+            {
+               reader->done = TRUE;
+               return(NULL);
+            }
+
+            if(!strncmp(buffer,"ENDMDL",6))
+            {
+               endmdl        = TRUE;
+               reader->multi = TRUE;
+               break;
+            }
+         }
+
+         if(!endmdl)
+            reader->done = TRUE;
+
+         if((pdb = blFinishReadPDBState(&state)) == NULL)
+         {
+            if(*natom < 0)
+            {
+               reader->done = TRUE;
+               return(NULL);
+            }
+         }
+      }
+   }
+
+   if(pdb == NULL)
+      reader->ModelNum--;
+
+   return(pdb);
+}
+
+/************************************************************************/
+/*>void blClosePDBModelReader(PDBMODELREADER *reader)
+   --------------------------------------------------
+*//**
+
+   \param[in]     *reader    Model reader from blOpenPDBModelReader()
+
+   Frees the model reader. The file pointer given to 
+   blOpenPDBModelReader() is not closed.
+
+-  16.10.26 Original
+*/
+void blClosePDBModelReader(PDBMODELREADER *reader)
+{
+   if(reader == NULL)
+      return;
+   
+#ifdef XML_SUPPORT
+   if(reader->xmlDoc != NULL)
+   {
+      xmlFreeDoc((xmlDoc *)reader->xmlDoc);
+      xmlCleanupParser();
+   }
 #endif
+   if((reader->fp != NULL) && (reader->fp != reader->fpin))
+      fclose(reader->fp);
+   if(reader->tmpfile[0])
+      unlink(reader->tmpfile);
+   free(reader);
+}
+
+/************************************************************************/
+/*>static PDB *blReadPDBStream(FILE *fpin, int *natom, BOOL AllAtoms, 
+                               int OccRank, int ModelNum, PDBLITE *lite)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in]     *fpin      A pointer to type FILE in which the
+                             .PDB file is stored.
+   \param[out]    *natom     Number of atoms read. -1 if error.
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \param[in]     ModelNum   NMR Model number (0 = all)
+   \param[in,out] *lite      Compact atom table to fill instead of a 
+                             linked list (or NULL)
+   \return                   A pointer to the first allocated item of
+                             the PDB linked list (NULL if lite is given)
+
+   The body of blDoReadPDB(). If lite is given, the atoms are added to 
+   it rather than to a linked list.
+
+-  16.10.26 Original - split from blDoReadPDB()
+*/
+static PDB *blReadPDBStream(FILE *fpin,
+                            int  *natom,
+                            BOOL AllAtoms,
+                            int  OccRank,
+                            int  ModelNum,
+                            PDBLITE *lite)
+{
+   char         buffer[160],
+                cmd[80];
+   int          status;
+   FILE         *fp = fpin;
+   PDB          *pdb;
+   READPDBSTATE state;
 
-   *natom         = 0;
-   CurAtom[0]     = '\0';
-   NPartial       = 0;
-   gPDBPartialOcc = FALSE;
-   gPDBMultiNMR   = FALSE;
    cmd[0]         = '\0';
    gPDBXML        = FALSE;
+   blInitReadPDBState(&state, natom, AllAtoms, OccRank, ModelNum);
+   state.lite     = lite;
 
-#if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS)
-   /* See whether this is a gzipped file                                */
-#  ifndef SINGLE_CHAR_FILECHECK
-   /* Default three character filetype check                            */
-   for(i=0; i<3; i++)
-      signature[i] = fgetc(fpin);
-   for(i=2; i>=0; i--)
-      ungetc(signature[i], fpin);
-   if(((signature[0] == (int)0x1F) &&    /* gzip                        */
-       (signature[1] == (int)0x8B) &&
-       (signature[2] == (int)0x08)) ||
-      ((signature[0] == (int)0x1F) &&    /* 05.06.07 compress           */
-       (signature[1] == (int)0x9D) &&
-       (signature[2] == (int)0x90)))
+   /* If the file is gzipped or compressed, get a stream of the 
+      uncompressed data
+   */
+   if((fp = blUncompressedStream(fpin, cmd))==NULL)
    {
-      gzipped_file = TRUE;
+      if(cmd[0]) unlink(cmd);
+      *natom = (-1);
+      return(NULL);
    }
-#  else
-   /* Single character filetype check                                   */
-   signature[0] = fgetc(fpin);
-   ungetc(signature[0], fpin);
-   if(signature[0] == (int)0x1F) gzipped_file = TRUE;
-#  endif
-
-   if(gzipped_file)
+
+
+   /* Check file format */
+   if(blCheckFileFormatPDBML(fp))
    {
-      /* It is gzipped so we'll open gunzip as a pipe and send the data
-         through that into a temporary file
-      */
-      sprintf(cmd,"gunzip >/tmp/readpdb_%d",(int)getpid());
-      if((fp = (FILE *)popen(cmd,"w"))==NULL)
+#ifdef XML_SUPPORT
+
+      /* Parse PDBML-formatted PDB file */
+      pdb = blDoReadPDBML(fp,natom,AllAtoms,OccRank,ModelNum);
+      if(lite != NULL)
+         pdb = blListToPDBLite(pdb, natom, lite);
+      xmlCleanupParser();     /* free globals set by parser */
+      if(fp != fpin) fclose(fp);
+      if(cmd[0]) unlink(cmd); /* delete tmp file            */
+      return( pdb );          /* return PDB list            */
+
+#else
+
+      /* PDBML format not supported. */
+      if(fp != fpin) fclose(fp);
+      if(cmd[0]) unlink(cmd); /* delete tmp file            */
+      *natom = (-1);          /* Indicate error             */
+      return( NULL );         /* return NULL list           */
+
+#endif
+   }
+
+
+   while(fgets(buffer,159,fp))
+   {
+      status = blReadPDBLine(&state, buffer, strlen(buffer));
+      if(status == READPDB_LINE_ERROR)
+      {
+         if(fp != fpin) fclose(fp);
+         if(cmd[0]) unlink(cmd);
+         return(NULL);
+      }
+      else if(status == READPDB_LINE_DONE)
+      {
+         break;
+      }
+   }
+
+   pdb = blFinishReadPDBState(&state);
+
+   if(fp != fpin) fclose(fp);
+   if(cmd[0]) unlink(cmd);
+
+   /* Return pointer to start of linked list                            */
+   return(pdb);
+}
+
+/************************************************************************/
+/*>static PDB *blReadPDBFileMapped(char *filename, int *natom, 
+                                   BOOL AllAtoms, int OccRank, 
+                                   int ModelNum, PDBLITE *lite)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *filename  Name of the PDB file
+   \param[out]    *natom     Number of atoms read. -1 if error.
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \param[in]     ModelNum   NMR Model number (0 = all)
+   \param[in,out] *lite      Compact atom table to fill instead of a 
+                             linked list (or NULL)
+   \return                   A pointer to the first allocated item of
+                             the PDB linked list (NULL if lite is given)
+
+   The body of blDoReadPDBMapped(). If lite is given, the atoms are 
+   added to it rather than to a linked list.
+
+-  16.10.26 Original - split from blDoReadPDBMapped()
+*/
+static PDB *blReadPDBFileMapped(char *filename,
+                                int  *natom,
+                                BOOL AllAtoms,
+                                int  OccRank,
+                                int  ModelNum,
+                                PDBLITE *lite)
+{
+   PDB          *pdb    = NULL;
+   char         *buffer = NULL;
+   long         length  = 0;
+   FILE         *fp;
+   READPDBSTATE state;
+   struct stat  statbuf;
+#ifndef NOMMAP
+   int          fd;
+#endif
+
+   *natom = 0;
+   
+#ifdef NOMMAP
+   /* Read the whole file into memory                                   */
+   if((fp=fopen(filename, "rb"))==NULL)
+   {
+      *natom = (-1);
+      return(NULL);
+   }
+   if((stat(filename, &statbuf) != 0) ||
+      ((buffer = (char *)malloc(statbuf.st_size+1))==NULL))
+   {
+      fclose(fp);
+      *natom = (-1);
+      return(NULL);
+   }
+   length = (long)fread(buffer, 1, statbuf.st_size, fp);
+   fclose(fp);
+#else
+   /* Map the file into memory                                          */
+   if((fd = open(filename, O_RDONLY)) == (-1))
+   {
+      *natom = (-1);
+      return(NULL);
+   }
+   if(fstat(fd, &statbuf) != 0)
+   {
+      close(fd);
+      *natom = (-1);
+      return(NULL);
+   }
+   length = (long)statbuf.st_size;
+   if(length > 0)
+   {
+      if((buffer = (char *)mmap(NULL, (size_t)length, PROT_READ, 
+                                MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+      {
+         close(fd);
+         *natom = (-1);
+         return(NULL);
+      }
+   }
+   close(fd);
+#endif
+
+   /* Compressed or PDBML files go through the normal reader            */
+   if(!blIsPlainPDBBuffer(buffer, length))
+   {
+      blUnmapPDBBuffer(buffer, length);
+      if((fp=fopen(filename, "r"))==NULL)
       {
          *natom = (-1);
          return(NULL);
       }
-      while((ch=fgetc(fpin))!=EOF)
-         fputc(ch, fp);
-      pclose(fp);
+      pdb = blReadPDBStream(fp, natom, AllAtoms, OccRank, ModelNum, 
+                            lite);
+      fclose(fp);
+      return(pdb);
+   }
+
+   gPDBXML = FALSE;
+   blInitReadPDBState(&state, natom, AllAtoms, OccRank, ModelNum);
+   state.lite = lite;
+
+   /* An ATOM record is at least 54 characters and usually 81 with the
+      newline, so make space for the atoms in one go
+   */
+   if(lite != NULL)
+      blResizePDBLite(lite, (int)(length / 81) + 1);
+
+   if(blReadPDBBuffer(&state, buffer, length))
+      pdb = blFinishReadPDBState(&state);
+
+   blUnmapPDBBuffer(buffer, length);
+   return(pdb);
+}
+
+/************************************************************************/
+/*>static BOOL blStorePartialAtom(READPDBSTATE *state)
+   ---------------------------------------------------
+*//**
+
+   \param[in,out] *state     Reader state
+   \return                   Memory allocation success
+
+   Stores the chosen partial occupancy atom from state->multi[] with
+   blStoreOccRankAtom() in the linked list or, when filling a PDBLITE,
+   in the table.
+
+-  16.10.26 Original
+*/
+static BOOL blStorePartialAtom(READPDBSTATE *state)
+{
+   PDB  *atom = NULL,
+        *last = NULL;
+   BOOL ok;
+
+   if(state->lite == NULL)
+   {
+      return(blStoreOccRankAtom(state->OccRank, state->multi, 
+                                state->NPartial, &(state->pdb),
+                                &(state->p), state->natom));
+   }
+
+   ok = blStoreOccRankAtom(state->OccRank, state->multi, 
+                           state->NPartial, &atom, &last, state->natom) &&
+        blAppendPDBLite(state->lite, atom);
+   if(atom != NULL) FREEPDBLIST(atom);
+   return(ok);
+}
+
+/************************************************************************/
+/*>static PDB *blListToPDBLite(PDB *pdb, int *natom, PDBLITE *lite)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     *pdb       PDB linked list. Freed
+   \param[in,out] *natom     Number of atoms. Set to -1 on error
+   \param[in,out] *lite      Compact atom table
+   \return                   NULL
+
+   Moves a linked list that has been read into a PDBLITE. Used for the
+   readers, such as PDBML, that cannot fill a PDBLITE directly.
+
+-  16.10.26 Original
+*/
+static PDB *blListToPDBLite(PDB *pdb, int *natom, PDBLITE *lite)
+{
+   PDB *p;
+   
+   if((*natom > 0) && !blResizePDBLite(lite, lite->natoms + *natom))
+      *natom = (-1);
+   for(p=pdb; (p!=NULL) && (*natom >= 0); NEXT(p))
+   {
+      if(!blAppendPDBLite(lite, p))
+         *natom = (-1);
+   }
+   if(pdb != NULL) FREEPDBLIST(pdb);
+   return(NULL);
+}
+
+/************************************************************************/
+/*>static void blInitReadPDBState(READPDBSTATE *state, int *natom, 
+                                  BOOL AllAtoms, int OccRank, 
+                                  int ModelNum)
+   ----------------------------------------------------------------
+*//**
+
+   \param[out]    *state     Reader state to initialise
+   \param[in]     *natom     Where the atom count is to be kept
+   \param[in]     AllAtoms   TRUE:  ATOM & HETATM records
+                             FALSE: ATOM records only
+   \param[in]     OccRank    Occupancy ranking
+   \param[in]     ModelNum   NMR Model number (0 = all)
+
+   Sets up the state used by blReadPDBLine() and resets natom and the
+   partial occupancy and multiple model flags.
+
+-  16.10.26 Original
+*/
+static void blInitReadPDBState(READPDBSTATE *state, int *natom, 
+                               BOOL AllAtoms, int OccRank, int ModelNum)
+{
+   state->pdb             = NULL;
+   state->p               = NULL;
+   state->lite            = NULL;
+   state->natom           = natom;
+   state->AllAtoms        = AllAtoms;
+   state->OccRank         = OccRank;
+   state->ModelNum        = ModelNum;
+   state->ModelCount      = 1;
+   state->NPartial        = 0;
+   state->CurRes          = 0;
+   state->CurIns          = ' ';
+   state->CurAtom[0]      = '\0';
+   state->atnum           = 0;
+   state->resnum          = 0;
+   state->charge          = 0;
+   state->x               = (double)0.0;
+   state->y               = (double)0.0;
+   state->z               = (double)0.0;
+   state->occ             = (double)0.0;
+   state->bval            = (double)0.0;
+   state->element[0]      = '\0';
+
+   *natom                 = 0;
+   gPDBPartialOcc         = FALSE;
+   gPDBMultiNMR           = FALSE;
+}
+
+/************************************************************************/
+/*>static int blReadPDBLine(READPDBSTATE *state, char *buffer, int length)
+   -----------------------------------------------------------------------
+*//**
+
+   \param[in,out] *state     Reader state
+   \param[in]     *buffer    A line from the PDB file. Need not be 
+                             terminated
+   \param[in]     length     Length of the line
+   \return                   READPDB_LINE_OK    - carry on reading
+                             READPDB_LINE_DONE  - past requested model
+                             READPDB_LINE_ERROR - memory allocation 
+                                                  failed. The list has
+                                                  been freed and natom
+                                                  set to -1
+
+   Handles one line of a PDB file, adding it to the linked list held in
+   the state if it is an ATOM or HETATM record that we want. This is the
+   body of the old blDoReadPDB() loop and is shared by all the text PDB 
+   readers.
+
+-  16.10.26 Original - split from blDoReadPDB()
+*/
+static int blReadPDBLine(READPDBSTATE *state, char *buffer, int length)
+{
+   char *atnam;
+   BOOL endmdl;
+
+   endmdl = ((length >= 6) && !strncmp(buffer,"ENDMDL",6));
+   
+   if(state->ModelNum != 0)   /* We are interested in model numbers     */
+   {
+      if(endmdl)
+         state->ModelCount++;
+
+      if(state->ModelCount < state->ModelNum)   /* Not the right model  */
+         return(READPDB_LINE_OK);
+      else if(state->ModelCount > state->ModelNum)  /* Gone past it     */
+         return(READPDB_LINE_DONE);
+   }
+
+   if(endmdl)
+      gPDBMultiNMR   = TRUE;
+      
+   if(!blDecodePDBRecord(state, buffer, length))
+      return(READPDB_LINE_OK);
+   
+   if(strncmp(state->record_type,"ATOM  ",6) &&
+      (strncmp(state->record_type,"HETATM",6) || !state->AllAtoms))
+      return(READPDB_LINE_OK);
+
+   /* Copy the raw atom name                                            */
+   /* 03.06.05 Note: this reads the alternate atom position as well as 
+      the atom name - changes in FixAtomName() now strip that
+      We now copy only the first 4 characters into atnam_raw and put the
+      5th character into altpos
+   */
+   strncpy(state->atnam_raw, state->atnambuff, 4);
+   state->atnam_raw[4] = '\0';
+   state->altpos = state->atnambuff[4];
+
+   /* Fix the atom name accounting for start in column 13 or 14         */
+   atnam = blFixAtomName(state->atnambuff, state->occ);
+            
+   /* Set element and charge                                            */
+   blProcessElementField(state->element, state->element_buff);
+   blProcessChargeField(&(state->charge), state->charge_buff);
+            
+   /* Set element from atom name if not in input file                   */
+   if(strlen(state->element) == 0)
+   {
+      blSetElementSymbolFromAtomName(state->element, state->atnam_raw);
+   }
+
+   /* Check for full occupancy. If occupancy is 0.0 assume that it is
+      actually fully occupied; the column just hasn't been filled in 
+      correctly
+               
+      04.10.94 Read all atoms if OccRank is 0
+
+      14.10.05 Now takes an atom as full occupancy:
+                  if occ==1.0
+                  if occ==0.0 and altpos==' '
+                  if OccRank==0
+               This fixes problems where a lower (partial) occupancy has
+               erroneously been set to zero
+      21.12.11 Now only worries about partial occupancy if altpos is a
+               space. The first line of the if() statement here would
+               assume single occupancy if altpos was a space and 
+               occupancy was zero:
+               if(((altpos == ' ') && (occ < (double)SMALL)) ||
+               - it now assumes single occupancy if altpos is a space 
+               regardless of the actual occupancy. This deals with cases
+               like 1ap2 ZN A112 and 1ces ZN A238 where these HETATMs are
+               single occupancy but with occupancy < 1.0
+   */
+   if((state->altpos == ' ') ||
+      (state->occ > (double)0.999) || 
+      (state->OccRank == 0))
+   {
+      PDB *p;
+      
+      /* Trim the atom name to 4 characters                             */
+      atnam[4] = '\0';
+               
+      if(state->NPartial != 0)
+      {
+         if(!blStorePartialAtom(state))
+         {
+            return(blAbortReadPDBState(state));
+         }
+                  
+         /* Set partial occupancy counter to 0                          */
+         state->NPartial = 0;
+      }
+               
+      /* Allocate space in the linked list. When filling a PDBLITE the
+         same record is used for every atom
+      */
+      if(state->lite != NULL)
+      {
+         state->p = &(state->litenode);
+      }
+      else if(state->pdb == NULL)
+      {
+         INITPDB(state->pdb);
+         state->p = state->pdb;
+      }
+      else
+      {
+         ALLOCNEXTPDB(state->p);
+      }
+               
+      /* Failed to allocate space; free up list so far & return         */
+      if((p = state->p)==NULL)
+         return(blAbortReadPDBState(state));
+               
+      /* Increment the number of atoms                                  */
+      (*(state->natom))++;
+               
+      /* Store the information read                                     */
+      CLEAR_PDB(p);
+      p->atnum  = state->atnum;
+      p->resnum = state->resnum;
+      p->x      = (REAL)state->x;
+      p->y      = (REAL)state->y;
+      p->z      = (REAL)state->z;
+      p->occ    = (REAL)state->occ;
+      p->bval   = (REAL)state->bval;
+      p->altpos = state->altpos;    /* 03.06.05 Added this one          */
+      p->formal_charge  = state->charge;
+      p->partial_charge = (REAL)state->charge;
+      p->access = 0.0;
+      p->radius = 0.0;
+      p->atomType = NULL;
+      p->next   = NULL;
+      strcpy(p->record_type, state->record_type);
+      strcpy(p->atnam,       atnam);
+      strcpy(p->atnam_raw,   state->atnam_raw);
+      strcpy(p->resnam,      state->resnam);
+      strcpy(p->chain,       state->chain);
+      strcpy(p->insert,      state->insert);
+      strcpy(p->element,     state->element);
+      blSetPDBCodes(p);
+
+      if((state->lite != NULL) && !blAppendPDBLite(state->lite, p))
+         return(blAbortReadPDBState(state));
+   }
+   else   /* Partial occupancy                                          */
+   {
+      PDB *m;
+      
+      /* Set flag to say we've got a partial occupancy atom             */
+      gPDBPartialOcc = TRUE;
+               
+      /* First in a group, store atom name                              */
+      if(state->NPartial == 0)
+      {
+         state->CurIns = state->insert[0];
+         state->CurRes = state->resnum;
+         strncpy(state->CurAtom,atnam,8);
+      }
+               
+      if(strncmp(state->CurAtom,atnam,strlen(state->CurAtom)-1) || 
+         state->resnum != state->CurRes || 
+         state->CurIns != state->insert[0])
+      {
+         /* Atom name has changed 
+            Select and store the OccRank highest occupancy atom
+         */
+         if(!blStorePartialAtom(state))
+         {
+            return(blAbortReadPDBState(state));
+         }
+                  
+         /* Reset the partial atom counter                              */
+         state->NPartial = 0;
+         strncpy(state->CurAtom,atnam,8);
+         state->CurRes = state->resnum;
+         state->CurIns = state->insert[0];
+      }
+               
+      if(state->NPartial < MAXPARTIAL)
+      {
+         /* Store the partial atom data                                 */
+         m = state->multi + state->NPartial;
+         CLEAR_PDB(m);
+         m->atnum  = state->atnum;
+         m->resnum = state->resnum;
+         m->x      = (REAL)state->x;
+         m->y      = (REAL)state->y;
+         m->z      = (REAL)state->z;
+         m->occ    = (REAL)state->occ;
+         m->bval   = (REAL)state->bval;
+         m->formal_charge  = state->charge;
+         m->partial_charge = (REAL)state->charge;
+         m->access = 0.0;
+         m->radius = 0.0;
+         m->atomType = NULL;
+         m->next   = NULL;
+         strcpy(m->record_type, state->record_type);
+         strcpy(m->atnam,       atnam);
+         /* 27.04.05 - added this line                                  */
+         strcpy(m->atnam_raw,   state->atnam_raw);
+         strcpy(m->resnam,      state->resnam);
+         strcpy(m->chain,       state->chain);
+         strcpy(m->insert,      state->insert);
+         strcpy(m->element,     state->element);
+         /* 03.06.05 - added this line                                  */
+         m->altpos = state->altpos;
+
+         (state->NPartial)++;
+      }
+   }
+
+   return(READPDB_LINE_OK);
+}
+
+/************************************************************************/
+/*>static PDB *blFinishReadPDBState(READPDBSTATE *state)
+   -----------------------------------------------------
+*//**
+
+   \param[in,out] *state     Reader state
+   \return                   The PDB linked list (NULL on error, with
+                             natom set to -1)
+
+   Stores any outstanding partial occupancy atoms and hands back the 
+   list that has been built.
+
+-  16.10.26 Original - split from blDoReadPDB()
+*/
+static PDB *blFinishReadPDBState(READPDBSTATE *state)
+{
+   if(state->NPartial != 0)
+   {
+      if(!blStorePartialAtom(state))
+      {
+         blAbortReadPDBState(state);
+         return(NULL);
+      }
+      state->NPartial = 0;
+   }
+
+   return(state->pdb);
+}
+
+/************************************************************************/
+/*>static int blAbortReadPDBState(READPDBSTATE *state)
+   ---------------------------------------------------
+*//**
+
+   \param[in,out] *state     Reader state
+   \return                   READPDB_LINE_ERROR
+
+   Frees the list built so far and flags the error in natom
+
+-  16.10.26 Original
+*/
+static int blAbortReadPDBState(READPDBSTATE *state)
+{
+   if(state->pdb != NULL) FREEPDBLIST(state->pdb);
+   state->p          = NULL;
+   state->NPartial   = 0;
+   *(state->natom)   = (-1);
+   return(READPDB_LINE_ERROR);
+}
+
+/************************************************************************/
+/*>static BOOL blReadPDBBuffer(READPDBSTATE *state, char *buffer, 
+                               long length)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in,out] *state     Reader state
+   \param[in]     *buffer    In-memory image of a PDB file
+   \param[in]     length     Length of the buffer
+   \return                   FALSE if memory allocation failed
+
+   Splits an in-memory PDB file into lines and passes each to 
+   blReadPDBLine()
+
+-  16.10.26 Original
+*/
+static BOOL blReadPDBBuffer(READPDBSTATE *state, char *buffer, 
+                            long length)
+{
+   char *line = buffer,
+        *end  = buffer + length,
+        *eol;
+   int  status;
+   
+   while(line < end)
+   {
+      if((eol = (char *)memchr(line, '\n', (size_t)(end - line)))==NULL)
+         eol = end;
+      else
+         eol++;
+
+      status = blReadPDBLine(state, line, (int)(eol - line));
+      if(status == READPDB_LINE_ERROR)
+         return(FALSE);
+      else if(status == READPDB_LINE_DONE)
+         break;
+
+      line = eol;
+   }
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static BOOL blIsPlainPDBBuffer(char *buffer, long length)
+   ---------------------------------------------------------
+*//**
+
+   \param[in]     *buffer    In-memory image of a file
+   \param[in]     length     Length of the buffer
+   \return                   TRUE if this looks like a plain text PDB 
+                             file rather than a compressed or PDBML one
+
+   Applies the same tests as blDoReadPDB() and blCheckFileFormatPDBML()
+   to a file held in memory.
+
+-  16.10.26 Original
+*/
+static BOOL blIsPlainPDBBuffer(char *buffer, long length)
+{
+   long i,
+        sample;
+   
+   if(length == 0)
+      return(TRUE);
+
+   /* Compressed file                                                   */
+   if(buffer[0] == (char)0x1F)
+      return(FALSE);
+
+   /* PDBML file                                                        */
+   if(buffer[0] == '<')
+      return(FALSE);
+   sample = MIN(length, XML_SAMPLE - 1);
+   for(i=0; i<sample-6; i++)
+   {
+      if((buffer[i] == '\n') && !strncmp(buffer+i+1, "<?xml ", 6))
+         return(FALSE);
+   }
+   
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static void blUnmapPDBBuffer(char *buffer, long length)
+   -------------------------------------------------------
+*//**
+
+   \param[in]     *buffer    Buffer from blDoReadPDBMapped()
+   \param[in]     length     Length of the buffer
+
+   Releases the file image created by blDoReadPDBMapped()
+
+-  16.10.26 Original
+*/
+static void blUnmapPDBBuffer(char *buffer, long length)
+{
+   if(buffer == NULL)
+      return;
+#ifdef NOMMAP
+   free(buffer);
+#else
+   munmap(buffer, (size_t)length);
+#endif
+}
+
+/************************************************************************/
+/*>static BOOL blDecodePDBRecord(READPDBSTATE *state, char *buffer, 
+                                 int length)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in,out] *state     Reader state in which fields are stored
+   \param[in]     *buffer    Line from a PDB file (need not be 
+                             terminated)
+   \param[in]     length     Length of line
+   \return                   FALSE if the line is blank
+
+   Fixed-column decoder for ATOM/HETATM records. This replaces
+
+\code
+   fsscanf(buffer,
+      "%6s%5d%1x%5s%4s%1s%4d%1s%3x%8lf%8lf%8lf%6lf%6lf%10x%2s%2s",...)
+\endcode
 
-      /* We now reopen the temporary file as our PDB input file         */
-      sprintf(cmd,"/tmp/readpdb_%d",(int)getpid());
-      if((fp = fopen(cmd,"r"))==NULL)
-      {
-         *natom = (-1);
-         return(NULL);
-      }
-   }
-#endif   
+   and follows exactly the same rules: a field stops at the end of the
+   line, string fields are padded with spaces to their full width, 
+   blank numeric fields are set to zero and numeric fields which cannot
+   be read at all are left unchanged.
 
+-  16.10.26 Original
+*/
+static BOOL blDecodePDBRecord(READPDBSTATE *state, char *buffer, 
+                              int length)
+{
+   char field[16];
+   int  i;
 
-   /* Check file format */
-   if(blCheckFileFormatPDBML(fp))
+   /* Like fsscanf(), a field stops at the end of the line              */
+   for(i=0; i<length; i++)
    {
-#ifdef XML_SUPPORT
+      if((buffer[i] == '\n') || (buffer[i] == '\0'))
+         break;
+   }
+   length = i;
+
+   blGetColumns(buffer, length,  0, 6, state->record_type);
+   blGetColumns(buffer, length,  6, 5, field);
+   blDecodeInt(field, &(state->atnum));
+   blGetColumns(buffer, length, 12, 5, state->atnambuff);
+   blGetColumns(buffer, length, 17, 4, state->resnam);
+   blGetColumns(buffer, length, 21, 1, state->chain);
+   blGetColumns(buffer, length, 22, 4, field);
+   blDecodeInt(field, &(state->resnum));
+   blGetColumns(buffer, length, 26, 1, state->insert);
+   blGetColumns(buffer, length, 30, 8, field);
+   blDecodeReal(field, &(state->x));
+   blGetColumns(buffer, length, 38, 8, field);
+   blDecodeReal(field, &(state->y));
+   blGetColumns(buffer, length, 46, 8, field);
+   blDecodeReal(field, &(state->z));
+   blGetColumns(buffer, length, 54, 6, field);
+   blDecodeReal(field, &(state->occ));
+   blGetColumns(buffer, length, 60, 6, field);
+   blDecodeReal(field, &(state->bval));
+   blGetColumns(buffer, length, 76, 2, state->element_buff);
+   blGetColumns(buffer, length, 78, 2, state->charge_buff);
+
+   /* As with fsscanf(), a blank line still resets the fields          */
+   return(length != 0);
+}
 
-      /* Parse PDBML-formatted PDB file */
-      pdb = blDoReadPDBML(fp,natom,AllAtoms,OccRank,ModelNum);
-      xmlCleanupParser();     /* free globals set by parser */
-      if(cmd[0]) unlink(cmd); /* delete tmp file            */
-      return( pdb );          /* return PDB list            */
+/************************************************************************/
+/*>static void blGetColumns(char *buffer, int length, int start, 
+                            int width, char *out)
+   ---------------------------------------------------------------
+*//**
 
-#else
+   \param[in]     *buffer    Line from a PDB file
+   \param[in]     length     Length of the line
+   \param[in]     start      Offset of first column (from 0)
+   \param[in]     width      Number of columns
+   \param[out]    *out       Columns, padded with spaces to width and
+                             terminated
 
-      /* PDBML format not supported. */
-      if(cmd[0]) unlink(cmd); /* delete tmp file            */
-      *natom = (-1);          /* Indicate error             */
-      return( NULL );         /* return NULL list           */
+   Extracts a fixed-width field
 
-#endif
-   }
+-  16.10.26 Original
+*/
+static void blGetColumns(char *buffer, int length, int start, int width,
+                         char *out)
+{
+   int i;
+   
+   for(i=0; i<width && start+i<length; i++)
+      out[i] = buffer[start+i];
+   for(; i<width; i++)
+      out[i] = ' ';
+   out[width] = '\0';
+}
 
+/************************************************************************/
+/*>static void blDecodeInt(char *field, int *value)
+   ------------------------------------------------
+*//**
 
-   while(fgets(buffer,159,fp))
+   \param[in]     *field     Terminated numeric field
+   \param[in,out] *value     Value read. Set to 0 if the field is blank
+                             and left unchanged if no number is found
+
+   Reads an integer with the same result as sscanf(field,"%d",value) as
+   used by fsscanf().
+
+-  16.10.26 Original
+*/
+static void blDecodeInt(char *field, int *value)
+{
+   char *c = field;
+   int  v  = 0;
+   BOOL neg = FALSE;
+   
+   while(isspace((int)*c))
+      c++;
+   
+   if(*c == '\0')                          /* Blank                     */
    {
-      if(ModelNum != 0)          /* We are interested in model numbers  */
-      {
-         if(!strncmp(buffer,"ENDMDL",6))
-         {
-            ModelCount++;
-         }
+      *value = 0;
+      return;
+   }
+   
+   if((*c == '-') || (*c == '+'))
+   {
+      neg = (*c == '-');
+      c++;
+   }
+   if(!isdigit((int)*c))                   /* Not a number              */
+      return;
+   
+   while(isdigit((int)*c))
+   {
+      v = 10 * v + (*c - '0');
+      c++;
+   }
+   *value = neg ? -v : v;
+}
 
-         if(ModelCount < ModelNum)   /* Haven't reached the right model */
-            continue;
-         else if(ModelCount > ModelNum)    /* Gone past the right model */
-            break;
-      }
+/************************************************************************/
+/*>static void blDecodeReal(char *field, double *value)
+   ----------------------------------------------------
+*//**
 
-      if(!strncmp(buffer,"ENDMDL",6))
-         gPDBMultiNMR   = TRUE;
-      
-      if(fsscanf(buffer,"%6s%5d%1x%5s%4s%1s%4d%1s%3x%8lf%8lf%8lf%6lf%6lf%10x%2s%2s",
-                 record_type,&atnum,atnambuff,resnam,chain,&resnum,insert,
-                 &x,&y,&z,&occ,&bval,element_buff,charge_buff) != EOF)
-      {
-         if((!strncmp(record_type,"ATOM  ",6)) || 
-            (!strncmp(record_type,"HETATM",6) && AllAtoms))
-         {
-            /* Copy the raw atom name                                   */
-            /* 03.06.05 Note: this reads the alternate atom position as 
-               well as the atom name - changes in FixAtomName() now strip
-               that
-               We now copy only the first 4 characters into atnam_raw and
-               put the 5th character into altpos
-            */
-            strncpy(atnam_raw, atnambuff, 4);
-            atnam_raw[4] = '\0';
-            altpos = atnambuff[4];
+   \param[in]     *field     Terminated numeric field
+   \param[in,out] *value     Value read. Set to 0 if the field is blank
+                             and left unchanged if no number is found
 
-            /* Fix the atom name accounting for start in column 13 or 14*/
-            atnam = blFixAtomName(atnambuff, occ);
-            
-            /* Set element and charge */
-            blProcessElementField(element, element_buff);
-            blProcessChargeField(&charge, charge_buff);
-            
-            /* Set element from atom name if not in input file */
-            if(strlen(element) == 0)
-            {
-               blSetElementSymbolFromAtomName(element, atnam_raw);
-            }
+   Reads a floating point number with the same result as 
+   sscanf(field,"%lf",value) as used by fsscanf().
 
-            /* Check for full occupancy. If occupancy is 0.0 assume that 
-               it is actually fully occupied; the column just hasn't been
-               filled in correctly
-               
-               04.10.94 Read all atoms if OccRank is 0
-
-               14.10.05 Now takes an atom as full occupancy:
-                           if occ==1.0
-                           if occ==0.0 and altpos==' '
-                           if OccRank==0
-                        This fixes problems where a lower (partial)
-                        occupancy has erroneously been set to zero
-               21.12.11 Now only worries about partial occupancy if altpos
-                        is a space. The first line of the if() statement
-                        here would assume single occupancy if altpos was
-                        a space and occupancy was zero:
-                        if(((altpos == ' ') && (occ < (double)SMALL)) ||
-                        - it now assumes single occupancy if altpos is a
-                        space regardless of the actual occupancy. This
-                        deals with cases like 1ap2 ZN A112 and 1ces ZN
-                        A238 where these HETATMs are single occupancy
-                        but with occupancy < 1.0
-            */
-            if((altpos == ' ') ||
-               (occ > (double)0.999) || 
-               (OccRank == 0))
-            {
-               /* Trim the atom name to 4 characters                    */
-               atnam[4] = '\0';
-               
-               if(NPartial != 0)
-               {
-                  if(!blStoreOccRankAtom(OccRank,multi,NPartial,&pdb,&p,
-                                         natom))
-                  {
-                     if(pdb != NULL) FREELIST(pdb, PDB);
-                     *natom = (-1);
-                     if(cmd[0]) unlink(cmd);
-                     return(NULL);
-                  }
-                  
-                  /* Set partial occupancy counter to 0                 */
-                  NPartial = 0;
-               }
-               
-               /* Allocate space in the linked list                     */
-               if(pdb == NULL)
-               {
-                  INIT(pdb, PDB);
-                  p = pdb;
-               }
-               else
-               {
-                  ALLOCNEXT(p, PDB);
-               }
-               
-               /* Failed to allocate space; free up list so far & return*/
-               if(p==NULL)
-               {
-                  if(pdb != NULL) FREELIST(pdb, PDB);
-                  *natom = (-1);
-                  if(cmd[0]) unlink(cmd);
-                  return(NULL);
-               }
-               
-               /* Increment the number of atoms                         */
-               (*natom)++;
-               
-               /* Store the information read                            */
-               CLEAR_PDB(p);
-               p->atnum  = atnum;
-               p->resnum = resnum;
-               p->x      = (REAL)x;
-               p->y      = (REAL)y;
-               p->z      = (REAL)z;
-               p->occ    = (REAL)occ;
-               p->bval   = (REAL)bval;
-               p->altpos = altpos;    /* 03.06.05 Added this one        */
-               p->formal_charge  = charge;
-               p->partial_charge = (REAL)charge;
-               p->access = 0.0;
-               p->radius = 0.0;
-               p->atomType = NULL;
-               p->next   = NULL;
-               strcpy(p->record_type, record_type);
-               strcpy(p->atnam,       atnam);
-               strcpy(p->atnam_raw,   atnam_raw);
-               strcpy(p->resnam,      resnam);
-               strcpy(p->chain,       chain);
-               strcpy(p->insert,      insert);
-               strcpy(p->element,     element);
-            }
-            else   /* Partial occupancy                                 */
-            {
-               /* Set flag to say we've got a partial occupancy atom    */
-               gPDBPartialOcc = TRUE;
-               
-               /* First in a group, store atom name                     */
-               if(NPartial == 0)
-               {
-                  CurIns = insert[0];
-                  CurRes = resnum;
-                  strncpy(CurAtom,atnam,8);
-               }
-               
-               if(strncmp(CurAtom,atnam,strlen(CurAtom)-1) || 
-                  resnum != CurRes || 
-                  CurIns != insert[0])
-               {
-                  /* Atom name has changed 
-                     Select and store the OccRank highest occupancy atom
-                     */
-                  if(!blStoreOccRankAtom(OccRank,multi,NPartial,&pdb,&p,
-                                         natom))
-                  {
-                     if(pdb != NULL) FREELIST(pdb, PDB);
-                     *natom = (-1);
-                     if(cmd[0]) unlink(cmd);
-                     return(NULL);
-                  }
-                  
-                  /* Reset the partial atom counter                     */
-                  NPartial = 0;
-                  strncpy(CurAtom,atnam,8);
-                  CurRes = resnum;
-                  CurIns = insert[0];
-               }
-               
-               if(NPartial < MAXPARTIAL)
-               {
-                  /* Store the partial atom data                        */
-                  CLEAR_PDB((multi + NPartial));
-                  multi[NPartial].atnum  = atnum;
-                  multi[NPartial].resnum = resnum;
-                  multi[NPartial].x      = (REAL)x;
-                  multi[NPartial].y      = (REAL)y;
-                  multi[NPartial].z      = (REAL)z;
-                  multi[NPartial].occ    = (REAL)occ;
-                  multi[NPartial].bval   = (REAL)bval;
-                  multi[NPartial].formal_charge = charge;
-                  multi[NPartial].partial_charge = (REAL)charge;
-                  multi[NPartial].access = 0.0;
-                  multi[NPartial].radius = 0.0;
-                  multi[NPartial].atomType = NULL;
-                  multi[NPartial].next   = NULL;
-                  strcpy(multi[NPartial].record_type, record_type);
-                  strcpy(multi[NPartial].atnam,       atnam);
-                  /* 27.04.05 - added this line                         */
-                  strcpy(multi[NPartial].atnam_raw,   atnam_raw);
-                  strcpy(multi[NPartial].resnam,      resnam);
-                  strcpy(multi[NPartial].chain,       chain);
-                  strcpy(multi[NPartial].insert,      insert);
-                  strcpy(multi[NPartial].element,     element);
-                  /* 03.06.05 - added this line                         */
-                  multi[NPartial].altpos = altpos;
-
-                  NPartial++;
-               }
-            }
-         }
-      }
-   }
+   Plain decimals, which is all that normally appears in a PDB file, are
+   built as an integer mantissa divided by a power of ten. Since both 
+   are exactly representable the single division gives the correctly
+   rounded result, just as strtod() does. Anything else (exponents, 
+   very long mantissas, nan, etc.) is passed to sscanf().
 
-   if(NPartial != 0)
+-  16.10.26 Original
+*/
+static void blDecodeReal(char *field, double *value)
+{
+   static double pow10[] = {1.0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5,
+                            1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10, 1.0e11,
+                            1.0e12, 1.0e13, 1.0e14, 1.0e15};
+   char   *c = field;
+   double mantissa = 0.0;
+   int    ndigits  = 0,
+          nfrac    = 0;
+   BOOL   neg      = FALSE;
+   
+   while(isspace((int)*c))
+      c++;
+   
+   if(*c == '\0')                          /* Blank                     */
+   {
+      *value = (double)0.0;
+      return;
+   }
+   
+   if((*c == '-') || (*c == '+'))
+   {
+      neg = (*c == '-');
+      c++;
+   }
+   while(isdigit((int)*c))
+   {
+      mantissa = 10.0 * mantissa + (double)(*c - '0');
+      ndigits++;
+      c++;
+   }
+   if(*c == '.')
    {
-      if(!blStoreOccRankAtom(OccRank,multi,NPartial,&pdb,&p,natom))
+      c++;
+      while(isdigit((int)*c))
       {
-         if(pdb != NULL) FREELIST(pdb, PDB);
-         *natom = (-1);
-         if(cmd[0]) unlink(cmd);
-         return(NULL);
+         mantissa = 10.0 * mantissa + (double)(*c - '0');
+         ndigits++;
+         nfrac++;
+         c++;
       }
    }
 
-   if(cmd[0]) unlink(cmd);
+   /* Anything out of the ordinary goes to sscanf()                     */
+   if((ndigits == 0) || (ndigits > 15) || isalnum((int)*c))
+   {
+      if(sscanf(field, "%lf", value) == (-1))
+         *value = (double)0.0;
+      return;
+   }
 
-   /* Return pointer to start of linked list                            */
-   return(pdb);
+   mantissa /= pow10[nfrac];
+   *value = neg ? -mantissa : mantissa;
 }
 
 /************************************************************************/
@@ -965,12 +2114,12 @@ static BOOL blStoreOccRankAtom(int OccRank, PDB multi[MAXPARTIAL],
    */
    if(*ppdb == NULL)
    {
-      INIT((*ppdb), PDB);
+      INITPDB((*ppdb));
       *pp = *ppdb;
    }
    else
    {
-      ALLOCNEXT(*pp, PDB);
+      ALLOCNEXTPDB(*pp);
    }
             
    /* Failed to allocate space; error return.                           */
@@ -1010,6 +2159,7 @@ static BOOL blStoreOccRankAtom(int OccRank, PDB multi[MAXPARTIAL],
       ((*pp)->atnam)[4] = '\0';
    else
       ((*pp)->atnam)[3] = ' ';
+   blSetPDBCodes(*pp);
 
    return(TRUE);
 }
@@ -1302,7 +2452,7 @@ pointer\n");
                      FINDPREV(a_prev, pdb, alts[i]);
                      if(a_prev != NULL)
                         a_prev->next = alts[i]->next;
-                     free(alts[i]);
+                     blFreePDBNode(alts[i]);
                      
                   }  /* Not the highest, so we delete it                */
                }  /* Stepping through the alternates                    */
@@ -1355,6 +2505,9 @@ pointer\n");
 -  18.08.14 Added XML_SUPPORT option. Return error if XML_SUPPORT not 
             defined By: CTP
 -  26.08.14 Pad record_type to six characters. By: CTP
+-  16.10.26 Split into blReadPDBMLDocument(), blFindPDBMLAtomSites() and
+            blReadPDBMLModel() so the model reader can use the document
+            for each model in turn
 
 */
 PDB *blDoReadPDBML(FILE *fpin,
@@ -1372,27 +2525,9 @@ PDB *blDoReadPDBML(FILE *fpin,
 #else
 
    /* Parse PDBML-formatted file.                                       */
-   xmlParserCtxtPtr ctxt;
    xmlDoc  *document;
-   xmlNode *root_node  = NULL, 
-           *sites_node = NULL, 
-           *atom_node  = NULL, 
-           *n          = NULL;
-   int     size_t;
-   char    xml_buffer[XML_BUFFER];
-   xmlChar *content;
-   double  content_lf;
-
-   PDB     *pdb      = NULL,
-           *curr_pdb = NULL,
-           *end_pdb  = NULL,
-           multi[MAXPARTIAL];
-
-   int     NPartial       =  0,
-           model_number   =  0;
-   char    store_atnam[8] = "",
-           pad_resnam[8]  = "";
-       
+   xmlNode *sites_node = NULL;
+   PDB     *pdb        = NULL;
 
    /* Zero natoms and reset flags */
    gPDBXML        = TRUE;  /* global PDBML-fornmat flag     */
@@ -1402,6 +2537,58 @@ PDB *blDoReadPDBML(FILE *fpin,
 
 
    /* Generate Document From Filehandle */
+   if((document = blReadPDBMLDocument(fpin)) == NULL)
+   {
+      /* Error: Failed to parse file */
+      *natom = -1;
+      return(NULL);
+   }
+   
+
+   /* Parse Document Tree */
+   if((sites_node = blFindPDBMLAtomSites(document)) == NULL)
+   {
+      /* Error: Failed to find atom sites */
+      xmlFreeDoc(document);
+      *natom = -1;
+      return(NULL);
+   }
+
+
+   /* Populate PDB list. */
+   pdb = blReadPDBMLModel(sites_node->children, natom, AllAtoms, OccRank,
+                          ModelNum, NULL);
+
+   /* Free document */
+   xmlFreeDoc(document);
+
+   /* Return PDB linked list */
+   return(pdb);
+
+#endif
+}
+
+
+#ifdef XML_SUPPORT
+/************************************************************************/
+/*>static xmlDoc *blReadPDBMLDocument(FILE *fpin)
+   ----------------------------------------------
+*//**
+
+   \param[in]     *fpin    File pointer
+   \return                 Parsed document. NULL on error
+
+   Parses a PDBML file from a file pointer.
+
+-  16.10.26 Original - split from blDoReadPDBML()
+*/
+static xmlDoc *blReadPDBMLDocument(FILE *fpin)
+{
+   xmlParserCtxtPtr ctxt;
+   xmlDoc  *document;
+   int     size_t;
+   char    xml_buffer[XML_BUFFER];
+
    size_t = fread(xml_buffer, 1, XML_BUFFER, fpin);
    ctxt = xmlCreatePushParserCtxt(NULL, NULL, xml_buffer, size_t, "file");
    while ((size_t = fread(xml_buffer, 1, XML_BUFFER, fpin)) > 0) 
@@ -1411,16 +2598,27 @@ PDB *blDoReadPDBML(FILE *fpin,
    xmlParseChunk(ctxt, xml_buffer, 0, 1);
    document = ctxt->myDoc;
    xmlFreeParserCtxt(ctxt);
-   
-   if(document == NULL)
-   {
-      /* Error: Failed to parse file */
-      *natom = -1;
-      return(NULL);
-   }
-   
 
-   /* Parse Document Tree */
+   return(document);
+}
+
+
+/************************************************************************/
+/*>static xmlNode *blFindPDBMLAtomSites(xmlDoc *document)
+   ------------------------------------------------------
+*//**
+
+   \param[in]     *document   Parsed PDBML document
+   \return                    The atom_siteCategory node. NULL if not
+                              found
+
+-  16.10.26 Original - split from blDoReadPDBML()
+*/
+static xmlNode *blFindPDBMLAtomSites(xmlDoc *document)
+{
+   xmlNode *root_node, 
+           *n;
+
    root_node = xmlDocGetRootElement(document);   
    for(n = root_node->children; n; n = n->next)
    {
@@ -1428,34 +2626,68 @@ PDB *blDoReadPDBML(FILE *fpin,
       if(!strcmp("atom_siteCategory",(char *) n->name))
       {
          /* Found Atom Sites */
-         sites_node = n;
-         break;
+         return(n);
       }
    }
-   
-   if(sites_node == NULL)
-   {
-      /* Error: Failed to find atom sites */
-      xmlFreeDoc(document);
-      *natom = -1;
-      return(NULL);
-   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static PDB *blReadPDBMLModel(xmlNode *start, int *natom, 
+                                BOOL AllAtoms, int OccRank, int ModelNum,
+                                xmlNode **next)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *start   First atom_site node to examine
+   \param[out]    *natom   Number of atoms read. -1 if error.
+   \param[in]     AllAtoms TRUE:  ATOM & HETATM records
+                           FALSE: ATOM records only
+   \param[in]     OccRank  Occupancy ranking
+   \param[in]     ModelNum NMR Model number
+   \param[out]    **next   The first atom_site node of a later model,
+                           or unchanged if there isn't one. May be NULL
+   \return                 A pointer to the first allocated item of
+                           the PDB linked list
+
+   Builds the PDB linked list for one model from the atom_site nodes of
+   a PDBML document. Stops at the first atom from a later model.
+
+-  16.10.26 Original - split from blDoReadPDBML()
+*/
+static PDB *blReadPDBMLModel(xmlNode *start, int *natom, BOOL AllAtoms,
+                             int OccRank, int ModelNum, xmlNode **next)
+{
+   xmlNode *atom_node  = NULL, 
+           *n          = NULL;
+   xmlChar *content;
+   double  content_lf;
+
+   PDB     *pdb      = NULL,
+           *curr_pdb = NULL,
+           *end_pdb  = NULL,
+           multi[MAXPARTIAL];
+
+   int     NPartial       =  0,
+           model_number   =  0;
+   char    store_atnam[8] = "",
+           pad_resnam[8]  = "";
 
+   *natom = 0;
 
    /* Scan through atom nodes and populate PDB list. */
-   for(atom_node = sites_node->children; atom_node; 
-       atom_node = atom_node->next)
+   for(atom_node = start; atom_node; atom_node = atom_node->next)
    {
       if(!strcmp("atom_site",(char *) atom_node->name))
       {
          /* Current PDB */
-         INIT(curr_pdb,PDB);
+         INITPDB(curr_pdb);
          
          if(curr_pdb == NULL)
          {
             /* Error: Failed to store atom in pdb list */
-            xmlFreeDoc(document);
-            if(pdb != NULL) FREELIST(pdb,PDB);
+            if(pdb != NULL) FREEPDBLIST(pdb);
             *natom = -1;
             return(NULL);
          }
@@ -1631,6 +2863,8 @@ PDB *blDoReadPDBML(FILE *fpin,
             strcpy(curr_pdb->chain, " ");
          }
 
+         blSetPDBCodes(curr_pdb);
+
          /* Set multi-model flag */
          if(model_number > 1)
          {
@@ -1641,12 +2875,16 @@ PDB *blDoReadPDBML(FILE *fpin,
          if(model_number != ModelNum)
          {
             /* Free curr_pdb */
-            FREELIST(curr_pdb,PDB);
+            FREEPDBLIST(curr_pdb);
             curr_pdb = NULL;
             
             if(model_number > ModelNum)
             {
-               break; /* skip rest of tree */
+               /* skip rest of tree, remembering where the next model
+                  starts
+               */
+               if(next != NULL) *next = atom_node;
+               break;
             }
             else
             {
@@ -1659,7 +2897,7 @@ PDB *blDoReadPDBML(FILE *fpin,
          if(!AllAtoms && strncmp(curr_pdb->record_type, "ATOM  ", 6))
          {
             /* Free curr_pdb and skip atom */
-            FREELIST(curr_pdb,PDB);
+            FREEPDBLIST(curr_pdb);
             curr_pdb = NULL;
             continue; /* filter */
          }
@@ -1678,9 +2916,8 @@ PDB *blDoReadPDBML(FILE *fpin,
             else
             {
                /* Error: Failed to store partial occ atom */
-               xmlFreeDoc(document);
-               if(curr_pdb != NULL) FREELIST(curr_pdb,PDB);
-               if(pdb      != NULL) FREELIST(pdb,     PDB);
+               if(curr_pdb != NULL) FREEPDBLIST(curr_pdb);
+               if(pdb      != NULL) FREEPDBLIST(pdb);
                *natom = -1;
                return(NULL);
             }
@@ -1707,7 +2944,7 @@ PDB *blDoReadPDBML(FILE *fpin,
             NPartial++;
 
             /* Free curr_pdb and continue */
-            FREELIST(curr_pdb,PDB);
+            FREEPDBLIST(curr_pdb);
             curr_pdb = NULL;
             continue;
          }
@@ -1730,9 +2967,6 @@ PDB *blDoReadPDBML(FILE *fpin,
          }
       }
    }
-      
-   /* Free document */
-   xmlFreeDoc(document);
 
    /* Store final atom (if partial occupancy) */   
    if(NPartial != 0)
@@ -1740,7 +2974,7 @@ PDB *blDoReadPDBML(FILE *fpin,
       if(!blStoreOccRankAtom(OccRank,multi,NPartial,&pdb,&end_pdb,natom))
       {
          /* Error: Failed to store atom in pdb list */
-         if(pdb != NULL) FREELIST(pdb,PDB);
+         if(pdb != NULL) FREEPDBLIST(pdb);
          *natom = -1;
          return(NULL);
       }
@@ -1751,15 +2985,45 @@ PDB *blDoReadPDBML(FILE *fpin,
    if(pdb == NULL || *natom == 0)
    {
       /* Error: pdb list empty or no atoms stored */
-      if(pdb != NULL) FREELIST(pdb,PDB);
+      if(pdb != NULL) FREEPDBLIST(pdb);
       *natom = -1;
    }
     
    /* Return PDB linked list */
    return(pdb);
+}
 
-#endif
+
+/************************************************************************/
+/*>static int blPDBMLModelNumber(xmlNode *atom_node)
+   -------------------------------------------------
+*//**
+
+   \param[in]     *atom_node   An atom_site node
+   \return                     Its pdbx_PDB_model_num (0 if absent)
+
+-  16.10.26 Original
+*/
+static int blPDBMLModelNumber(xmlNode *atom_node)
+{
+   xmlNode *n;
+   xmlChar *content;
+   double  content_lf = 0.0;
+   
+   for(n = atom_node->children; n; n = n->next)
+   {
+      if((n->type == XML_ELEMENT_NODE) &&
+         !strcmp((char *) n->name,"pdbx_PDB_model_num"))
+      {
+         content = xmlNodeGetContent(n);
+         sscanf((char *) content,"%lf",&content_lf);
+         xmlFree(content);
+         break;
+      }
+   }
+   return((int)content_lf);
 }
+#endif
 
 
 /************************************************************************/
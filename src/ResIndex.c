@@ -0,0 +1,689 @@
+/************************************************************************/
+/**
+
+   \file       ResIndex.c
+
+   \version    V1.0
+   \date       16.10.26
+   \brief      Hash index of the residues in a PDB linked list
+
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   blFindResidue() and friends search the linked list from the start
+   for every residue looked up, so code looking up many residues takes
+   time proportional to the number of atoms times the number of
+   lookups. A PDBRESINDEX is built once in a single pass over the list
+   and then finds a residue from its chain, number and insert code via
+   a hash table.
+
+   The residues are numbered from 0 in the order they appear in the
+   linked list. A residue is a run of atoms with the same chain label,
+   residue number and insert code (as for blFindNextResidue()). For
+   residue r, index->start[r] is its first atom and index->stop[r] the
+   atom after it (NULL for the last residue).
+
+   The ...Indexed() routines give exactly the same results as the
+   routines that search the linked list. The linked list must not be
+   changed while the index is in use. The index is not changed by
+   lookups so may be shared between threads.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   PDBRESINDEX *index;
+   PDB         *p;
+   int         r;
+
+   index = blBuildPDBResIndex(pdb);
+   p = blFindResidueSpecIndexed(index, "L24A");
+   if((r = blFindPDBResIndex(index, "H", 100, "C")) >= 0)
+   {
+      for(p=index->start[r]; p!=index->stop[r]; NEXT(p))
+         ...
+   }
+   blFreePDBResIndex(index);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    Handling PDB Data
+   #SUBGROUP Searching the PDB linked list
+
+   #FUNCTION  blBuildPDBResIndex()
+   Builds a hash index of the residues in a PDB linked list
+
+   #FUNCTION  blFreePDBResIndex()
+   Frees a residue index
+
+   #FUNCTION  blFindPDBResIndex()
+   Finds the number of a residue in a residue index
+
+   #FUNCTION  blFindResidueIndexed()
+   As blFindResidue() using a residue index
+
+   #FUNCTION  blFindResidueSpecIndexed()
+   As blFindResidueSpec() using a residue index
+
+   #FUNCTION  blFindHetatmResidueIndexed()
+   As blFindHetatmResidue() using a residue index
+
+   #FUNCTION  blFindHetatmResidueSpecIndexed()
+   As blFindHetatmResidueSpec() using a residue index
+
+   #FUNCTION  blFindZonePDBIndexed()
+   As blFindZonePDB() using a residue index
+
+   #FUNCTION  blExtractZonePDBAsCopyIndexed()
+   As blExtractZonePDBAsCopy() using a residue index. Only the zone is
+   copied
+*/
+/************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "SysDefs.h"
+#include "MathType.h"
+#include "macros.h"
+#include "pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define RES_ALLOCQUANT 256
+
+/* Do the chain, residue number and insert code of an atom differ from
+   those of another?
+*/
+#define DIFFRES(p, q)                                                   \
+   (((p)->resnum != (q)->resnum) ||                                     \
+    strcmp((p)->insert, (q)->insert) ||                                 \
+    !CHAINMATCH((p)->chain, (q)->chain))
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static unsigned long HashResidue(char *chain, int resnum, char insert);
+static BOOL ExtractZoneStartRes(PDB *p, char *chain1, int resnum1,
+                                char *insert1);
+static BOOL ExtractZoneEndRes(PDB *p, char *chain1, char *chain2,
+                              int resnum2, char *insert2);
+
+
+/************************************************************************/
+/*>PDBRESINDEX *blBuildPDBResIndex(PDB *pdb)
+   -----------------------------------------
+*//**
+
+   \param[in]     *pdb     PDB linked list
+   \return                 Residue index (NULL if out of memory or there
+                           are no atoms)
+
+   Builds a hash index of the residues in a PDB linked list in a single
+   pass over the list
+
+-  16.10.26 Original
+*/
+PDBRESINDEX *blBuildPDBResIndex(PDB *pdb)
+{
+   PDBRESINDEX   *index;
+   PDB           *p,
+                 *prev = NULL,
+                 **tmp;
+   int           nalloc = 0,
+                 r;
+   unsigned long h;
+
+   if(pdb==NULL)
+      return(NULL);
+
+   if((index = (PDBRESINDEX *)malloc(sizeof(PDBRESINDEX)))==NULL)
+      return(NULL);
+   index->pdb      = pdb;
+   index->start    = NULL;
+   index->stop     = NULL;
+   index->bucket   = NULL;
+   index->next     = NULL;
+   index->nres     = 0;
+   index->nbuckets = 0;
+
+   /* Find the first atom of each residue                               */
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if((prev == NULL) || DIFFRES(p, prev))
+      {
+         if(index->nres == nalloc)
+         {
+            nalloc += RES_ALLOCQUANT;
+            if((tmp = (PDB **)realloc(index->start,
+                                      nalloc * sizeof(PDB *)))==NULL)
+            {
+               blFreePDBResIndex(index);
+               return(NULL);
+            }
+            index->start = tmp;
+         }
+         index->start[index->nres++] = p;
+      }
+      prev = p;
+   }
+
+   /* The end of each residue is the start of the next                  */
+   index->nbuckets = 2 * index->nres + 1;
+   if(((index->stop   = (PDB **)malloc(index->nres * sizeof(PDB *)))
+       ==NULL) ||
+      ((index->next   = (int *)malloc(index->nres * sizeof(int)))
+       ==NULL) ||
+      ((index->bucket = (int *)malloc(index->nbuckets * sizeof(int)))
+       ==NULL))
+   {
+      blFreePDBResIndex(index);
+      return(NULL);
+   }
+   for(r=0; r<index->nres; r++)
+   {
+      index->stop[r] = (r < index->nres-1) ? index->start[r+1] : NULL;
+   }
+
+   /* Hash the residues. Adding them at the head of each bucket in
+      reverse order leaves each bucket in linked list order so that
+      lookups find the first matching residue as a search would
+   */
+   for(h=0; h<(unsigned long)index->nbuckets; h++)
+      index->bucket[h] = -1;
+   for(r=index->nres-1; r>=0; r--)
+   {
+      p = index->start[r];
+      h = HashResidue(p->chain, p->resnum, p->insert[0]) %
+          (unsigned long)index->nbuckets;
+      index->next[r]   = index->bucket[h];
+      index->bucket[h] = r;
+   }
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>void blFreePDBResIndex(PDBRESINDEX *index)
+   ------------------------------------------
+*//**
+
+   \param[in]     *index   Residue index
+
+   Frees a residue index. The PDB linked list is not freed.
+
+-  16.10.26 Original
+*/
+void blFreePDBResIndex(PDBRESINDEX *index)
+{
+   if(index != NULL)
+   {
+      if(index->start  != NULL) free(index->start);
+      if(index->stop   != NULL) free(index->stop);
+      if(index->next   != NULL) free(index->next);
+      if(index->bucket != NULL) free(index->bucket);
+      free(index);
+   }
+}
+
+
+/************************************************************************/
+/*>int blFindPDBResIndex(PDBRESINDEX *index, char *chain, int resnum,
+                         char *insert)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *index   Residue index
+   \param[in]     *chain   Chain label
+   \param[in]     resnum   Residue number
+   \param[in]     *insert  Insert code
+   \return                 Number of the residue (from 0) in the index
+                           (-1 if not found)
+
+   Finds the first residue with the given chain, number and insert code.
+   Its atoms are from index->start[r] up to, but not including,
+   index->stop[r]
+
+-  16.10.26 Original
+*/
+int blFindPDBResIndex(PDBRESINDEX *index, char *chain, int resnum,
+                      char *insert)
+{
+   PDB *p;
+   int r;
+
+   if((index == NULL) || (index->nres == 0))
+      return(-1);
+
+   for(r=index->bucket[HashResidue(chain, resnum, insert[0]) %
+                       (unsigned long)index->nbuckets];
+       r >= 0;
+       r=index->next[r])
+   {
+      p = index->start[r];
+      if((p->resnum == resnum) &&
+         !strcmp(p->insert, insert) &&
+         CHAINMATCH(p->chain, chain))
+         return(r);
+   }
+   return(-1);
+}
+
+
+/************************************************************************/
+/*>PDB *blFindResidueIndexed(PDBRESINDEX *index, char *chain,
+                             int resnum, char *insert)
+   ---------------------------------------------------------
+*//**
+
+   \param[in]     *index   Residue index
+   \param[in]     *chain   Chain label
+   \param[in]     resnum   Residue number
+   \param[in]     *insert  Insert code
+   \return                 Pointer to start of specified residue
+
+   As blFindResidue() but uses a residue index
+
+-  16.10.26 Original
+*/
+PDB *blFindResidueIndexed(PDBRESINDEX *index, char *chain, int resnum,
+                          char *insert)
+{
+   int r;
+
+   if((r = blFindPDBResIndex(index, chain, resnum, insert)) < 0)
+      return(NULL);
+   return(index->start[r]);
+}
+
+
+/************************************************************************/
+/*>PDB *blFindResidueSpecIndexed(PDBRESINDEX *index, char *resspec)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     *index    Residue index
+   \param[in]     *resspec  Residue specification
+   \return                  Pointer to first atom of specified residue
+                            (NULL if not found).
+
+   As blFindResidueSpec() but uses a residue index
+
+-  16.10.26 Original
+*/
+PDB *blFindResidueSpecIndexed(PDBRESINDEX *index, char *resspec)
+{
+   char chain[8],
+        insert[8];
+   int  resnum;
+
+   if(blParseResSpec(resspec, chain, &resnum, insert))
+      return(blFindResidueIndexed(index, chain, resnum, insert));
+
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>PDB *blFindHetatmResidueIndexed(PDBRESINDEX *index, char *chain,
+                                   int resnum, char *insert)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *index   Residue index
+   \param[in]     *chain   Chain label
+   \param[in]     resnum   Residue number
+   \param[in]     *insert  Insert code
+   \return                 Pointer to start of HET residue
+
+   As blFindHetatmResidue() but uses a residue index. As there, only
+   the first character of the insert code is compared and the first
+   HETATM atom of the residue is returned.
+
+-  16.10.26 Original
+*/
+PDB *blFindHetatmResidueIndexed(PDBRESINDEX *index, char *chain,
+                                int resnum, char *insert)
+{
+   PDB *p;
+   int r;
+
+   if((index == NULL) || (index->nres == 0))
+      return(NULL);
+
+   for(r=index->bucket[HashResidue(chain, resnum, insert[0]) %
+                       (unsigned long)index->nbuckets];
+       r >= 0;
+       r=index->next[r])
+   {
+      p = index->start[r];
+      if((p->resnum == resnum) &&
+         !strncmp(p->insert, insert, 1) &&
+         CHAINMATCH(p->chain, chain))
+      {
+         for(; p!=index->stop[r]; NEXT(p))
+         {
+            if(!strncmp(p->record_type, "HETATM", 6))
+               return(p);
+         }
+      }
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>PDB *blFindHetatmResidueSpecIndexed(PDBRESINDEX *index,
+                                       char *resspec)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]     *index    Residue index
+   \param[in]     *resspec  Residue specification
+   \return                  Pointer to first atom of specified residue
+                            (NULL if not found).
+
+   As blFindHetatmResidueSpec() but uses a residue index
+
+-  16.10.26 Original
+*/
+PDB *blFindHetatmResidueSpecIndexed(PDBRESINDEX *index, char *resspec)
+{
+   char chain[8],
+        insert[8];
+   int  resnum;
+
+   if(blParseResSpec(resspec, chain, &resnum, insert))
+      return(blFindHetatmResidueIndexed(index, chain, resnum, insert));
+
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>BOOL blFindZonePDBIndexed(PDBRESINDEX *index, int start,
+                             char *startinsert, int stop,
+                             char *stopinsert, char *chain, int mode,
+                             PDB **pdb_start, PDB **pdb_stop)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     *index       Residue index
+   \param[in]     start        Resnum of start of zone
+   \param[in]     *startinsert Insert code for start of zone
+   \param[in]     stop         Resnum of end of zone
+   \param[in]     *stopinsert  Insert code for end of zone
+   \param[in]     *chain       Chain name
+   \param[in]     mode         ZONE_MODE_RESNUM or ZONE_MODE_SEQUENTIAL
+   \param[out]    **pdb_start  Start of zone
+   \param[out]    **pdb_stop   End of zone
+   \return                     OK?
+
+   As blFindZonePDB() but uses a residue index for zones given by
+   residue number within a chain. Sequential numbering, zones in any
+   chain (a blank chain) and zones running to the start or end of a
+   chain (-999) are passed to blFindZonePDB().
+
+-  16.10.26 Original
+*/
+BOOL blFindZonePDBIndexed(PDBRESINDEX *index,
+                          int         start,
+                          char        *startinsert,
+                          int         stop,
+                          char        *stopinsert,
+                          char        *chain,
+                          int         mode,
+                          PDB         **pdb_start,
+                          PDB         **pdb_stop)
+{
+   int rstart, rstop;
+
+   *pdb_start = NULL;
+   *pdb_stop  = NULL;
+   if(index == NULL)
+      return(FALSE);
+
+   if((mode != ZONE_MODE_RESNUM) || CHAINMATCH(chain, " ") ||
+      (start == (-999)) || (stop == (-999)))
+   {
+      return(blFindZonePDB(index->pdb, start, startinsert, stop,
+                           stopinsert, chain, mode,
+                           pdb_start, pdb_stop));
+   }
+
+   rstart = blFindPDBResIndex(index, chain, start, startinsert);
+   rstop  = blFindPDBResIndex(index, chain, stop,  stopinsert);
+
+   /* blFindZonePDB() stops searching at the atom after the stop
+      residue, so does not find a start residue that comes later
+   */
+   if(rstop >= 0)
+   {
+      *pdb_stop = index->stop[rstop];
+      if(rstart > rstop+1)
+         rstart = -1;
+   }
+   if(rstart < 0)
+      return(FALSE);
+
+   *pdb_start = index->start[rstart];
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>PDB *blExtractZonePDBAsCopyIndexed(PDBRESINDEX *index, char *chain1,
+                                      int resnum1, char *insert1,
+                                      char *chain2, int resnum2,
+                                      char *insert2)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *index   Residue index
+   \param[in]     *chain1  Start residue chain name
+   \param[in]     resnum1  Start residue number
+   \param[in]     *insert1 Start residue insert code
+   \param[in]     *chain2  End residue chain name
+   \param[in]     resnum2  End residue number
+   \param[in]     *insert2 End residue insert code
+   \return                 PDB linked list of the region of interest.
+
+   As blExtractZonePDBAsCopy() but steps through the residues in the
+   index rather than the atoms, and only the atoms in the zone are
+   copied rather than the whole linked list.
+
+-  16.10.26 Original
+*/
+PDB *blExtractZonePDBAsCopyIndexed(PDBRESINDEX *index,
+                                   char *chain1, int resnum1,
+                                   char *insert1,
+                                   char *chain2, int resnum2,
+                                   char *insert2)
+{
+   PDB *zone = NULL,
+       *p, *q = NULL;
+   int rstart, rend;
+
+   if(index == NULL)
+      return(NULL);
+
+   /* Find the first residue in the zone                                */
+   for(rstart=0; rstart<index->nres; rstart++)
+   {
+      if(ExtractZoneStartRes(index->start[rstart], chain1, resnum1,
+                             insert1))
+         break;
+   }
+   if(rstart == index->nres)
+      return(NULL);
+
+   /* Find the residue after the end of the zone                        */
+   for(rend=rstart; rend<index->nres; rend++)
+   {
+      if(ExtractZoneEndRes(index->start[rend], chain1, chain2, resnum2,
+                           insert2))
+         break;
+   }
+   if(rend == rstart)
+      return(NULL);
+
+   /* Copy the atoms in the zone                                        */
+   for(p=index->start[rstart]; p!=index->stop[rend-1]; NEXT(p))
+   {
+      if(zone==NULL)
+      {
+         INITPDB(zone);
+         q=zone;
+      }
+      else
+      {
+         ALLOCNEXTPDB(q);
+      }
+      if(q==NULL)
+      {
+         FREEPDBLIST(zone);
+         return(NULL);
+      }
+
+      blCopyPDB(q, p);
+   }
+
+   return(zone);
+}
+
+
+/************************************************************************/
+/*>static BOOL ExtractZoneStartRes(PDB *p, char *chain1, int resnum1,
+                                   char *insert1)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     *p       First atom of a residue
+   \param[in]     *chain1  Start residue chain name
+   \param[in]     resnum1  Start residue number
+   \param[in]     *insert1 Start residue insert code
+   \return                 Could the residue start the zone?
+
+   The test blExtractZonePDBAsCopy() uses for the start of the zone
+
+-  16.10.26 Original
+*/
+static BOOL ExtractZoneStartRes(PDB *p, char *chain1, int resnum1,
+                                char *insert1)
+{
+   return(CHAINMATCH(p->chain,chain1) &&
+          ((p->resnum > resnum1) ||
+           ((p->resnum == resnum1) &&
+            (p->insert[0] >= insert1[0]))));
+}
+
+
+/************************************************************************/
+/*>static BOOL ExtractZoneEndRes(PDB *p, char *chain1, char *chain2,
+                                 int resnum2, char *insert2)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]     *p       First atom of a residue
+   \param[in]     *chain1  Start residue chain name
+   \param[in]     *chain2  End residue chain name
+   \param[in]     resnum2  End residue number
+   \param[in]     *insert2 End residue insert code
+   \return                 Is the residue beyond the end of the zone?
+
+   The test blExtractZonePDBAsCopy() uses for the end of the zone
+
+-  16.10.26 Original
+*/
+static BOOL ExtractZoneEndRes(PDB *p, char *chain1, char *chain2,
+                              int resnum2, char *insert2)
+{
+   if(CHAINMATCH(p->chain,chain2) &&
+      ((p->resnum > resnum2) ||
+       ((p->resnum == resnum2) &&
+        (p->insert[0] > insert2[0]))))
+      return(TRUE);
+
+   if(CHAINMATCH(chain1,chain2) &&
+      !CHAINMATCH(p->chain,chain2))
+      return(TRUE);
+
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>static unsigned long HashResidue(char *chain, int resnum,
+                                    char insert)
+   ---------------------------------------------------------
+*//**
+
+   \param[in]     *chain   Chain label
+   \param[in]     resnum   Residue number
+   \param[in]     insert   First character of the insert code
+   \return                 Hash value
+
+   FNV-1a hash of the chain label, residue number and insert code. Only
+   the first character of the insert code is used so that
+   blFindHetatmResidueIndexed() can look in the same bucket.
+
+-  16.10.26 Original
+*/
+static unsigned long HashResidue(char *chain, int resnum, char insert)
+{
+   unsigned long h = 2166136261UL;
+   unsigned int  n = (unsigned int)resnum;
+   int           i;
+
+   for(i=0; i<8 && chain[i]; i++)
+      h = ((h ^ (unsigned char)chain[i]) * 16777619UL) & 0xffffffffUL;
+   for(i=0; i<4; i++)
+   {
+      h = ((h ^ (n & 0xff)) * 16777619UL) & 0xffffffffUL;
+      n >>= 8;
+   }
+   h = ((h ^ (unsigned char)insert) * 16777619UL) & 0xffffffffUL;
+
+   return(h);
+}
@@ -3,8 +3,8 @@
 
    \file       SelAtPDB.c
    
-   \version    V1.10
-   \date       19.08.14
+   \version    V1.12
+   \date       16.10.26
    \brief      Select a subset of atom types from a PDB linked list
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2014
@@ -90,6 +90,10 @@
 -  V1.8  04.02.09 SelectAtomsPDB(): Initialize q for fussy compliers
 -  V1.9  07.07.14 Use bl prefix for functions By: CTP
 -  V1.10 19.08.14 Renamed function to blSelectAtomsPDBAsCopy(). By: CTP
+-  V1.11 16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
+-  V1.12 16.10.26 blSelectAtomsPDBAsCopy() compares packed atom names.
+                  See AtomSelect.c for compiled selections
 
 *************************************************************************/
 /* Doxygen
@@ -125,6 +129,7 @@
 /************************************************************************/
 /* Prototypes
 */
+static unsigned long PackAtnam(char *atnam);
 
 /************************************************************************/
 /*>PDB *blSelectAtomsPDBAsCopy(PDB *pdbin, int nsel, char **sel,
@@ -168,40 +173,56 @@
 -  04.02.09 Initialize q for fussy compliers
 -  07.07.14 Use bl prefix for functions By: CTP
 -  19.08.14 Renamed function to blSelectAtomsPDBAsCopy(). By: CTP
+-  16.10.26 Compares packed atom names rather than using strncmp()
+            By: ACRM
 */
 PDB *blSelectAtomsPDBAsCopy(PDB *pdbin, int nsel, char **sel, int *natom)
 {
-   PDB   *pdbout  = NULL,
-         *p,
-         *q = NULL;
-   int   i;
+   PDB           *pdbout  = NULL,
+                 *p,
+                 *q = NULL;
+   unsigned long *keys,
+                 key;
+   int           i;
     
    *natom = 0;
+
+   /* Pack the selected names once so each test is a single integer
+      comparison rather than a strncmp()
+   */
+   if((keys = (unsigned long *)malloc((nsel ? nsel : 1) * 
+                                      sizeof(unsigned long)))==NULL)
+      return(NULL);
+   for(i=0; i<nsel; i++)
+      keys[i] = PackAtnam(sel[i]);
    
    /* Step through the input PDB linked list                            */
    for(p=pdbin; p!= NULL; NEXT(p))
    {
+      key = PackAtnam(p->atnam);
+      
       /* Step through the selection list                                */
       for(i=0; i<nsel; i++)
       {
          /* See if there is a match                                     */
-         if(!strncmp(p->atnam,sel[i],4))
+         if(key == keys[i])
          {
             /* Alloacte a new entry                                     */
             if(pdbout==NULL)
             {
-               INIT(pdbout, PDB);
+               INITPDB(pdbout);
                q = pdbout;
             }
             else
             {
-               ALLOCNEXT(q, PDB);
+               ALLOCNEXTPDB(q);
             }
             
             /* If failed, free anything allocated and return            */
             if(q==NULL)
             {
-               if(pdbout != NULL) FREELIST(pdbout,PDB);
+               if(pdbout != NULL) FREEPDBLIST(pdbout);
+               free(keys);
                *natom = 0;
                return(NULL);
             }
@@ -217,7 +238,34 @@ PDB *blSelectAtomsPDBAsCopy(PDB *pdbin, int nsel, char **sel, int *natom)
       }
    }
 
+   free(keys);
+
    /* Return pointer to start of output list                            */
    return(pdbout);
 }
 
+
+/************************************************************************/
+/*>static unsigned long PackAtnam(char *atnam)
+   -------------------------------------------
+*//**
+
+   \param[in]     *atnam     Atom name
+   \return                   Up to 4 characters of the name packed into
+                             an integer
+
+   Two names give the same value exactly when strncmp(a, b, 4) is 0 
+   since the bytes after the end of a shorter name are left as zero.
+
+-  16.10.26 Original   By: ACRM
+*/
+static unsigned long PackAtnam(char *atnam)
+{
+   unsigned long key = 0;
+   int           i;
+
+   for(i=0; i<4 && atnam[i]; i++)
+      key |= ((unsigned long)(unsigned char)atnam[i]) << (8*i);
+   return(key);
+}
+
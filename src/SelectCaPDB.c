@@ -3,8 +3,8 @@
 
    \file       SelectCaPDB.c
    
-   \version    V1.8
-   \date       07.07.14
+   \version    V1.9
+   \date       16.10.26
    \brief      
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1990-2014
@@ -58,6 +58,8 @@
 -  V1.6  26.07.95 Removed unused variables
 -  V1.7  16.10.96 Added SelectCaPDB()
 -  V1.8  07.07.14 Use bl prefix for functions By: CTP
+-  V1.9  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Doxygen
@@ -129,7 +131,7 @@ PDB *blSelectCaPDB(PDB *pdb)
    while((pdb!=NULL) && strncmp(pdb->atnam,"CA  ",4))
    {
       p=pdb->next;
-      free(pdb);
+      blFreePDBNode(pdb);
       pdb=p;
    }
 
@@ -139,7 +141,7 @@ PDB *blSelectCaPDB(PDB *pdb)
       if(strncmp(p->atnam,"CA  ",4))
       {
          prev->next = p->next;
-         free(p);
+         blFreePDBNode(p);
          p = prev;
       }
       prev = p;
@@ -3,7 +3,7 @@
 
    \file       SetResnam.c
    
-   \version    V1.3
+   \version    V1.4
    \date       07.07.14
    \brief      
    
@@ -50,6 +50,7 @@
 -  V1.1  01.03.94
 -  V1.2  27.02.98 Removed unreachable break from switch()
 -  V1.3  07.07.14 Use bl prefix for functions By: CTP
+-  V1.4  16.10.26 Sets the residue code
 
 *************************************************************************/
 /* Doxygen
@@ -97,6 +98,7 @@
 
 -  12.05.92 Original
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Sets the residue code   By: ACRM
 */
 void blSetResnam(PDB  *ResStart,
                  PDB  *NextRes,
@@ -106,10 +108,12 @@ void blSetResnam(PDB  *ResStart,
                  char *chain)
 {
    PDB *p;
+   int rescode = blGetResCode(resnam);
    
    for(p=ResStart; p && p!=NextRes; NEXT(p))
    {
       strcpy(p->resnam, resnam);
+      p->rescode = (short)rescode;
       strcpy(p->insert, insert);
       strcpy(p->chain,  chain);
       p->resnum = resnum;
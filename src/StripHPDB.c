@@ -3,8 +3,8 @@
 
    \file       StripHPDB.c
    
-   \version    V1.9
-   \date       19.08.14
+   \version    V1.10
+   \date       16.10.26
    \brief      
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin, University of Reading, 
@@ -61,6 +61,8 @@
 -  V1.8  07.07.14 Use bl prefix for functions By: CTP
 -  V1.9  19.08.14 Renamed blStripHPDBAsCopy() to blStripHPDBAsCopy() 
                   By: CTP
+-  V1.10 16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Doxygen
@@ -126,18 +128,18 @@ PDB *blStripHPDBAsCopy(PDB *pdbin, int *natom)
          /* Allocate a new entry                                        */
          if(pdbout==NULL)
          {
-            INIT(pdbout, PDB);
+            INITPDB(pdbout);
             q = pdbout;
          }
          else
          {
-            ALLOCNEXT(q, PDB);
+            ALLOCNEXTPDB(q);
          }
          
          /* If failed, free anything allocated and return               */
          if(q==NULL)
          {
-            if(pdbout != NULL) FREELIST(pdbout,PDB);
+            if(pdbout != NULL) FREEPDBLIST(pdbout);
             *natom = 0;
             return(NULL);
          }
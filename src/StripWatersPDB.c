@@ -3,8 +3,8 @@
 
    \file       StripWatersPDB.c
    
-   \version    V1.2
-   \date       19.08.14
+   \version    V1.3
+   \date       16.10.26
    \brief      
    
    \copyright  (c) Dr. Andrew C. R. Martin, UCL, 2008-2014
@@ -50,6 +50,8 @@
 -  V1.1  07.07.14 Use bl prefix for functions By: CTP
 -  V1.2  19.08.14 Renamed function blStripWatersPDB() to 
                   blStripWatersPDBAsCopy() By: CTP
+-  V1.3  16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Doxygen
@@ -113,18 +115,18 @@ PDB *blStripWatersPDBAsCopy(PDB *pdbin, int *natom)
          /* Allocate a new entry                                        */
          if(pdbout==NULL)
          {
-            INIT(pdbout, PDB);
+            INITPDB(pdbout);
             q = pdbout;
          }
          else
          {
-            ALLOCNEXT(q, PDB);
+            ALLOCNEXTPDB(q);
          }
          
          /* If failed, free anything allocated and return               */
          if(q==NULL)
          {
-            if(pdbout != NULL) FREELIST(pdbout,PDB);
+            if(pdbout != NULL) FREEPDBLIST(pdbout);
             *natom = 0;
             return(NULL);
          }
@@ -3,11 +3,11 @@
 
    \file       StructurePDB.c
    
-   \version    V1.3
-   \date       07.07.14
+   \version    V1.4
+   \date       16.10.26
    \brief      Build a structured PDB representation
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2009-14
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2009-26
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -50,6 +50,7 @@
 -  V1.1   19.05.10  PDBRESIDUE and PDBCHAIN are doubly linked lists
 -  V1.2   04.02.14  Use CHAINMATCH By: CTP
 -  V1.3   07.07.14  Use bl prefix for functions By: CTP
+-  V1.4   16.10.26  Added blAllocPDBStructureArray()
 
 *************************************************************************/
 /* Doxygen
@@ -60,6 +61,10 @@
    Takes a PDB linked list and converts it into a hierarchical structure
    of chains, residues and atoms
 
+   #FUNCTION  blAllocPDBStructureArray()
+   As blAllocPDBStructure(), but builds the chains, residues and atom
+   pointers as arrays in a single allocation for O(1) access
+
    #FUNCTION  blFreePDBStructure()
    Frees memory used by the hierarchical description of a PDB structure.
    Note this does not free the underlying PDB linked list
@@ -73,6 +78,7 @@
 /* Includes
 */
 #include <stdlib.h>
+#include <stdio.h>
 #include "pdb.h"
 #include "macros.h"
 
@@ -87,6 +93,7 @@
 /************************************************************************/
 /* Prototypes
 */
+static void SetResidueLabel(PDBRESIDUE *residue);
 
 
 /************************************************************************/
@@ -121,6 +128,12 @@ PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
    pdbstruct->pdb = pdb;
    pdbstruct->chains = NULL;
    pdbstruct->extras = NULL;             /* 02.06.10                    */
+   pdbstruct->chainArray   = NULL;
+   pdbstruct->residueArray = NULL;
+   pdbstruct->atoms        = NULL;
+   pdbstruct->nchains      = 0;
+   pdbstruct->nresidues    = 0;
+   pdbstruct->natoms       = 0;
    
    /* Build the chain list                                              */
    for(pdbc=pdb; pdbc!=NULL; pdbc=nextchain)
@@ -146,6 +159,8 @@ PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
       chain->stop     = nextchain;
       chain->residues = NULL;              /* 02.06.10                  */
       chain->extras   = NULL;              /* 02.06.10                  */
+      chain->startres = chain->nres      = 0;
+      chain->startatom = chain->stopatom = 0;
       strcpy(chain->chain, pdbc->chain);
    }
    
@@ -154,9 +169,6 @@ PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
    {
       for(pdbr = chain->start; pdbr != chain->stop; pdbr=nextres)
       {
-         char resid[24];
-         int  i, j;
-         
          nextres = blFindNextResidue(pdbr);
          
          if(chain->residues == NULL)
@@ -181,27 +193,216 @@ PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
          strcpy(residue->resnam, pdbr->resnam);
          residue->resnum = pdbr->resnum;
          residue->extras = NULL;            /* 02.06.10                 */
+         residue->startatom = residue->stopatom = 0;
+         SetResidueLabel(residue);
+      }
+   }
+   
+   return(pdbstruct);
+}
+
+
+/************************************************************************/
+/*>PDBSTRUCT *blAllocPDBStructureArray(PDB *pdb)
+   ---------------------------------------------
+*//**
+
+   \param[in]     *pdb    PDB linked list
+   \return                PDBSTRUCT structure containing chain and 
+                          residue arrays
+
+   As blAllocPDBStructure(), but the structure, chains, residues and an
+   array of atom pointers are placed in a single allocation. Chain k is 
+   then chainArray[k] (or PDBSTRUCT_CHAIN()), residue i of chain k is 
+   PDBSTRUCT_RESIDUE() and atom n is atoms[n], all without walking a 
+   list. Chains and residues also record the indexes of their first and
+   last atoms in atoms[] and each chain records the index of its first
+   residue in residueArray[] and the number of residues.
+
+   The next and prev pointers are also set so that code walking the 
+   chains and residues as linked lists works unchanged. As for 
+   blAllocPDBStructure(), the residue list of each chain ends with a
+   NULL next pointer.
+
+   Free with blFreePDBStructure() as normal. The structure becomes 
+   invalid if atoms are added to or removed from the PDB linked list.
+
+-  16.10.26  Original   By: ACRM
+*/
+PDBSTRUCT *blAllocPDBStructureArray(PDB *pdb)
+{
+   PDB        *p,
+              *chainStart = NULL,
+              *resStart   = NULL;
+   PDBSTRUCT  *pdbstruct  = NULL;
+   PDBCHAIN   *chain      = NULL;
+   PDBRESIDUE *residue    = NULL;
+   int        natoms      = 0,
+              nchains     = 0,
+              nres        = 0,
+              atnum;
+   size_t     size;
+   
+   /* Count the atoms, chains and residues. The chain and residue breaks
+      are the same as those found by blFindNextChain() and 
+      blFindNextResidue()
+   */
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if((chainStart == NULL) || !CHAINMATCH(p->chain, chainStart->chain))
+      {
+         chainStart = p;
+         nchains++;
+      }
+      if((resStart == NULL)                      || 
+         (p->resnum    != resStart->resnum)      ||
+         (p->insert[0] != resStart->insert[0])   ||
+         !CHAINMATCH(p->chain, resStart->chain))
+      {
+         resStart = p;
+         nres++;
+      }
+      natoms++;
+   }
+
+   /* Allocate everything in one go. The PDB pointers go last since they
+      may have weaker alignment requirements than the structures
+   */
+   size = sizeof(PDBSTRUCT) + 
+          (nchains * sizeof(PDBCHAIN)) +
+          (nres    * sizeof(PDBRESIDUE)) +
+          (natoms  * sizeof(PDB *));
+   if((pdbstruct = (PDBSTRUCT *)malloc(size))==NULL)
+      return(NULL);
+
+   pdbstruct->pdb          = pdb;
+   pdbstruct->chains       = NULL;
+   pdbstruct->extras       = NULL;
+   pdbstruct->nchains      = nchains;
+   pdbstruct->nresidues    = nres;
+   pdbstruct->natoms       = natoms;
+   pdbstruct->chainArray   = (PDBCHAIN *)(pdbstruct + 1);
+   pdbstruct->residueArray = (PDBRESIDUE *)(pdbstruct->chainArray + 
+                                            nchains);
+   pdbstruct->atoms        = (PDB **)(pdbstruct->residueArray + nres);
+
+   if(natoms == 0)
+   {
+      pdbstruct->chainArray   = NULL;
+      pdbstruct->residueArray = NULL;
+      pdbstruct->atoms        = NULL;
+      return(pdbstruct);
+   }
+   pdbstruct->chains = pdbstruct->chainArray;
+
+   /* Fill in the arrays                                                */
+   nchains = nres = 0;
+   for(p=pdb, atnum=0; p!=NULL; NEXT(p), atnum++)
+   {
+      pdbstruct->atoms[atnum] = p;
+
+      /* Start of a new chain                                           */
+      if((chain == NULL) || !CHAINMATCH(p->chain, chain->chain))
+      {
+         if(chain != NULL)
+         {
+            chain->stop     = p;
+            chain->stopatom = atnum;
+         }
+         
+         chain = &(pdbstruct->chainArray[nchains]);
+         chain->prev      = (nchains ? chain-1 : NULL);
+         chain->next      = NULL;
+         if(chain->prev != NULL)
+            chain->prev->next = chain;
+         chain->start     = p;
+         chain->stop      = NULL;
+         chain->residues  = &(pdbstruct->residueArray[nres]);
+         chain->extras    = NULL;
+         chain->startres  = nres;
+         chain->nres      = 0;
+         chain->startatom = atnum;
+         chain->stopatom  = pdbstruct->natoms;
+         strcpy(chain->chain, p->chain);
+         nchains++;
+
+         /* Force a new residue                                         */
+         residue = NULL;
+      }
 
-         /* Build a residue label                                       */
-         sprintf(resid, "%s.%d%s", 
-                 residue->chain, residue->resnum, residue->insert);
-         for(i=0, j=0; resid[i]; i++)
+      /* Start of a new residue                                         */
+      if((residue == NULL)                      ||
+         (p->resnum    != residue->resnum)      ||
+         (p->insert[0] != residue->insert[0]))
+      {
+         if(residue != NULL)
          {
-            /* Copy the character if it's not a space, but only copy a 
-               full stop if it's not going to be the first character
-            */
-            if(resid[i] != ' ' && (resid[i] != '.' || j>0))
-            {
-               residue->resid[j++] = resid[i];
-            }
+            residue->stop     = p;
+            residue->stopatom = atnum;
          }
-         residue->resid[j++] = '\0';
+         else if(nres)
+         {
+            /* Last residue of the previous chain                       */
+            pdbstruct->residueArray[nres-1].stop     = p;
+            pdbstruct->residueArray[nres-1].stopatom = atnum;
+         }
+         
+         residue = &(pdbstruct->residueArray[nres]);
+         residue->prev      = (chain->nres ? residue-1 : NULL);
+         residue->next      = NULL;
+         if(residue->prev != NULL)
+            residue->prev->next = residue;
+         residue->start     = p;
+         residue->stop      = NULL;
+         residue->extras    = NULL;
+         residue->resnum    = p->resnum;
+         residue->startatom = atnum;
+         residue->stopatom  = pdbstruct->natoms;
+         strcpy(residue->chain,  p->chain);
+         strcpy(residue->insert, p->insert);
+         strcpy(residue->resnam, p->resnam);
+         SetResidueLabel(residue);
+         chain->nres++;
+         nres++;
       }
    }
    
    return(pdbstruct);
 }
 
+
+/************************************************************************/
+/*>static void SetResidueLabel(PDBRESIDUE *residue)
+   ------------------------------------------------
+*//**
+
+   \param[in,out] *residue   Residue with chain, resnum and insert set
+
+   Builds the resid label (e.g. A.23B) for a residue. Spaces are removed
+   and the full stop is omitted if there is no chain label.
+
+-  16.10.26  Split out of blAllocPDBStructure()   By: ACRM
+*/
+static void SetResidueLabel(PDBRESIDUE *residue)
+{
+   char resid[24];
+   int  i, j;
+   
+   sprintf(resid, "%s.%d%s", 
+           residue->chain, residue->resnum, residue->insert);
+   for(i=0, j=0; resid[i]; i++)
+   {
+      /* Copy the character if it's not a space, but only copy a 
+         full stop if it's not going to be the first character
+      */
+      if(resid[i] != ' ' && (resid[i] != '.' || j>0))
+      {
+         residue->resid[j++] = resid[i];
+      }
+   }
+   residue->resid[j++] = '\0';
+}
+
 /************************************************************************/
 /*>void blFreePDBStructure(PDBSTRUCT *pdbstruct)
    ---------------------------------------------
@@ -213,8 +414,12 @@ PDBSTRUCT *blAllocPDBStructure(PDB *pdb)
    Frees memory used by the hierarchical description of a PDB structure.
    Note this does not free the underlying PDB linked list
 
+   Handles structures from both blAllocPDBStructure() and
+   blAllocPDBStructureArray()
+
 -  24.11.09  Original   By: ACRM
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Handles array-backed structures   By: ACRM
 */
 void blFreePDBStructure(PDBSTRUCT *pdbstruct)
 {
@@ -222,6 +427,13 @@ void blFreePDBStructure(PDBSTRUCT *pdbstruct)
 
    if(pdbstruct == NULL)
       return;
+
+   /* Array-backed structures are a single allocation                   */
+   if(pdbstruct->chainArray != NULL)
+   {
+      free(pdbstruct);
+      return;
+   }
    
    for(chain = pdbstruct->chains; chain!=NULL; NEXT(chain))
    {
@@ -0,0 +1,197 @@
+/************************************************************************/
+/**
+
+   \file       access_suite.c
+   
+   \version    V1.1
+   \date       16.10.26
+   \brief      Test suite for accessibility calculations.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blCalcAccess(), blCalcAccessThreads() and
+   blCalcAccessMethod(). The threaded calculation must give exactly the
+   same values as the serial one. The Shrake and Rupley totals must be
+   close to the Lee and Richards ones.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Added Shrake and Rupley test
+
+*************************************************************************/
+
+#include "access_suite.h"
+
+/* Globals */
+static char test_input_filename[] = "data/test-deca-ala-01.pdb",
+            radii_filename[]      = "../../data/radii.dat";
+static PDB    *pdb    = NULL;
+static RESRAD *resrad = NULL;
+static int    natoms;
+
+/* Setup And Teardown */
+static void access_setup(void)
+{
+   FILE *fp;
+   
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb != NULL, "Failed to read test file.");
+
+   fp = fopen(radii_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open radius file.");
+   resrad = blSetAtomRadii(pdb, fp);
+   fclose(fp);
+   ck_assert_msg(resrad != NULL, "Failed to read radius file.");
+}
+
+static void access_teardown(void)
+{
+   if(pdb    != NULL) FREELIST(pdb,    PDB);
+   if(resrad != NULL) FREELIST(resrad, RESRAD);
+}
+
+/* Core tests */
+START_TEST(test_access_01)
+{
+   PDB  *p;
+   REAL total = 0.0;
+   
+   ck_assert(blCalcAccess(pdb, natoms, 0.0, 1.4, TRUE));
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      ck_assert(p->access >= 0.0);
+      total += p->access;
+   }
+   ck_assert(total > 0.0);
+}
+END_TEST
+
+START_TEST(test_access_threads)
+{
+   PDB   *p, *copy;
+   REAL  *serial;
+   VEC3F shift = {6.0, 0.0, 0.0};
+   int   i, nthreads;
+
+   /* Add shifted copies of the structure so there are enough atoms for
+      several threads
+   */
+   for(i=0; i<4; i++)
+   {
+      copy = blDupePDB(pdb);
+      ck_assert(copy != NULL);
+      shift.y += 5.0;
+      blTranslatePDB(copy, shift);
+      for(p=pdb; p->next!=NULL; NEXT(p));
+      p->next = copy;
+   }
+   for(p=pdb, natoms=0; p!=NULL; NEXT(p))
+      natoms++;
+
+   serial = (REAL *)malloc(natoms * sizeof(REAL));
+   ck_assert(serial != NULL);
+   ck_assert(blCalcAccess(pdb, natoms, 0.0, 1.4, TRUE));
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+      serial[i] = p->access;
+
+   /* More threads than chunks of atoms, and one per processor          */
+   for(nthreads=0; nthreads<=4; nthreads+=4)
+   {
+      for(p=pdb; p!=NULL; NEXT(p))
+         p->access = -1.0;
+      ck_assert(blCalcAccessThreads(pdb, natoms, 0.0, 1.4, TRUE, 
+                                    nthreads));
+      for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+         ck_assert(p->access == serial[i]);
+   }
+   free(serial);
+}
+END_TEST
+
+START_TEST(test_access_sr)
+{
+   PDB  *p;
+   REAL lrTotal, srTotal;
+   BOOL doAccess = TRUE;
+   int  pass;
+   
+   /* Accessibility and then contact area                               */
+   for(pass=0; pass<2; pass++)
+   {
+      ck_assert(blCalcAccessMethod(pdb, natoms, ACCESS_METHOD_LR, 0.0, 
+                                   1.4, doAccess, 1));
+      for(p=pdb, lrTotal=0.0; p!=NULL; NEXT(p))
+         lrTotal += p->access;
+
+      ck_assert(blCalcAccessMethod(pdb, natoms, ACCESS_METHOD_SR, 0.0, 
+                                   1.4, doAccess, 1));
+      for(p=pdb, srTotal=0.0; p!=NULL; NEXT(p))
+      {
+         ck_assert(p->access >= 0.0);
+         srTotal += p->access;
+      }
+      
+      ck_assert(fabs(srTotal - lrTotal) < 0.02 * lrTotal);
+      doAccess = FALSE;
+   }
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *access_suite(void)
+{
+   Suite *s = suite_create("Access");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             access_setup, 
+                             access_teardown);
+   tcase_add_test(tc_core, test_access_01);
+   tcase_add_test(tc_core, test_access_threads);
+   tcase_add_test(tc_core, test_access_sr);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
@@ -0,0 +1,477 @@
+/************************************************************************/
+/**
+
+   \file       align_suite.c
+   
+   \version    V1.4
+   \date       16.10.26
+   \brief      Test suite for sequence alignment.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blAffinealignLinear(). The alignments and scores must
+   be identical to those from blAffinealign() and blAffinealignuc() and
+   long sequences must be aligned automatically without the full 
+   matrices. Query profile scores and alignments must also match, as 
+   must alignments using alignment contexts. Banded alignments of 
+   sequences differing by deletions, extensions and insertions must 
+   match too.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Added query profile tests
+-  V1.2  16.10.26 Added alignment context test
+-  V1.3  16.10.26 Added banded alignment test
+-  V1.4  16.10.26 Added banded test with an N-terminal extension and 
+                  insertions
+
+*************************************************************************/
+
+#include "align_suite.h"
+
+/* Defines */
+#define MAXSEQ  80
+#define MAXOFFSEQ 300
+#define LONGSEQ 2500
+
+/* Globals */
+static char mdm_filename[]  = "../../data/pet91.mat";
+static char mdm_filename2[] = "../../data/BLOSUM62";
+static unsigned long seed;
+
+/* Setup And Teardown */
+static void align_setup(void)
+{
+   ck_assert_msg(blReadMDM(mdm_filename), "Failed to read MDM.");
+   seed = 12345;
+}
+
+static void align_teardown(void)
+{
+}
+
+/* Portable random residues                                             */
+static char RandomResidue(int nres)
+{
+   static char residues[] = "ACDEFGHIKLMNPQRSTVWY";
+   
+   seed = (seed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+   return(residues[(seed >> 16) % nres]);
+}
+
+static void RandomPair(char *seq1, int length1, char *seq2, int length2,
+                       int nres)
+{
+   int i;
+   
+   for(i=0; i<length1; i++)
+      seq1[i] = RandomResidue(nres);
+   /* Make the second sequence related to the first                     */
+   for(i=0; i<length2; i++)
+      seq2[i] = (i<length1 && RandomResidue(4)!='A') ? 
+                seq1[i] : RandomResidue(nres);
+}
+
+/* Core tests */
+START_TEST(test_linear_matches)
+{
+   char seq1[MAXSEQ], seq2[MAXSEQ],
+        align1[2*MAXSEQ], align2[2*MAXSEQ],
+        lin1[2*MAXSEQ],   lin2[2*MAXSEQ];
+   int  trial, length1, length2, penalty, penext, 
+        score, linscore, alen, linlen;
+   BOOL identity, upcase;
+
+   for(trial=0; trial<500; trial++)
+   {
+      length1  = 1 + (RandomResidue(20) - 'A') * 3;
+      length2  = 1 + (RandomResidue(20) - 'A') * 3;
+      length1  = MIN(length1, MAXSEQ);
+      length2  = MIN(length2, MAXSEQ);
+      penalty  = trial % 12;
+      penext   = trial % 3;
+      identity = ((trial % 5) == 0);
+      upcase   = ((trial % 7) == 0);
+      RandomPair(seq1, length1, seq2, length2, (trial%3) ? 20 : 3);
+      if(upcase)
+         seq1[0] = tolower(seq1[0]);
+
+      if(upcase)
+         score = blAffinealignuc(seq1, length1, seq2, length2, FALSE,
+                                 identity, penalty, penext, 
+                                 align1, align2, &alen);
+      else
+         score = blAffinealign(seq1, length1, seq2, length2, FALSE,
+                               identity, penalty, penext, 
+                               align1, align2, &alen);
+      linscore = blAffinealignLinear(seq1, length1, seq2, length2,
+                                     identity, upcase, penalty, penext,
+                                     lin1, lin2, &linlen);
+
+      ck_assert_int_eq(score, linscore);
+      ck_assert_int_eq(alen, linlen);
+      ck_assert(!strncmp(align1, lin1, alen));
+      ck_assert(!strncmp(align2, lin2, alen));
+   }
+}
+END_TEST
+
+START_TEST(test_linear_long)
+{
+   char *seq1, *seq2, *align1, *align2;
+   int  length1 = LONGSEQ,
+        length2 = LONGSEQ - 10,
+        alen, score, i, n1, n2;
+
+   seq1   = (char *)malloc(length1 * sizeof(char));
+   seq2   = (char *)malloc(length2 * sizeof(char));
+   align1 = (char *)malloc((length1 + length2) * sizeof(char));
+   align2 = (char *)malloc((length1 + length2) * sizeof(char));
+   ck_assert(seq1 != NULL && seq2 != NULL && 
+             align1 != NULL && align2 != NULL);
+
+   /* seq2 is seq1 with 10 residues deleted from the middle             */
+   RandomPair(seq1, length1, seq2, length2, 20);
+   for(i=0; i<length2; i++)
+      seq2[i] = seq1[(i < LONGSEQ/2) ? i : i+10];
+
+   score = blAffinealign(seq1, length1, seq2, length2, FALSE, TRUE, 
+                         10, 1, align1, align2, &alen);
+
+   /* One gap of 10                                                     */
+   ck_assert_int_eq(alen, length1);
+   ck_assert_int_eq(score, length2 - (10 + 9));
+
+   for(i=0, n1=0, n2=0; i<alen; i++)
+   {
+      if(align1[i] != '-')
+         ck_assert(align1[i] == seq1[n1++]);
+      if(align2[i] != '-')
+         ck_assert(align2[i] == seq2[n2++]);
+   }
+   ck_assert_int_eq(n1, length1);
+   ck_assert_int_eq(n2, length2);
+
+   free(seq1);
+   free(seq2);
+   free(align1);
+   free(align2);
+}
+END_TEST
+
+
+START_TEST(test_profile_matches)
+{
+   char         seq1[MAXSEQ], seq2[MAXSEQ],
+                align1[2*MAXSEQ], align2[2*MAXSEQ],
+                prof1[2*MAXSEQ],  prof2[2*MAXSEQ];
+   int          trial, length1, length2, penalty, penext, 
+                score, alen, proflen;
+   BOOL         identity, upcase;
+   ALIGNPROFILE *profile;
+
+   for(trial=0; trial<500; trial++)
+   {
+      length1  = 1 + (RandomResidue(20) - 'A') * 3;
+      length2  = 1 + (RandomResidue(20) - 'A') * 3;
+      length1  = MIN(length1, MAXSEQ);
+      length2  = MIN(length2, MAXSEQ);
+      penalty  = trial % 12;
+      penext   = trial % 3;
+      identity = ((trial % 5) == 0);
+      upcase   = ((trial % 7) == 0);
+      RandomPair(seq1, length1, seq2, length2, (trial%3) ? 20 : 3);
+      if(upcase)
+         seq1[0] = tolower(seq1[0]);
+
+      if(upcase)
+         score = blAffinealignuc(seq1, length1, seq2, length2, FALSE,
+                                 identity, penalty, penext, 
+                                 align1, align2, &alen);
+      else
+         score = blAffinealign(seq1, length1, seq2, length2, FALSE,
+                               identity, penalty, penext, 
+                               align1, align2, &alen);
+
+      profile = blBuildAlignProfile(seq1, length1, identity, upcase);
+      ck_assert(profile != NULL);
+      ck_assert_int_eq(score, blAffinealignScore(profile, seq2, length2,
+                                                 penalty, penext));
+      ck_assert_int_eq(score, blAffinealignProfile(profile, seq2, length2,
+                                                   penalty, penext,
+                                                   prof1, prof2, 
+                                                   &proflen));
+      ck_assert_int_eq(alen, proflen);
+      ck_assert(!strncmp(align1, prof1, alen));
+      ck_assert(!strncmp(align2, prof2, alen));
+      blFreeAlignProfile(profile);
+   }
+}
+END_TEST
+
+
+START_TEST(test_profile_long)
+{
+   char         *seq1, *seq2;
+   int          length1 = LONGSEQ,
+                length2 = LONGSEQ - 10,
+                score, i;
+   ALIGNPROFILE *profile;
+
+   seq1 = (char *)malloc(length1 * sizeof(char));
+   seq2 = (char *)malloc(length2 * sizeof(char));
+   ck_assert(seq1 != NULL && seq2 != NULL);
+
+   RandomPair(seq1, length1, seq2, length2, 20);
+   for(i=0; i<length2; i++)
+      seq2[i] = seq1[(i < LONGSEQ/2) ? i : i+10];
+
+   /* Identity scores                                                   */
+   profile = blBuildAlignProfile(seq1, length1, TRUE, FALSE);
+   ck_assert(profile != NULL);
+   ck_assert_int_eq(blAffinealignScore(profile, seq2, length2, 10, 1),
+                    length2 - (10 + 9));
+   blFreeAlignProfile(profile);
+
+   free(seq1);
+   free(seq2);
+
+   /* A self alignment is the sum of the self scores. For this length 
+      the scores are too big for 16 bits so this checks the fallback
+   */
+   length1 = 2 * LONGSEQ;
+   seq1    = (char *)malloc(length1 * sizeof(char));
+   ck_assert(seq1 != NULL);
+   for(i=0, score=0; i<length1; i++)
+   {
+      seq1[i] = RandomResidue(20);
+      score  += blCalcMDMScore(seq1[i], seq1[i]);
+   }
+   ck_assert(score > SHRT_MAX);
+   profile = blBuildAlignProfile(seq1, length1, FALSE, FALSE);
+   ck_assert(profile != NULL);
+   ck_assert_int_eq(blAffinealignScore(profile, seq1, length1, 10, 1),
+                    score);
+   blFreeAlignProfile(profile);
+
+   free(seq1);
+}
+END_TEST
+
+
+START_TEST(test_context_matches)
+{
+   char         seq1[MAXSEQ], seq2[MAXSEQ],
+                align1[2*MAXSEQ], align2[2*MAXSEQ],
+                ctx1[2*MAXSEQ],   ctx2[2*MAXSEQ];
+   int          trial, m, length1, length2, 
+                score[2], ctxscore[2], alen, ctxlen;
+   ALIGNCONTEXT *ctx[2];
+
+   /* One context with each matrix, used alternately                    */
+   ctx[0] = blCreateAlignContext(10, 2);
+   ctx[1] = blCreateAlignContext(10, 2);
+   ck_assert(ctx[0] != NULL && ctx[1] != NULL);
+   ck_assert(blReadMDMCtx(ctx[0], mdm_filename));
+   ck_assert(blReadMDMCtx(ctx[1], mdm_filename2));
+   
+   for(trial=0; trial<100; trial++)
+   {
+      length1  = 1 + (RandomResidue(20) - 'A') * 3;
+      length2  = 1 + (RandomResidue(20) - 'A') * 3;
+      length1  = MIN(length1, MAXSEQ);
+      length2  = MIN(length2, MAXSEQ);
+      RandomPair(seq1, length1, seq2, length2, 20);
+
+      for(m=0; m<2; m++)
+      {
+         ck_assert(blReadMDM(m ? mdm_filename2 : mdm_filename));
+         score[m] = blAffinealign(seq1, length1, seq2, length2, FALSE,
+                                  FALSE, 10, 2, align1, align2, &alen);
+         ctxscore[m] = blAffinealignCtx(ctx[m], seq1, length1, 
+                                        seq2, length2, FALSE, FALSE, 
+                                        ctx1, ctx2, &ctxlen);
+         ck_assert_int_eq(score[m], ctxscore[m]);
+         ck_assert_int_eq(alen, ctxlen);
+         ck_assert(!strncmp(align1, ctx1, alen));
+         ck_assert(!strncmp(align2, ctx2, alen));
+      }
+   }
+   
+   blFreeAlignContext(ctx[0]);
+   blFreeAlignContext(ctx[1]);
+}
+END_TEST
+
+
+START_TEST(test_banded_matches)
+{
+   char seq1[MAXSEQ], seq2[MAXSEQ],
+        align1[2*MAXSEQ], align2[2*MAXSEQ],
+        band1[2*MAXSEQ],  band2[2*MAXSEQ];
+   int  trial, length1, length2, penalty, penext, start, stop,
+        score, bandscore, alen, bandlen, i;
+   BOOL identity, upcase;
+
+   for(trial=0; trial<500; trial++)
+   {
+      length1  = MAXSEQ - (RandomResidue(20) - 'A');
+      penalty  = trial % 12;
+      penext   = trial % 3;
+      identity = ((trial % 5) == 0);
+      upcase   = ((trial % 7) == 0);
+      for(i=0; i<length1; i++)
+         seq1[i] = RandomResidue(20);
+
+      /* seq2 is seq1 with the ends trimmed and a loop deleted, as for
+         the ATOM and SEQRES sequences
+      */
+      start   = (RandomResidue(20) - 'A') / 3;
+      stop    = length1 - (RandomResidue(20) - 'A') / 3;
+      for(i=start, length2=0; i<stop; i++)
+      {
+         if((i < length1/2) || (i >= length1/2 + trial%6))
+            seq2[length2++] = seq1[i];
+      }
+      if(upcase)
+         seq1[0] = tolower(seq1[0]);
+
+      if(upcase)
+         score = blAffinealignuc(seq1, length1, seq2, length2, FALSE,
+                                 identity, penalty, penext, 
+                                 align1, align2, &alen);
+      else
+         score = blAffinealign(seq1, length1, seq2, length2, FALSE,
+                               identity, penalty, penext, 
+                               align1, align2, &alen);
+      bandscore = blAffinealignBanded(seq1, length1, seq2, length2,
+                                      identity, upcase, penalty, penext,
+                                      trial % 4, band1, band2, &bandlen);
+
+      ck_assert_int_eq(score, bandscore);
+      ck_assert_int_eq(alen, bandlen);
+      ck_assert(!strncmp(align1, band1, alen));
+      ck_assert(!strncmp(align2, band2, alen));
+
+      /* A band covering the whole matrix gives the same alignment for
+         unrelated sequences
+      */
+      RandomPair(seq1, length1, seq2, length2, 20);
+      score = blAffinealign(seq1, length1, seq2, length2, FALSE,
+                            identity, penalty, penext, 
+                            align1, align2, &alen);
+      bandscore = blAffinealignBanded(seq1, length1, seq2, length2,
+                                      identity, FALSE, penalty, penext,
+                                      2*MAXSEQ, band1, band2, &bandlen);
+      ck_assert_int_eq(score, bandscore);
+      ck_assert_int_eq(alen, bandlen);
+      ck_assert(!strncmp(align1, band1, alen));
+      ck_assert(!strncmp(align2, band2, alen));
+   }
+}
+END_TEST
+
+
+START_TEST(test_banded_offset)
+{
+   char seq1[MAXOFFSEQ], seq2[2*MAXOFFSEQ],
+        align1[3*MAXOFFSEQ], align2[3*MAXOFFSEQ],
+        band1[3*MAXOFFSEQ],  band2[3*MAXOFFSEQ];
+   int  trial, length1, length2, score, bandscore, alen, bandlen, 
+        i, k;
+
+   for(trial=0; trial<50; trial++)
+   {
+      length1 = MAXOFFSEQ - 10 * (RandomResidue(20) - 'A');
+      for(i=0; i<length1; i++)
+         seq1[i] = RandomResidue(20);
+
+      /* seq2 has an extra 10 residues at the N-terminus and is 
+         missing 10 at the C-terminus, with a few mutations and short
+         insertions, so the best path lies outside the starting band
+      */
+      for(length2=0; length2<10; length2++)
+         seq2[length2] = RandomResidue(20);
+      for(i=0; i<length1-10; i++)
+      {
+         if(RandomResidue(20) == 'A')
+         {
+            for(k=(RandomResidue(4)-'A'); k>=0; k--)
+               seq2[length2++] = RandomResidue(20);
+         }
+         seq2[length2++] = (RandomResidue(8) == 'A') ? 
+                           RandomResidue(20) : seq1[i];
+      }
+
+      score = blAffinealign(seq1, length1, seq2, length2, FALSE,
+                            FALSE, 10, 2, align1, align2, &alen);
+      bandscore = blAffinealignBanded(seq1, length1, seq2, length2,
+                                      FALSE, FALSE, 10, 2, 0,
+                                      band1, band2, &bandlen);
+      ck_assert_int_eq(score, bandscore);
+      ck_assert_int_eq(alen, bandlen);
+      ck_assert(!strncmp(align1, band1, alen));
+      ck_assert(!strncmp(align2, band2, alen));
+   }
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *align_suite(void)
+{
+   Suite *s = suite_create("Align");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             align_setup, 
+                             align_teardown);
+   tcase_add_test(tc_core, test_linear_matches);
+   tcase_add_test(tc_core, test_linear_long);
+   tcase_add_test(tc_core, test_profile_matches);
+   tcase_add_test(tc_core, test_profile_long);
+   tcase_add_test(tc_core, test_context_matches);
+   tcase_add_test(tc_core, test_banded_matches);
+   tcase_add_test(tc_core, test_banded_offset);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
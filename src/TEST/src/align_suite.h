@@ -0,0 +1,78 @@
+/************************************************************************/
+/**
+
+   \file       align_suite.h
+   
+   \version    V1.1
+   \date       16.10.26
+   \brief      Test suite for sequence alignment.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for sequence alignment.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Added limits.h
+
+*************************************************************************/
+
+#ifndef _ALIGN_SUITE_H
+#define _ALIGN_SUITE_H
+
+/* Includes for tests */
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <check.h>
+
+/* Includes from source file */
+#include "../../SysDefs.h"
+#include "../../MathType.h"
+#include "../../macros.h"
+#include "../../general.h"
+#include "../../seq.h"
+
+
+/* Prototypes */
+Suite *align_suite(void);
+
+#endif
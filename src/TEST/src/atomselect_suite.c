@@ -0,0 +1,302 @@
+/************************************************************************/
+/**
+
+   \file       atomselect_suite.c
+   
+   \version    V1.1
+   \date       16.10.26
+   \brief      Test suite for compiled atom selections.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blCompilePDBSelection() and blEvalPDBSelection().
+   Selections are checked against the same tests made atom by atom.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Added test_atomselect_05 for numeric chain labels
+
+*************************************************************************/
+
+#include "atomselect_suite.h"
+
+/* Globals */
+static char test_input_filename[] = "data/test-deca-ala-01.pdb";
+static PDB          *pdb = NULL;
+static PDBSELECTION *sel = NULL;
+static int          natoms;
+
+/* Setup And Teardown */
+static void atomselect_setup(void)
+{
+   FILE *fp;
+   
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb != NULL, "Failed to read test file.");
+   sel = NULL;
+}
+
+static void atomselect_teardown(void)
+{
+   if(sel != NULL) blFreePDBSelection(sel);
+   if(pdb != NULL) FREELIST(pdb, PDB);
+}
+
+/* Compile and evaluate a selection, checking each atom against the
+   given test
+*/
+static void check_selection(char *expr, BOOL (*test)(PDB *))
+{
+   PDB *p;
+   int i, 
+       n = 0;
+
+   if(sel != NULL) blFreePDBSelection(sel);
+   sel = blCompilePDBSelection(expr, NULL);
+   ck_assert_msg(sel != NULL, "Failed to compile selection.");
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      if((*test)(p)) n++;
+   ck_assert_int_eq(blEvalPDBSelection(sel, pdb), n);
+   ck_assert_int_eq(sel->natoms, natoms);
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+      ck_assert_int_eq(PDBSELECTED(sel, i) ? TRUE : FALSE, (*test)(p));
+}
+
+static BOOL is_ca(PDB *p)
+{
+   return(!strncmp(p->atnam, "CA  ", 4));
+}
+
+static BOOL is_carbon(PDB *p)
+{
+   return(blAtomNameMatch(p->atnam, "C*", NULL));
+}
+
+static BOOL is_beta(PDB *p)
+{
+   return(blAtomNameMatch(p->atnam, "?B*", NULL));
+}
+
+static BOOL is_backbone_not_a3_5(PDB *p)
+{
+   return((!strncmp(p->atnam, "N   ", 4) || !strncmp(p->atnam, "CA  ", 4) ||
+           !strncmp(p->atnam, "C   ", 4) || !strncmp(p->atnam, "O   ", 4)) &&
+          !(CHAINMATCH(p->chain, "A") && p->resnum >= 3 && p->resnum <= 5));
+}
+
+static BOOL is_b_or_a1(PDB *p)
+{
+   return(CHAINMATCH(p->chain, "B") || 
+          (CHAINMATCH(p->chain, "A") && p->resnum == 1));
+}
+
+static BOOL is_resid_2_3(PDB *p)
+{
+   return(p->resnum >= 2 && p->resnum <= 3);
+}
+
+static BOOL is_1_3(PDB *p)
+{
+   return(CHAINMATCH(p->chain, "1") && (p->resnum == 3));
+}
+
+static BOOL is_1_2_4(PDB *p)
+{
+   return(CHAINMATCH(p->chain, "1") && (p->resnum >= 2) && 
+          (p->resnum <= 4));
+}
+
+static BOOL is_resid_3(PDB *p)
+{
+   return(p->resnum == 3);
+}
+
+static BOOL is_none(PDB *p)
+{
+   return(FALSE);
+}
+
+static BOOL is_all(PDB *p)
+{
+   return(TRUE);
+}
+
+static BOOL is_near_a1(PDB *p)
+{
+   PDB *q;
+
+   for(q=pdb; q!=NULL; NEXT(q))
+   {
+      if(CHAINMATCH(q->chain, "A") && (q->resnum == 1) &&
+         (DISTSQ(p, q) <= (REAL)(4.0*4.0)))
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+/* Core tests */
+START_TEST(test_atomselect_01)
+{
+   /* Atom names and wildcards                                          */
+   check_selection("name CA", is_ca);
+   check_selection("NAME C*", is_carbon);
+   check_selection("name ?B*", is_beta);
+   check_selection("element C", is_carbon);
+   check_selection("element C and not name CB CA C", is_none);
+   check_selection("all", is_all);
+   check_selection("none", is_none);
+}
+END_TEST
+
+START_TEST(test_atomselect_02)
+{
+   /* Residues, chains and logic                                        */
+   check_selection("name N CA C O and not resid A3-A5", 
+                   is_backbone_not_a3_5);
+   check_selection("name N CA C O and not resid A3-5", 
+                   is_backbone_not_a3_5);
+   check_selection("chain B or (resid A1 and resname ALA)", is_b_or_a1);
+   check_selection("resid 2-3", is_resid_2_3);
+   check_selection("record ATOM", is_all);
+   check_selection("record HETATM", is_none);
+}
+END_TEST
+
+START_TEST(test_atomselect_03)
+{
+   PDB  *copy1, *copy2, *p, *q;
+   char *names[4] = {"N   ", "CA  ", "C   ", "O   "};
+   int  *atoms   = NULL,
+        maxatoms = 0,
+        n1, n2, n, i;
+
+   /* Distances                                                         */
+   check_selection("within 4.0 of resid A1", is_near_a1);
+
+   /* Index lists and copies                                            */
+   if(sel != NULL) blFreePDBSelection(sel);
+   sel = blCompilePDBSelection("name N CA C O", NULL);
+   ck_assert_msg(sel != NULL, "Failed to compile selection.");
+   n = blEvalPDBSelection(sel, pdb);
+   ck_assert_int_eq(blGetPDBSelectionIndexes(sel, &atoms, &maxatoms), n);
+   for(i=1; i<n; i++)
+      ck_assert(atoms[i] > atoms[i-1]);
+   free(atoms);
+
+   copy1 = blCopyPDBSelection(sel, pdb, &n1);
+   copy2 = blSelectAtomsPDBAsCopy(pdb, 4, names, &n2);
+   ck_assert_int_eq(n1, n);
+   ck_assert_int_eq(n2, n);
+   for(p=copy1, q=copy2; p!=NULL && q!=NULL; NEXT(p), NEXT(q))
+      ck_assert_int_eq(p->atnum, q->atnum);
+   ck_assert(p == NULL && q == NULL);
+   FREELIST(copy1, PDB);
+   FREELIST(copy2, PDB);
+}
+END_TEST
+
+START_TEST(test_atomselect_04)
+{
+   int errpos;
+
+   /* Syntax errors                                                     */
+   ck_assert(blCompilePDBSelection("name", &errpos) == NULL);
+   ck_assert_int_eq(errpos, 0);
+   ck_assert(blCompilePDBSelection("name CA and", &errpos) == NULL);
+   ck_assert_int_eq(errpos, 8);
+   ck_assert(blCompilePDBSelection("(name CA", &errpos) == NULL);
+   ck_assert_int_eq(errpos, 0);
+   ck_assert(blCompilePDBSelection("name CA)", &errpos) == NULL);
+   ck_assert_int_eq(errpos, 7);
+   ck_assert(blCompilePDBSelection("resid A10-B20", &errpos) == NULL);
+   ck_assert_int_eq(errpos, 6);
+   ck_assert(blCompilePDBSelection("resid A20-A10", &errpos) == NULL);
+   ck_assert(blCompilePDBSelection("name C*A", &errpos) == NULL);
+   ck_assert(blCompilePDBSelection("name CAAAA", &errpos) == NULL);
+   ck_assert(blCompilePDBSelection("within x of all", &errpos) == NULL);
+   ck_assert_int_eq(errpos, 7);
+   ck_assert(blCompilePDBSelection("within 4 all", &errpos) == NULL);
+   ck_assert_int_eq(errpos, 9);
+   ck_assert(blCompilePDBSelection("record FOO", &errpos) == NULL);
+}
+END_TEST
+
+START_TEST(test_atomselect_05)
+{
+   PDB *p;
+
+   /* Numeric chain label given with a . separator                      */
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if(CHAINMATCH(p->chain, "B"))
+         strcpy(p->chain, "1");
+   }
+   check_selection("resid 1.3", is_1_3);
+   check_selection("resid 1.2-1.4", is_1_2_4);
+   check_selection("resid 1.2-4", is_1_2_4);
+   check_selection("resid 3", is_resid_3);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *atomselect_suite(void)
+{
+   Suite *s = suite_create("AtomSelect");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             atomselect_setup, 
+                             atomselect_teardown);
+   tcase_add_test(tc_core, test_atomselect_01);
+   tcase_add_test(tc_core, test_atomselect_02);
+   tcase_add_test(tc_core, test_atomselect_03);
+   tcase_add_test(tc_core, test_atomselect_04);
+   tcase_add_test(tc_core, test_atomselect_05);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
@@ -0,0 +1,247 @@
+/************************************************************************/
+/**
+
+   \file       bpdb_suite.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Test suite for binary .bpdb files.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blWriteBPDB(), blWriteWholeBPDB(), blReadBPDB(),
+   blReadWholeBPDB() and the lazy blOpenBPDB() interface. Files are
+   written and read back and compared field by field with the original.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+
+#include "bpdb_suite.h"
+
+/* Globals */
+static char test_input_filename[] = 
+               "data/wholepdb_suite/test_alanine_in.pdb",
+            test_bpdb_filename[]  = "tmp/test_alanine_in.bpdb";
+static WHOLEPDB *wpdb_in  = NULL,
+                *wpdb_out = NULL;
+static PDB      *pdb_out  = NULL;
+static BPDBFILE *bpdb     = NULL;
+
+/* Setup And Teardown */
+static void bpdb_setup(void)
+{
+   FILE *fp;
+   PDB  *p;
+   int  i = 0;
+   
+   wpdb_out = NULL;
+   pdb_out  = NULL;
+   bpdb     = NULL;
+
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   wpdb_in = blReadWholePDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb_in != NULL, "Failed to read test file.");
+   
+   /* Fill in the fields that don't come from PDB files                 */
+   for(p=wpdb_in->pdb; p!=NULL; NEXT(p))
+   {
+      p->access         = (REAL)i * 1.5;
+      p->radius         = (REAL)i * 0.25;
+      p->partial_charge = (REAL)i * -0.125;
+      i++;
+   }
+}
+
+static void bpdb_teardown(void)
+{
+   if(wpdb_in  != NULL) blFreeWholePDB(wpdb_in);
+   if(wpdb_out != NULL) blFreeWholePDB(wpdb_out);
+   if(pdb_out  != NULL) FREELIST(pdb_out, PDB);
+   if(bpdb     != NULL) blCloseBPDB(bpdb);
+   remove(test_bpdb_filename);
+}
+
+/* Write the test file                                                  */
+static void write_bpdb(BOOL whole)
+{
+   FILE *fp;
+   
+   fp = fopen(test_bpdb_filename, "wb");
+   ck_assert_msg(fp != NULL, "Failed to open output file.");
+   if(whole)
+      ck_assert(blWriteWholeBPDB(fp, wpdb_in));
+   else
+      ck_assert(blWriteBPDB(fp, wpdb_in->pdb));
+   fclose(fp);
+}
+
+/* Compare two lists                                                    */
+static void compare_lists(PDB *pdb1, PDB *pdb2)
+{
+   PDB *p, *q;
+
+   for(p=pdb1, q=pdb2; p!=NULL && q!=NULL; NEXT(p), NEXT(q))
+   {
+      ck_assert_str_eq(q->record_type, p->record_type);
+      ck_assert_str_eq(q->atnam,       p->atnam);
+      ck_assert_str_eq(q->atnam_raw,   p->atnam_raw);
+      ck_assert_str_eq(q->resnam,      p->resnam);
+      ck_assert_str_eq(q->chain,       p->chain);
+      ck_assert_str_eq(q->insert,      p->insert);
+      ck_assert_str_eq(q->element,     p->element);
+      ck_assert_int_eq(q->atnum,       p->atnum);
+      ck_assert_int_eq(q->resnum,      p->resnum);
+      ck_assert_int_eq(q->formal_charge, p->formal_charge);
+      ck_assert(q->altpos         == p->altpos);
+      ck_assert(q->x              == p->x);
+      ck_assert(q->y              == p->y);
+      ck_assert(q->z              == p->z);
+      ck_assert(q->occ            == p->occ);
+      ck_assert(q->bval           == p->bval);
+      ck_assert(q->access         == p->access);
+      ck_assert(q->radius         == p->radius);
+      ck_assert(q->partial_charge == p->partial_charge);
+   }
+   ck_assert(p == NULL);
+   ck_assert(q == NULL);
+}
+
+/* Compare two string lists                                             */
+static void compare_strings(STRINGLIST *s1, STRINGLIST *s2)
+{
+   for(; s1!=NULL && s2!=NULL; NEXT(s1), NEXT(s2))
+      ck_assert_str_eq(s2->string, s1->string);
+   ck_assert(s1 == NULL);
+   ck_assert(s2 == NULL);
+}
+
+/* Core tests */
+START_TEST(test_bpdb_01)
+{
+   FILE *fp;
+   int  natoms;
+   
+   write_bpdb(FALSE);
+   fp = fopen(test_bpdb_filename, "rb");
+   pdb_out = blReadBPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb_out != NULL, "Failed to read .bpdb file.");
+   ck_assert_int_eq(natoms, wpdb_in->natoms);
+   compare_lists(wpdb_in->pdb, pdb_out);
+}
+END_TEST
+
+START_TEST(test_bpdb_02)
+{
+   FILE *fp;
+   
+   write_bpdb(TRUE);
+   fp = fopen(test_bpdb_filename, "rb");
+   wpdb_out = blReadWholeBPDB(fp);
+   fclose(fp);
+   ck_assert_msg(wpdb_out != NULL, "Failed to read .bpdb file.");
+   ck_assert_int_eq(wpdb_out->natoms, wpdb_in->natoms);
+   compare_lists(wpdb_in->pdb, wpdb_out->pdb);
+   compare_strings(wpdb_in->header,  wpdb_out->header);
+   compare_strings(wpdb_in->trailer, wpdb_out->trailer);
+}
+END_TEST
+
+START_TEST(test_bpdb_lazy)
+{
+   PDB        atom, 
+              *p;
+   STRINGLIST *header;
+   int        natoms;
+   
+   write_bpdb(TRUE);
+   bpdb = blOpenBPDB(test_bpdb_filename);
+   ck_assert_msg(bpdb != NULL, "Failed to open .bpdb file.");
+   ck_assert_int_eq(bpdb->natoms, wpdb_in->natoms);
+
+   /* Single atom access                                                */
+   p = wpdb_in->pdb->next->next;
+   ck_assert(blGetBPDBAtom(bpdb, 2, &atom));
+   ck_assert_str_eq(atom.atnam, p->atnam);
+   ck_assert(atom.x == p->x);
+   ck_assert(!blGetBPDBAtom(bpdb, bpdb->natoms, &atom));
+
+   /* Part of the list                                                  */
+   pdb_out = blBPDBToPDB(bpdb, 2, 0, &natoms);
+   ck_assert_int_eq(natoms, wpdb_in->natoms - 2);
+   compare_lists(p, pdb_out);
+
+   header = blGetBPDBHeader(bpdb);
+   compare_strings(wpdb_in->header, header);
+   if(header != NULL) blFreeStringList(header);
+}
+END_TEST
+
+START_TEST(test_bpdb_bad)
+{
+   /* A text PDB file is not a .bpdb file                               */
+   bpdb = blOpenBPDB(test_input_filename);
+   ck_assert(bpdb == NULL);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *bpdb_suite(void)
+{
+   Suite *s = suite_create("BPDB");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             bpdb_setup, 
+                             bpdb_teardown);
+   tcase_add_test(tc_core, test_bpdb_01);
+   tcase_add_test(tc_core, test_bpdb_02);
+   tcase_add_test(tc_core, test_bpdb_lazy);
+   tcase_add_test(tc_core, test_bpdb_bad);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
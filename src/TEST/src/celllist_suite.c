@@ -0,0 +1,233 @@
+/************************************************************************/
+/**
+
+   \file       celllist_suite.c
+   
+   \version    V1.2
+   \date       16.10.26
+   \brief      Test suite for cell list neighbour searching.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blBuildPDBCellList() and the neighbour queries. The
+   results are compared with a simple test of every atom.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Added test_celllist_04 for atoms with no coordinates
+-  V1.2  16.10.26 Frees library-built lists with FREEPDBLIST()
+
+*************************************************************************/
+
+#include "celllist_suite.h"
+
+/* Globals */
+static char test_input_filename[] = "data/test-deca-ala-01.pdb";
+static PDB         *pdb      = NULL;
+static PDBCELLLIST *cl       = NULL;
+static int         *atoms    = NULL,
+                   maxatoms  = 0,
+                   natoms;
+
+/* Setup And Teardown */
+static void celllist_setup(void)
+{
+   FILE *fp;
+   
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb != NULL, "Failed to read test file.");
+   atoms    = NULL;
+   maxatoms = 0;
+   cl       = NULL;
+}
+
+static void celllist_teardown(void)
+{
+   if(cl    != NULL) blFreePDBCellList(cl);
+   if(atoms != NULL) free(atoms);
+   if(pdb   != NULL) FREEPDBLIST(pdb);
+}
+
+/* Check the atoms found for a residue against testing every atom       */
+static void check_residue(PDB *res, REAL dist, int nfound)
+{
+   PDB  *p, *q, 
+        *next = blFindNextResidue(res);
+   int  i, 
+        n = 0;
+   BOOL near;
+
+   for(q=pdb, i=0; q!=NULL; NEXT(q), i++)
+   {
+      near = FALSE;
+      for(p=res; p!=next; NEXT(p))
+      {
+         if(DISTSQ(p, q) <= dist * dist)
+            near = TRUE;
+      }
+      if(near)
+      {
+         ck_assert(n < nfound);
+         ck_assert_int_eq(atoms[n], i);
+         n++;
+      }
+   }
+   ck_assert_int_eq(n, nfound);
+}
+
+/* Core tests */
+START_TEST(test_celllist_01)
+{
+   PDB  *res;
+   REAL dist[3] = {2.0, 4.0, 10.0};
+   int  i, n;
+
+   cl = blBuildPDBCellList(pdb, 4.0);
+   ck_assert_msg(cl != NULL, "Failed to build cell list.");
+   ck_assert_int_eq(cl->coords->natoms, natoms);
+
+   /* Distances less than, equal to and greater than the cell size      */
+   for(i=0; i<3; i++)
+   {
+      for(res=pdb; res!=NULL; res=blFindNextResidue(res))
+      {
+         n = blFindPDBResidueNeighbours(cl, res, dist[i], 
+                                        &atoms, &maxatoms);
+         check_residue(res, dist[i], n);
+      }
+   }
+}
+END_TEST
+
+START_TEST(test_celllist_02)
+{
+   PDB   *p;
+   VEC3F point;
+   int   n;
+
+   cl = blBuildPDBCellList(pdb, 4.0);
+   ck_assert_msg(cl != NULL, "Failed to build cell list.");
+
+   /* An atom finds itself                                              */
+   p = pdb->next->next;
+   n = blFindPDBAtomNeighbours(cl, p, 0.1, &atoms, &maxatoms);
+   ck_assert_int_eq(n, 1);
+   ck_assert(cl->coords->atom[atoms[0]] == p);
+
+   /* A point well away from the structure finds nothing                */
+   point.x = p->x + 100.0;
+   point.y = p->y;
+   point.z = p->z;
+   n = blFindPDBPointNeighbours(cl, point, 4.0, &atoms, &maxatoms);
+   ck_assert_int_eq(n, 0);
+}
+END_TEST
+
+START_TEST(test_celllist_03)
+{
+   PDB  *res, *p, *q;
+   int  n;
+
+   /* blBuildAtomNeighbourPDBListAsCopy() gives the same atoms          */
+   cl  = blBuildPDBCellList(pdb, 4.0);
+   res = blFindNextResidue(pdb);
+   n   = blFindPDBResidueNeighbours(cl, res, 4.0, &atoms, &maxatoms);
+   p   = blBuildAtomNeighbourPDBListAsCopy(pdb, res, 4.0);
+   ck_assert(p != NULL);
+   for(q=p, natoms=0; q!=NULL; NEXT(q), natoms++)
+   {
+      ck_assert(natoms < n);
+      ck_assert_int_eq(q->atnum, cl->coords->atom[atoms[natoms]]->atnum);
+   }
+   ck_assert_int_eq(natoms, n);
+   FREEPDBLIST(p);
+}
+END_TEST
+
+START_TEST(test_celllist_04)
+{
+   PDB  *res, *p, *q, *far;
+   BOOL foundRes  = FALSE,
+        foundFar  = FALSE;
+
+   /* Atoms with no coordinates are neighbours of each other, as when 
+      blBuildAtomNeighbourPDBListAsCopy() tested every pair
+   */
+   res = blFindNextResidue(pdb);
+   res->next->x = res->next->y = res->next->z = (REAL)9999.0;
+   for(far=res; far->next!=NULL; NEXT(far));
+   far->x = far->y = far->z = (REAL)9999.0;
+
+   p   = blBuildAtomNeighbourPDBListAsCopy(pdb, res, 4.0);
+   ck_assert(p != NULL);
+   for(q=p; q!=NULL; NEXT(q))
+   {
+      ck_assert(q->occ == (REAL)1.0);
+      if(q->atnum == res->next->atnum) foundRes = TRUE;
+      if(q->atnum == far->atnum)       foundFar = TRUE;
+   }
+   ck_assert(foundRes);
+   ck_assert(foundFar);
+   FREEPDBLIST(p);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *celllist_suite(void)
+{
+   Suite *s = suite_create("CellList");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             celllist_setup, 
+                             celllist_teardown);
+   tcase_add_test(tc_core, test_celllist_01);
+   tcase_add_test(tc_core, test_celllist_02);
+   tcase_add_test(tc_core, test_celllist_03);
+   tcase_add_test(tc_core, test_celllist_04);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
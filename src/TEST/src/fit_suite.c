@@ -0,0 +1,431 @@
+/************************************************************************/
+/**
+
+   \file       fit_suite.c
+   
+   \version    V1.4
+   \date       16.10.26
+   \brief      Test suite for coordinate fitting.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blQCPfit(), blQCPfitRMSD() and blQCPrmsd(). The QCP
+   rotation must agree with blMatfit() and the RMSD must agree with the
+   RMSD after applying the rotation. blRMSDMatrixPDB() must agree with
+   fitting each pair of models with blFitCaPDB(). The models are
+   perturbed copies of crambin, enough to need more than one tile. 
+   Fitting to a fit target must give the same coordinates as 
+   blFitCaPDB() and the same weighted RMSD as blQCPrmsd(). With CA/CB
+   weighting it must give the same rotation as blFitCaCbPDB().
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Added test_rmsd_matrix
+-  V1.2  16.10.26 Added test_fit_target
+-  V1.3  16.10.26 Added test_qcp_degenerate
+-  V1.4  16.10.26 test_fit_target checks the CA/CB weighted fit against
+                  blFitCaCbPDB()
+
+*************************************************************************/
+
+#include "fit_suite.h"
+
+/* Defines */
+#define NCOOR 20
+#define NMODELS 40
+
+/* Globals */
+static COOR ref[NCOOR],
+            mob[NCOOR];
+static REAL weights[NCOOR];
+static char test_pdb_filename[] = "data/hbond_suite/test_crambin.pdb";
+
+/* Setup And Teardown */
+static void fit_setup(void)
+{
+   REAL  rm[3][3],
+         ang = 1.1,
+         cs  = cos(ang),
+         sn  = sin(ang);
+   VEC3F cg1 = {0.0, 0.0, 0.0},
+         cg2 = {0.0, 0.0, 0.0};
+   int   i;
+
+   /* A rotation about z and an irregular set of points with some noise
+      on the rotated copy
+   */
+   rm[0][0] = cs;  rm[0][1] = sn;  rm[0][2] = 0.0;
+   rm[1][0] = -sn; rm[1][1] = cs;  rm[1][2] = 0.0;
+   rm[2][0] = 0.0; rm[2][1] = 0.0; rm[2][2] = 1.0;
+   
+   for(i=0; i<NCOOR; i++)
+   {
+      ref[i].x   = (REAL)((i * 7) % 11) - 5.0;
+      ref[i].y   = (REAL)((i * 5) % 13) - 6.0;
+      ref[i].z   = (REAL)((i * 3) % 7)  - 3.0;
+      weights[i] = 1.0 + (REAL)(i % 3);
+      blMatMult3_33(ref[i], rm, &(mob[i]));
+      mob[i].x  += 0.1 * (REAL)((i % 5) - 2);
+      mob[i].y  -= 0.1 * (REAL)((i % 3) - 1);
+   }
+
+   for(i=0; i<NCOOR; i++)
+   {
+      cg1.x += ref[i].x / NCOOR; cg1.y += ref[i].y / NCOOR;
+      cg1.z += ref[i].z / NCOOR;
+      cg2.x += mob[i].x / NCOOR; cg2.y += mob[i].y / NCOOR;
+      cg2.z += mob[i].z / NCOOR;
+   }
+   for(i=0; i<NCOOR; i++)
+   {
+      ref[i].x -= cg1.x; ref[i].y -= cg1.y; ref[i].z -= cg1.z;
+      mob[i].x -= cg2.x; mob[i].y -= cg2.y; mob[i].z -= cg2.z;
+   }
+}
+
+static void fit_teardown(void)
+{
+}
+
+/* RMSD between ref and mob after applying a rotation                   */
+static REAL RMSAfter(REAL rm[3][3], REAL *wt)
+{
+   REAL  sum  = 0.0,
+         wsum = 0.0,
+         w;
+   VEC3F v;
+   int   i;
+   
+   for(i=0; i<NCOOR; i++)
+   {
+      w = (wt != NULL) ? wt[i] : 1.0;
+      blMatMult3_33(mob[i], rm, &v);
+      sum  += w * DISTSQ(&v, &(ref[i]));
+      wsum += w;
+   }
+   return(sqrt(sum / wsum));
+}
+
+/* RMSD between two coordinate arrays after rotating the second        */
+static REAL RMSAfterN(COOR *x1, COOR *x2, int n, REAL rm[3][3])
+{
+   REAL  sum = 0.0;
+   VEC3F v;
+   int   i;
+   
+   for(i=0; i<n; i++)
+   {
+      blMatMult3_33(x2[i], rm, &v);
+      sum += DISTSQ(&v, &(x1[i]));
+   }
+   return(sqrt(sum / n));
+}
+
+/* Core tests */
+START_TEST(test_qcp_matfit)
+{
+   REAL rm1[3][3], rm2[3][3];
+   int  i, j, pass;
+
+   /* Unweighted then weighted                                          */
+   for(pass=0; pass<2; pass++)
+   {
+      REAL *wt = pass ? weights : NULL;
+      
+      ck_assert(blMatfit(ref, mob, rm1, NCOOR, wt, FALSE));
+      ck_assert(blQCPfit(ref, mob, rm2, NCOOR, wt, FALSE));
+      for(i=0; i<3; i++)
+         for(j=0; j<3; j++)
+            ck_assert(fabs(rm1[i][j] - rm2[i][j]) < 1.0e-6);
+   }
+   
+   /* Column-wise matrix is the transpose                               */
+   ck_assert(blQCPfit(ref, mob, rm1, NCOOR, NULL, FALSE));
+   ck_assert(blQCPfit(ref, mob, rm2, NCOOR, NULL, TRUE));
+   for(i=0; i<3; i++)
+      for(j=0; j<3; j++)
+         ck_assert(rm1[j][i] == rm2[i][j]);
+
+   ck_assert(!blQCPfit(ref, mob, rm2, 1, NULL, FALSE));
+}
+END_TEST
+
+START_TEST(test_qcp_rmsd)
+{
+   REAL rm[3][3], rmsd;
+
+   ck_assert(blQCPfitRMSD(ref, mob, NCOOR, NULL, rm, FALSE, &rmsd));
+   ck_assert(rmsd > 0.0);
+   ck_assert(fabs(rmsd - RMSAfter(rm, NULL)) < 1.0e-6);
+   ck_assert(fabs(blQCPrmsd(ref, mob, NCOOR, NULL) - rmsd) < 1.0e-10);
+
+   ck_assert(blQCPfitRMSD(ref, mob, NCOOR, weights, rm, FALSE, &rmsd));
+   ck_assert(fabs(rmsd - RMSAfter(rm, weights)) < 1.0e-6);
+
+   /* A structure fitted to itself                                      */
+   ck_assert(blQCPrmsd(ref, ref, NCOOR, NULL) < 1.0e-6);
+}
+END_TEST
+
+START_TEST(test_qcp_degenerate)
+{
+   COOR two1[2]   = {{ 1.0, 0.0, 0.0}, {-1.0, 0.0, 0.0}},
+        two2[2]   = {{ 0.0, 1.0, 0.0}, { 0.0,-1.0, 0.0}},
+        line1[3]  = {{-1.0, 0.0, 0.0}, { 0.0, 0.0, 0.0}, { 1.0, 0.0, 0.0}},
+        line2[3]  = {{ 0.0, 0.0,-2.0}, { 0.0, 0.0, 0.0}, { 0.0, 0.0, 2.0}},
+        tri1[3]   = {{ 2.0,-1.0, 0.0}, {-1.0, 2.0, 0.0}, {-1.0,-1.0, 0.0}},
+        tri2[3],
+        small1[3],
+        small2[3];
+   REAL rm1[3][3], rm2[3][3], rmsd,
+        scale;
+   int  i, j;
+
+   /* Two points - the rotation isn't unique                            */
+   ck_assert(blQCPfitRMSD(two1, two2, 2, NULL, rm1, FALSE, &rmsd));
+   ck_assert(rmsd == rmsd);
+   ck_assert(rmsd < 1.0e-6);
+   ck_assert(RMSAfterN(two1, two2, 2, rm1) < 1.0e-6);
+   ck_assert(fabs(blQCPrmsd(two1, two2, 2, NULL)) < 1.0e-6);
+
+   /* Collinear points of different lengths                             */
+   ck_assert(blQCPfitRMSD(line1, line2, 3, NULL, rm1, FALSE, &rmsd));
+   ck_assert(rmsd == rmsd);
+   ck_assert(fabs(rmsd - RMSAfterN(line1, line2, 3, rm1)) < 1.0e-6);
+   ck_assert(fabs(rmsd - sqrt(2.0/3.0)) < 1.0e-6);
+
+   /* A triangle rotated by 90 degrees about z at decreasing scales 
+      should always give the same rotation as blMatfit()
+   */
+   for(i=0; i<3; i++)
+   {
+      tri2[i].x = -tri1[i].y;
+      tri2[i].y =  tri1[i].x;
+      tri2[i].z =  tri1[i].z;
+   }
+   for(scale=1.0; scale>1.0e-4; scale/=10.0)
+   {
+      for(i=0; i<3; i++)
+      {
+         small1[i].x = scale * tri1[i].x;
+         small1[i].y = scale * tri1[i].y;
+         small1[i].z = scale * tri1[i].z;
+         small2[i].x = scale * tri2[i].x;
+         small2[i].y = scale * tri2[i].y;
+         small2[i].z = scale * tri2[i].z;
+      }
+      ck_assert(blMatfit(small1, small2, rm1, 3, NULL, FALSE));
+      ck_assert(blQCPfitRMSD(small1, small2, 3, NULL, rm2, FALSE, 
+                             &rmsd));
+      ck_assert(rmsd < 1.0e-6 * scale);
+      for(i=0; i<3; i++)
+         for(j=0; j<3; j++)
+            ck_assert(fabs(rm1[i][j] - rm2[i][j]) < 1.0e-6);
+   }
+}
+END_TEST
+
+START_TEST(test_rmsd_matrix)
+{
+   PDB  *models[NMODELS], *fitted, *ca1, *ca2, *p;
+   REAL *matrix, *threaded, rm[3][3];
+   char *sel[1];
+   int  i, j, natoms;
+   FILE *fp;
+
+   fp = fopen(test_pdb_filename, "r");
+   ck_assert(fp != NULL);
+   models[0] = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert(models[0] != NULL);
+
+   for(i=1; i<NMODELS; i++)
+   {
+      models[i] = blDupePDB(models[0]);
+      for(p=models[i], j=0; p!=NULL; NEXT(p), j++)
+      {
+         p->x += 0.5 * sin((REAL)(i * 7 + j));
+         p->y += 0.5 * cos((REAL)(i * 3 + j));
+         p->z += 0.5 * sin((REAL)(i + j * 5));
+      }
+   }
+
+   matrix = blRMSDMatrixPDB(models, NMODELS, RMSD_ATOMS_CA, 1);
+   ck_assert(matrix != NULL);
+
+   SELECT(sel[0], "CA  ");
+   for(i=0; i<NMODELS; i++)
+   {
+      for(j=i+1; j<NMODELS; j++)
+      {
+         fitted = blDupePDB(models[j]);
+         ck_assert(blFitCaPDB(models[i], fitted, rm));
+         ca1 = blSelectAtomsPDBAsCopy(models[i], 1, sel, &natoms);
+         ca2 = blSelectAtomsPDBAsCopy(fitted, 1, sel, &natoms);
+         ck_assert(fabs(matrix[RMSDMATRIX_INDEX(i, j, NMODELS)] -
+                        blCalcRMSPDB(ca1, ca2)) < 1.0e-4);
+         FREEPDBLIST(ca1);
+         FREEPDBLIST(ca2);
+         FREEPDBLIST(fitted);
+      }
+   }
+   free(sel[0]);
+
+   /* Threads must give exactly the same answers                        */
+   threaded = blRMSDMatrixPDB(models, NMODELS, RMSD_ATOMS_CA, 2);
+   ck_assert(threaded != NULL);
+   for(i=0; i<NMODELS*(NMODELS-1)/2; i++)
+      ck_assert(matrix[i] == threaded[i]);
+
+   free(matrix);
+   free(threaded);
+   for(i=0; i<NMODELS; i++)
+      FREEPDBLIST(models[i]);
+}
+END_TEST
+
+START_TEST(test_fit_target)
+{
+   PDB       *ref, *mob, *fitted, *p, *q, *ca1, *ca2;
+   FITTARGET *target;
+   COOR      *coor;
+   REAL      rm[3][3], trm[3][3], rmsd, rmsd2, 
+             rot[3][3] = {{0.36, 0.48, -0.80}, 
+                          {-0.80, 0.60, 0.00}, 
+                          {0.48, 0.64, 0.60}};
+   char      *sel[1];
+   int       natoms, i, j, ncoor;
+   FILE      *fp;
+
+   fp = fopen(test_pdb_filename, "r");
+   ck_assert(fp != NULL);
+   ref = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert(ref != NULL);
+
+   mob = blDupePDB(ref);
+   blApplyMatrixPDB(mob, rot);
+   for(p=mob, j=0; p!=NULL; NEXT(p), j++)
+   {
+      p->x += 10.0 + 0.5 * sin((REAL)(j * 7));
+      p->y += 0.5 * cos((REAL)(j * 3));
+   }
+
+   /* CA: RMSD and coordinates as blFitCaPDB()                          */
+   target = blCreateFitTarget(ref, RMSD_ATOMS_CA);
+   ck_assert(target != NULL);
+   ck_assert(blFitTargetRMSD(target, mob, &rmsd, trm));
+
+   fitted = blDupePDB(mob);
+   ck_assert(blFitCaPDB(ref, fitted, rm));
+   SELECT(sel[0], "CA  ");
+   ca1 = blSelectAtomsPDBAsCopy(ref, 1, sel, &natoms);
+   ca2 = blSelectAtomsPDBAsCopy(fitted, 1, sel, &natoms);
+   free(sel[0]);
+   ck_assert(fabs(rmsd - blCalcRMSPDB(ca1, ca2)) < 1.0e-6);
+   for(i=0; i<3; i++)
+      for(j=0; j<3; j++)
+         ck_assert(fabs(rm[i][j] - trm[i][j]) < 1.0e-6);
+
+   ck_assert(blSuperposeOnFitTarget(target, mob, &rmsd2, NULL));
+   ck_assert(rmsd2 == rmsd);
+   for(p=mob, q=fitted; p!=NULL; NEXT(p), NEXT(q))
+      ck_assert(DIST(p, q) < 1.0e-6);
+
+   /* Coordinate arrays                                                 */
+   ncoor = blGetPDBCoor(ca2, &coor);
+   ck_assert(blFitTargetRMSDCoor(target, coor, ncoor, &rmsd2, NULL));
+   ck_assert(fabs(rmsd2 - rmsd) < 1.0e-6);
+   ck_assert(!blFitTargetRMSDCoor(target, coor, ncoor-1, &rmsd2, NULL));
+   free(coor);
+   blFreeFitTarget(target);
+   FREEPDBLIST(ca1);
+   FREEPDBLIST(ca2);
+
+   /* CA/CB weighted: the single pass must match fitting the centred
+      coordinates with the same weights
+   */
+   target = blCreateFitTarget(ref, RMSD_ATOMS_CACB);
+   ck_assert(target != NULL);
+   ck_assert(target->weights != NULL);
+   ck_assert(blFitTargetRMSD(target, mob, &rmsd, trm));
+
+   /* and the same weights and rotation as blFitCaCbPDB()               */
+   FREEPDBLIST(fitted);
+   fitted = blDupePDB(mob);
+   ck_assert(blFitCaCbPDB(ref, fitted, rm));
+   for(i=0; i<3; i++)
+      for(j=0; j<3; j++)
+         ck_assert(fabs(rm[i][j] - trm[i][j]) < 1.0e-6);
+
+   blOriginPDB(mob);
+   ncoor = blGetPDBCoor(mob, &coor);
+   ck_assert_int_eq(ncoor, target->ncoor);
+   ck_assert(fabs(blQCPrmsd(target->coor, coor, ncoor, target->weights) -
+                  rmsd) < 1.0e-6);
+   free(coor);
+   blFreeFitTarget(target);
+
+   FREEPDBLIST(ref);
+   FREEPDBLIST(mob);
+   FREEPDBLIST(fitted);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *fit_suite(void)
+{
+   Suite *s = suite_create("Fit");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             fit_setup, 
+                             fit_teardown);
+   tcase_add_test(tc_core, test_qcp_matfit);
+   tcase_add_test(tc_core, test_qcp_rmsd);
+   tcase_add_test(tc_core, test_qcp_degenerate);
+   tcase_add_test(tc_core, test_rmsd_matrix);
+   tcase_add_test(tc_core, test_fit_target);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
@@ -0,0 +1,197 @@
+/************************************************************************/
+/**
+
+   \file       hbond_suite.c
+   
+   \version    V1.1
+   \date       16.10.26
+   \brief      Test suite for H-bond network calculations.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blFindHBonds() and the sidechain iterators. The 
+   residue pairs found must be the same as those found by calling
+   blIsHBonded() for every pair. Iterators must be independent.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Uses crambin. Added test_hbond_iter
+
+*************************************************************************/
+
+#include "hbond_suite.h"
+
+/* Globals */
+static char test_input_filename[] = "data/hbond_suite/test_crambin.pdb",
+            pgp_filename[]        = "../../data/Explicit.pgp";
+static PDB *pdb = NULL;
+static int natoms;
+
+/* Setup And Teardown */
+static void hbond_setup(void)
+{
+   FILE *fp;
+   
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb != NULL, "Failed to read test file.");
+
+   fp = fopen(pgp_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open PGP file.");
+   ck_assert(blHAddPDB(fp, pdb) > 0);
+   fclose(fp);
+}
+
+static void hbond_teardown(void)
+{
+   if(pdb != NULL) FREEPDBLIST(pdb);
+}
+
+/* Core tests */
+START_TEST(test_hbond_pairs)
+{
+   HBONDPAIR *hbonds, *h;
+   PDB       *p, *q;
+   int       nhbonds, npairs = 0;
+   BOOL      found;
+
+   hbonds = blFindHBonds(pdb, HBOND_ANY, &nhbonds);
+   ck_assert(hbonds != NULL);
+   ck_assert(nhbonds > 0);
+
+   for(p=pdb; p!=NULL; p=blFindNextResidue(p))
+   {
+      for(q=blFindNextResidue(p); q!=NULL; q=blFindNextResidue(q))
+      {
+         found = FALSE;
+         for(h=hbonds; h!=NULL; NEXT(h))
+         {
+            ck_assert(h->donorRes != h->acceptorRes);
+            if(((h->donorRes == p) && (h->acceptorRes == q)) ||
+               ((h->donorRes == q) && (h->acceptorRes == p)))
+            {
+               ck_assert(blValidHBond(h->AtomH, h->AtomD, 
+                                      h->AtomA, h->AtomP));
+               found = TRUE;
+            }
+         }
+         ck_assert((blIsHBonded(p, q, HBOND_ANY) != 0) == found);
+         if(found)
+            npairs++;
+      }
+   }
+   ck_assert(npairs > 0);
+   FREELIST(hbonds, HBONDPAIR);
+}
+END_TEST
+
+START_TEST(test_hbond_type)
+{
+   HBONDPAIR *hbonds, *h;
+   int       nall, nbb, n = 0;
+
+   hbonds = blFindHBonds(pdb, HBOND_ANY, &nall);
+   for(h=hbonds; h!=NULL; NEXT(h))
+   {
+      if(h->type == HBOND_BB)
+         n++;
+   }
+   FREELIST(hbonds, HBONDPAIR);
+
+   hbonds = blFindHBonds(pdb, HBOND_BB, &nbb);
+   ck_assert_int_eq(nbb, n);
+   for(h=hbonds; h!=NULL; NEXT(h))
+      ck_assert_int_eq(h->type, HBOND_BB);
+   FREELIST(hbonds, HBONDPAIR);
+}
+END_TEST
+
+START_TEST(test_hbond_iter)
+{
+   HBONDITER iter1, iter2;
+   PDB       *res,
+             *AtomH1, *AtomD1, *AtomH2, *AtomD2;
+   BOOL      more1, more2;
+   int       ndonors = 0;
+
+   /* Two iterators stepping through the same residue at the same time
+      must give the same donors
+   */
+   for(res=pdb; res!=NULL; res=blFindNextResidue(res))
+   {
+      blResetHBondIter(&iter1);
+      blResetHBondIter(&iter2);
+      do
+      {
+         more1 = blNextSidechainHBDonor(&iter1, res, &AtomH1, &AtomD1);
+         more2 = blNextSidechainHBDonor(&iter2, res, &AtomH2, &AtomD2);
+         ck_assert(more1 == more2);
+         if(more1)
+         {
+            ck_assert(AtomH1 == AtomH2);
+            ck_assert(AtomD1 == AtomD2);
+            ndonors++;
+         }
+      }  while(more1);
+   }
+   ck_assert(ndonors > 0);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *hbond_suite(void)
+{
+   Suite *s = suite_create("HBond");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             hbond_setup, 
+                             hbond_teardown);
+   tcase_add_test(tc_core, test_hbond_pairs);
+   tcase_add_test(tc_core, test_hbond_type);
+   tcase_add_test(tc_core, test_hbond_iter);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
@@ -3,8 +3,8 @@
 
    \file       main.c
    
-   \version    V1.0
-   \date       05.08.14
+   \version    V1.15
+   \date       16.10.26
    \brief      Run test suites for BiopLib.
 
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
@@ -69,6 +69,21 @@
    =================
 
 -  V1.0  05.08.14 Original By: CTP
+-  V1.1  16.10.26 Added readpdbmapped_suite
+-  V1.2  16.10.26 Added modelreader_suite
+-  V1.3  16.10.26 Added bpdb_suite
+-  V1.4  16.10.26 Added pdbarena_suite
+-  V1.5  16.10.26 Added pdbcoords_suite
+-  V1.6  16.10.26 Added celllist_suite
+-  V1.7  16.10.26 Added access_suite
+-  V1.8  16.10.26 Added hbond_suite
+-  V1.9  16.10.26 Added fit_suite
+-  V1.10 16.10.26 Added align_suite
+-  V1.11 16.10.26 Added resindex_suite
+-  V1.12 16.10.26 Added pdbstruct_suite
+-  V1.13 16.10.26 Added atomselect_suite
+-  V1.14 16.10.26 Added pdbcodes_suite
+-  V1.15 16.10.26 Added pdblite_suite
 
 *************************************************************************/
 
@@ -84,6 +99,21 @@
 #include "readpdbml_suite.h"
 #include "writepdbml_suite.h"
 #include "wholepdb_suite.h"
+#include "readpdbmapped_suite.h"
+#include "modelreader_suite.h"
+#include "bpdb_suite.h"
+#include "pdbarena_suite.h"
+#include "pdbcoords_suite.h"
+#include "celllist_suite.h"
+#include "access_suite.h"
+#include "hbond_suite.h"
+#include "align_suite.h"
+#include "fit_suite.h"
+#include "resindex_suite.h"
+#include "pdbstruct_suite.h"
+#include "atomselect_suite.h"
+#include "pdbcodes_suite.h"
+#include "pdblite_suite.h"
 
 
 int main(int argc, char **argv)
@@ -106,6 +136,21 @@ int main(int argc, char **argv)
    srunner_add_suite(sr, readpdbml_suite());
    srunner_add_suite(sr, writepdbml_suite());
    srunner_add_suite(sr, wholepdb_suite());
+   srunner_add_suite(sr, readpdbmapped_suite());
+   srunner_add_suite(sr, modelreader_suite());
+   srunner_add_suite(sr, bpdb_suite());
+   srunner_add_suite(sr, pdbarena_suite());
+   srunner_add_suite(sr, pdbcoords_suite());
+   srunner_add_suite(sr, celllist_suite());
+   srunner_add_suite(sr, access_suite());
+   srunner_add_suite(sr, hbond_suite());
+   srunner_add_suite(sr, align_suite());
+   srunner_add_suite(sr, fit_suite());
+   srunner_add_suite(sr, resindex_suite());
+   srunner_add_suite(sr, pdbstruct_suite());
+   srunner_add_suite(sr, atomselect_suite());
+   srunner_add_suite(sr, pdbcodes_suite());
+   srunner_add_suite(sr, pdblite_suite());
                                                   /* add suites here... */
 
 
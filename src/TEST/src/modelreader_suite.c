@@ -0,0 +1,264 @@
+/************************************************************************/
+/**
+
+   \file       modelreader_suite.c
+   
+   \version    V1.1
+   \date       16.10.26
+   \brief      Test suite for the PDB model reader.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blOpenPDBModelReader(), blReadNextPDBModel() and
+   blClosePDBModelReader(), and for the model index used by 
+   blDoReadPDBIndexed(). Each model returned is compared with the
+   same model read by blDoReadPDB().
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Added model index tests
+
+*************************************************************************/
+
+#include "modelreader_suite.h"
+
+/* Globals */
+static char test_nmr_filename[]   = 
+               "data/modelreader_suite/test_nmr_3models.pdb",
+            test_gzip_filename[]  = "tmp/test_nmr_3models.pdb.gz",
+            test_index_filename[] = "tmp/test_nmr_3models.pdb.midx";
+static FILE           *fp          = NULL;
+static PDBMODELREADER *reader      = NULL;
+static PDBMODELINDEX  *model_index = NULL;
+
+/* Setup And Teardown */
+static void modelreader_setup(void)
+{
+   fp          = NULL;
+   reader      = NULL;
+   model_index = NULL;
+}
+
+static void modelreader_teardown(void)
+{
+   if(reader      != NULL) blClosePDBModelReader(reader);
+   if(model_index != NULL) blFreePDBModelIndex(model_index);
+   if(fp          != NULL) fclose(fp);
+}
+
+/* Check each model against blDoReadPDB()                               */
+static int check_models(char *filename, BOOL AllAtoms)
+{
+   PDB  *pdb, *ref, *p, *q;
+   FILE *fpref;
+   int  natoms, natoms_ref,
+        nmodels = 0;
+   
+   fp = fopen(filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   reader = blOpenPDBModelReader(fp, AllAtoms, 1);
+   ck_assert_msg(reader != NULL, "Failed to open model reader.");
+
+   while((pdb = blReadNextPDBModel(reader, &natoms)) != NULL)
+   {
+      nmodels++;
+      ck_assert_int_eq(reader->ModelNum, nmodels);
+
+      fpref = fopen(filename, "r");
+      ref   = blDoReadPDB(fpref, &natoms_ref, AllAtoms, 1, nmodels);
+      fclose(fpref);
+      
+      ck_assert_int_eq(natoms, natoms_ref);
+      for(p=pdb, q=ref; p!=NULL && q!=NULL; NEXT(p), NEXT(q))
+      {
+         ck_assert_str_eq(p->atnam,  q->atnam);
+         ck_assert_int_eq(p->atnum,  q->atnum);
+         ck_assert(p->x == q->x);
+         ck_assert(p->y == q->y);
+         ck_assert(p->z == q->z);
+      }
+      ck_assert(p == NULL);
+      ck_assert(q == NULL);
+
+      FREELIST(pdb, PDB);
+      FREELIST(ref, PDB);
+   }
+   ck_assert_int_eq(natoms, 0);
+
+   return(nmodels);
+}
+
+/* Check each indexed model against blDoReadPDB()                       */
+static void check_indexed_models(char *filename)
+{
+   PDB  *pdb, *ref, *p, *q;
+   FILE *fpref;
+   int  natoms, natoms_ref, model;
+   
+   fp = fopen(filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+
+   /* Go one past the end which should give an empty list               */
+   for(model=1; model<=model_index->nmodels+1; model++)
+   {
+      pdb   = blDoReadPDBIndexed(fp, model_index, &natoms, TRUE, 1, model);
+      fpref = fopen(filename, "r");
+      ref   = blDoReadPDB(fpref, &natoms_ref, TRUE, 1, model);
+      fclose(fpref);
+      
+      ck_assert_int_eq(natoms, natoms_ref);
+      for(p=pdb, q=ref; p!=NULL && q!=NULL; NEXT(p), NEXT(q))
+      {
+         ck_assert_str_eq(p->atnam,  q->atnam);
+         ck_assert(p->x == q->x);
+      }
+      ck_assert(p == NULL);
+      ck_assert(q == NULL);
+
+      FREELIST(pdb, PDB);
+      FREELIST(ref, PDB);
+   }
+}
+
+/* Core tests */
+START_TEST(test_models_01)
+{
+   ck_assert_int_eq(check_models(test_nmr_filename, TRUE), 3);
+   ck_assert(gPDBMultiNMR);
+}
+END_TEST
+
+START_TEST(test_models_02)
+{
+   ck_assert_int_eq(check_models(test_nmr_filename, FALSE), 3);
+}
+END_TEST
+
+START_TEST(test_models_03)
+{
+   /* A file without MODEL records is a single model                    */
+   ck_assert_int_eq(check_models("data/test-deca-ala-01.pdb", TRUE), 1);
+   ck_assert(!gPDBMultiNMR);
+}
+END_TEST
+
+START_TEST(test_models_gzip)
+{
+   char buffer[160];
+   FILE *fpin, *fpout;
+   int  nmodels;
+   
+   /* Write a gzipped copy of the test file                             */
+   fpin  = fopen(test_nmr_filename, "r");
+   ck_assert_msg(fpin != NULL, "Failed to open test file.");
+   fpout = blOpenOrPipe(test_gzip_filename);
+   ck_assert_msg(fpout != NULL, "Failed to open gzip file.");
+   while(fgets(buffer, 160, fpin))
+      fputs(buffer, fpout);
+   fclose(fpin);
+   blCloseOrPipe(fpout);
+   
+   nmodels = check_models(test_gzip_filename, TRUE);
+   remove(test_gzip_filename);
+   ck_assert_int_eq(nmodels, 3);
+}
+END_TEST
+
+START_TEST(test_index_01)
+{
+   FILE *fpidx;
+   
+   fpidx = fopen(test_nmr_filename, "r");
+   ck_assert_msg(fpidx != NULL, "Failed to open test file.");
+   model_index = blBuildPDBModelIndex(fpidx);
+   fclose(fpidx);
+   ck_assert_msg(model_index != NULL, "Failed to build index.");
+   ck_assert_int_eq(model_index->nmodels, 3);
+   check_indexed_models(test_nmr_filename);
+}
+END_TEST
+
+START_TEST(test_index_02)
+{
+   FILE *fpidx;
+   
+   /* Save the model_index, read it back and use that                         */
+   fpidx = fopen(test_nmr_filename, "r");
+   ck_assert_msg(fpidx != NULL, "Failed to open test file.");
+   model_index = blBuildPDBModelIndex(fpidx);
+   fclose(fpidx);
+   ck_assert_msg(model_index != NULL, "Failed to build index.");
+
+   fpidx = fopen(test_index_filename, "w");
+   ck_assert(blWritePDBModelIndex(fpidx, model_index));
+   fclose(fpidx);
+   blFreePDBModelIndex(model_index);
+
+   fpidx = fopen(test_index_filename, "r");
+   model_index = blReadPDBModelIndex(fpidx);
+   fclose(fpidx);
+   remove(test_index_filename);
+   ck_assert_msg(model_index != NULL, "Failed to read index.");
+   ck_assert_int_eq(model_index->nmodels, 3);
+   check_indexed_models(test_nmr_filename);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *modelreader_suite(void)
+{
+   Suite *s = suite_create("ModelReader");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             modelreader_setup, 
+                             modelreader_teardown);
+   tcase_add_test(tc_core, test_models_01);
+   tcase_add_test(tc_core, test_models_02);
+   tcase_add_test(tc_core, test_models_03);
+   tcase_add_test(tc_core, test_models_gzip);
+   tcase_add_test(tc_core, test_index_01);
+   tcase_add_test(tc_core, test_index_02);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
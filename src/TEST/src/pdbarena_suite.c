@@ -0,0 +1,321 @@
+/************************************************************************/
+/**
+
+   \file       pdbarena_suite.c
+   
+   \version    V1.2
+   \date       16.10.26
+   \brief      Test suite for PDB arena allocation.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blNewPDBArena(), blAllocPDB(), blFreePDB() and
+   blFreePDBArena(). A file is read with and without an arena and the
+   lists compared; nodes are then deleted with blKillPDB() and the arena
+   freed. Several threads then each read into their own arena at the
+   same time. Hydrogens are added with an arena current.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Added test_arena_04 for arenas in several threads
+-  V1.2  16.10.26 Added test_arena_05 for blHAddPDB() with an arena
+
+*************************************************************************/
+
+#include "pdbarena_suite.h"
+
+/* Defines */
+#define NTHREADS 4
+
+/* Globals */
+static char test_input_filename[] = 
+               "data/wholepdb_suite/test_alanine_in.pdb";
+static char hadd_input_filename[] = "data/hbond_suite/test_crambin.pdb",
+            pgp_filename[]        = "../../data/Explicit.pgp";
+static PDB      *pdb_ref = NULL;
+static PDBARENA *arena   = NULL;
+static int      natoms_ref;
+
+/* Setup And Teardown */
+static void pdbarena_setup(void)
+{
+   FILE *fp;
+   
+   arena = NULL;
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb_ref = blReadPDB(fp, &natoms_ref);
+   fclose(fp);
+   ck_assert_msg(pdb_ref != NULL, "Failed to read test file.");
+}
+
+static void pdbarena_teardown(void)
+{
+   blUsePDBArena(NULL);
+   if(pdb_ref != NULL) FREEPDBLIST(pdb_ref);
+   if(arena   != NULL) blFreePDBArena(arena);
+}
+
+/* Read the test file into the arena                                    */
+static PDB *read_into_arena(int *natoms)
+{
+   FILE     *fp;
+   PDB      *pdb;
+   PDBARENA *old;
+   
+   fp  = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   old = blUsePDBArena(arena);
+   pdb = blReadPDB(fp, natoms);
+   blUsePDBArena(old);
+   fclose(fp);
+   return(pdb);
+}
+
+/* Read the test file into a new arena in a thread, returning NULL if
+   the thread sees a current arena it did not set or the list is wrong
+*/
+static void *read_in_thread(void *arg)
+{
+   PDBARENA *myarena;
+   PDB      *pdb, *p;
+   FILE     *fp;
+   int      natoms, i;
+   void     *ok = arg;
+
+   for(i=0; (i<20) && (ok!=NULL); i++)
+   {
+      if((gPDBArena != NULL) || 
+         ((myarena = blNewPDBArena(2)) == NULL))
+         return(NULL);
+      if((fp = fopen(test_input_filename, "r")) == NULL)
+         return(NULL);
+      blUsePDBArena(myarena);
+      pdb = blReadPDB(fp, &natoms);
+      blUsePDBArena(NULL);
+      fclose(fp);
+
+      if((pdb == NULL) || (natoms != natoms_ref) || 
+         (myarena->nnodes != natoms))
+         ok = NULL;
+      for(p=pdb; p!=NULL; NEXT(p))
+      {
+         if(!blPDBInArena(p))
+            ok = NULL;
+      }
+      pdb = blKillPDB(pdb, NULL);
+      FREEPDBLIST(pdb);
+      if(myarena->nnodes != 0)
+         ok = NULL;
+      blFreePDBArena(myarena);
+   }
+   return(ok);
+}
+
+/* Core tests */
+START_TEST(test_arena_01)
+{
+   PDB *pdb, *p, *q;
+   int natoms;
+
+   /* A small slab size so that several slabs are needed               */
+   arena = blNewPDBArena(3);
+   ck_assert(arena != NULL);
+   pdb = read_into_arena(&natoms);
+   ck_assert_msg(pdb != NULL, "Failed to read into arena.");
+   ck_assert_int_eq(natoms, natoms_ref);
+   ck_assert_int_eq(arena->nnodes, natoms);
+
+   for(p=pdb, q=pdb_ref; p!=NULL && q!=NULL; NEXT(p), NEXT(q))
+   {
+      ck_assert(blPDBInArena(p));
+      ck_assert(!blPDBInArena(q));
+      ck_assert_str_eq(p->atnam, q->atnam);
+      ck_assert_int_eq(p->resnum, q->resnum);
+      ck_assert(p->x == q->x);
+   }
+   ck_assert(p == NULL);
+   ck_assert(q == NULL);
+
+   /* Consecutive atoms within a slab are contiguous                    */
+   ck_assert(pdb->next == pdb + 1);
+}
+END_TEST
+
+START_TEST(test_arena_02)
+{
+   PDB *pdb, *p, *next;
+   int natoms;
+
+   arena = blNewPDBArena(0);
+   pdb   = read_into_arena(&natoms);
+   ck_assert_msg(pdb != NULL, "Failed to read into arena.");
+
+   /* Kill the second atom and the head of the list                     */
+   next = blKillPDB(pdb->next, pdb);
+   ck_assert(pdb->next == next);
+   pdb  = blKillPDB(pdb, NULL);
+   ck_assert_int_eq(arena->nnodes, natoms - 2);
+   
+   /* Killed nodes are re-used                                          */
+   blUsePDBArena(arena);
+   p = blAllocPDB();
+   blUsePDBArena(NULL);
+   ck_assert(blPDBInArena(p));
+   ck_assert(p->next == NULL);
+   ck_assert_int_eq(arena->nnodes, natoms - 1);
+
+   /* A list mixing malloc()'d and arena nodes                          */
+   p->next = blAllocPDB();
+   ck_assert(!blPDBInArena(p->next));
+   p->next->next = pdb;
+   blFreePDB(p);
+   ck_assert_int_eq(arena->nnodes, 0);
+}
+END_TEST
+
+START_TEST(test_arena_03)
+{
+   PDB *pdb;
+   int natoms;
+
+   arena = blNewPDBArena(0);
+   pdb   = read_into_arena(&natoms);
+   ck_assert_msg(pdb != NULL, "Failed to read into arena.");
+
+   blResetPDBArena(arena);
+   ck_assert_int_eq(arena->nnodes, 0);
+   pdb   = read_into_arena(&natoms);
+   ck_assert(pdb != NULL);
+   ck_assert_int_eq(arena->nnodes, natoms);
+
+   /* Freeing the arena frees the list                                  */
+   blFreePDBArena(arena);
+   arena = NULL;
+   ck_assert(!blPDBInArena(pdb));
+}
+END_TEST
+
+START_TEST(test_arena_04)
+{
+   pthread_t threads[NTHREADS];
+   void      *result;
+   int       i;
+
+   /* The current arena belongs to this thread only                     */
+   arena = blNewPDBArena(0);
+   blUsePDBArena(arena);
+   for(i=0; i<NTHREADS; i++)
+      ck_assert_int_eq(pthread_create(&threads[i], NULL, read_in_thread, 
+                                      (void *)&threads[i]), 0);
+   for(i=0; i<NTHREADS; i++)
+   {
+      ck_assert_int_eq(pthread_join(threads[i], &result), 0);
+      ck_assert(result != NULL);
+   }
+   ck_assert(gPDBArena == arena);
+   blUsePDBArena(NULL);
+}
+END_TEST
+
+/* Strip and add hydrogens to crambin, returning the number added       */
+static int add_hydrogens(PDB **pdb)
+{
+   FILE *fp;
+   PDB  *pdbH;
+   int  natoms, nhyd;
+
+   fp    = fopen(hadd_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open crambin file.");
+   pdbH  = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert(pdbH != NULL);
+   *pdb  = blStripHPDBAsCopy(pdbH, &natoms);
+   FREEPDBLIST(pdbH);
+   ck_assert(*pdb != NULL);
+
+   fp    = fopen(pgp_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open PGP file.");
+   nhyd  = blHAddPDB(fp, *pdb);
+   fclose(fp);
+   return(nhyd);
+}
+
+START_TEST(test_arena_05)
+{
+   PDB *pdb, *pdbArena;
+   int nhyd, nhydArena;
+
+   /* The N-terminal N has no planar H, so makeh() frees its list       */
+   nhyd      = add_hydrogens(&pdb);
+   ck_assert(nhyd > 0);
+
+   arena     = blNewPDBArena(0);
+   blUsePDBArena(arena);
+   nhydArena = add_hydrogens(&pdbArena);
+   blUsePDBArena(NULL);
+   ck_assert_int_eq(nhydArena, nhyd);
+   ck_assert(blPDBInArena(pdbArena));
+
+   FREEPDBLIST(pdbArena);
+   FREEPDBLIST(pdb);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *pdbarena_suite(void)
+{
+   Suite *s = suite_create("PDBArena");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             pdbarena_setup, 
+                             pdbarena_teardown);
+   tcase_add_test(tc_core, test_arena_01);
+   tcase_add_test(tc_core, test_arena_02);
+   tcase_add_test(tc_core, test_arena_03);
+   tcase_add_test(tc_core, test_arena_04);
+   tcase_add_test(tc_core, test_arena_05);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
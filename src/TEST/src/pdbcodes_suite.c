@@ -0,0 +1,196 @@
+/************************************************************************/
+/**
+
+   \file       pdbcodes_suite.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Test suite for the PDB codes.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for the interned residue, atom and element codes set by
+   the PDB reader and used by ISWATER(), blThrone() and the
+   ...CODEMATCH() macros.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+
+#include "pdbcodes_suite.h"
+
+/* Globals */
+static char test_input_filename[] = "data/hbond_suite/test_crambin.pdb";
+static PDB  *pdb   = NULL;
+static int  natoms;
+
+/* Setup And Teardown */
+static void pdbcodes_setup(void)
+{
+   FILE *fp;
+   
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb != NULL, "Failed to read test file.");
+}
+
+static void pdbcodes_teardown(void)
+{
+   if(pdb != NULL) FREELIST(pdb, PDB);
+}
+
+/* Core tests */
+START_TEST(test_pdbcodes_01)
+{
+   char *name;
+   int  code;
+
+   /* Every name in each table maps back to its own code, which also 
+      checks that the tables are sorted for the binary search
+   */
+   for(code=1; (name=blResCodeName(code))!=NULL; code++)
+      ck_assert_int_eq(blGetResCode(name), code);
+   ck_assert_int_gt(code, PDBRES_WAT);
+   for(code=1; (name=blAtomCodeName(code))!=NULL; code++)
+      ck_assert_int_eq(blGetAtomCode(name), code);
+   ck_assert_int_gt(code, PDBATOM_HA);
+   for(code=1; (name=blElementCodeName(code))!=NULL; code++)
+      ck_assert_int_eq(blGetElementCode(name), code);
+   ck_assert_int_eq(code, 119);
+
+   ck_assert(blResCodeName(0)     == NULL);
+   ck_assert(blAtomCodeName(-1)   == NULL);
+
+   /* Names that are not in the tables                                  */
+   ck_assert_int_eq(blGetResCode("XYZ"),    PDBCODE_OTHER);
+   ck_assert_int_eq(blGetResCode("AL"),     PDBCODE_OTHER);
+   ck_assert_int_eq(blGetAtomCode("CA"),    PDBCODE_OTHER);
+   ck_assert_int_eq(blGetAtomCode("QQ  "),  PDBCODE_OTHER);
+   ck_assert_int_eq(blGetElementCode("Xx"), PDBCODE_OTHER);
+   ck_assert_int_eq(blGetElementCode("  "), PDBCODE_OTHER);
+
+   /* Residue names only use the first 3 characters, atom names 4 and
+      elements are not case sensitive
+   */
+   ck_assert_int_eq(blGetResCode("ALA "),   PDBRES_ALA);
+   ck_assert_int_eq(blGetAtomCode("CA  X"), PDBATOM_CA);
+   ck_assert_int_eq(blGetElementCode(" C"), PDBELEM_C);
+   ck_assert_int_eq(blGetElementCode("s"),  PDBELEM_S);
+   ck_assert_int_eq(blGetElementCode("Fe"), 26);
+}
+END_TEST
+
+START_TEST(test_pdbcodes_02)
+{
+   PDB  *p;
+   PDB  copy;
+   int  n = 0;
+
+   /* The reader sets the codes from the strings                        */
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      copy = *p;
+      blSetPDBCodes(&copy);
+      ck_assert_int_eq(p->rescode,  copy.rescode);
+      ck_assert_int_eq(p->atcode,   copy.atcode);
+      ck_assert_int_eq(p->elemcode, copy.elemcode);
+      ck_assert_int_ne(p->rescode,  PDBCODE_UNSET);
+      ck_assert_int_ne(p->atcode,   PDBCODE_UNSET);
+      ck_assert_int_ne(p->elemcode, PDBCODE_UNSET);
+      
+      ck_assert_int_eq(ATNAMCODEMATCH(p, PDBATOM_CA, "CA  "),
+                       !strncmp(p->atnam, "CA  ", 4));
+      ck_assert_int_eq(RESNAMCODEMATCH(p, PDBRES_PRO, "PRO"),
+                       !strncmp(p->resnam, "PRO", 3));
+      if(p->atcode == PDBATOM_CA)
+         n++;
+   }
+   ck_assert_int_eq(n, 46);
+   ck_assert_int_eq(pdb->rescode,  PDBRES_THR);
+   ck_assert_int_eq(pdb->atcode,   PDBATOM_N);
+   ck_assert_int_eq(pdb->elemcode, PDBELEM_N);
+   ck_assert_int_eq(blThrone(pdb->resnam), 'T');
+}
+END_TEST
+
+START_TEST(test_pdbcodes_03)
+{
+   PDB *p = pdb;
+
+   /* ISWATER() uses the code if set and the string if not              */
+   ck_assert(!ISWATER(p));
+   strcpy(p->resnam, "WAT");
+   ck_assert(!ISWATER(p));
+   blSetPDBCodes(p);
+   ck_assert(ISWATER(p));
+   p->rescode = PDBCODE_UNSET;
+   ck_assert(ISWATER(p));
+   strcpy(p->resnam, "DOD");
+   ck_assert(ISWATER(p));
+
+   /* Renaming a residue updates the code                               */
+   blSetPDBCodes(p);
+   blSetResnam(pdb, blFindNextResidue(pdb), "ALA", 1, " ", "A");
+   ck_assert_int_eq(pdb->rescode, PDBRES_ALA);
+   ck_assert(!ISWATER(pdb));
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *pdbcodes_suite(void)
+{
+   Suite *s = suite_create("PDBCodes");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             pdbcodes_setup, 
+                             pdbcodes_teardown);
+   tcase_add_test(tc_core, test_pdbcodes_01);
+   tcase_add_test(tc_core, test_pdbcodes_02);
+   tcase_add_test(tc_core, test_pdbcodes_03);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
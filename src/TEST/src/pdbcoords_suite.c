@@ -0,0 +1,187 @@
+/************************************************************************/
+/**
+
+   \file       pdbcoords_suite.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Test suite for PDB coordinate views.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blGetPDBCoords() and the geometry routines that work
+   on a PDBCOORDS view. Results are compared with the equivalent
+   routines working on the PDB linked list.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+
+#include "pdbcoords_suite.h"
+
+/* Globals */
+static char test_input_filename[] = 
+               "data/wholepdb_suite/test_alanine_in.pdb";
+static PDB       *pdb1    = NULL,
+                 *pdb2    = NULL;
+static PDBCOORDS *coords1 = NULL,
+                 *coords2 = NULL;
+static int       natoms;
+static REAL      matrix[3][3] = {{ 0.36, 0.48, -0.80},
+                                 {-0.80, 0.60,  0.00},
+                                 { 0.48, 0.64,  0.60}};
+
+/* Setup And Teardown */
+static void pdbcoords_setup(void)
+{
+   FILE *fp;
+   
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb1 = blReadPDB(fp, &natoms);
+   rewind(fp);
+   pdb2 = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb1 != NULL && pdb2 != NULL, "Failed to read file.");
+   coords1 = blGetPDBCoords(pdb1);
+   coords2 = NULL;
+   ck_assert_msg(coords1 != NULL, "Failed to create view.");
+}
+
+static void pdbcoords_teardown(void)
+{
+   if(coords1 != NULL) blFreePDBCoords(coords1);
+   if(coords2 != NULL) blFreePDBCoords(coords2);
+   if(pdb1    != NULL) FREELIST(pdb1, PDB);
+   if(pdb2    != NULL) FREELIST(pdb2, PDB);
+}
+
+/* Check the view and list hold exactly the same coordinates            */
+static void compare_coords(PDBCOORDS *coords, PDB *pdb)
+{
+   PDB *p;
+   int i;
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      ck_assert(coords->x[i] == p->x);
+      ck_assert(coords->y[i] == p->y);
+      ck_assert(coords->z[i] == p->z);
+   }
+   ck_assert_int_eq(i, coords->natoms);
+}
+
+/* Core tests */
+START_TEST(test_coords_01)
+{
+   ck_assert_int_eq(coords1->natoms, natoms);
+   ck_assert(coords1->atom[0] == pdb1);
+   ck_assert(coords1->atom[1] == pdb1->next);
+   compare_coords(coords1, pdb1);
+}
+END_TEST
+
+START_TEST(test_coords_02)
+{
+   VEC3F cg1, 
+         cg2,
+         shift = {1.5, -2.0, 0.25};
+
+   blGetCofGPDBCoords(coords1, &cg1);
+   blGetCofGPDB(pdb2, &cg2);
+   ck_assert(cg1.x == cg2.x);
+   ck_assert(cg1.y == cg2.y);
+   ck_assert(cg1.z == cg2.z);
+
+   blRotatePDBCoords(coords1, matrix);
+   blRotatePDB(pdb2, matrix);
+   compare_coords(coords1, pdb2);
+
+   blTranslatePDBCoords(coords1, shift);
+   blTranslatePDB(pdb2, shift);
+   compare_coords(coords1, pdb2);
+
+   /* The list is only changed when the view is written back            */
+   ck_assert(pdb1->x != pdb2->x);
+   blPutPDBCoords(coords1);
+   compare_coords(coords1, pdb1);
+}
+END_TEST
+
+START_TEST(test_coords_03)
+{
+   REAL rms;
+   
+   blApplyMatrixPDB(pdb2, matrix);
+   coords2 = blGetPDBCoords(pdb2);
+   ck_assert_msg(coords2 != NULL, "Failed to create view.");
+   
+   rms = blCalcRMSPDBCoords(coords1, coords2);
+   ck_assert(rms == blCalcRMSPDB(pdb1, pdb2));
+   ck_assert(blCalcRMSPDBCoords(coords1, coords1) == 0.0);
+   ck_assert(blDistPDBCoords(coords1, 0, coords1, 1) == DIST(pdb1, 
+                                                             pdb1->next));
+
+   /* Refreshing picks up changes to the list                           */
+   blApplyMatrixPDB(pdb1, matrix);
+   blRefreshPDBCoords(coords1);
+   ck_assert(blCalcRMSPDBCoords(coords1, coords2) == 0.0);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *pdbcoords_suite(void)
+{
+   Suite *s = suite_create("PDBCoords");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             pdbcoords_setup, 
+                             pdbcoords_teardown);
+   tcase_add_test(tc_core, test_coords_01);
+   tcase_add_test(tc_core, test_coords_02);
+   tcase_add_test(tc_core, test_coords_03);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
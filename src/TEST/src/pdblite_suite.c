@@ -0,0 +1,262 @@
+/************************************************************************/
+/**
+
+   \file       pdblite_suite.c
+   
+   \version    V1.1
+   \date       16.10.26
+   \brief      Test suite for the compact atom table.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for PDBLITE. Linked lists converted to and from a PDBLITE
+   and PDBLITEs read directly from files are compared with the linked
+   lists read by blDoReadPDB().
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Test more than 256 chain labels
+
+*************************************************************************/
+
+#include "pdblite_suite.h"
+
+/* Globals */
+static char test_input_filename[] = "data/hbond_suite/test_crambin.pdb";
+static char test_alt_filename[]   = 
+   "data/readpdbml_suite/test_alpha_carbon_alt_01.pdb";
+static char test_xml_filename[]   = 
+   "data/readpdbml_suite/test_alpha_carbon_alt_01.xml";
+static PDB     *pdb  = NULL;
+static PDBLITE *lite = NULL;
+static int     natoms;
+
+/* Setup And Teardown */
+static void pdblite_setup(void)
+{
+   FILE *fp;
+   
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb = blDoReadPDB(fp, &natoms, TRUE, 1, 1);
+   fclose(fp);
+   ck_assert_msg(pdb != NULL, "Failed to read test file.");
+   lite = NULL;
+}
+
+static void pdblite_teardown(void)
+{
+   if(lite != NULL) blFreePDBLite(lite);
+   if(pdb  != NULL) FREELIST(pdb, PDB);
+}
+
+/* Check a PDBLITE has the same atoms as a linked list                  */
+static void check_same_atoms(PDBLITE *l, PDB *q)
+{
+   PDB p;
+   int i;
+
+   for(i=0; i<l->natoms && q!=NULL; i++, NEXT(q))
+   {
+      blGetPDBLiteAtom(l, i, &p);
+      ck_assert_int_eq(p.atnum,  q->atnum);
+      ck_assert_int_eq(p.resnum, q->resnum);
+      ck_assert(p.x == q->x && p.y == q->y && p.z == q->z);
+      ck_assert(fabs(p.occ  - q->occ)  < 0.0001);
+      ck_assert(fabs(p.bval - q->bval) < 0.0001);
+      ck_assert_int_eq(p.altpos,        q->altpos);
+      ck_assert_int_eq(p.formal_charge, q->formal_charge);
+      ck_assert_int_eq(p.rescode,       q->rescode);
+      ck_assert_int_eq(p.atcode,        q->atcode);
+      ck_assert_int_eq(p.elemcode,      q->elemcode);
+      ck_assert_str_eq(p.record_type,   q->record_type);
+      ck_assert_str_eq(p.atnam,         q->atnam);
+      ck_assert_str_eq(p.atnam_raw,     q->atnam_raw);
+      ck_assert_str_eq(p.resnam,        q->resnam);
+      ck_assert_str_eq(p.chain,         q->chain);
+      ck_assert_str_eq(p.insert,        q->insert);
+      ck_assert_str_eq(p.element,       q->element);
+   }
+   ck_assert_int_eq(i, l->natoms);
+   ck_assert(q == NULL);
+}
+
+/* Core tests */
+START_TEST(test_pdblite_01)
+{
+   PDB *pdb2;
+   int natoms2;
+
+   ck_assert(sizeof(PDBLITEATOM) <= 40);
+
+   /* PDB -> PDBLITE -> PDB                                             */
+   lite = blPDBToPDBLite(pdb);
+   ck_assert_msg(lite != NULL, "Failed to convert to PDBLITE.");
+   ck_assert_int_eq(lite->natoms,  natoms);
+   ck_assert_int_eq(lite->nchains, 1);
+   check_same_atoms(lite, pdb);
+
+   pdb2 = blPDBLiteToPDB(lite, &natoms2);
+   ck_assert_int_eq(natoms2, natoms);
+   check_same_atoms(lite, pdb2);
+   FREELIST(pdb2, PDB);
+}
+END_TEST
+
+START_TEST(test_pdblite_02)
+{
+   PDBLITE *lite2;
+   PDB     *pdb2;
+   FILE    *fp;
+   int     natoms2;
+
+   /* Read directly, with and without the memory map                    */
+   fp = fopen(test_input_filename, "r");
+   lite = blReadPDBLite(fp);
+   fclose(fp);
+   ck_assert_msg(lite != NULL, "Failed to read PDBLITE.");
+   ck_assert_int_eq(lite->maxatoms, lite->natoms);
+   check_same_atoms(lite, pdb);
+   blFreePDBLite(lite);
+   
+   lite = blReadPDBLiteMapped(test_input_filename);
+   ck_assert_msg(lite != NULL, "Failed to read mapped PDBLITE.");
+   check_same_atoms(lite, pdb);
+   blFreePDBLite(lite);
+   lite = NULL;
+
+   /* Partial occupancy atoms                                           */
+   fp = fopen(test_alt_filename, "r");
+   pdb2 = blDoReadPDB(fp, &natoms2, TRUE, 2, 1);
+   rewind(fp);
+   lite = blDoReadPDBLite(fp, TRUE, 2, 1);
+   fclose(fp);
+   ck_assert(lite != NULL && pdb2 != NULL);
+   ck_assert_int_eq(lite->natoms, 1);
+   ck_assert(lite->x[0] == 4.0);
+   check_same_atoms(lite, pdb2);
+   blFreePDBLite(lite);
+
+   lite2 = blDoReadPDBLiteMapped(test_alt_filename, TRUE, 2, 1);
+   ck_assert(lite2 != NULL);
+   check_same_atoms(lite2, pdb2);
+   blFreePDBLite(lite2);
+   FREELIST(pdb2, PDB);
+
+   /* PDBML goes via a linked list                                      */
+   fp = fopen(test_xml_filename, "r");
+   pdb2 = blDoReadPDB(fp, &natoms2, TRUE, 1, 1);
+   rewind(fp);
+   lite = blDoReadPDBLite(fp, TRUE, 1, 1);
+   fclose(fp);
+   ck_assert(lite != NULL && pdb2 != NULL);
+   check_same_atoms(lite, pdb2);
+   FREELIST(pdb2, PDB);
+}
+END_TEST
+
+START_TEST(test_pdblite_03)
+{
+   PDB  *p;
+   char label[16];
+   int  i;
+
+   lite = blAllocPDBLite(1);
+   ck_assert(lite != NULL);
+
+   /* Chain labels of more than one character                           */
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      sprintf(p->chain, "%c%c", 'A' + (i/100), 'a' + (i%3));
+      ck_assert(blAppendPDBLite(lite, p));
+   }
+   ck_assert(lite->maxatoms >= natoms);
+   check_same_atoms(lite, pdb);
+   ck_assert_str_eq(PDBLITE_CHAIN(lite, 0),   "Aa");
+   ck_assert_str_eq(PDBLITE_CHAIN(lite, 101), "Bc");
+   ck_assert(lite->nchains == 3 * ((natoms+99)/100));
+
+   /* Release the unused space                                          */
+   ck_assert(blResizePDBLite(lite, 0));
+   ck_assert_int_eq(lite->maxatoms, natoms);
+   check_same_atoms(lite, pdb);
+
+   /* Names that do not fit                                             */
+   strcpy(pdb->resnam, "ABCDE");
+   ck_assert(!blAppendPDBLite(lite, pdb));
+   strcpy(pdb->resnam, "ALA");
+   strcpy(pdb->insert, "AB");
+   ck_assert(!blAppendPDBLite(lite, pdb));
+   strcpy(pdb->insert, " ");
+
+   /* More chain labels than fit in a byte                              */
+   for(i=lite->nchains; i<1000; i++)
+   {
+      sprintf(label, "X%d", i);
+      strncpy(pdb->chain, label, 7);
+      ck_assert(blAppendPDBLite(lite, pdb));
+   }
+   ck_assert_int_eq(lite->nchains, 1000);
+   ck_assert_str_eq(PDBLITE_CHAIN(lite, lite->natoms-1), "X999");
+   strcpy(pdb->chain, "Aa");
+   ck_assert(blAppendPDBLite(lite, pdb));
+   ck_assert_int_eq(lite->nchains, 1000);
+   ck_assert_str_eq(PDBLITE_CHAIN(lite, lite->natoms-1), "Aa");
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *pdblite_suite(void)
+{
+   Suite *s = suite_create("PDBLite");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             pdblite_setup, 
+                             pdblite_teardown);
+   tcase_add_test(tc_core, test_pdblite_01);
+   tcase_add_test(tc_core, test_pdblite_02);
+   tcase_add_test(tc_core, test_pdblite_03);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
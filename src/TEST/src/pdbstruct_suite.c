@@ -0,0 +1,205 @@
+/************************************************************************/
+/**
+
+   \file       pdbstruct_suite.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Test suite for PDBSTRUCT hierarchies.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blAllocPDBStructureArray(). The array-backed structure
+   is compared with the linked list version from blAllocPDBStructure().
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+
+#include "pdbstruct_suite.h"
+
+/* Globals */
+static char test_input_filename[] = "data/test-deca-ala-01.pdb";
+static PDB       *pdb    = NULL;
+static PDBSTRUCT *lstruct = NULL,
+                 *astruct = NULL;
+static int       natoms;
+
+/* Setup And Teardown */
+static void pdbstruct_setup(void)
+{
+   FILE *fp;
+   
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb != NULL, "Failed to read test file.");
+   lstruct = astruct = NULL;
+}
+
+static void pdbstruct_teardown(void)
+{
+   if(lstruct != NULL) blFreePDBStructure(lstruct);
+   if(astruct != NULL) blFreePDBStructure(astruct);
+   if(pdb     != NULL) FREELIST(pdb, PDB);
+}
+
+/* Check the array-backed structure matches the linked version          */
+static void check_same_structure(void)
+{
+   PDBCHAIN   *lchain, *achain;
+   PDBRESIDUE *lres,   *ares;
+   PDB        *p;
+   int        k, i, r, a;
+
+   lstruct = blAllocPDBStructure(pdb);
+   astruct = blAllocPDBStructureArray(pdb);
+   ck_assert_msg(lstruct != NULL, "Failed to build linked PDBSTRUCT.");
+   ck_assert_msg(astruct != NULL, "Failed to build array PDBSTRUCT.");
+   ck_assert(astruct->pdb == pdb);
+
+   /* Atoms                                                             */
+   for(p=pdb, a=0; p!=NULL; NEXT(p), a++)
+      ck_assert(astruct->atoms[a] == p);
+   ck_assert_int_eq(astruct->natoms, a);
+
+   /* Walk both as linked lists and check the array indexes             */
+   for(lchain=lstruct->chains, achain=astruct->chains, k=0, r=0;
+       lchain!=NULL && achain!=NULL;
+       NEXT(lchain), NEXT(achain), k++)
+   {
+      ck_assert(achain == PDBSTRUCT_CHAIN(astruct, k));
+      ck_assert(achain->prev == ((k==0) ? NULL : achain-1));
+      ck_assert(achain->start == lchain->start);
+      ck_assert(achain->stop  == lchain->stop);
+      ck_assert_str_eq(achain->chain, lchain->chain);
+      ck_assert(astruct->atoms[achain->startatom] == achain->start);
+      ck_assert_int_eq(achain->startres, r);
+
+      for(lres=lchain->residues, ares=achain->residues, i=0;
+          lres!=NULL && ares!=NULL;
+          NEXT(lres), NEXT(ares), i++, r++)
+      {
+         ck_assert(ares == PDBSTRUCT_RESIDUE(astruct, k, i));
+         ck_assert(ares == PDBSTRUCT_RESIDUEN(astruct, r));
+         ck_assert(ares->prev == ((i==0) ? NULL : ares-1));
+         ck_assert(ares->start == lres->start);
+         ck_assert(ares->stop  == lres->stop);
+         ck_assert_int_eq(ares->resnum, lres->resnum);
+         ck_assert_str_eq(ares->chain,  lres->chain);
+         ck_assert_str_eq(ares->insert, lres->insert);
+         ck_assert_str_eq(ares->resnam, lres->resnam);
+         ck_assert_str_eq(ares->resid,  lres->resid);
+         ck_assert(astruct->atoms[ares->startatom] == ares->start);
+         if(ares->stop == NULL)
+            ck_assert_int_eq(ares->stopatom, astruct->natoms);
+         else
+            ck_assert(astruct->atoms[ares->stopatom] == ares->stop);
+      }
+      ck_assert(lres == NULL && ares == NULL);
+      ck_assert_int_eq(achain->nres, i);
+
+      if(achain->stop == NULL)
+         ck_assert_int_eq(achain->stopatom, astruct->natoms);
+      else
+         ck_assert(astruct->atoms[achain->stopatom] == achain->stop);
+   }
+   ck_assert(lchain == NULL && achain == NULL);
+   ck_assert_int_eq(astruct->nchains,   k);
+   ck_assert_int_eq(astruct->nresidues, r);
+}
+
+/* Core tests */
+START_TEST(test_pdbstruct_01)
+{
+   check_same_structure();
+}
+END_TEST
+
+START_TEST(test_pdbstruct_02)
+{
+   PDB *p;
+
+   /* Add insertion codes and a chain break with the same chain label
+      as an earlier chain
+   */
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if(p->resnum == 3)
+         strcpy(p->insert, "A");
+      if(p->next == NULL)
+         strcpy(p->chain, "A");
+   }
+   check_same_structure();
+}
+END_TEST
+
+START_TEST(test_pdbstruct_03)
+{
+   /* Empty structure                                                   */
+   astruct = blAllocPDBStructureArray(NULL);
+   ck_assert_msg(astruct != NULL, "Failed to build empty PDBSTRUCT.");
+   ck_assert(astruct->chains == NULL);
+   ck_assert_int_eq(astruct->nchains,   0);
+   ck_assert_int_eq(astruct->nresidues, 0);
+   ck_assert_int_eq(astruct->natoms,    0);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *pdbstruct_suite(void)
+{
+   Suite *s = suite_create("PDBStruct");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             pdbstruct_setup, 
+                             pdbstruct_teardown);
+   tcase_add_test(tc_core, test_pdbstruct_01);
+   tcase_add_test(tc_core, test_pdbstruct_02);
+   tcase_add_test(tc_core, test_pdbstruct_03);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
@@ -0,0 +1,238 @@
+/************************************************************************/
+/**
+
+   \file       readpdbmapped_suite.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Test suite for blReadPDBMapped().
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blReadPDBMapped() and blDoReadPDBMapped(). Each file
+   is read with both the memory-mapped reader and the stdio reader and
+   the two linked lists are compared field by field.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+
+#include "readpdbmapped_suite.h"
+
+/* Globals */
+static PDB *pdb_std    = NULL,
+           *pdb_mapped = NULL;
+static int natoms_std    = 0,
+           natoms_mapped = 0;
+
+/* Setup And Teardown */
+static void readpdbmapped_setup(void)
+{
+   pdb_std       = NULL;
+   pdb_mapped    = NULL;
+   natoms_std    = 0;
+   natoms_mapped = 0;
+}
+
+static void readpdbmapped_teardown(void)
+{
+   FREELIST(pdb_std,    PDB);
+   FREELIST(pdb_mapped, PDB);
+}
+
+/* Read a file both ways */
+static void read_both(char *filename, BOOL AllAtoms, int OccRank, 
+                      int ModelNum)
+{
+   FILE *fp;
+   BOOL partial_std;
+   
+   fp = fopen(filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb_std = blDoReadPDB(fp, &natoms_std, AllAtoms, OccRank, ModelNum);
+   fclose(fp);
+   partial_std = gPDBPartialOcc;
+   
+   pdb_mapped = blDoReadPDBMapped(filename, &natoms_mapped, AllAtoms, 
+                                  OccRank, ModelNum);
+   ck_assert(gPDBPartialOcc == partial_std);
+}
+
+/* Compare the two lists */
+static void compare_lists(void)
+{
+   PDB *p, *q;
+
+   ck_assert_int_eq(natoms_mapped, natoms_std);
+   for(p=pdb_std, q=pdb_mapped; 
+       p!=NULL && q!=NULL; 
+       NEXT(p), NEXT(q))
+   {
+      ck_assert_str_eq(q->record_type, p->record_type);
+      ck_assert_str_eq(q->atnam,       p->atnam);
+      ck_assert_str_eq(q->atnam_raw,   p->atnam_raw);
+      ck_assert_str_eq(q->resnam,      p->resnam);
+      ck_assert_str_eq(q->chain,       p->chain);
+      ck_assert_str_eq(q->insert,      p->insert);
+      ck_assert_str_eq(q->element,     p->element);
+      ck_assert_int_eq(q->atnum,       p->atnum);
+      ck_assert_int_eq(q->resnum,      p->resnum);
+      ck_assert_int_eq(q->formal_charge, p->formal_charge);
+      ck_assert(q->altpos == p->altpos);
+      ck_assert(q->x      == p->x);
+      ck_assert(q->y      == p->y);
+      ck_assert(q->z      == p->z);
+      ck_assert(q->occ    == p->occ);
+      ck_assert(q->bval   == p->bval);
+   }
+   ck_assert(p == NULL);
+   ck_assert(q == NULL);
+}
+
+/* Core tests */
+START_TEST(test_read_01)
+{
+   read_both("data/test-deca-ala-01.pdb", TRUE, 1, 1);
+   ck_assert_msg(pdb_mapped != NULL, "No data read from test file.");
+   ck_assert_int_eq(natoms_mapped, 51);
+   compare_lists();
+}
+END_TEST
+
+START_TEST(test_read_02)
+{
+   read_both("data/test-deca-ala-01.pdb", FALSE, 0, 0);
+   compare_lists();
+}
+END_TEST
+
+START_TEST(test_read_03)
+{
+   read_both("data/readpdbml_suite/test_heme_iron.pdb", TRUE, 1, 1);
+   ck_assert_msg(pdb_mapped != NULL, "No data read from test file.");
+   compare_lists();
+}
+END_TEST
+
+START_TEST(test_read_04)
+{
+   read_both("data/readpdbml_suite/test_chloride.pdb", TRUE, 1, 1);
+   ck_assert_msg(pdb_mapped != NULL, "No data read from test file.");
+   ck_assert_str_eq(pdb_mapped->element, "CL");
+   ck_assert(pdb_mapped->formal_charge == -1);
+   compare_lists();
+}
+END_TEST
+
+/* Partial occupancy */
+START_TEST(test_partial_01)
+{
+   read_both("data/readpdbml_suite/test_alpha_carbon_alt_01.pdb", 
+             TRUE, 1, 1);
+   ck_assert_msg(pdb_mapped != NULL, "No data read from test file.");
+   ck_assert(gPDBPartialOcc == TRUE);
+   ck_assert(pdb_mapped->x == 1.0);
+   compare_lists();
+}
+END_TEST
+
+START_TEST(test_partial_02)
+{
+   read_both("data/readpdbml_suite/test_alpha_carbon_alt_01.pdb", 
+             TRUE, 2, 1);
+   ck_assert_msg(pdb_mapped != NULL, "No data read from test file.");
+   ck_assert(pdb_mapped->x == 4.0);
+   compare_lists();
+}
+END_TEST
+
+/* Files that are passed on to blDoReadPDB() */
+START_TEST(test_pdbml_01)
+{
+   read_both("data/readpdbml_suite/test_alpha_carbon.xml", TRUE, 1, 1);
+   ck_assert_msg(pdb_mapped != NULL, "No data read from test file.");
+   ck_assert(gPDBXML == TRUE);
+   compare_lists();
+}
+END_TEST
+
+START_TEST(test_missing_01)
+{
+   pdb_mapped = blReadPDBMapped("data/no_such_file.pdb", &natoms_mapped);
+   ck_assert(pdb_mapped == NULL);
+   ck_assert_int_eq(natoms_mapped, -1);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *readpdbmapped_suite(void)
+{
+   Suite *s        = suite_create("ReadPDBMapped");
+   TCase *tc_core  = tcase_create("Core"),
+         *tc_occ   = tcase_create("Occupancy"),
+         *tc_other = tcase_create("Other");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, readpdbmapped_setup, 
+                             readpdbmapped_teardown);
+   tcase_add_test(tc_core, test_read_01);
+   tcase_add_test(tc_core, test_read_02);
+   tcase_add_test(tc_core, test_read_03);
+   tcase_add_test(tc_core, test_read_04);
+   suite_add_tcase(s, tc_core);
+
+   /* Partial occupancy */
+   tcase_add_checked_fixture(tc_occ, readpdbmapped_setup, 
+                             readpdbmapped_teardown);
+   tcase_add_test(tc_occ, test_partial_01);
+   tcase_add_test(tc_occ, test_partial_02);
+   suite_add_tcase(s, tc_occ);
+
+   /* PDBML and errors */
+   tcase_add_checked_fixture(tc_other, readpdbmapped_setup, 
+                             readpdbmapped_teardown);
+   tcase_add_test(tc_other, test_pdbml_01);
+   tcase_add_test(tc_other, test_missing_01);
+   suite_add_tcase(s, tc_other);
+
+   return(s);
+}
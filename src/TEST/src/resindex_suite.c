@@ -0,0 +1,231 @@
+/************************************************************************/
+/**
+
+   \file       resindex_suite.c
+   
+   \version    V1.0
+   \date       16.10.26
+   \brief      Test suite for the residue index.
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Test suite for blBuildPDBResIndex() and the indexed residue lookups.
+   The results are compared with those from the routines that search 
+   the linked list.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+
+*************************************************************************/
+
+#include "resindex_suite.h"
+
+/* Globals */
+static char test_input_filename[] = "data/test-deca-ala-01.pdb";
+static PDB         *pdb   = NULL;
+static PDBRESINDEX *resindex = NULL;
+static int         natoms;
+
+/* Setup And Teardown */
+static void resindex_setup(void)
+{
+   FILE *fp;
+   
+   fp = fopen(test_input_filename, "r");
+   ck_assert_msg(fp != NULL, "Failed to open test file.");
+   pdb = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb != NULL, "Failed to read test file.");
+   resindex = NULL;
+}
+
+static void resindex_teardown(void)
+{
+   if(resindex != NULL) blFreePDBResIndex(resindex);
+   if(pdb   != NULL) FREELIST(pdb, PDB);
+}
+
+/* Check two linked lists have the same atoms                           */
+static void check_same_atoms(PDB *p, PDB *q)
+{
+   for(; p!=NULL && q!=NULL; NEXT(p), NEXT(q))
+      ck_assert_int_eq(p->atnum, q->atnum);
+   ck_assert(p == NULL && q == NULL);
+}
+
+/* Core tests */
+START_TEST(test_resindex_01)
+{
+   PDB *res, *next;
+   int r;
+
+   resindex = blBuildPDBResIndex(pdb);
+   ck_assert_msg(resindex != NULL, "Failed to build residue index.");
+
+   /* Every residue is found in order with the atom after it            */
+   for(res=pdb, r=0; res!=NULL; res=next, r++)
+   {
+      next = blFindNextResidue(res);
+      ck_assert_int_eq(blFindPDBResIndex(resindex, res->chain, res->resnum,
+                                         res->insert), r);
+      ck_assert(resindex->start[r] == res);
+      ck_assert(resindex->stop[r]  == next);
+      ck_assert(blFindResidueIndexed(resindex, res->chain, res->resnum,
+                                     res->insert) ==
+                blFindResidue(pdb, res->chain, res->resnum, 
+                              res->insert));
+   }
+   ck_assert_int_eq(resindex->nres, r);
+
+   /* Residues that are not there                                       */
+   ck_assert_int_eq(blFindPDBResIndex(resindex, "A", 999, " "), -1);
+   ck_assert_int_eq(blFindPDBResIndex(resindex, "Z", pdb->resnum, " "), -1);
+   ck_assert_int_eq(blFindPDBResIndex(resindex, pdb->chain, pdb->resnum, 
+                                      "A"), -1);
+   ck_assert(blFindResidueSpecIndexed(resindex, "A999") == NULL);
+   ck_assert(blFindResidueSpecIndexed(resindex, "B3") == 
+             blFindResidueSpec(pdb, "B3"));
+}
+END_TEST
+
+START_TEST(test_resindex_02)
+{
+   PDB  *p, *res;
+   char spec[16];
+   int  n;
+
+   /* Make every other residue HETATM, with only its second atom a 
+      HETATM in some cases
+   */
+   for(res=pdb, n=0; res!=NULL; res=blFindNextResidue(res), n++)
+   {
+      if(n%2)
+         strcpy(res->record_type, "HETATM");
+      if(n%4 == 1)
+         strcpy(res->next->record_type, "HETATM");
+   }
+
+   resindex = blBuildPDBResIndex(pdb);
+   ck_assert_msg(resindex != NULL, "Failed to build residue index.");
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      ck_assert(blFindHetatmResidueIndexed(resindex, p->chain, p->resnum,
+                                           p->insert) ==
+                blFindHetatmResidue(pdb, p->chain, p->resnum, 
+                                    p->insert));
+      sprintf(spec, "%s%d", p->chain, p->resnum);
+      ck_assert(blFindHetatmResidueSpecIndexed(resindex, spec) ==
+                blFindHetatmResidueSpec(pdb, spec));
+   }
+}
+END_TEST
+
+START_TEST(test_resindex_03)
+{
+   PDB  *p, *q, 
+        *start1, *stop1, 
+        *start2, *stop2,
+        *zone1,  *zone2;
+   BOOL ok1, ok2;
+   int  mode;
+
+   resindex = blBuildPDBResIndex(pdb);
+   ck_assert_msg(resindex != NULL, "Failed to build residue index.");
+
+   /* Every pair of residues gives the same zones                       */
+   for(p=pdb; p!=NULL; p=blFindNextResidue(p))
+   {
+      for(q=pdb; q!=NULL; q=blFindNextResidue(q))
+      {
+         for(mode=ZONE_MODE_RESNUM; mode<=ZONE_MODE_SEQUENTIAL; mode++)
+         {
+            ok1 = blFindZonePDB(pdb, p->resnum, p->insert, 
+                                q->resnum, q->insert, p->chain, mode,
+                                &start1, &stop1);
+            ok2 = blFindZonePDBIndexed(resindex, p->resnum, p->insert, 
+                                       q->resnum, q->insert, p->chain, 
+                                       mode, &start2, &stop2);
+            ck_assert_int_eq(ok1, ok2);
+            ck_assert(start1 == start2);
+            ck_assert(stop1  == stop2);
+         }
+
+         zone1 = blExtractZonePDBAsCopy(pdb, 
+                                        p->chain, p->resnum, p->insert,
+                                        q->chain, q->resnum, q->insert);
+         zone2 = blExtractZonePDBAsCopyIndexed(resindex,
+                                        p->chain, p->resnum, p->insert,
+                                        q->chain, q->resnum, q->insert);
+         check_same_atoms(zone1, zone2);
+         if(zone1 != NULL) FREELIST(zone1, PDB);
+         if(zone2 != NULL) FREELIST(zone2, PDB);
+      }
+   }
+
+   /* Whole chain                                                       */
+   ok1 = blFindZonePDB(pdb, -999, " ", -999, " ", "B", ZONE_MODE_RESNUM,
+                       &start1, &stop1);
+   ok2 = blFindZonePDBIndexed(resindex, -999, " ", -999, " ", "B", 
+                              ZONE_MODE_RESNUM, &start2, &stop2);
+   ck_assert(ok1 && ok2);
+   ck_assert(start1 == start2);
+   ck_assert(stop1  == stop2);
+}
+END_TEST
+
+
+/* Create Suite */
+Suite *resindex_suite(void)
+{
+   Suite *s = suite_create("ResIndex");
+   TCase *tc_core = tcase_create("Core");
+
+   /* Core test case */
+   tcase_add_checked_fixture(tc_core, 
+                             resindex_setup, 
+                             resindex_teardown);
+   tcase_add_test(tc_core, test_resindex_01);
+   tcase_add_test(tc_core, test_resindex_02);
+   tcase_add_test(tc_core, test_resindex_03);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
@@ -3,8 +3,8 @@
 
    \file       wholepdb_suite.c
    
-   \version    V1.2
-   \date       12.09.14
+   \version    V1.4
+   \date       16.10.26
    \brief      Test suite for whole pdb and pdbml.
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
@@ -50,6 +50,8 @@
 -  V1.0  05.08.14 Original By: CTP
 -  V1.1  18.08.14 Check if input file read for all tests. By: CTP
 -  V1.2  12.09.14 Update tests for MS Windows. By: CTP
+-  V1.3  16.10.26 Added test_read_write_pdb_gzip
+-  V1.4  16.10.26 Added test_read_pdb_gzip_name. Teardown clears wpdb
 
 *************************************************************************/
 
@@ -114,6 +116,7 @@ static void wholepdb_teardown(void)
 
    /* Free WPDB */
    if(wpdb) blFreeWholePDB(wpdb);
+   wpdb = NULL;
 }
 
 /* Core tests */
@@ -401,6 +404,96 @@ START_TEST(test_read_write_pdbml)
 }
 END_TEST
 
+START_TEST(test_read_write_pdb_gzip)
+{
+   /* get pdb data */
+   char filename_in[]      = "test_alanine_in.pdb",
+        filename_example[] = "test_alanine_out_01.pdb",
+        filename_gzip[]    = "tmp/test_alanine_in.pdb.gz",
+        buffer[160],
+        test_message[]     = "Output PDB from gzipped input does not "
+                             "match example file.";
+   FILE *fpout;
+        
+   /* Set Default */
+   gPDBXMLForce = FORCEXML_NOFORCE;
+   
+   /* write a gzipped copy of the input file                            */
+   strcat(test_input_filename,filename_in);
+   fp = fopen(test_input_filename,"r");
+   ck_assert_msg(fp != NULL, "Failed to open PDB file.");
+   fpout = blOpenOrPipe(filename_gzip);
+   ck_assert_msg(fpout != NULL, "Failed to open gzip file.");
+   while(fgets(buffer, 160, fp))
+      fputs(buffer, fpout);
+   fclose(fp);
+   blCloseOrPipe(fpout);
+
+   /* read gzipped file                                                 */
+   fp = fopen(filename_gzip,"r");
+   wpdb = blReadWholePDB(fp);
+   fclose(fp);
+   remove(filename_gzip);
+   ck_assert_msg(wpdb != NULL, "Failed to read gzipped PDB file.");
+
+#ifndef MS_WINDOWS   
+   /* Set temp file name */
+   mkstemp(test_output_filename);
+#endif
+
+   /* write output file */
+   fp = fopen(test_output_filename,"w");
+   blWriteWholePDB(fp, wpdb);
+   fclose(fp);
+
+   /* compare output file to example file */
+   strcat(test_example_filename, filename_example);
+   files_identical = wholepdb_compare_files(test_example_filename, 
+                                            test_output_filename);
+
+   /* remove output file */
+   remove(test_output_filename);
+  
+   /* return test result */
+   ck_assert_msg(files_identical, test_message);
+}
+END_TEST
+
+START_TEST(test_read_pdb_gzip_name)
+{
+   /* A file made with gzip -k stores the original filename, which must
+      be skipped rather than copied
+   */
+   char filename_in[]   = "test_alanine_in.pdb",
+        filename_gzip[] = "test_alanine_in.pdb.gz";
+   PDB  *pdb, *pdbgz;
+   int  natoms, natomsgz, i;
+
+   strcat(test_input_filename,filename_in);
+   fp  = fopen(test_input_filename,"r");
+   ck_assert_msg(fp != NULL, "Failed to open PDB file.");
+   pdb = blReadPDB(fp, &natoms);
+   fclose(fp);
+   ck_assert_msg(pdb != NULL, "Failed to read PDB file.");
+
+   strcpy(test_input_filename, test_example_basename);
+   strcat(test_input_filename, filename_gzip);
+
+   /* Read it twice so that any damage to the heap is found            */
+   for(i=0; i<2; i++)
+   {
+      fp    = fopen(test_input_filename,"r");
+      ck_assert_msg(fp != NULL, "Failed to open gzipped PDB file.");
+      pdbgz = blReadPDB(fp, &natomsgz);
+      fclose(fp);
+      ck_assert_msg(pdbgz != NULL, "Failed to read gzipped PDB file.");
+      ck_assert_int_eq(natomsgz, natoms);
+      FREEPDBLIST(pdbgz);
+   }
+   FREEPDBLIST(pdb);
+}
+END_TEST
+
 
 
 /* Create Suite */
@@ -421,6 +514,8 @@ Suite *wholepdb_suite(void)
    tcase_add_test(tc_core, test_write_pdbml_02);
    tcase_add_test(tc_core, test_read_write_pdb);
    tcase_add_test(tc_core, test_read_write_pdbml);   
+   tcase_add_test(tc_core, test_read_write_pdb_gzip);
+   tcase_add_test(tc_core, test_read_pdb_gzip_name);
    suite_add_tcase(s, tc_core);
 
    return s;
@@ -3,8 +3,8 @@
 
    \file       WholePDB.c
    
-   \version    V1.10
-   \date       29.09.14
+   \version    V1.12
+   \date       16.10.26
    \brief      
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 2014
@@ -62,6 +62,10 @@
                   MS Windows. By: CTP
 -  V1.10 29.09.14 Allow single character filetype check for gzipped files.
                   By: CTP
+-  V1.11 16.10.26 gzipped files are decompressed in-process with zlib
+                  rather than via gunzip and a temporary file
+-  V1.12 16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Doxygen
@@ -125,13 +129,6 @@ static WHOLEPDB *blDoReadWholePDB(FILE *fpin, BOOL atomsonly);
 static STRINGLIST *blParseHeaderPDBML(FILE *fpin);
 static BOOL blSetPDBDateField(char *pdb_date, char *pdbml_date);
 
-#if !defined(__APPLE__) && !defined(MS_WINDOWS)
-FILE *popen(char *, char *);
-#endif
-#ifndef __APPLE__
-int  pclose(FILE *);
-#endif
-
 /************************************************************************/
 /*>void blFreeWholePDB(WHOLEPDB *wpdb)
    ---------------------------------
@@ -148,7 +145,7 @@ void blFreeWholePDB(WHOLEPDB *wpdb)
 {
    blFreeStringList(wpdb->header);
    blFreeStringList(wpdb->trailer);
-   FREELIST(wpdb->pdb, PDB);
+   FREEPDBLIST(wpdb->pdb);
    free(wpdb);
 }
 
@@ -347,6 +344,9 @@ WHOLEPDB *blReadWholePDBAtoms(FILE *fpin)
             MS Windows. By: CTP
 -  29.09.14 Allow single character filetype check for gzipped files. 
             By: CTP
+-  16.10.26 gzipped files are decompressed in-process using 
+            blUncompressedStream(). The temporary file used for 
+            compress'd files is now closed and deleted
 
    TODO FIXME!!!!! Move all this into doReadPDB so that we don't worry 
    about rewinding any more
@@ -357,16 +357,7 @@ static WHOLEPDB *blDoReadWholePDB(FILE *fpin, BOOL atomsonly)
    char     buffer[MAXBUFF];
    FILE     *fp = fpin;
    BOOL     pdbml_format = FALSE;
-   
-#if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS)
-   int      signature[3],
-            ch;
    char     cmd[80];
-   BOOL     gzipped_file = FALSE;
-#  ifndef SINGLE_CHAR_FILECHECK
-   int      i;
-#  endif
-#endif
 
    if((wpdb=(WHOLEPDB *)malloc(sizeof(WHOLEPDB)))==NULL)
       return(NULL);
@@ -375,58 +366,15 @@ static WHOLEPDB *blDoReadWholePDB(FILE *fpin, BOOL atomsonly)
    wpdb->header  = NULL;
    wpdb->trailer = NULL;
    
-#if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS)
-   cmd[0] = '\0';
-   
-   /* See whether this is a gzipped file                                */
-#  ifndef SINGLE_CHAR_FILECHECK
-   /* Default three character filetype check                            */
-   for(i=0; i<3; i++)
-      signature[i] = fgetc(fpin);
-   for(i=2; i>=0; i--)
-      ungetc(signature[i], fpin);
-   if(((signature[0] == (int)0x1F) &&    /* gzip                        */
-       (signature[1] == (int)0x8B) &&
-       (signature[2] == (int)0x08)) ||
-      ((signature[0] == (int)0x1F) &&    /* 05.06.07 compress           */
-       (signature[1] == (int)0x9D) &&
-       (signature[2] == (int)0x90)))
+   /* If the file is gzipped or compressed, get a stream of the 
+      uncompressed data. This may be rewound.
+   */
+   if((fp = blUncompressedStream(fpin, cmd))==NULL)
    {
-      gzipped_file = TRUE;
-   }
-#  else
-   /* Single character filetype check                                   */
-   signature[0] = fgetc(fpin);
-   ungetc(signature[0], fpin);
-   if(signature[0] == (int)0x1F) gzipped_file = TRUE;
-#  endif
-
-   if(gzipped_file)
-   {
-      /* It is gzipped so we'll open gunzip as a pipe and send the data
-         through that into a temporary file
-      */
-      cmd[0] = '\0';
-      sprintf(cmd,"gunzip >/tmp/readpdb_%d",(int)getpid());
-      if((fp = (FILE *)popen(cmd,"w"))==NULL)
-      {
-         wpdb->natoms = (-1);
-         return(NULL);
-      }
-      while((ch=fgetc(fpin))!=EOF)
-         fputc(ch, fp);
-      pclose(fp);
-
-      /* We now reopen the temporary file as our PDB input file         */
-      sprintf(cmd,"/tmp/readpdb_%d",(int)getpid());
-      if((fp = fopen(cmd,"r"))==NULL)
-      {
-         wpdb->natoms = (-1);
-         return(NULL);
-      }
+      if(cmd[0]) unlink(cmd);
+      free(wpdb);
+      return(NULL);
    }
-#endif   
-
 
    /* Check file format */
    pdbml_format = blCheckFileFormatPDBML(fp);
@@ -435,6 +383,8 @@ static WHOLEPDB *blDoReadWholePDB(FILE *fpin, BOOL atomsonly)
    /* PDBML format not supported. */
    if(pdbml_format)
    {
+      if(fp != fpin) fclose(fp);
+      if(cmd[0]) unlink(cmd);
       free(wpdb);
       return(NULL);
    }
@@ -448,11 +398,15 @@ static WHOLEPDB *blDoReadWholePDB(FILE *fpin, BOOL atomsonly)
          if(!strncmp(buffer, "ATOM  ", 6) ||
             !strncmp(buffer, "HETATM", 6) ||
             !strncmp(buffer, "MODEL ", 6))
-      {
-         break;
-      }
-      if((wpdb->header = blStoreString(wpdb->header, buffer))==NULL)
-         return(NULL);
+         {
+            break;
+         }
+         if((wpdb->header = blStoreString(wpdb->header, buffer))==NULL)
+         {
+            if(fp != fpin) fclose(fp);
+            if(cmd[0]) unlink(cmd);
+            return(NULL);
+         }
       }
    }
    else
@@ -489,6 +443,9 @@ static WHOLEPDB *blDoReadWholePDB(FILE *fpin, BOOL atomsonly)
    {
       wpdb->trailer = blStoreString(wpdb->trailer, "END   \n");
    }
+
+   if(fp != fpin) fclose(fp);
+   if(cmd[0]) unlink(cmd);
    
    return(wpdb);
 }
@@ -3,8 +3,8 @@
 
    \file       access.c
    
-   \version    V1.1
-   \date       17.07.14
+   \version    V1.3
+   \date       16.10.26
    \brief      Accessibility calculation code
    
    \copyright  (c) UCL, Dr. Andrew C.R. Martin, 1999-2014
@@ -37,7 +37,9 @@
    ============
 
    Calculation of solvent accessibility by the method of Lee and Richards.
-   Based loosely on PMCL code by Peter McLaughlin
+   Based loosely on PMCL code by Peter McLaughlin. The faster method of
+   Shrake and Rupley, using a cell list to find neighbours, is also
+   available.
 
 **************************************************************************
 
@@ -58,6 +60,25 @@
       Does the accessibilty calculations. integrationAccuracy can be set
       to zero to use the default value
 
+\code
+   BOOL blCalcAccessThreads(PDB *pdb, int natoms, 
+                            REAL integrationAccuracy, REAL probeRadius,
+                            BOOL doAccessibility, int nthreads)
+\endcode
+      As blCalcAccess() but shares the atoms between nthreads threads
+      (0 for one per processor). Gives identical results. Programs using
+      this must be linked with -lpthread
+
+\code
+   BOOL blCalcAccessMethod(PDB *pdb, int natoms, int method,
+                           REAL accuracy, REAL probeRadius,
+                           BOOL doAccessibility, int nthreads)
+\endcode
+      As blCalcAccessThreads() but allows the method to be chosen.
+      ACCESS_METHOD_LR is Lee and Richards (accuracy is the integration
+      accuracy); ACCESS_METHOD_SR is Shrake and Rupley (accuracy is the
+      number of points per atom, 0 for ACCESS_DEF_NPOINTS)
+
 \code
    RESACCESS *blCalcResAccess(PDB *pdb, RESRAD *resrad)
 \endcode
@@ -69,6 +90,10 @@
    =================
 -  V1.0  21.04.99 Original   By: ACRM
 -  V1.1  17.07.14 Extracted from XMAS code
+-  V1.2  16.10.26 Added blCalcAccessThreads(). The per-atom calculation
+                  uses per-thread scratch arrays
+-  V1.3  16.10.26 Added blCalcAccessMethod() and the Shrake and Rupley
+                  method
 
 *************************************************************************/
 /* Doxygen
@@ -84,6 +109,13 @@
    Allocates arrays and calls routines to populate them, do the access
    calculations and populate into the PDB linked list
 
+   #FUNCTION  blCalcAccessThreads()
+   As blCalcAccess(), but shares the atoms between several threads
+
+   #FUNCTION  blCalcAccessMethod()
+   As blCalcAccessThreads(), but the Lee and Richards or Shrake and 
+   Rupley method may be chosen
+
    #FUNCTION  blCalcResAccess()
    Calculates and populates the residue totals and relative values
    using standards stored in resrad
@@ -91,9 +123,18 @@
 /************************************************************************/
 /* Includes
 */
+#ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L   /* For pthreads and sysconf()       */
+#endif
+#include "port.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#ifndef NOTHREADS
+#  include <pthread.h>
+#  include <unistd.h>
+#endif
 
 #include "macros.h"
 #include "SysDefs.h"
@@ -111,19 +152,13 @@
 #define MAX_ATOM_IN_CUBE   100 /* Initial max no. of atoms in a cube -
                                   expands as required                   */
 
+#define ACCESS_CHUNK        64 /* Atoms handed to a thread at a time    */
+
 #define FREE_ACCESS_STORAGE                                              \
 do {                                                                     \
    if(cube)         free(cube);                                          \
    if(radii)        free(radii);                                         \
    if(radiiSquared) free(radiiSquared);                                  \
-   if(neighbours)   free(neighbours);                                    \
-   if(flag)         free(flag);                                          \
-   if(arci)         free(arci);                                          \
-   if(arcf)         free(arcf);                                          \
-   if(deltaX)       free(deltaX);                                        \
-   if(deltaY)       free(deltaY);                                        \
-   if(dist)         free(dist);                                          \
-   if(distSquared)  free(distSquared);                                   \
    if(atomTable)    free(atomTable);                                     \
    if(atomsInCube)  {                                                    \
       for(i=0;i<=maxAtomInCube;i++)                                      \
@@ -134,39 +169,55 @@ do {                                                                     \
    }                                                                     \
 }  while(0);
 
+/* The atoms sorted into cubes. Shared (read-only) by all threads. All
+   arrays count from 1
+*/
+typedef struct
+{
+   REAL  *x, *y, *z,
+         *radii,
+         *radiiSquared,
+         *accessResults,
+         integrationAccuracy,
+         probeRadius;
+   int   *cube,
+         *atomTable,
+         **atomsInCube,
+         numAtoms,
+         idim, jidim, kjidim,
+         method,               /* ACCESS_METHOD_LR or _SR               */
+         npoints,              /* Shrake-Rupley: number of points,      */
+         nextAtom;             /* Next atom to hand to a thread         */
+   REAL  *pointX,              /*    the unit sphere points             */
+         *pointY,
+         *pointZ,
+         maxRadius;            /*    and the largest radius+probe       */
+   PDBCELLLIST *cl;            /*    and the atoms in a cell list       */
+   BOOL  access,
+         ok;
+#ifndef NOTHREADS
+   pthread_mutex_t mutex;
+#endif
+}  ACCESSGRID;
+
+/* Scratch arrays used while calculating the accessibility of one atom.
+   Each thread has its own. All arrays count from 1
+*/
+typedef struct
+{
+   int   *neighbours,
+         *flag,
+         maxIntersect;
+   REAL  *arci, *arcf,
+         *deltaX, *deltaY,
+         *dist, *distSquared;
+   int   *srAtoms,             /* Shrake-Rupley neighbours              */
+         srMaxAtoms,
+         srMaxNeighbours;
+   REAL  *srX, *srY, *srZ,     /*    their coordinates                  */
+         *srRadSq;             /*    and radius+probe squared           */
+}  ACCESSSCRATCH;
 
-#define EXPAND_INTERSECT_ARRAYS                                          \
-do {  int newMaxIntersect = (maxIntersect+MAX_INTERSECT_EXP),            \
-          iexpand;                                                       \
-   neighbours = (int  *)realloc(neighbours,                              \
-                                (newMaxIntersect+1)*sizeof(int));        \
-   flag = (int  *)realloc(flag, (newMaxIntersect+1)*sizeof(int));        \
-   arci = (REAL *)realloc(arci, (newMaxIntersect+1)*sizeof(REAL));       \
-   arcf = (REAL *)realloc(arcf, (newMaxIntersect+1)*sizeof(REAL));       \
-   deltaX = (REAL *)realloc(deltaX, (newMaxIntersect+1)*sizeof(REAL));   \
-   deltaY = (REAL *)realloc(deltaY, (newMaxIntersect+1)*sizeof(REAL));   \
-   dist   = (REAL *)realloc(dist,   (newMaxIntersect+1)*sizeof(REAL));   \
-   distSquared = (REAL *)realloc(distSquared,                            \
-                                 (newMaxIntersect+1)*sizeof(REAL));      \
-   if(neighbours==NULL || flag==NULL   || arci==NULL || arcf==NULL ||    \
-      deltaX==NULL     || deltaY==NULL || dist==NULL ||                  \
-      distSquared==NULL)                                                 \
-   {  FREE_ACCESS_STORAGE;                                               \
-      return(FALSE);                                                     \
-   }                                                                     \
-   for(iexpand=maxIntersect+1; iexpand<=newMaxIntersect; iexpand++)      \
-   {  neighbours[iexpand]  = 0;                                          \
-      flag[iexpand]        = 0;                                          \
-      arci[iexpand]        = 0.0;                                        \
-      arcf[iexpand]        = 0.0;                                        \
-      deltaX[iexpand]      = 0.0;                                        \
-      deltaY[iexpand]      = 0.0;                                        \
-      dist[iexpand]        = 0.0;                                        \
-      distSquared[iexpand] = 0.0;                                        \
-   }                                                                     \
-   maxIntersect = newMaxIntersect;                                       \
-} while(0)
-   
 /************************************************************************/
 /* Prototypes
 */
@@ -175,7 +226,24 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
                          REAL probeRadius, BOOL access,
                          REAL *AtomRadius,
                          REAL *x, REAL *y, REAL *z,
-                         REAL *accessResults);
+                         REAL *accessResults, int nthreads);
+static BOOL InitScratch(ACCESSSCRATCH *scratch);
+static void FreeScratch(ACCESSSCRATCH *scratch);
+static BOOL ExpandScratch(ACCESSSCRATCH *scratch);
+static BOOL doCalcAccessSR(PDB *pdb, int numAtoms, int npoints,
+                           REAL probeRadius, BOOL access,
+                           REAL *atomRadii,
+                           REAL *x, REAL *y, REAL *z,
+                           REAL *accessResults, int nthreads);
+static BOOL ExpandScratchSR(ACCESSSCRATCH *scratch, int nneighbours);
+static BOOL RunAccessCalc(ACCESSGRID *grid, int nthreads);
+static BOOL CalcRange(ACCESSGRID *grid, int first, int last,
+                      ACCESSSCRATCH *scratch);
+static BOOL CalcAtomRangeAccess(ACCESSGRID *grid, int first, int last,
+                                ACCESSSCRATCH *scratch);
+static BOOL CalcAtomRangeSR(ACCESSGRID *grid, int first, int last,
+                            ACCESSSCRATCH *scratch);
+static void *AccessWorker(void *arg);
 static void FillArrays(PDB *pdb, REAL *x, REAL *y, REAL *z, REAL *r);
 static RESRAD *GetResidueRadii(RESRAD *resrad, char *resnam);
 static RESRAD *ReadRadiusFile(FILE *fpRad);
@@ -323,10 +391,88 @@ RESRAD *blSetAtomRadii(PDB *pdb, FILE *fpRad)
    calculations and populate into the PDB linked list
 
 -  22.04.99 Original   By: ACRM
+-  16.10.26 Now a wrapper to blCalcAccessThreads() using one thread
 */
 BOOL blCalcAccess(PDB *pdb, int natoms, 
                   REAL integrationAccuracy, REAL probeRadius,
                   BOOL doAccessibility)
+{
+   return(blCalcAccessThreads(pdb, natoms, integrationAccuracy, 
+                              probeRadius, doAccessibility, 1));
+}
+
+
+/************************************************************************/
+/*>BOOL blCalcAccessThreads(PDB *pdb, int natoms, 
+                            REAL integrationAccuracy, 
+                            REAL probeRadius,
+                            BOOL doAccessibility,
+                            int nthreads)
+   --------------------------------------------------------------
+*//**
+   \param[in,out]    *pdb                  PDB linked list
+   \param[in]        natoms                Number of atoms
+   \param[in]        integrationAccuracy   Integration accuracy
+   \param[in]        probeRadius           Probe radius
+   \param[in]        doAccessibility       Accessibility or contact area
+   \param[in]        nthreads              Number of threads to use. 0
+                                           uses one per online processor
+   \return                                 Success
+
+   As blCalcAccess(), but the atoms are shared between nthreads threads.
+   The accessibility of each atom is calculated in exactly the same way
+   whatever the number of threads, so the results are identical to those
+   from blCalcAccess(). If the library is built with NOTHREADS defined,
+   the calculation is done in the calling thread.
+
+-  16.10.26 Original (from blCalcAccess())
+-  16.10.26 Now a wrapper to blCalcAccessMethod()
+*/
+BOOL blCalcAccessThreads(PDB *pdb, int natoms, 
+                         REAL integrationAccuracy, REAL probeRadius,
+                         BOOL doAccessibility, int nthreads)
+{
+   return(blCalcAccessMethod(pdb, natoms, ACCESS_METHOD_LR,
+                             integrationAccuracy, probeRadius,
+                             doAccessibility, nthreads));
+}
+
+
+/************************************************************************/
+/*>BOOL blCalcAccessMethod(PDB *pdb, int natoms, int method,
+                           REAL accuracy, REAL probeRadius,
+                           BOOL doAccessibility, int nthreads)
+   --------------------------------------------------------------
+*//**
+   \param[in,out]    *pdb                  PDB linked list
+   \param[in]        natoms                Number of atoms
+   \param[in]        method                ACCESS_METHOD_LR (Lee and
+                                           Richards) or ACCESS_METHOD_SR
+                                           (Shrake and Rupley)
+   \param[in]        accuracy              For Lee and Richards, the
+                                           integration accuracy. For 
+                                           Shrake and Rupley, the number
+                                           of points on each sphere. 0 
+                                           gives the default
+   \param[in]        probeRadius           Probe radius
+   \param[in]        doAccessibility       Accessibility or contact area
+   \param[in]        nthreads              Number of threads to use. 0
+                                           uses one per online processor
+   \return                                 Success
+
+   Calculates accessibility with the specified method. Shrake and
+   Rupley places points evenly over each expanded atom sphere and counts
+   the ones not buried by a neighbour. It is considerably faster than
+   Lee and Richards for a similar accuracy on whole structures; with
+   ACCESS_DEF_NPOINTS points the total accessibility normally agrees 
+   to within about 1%. Results from either method are the same 
+   whatever the number of threads.
+
+-  16.10.26 Original (from blCalcAccessThreads())
+*/
+BOOL blCalcAccessMethod(PDB *pdb, int natoms, int method,
+                        REAL accuracy, REAL probeRadius,
+                        BOOL doAccessibility, int nthreads)
 {
    REAL *x = NULL, 
         *y = NULL, 
@@ -335,8 +481,18 @@ BOOL blCalcAccess(PDB *pdb, int natoms,
         *accessArray = NULL;
    BOOL retval = FALSE;
 
-   if(integrationAccuracy < VERY_SMALL)
-      integrationAccuracy = ACCESS_DEF_INTACC;
+   int  npoints = 0;
+
+   if(method == ACCESS_METHOD_SR)
+   {
+      npoints = (int)(accuracy + 0.5);
+      if(npoints < 1)
+         npoints = ACCESS_DEF_NPOINTS;
+   }
+   else if(accuracy < VERY_SMALL)
+   {
+      accuracy = ACCESS_DEF_INTACC;
+   }
    
    /* Allocate arrays                                                   */
    if((x=(REAL *)malloc(natoms * sizeof(REAL)))!=NULL)
@@ -350,18 +506,24 @@ BOOL blCalcAccess(PDB *pdb, int natoms,
                if((accessArray=(REAL *)malloc(natoms * sizeof(REAL)))
                   !=NULL)
                {
-                  retval = TRUE;
-                  
                   /* Populate arrays from PDB structure, do the 
                      accessibility run and put the results back into the 
                      PDB structure
                   */
                   FillArrays(pdb, x, y, z, radii);
-                  doCalcAccess(natoms, integrationAccuracy, probeRadius, 
-                               doAccessibility,
-                               radii, x, y, z,
-                               accessArray);
-                  SetPDBAccess(pdb, accessArray);
+                  if(method == ACCESS_METHOD_SR)
+                     retval = doCalcAccessSR(pdb, natoms, npoints,
+                                             probeRadius, 
+                                             doAccessibility,
+                                             radii, x, y, z,
+                                             accessArray, nthreads);
+                  else
+                     retval = doCalcAccess(natoms, accuracy, 
+                                           probeRadius, doAccessibility,
+                                           radii, x, y, z,
+                                           accessArray, nthreads);
+                  if(retval)
+                     SetPDBAccess(pdb, accessArray);
                }
             }
          }
@@ -379,7 +541,6 @@ BOOL blCalcAccess(PDB *pdb, int natoms,
 }
 
 
-
 /************************************************************************/
 /*>static void FillArrays(PDB *pdb, REAL *x, REAL *y, REAL *z, REAL *r)
    --------------------------------------------------------------------
@@ -866,25 +1027,16 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
                          REAL probeRadius, 
                          BOOL access, REAL *atomRadii,
                          REAL *x, REAL *y, REAL *z,
-                         REAL *accessResults)
+                         REAL *accessResults, int nthreads)
 {
    int   *cube   = NULL,
-         *neighbours   = NULL,
-         *flag   = NULL,
          *atomTable   = NULL,
          **atomsInCube  = NULL;
-   REAL  *radii  = NULL, *radiiSquared=NULL,
-         *arci   = NULL, *arcf=NULL,
-         *deltaX = NULL, *deltaY=NULL,
-         *dist   = NULL, *distSquared=NULL;
+   REAL  *radii  = NULL, *radiiSquared=NULL;
          
-   int   i, j, k, l, m, n,
-         jj, kk,
-         cubeAtom, io, keyAtom,
+   int   i, j, k, l, n,
          cubeIndex,
-         nzp, karc, idim, jidim, kjidim,
-         mkji, nm,
-         maxIntersect  = MAX_INTERSECT,
+         idim, jidim, kjidim,
          maxAtomInCube = MAX_ATOM_IN_CUBE;
    REAL  xmin  =  999999.0,    
          ymin  =  999999.0,
@@ -892,24 +1044,11 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
          xmax  = -999999.0,
          ymax  = -999999.0,
          zmax  = -999999.0,
-         pi    = acos(-1.0),
-         twoPi = 2.0*acos(-1.0),
-         maxRadius, totalArea, tmpArea,
-         intersect,
-         xr, yr, zr, 
-         radius, radiusX2, radiusSquared, 
-         zres, zgrid,
-         t, tf, ti, tt, 
-         partialArea,
-         rsec2r, rsecr, 
-         rsec2n, rsecn,
-         alpha, beta,
-         arcsum;
-   BOOL  SkipAccess = FALSE;
+         maxRadius;
+   ACCESSGRID grid;
 
 #ifdef DEBUG
-   int   maxAtomsSeenInCube = 0,
-         maxIntersectsSeen  = 0;
+   int   maxAtomsSeenInCube = 0;
 #endif
 
    /* Reset arrays to count from 1 instead of 0                         */
@@ -922,28 +1061,10 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
    radii        = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
    radiiSquared = (REAL *)malloc((numAtoms+1)*sizeof(REAL));
    
-   /* Allocate memory for arrays based on number of intersects          */
-   neighbours        = (int  *)malloc((MAX_INTERSECT+1)*sizeof(int));
-   flag        = (int  *)malloc((MAX_INTERSECT+1)*sizeof(int));
-   arci        = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   arcf        = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   deltaX      = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   deltaY      = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   dist        = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-   distSquared = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
-
    /* Check allocations                                                 */
    if(cube         == NULL ||
       radii        == NULL ||
-      radiiSquared == NULL ||
-      neighbours   == NULL ||
-      flag         == NULL ||
-      arci         == NULL ||
-      arcf         == NULL ||
-      deltaX       == NULL ||
-      deltaY       == NULL ||
-      dist         == NULL ||
-      distSquared  == NULL)
+      radiiSquared == NULL)
    {
       FREE_ACCESS_STORAGE;
       return(FALSE);
@@ -1079,9 +1200,353 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
 
    /* Perform the actual accessibility calculations 
       ---------------------------------------------
-      We cycle through each atom in turn
    */
-   for(keyAtom=1; keyAtom<=numAtoms; keyAtom++)
+   grid.x                   = x;
+   grid.y                   = y;
+   grid.z                   = z;
+   grid.radii               = radii;
+   grid.radiiSquared        = radiiSquared;
+   grid.accessResults       = accessResults;
+   grid.integrationAccuracy = integrationAccuracy;
+   grid.probeRadius         = probeRadius;
+   grid.cube                = cube;
+   grid.atomTable           = atomTable;
+   grid.atomsInCube         = atomsInCube;
+   grid.numAtoms            = numAtoms;
+   grid.idim                = idim;
+   grid.jidim               = jidim;
+   grid.kjidim              = kjidim;
+   grid.access              = access;
+   grid.method              = ACCESS_METHOD_LR;
+
+   grid.ok = RunAccessCalc(&grid, nthreads);
+
+   FREE_ACCESS_STORAGE;
+   
+   return(grid.ok);
+}
+
+
+/************************************************************************/
+/*>static BOOL doCalcAccessSR(PDB *pdb, int numAtoms, int npoints,
+                              REAL probeRadius, BOOL access,
+                              REAL *atomRadii,
+                              REAL *x, REAL *y, REAL *z,
+                              REAL *accessResults, int nthreads)
+   -------------------------------------------------------------------
+*//**
+   \param[in]     *pdb            PDB linked list
+   \param[in]     numAtoms        Number of atoms
+   \param[in]     npoints         Number of points on each sphere
+   \param[in]     probeRadius     Probe radius
+   \param[in]     access          Calculate accessibility (rather than
+                                  contact area)
+   \param[in]     *atomRadii      Atom radii
+   \param[in]     *x              Atom x coordinates
+   \param[in]     *y              Atom y coordinates
+   \param[in]     *z              Atom z coordinates
+   \param[out]    *accessResults  Accessibility of each atom
+   \param[in]     nthreads        Number of threads
+   \return                        Success?
+
+   Sets up and runs the Shrake and Rupley calculation. The points are
+   placed evenly over a unit sphere on a golden section spiral and the
+   atoms are placed in a cell list with cells the size of the largest
+   expanded sphere diameter.
+
+-  16.10.26 Original
+*/
+static BOOL doCalcAccessSR(PDB *pdb, int numAtoms, int npoints,
+                           REAL probeRadius, BOOL access,
+                           REAL *atomRadii,
+                           REAL *x, REAL *y, REAL *z,
+                           REAL *accessResults, int nthreads)
+{
+   ACCESSGRID grid;
+   REAL       *radii        = NULL,
+              *radiiSquared = NULL,
+              *pointX       = NULL,
+              *pointY       = NULL,
+              *pointZ       = NULL,
+              maxRadius     = 0.0,
+              goldenAngle   = PI * (3.0 - sqrt(5.0));
+   int        i;
+
+   /* Reset arrays to count from 1 instead of 0                         */
+   atomRadii--;
+   x--; y--; z--;
+   accessResults--;
+
+   grid.cl = NULL;
+   grid.ok = FALSE;
+   
+   if(((radii        = (REAL *)malloc((numAtoms+1)*sizeof(REAL)))
+       ==NULL) ||
+      ((radiiSquared = (REAL *)malloc((numAtoms+1)*sizeof(REAL)))
+       ==NULL) ||
+      ((pointX       = (REAL *)malloc(npoints*sizeof(REAL)))==NULL) ||
+      ((pointY       = (REAL *)malloc(npoints*sizeof(REAL)))==NULL) ||
+      ((pointZ       = (REAL *)malloc(npoints*sizeof(REAL)))==NULL))
+      goto cleanup;
+
+   for(i=1; i<=numAtoms; i++)
+   {
+      radii[i]         = atomRadii[i] + probeRadius;
+      radiiSquared[i]  = radii[i] * radii[i];
+      accessResults[i] = 0.0;
+      if(radii[i] > maxRadius) maxRadius = radii[i];
+   }
+
+   /* Points on a golden section spiral                                 */
+   for(i=0; i<npoints; i++)
+   {
+      REAL py  = 1.0 - (2.0*i + 1.0) / npoints,
+           r   = sqrt(1.0 - py*py),
+           phi = i * goldenAngle;
+      
+      pointX[i] = r * cos(phi);
+      pointY[i] = py;
+      pointZ[i] = r * sin(phi);
+   }
+
+   if((grid.cl = blBuildPDBCellList(pdb, 2.0 * maxRadius))==NULL)
+      goto cleanup;
+
+   grid.x             = x;
+   grid.y             = y;
+   grid.z             = z;
+   grid.radii         = radii;
+   grid.radiiSquared  = radiiSquared;
+   grid.accessResults = accessResults;
+   grid.probeRadius   = probeRadius;
+   grid.numAtoms      = numAtoms;
+   grid.access        = access;
+   grid.method        = ACCESS_METHOD_SR;
+   grid.npoints       = npoints;
+   grid.pointX        = pointX;
+   grid.pointY        = pointY;
+   grid.pointZ        = pointZ;
+   grid.maxRadius     = maxRadius;
+
+   grid.ok = RunAccessCalc(&grid, nthreads);
+
+cleanup:
+   if(grid.cl)      blFreePDBCellList(grid.cl);
+   if(radii)        free(radii);
+   if(radiiSquared) free(radiiSquared);
+   if(pointX)       free(pointX);
+   if(pointY)       free(pointY);
+   if(pointZ)       free(pointZ);
+   
+   return(grid.ok);
+}
+
+
+/************************************************************************/
+/*>static BOOL RunAccessCalc(ACCESSGRID *grid, int nthreads)
+   ---------------------------------------------------------
+*//**
+   \param[in,out] *grid     The atoms and method. Results are placed in
+                            grid->accessResults[]
+   \param[in]     nthreads  Number of threads (0 for one per processor)
+   \return                  Success?
+
+   Runs the per-atom calculation for all atoms. The atoms are shared
+   between the threads in chunks of ACCESS_CHUNK. With a single thread,
+   we just cycle through each atom in turn
+
+-  16.10.26 Original (from doCalcAccess())
+*/
+static BOOL RunAccessCalc(ACCESSGRID *grid, int nthreads)
+{
+   grid->nextAtom = 1;
+   grid->ok       = TRUE;
+
+#ifdef NOTHREADS
+   nthreads = 1;
+#else
+   if(nthreads <= 0)
+   {
+      long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+      nthreads = (nproc > 0) ? (int)nproc : 1;
+   }
+   /* No point in having threads with nothing to do                     */
+   if(nthreads > (grid->numAtoms + ACCESS_CHUNK - 1) / ACCESS_CHUNK)
+      nthreads = (grid->numAtoms + ACCESS_CHUNK - 1) / ACCESS_CHUNK;
+#endif
+
+   if(nthreads <= 1)
+   {
+      ACCESSSCRATCH scratch;
+      
+      if(InitScratch(&scratch))
+      {
+         grid->ok = CalcRange(grid, 1, grid->numAtoms, &scratch);
+         FreeScratch(&scratch);
+      }
+      else
+      {
+         grid->ok = FALSE;
+      }
+   }
+#ifndef NOTHREADS
+   else
+   {
+      pthread_t *threads;
+      int       nstarted = 0,
+                i;
+      
+      if((threads = (pthread_t *)malloc(nthreads * sizeof(pthread_t)))
+         == NULL)
+      {
+         return(FALSE);
+      }
+
+      pthread_mutex_init(&(grid->mutex), NULL);
+
+      /* Start nthreads-1 extra threads. This thread does its share too.
+         If a thread can't be started, the others just do more work
+      */
+      for(i=1; i<nthreads; i++)
+      {
+         if(pthread_create(&(threads[nstarted]), NULL, AccessWorker, 
+                           (void *)grid) == 0)
+            nstarted++;
+      }
+      AccessWorker((void *)grid);
+      
+      for(i=0; i<nstarted; i++)
+         pthread_join(threads[i], NULL);
+
+      pthread_mutex_destroy(&(grid->mutex));
+      free(threads);
+   }
+#endif
+
+   return(grid->ok);
+}
+
+
+/************************************************************************/
+/*>static BOOL CalcRange(ACCESSGRID *grid, int first, int last,
+                         ACCESSSCRATCH *scratch)
+   -------------------------------------------------------------
+*//**
+   \param[in,out] *grid      The atoms and method
+   \param[in]     first     First atom (counting from 1)
+   \param[in]     last      Last atom
+   \param[in,out] *scratch  Scratch arrays for this thread
+   \return                  Success?
+
+   Calculates the accessibility of a range of atoms with the method
+   selected in the grid
+
+-  16.10.26 Original
+*/
+static BOOL CalcRange(ACCESSGRID *grid, int first, int last,
+                      ACCESSSCRATCH *scratch)
+{
+   if(grid->method == ACCESS_METHOD_SR)
+      return(CalcAtomRangeSR(grid, first, last, scratch));
+   return(CalcAtomRangeAccess(grid, first, last, scratch));
+}
+
+
+/* Expands the scratch arrays, updating the local copies of the pointers
+   in CalcAtomRangeAccess()
+*/
+#define EXPAND_INTERSECT_ARRAYS                                          \
+do {                                                                     \
+   if(!ExpandScratch(scratch))                                           \
+      return(FALSE);                                                     \
+   neighbours   = scratch->neighbours;                                   \
+   flag         = scratch->flag;                                         \
+   arci         = scratch->arci;                                         \
+   arcf         = scratch->arcf;                                         \
+   deltaX       = scratch->deltaX;                                       \
+   deltaY       = scratch->deltaY;                                       \
+   dist         = scratch->dist;                                         \
+   distSquared  = scratch->distSquared;                                  \
+   maxIntersect = scratch->maxIntersect;                                 \
+} while(0)
+
+/************************************************************************/
+/*>static BOOL CalcAtomRangeAccess(ACCESSGRID *grid, int first, int last,
+                                   ACCESSSCRATCH *scratch)
+   ----------------------------------------------------------------------
+*//**
+   \param[in,out] *grid      The atoms sorted into cubes. Results are
+                             placed in grid->accessResults[]
+   \param[in]     first     First atom (counting from 1)
+   \param[in]     last      Last atom
+   \param[in,out] *scratch  Scratch arrays for this thread
+   \return                  Success?
+
+   Calculates the accessibility of atoms first to last. This is the main
+   loop from doCalcAccess(); the result for each atom depends only on
+   the grid so the atoms may be done in any order by any thread.
+
+   arci[] used to be cleared for all maxIntersect entries for every
+   section. Only entries up to karc are used and all of those are set,
+   so now only the start of the second segment of a split arc is
+   cleared, which gives the same results.
+
+-  21.04.99 Original   By: ACRM (in doCalcAccess())
+-  16.10.26 Moved out of doCalcAccess()
+*/
+static BOOL CalcAtomRangeAccess(ACCESSGRID *grid, int first, int last,
+                                ACCESSSCRATCH *scratch)
+{
+   REAL  *x             = grid->x,
+         *y             = grid->y,
+         *z             = grid->z,
+         *radiiSquared  = grid->radiiSquared,
+         *radii         = grid->radii,
+         *accessResults = grid->accessResults,
+         integrationAccuracy = grid->integrationAccuracy,
+         probeRadius    = grid->probeRadius;
+   int   *cube          = grid->cube,
+         *atomTable     = grid->atomTable,
+         **atomsInCube  = grid->atomsInCube,
+         idim           = grid->idim,
+         jidim          = grid->jidim,
+         kjidim         = grid->kjidim;
+   BOOL  access         = grid->access;
+   int   *neighbours    = scratch->neighbours,
+         *flag          = scratch->flag,
+         maxIntersect   = scratch->maxIntersect;
+   REAL  *arci          = scratch->arci, 
+         *arcf          = scratch->arcf,
+         *deltaX        = scratch->deltaX, 
+         *deltaY        = scratch->deltaY,
+         *dist          = scratch->dist, 
+         *distSquared   = scratch->distSquared;
+   int   i, j, k, m,
+         jj, kk,
+         cubeAtom, io, keyAtom,
+         cubeIndex,
+         nzp, karc,
+         mkji, nm;
+   REAL  pi    = acos(-1.0),
+         twoPi = 2.0*acos(-1.0),
+         totalArea, tmpArea,
+         intersect,
+         xr, yr, zr, 
+         radius, radiusX2, radiusSquared, 
+         zres, zgrid,
+         t, tf, ti, tt, 
+         partialArea,
+         rsec2r, rsecr, 
+         rsec2n, rsecn,
+         alpha, beta,
+         arcsum;
+   BOOL  SkipAccess = FALSE;
+
+#ifdef DEBUG
+   int   maxIntersectsSeen  = 0;
+#endif
+
+   for(keyAtom=first; keyAtom<=last; keyAtom++)
    {
       cubeIndex     = cube[keyAtom];
       io            = 0;
@@ -1175,9 +1640,6 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
             rsec2r = radiusSquared - (zgrid-zr)*(zgrid-zr);
             rsecr  = sqrt(rsec2r);
             
-            for(k=1; k<=maxIntersect; k++)
-               arci[k] = 0.0;
-            
             karc=0;
             
             for(j=1; j<=io; j++)
@@ -1267,6 +1729,7 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
                      {
                         arcf[karc] = twoPi;
                         karc++;
+                        arci[karc] = 0.0;
                      }
                      
                      arcf[karc] = tf;
@@ -1353,8 +1816,382 @@ static BOOL doCalcAccess(int numAtoms, REAL integrationAccuracy,
    fprintf(stderr,"Maximum intersects: %d\n",maxIntersectsSeen);
 #endif
 
-   FREE_ACCESS_STORAGE;
+   return(TRUE);
+}
+
+#undef EXPAND_INTERSECT_ARRAYS
+
+
+/************************************************************************/
+/*>static BOOL CalcAtomRangeSR(ACCESSGRID *grid, int first, int last,
+                               ACCESSSCRATCH *scratch)
+   ------------------------------------------------------------------
+*//**
+   \param[in,out] *grid      The atoms in a cell list. Results are
+                             placed in grid->accessResults[]
+   \param[in]     first     First atom (counting from 1)
+   \param[in]     last      Last atom
+   \param[in,out] *scratch  Scratch arrays for this thread
+   \return                  Success?
+
+   Calculates the accessibility of atoms first to last by the method
+   of Shrake and Rupley. Each point on the expanded sphere of an atom
+   is tested against the spheres that overlap it. The neighbours are
+   held relative to the atom in separate x, y and z arrays so that the
+   inner loop is a simple loop over contiguous arrays. Buried points
+   are usually buried by the same atom as the previous point, so that
+   atom is tested first.
+
+-  16.10.26 Original
+*/
+static BOOL CalcAtomRangeSR(ACCESSGRID *grid, int first, int last,
+                            ACCESSSCRATCH *scratch)
+{
+   REAL  *x       = grid->x,
+         *y       = grid->y,
+         *z       = grid->z,
+         *radii   = grid->radii,
+         *pointX  = grid->pointX,
+         *pointY  = grid->pointY,
+         *pointZ  = grid->pointZ,
+         fourPi   = 4.0 * PI;
+   int   npoints  = grid->npoints,
+         keyAtom;
+
+   for(keyAtom=first; keyAtom<=last; keyAtom++)
+   {
+      REAL  radius = radii[keyAtom],
+            radiusVdw,
+            *nbX, *nbY, *nbZ, *nbRadSq;
+      VEC3F centre;
+      int   nfound, nnb = 0, naccess = 0, lastOcc = 0, i, k;
+
+      centre.x = x[keyAtom];
+      centre.y = y[keyAtom];
+      centre.z = z[keyAtom];
+
+      /* Find the atoms whose expanded spheres overlap this one         */
+      if((nfound = blFindPDBPointNeighbours(grid->cl, centre, 
+                                            radius + grid->maxRadius,
+                                            &(scratch->srAtoms),
+                                            &(scratch->srMaxAtoms))) < 0)
+         return(FALSE);
+
+      if(nfound > scratch->srMaxNeighbours)
+      {
+         if(!ExpandScratchSR(scratch, nfound))
+            return(FALSE);
+      }
+      nbX     = scratch->srX;
+      nbY     = scratch->srY;
+      nbZ     = scratch->srZ;
+      nbRadSq = scratch->srRadSq;
+
+      for(i=0; i<nfound; i++)
+      {
+         int  j  = scratch->srAtoms[i] + 1;
+         REAL dx, dy, dz, rr;
+         
+         if(j == keyAtom)
+            continue;
+         
+         dx = x[j] - centre.x;
+         dy = y[j] - centre.y;
+         dz = z[j] - centre.z;
+         rr = radius + radii[j];
+         
+         if((dx*dx + dy*dy + dz*dz) < rr*rr)
+         {
+            nbX[nnb]     = dx;
+            nbY[nnb]     = dy;
+            nbZ[nnb]     = dz;
+            nbRadSq[nnb] = grid->radiiSquared[j];
+            nnb++;
+         }
+      }
+
+      /* Count the points that are not inside a neighbour               */
+      for(k=0; k<npoints; k++)
+      {
+         REAL px = radius * pointX[k],
+              py = radius * pointY[k],
+              pz = radius * pointZ[k],
+              dx, dy, dz;
+         BOOL buried = FALSE;
+
+         if(nnb)
+         {
+            dx = px - nbX[lastOcc];
+            dy = py - nbY[lastOcc];
+            dz = pz - nbZ[lastOcc];
+            buried = ((dx*dx + dy*dy + dz*dz) < nbRadSq[lastOcc]);
+         }
+         
+         for(i=0; !buried && i<nnb; i++)
+         {
+            dx = px - nbX[i];
+            dy = py - nbY[i];
+            dz = pz - nbZ[i];
+            if((dx*dx + dy*dy + dz*dz) < nbRadSq[i])
+            {
+               buried  = TRUE;
+               lastOcc = i;
+            }
+         }
+
+         if(!buried)
+            naccess++;
+      }
+
+      /* Area of the accessible points on the expanded sphere or, for 
+         the contact area, on the Van der Waals sphere
+      */
+      radiusVdw = radius - grid->probeRadius;
+      if(grid->access)
+         grid->accessResults[keyAtom] = 
+            fourPi * radius * radius * naccess / npoints;
+      else
+         grid->accessResults[keyAtom] = 
+            fourPi * radiusVdw * radiusVdw * naccess / npoints;
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void *AccessWorker(void *arg)
+   ------------------------------------
+*//**
+   \param[in,out] *arg      The ACCESSGRID
+   \return                  NULL
+
+   Thread function. Repeatedly takes the next ACCESS_CHUNK atoms from
+   the grid and calculates their accessibility until all atoms are done
+   or a thread has failed.
+
+-  16.10.26 Original
+*/
+static void *AccessWorker(void *arg)
+{
+#ifndef NOTHREADS
+   ACCESSGRID    *grid = (ACCESSGRID *)arg;
+   ACCESSSCRATCH scratch;
+   int           first, last;
+   BOOL          ok;
+
+   if(!InitScratch(&scratch))
+   {
+      pthread_mutex_lock(&(grid->mutex));
+      grid->ok = FALSE;
+      pthread_mutex_unlock(&(grid->mutex));
+      return(NULL);
+   }
+   
+   for(;;)
+   {
+      pthread_mutex_lock(&(grid->mutex));
+      first           = grid->nextAtom;
+      grid->nextAtom += ACCESS_CHUNK;
+      ok              = grid->ok;
+      pthread_mutex_unlock(&(grid->mutex));
+
+      if(!ok || (first > grid->numAtoms))
+         break;
+      
+      last = MIN(first + ACCESS_CHUNK - 1, grid->numAtoms);
+      if(!CalcRange(grid, first, last, &scratch))
+      {
+         pthread_mutex_lock(&(grid->mutex));
+         grid->ok = FALSE;
+         pthread_mutex_unlock(&(grid->mutex));
+         break;
+      }
+   }
+
+   FreeScratch(&scratch);
+#endif
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static BOOL InitScratch(ACCESSSCRATCH *scratch)
+   -----------------------------------------------
+*//**
+   \param[out]    *scratch  Scratch arrays
+   \return                  Success?
+
+   Allocates the scratch arrays used by CalcAtomRangeAccess() for the
+   initial MAX_INTERSECT intersections. The arrays used by 
+   CalcAtomRangeSR() are allocated when first needed
+
+-  16.10.26 Original (from doCalcAccess())
+*/
+static BOOL InitScratch(ACCESSSCRATCH *scratch)
+{
+   scratch->maxIntersect = MAX_INTERSECT;
+   scratch->neighbours   = (int  *)malloc((MAX_INTERSECT+1)*sizeof(int));
+   scratch->flag         = (int  *)malloc((MAX_INTERSECT+1)*sizeof(int));
+   scratch->arci         = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
+   scratch->arcf         = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
+   scratch->deltaX       = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
+   scratch->deltaY       = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
+   scratch->dist         = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
+   scratch->distSquared  = (REAL *)malloc((MAX_INTERSECT+1)*sizeof(REAL));
+   scratch->srAtoms         = NULL;
+   scratch->srMaxAtoms      = 0;
+   scratch->srMaxNeighbours = 0;
+   scratch->srX             = NULL;
+   scratch->srY             = NULL;
+   scratch->srZ             = NULL;
+   scratch->srRadSq         = NULL;
+
+   if(scratch->neighbours == NULL ||
+      scratch->flag       == NULL ||
+      scratch->arci       == NULL ||
+      scratch->arcf       == NULL ||
+      scratch->deltaX     == NULL ||
+      scratch->deltaY     == NULL ||
+      scratch->dist       == NULL ||
+      scratch->distSquared== NULL)
+   {
+      FreeScratch(scratch);
+      return(FALSE);
+   }
    
    return(TRUE);
 }
 
+
+/************************************************************************/
+/*>static void FreeScratch(ACCESSSCRATCH *scratch)
+   -----------------------------------------------
+*//**
+   \param[in]     *scratch  Scratch arrays
+
+   Frees the scratch arrays
+
+-  16.10.26 Original
+*/
+static void FreeScratch(ACCESSSCRATCH *scratch)
+{
+   if(scratch->neighbours)  free(scratch->neighbours);
+   if(scratch->flag)        free(scratch->flag);
+   if(scratch->arci)        free(scratch->arci);
+   if(scratch->arcf)        free(scratch->arcf);
+   if(scratch->deltaX)      free(scratch->deltaX);
+   if(scratch->deltaY)      free(scratch->deltaY);
+   if(scratch->dist)        free(scratch->dist);
+   if(scratch->distSquared) free(scratch->distSquared);
+   if(scratch->srAtoms)     free(scratch->srAtoms);
+   if(scratch->srX)         free(scratch->srX);
+   if(scratch->srY)         free(scratch->srY);
+   if(scratch->srZ)         free(scratch->srZ);
+   if(scratch->srRadSq)     free(scratch->srRadSq);
+   scratch->neighbours  = NULL;
+   scratch->flag        = NULL;
+   scratch->arci        = NULL;
+   scratch->arcf        = NULL;
+   scratch->deltaX      = NULL;
+   scratch->deltaY      = NULL;
+   scratch->dist        = NULL;
+   scratch->distSquared = NULL;
+   scratch->srAtoms     = NULL;
+   scratch->srX         = NULL;
+   scratch->srY         = NULL;
+   scratch->srZ         = NULL;
+   scratch->srRadSq     = NULL;
+}
+
+
+/************************************************************************/
+/*>static BOOL ExpandScratch(ACCESSSCRATCH *scratch)
+   -------------------------------------------------
+*//**
+   \param[in,out] *scratch  Scratch arrays
+   \return                  Success? (The arrays are freed on failure)
+
+   Expands the scratch arrays by MAX_INTERSECT_EXP entries
+
+-  21.04.99 Original   By: ACRM (EXPAND_INTERSECT_ARRAYS macro)
+-  16.10.26 Now a function working on an ACCESSSCRATCH
+*/
+static BOOL ExpandScratch(ACCESSSCRATCH *scratch)
+{
+   int  newMaxIntersect = (scratch->maxIntersect+MAX_INTERSECT_EXP),
+        iexpand;
+   int  *ip;
+   REAL *rp;
+
+#define EXPAND_SCRATCH(a, type)                                          \
+   if((a) != NULL)                                                       \
+   {  if((type = realloc((a), (newMaxIntersect+1)*sizeof(*(a))))==NULL)  \
+      {  FreeScratch(scratch);                                           \
+         return(FALSE);                                                  \
+      }                                                                  \
+      (a) = type;                                                        \
+   }
+
+   EXPAND_SCRATCH(scratch->neighbours,  ip);
+   EXPAND_SCRATCH(scratch->flag,        ip);
+   EXPAND_SCRATCH(scratch->arci,        rp);
+   EXPAND_SCRATCH(scratch->arcf,        rp);
+   EXPAND_SCRATCH(scratch->deltaX,      rp);
+   EXPAND_SCRATCH(scratch->deltaY,      rp);
+   EXPAND_SCRATCH(scratch->dist,        rp);
+   EXPAND_SCRATCH(scratch->distSquared, rp);
+#undef EXPAND_SCRATCH
+
+   for(iexpand=scratch->maxIntersect+1; 
+       iexpand<=newMaxIntersect; 
+       iexpand++)
+   {  
+      scratch->neighbours[iexpand]  = 0;
+      scratch->flag[iexpand]        = 0;
+      scratch->arci[iexpand]        = 0.0;
+      scratch->arcf[iexpand]        = 0.0;
+      scratch->deltaX[iexpand]      = 0.0;
+      scratch->deltaY[iexpand]      = 0.0;
+      scratch->dist[iexpand]        = 0.0;
+      scratch->distSquared[iexpand] = 0.0;
+   }
+   scratch->maxIntersect = newMaxIntersect;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL ExpandScratchSR(ACCESSSCRATCH *scratch, int nneighbours)
+   --------------------------------------------------------------------
+*//**
+   \param[in,out] *scratch      Scratch arrays
+   \param[in]     nneighbours  Number of neighbours needed
+   \return                     Success?
+
+   Expands the Shrake and Rupley neighbour arrays to hold at least
+   nneighbours atoms
+
+-  16.10.26 Original
+*/
+static BOOL ExpandScratchSR(ACCESSSCRATCH *scratch, int nneighbours)
+{
+   REAL *rp;
+   int  newMax = MAX(nneighbours, 2*scratch->srMaxNeighbours);
+
+#define EXPAND_SCRATCH_SR(a)                                             \
+   if((rp = (REAL *)realloc((a), newMax*sizeof(REAL)))==NULL)            \
+      return(FALSE);                                                     \
+   (a) = rp
+
+   EXPAND_SCRATCH_SR(scratch->srX);
+   EXPAND_SCRATCH_SR(scratch->srY);
+   EXPAND_SCRATCH_SR(scratch->srZ);
+   EXPAND_SCRATCH_SR(scratch->srRadSq);
+#undef EXPAND_SCRATCH_SR
+
+   scratch->srMaxNeighbours = newMax;
+   return(TRUE);
+}
+
@@ -3,8 +3,8 @@
 
    \file       access.h
    
-   \version    V1.1
-   \date       17.07.14
+   \version    V1.3
+   \date       16.10.26
    \brief      Accessibility calculation code
    
    \copyright  (c) UCL, Dr. Andrew C.R. Martin, 1999-2014
@@ -47,6 +47,9 @@
    =================
 -  V1.0  21.04.99 Original   By: ACRM
 -  V1.1  17.07.14 Extracted from XMAS code
+-  V1.2  16.10.26 Added blCalcAccessThreads()
+-  V1.3  16.10.26 Added blCalcAccessMethod() and the Shrake and Rupley
+                  method
 
 *************************************************************************/
 #ifndef _ACCESS_H_
@@ -54,6 +57,11 @@
 
 #define ACCESS_MAX_ATOMS_PER_RESIDUE 50
 #define ACCESS_DEF_INTACC            0.05
+#define ACCESS_DEF_NPOINTS           240
+
+/* Methods for blCalcAccessMethod()                                     */
+#define ACCESS_METHOD_LR             0   /* Lee and Richards            */
+#define ACCESS_METHOD_SR             1   /* Shrake and Rupley           */
 
 #ifndef VERY_SMALL
 #define VERY_SMALL            (REAL)1e-6
@@ -87,6 +95,12 @@ RESRAD *blSetAtomRadii(PDB *pdb, FILE *fpRad);
 BOOL blCalcAccess(PDB *pdb, int natoms, 
                   REAL integrationAccuracy, REAL probeRadius,
                   BOOL doAccessibility);
+BOOL blCalcAccessThreads(PDB *pdb, int natoms, 
+                         REAL integrationAccuracy, REAL probeRadius,
+                         BOOL doAccessibility, int nthreads);
+BOOL blCalcAccessMethod(PDB *pdb, int natoms, int method,
+                        REAL accuracy, REAL probeRadius,
+                        BOOL doAccessibility, int nthreads);
 RESACCESS *blCalcResAccess(PDB *pdb, RESRAD *resrad);
 
 #endif
@@ -3,8 +3,8 @@
 
    \file       align.c
    
-   \version    V3.5
-   \date       26.08.14
+   \version    V3.12
+   \date       16.10.26
    \brief      Perform Needleman & Wunsch sequence alignment
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
@@ -50,6 +50,11 @@
    First call ReadMDM() to read the mutation data matrix, then call
    align() to align the sequences.
 
+   The matrix read by ReadMDM() is shared by all the routines. To use
+   different matrices or gap penalties in separate threads, create an
+   alignment context for each with blCreateAlignContext(), read the 
+   matrix into it with blReadMDMCtx() and use the ...Ctx() routines.
+
 **************************************************************************
 
    Revision History:
@@ -80,6 +85,24 @@
                   style matrix files as well as our own
 -  V3.4  07.07.14 Use bl prefix for functions By: CTP
 -  V3.5  26.08.14 Added blSetMDMScoreWeight() By: ACRM
+-  V3.6  16.10.26 Added blAffinealignLinear() used automatically for
+                  long sequences
+-  V3.7  16.10.26 Added blAffinealignProfile() and blGetMDMResidues()
+-  V3.8  16.10.26 Matrix, penalties and work space are held in an
+                  alignment context (ALIGNCONTEXT). Added ...Ctx()
+                  versions of the routines. blAffinealign() and
+                  blAffinealignuc() share AffineAlign()
+-  V3.9  16.10.26 Residues are looked up in a 256-entry index built when
+                  the MDM is read and sequences are encoded once per
+                  alignment
+-  V3.10 16.10.26 Added blAffinealignBanded() and blAffinealignBandedCtx()
+-  V3.11 16.10.26 blCalcMDMScoreCtx(), blCalcMDMScoreUCCtx() and 
+                  blSetMDMScoreWeightCtx() count their warnings 
+                  separately, so the same warnings are printed as when 
+                  each had its own static count
+-  V3.12 16.10.26 blAffinealignBanded() widens the band until no 
+                  alignment leaving it could score as well, rather than
+                  until the path does not reach its edge
 
 *************************************************************************/
 /* Doxygen
@@ -99,9 +122,46 @@
    Perform simple N&W alignment of seq1 and seq2 with separate gap
    opening and extension penalties. Optimized for DNA sequences
 
+   #FUNCTION blAffinealignLinear()
+   As blAffinealign() or blAffinealignuc() but uses memory proportional
+   to the sequence length rather than its square. Used automatically
+   by those routines for long sequences
+
+   #FUNCTION blAffinealignBanded()
+   As blAffinealignLinear() but only fills a band around the diagonal,
+   widening it if the alignment reaches its edge. For near-identical
+   sequences
+
+   #FUNCTION blAffinealignBandedCtx()
+   As blAffinealignBanded() using an alignment context
+
+   #FUNCTION blCreateAlignContext()
+   Creates an alignment context holding a matrix, gap penalties and
+   work space so that alignments with different matrices may be run
+   in separate threads
+
+   #FUNCTION blFreeAlignContext()
+   Frees an alignment context
+
+   #FUNCTION blAffinealignCtx()
+   As blAffinealign() using an alignment context
+
+   #FUNCTION blAffinealignucCtx()
+   As blAffinealignuc() using an alignment context
+
+   #FUNCTION blAffinealignLinearCtx()
+   As blAffinealignLinear() using an alignment context
+
+   #FUNCTION blAffinealignProfile()
+   As blAffinealignLinear() with the first sequence and its scores
+   taken from a query profile built with blBuildAlignProfile()
+
    #FUNCTION blReadMDM()
-   Read mutation data matrix into static global arrays for use by 
-   alignment code
+   Read mutation data matrix into the default alignment context for use
+   by alignment code
+
+   #FUNCTION blReadMDMCtx()
+   Read mutation data matrix into an alignment context
 
    #FUNCTION blCalcMDMScore()
    Calculates a score for comparing two amino acids using a mutation
@@ -111,13 +171,31 @@
    As blCalcMDMScore() but upcases the amino acid labels before 
    calculation
 
+   #FUNCTION blCalcMDMScoreCtx()
+   As blCalcMDMScore() using an alignment context
+
+   #FUNCTION blCalcMDMScoreUCCtx()
+   As blCalcMDMScoreUC() using an alignment context
+
    #FUNCTION blZeroMDM()
    Modifies all values in the MDM such that the minimum value is 0
 
+   #FUNCTION blZeroMDMCtx()
+   As blZeroMDM() using an alignment context
+
    #FUNCTION blSetMDMScoreWeight()
    Apply a weight to a particular amino acid substitution. Modifies
    the scoring matrix read by blReadMDM()
 
+   #FUNCTION blSetMDMScoreWeightCtx()
+   As blSetMDMScoreWeight() using an alignment context
+
+   #FUNCTION blGetMDMResidues()
+   Gives the residue types in the scoring matrix read by blReadMDM()
+
+   #FUNCTION blGetMDMResiduesCtx()
+   As blGetMDMResidues() using an alignment context
+
 */
 /************************************************************************/
 /* Includes
@@ -126,6 +204,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 
 #include "SysDefs.h"
 #include "macros.h"
@@ -147,19 +226,86 @@
 #define MAXBUFF 400
 #define MAXWORD 16
 
+#define ALIGN_MAXFULLCELLS 4194304L /* Largest matrix blAffinealign()
+                                       stores. Above this the linear-
+                                       space code is used              */
+#define ALIGN_BLOCKCELLS   1048576L /* Largest block of path directions
+                                       stored by the linear-space code */
+#define ALIGN_NSPLIT       16       /* Sub-blocks per level in the 
+                                       linear-space code               */
+#define ALIGN_BANDWIDTH    8        /* Default starting half-width of
+                                       the band for 
+                                       blAffinealignBanded()           */
+#define ALIGN_BANDNEG      (INT_MIN/4) /* Score for cells outside the 
+                                       band                            */
+
+#define CONTEXT(ctx) (((ctx)==NULL) ? &sDefaultContext : (ctx))
+
+/* Row of the MDM for a residue or -1 if it is not in the MDM          */
+#define MDMINDEX(ctx, res)                                              \
+   (((ctx)->index[(unsigned char)(res)] < (ctx)->size) ?                \
+    (ctx)->index[(unsigned char)(res)] : -1)
+
+/* Score for positions i and j of sequences encoded with EncodeSeq(). 
+   Residues not in the MDM go through ContextScore() for the warning
+*/
+#define CODESCORE(ctx, code1, code2, seq1, seq2, i, j, upcase)          \
+   ((((code1)[i] < 0) || ((code2)[j] < 0)) ?                            \
+    ContextScore((ctx), (seq1)[i], (seq2)[j], (upcase)) :               \
+    (ctx)->score[(code1)[i]][(code2)[j]])
+
+/* Offset of cell (i,j) in the banded matrices for diagonals (i-j) from
+   kmin to kmin+width-1, and whether the cell is in the band
+*/
+#define BANDCELL(kmin, width, i, j)                                     \
+   ((long)(j) * (long)(width) + (long)((i) - (j) - (kmin)))
+#define INBAND(kmin, kmax, i, j)                                        \
+   ((((i) - (j)) >= (kmin)) && (((i) - (j)) <= (kmax)))
+
 /* Type definition to store a X,Y coordinate pair in the matrix         */
 typedef struct
 {
    int x, y;
 }  XY;
 
+/* Checkpoint from which the linear-space code can restart filling the
+   matrix at column c
+*/
+typedef struct
+{
+   int *Mc,                 /* Scores for column c                      */
+       *Mc1,                /* Scores for column c+1                    */
+       *Dv,                 /* Best gap score along each row            */
+       *Dc;                 /* Column from which Dv comes               */
+}  ALIGNSTATE;
+
+/* Linear-space alignment in progress                                   */
+typedef struct
+{
+   char *seq1, *seq2,
+        *align1, *align2;
+   int  *work[3],           /* Rolling score columns                    */
+        *workDv, *workDc,   /* Running row gap scores                   */
+        *last,              /* Last column filled                       */
+        *dirn,              /* Path directions for a block of columns   */
+        length1, length2,
+        penalty, penext,
+        i, j, ai;           /* Current cell of path and alignment length*/
+   ALIGNPROFILE *profile;   /* Query profile for seq1 or NULL           */
+   ALIGNCONTEXT *ctx;       /* Scoring matrix                           */
+   int  *code1, *code2;     /* Sequences encoded with EncodeSeq()       */
+   BOOL identity, 
+        upcase,
+        done;               /* Path has reached the end of a sequence   */
+}  LINALIGN;
+
 
 /************************************************************************/
 /* Globals
 */
-static int  **sMDMScore;
-static char *sMDM_AAList;
-static int  sMDMSize = 0;
+static ALIGNCONTEXT sDefaultContext;  /* Used by the routines without a
+                                         context and when NULL is given
+                                         for the context              */
 
 /************************************************************************/
 /* Prototypes
@@ -170,6 +316,54 @@ static int  SearchForBest(int **matrix, int length1, int length2,
 static int  TraceBack(int **matrix, XY **dirn, int length1, int length2, 
                       char *seq1, char *seq2, char *align1, char *align2, 
                       int *align_len);
+static int  LinAlignSplits(LINALIGN *la, int width);
+static void LinAlignSplitCols(int a, int b, int nsplit, int *cols);
+static BOOL AllocLinAlign(LINALIGN *la);
+static void FreeLinAlign(LINALIGN *la);
+static ALIGNSTATE *AllocAlignStates(int nsplit, int length1);
+static void FreeAlignStates(ALIGNSTATE *saves, int nsplit);
+static int  LinAlignScore(LINALIGN *la, int i, int j);
+static void LinAlignColumn(LINALIGN *la, int j, int *Mj, int *Mj1,
+                           int *Mj2, int *Dv, int *Dc, int *dirn);
+static void LinAlignFill(LINALIGN *la, ALIGNSTATE *start, int chi, 
+                         int clo, int *row0, ALIGNSTATE *saves, 
+                         int *cols, int nsplit, BOOL storeDirn);
+static int  LinAlignStart(LINALIGN *la, int *col0, int *row0);
+static BOOL LinAlignSolve(LINALIGN *la, int a, int b, ALIGNSTATE *state);
+static void LinAlignWalk(LINALIGN *la, int a, int b);
+static void LinAlignFinish(LINALIGN *la);
+static int  LinAlignRun(LINALIGN *la);
+static int  AffineAlign(ALIGNCONTEXT *ctx, BOOL useWork, char *seq1, 
+                        int length1, char *seq2, int length2, 
+                        BOOL verbose, BOOL identity, BOOL upcase, 
+                        int penalty, int penext, char *align1, 
+                        char *align2, int *align_len);
+static int  LinearAlign(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                        char *seq2, int length2, BOOL identity, 
+                        BOOL upcase, int penalty, int penext, 
+                        char *align1, char *align2, int *align_len);
+static void BandAlignColumn(LINALIGN *la, int *M, int kmin, int kmax, 
+                            int j, int *Dv, int *Dc);
+static void BandAlignWalk(LINALIGN *la, int kmin, int kmax);
+static int  BandAlignRun(LINALIGN *la, int kmin, int kmax, 
+                         BOOL *exact);
+static BOOL BandAlignExact(LINALIGN *la, int *F, int *D, int kmin, 
+                           int kmax, int score);
+static int  *BandBestSums(LINALIGN *la, BOOL first);
+static int  BandedAlign(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                        char *seq2, int length2, BOOL identity, 
+                        BOOL upcase, int penalty, int penext, int band,
+                        char *align1, char *align2, int *align_len);
+static int  ContextScore(ALIGNCONTEXT *ctx, char resa, char resb, 
+                         BOOL upcase);
+static int  CalcMDMScoreWarn(ALIGNCONTEXT *ctx, char resa, char resb,
+                             int *nwarn);
+static BOOL AllocContextWork(ALIGNCONTEXT *ctx, int dim);
+static void FreeContextWork(ALIGNCONTEXT *ctx);
+static void FreeContextMDM(ALIGNCONTEXT *ctx);
+static void BuildContextIndex(ALIGNCONTEXT *ctx);
+static int  *EncodeSeq(ALIGNCONTEXT *ctx, char *seq, int length, 
+                       BOOL upcase);
 
 
 /************************************************************************/
@@ -265,9 +459,9 @@ int blAlign(char *seq1,
             opening and extension penalties. The code now maintains
             the path as it goes.
 -  07.07.14 Use bl prefix for functions By: CTP
-**************************************************************************
-******   NOTE AND CHANGES SHOULD BE PROPAGATED TO affinealignuc()   ******
-**************************************************************************
+-  16.10.26 Calls blAffinealignLinear() if the matrices would be larger
+            than ALIGN_MAXFULLCELLS. verbose is then ignored
+-  16.10.26 Now a wrapper to AffineAlign() using the default context
 */
 int blAffinealign(char *seq1, 
                   int  length1, 
@@ -281,316 +475,1612 @@ int blAffinealign(char *seq1,
                   char *align2,
                   int  *align_len)
 {
-   XY    **dirn   = NULL;
-   int   **matrix = NULL,
-         maxdim,
-         i,    j,    k,    l,
-         i1,   j1,
-         dia,  right, down,
-         rcell, dcell, maxoff,
-         match = 1,
-         thisscore,
-         gapext,
-         score;
-   
-   maxdim = MAX(length1, length2);
+   return(AffineAlign(&sDefaultContext, FALSE, seq1, length1, seq2, 
+                      length2, verbose, identity, FALSE, penalty, penext,
+                      align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>int blAffinealignuc(char *seq1, int length1, char *seq2, int length2, 
+                       BOOL verbose, BOOL identity, int penalty, 
+                       int penext, char *align1, char *align2, 
+                       int *align_len)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *seq1         First sequence
+   \param[in]     length1       First sequence length
+   \param[in]     *seq2         Second sequence
+   \param[in]     length2       Second sequence length
+   \param[in]     verbose       Display N&W matrix
+   \param[in]     identity      Use identity matrix
+   \param[in]     penalty       Gap insertion penalty value
+   \param[in]     penext        Extension penalty
+   \param[out]    *align1       Sequence 1 aligned
+   \param[out]    *align2       Sequence 2 aligned
+   \param[out]    *align_len    Alignment length
+   \return                         Alignment score (0 on error)
+            
+   Perform simple N&W alignment of seq1 and seq2. No window is used, so
+   will be slow for long sequences.
+
+   Note that you must allocate sufficient memory for the aligned 
+   sequences.
+   The easy way to do this is to ensure that align1 and align2 are
+   of length (length1+length2).
+
+-  07.10.92 Adapted from original written while at NIMR
+-  08.10.92 Split into separate routines
+-  09.10.92 Changed best structure to simple integers, moved 
+            SearchForBest() into TraceBack()
+-  21.08.95 Was only filling in the bottom right cell at initialisation
+            rather than all the right hand column and bottom row
+-  11.07.96 Changed calls to calcscore() to CalcMDMScore()
+-  06.03.00 Changed name to affinealign() (the routine align() is
+            provided as a backwards compatible wrapper). Added penext 
+            parameter. Now supports affine gap penalties with separate
+            opening and extension penalties. The code now maintains
+            the path as it goes.
+-  27.02.07 Exactly as affinealign() but upcases characters before
+            comparison
+-  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Calls blAffinealignLinear() if the matrices would be larger
+            than ALIGN_MAXFULLCELLS. verbose is then ignored
+-  16.10.26 Now a wrapper to AffineAlign() using the default context
+*/
+int blAffinealignuc(char *seq1, 
+                    int  length1, 
+                    char *seq2, 
+                    int  length2, 
+                    BOOL verbose, 
+                    BOOL identity, 
+                    int  penalty, 
+                    int  penext,
+                    char *align1, 
+                    char *align2,
+                    int  *align_len)
+{
+   return(AffineAlign(&sDefaultContext, FALSE, seq1, length1, seq2, 
+                      length2, verbose, identity, TRUE, penalty, penext,
+                      align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>int blAffinealignLinear(char *seq1, int length1, char *seq2, 
+                           int length2, BOOL identity, BOOL upcase,
+                           int penalty, int penext, char *align1, 
+                           char *align2, int *align_len)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *seq1         First sequence
+   \param[in]     length1       First sequence length
+   \param[in]     *seq2         Second sequence
+   \param[in]     length2       Second sequence length
+   \param[in]     identity      Use identity matrix
+   \param[in]     upcase        Upcase residues before using the MDM
+                                (as blAffinealignuc())
+   \param[in]     penalty       Gap insertion penalty value
+   \param[in]     penext        Extension penalty
+   \param[out]    *align1       Sequence 1 aligned
+   \param[out]    *align2       Sequence 2 aligned
+   \param[out]    *align_len    Alignment length
+   \return                      Alignment score (0 on error)
+
+   Gives exactly the same alignment and score as blAffinealign() (or
+   blAffinealignuc() if upcase is set) without storing the score and
+   path matrices. blAffinealign() calls this automatically when the 
+   matrices would be larger than ALIGN_MAXFULLCELLS.
+
+   The matrix is filled a column (of seq2) at a time from the end using
+   Gotoh's running maxima for the gap scores, which give the same cell 
+   scores and the same choice of gap length as the search along the row
+   and column in blAffinealign(). Only the columns needed for the next 
+   column are kept, together with checkpoints: the state needed to 
+   restart the fill from a given column. The path is then followed from 
+   the start by refilling a block of columns at a time from its 
+   checkpoint, recursively checkpointing blocks that are too big to 
+   store, and recording the path directions only for a block small 
+   enough to store. Memory is therefore proportional to length1 (times
+   the depth of the recursion) rather than to length1 * length2. The 
+   usual Hirschberg/Myers-Miller midpoint split is not used since, 
+   where there are equally good alignments, it does not necessarily 
+   find the same one as blAffinealign().
+
+   Note that you must allocate sufficient memory for the aligned 
+   sequences.
+   The easy way to do this is to ensure that align1 and align2 are
+   of length (length1+length2).
+
+-  16.10.26 Original
+-  16.10.26 Now a wrapper to LinearAlign() using the default context
+*/
+int blAffinealignLinear(char *seq1, 
+                        int  length1, 
+                        char *seq2, 
+                        int  length2, 
+                        BOOL identity, 
+                        BOOL upcase,
+                        int  penalty, 
+                        int  penext,
+                        char *align1, 
+                        char *align2,
+                        int  *align_len)
+{
+   return(LinearAlign(&sDefaultContext, seq1, length1, seq2, length2,
+                      identity, upcase, penalty, penext, 
+                      align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>int blAffinealignProfile(ALIGNPROFILE *profile, char *seq2, 
+                            int length2, int penalty, int penext,
+                            char *align1, char *align2, int *align_len)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *profile   Query profile from blBuildAlignProfile()
+   \param[in]     *seq2      Second sequence
+   \param[in]     length2    Second sequence length
+   \param[in]     penalty    Gap insertion penalty value
+   \param[in]     penext     Extension penalty
+   \param[out]    *align1    Sequence 1 aligned
+   \param[out]    *align2    Sequence 2 aligned
+   \param[out]    *align_len Alignment length
+   \return                   Alignment score (0 on error)
+
+   As blAffinealignLinear() with the profile's query as seq1 and the
+   identity and upcase settings it was built with, but looks the scores 
+   up in the profile. Use this when aligning one sequence against many.
+   Unlike blCalcMDMScore(), no warnings are printed for residues which
+   are not in the MDM. The profile is not modified so may be shared
+   between threads.
+
+   Note that you must allocate sufficient memory for the aligned 
+   sequences.
+   The easy way to do this is to ensure that align1 and align2 are
+   of length (length1+length2).
+
+-  16.10.26 Original
+*/
+int blAffinealignProfile(ALIGNPROFILE *profile, 
+                         char *seq2, 
+                         int  length2, 
+                         int  penalty, 
+                         int  penext,
+                         char *align1, 
+                         char *align2,
+                         int  *align_len)
+{
+   LINALIGN la;
+   int      score;
    
-   /* Initialise the score matrix                                       */
-   if((matrix = (int **)blArray2D(sizeof(int), maxdim, maxdim))==NULL)
-      return(0);
-   if((dirn   = (XY **)blArray2D(sizeof(XY), maxdim, maxdim))==NULL)
+   *align_len = 0;
+   if((profile == NULL) || (length2 < 1))
       return(0);
-      
-   for(i=0;i<maxdim;i++)
-   {
-      for(j=0;j<maxdim;j++)
-      {
-         matrix[i][j] = 0;
-         dirn[i][j].x = -1;
-         dirn[i][j].y = -1;
-      }
-   }
-    
-   /* Fill in scores up the right hand side of the matrix               */
-   for(j=0; j<length2; j++)
+
+   la.seq1     = profile->seq;
+   la.seq2     = seq2;
+   la.align1   = align1;
+   la.align2   = align2;
+   la.length1  = profile->length;
+   la.length2  = length2;
+   la.identity = profile->identity;
+   la.upcase   = profile->upcase;
+   la.penalty  = penalty;
+   la.penext   = penext;
+   la.profile  = profile;
+   la.ctx      = &sDefaultContext;
+   
+   score = LinAlignRun(&la);
+   *align_len = la.ai;
+   return(score);
+}
+
+
+/************************************************************************/
+/*>ALIGNCONTEXT *blCreateAlignContext(int penalty, int penext)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     penalty    Gap insertion penalty value
+   \param[in]     penext     Extension penalty
+   \return                   Alignment context (NULL if out of memory)
+
+   Creates an alignment context: a mutation data matrix, gap penalties
+   and work space reused between alignments. Read a matrix into it with
+   blReadMDMCtx(). The penalties may be changed by setting 
+   ctx->penalty and ctx->penext. 
+
+   Alignments with separate contexts may be run in separate threads. A
+   context should only be used by one thread at a time unless only 
+   scores are being looked up (blCalcMDMScoreCtx()). The routines 
+   without a context use a default context which never holds work 
+   space.
+
+-  16.10.26 Original
+*/
+ALIGNCONTEXT *blCreateAlignContext(int penalty, int penext)
+{
+   ALIGNCONTEXT *ctx;
+   int          i;
+   
+   if((ctx = (ALIGNCONTEXT *)malloc(sizeof(ALIGNCONTEXT)))!=NULL)
    {
-      if(identity)
-      {
-         if(seq1[length1-1] == seq2[j]) matrix[length1-1][j] = match;
-      }
-      else
-      {
-         matrix[length1-1][j] = blCalcMDMScore(seq1[length1-1], seq2[j]);
-      }
+      ctx->score    = NULL;
+      ctx->residues = NULL;
+      ctx->size     = 0;
+      ctx->penalty  = penalty;
+      ctx->penext   = penext;
+      for(i=0; i<ALIGN_NWARN; i++)
+         ctx->nwarn[i] = 0;
+      ctx->matrix   = NULL;
+      ctx->dirn     = NULL;
+      ctx->workDim  = 0;
+      BuildContextIndex(ctx);
    }
+   return(ctx);
+}
 
-   /* Fill in scores along the bottom row of the matrix                 */
-   for(i=0; i<length1; i++)
+
+/************************************************************************/
+/*>void blFreeAlignContext(ALIGNCONTEXT *ctx)
+   ------------------------------------------
+*//**
+
+   \param[in]     *ctx       Alignment context
+
+   Frees an alignment context with its matrix and work space
+
+-  16.10.26 Original
+*/
+void blFreeAlignContext(ALIGNCONTEXT *ctx)
+{
+   if(ctx != NULL)
    {
-      if(identity)
-      {
-         if(seq1[i] == seq2[length2-1]) matrix[i][length2-1] = match;
-      }
-      else
-      {
-         matrix[i][length2-1] = blCalcMDMScore(seq1[i], seq2[length2-1]);
-      }
+      FreeContextMDM(ctx);
+      FreeContextWork(ctx);
+      free(ctx);
    }
+}
 
-   i = length1 - 1;
-   j = length2 - 1;
-   
-   /* Move back along the diagonal                                      */
-   while(i > 0 && j > 0)
-   {
-      i--;
-      j--;
 
-      /* Fill in the scores along this row                              */
-      for(i1 = i; i1 > -1; i1--)
-      {
-         dia   = matrix[i1+1][j+1];
+/************************************************************************/
+/*>int blAffinealignCtx(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                        char *seq2, int length2, BOOL verbose, 
+                        BOOL identity, char *align1, char *align2, 
+                        int *align_len)
+   ---------------------------------------------------------------------
+*//**
 
-         /* Find highest score to right of diagonal                     */
-         rcell = i1+2;
-         if(i1+2 >= length1)  right = 0;
-         else                 right = matrix[i1+2][j+1] - penalty;
-         
-         gapext = 1;
-         for(k = i1+3; k<length1; k++, gapext++)
-         {
-            thisscore = matrix[k][j+1] - (penalty + gapext*penext);
-            
-            if(thisscore > right) 
-            {
-               right = thisscore;
-               rcell = k;
-            }
-         }
+   \param[in,out] *ctx          Alignment context
+   \param[in]     *seq1         First sequence
+   \param[in]     length1       First sequence length
+   \param[in]     *seq2         Second sequence
+   \param[in]     length2       Second sequence length
+   \param[in]     verbose       Display N&W matrix
+   \param[in]     identity      Use identity matrix
+   \param[out]    *align1       Sequence 1 aligned
+   \param[out]    *align2       Sequence 2 aligned
+   \param[out]    *align_len    Alignment length
+   \return                      Alignment score (0 on error)
 
-         /* Find highest score below diagonal                           */
-         dcell = j+2;
-         if(j+2 >= length2)  down = 0;
-         else                down   = matrix[i1+1][j+2] - penalty;
-         
-         gapext = 1;
-         for(l = j+3; l<length2; l++, gapext++)
-         {
-            thisscore = matrix[i1+1][l] - (penalty + gapext*penext);
+   As blAffinealign() but uses the matrix and gap penalties from an
+   alignment context. The score and path matrices are kept in the 
+   context and reused by later alignments.
 
-            if(thisscore > down) 
-            {
-               down = thisscore;
-               dcell = l;
-            }
+-  16.10.26 Original
+*/
+int blAffinealignCtx(ALIGNCONTEXT *ctx, 
+                     char *seq1, 
+                     int  length1, 
+                     char *seq2, 
+                     int  length2, 
+                     BOOL verbose, 
+                     BOOL identity, 
+                     char *align1, 
+                     char *align2,
+                     int  *align_len)
+{
+   return(AffineAlign(CONTEXT(ctx), (ctx != NULL), seq1, length1, 
+                      seq2, length2, verbose, identity, FALSE, 
+                      CONTEXT(ctx)->penalty, CONTEXT(ctx)->penext,
+                      align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>int blAffinealignucCtx(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                          char *seq2, int length2, BOOL verbose, 
+                          BOOL identity, char *align1, char *align2, 
+                          int *align_len)
+   ---------------------------------------------------------------------
+*//**
+
+   As blAffinealignCtx() but upcases residues before using the matrix,
+   as blAffinealignuc()
+
+-  16.10.26 Original
+*/
+int blAffinealignucCtx(ALIGNCONTEXT *ctx, 
+                       char *seq1, 
+                       int  length1, 
+                       char *seq2, 
+                       int  length2, 
+                       BOOL verbose, 
+                       BOOL identity, 
+                       char *align1, 
+                       char *align2,
+                       int  *align_len)
+{
+   return(AffineAlign(CONTEXT(ctx), (ctx != NULL), seq1, length1, 
+                      seq2, length2, verbose, identity, TRUE, 
+                      CONTEXT(ctx)->penalty, CONTEXT(ctx)->penext,
+                      align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>int blAffinealignLinearCtx(ALIGNCONTEXT *ctx, char *seq1, 
+                              int length1, char *seq2, int length2,
+                              BOOL identity, BOOL upcase, char *align1,
+                              char *align2, int *align_len)
+   ---------------------------------------------------------------------
+*//**
+
+   As blAffinealignLinear() but uses the matrix and gap penalties from
+   an alignment context
+
+-  16.10.26 Original
+*/
+int blAffinealignLinearCtx(ALIGNCONTEXT *ctx, 
+                           char *seq1, 
+                           int  length1, 
+                           char *seq2, 
+                           int  length2, 
+                           BOOL identity, 
+                           BOOL upcase,
+                           char *align1, 
+                           char *align2,
+                           int  *align_len)
+{
+   return(LinearAlign(CONTEXT(ctx), seq1, length1, seq2, length2,
+                      identity, upcase, 
+                      CONTEXT(ctx)->penalty, CONTEXT(ctx)->penext,
+                      align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>int blAffinealignBanded(char *seq1, int length1, char *seq2, 
+                           int length2, BOOL identity, BOOL upcase,
+                           int penalty, int penext, int band,
+                           char *align1, char *align2, int *align_len)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *seq1         First sequence
+   \param[in]     length1       First sequence length
+   \param[in]     *seq2         Second sequence
+   \param[in]     length2       Second sequence length
+   \param[in]     identity      Use identity matrix
+   \param[in]     upcase        Upcase residues before using the MDM
+                                (as blAffinealignuc())
+   \param[in]     penalty       Gap insertion penalty value
+   \param[in]     penext        Extension penalty
+   \param[in]     band          Starting half-width of the band (0 for 
+                                the default, ALIGN_BANDWIDTH)
+   \param[out]    *align1       Sequence 1 aligned
+   \param[out]    *align2       Sequence 2 aligned
+   \param[out]    *align_len    Alignment length
+   \return                      Alignment score (0 on error)
+
+   For sequences that differ by a few insertions and deletions, such as
+   a SEQRES sequence and the sequence from the ATOM records. Uses the
+   same scoring and tie-breaking as blAffinealignLinear() (and hence 
+   blAffinealign()) but only fills the cells of the matrix within a 
+   band of diagonals. The band covers the diagonals from the start of 
+   one sequence to the start of the other, when the two are aligned at 
+   either end, plus band diagonals either side. After the alignment, a
+   second pass over the band bounds the score of any alignment leaving
+   it (from the best score of each residue against the other 
+   sequence). If one could score as well as that found, the width is 
+   doubled and the alignment repeated, until none can or the band 
+   covers the whole matrix. Time and memory are therefore proportional
+   to the sequence length times the final band width.
+
+   The result is therefore the same as blAffinealign(). If the whole
+   matrix is needed and is too big to store, blAffinealignLinear() is 
+   used. With negative gap penalties no bound can be given, so the 
+   band is widened to the whole matrix.
+
+   Note that you must allocate sufficient memory for the aligned 
+   sequences.
+   The easy way to do this is to ensure that align1 and align2 are
+   of length (length1+length2).
+
+-  16.10.26 Original
+-  16.10.26 Widens the band until the result is known to be exact
+*/
+int blAffinealignBanded(char *seq1, 
+                        int  length1, 
+                        char *seq2, 
+                        int  length2, 
+                        BOOL identity, 
+                        BOOL upcase,
+                        int  penalty, 
+                        int  penext,
+                        int  band,
+                        char *align1, 
+                        char *align2,
+                        int  *align_len)
+{
+   return(BandedAlign(&sDefaultContext, seq1, length1, seq2, length2,
+                      identity, upcase, penalty, penext, band,
+                      align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>int blAffinealignBandedCtx(ALIGNCONTEXT *ctx, char *seq1, 
+                              int length1, char *seq2, int length2,
+                              BOOL identity, BOOL upcase, int band,
+                              char *align1, char *align2, 
+                              int *align_len)
+   ---------------------------------------------------------------------
+*//**
+
+   As blAffinealignBanded() but uses the matrix and gap penalties from
+   an alignment context
+
+-  16.10.26 Original
+*/
+int blAffinealignBandedCtx(ALIGNCONTEXT *ctx, 
+                           char *seq1, 
+                           int  length1, 
+                           char *seq2, 
+                           int  length2, 
+                           BOOL identity, 
+                           BOOL upcase,
+                           int  band,
+                           char *align1, 
+                           char *align2,
+                           int  *align_len)
+{
+   return(BandedAlign(CONTEXT(ctx), seq1, length1, seq2, length2,
+                      identity, upcase, 
+                      CONTEXT(ctx)->penalty, CONTEXT(ctx)->penext, band,
+                      align1, align2, align_len));
+}
+
+
+/************************************************************************/
+/*>BOOL blReadMDMCtx(ALIGNCONTEXT *ctx, char *mdmfile)
+   ---------------------------------------------------
+*//**
+
+   \param[in,out] *ctx        Alignment context (NULL for the default)
+   \param[in]     *mdmfile    Mutation data matrix filename
+   \return                      Success?
+   
+   Read mutation data matrix into an alignment context replacing any
+   matrix read previously. The matrix may
+   have comments at the start introduced with a ! in the first column.
+   The matrix must be complete (i.e. a triangular matrix will not
+   work). A line describing the residue types must appear, and may
+   be placed before or after the matrix itself
+
+-  07.10.92 Original
+-  18.03.94 getc() -> fgetc()
+-  24.11.94 Automatically looks in DATAENV if not found in current 
+            directory
+-  28.02.95 Modified to read any size MDM and allow comments
+            Also allows the list of aa types before or after the actual
+            matrix
+-  26.07.95 Removed unused variables
+-  06.02.03 Fixed for new version of GetWord()
+-  07.04.09 Completely re-written to allow it to read BLAST style matrix
+            files as well as the ones used previously
+            Allow comments introduced with # as well as !
+            Uses MAXWORD rather than hardcoded 16
+-  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Renamed from blReadMDM() and reads into an alignment context
+            Builds the residue index
+*/
+BOOL blReadMDMCtx(ALIGNCONTEXT *ctx, char *mdmfile)
+{
+   FILE *mdm = NULL;
+   int  i, j, k, row, tmpStoreSize;
+   char buffer[MAXBUFF],
+        word[MAXWORD],
+        *p,
+        **tmpStore;
+   BOOL noenv;
+
+   ctx = CONTEXT(ctx);
+   if((mdm=blOpenFile(mdmfile, DATAENV, "r", &noenv))==NULL)
+   {
+      return(FALSE);
+   }
+
+   /* Free any matrix previously read into this context                 */
+   FreeContextMDM(ctx);
+
+   /* First read the file to determine the dimensions                   */
+   while(fgets(buffer,MAXBUFF,mdm))
+   {
+      TERMINATE(buffer);
+      KILLLEADSPACES(p,buffer);
+
+      /* First line which is non-blank and non-comment                  */
+      if(strlen(p) && p[0] != '!' && p[0] != '#')
+      {
+         ctx->size = 0;
+         for(p = buffer; p!=NULL;)
+         {
+            p = blGetWord(p, word, MAXWORD);
+            /* Increment counter if this is numeric                     */
+            if(isdigit(word[0]) || 
+               ((word[0] == '-')&&(isdigit(word[1]))))
+               ctx->size++;
          }
-         
-         /* Set score to best of these                                  */
-         maxoff = MAX(right, down);
-         if(dia >= maxoff)
+         if(ctx->size)
+            break;
+      }
+   }
+
+   /* Allocate memory for the MDM and the AA List                       */
+   if((ctx->score = (int **)blArray2D(sizeof(int),ctx->size,ctx->size))
+      ==NULL)
+   {
+      fclose(mdm);
+      ctx->size = 0;
+      return(FALSE);
+   }
+   if((ctx->residues = (char *)malloc((ctx->size+1)*sizeof(char)))==NULL)
+   {
+      fclose(mdm);
+      FreeContextMDM(ctx);
+      return(FALSE);
+   }
+
+   /* Allocate temporary storage for a row from the matrix              */
+   tmpStoreSize = 2*ctx->size;
+   if((tmpStore = (char **)blArray2D(sizeof(char), tmpStoreSize, MAXWORD))
+      ==NULL)
+   {
+      fclose(mdm);
+      FreeContextMDM(ctx);
+      return(FALSE);
+   }
+
+   /* Fill the matrix with zeros                                        */
+   for(i=0; i<ctx->size; i++)
+   {
+      for(j=0; j<ctx->size; j++)
+      {
+         ctx->score[i][j] = 0;
+      }
+   }
+
+   /* Rewind the file and read the actual data                          */
+   rewind(mdm);
+   row = 0;
+   while(fgets(buffer,MAXBUFF,mdm))
+   {
+      int Numeric;
+      
+      TERMINATE(buffer);
+      KILLLEADSPACES(p,buffer);
+
+      /* Check line is non-blank and non-comment                        */
+      if(strlen(p) && p[0] != '!' && p[0] != '#')
+      {
+         Numeric = 0;
+         for(p = buffer, i = 0; p!=NULL && i<tmpStoreSize; i++)
+         {
+            p = blGetWord(p, tmpStore[i], MAXWORD);
+            /* Incremement Numeric counter if it's a numeric field      */
+            if(isdigit(tmpStore[i][0]) || 
+               ((tmpStore[i][0] == '-')&&(isdigit(tmpStore[i][1]))))
+            {
+               Numeric++;
+            }
+         }
+
+         /* No numeric fields so it is the amino acid names             */
+         if(Numeric == 0)
+         {
+            for(j = 0; j<i && j<ctx->size; j++)
+            {
+               ctx->residues[j] = tmpStore[j][0];
+            }
+         }
+         else
+         {
+            /* There were numeric fields, so copy them into the matrix,
+               skipping any non-numeric fields
+               j counts the input fields
+               k counts the fields in ctx->score
+               row counts the row in ctx->score
+            */
+            for(j=0, k=0; j<i && k<ctx->size; j++)
+            {
+               if(isdigit(tmpStore[j][0]) || 
+                  ((tmpStore[j][0] == '-')&&(isdigit(tmpStore[j][1]))))
+               {
+                  sscanf(tmpStore[j],"%d",&(ctx->score[row][k]));
+                  k++;
+               }
+            }
+            
+            row++;
+         }
+      }
+   }
+   fclose(mdm);
+   blFreeArray2D((char **)tmpStore, tmpStoreSize, MAXWORD);
+
+   BuildContextIndex(ctx);
+   
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL blReadMDM(char *mdmfile)
+   -----------------------------
+*//**
+
+   \param[in]     *mdmfile    Mutation data matrix filename
+   \return                      Success?
+   
+   Read mutation data matrix into the default alignment context used by
+   the routines which do not take a context. See blReadMDMCtx()
+
+-  07.10.92 Original
+-  16.10.26 Now a wrapper to blReadMDMCtx()
+*/
+BOOL blReadMDM(char *mdmfile)
+{
+   return(blReadMDMCtx(NULL, mdmfile));
+}
+
+
+/************************************************************************/
+/*>static int SearchForBest(int **matrix, int length1, int length2, 
+                            int *BestI, int *BestJ, char *seq1, 
+                            char *seq2, char *align1, char *align2)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]     **matrix   N&W matrix
+   \param[in]     length1    Length of first sequence
+   \param[in]     length2    Length of second sequence
+   \param[in]     *BestI     x position of highest score
+   \param[in]     *BestJ     y position of highest score
+   \param[in]     *seq1      First sequence
+   \param[in]     *seq2      Second sequence
+   \param[out]    *align1    First sequence with end aligned correctly
+   \param[out]    *align2    Second sequence with end aligned correctly
+   \return                     Alignment length thus far
+
+   Searches the outside of the matrix for the best score and starts the
+   alignment by putting in any starting - characters.
+
+-  08.10.92 Original extracted from Align()
+*/
+static int SearchForBest(int  **matrix, 
+                         int  length1, 
+                         int  length2, 
+                         int  *BestI, 
+                         int  *BestJ,
+                         char *seq1, 
+                         char *seq2, 
+                         char *align1, 
+                         char *align2)
+{
+   int   ai, 
+         besti,   bestj, 
+         i,       j;
+   
+   /* Now search the outside of the matrix for the highest scoring cell */
+   ai    = 0;
+   besti = 0;
+   for(i = 1; i < length1; i++) 
+   {
+      if(matrix[i][0] > matrix[besti][0]) besti = i;
+   }
+   bestj = 0;
+   for(j = 1; j < length2; j++)
+   {
+      if(matrix[0][j] > matrix[0][bestj]) bestj = j;
+   }
+   if(matrix[besti][0] > matrix[0][bestj])
+   {
+      *BestI = besti;
+      *BestJ = 0;
+      for(i=0; i<*BestI; i++)
+      {
+         align1[ai] = seq1[i];
+         align2[ai++] = '-';
+      }
+   }
+   else
+   {
+      *BestI = 0;
+      *BestJ = bestj;
+      for(j=0; j<*BestJ; j++)
+      {
+         align1[ai] = '-';
+         align2[ai++] = seq2[j];
+      }
+   }
+   return(ai);
+}
+
+
+/************************************************************************/
+/*>static int TraceBack(int **matrix, XY **dirn, 
+                        int length1, int length2, 
+                        char *seq1, char *seq2, char *align1, 
+                        char *align2, int *align_len)
+   ----------------------------------------------------------
+*//**
+   \param[in]     **matrix   N&W matrix
+   \param[in]     **dirn     Direction Matrix
+   \param[in]     length1    Length of first sequence
+   \param[in]     length2    Length of second sequence
+   \param[in]     *seq1      First sequence
+   \param[in]     *seq2      Second sequence
+   \param[out]    *align1    First sequence aligned
+   \param[out]    *align2    Second sequence aligned
+   \param[out]    *align_len Aligned sequence length
+   \return                     Alignment score
+
+   Does the traceback to find the aligment.
+
+-  08.10.92 Original extracted from Align(). Rewritten to do tracing
+            correctly.
+-  09.10.92 Changed to call SearchForBest(). Nor returns score rather than
+            length.
+-  06.03.00 Recoded to take the path matrix which is calculated within
+            the main affinealign() routine rather than calculating the
+            path as we go. penalty parameter removed as this is no longer
+            needed. dirn parameter added.
+-  28.09.00 Fixed bug where last inserts were printed properly if one chain
+            ended first
+*/
+static int TraceBack(int  **matrix, 
+                     XY   **dirn,
+                     int  length1, 
+                     int  length2, 
+                     char *seq1, 
+                     char *seq2, 
+                     char *align1, 
+                     char *align2, 
+                     int  *align_len)
+{
+   int   i,    j, 
+         ai, 
+         BestI,BestJ;
+   XY    nextCell;
+
+   ai = SearchForBest(matrix, length1, length2, &BestI, &BestJ, 
+                       seq1, seq2, align1, align2);
+
+   /* Now trace back to find the alignment                              */
+   i            = BestI;
+   j            = BestJ;
+   align1[ai]   = seq1[i];
+   align2[ai++] = seq2[j];
+
+   while(i < length1-1 && j < length2-1)
+   {
+      nextCell.x = dirn[i][j].x;
+      nextCell.y = dirn[i][j].y;
+      if((nextCell.x == i+1) && (nextCell.y == j+1))
+      {
+         /* We are inheriting from the diagonal                         */
+         i++;
+         j++;
+      }
+      else if(nextCell.y == j+1)
+      {
+         /* We are inheriting from the off-diagonal inserting a gap in
+            the y-sequence (seq2)
+         */
+         i++;
+         j++;
+         while((i < nextCell.x) && (i < length1-1))
+         {
+            align1[ai] = seq1[i++];
+            align2[ai++] = '-';
+         }
+      }
+      else if(nextCell.x == i+1)
+      {
+         /* We are inheriting from the off-diagonal inserting a gap in
+            the x-sequence (seq1)
+         */
+         i++;
+         j++;
+         while((j < nextCell.y) && (j < length2-1))
+         {
+            align1[ai] = '-';
+            align2[ai++] = seq2[j++];
+         }
+      }
+      else
+      {
+         /* Cockup!                                                     */
+         fprintf(stderr,"align.c/TraceBack() internal error\n");
+      }
+      
+      align1[ai]   = seq1[i];
+      align2[ai++] = seq2[j];
+   }
+
+   /* If one sequence finished first, fill in the end with insertions   */
+   if(i < length1-1)
+   {
+      for(j=i+1; j<length1; j++)
+      {
+         align1[ai]   = seq1[j];
+         align2[ai++] = '-';
+      }
+   }
+   else if(j < length2-1)
+   {
+      for(i=j+1; i<length2; i++)
+      {
+         align1[ai]   = '-';
+         align2[ai++] = seq2[i];
+      }
+   }
+   
+   *align_len = ai;
+   
+   return(matrix[BestI][BestJ]);
+}
+
+
+/************************************************************************/
+/*>static int LinAlignSplits(LINALIGN *la, int width)
+   --------------------------------------------------
+*//**
+
+   \param[in]     *la       Linear-space alignment
+   \param[in]     width     Number of columns in a block
+   \return                  Number of sub-blocks to split it into (1 if 
+                            the path directions for the block can be 
+                            stored)
+
+-  16.10.26 Original
+*/
+static int LinAlignSplits(LINALIGN *la, int width)
+{
+   if((long)width * (long)la->length1 <= ALIGN_BLOCKCELLS)
+      return(1);
+   return(MIN(width, ALIGN_NSPLIT));
+}
+
+
+/************************************************************************/
+/*>static void LinAlignSplitCols(int a, int b, int nsplit, int *cols)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     a         First column of the block
+   \param[in]     b         Column after the end of the block
+   \param[in]     nsplit    Number of sub-blocks
+   \param[out]    *cols     First column of each sub-block followed by b
+
+-  16.10.26 Original
+*/
+static void LinAlignSplitCols(int a, int b, int nsplit, int *cols)
+{
+   int k;
+   
+   for(k=0; k<=nsplit; k++)
+      cols[k] = a + (int)(((long)(b - a) * (long)k) / nsplit);
+}
+
+
+/************************************************************************/
+/*>static BOOL AllocLinAlign(LINALIGN *la)
+   ---------------------------------------
+*//**
+
+   \param[in,out] *la       Linear-space alignment
+   \return                  Success?
+
+   Allocates the working columns and the path direction block. 
+   FreeLinAlign() must be called even if this fails.
+
+-  16.10.26 Original
+*/
+static BOOL AllocLinAlign(LINALIGN *la)
+{
+   int i,
+       n = la->length1;
+
+   la->dirn   = NULL;
+   la->workDv = NULL;
+   la->workDc = NULL;
+   for(i=0; i<3; i++)
+      la->work[i] = NULL;
+   
+   for(i=0; i<3; i++)
+   {
+      if((la->work[i] = (int *)malloc(n * sizeof(int)))==NULL)
+         return(FALSE);
+   }
+   if(((la->workDv = (int *)malloc(n * sizeof(int)))==NULL) ||
+      ((la->workDc = (int *)malloc(n * sizeof(int)))==NULL))
+      return(FALSE);
+   if((la->dirn = (int *)malloc(MIN((long)n * (long)la->length2,
+                                    ALIGN_BLOCKCELLS) * sizeof(int)))
+      ==NULL)
+      return(FALSE);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void FreeLinAlign(LINALIGN *la)
+   --------------------------------------
+*//**
+
+   \param[in,out] *la       Linear-space alignment
+
+-  16.10.26 Original
+*/
+static void FreeLinAlign(LINALIGN *la)
+{
+   int i;
+   
+   for(i=0; i<3; i++)
+   {
+      if(la->work[i] != NULL)
+         free(la->work[i]);
+   }
+   if(la->workDv != NULL) free(la->workDv);
+   if(la->workDc != NULL) free(la->workDc);
+   if(la->dirn   != NULL) free(la->dirn);
+}
+
+
+/************************************************************************/
+/*>static ALIGNSTATE *AllocAlignStates(int nsplit, int length1)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]     nsplit    Number of sub-blocks
+   \param[in]     length1   Length of first sequence
+   \return                  Array of checkpoints for the start of each 
+                            sub-block (NULL if out of memory). Element
+                            0 is not used since the first block is never
+                            restarted from its own start.
+
+-  16.10.26 Original
+*/
+static ALIGNSTATE *AllocAlignStates(int nsplit, int length1)
+{
+   ALIGNSTATE *saves;
+   int        k;
+   
+   if((saves = (ALIGNSTATE *)malloc(nsplit * sizeof(ALIGNSTATE)))==NULL)
+      return(NULL);
+
+   for(k=0; k<nsplit; k++)
+      saves[k].Mc = NULL;
+   
+   for(k=1; k<nsplit; k++)
+   {
+      if((saves[k].Mc = (int *)malloc(4 * length1 * sizeof(int)))==NULL)
+      {
+         FreeAlignStates(saves, nsplit);
+         return(NULL);
+      }
+      saves[k].Mc1 = saves[k].Mc  + length1;
+      saves[k].Dv  = saves[k].Mc1 + length1;
+      saves[k].Dc  = saves[k].Dv  + length1;
+   }
+   
+   return(saves);
+}
+
+
+/************************************************************************/
+/*>static void FreeAlignStates(ALIGNSTATE *saves, int nsplit)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]     *saves    Array of checkpoints (may be NULL)
+   \param[in]     nsplit    Number of sub-blocks
+
+-  16.10.26 Original
+*/
+static void FreeAlignStates(ALIGNSTATE *saves, int nsplit)
+{
+   int k;
+   
+   if(saves != NULL)
+   {
+      for(k=0; k<nsplit; k++)
+      {
+         if(saves[k].Mc != NULL)
+            free(saves[k].Mc);
+      }
+      free(saves);
+   }
+}
+
+
+/************************************************************************/
+/*>static int LinAlignScore(LINALIGN *la, int i, int j)
+   ----------------------------------------------------
+*//**
+
+   \param[in]     *la       Linear-space alignment
+   \param[in]     i         Offset into first sequence
+   \param[in]     j         Offset into second sequence
+   \return                  Score for aligning the residues
+
+-  16.10.26 Original
+-  16.10.26 Uses the encoded sequences
+*/
+static int LinAlignScore(LINALIGN *la, int i, int j)
+{
+   if(la->profile != NULL)
+      return(la->profile->score[la->profile->row[(unsigned char)
+                                                 la->seq2[j]] * 
+                                la->length1 + (la->length1-1-i)]);
+   if(la->identity)
+      return((la->seq1[i] == la->seq2[j]) ? 1 : 0);
+   return(CODESCORE(la->ctx, la->code1, la->code2, la->seq1, la->seq2, 
+                    i, j, la->upcase));
+}
+
+
+/************************************************************************/
+/*>static void LinAlignColumn(LINALIGN *la, int j, int *Mj, int *Mj1,
+                              int *Mj2, int *Dv, int *Dc, int *dirn)
+   ------------------------------------------------------------------
+*//**
+
+   \param[in]     *la       Linear-space alignment
+   \param[in]     j         Column (offset into second sequence)
+   \param[out]    *Mj       Scores for column j
+   \param[in]     *Mj1      Scores for column j+1
+   \param[in]     *Mj2      Scores for column j+2
+   \param[in,out] *Dv       Best gap score along each row (see below)
+   \param[in,out] *Dc       Column from which Dv comes
+   \param[out]    *dirn     Path directions for column j (may be NULL)
+                            0 for the diagonal, the row to continue 
+                            from for a gap in seq2 or minus the column 
+                            to continue from for a gap in seq1
+
+   Fills a column of the matrix exactly as blAffinealign() does. The
+   best score to the right of the diagonal, found by searching the 
+   column in blAffinealign(), is kept as a running maximum as we go up 
+   the column. The best score below the diagonal, found by searching the
+   row, is kept in Dv[] as a running maximum as we move along the rows.
+   Ties go to the shortest gap as they do in blAffinealign().
+
+-  16.10.26 Original
+*/
+static void LinAlignColumn(LINALIGN *la, int j, int *Mj, int *Mj1,
+                           int *Mj2, int *Dv, int *Dc, int *dirn)
+{
+   int i, 
+       dia, right, down, 
+       rcell = 0, 
+       dcell, 
+       Rv    = 0, 
+       cand,
+       n1    = la->length1,
+       n2    = la->length2;
+
+   /* Bottom row and right hand column are just the residue scores      */
+   if(j == n2-1)
+   {
+      for(i=0; i<n1; i++)
+         Mj[i] = LinAlignScore(la, i, j);
+      return;
+   }
+   Mj[n1-1] = LinAlignScore(la, n1-1, j);
+
+   for(i=n1-2; i>=0; i--)
+   {
+      dia = Mj1[i+1];
+
+      /* Best score to right of diagonal                                */
+      if(i == n1-2)
+      {
+         right = 0;
+         rcell = i+2;
+      }
+      else
+      {
+         cand = Mj1[i+2] - la->penalty;
+         if((i == n1-3) || (cand >= Rv - la->penext))
          {
-            matrix[i1][j] = dia;
-            dirn[i1][j].x = i1+1;
-            dirn[i1][j].y = j+1;
+            Rv    = cand;
+            rcell = i+2;
          }
          else
          {
-            if(right > down)
-            {
-               matrix[i1][j] = right;
-               dirn[i1][j].x = rcell;
-               dirn[i1][j].y = j+1;
-            }
-            else
-            {
-               matrix[i1][j] = down;
-               dirn[i1][j].x = i1+1;
-               dirn[i1][j].y = dcell;
-            }
+            Rv   -= la->penext;
          }
-       
-         /* Add the score for a match                                   */
-         if(identity)
+         right = Rv;
+      }
+
+      /* Best score below diagonal                                      */
+      if(j == n2-2)
+      {
+         down  = 0;
+         dcell = j+2;
+      }
+      else
+      {
+         cand = Mj2[i+1] - la->penalty;
+         if((j == n2-3) || (cand >= Dv[i] - la->penext))
          {
-            if(seq1[i1] == seq2[j]) matrix[i1][j] += match;
+            Dv[i] = cand;
+            Dc[i] = j+2;
          }
          else
          {
-            matrix[i1][j] += blCalcMDMScore(seq1[i1],seq2[j]);
+            Dv[i] -= la->penext;
          }
+         down  = Dv[i];
+         dcell = Dc[i];
       }
 
-      /* Fill in the scores in this column                              */
-      for(j1 = j; j1 > -1; j1--)
+      /* Set score to best of these                                     */
+      if(dia >= MAX(right, down))
       {
-         dia   = matrix[i+1][j1+1];
-         
-         /* Find highest score to right of diagonal                     */
-         rcell = i+2;
-         if(i+2 >= length1)   right = 0;
-         else                 right = matrix[i+2][j1+1] - penalty;
+         Mj[i] = dia;
+         if(dirn != NULL) dirn[i] = 0;
+      }
+      else if(right > down)
+      {
+         Mj[i] = right;
+         if(dirn != NULL) dirn[i] = rcell;
+      }
+      else
+      {
+         Mj[i] = down;
+         if(dirn != NULL) dirn[i] = -dcell;
+      }
+      
+      Mj[i] += LinAlignScore(la, i, j);
+   }
+}
 
-         gapext = 1;
-         for(k = i+3; k<length1; k++, gapext++)
-         {
-            thisscore = matrix[k][j1+1] - (penalty + gapext*penext);
-            
-            if(thisscore > right) 
-            {
-               right = thisscore;
-               rcell = k;
-            }
-         }
 
-         /* Find highest score below diagonal                           */
-         dcell = j1+2;
-         if(j1+2 >= length2)  down = 0;
-         else                 down = matrix[i+1][j1+2] - penalty;
+/************************************************************************/
+/*>static void LinAlignFill(LINALIGN *la, ALIGNSTATE *start, int chi, 
+                            int clo, int *row0, ALIGNSTATE *saves, 
+                            int *cols, int nsplit, BOOL storeDirn)
+   -------------------------------------------------------------------
+*//**
 
-         gapext = 1;
-         for(l = j1+3; l<length2; l++, gapext++)
-         {
-            thisscore = matrix[i+1][l] - (penalty + gapext*penext);
-            
-            if(thisscore > down) 
-            {
-               down = thisscore;
-               dcell = l;
-            }
-         }
+   \param[in,out] *la       Linear-space alignment
+   \param[in]     *start    Checkpoint for column chi (NULL if chi is 
+                            the end of the second sequence)
+   \param[in]     chi       Column after the last one to fill
+   \param[in]     clo       Last column to fill
+   \param[out]    *row0     First row of the matrix (may be NULL)
+   \param[out]    *saves    Checkpoints to save (may be NULL)
+   \param[in]     *cols     Columns at which to save checkpoints
+   \param[in]     nsplit    Number of checkpoints + 1
+   \param[in]     storeDirn Store the path directions in la->dirn
+
+   Fills columns chi-1 down to clo, leaving la->last pointing to the
+   scores for column clo. If storeDirn is set, the directions for 
+   column j are stored from la->dirn[(j-clo)*length1]
+
+-  16.10.26 Original
+*/
+static void LinAlignFill(LINALIGN *la, ALIGNSTATE *start, int chi, 
+                         int clo, int *row0, ALIGNSTATE *saves, 
+                         int *cols, int nsplit, BOOL storeDirn)
+{
+   int *p0 = la->work[0],
+       *p1 = la->work[1],
+       *p2 = la->work[2],
+       *tmp,
+       n1  = la->length1,
+       ksave = nsplit - 1,
+       i, j;
 
-         /* Set score to best of these                                  */
-         maxoff = MAX(right, down);
-         if(dia >= maxoff)
-         {
-            matrix[i][j1] = dia;
-            dirn[i][j1].x = i+1;
-            dirn[i][j1].y = j1+1;
-         }
-         else
-         {
-            if(right > down)
-            {
-               matrix[i][j1] = right;
-               dirn[i][j1].x = rcell;
-               dirn[i][j1].y = j1+1;
-            }
-            else
-            {
-               matrix[i][j1] = down;
-               dirn[i][j1].x = i+1;
-               dirn[i][j1].y = dcell;
-            }
-         }
-       
-         /* Add the score for a match                                   */
-         if(identity)
-         {
-            if(seq1[i] == seq2[j1]) matrix[i][j1] += match;
-         }
-         else
+   if(start != NULL)
+   {
+      for(i=0; i<n1; i++)
+      {
+         p1[i]         = start->Mc[i];
+         p2[i]         = start->Mc1[i];
+         la->workDv[i] = start->Dv[i];
+         la->workDc[i] = start->Dc[i];
+      }
+   }
+
+   for(j=chi-1; j>=clo; j--)
+   {
+      LinAlignColumn(la, j, p0, p1, p2, la->workDv, la->workDc,
+                     storeDirn ? la->dirn + (long)(j-clo) * n1 : NULL);
+      if(row0 != NULL)
+         row0[j] = p0[0];
+      
+      tmp = p2;
+      p2  = p1;
+      p1  = p0;
+      p0  = tmp;
+
+      /* Save a checkpoint from which to restart at this column         */
+      if((saves != NULL) && (ksave > 0) && (j == cols[ksave]))
+      {
+         for(i=0; i<n1; i++)
          {
-            matrix[i][j1] += blCalcMDMScore(seq1[i],seq2[j1]);
+            saves[ksave].Mc[i]  = p1[i];
+            saves[ksave].Mc1[i] = p2[i];
+            saves[ksave].Dv[i]  = la->workDv[i];
+            saves[ksave].Dc[i]  = la->workDc[i];
          }
+         ksave--;
       }
-   } 
+   }
+
+   la->work[0] = p0;
+   la->work[1] = p1;
+   la->work[2] = p2;
+   la->last    = p1;
+}
+
+
+/************************************************************************/
+/*>static int LinAlignStart(LINALIGN *la, int *col0, int *row0)
+   ------------------------------------------------------------
+*//**
+
+   \param[in,out] *la       Linear-space alignment
+   \param[in]     *col0     First column of the matrix
+   \param[in]     *row0     First row of the matrix
+   \return                  Alignment score
+
+   Finds the start of the path and starts the alignment exactly as
+   SearchForBest() and TraceBack() do
+
+-  16.10.26 Original
+*/
+static int LinAlignStart(LINALIGN *la, int *col0, int *row0)
+{
+   int besti = 0,
+       bestj = 0,
+       score,
+       i, j;
    
-   score = TraceBack(matrix, dirn, length1, length2,
-                     seq1, seq2, align1, align2, align_len);
+   la->ai = 0;
+   for(i=1; i<la->length1; i++)
+   {
+      if(col0[i] > col0[besti]) besti = i;
+   }
+   for(j=1; j<la->length2; j++)
+   {
+      if(row0[j] > row0[bestj]) bestj = j;
+   }
+   if(col0[besti] > row0[bestj])
+   {
+      la->i = besti;
+      la->j = 0;
+      score = col0[besti];
+      for(i=0; i<la->i; i++)
+      {
+         la->align1[la->ai]   = la->seq1[i];
+         la->align2[la->ai++] = '-';
+      }
+   }
+   else
+   {
+      la->i = 0;
+      la->j = bestj;
+      score = row0[bestj];
+      for(j=0; j<la->j; j++)
+      {
+         la->align1[la->ai]   = '-';
+         la->align2[la->ai++] = la->seq2[j];
+      }
+   }
 
-   if(verbose)
+   la->align1[la->ai]   = la->seq1[la->i];
+   la->align2[la->ai++] = la->seq2[la->j];
+   la->done = !((la->i < la->length1-1) && (la->j < la->length2-1));
+   
+   return(score);
+}
+
+
+/************************************************************************/
+/*>static BOOL LinAlignSolve(LINALIGN *la, int a, int b, 
+                             ALIGNSTATE *state)
+   ------------------------------------------------------
+*//**
+
+   \param[in,out] *la       Linear-space alignment
+   \param[in]     a         First column of the block
+   \param[in]     b         Column after the end of the block
+   \param[in]     *state    Checkpoint for column b (NULL if b is the 
+                            end of the second sequence)
+   \return                  Success? (FALSE if out of memory)
+
+   Follows the path through a block of columns which it enters. If the
+   path directions for the block can be stored, the block is refilled
+   from its checkpoint storing them and the path is followed. Otherwise
+   the block is split, the refill saving checkpoints for the sub-blocks,
+   and each sub-block that the path enters is solved in turn.
+
+-  16.10.26 Original
+*/
+static BOOL LinAlignSolve(LINALIGN *la, int a, int b, ALIGNSTATE *state)
+{
+   ALIGNSTATE *saves;
+   int        cols[ALIGN_NSPLIT+1],
+              nsplit,
+              k;
+   BOOL       ok = TRUE;
+
+   nsplit = LinAlignSplits(la, b - a);
+   if(nsplit == 1)
    {
-      printf("Matrix:\n-------\n");
-      for(j=0; j<length2;j++)
+      LinAlignFill(la, state, b, a, NULL, NULL, NULL, 0, TRUE);
+      LinAlignWalk(la, a, b);
+      return(TRUE);
+   }
+
+   if((saves = AllocAlignStates(nsplit, la->length1))==NULL)
+      return(FALSE);
+   
+   LinAlignSplitCols(a, b, nsplit, cols);
+   LinAlignFill(la, state, b, cols[1], NULL, saves, cols, nsplit, FALSE);
+   
+   for(k=0; k<nsplit && ok && !la->done; k++)
+   {
+      if(la->j < cols[k+1])
+         ok = LinAlignSolve(la, cols[k], cols[k+1],
+                            (k==nsplit-1) ? state : &(saves[k+1]));
+   }
+
+   FreeAlignStates(saves, nsplit);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static void LinAlignWalk(LINALIGN *la, int a, int b)
+   ----------------------------------------------------
+*//**
+
+   \param[in,out] *la       Linear-space alignment
+   \param[in]     a         First column of the block
+   \param[in]     b         Column after the end of the block
+
+   Follows the path through a block for which the directions are stored
+   in la->dirn, building the alignment exactly as TraceBack() does
+
+-  16.10.26 Original
+*/
+static void LinAlignWalk(LINALIGN *la, int a, int b)
+{
+   int  n1 = la->length1,
+        n2 = la->length2,
+        next;
+   char *seq1   = la->seq1,
+        *seq2   = la->seq2,
+        *align1 = la->align1,
+        *align2 = la->align2;
+   
+   while(!la->done && (la->j < b))
+   {
+      next = la->dirn[(long)(la->j - a) * n1 + la->i];
+      la->i++;
+      la->j++;
+      
+      if(next > 0)
       {
-         for(i=0; i<length1; i++)
+         /* Gap in seq2                                                 */
+         while((la->i < next) && (la->i < n1-1))
          {
-            printf("%3d ",matrix[i][j]);
+            align1[la->ai]   = seq1[la->i++];
+            align2[la->ai++] = '-';
          }
-         printf("\n");
       }
-
-      printf("Path:\n-----\n");
-      for(j=0; j<length2;j++)
+      else if(next < 0)
       {
-         for(i=0; i<length1; i++)
+         /* Gap in seq1                                                 */
+         while((la->j < -next) && (la->j < n2-1))
          {
-            printf("(%3d,%3d) ",dirn[i][j].x,dirn[i][j].y);
+            align1[la->ai]   = '-';
+            align2[la->ai++] = seq2[la->j++];
          }
-         printf("\n");
       }
+
+      align1[la->ai]   = seq1[la->i];
+      align2[la->ai++] = seq2[la->j];
+      la->done = !((la->i < n1-1) && (la->j < n2-1));
+   }
+}
+
+
+/************************************************************************/
+/*>static void LinAlignFinish(LINALIGN *la)
+   ----------------------------------------
+*//**
+
+   \param[in,out] *la       Linear-space alignment
+
+   If one sequence finished first, fills in the end with insertions as
+   TraceBack() does
+
+-  16.10.26 Original
+*/
+static void LinAlignFinish(LINALIGN *la)
+{
+   int k;
+   
+   if(la->i < la->length1-1)
+   {
+      for(k=la->i+1; k<la->length1; k++)
+      {
+         la->align1[la->ai]   = la->seq1[k];
+         la->align2[la->ai++] = '-';
+      }
+   }
+   else if(la->j < la->length2-1)
+   {
+      for(k=la->j+1; k<la->length2; k++)
+      {
+         la->align1[la->ai]   = '-';
+         la->align2[la->ai++] = la->seq2[k];
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static int LinAlignRun(LINALIGN *la)
+   -------------------------------------
+*//**
+
+   \param[in,out] *la       Linear-space alignment with the sequences,
+                            scoring and output set up
+   \return                  Alignment score (0 if out of memory)
+
+   Does the work for blAffinealignLinear() and blAffinealignProfile().
+   On return la->ai is the alignment length (0 if out of memory).
+
+-  16.10.26 Original (split from blAffinealignLinear())
+*/
+static int LinAlignRun(LINALIGN *la)
+{
+   ALIGNSTATE *saves = NULL;
+   int        *col0  = NULL,
+              *row0  = NULL,
+              cols[ALIGN_NSPLIT+1],
+              nsplit, k,
+              score  = 0;
+   BOOL       ok     = FALSE;
+
+   /* Look up the residues in the MDM once                              */
+   la->code1 = la->code2 = NULL;
+   if((la->profile == NULL) && !la->identity)
+   {
+      if(((la->code1 = EncodeSeq(la->ctx, la->seq1, la->length1, 
+                                 la->upcase))==NULL) ||
+         ((la->code2 = EncodeSeq(la->ctx, la->seq2, la->length2, 
+                                 la->upcase))==NULL))
+      {
+         if(la->code1 != NULL) free(la->code1);
+         la->ai = 0;
+         return(0);
+      }
+   }
+
+   nsplit = LinAlignSplits(la, la->length2);
+   
+   if(AllocLinAlign(la) &&
+      ((col0  = (int *)malloc(la->length1 * sizeof(int)))!=NULL) &&
+      ((row0  = (int *)malloc(la->length2 * sizeof(int)))!=NULL) &&
+      ((saves = AllocAlignStates(nsplit, la->length1))!=NULL))
+   {
+      /* Fill the whole matrix keeping the first row and column, to find
+         the start of the path, and checkpoints for the top level blocks
+      */
+      LinAlignSplitCols(0, la->length2, nsplit, cols);
+      LinAlignFill(la, NULL, la->length2, 0, row0, saves, cols, nsplit, 
+                   FALSE);
+      for(k=0; k<la->length1; k++)
+         col0[k] = la->last[k];
+   
+      /* Start the alignment exactly as SearchForBest() does            */
+      score = LinAlignStart(la, col0, row0);
+
+      /* Follow the path through the blocks                             */
+      ok = TRUE;
+      for(k=0; k<nsplit && ok && !la->done; k++)
+      {
+         if(la->j < cols[k+1])
+            ok = LinAlignSolve(la, cols[k], cols[k+1],
+                               (k==nsplit-1) ? NULL : &(saves[k+1]));
+      }
+      if(ok)
+         LinAlignFinish(la);
    }
-    
-   blFreeArray2D((char **)matrix, maxdim, maxdim);
-   blFreeArray2D((char **)dirn,   maxdim, maxdim);
-    
+   
+   FreeAlignStates(saves, nsplit);
+   if(col0 != NULL) free(col0);
+   if(row0 != NULL) free(row0);
+   FreeLinAlign(la);
+   if(la->code1 != NULL) free(la->code1);
+   if(la->code2 != NULL) free(la->code2);
+
+   if(!ok)
+   {
+      la->ai = 0;
+      return(0);
+   }
+   
    return(score);
 }
 
 
 /************************************************************************/
-/*>int blAffinealignuc(char *seq1, int length1, char *seq2, int length2, 
-                       BOOL verbose, BOOL identity, int penalty, 
-                       int penext, char *align1, char *align2, 
-                       int *align_len)
+/*>static int AffineAlign(ALIGNCONTEXT *ctx, BOOL useWork, char *seq1, 
+                          int length1, char *seq2, int length2, 
+                          BOOL verbose, BOOL identity, BOOL upcase, 
+                          int penalty, int penext, char *align1, 
+                          char *align2, int *align_len)
    ---------------------------------------------------------------------
 *//**
 
-   \param[in]     *seq1         First sequence
-   \param[in]     length1       First sequence length
-   \param[in]     *seq2         Second sequence
-   \param[in]     length2       Second sequence length
-   \param[in]     verbose       Display N&W matrix
-   \param[in]     identity      Use identity matrix
-   \param[in]     penalty       Gap insertion penalty value
-   \param[in]     penext        Extension penalty
-   \param[out]    *align1       Sequence 1 aligned
-   \param[out]    *align2       Sequence 2 aligned
-   \param[out]    *align_len    Alignment length
-   \return                         Alignment score (0 on error)
-            
-   Perform simple N&W alignment of seq1 and seq2. No window is used, so
-   will be slow for long sequences.
+   \param[in,out] *ctx          Alignment context for the MDM
+   \param[in]     useWork       Use the context's work space for the 
+                                score and path matrices
+   \param[in]     upcase        Upcase residues before using the MDM
 
-   Note that you must allocate sufficient memory for the aligned 
-   sequences.
-   The easy way to do this is to ensure that align1 and align2 are
-   of length (length1+length2).
+   Other parameters and return as blAffinealign()
 
--  07.10.92 Adapted from original written while at NIMR
--  08.10.92 Split into separate routines
--  09.10.92 Changed best structure to simple integers, moved 
-            SearchForBest() into TraceBack()
--  21.08.95 Was only filling in the bottom right cell at initialisation
-            rather than all the right hand column and bottom row
--  11.07.96 Changed calls to calcscore() to CalcMDMScore()
--  06.03.00 Changed name to affinealign() (the routine align() is
-            provided as a backwards compatible wrapper). Added penext 
-            parameter. Now supports affine gap penalties with separate
-            opening and extension penalties. The code now maintains
-            the path as it goes.
--  27.02.07 Exactly as affinealign() but upcases characters before
-            comparison
--  07.07.14 Use bl prefix for functions By: CTP
+   Does the work for blAffinealign(), blAffinealignuc() and their 
+   context versions.
 
-**************************************************************************
-******    NOTE AND CHANGES SHOULD BE PROPAGATED TO affinealign()    ******
-**************************************************************************
+-  16.10.26 Original from blAffinealign() which was duplicated in
+            blAffinealignuc()
 */
-int blAffinealignuc(char *seq1, 
-                    int  length1, 
-                    char *seq2, 
-                    int  length2, 
-                    BOOL verbose, 
-                    BOOL identity, 
-                    int  penalty, 
-                    int  penext,
-                    char *align1, 
-                    char *align2,
-                    int  *align_len)
+static int AffineAlign(ALIGNCONTEXT *ctx,
+                       BOOL useWork,
+                       char *seq1, 
+                       int  length1, 
+                       char *seq2, 
+                       int  length2, 
+                       BOOL verbose, 
+                       BOOL identity, 
+                       BOOL upcase,
+                       int  penalty, 
+                       int  penext,
+                       char *align1, 
+                       char *align2,
+                       int  *align_len)
 {
    XY    **dirn   = NULL;
-   int   **matrix = NULL,
+   int   *code1   = NULL,
+         *code2   = NULL,
+         **matrix = NULL,
          maxdim,
          i,    j,    k,    l,
          i1,   j1,
@@ -602,13 +2092,47 @@ int blAffinealignuc(char *seq1,
          score;
    
    maxdim = MAX(length1, length2);
+
+   /* If the matrices would be too big, use the linear-space code which
+      gives the same alignment
+   */
+   if(((long)maxdim * (long)maxdim) > ALIGN_MAXFULLCELLS)
+      return(LinearAlign(ctx, seq1, length1, seq2, length2, identity,
+                         upcase, penalty, penext, 
+                         align1, align2, align_len));
    
-   /* Initialise the score matrix                                       */
-   if((matrix = (int **)blArray2D(sizeof(int), maxdim, maxdim))==NULL)
-      return(0);
-   if((dirn   = (XY **)blArray2D(sizeof(XY), maxdim, maxdim))==NULL)
-      return(0);
+   /* Initialise the score matrix, reusing the context's work space if
+      required
+   */
+   if(useWork)
+   {
+      if(!AllocContextWork(ctx, maxdim))
+         return(0);
+      matrix = ctx->matrix;
+      dirn   = (XY **)ctx->dirn;
+   }
+   else
+   {
+      if((matrix = (int **)blArray2D(sizeof(int), maxdim, maxdim))==NULL)
+         return(0);
+      if((dirn   = (XY **)blArray2D(sizeof(XY), maxdim, maxdim))==NULL)
+      {
+         blFreeArray2D((char **)matrix, maxdim, maxdim);
+         return(0);
+      }
+   }
       
+   /* Look up the residues in the MDM once                              */
+   if(!identity)
+   {
+      if(((code1 = EncodeSeq(ctx, seq1, length1, upcase))==NULL) ||
+         ((code2 = EncodeSeq(ctx, seq2, length2, upcase))==NULL))
+      {
+         score = 0;
+         goto Cleanup;
+      }
+   }
+
    for(i=0;i<maxdim;i++)
    {
       for(j=0;j<maxdim;j++)
@@ -628,7 +2152,8 @@ int blAffinealignuc(char *seq1,
       }
       else
       {
-         matrix[length1-1][j] = blCalcMDMScoreUC(seq1[length1-1],seq2[j]);
+         matrix[length1-1][j] = CODESCORE(ctx, code1, code2, seq1, seq2,
+                                          length1-1, j, upcase);
       }
    }
 
@@ -641,7 +2166,8 @@ int blAffinealignuc(char *seq1,
       }
       else
       {
-         matrix[i][length2-1] = blCalcMDMScoreUC(seq1[i],seq2[length2-1]);
+         matrix[i][length2-1] = CODESCORE(ctx, code1, code2, seq1, seq2,
+                                          i, length2-1, upcase);
       }
    }
 
@@ -724,7 +2250,8 @@ int blAffinealignuc(char *seq1,
          }
          else
          {
-            matrix[i1][j] += blCalcMDMScoreUC(seq1[i1],seq2[j]);
+            matrix[i1][j] += CODESCORE(ctx, code1, code2, seq1, seq2, 
+                                       i1, j, upcase);
          }
       }
 
@@ -798,409 +2325,899 @@ int blAffinealignuc(char *seq1,
          }
          else
          {
-            matrix[i][j1] += blCalcMDMScoreUC(seq1[i],seq2[j1]);
+            matrix[i][j1] += CODESCORE(ctx, code1, code2, seq1, seq2, 
+                                       i, j1, upcase);
+         }
+      }
+   } 
+   
+   score = TraceBack(matrix, dirn, length1, length2,
+                     seq1, seq2, align1, align2, align_len);
+
+   if(verbose)
+   {
+      printf("Matrix:\n-------\n");
+      for(j=0; j<length2;j++)
+      {
+         for(i=0; i<length1; i++)
+         {
+            printf("%3d ",matrix[i][j]);
+         }
+         printf("\n");
+      }
+
+      printf("Path:\n-----\n");
+      for(j=0; j<length2;j++)
+      {
+         for(i=0; i<length1; i++)
+         {
+            printf("(%3d,%3d) ",dirn[i][j].x,dirn[i][j].y);
+         }
+         printf("\n");
+      }
+   }
+    
+Cleanup:
+   if(!useWork)
+   {
+      blFreeArray2D((char **)matrix, maxdim, maxdim);
+      blFreeArray2D((char **)dirn,   maxdim, maxdim);
+   }
+   if(code1 != NULL) free(code1);
+   if(code2 != NULL) free(code2);
+    
+   return(score);
+}
+
+
+/************************************************************************/
+/*>static int ContextScore(ALIGNCONTEXT *ctx, char resa, char resb,
+                           BOOL upcase)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in,out] *ctx      Alignment context
+   \param[in]     resa      First residue
+   \param[in]     resb      Second residue
+   \param[in]     upcase    Upcase the residues first
+   \return                  score
+
+-  16.10.26 Original
+*/
+static int ContextScore(ALIGNCONTEXT *ctx, char resa, char resb, 
+                        BOOL upcase)
+{
+   if(upcase)
+      return(blCalcMDMScoreUCCtx(ctx, resa, resb));
+   return(blCalcMDMScoreCtx(ctx, resa, resb));
+}
+
+
+/************************************************************************/
+/*>static BOOL AllocContextWork(ALIGNCONTEXT *ctx, int dim)
+   --------------------------------------------------------
+*//**
+
+   \param[in,out] *ctx      Alignment context
+   \param[in]     dim       Dimension of score and path matrices needed
+   \return                  Success?
+
+   Makes sure that the work space in the context is big enough
+
+-  16.10.26 Original
+*/
+static BOOL AllocContextWork(ALIGNCONTEXT *ctx, int dim)
+{
+   if(ctx->workDim >= dim)
+      return(TRUE);
+
+   FreeContextWork(ctx);
+   if((ctx->matrix = (int **)blArray2D(sizeof(int), dim, dim))==NULL)
+      return(FALSE);
+   if((ctx->dirn = blArray2D(sizeof(XY), dim, dim))==NULL)
+   {
+      FreeContextWork(ctx);
+      return(FALSE);
+   }
+   ctx->workDim = dim;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void FreeContextWork(ALIGNCONTEXT *ctx)
+   ----------------------------------------------
+*//**
+
+   \param[in,out] *ctx      Alignment context
+
+   Frees the work space in a context
+
+-  16.10.26 Original
+*/
+static void FreeContextWork(ALIGNCONTEXT *ctx)
+{
+   if(ctx->matrix != NULL)
+      blFreeArray2D((char **)ctx->matrix, ctx->workDim, ctx->workDim);
+   if(ctx->dirn != NULL)
+      blFreeArray2D(ctx->dirn, ctx->workDim, ctx->workDim);
+   ctx->matrix  = NULL;
+   ctx->dirn    = NULL;
+   ctx->workDim = 0;
+}
+
+
+/************************************************************************/
+/*>static void FreeContextMDM(ALIGNCONTEXT *ctx)
+   ---------------------------------------------
+*//**
+
+   \param[in,out] *ctx      Alignment context
+
+   Frees the matrix in a context
+
+-  16.10.26 Original
+*/
+static void FreeContextMDM(ALIGNCONTEXT *ctx)
+{
+   if(ctx->score != NULL)
+      blFreeArray2D((char **)ctx->score, ctx->size, ctx->size);
+   if(ctx->residues != NULL)
+      free(ctx->residues);
+   ctx->score    = NULL;
+   ctx->residues = NULL;
+   ctx->size     = 0;
+   BuildContextIndex(ctx);
+}
+
+
+/************************************************************************/
+/*>static void BuildContextIndex(ALIGNCONTEXT *ctx)
+   ------------------------------------------------
+*//**
+
+   \param[in,out] *ctx      Alignment context
+
+   Builds the table giving the MDM row for each residue character (-1 if
+   it is not in the matrix). Where a residue appears more than once the
+   first is used as the search in blCalcMDMScore() used to.
+
+-  16.10.26 Original
+*/
+static void BuildContextIndex(ALIGNCONTEXT *ctx)
+{
+   int i;
+   
+   for(i=0; i<256; i++)
+      ctx->index[i] = -1;
+   if(ctx->residues != NULL)
+   {
+      for(i=ctx->size-1; i>=0; i--)
+         ctx->index[(unsigned char)ctx->residues[i]] = i;
+   }
+}
+
+
+/************************************************************************/
+/*>static int *EncodeSeq(ALIGNCONTEXT *ctx, char *seq, int length, 
+                         BOOL upcase)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     *ctx      Alignment context
+   \param[in]     *seq      Sequence
+   \param[in]     length    Sequence length
+   \param[in]     upcase    Upcase residues first
+   \return                  Malloc'd MDM row for each residue (-1 if not
+                            in the MDM) or NULL if out of memory
+
+   Looks up each residue once so that the alignment can index the MDM
+   directly
+
+-  16.10.26 Original
+*/
+static int *EncodeSeq(ALIGNCONTEXT *ctx, char *seq, int length, 
+                      BOOL upcase)
+{
+   int  *code, i;
+   char res;
+   
+   if((code = (int *)malloc(MAX(length, 1) * sizeof(int)))==NULL)
+      return(NULL);
+   
+   for(i=0; i<length; i++)
+   {
+      res = seq[i];
+      if(upcase && islower(res))
+         res = toupper(res);
+      code[i] = MDMINDEX(ctx, res);
+   }
+   return(code);
+}
+
+
+/************************************************************************/
+/*>static int LinearAlign(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                          char *seq2, int length2, BOOL identity, 
+                          BOOL upcase, int penalty, int penext, 
+                          char *align1, char *align2, int *align_len)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *ctx          Alignment context for the MDM
+   
+   Other parameters and return as blAffinealignLinear()
+
+   Does the work for blAffinealignLinear() and blAffinealignLinearCtx()
+
+-  16.10.26 Original (split from blAffinealignLinear())
+*/
+static int LinearAlign(ALIGNCONTEXT *ctx,
+                       char *seq1, 
+                       int  length1, 
+                       char *seq2, 
+                       int  length2, 
+                       BOOL identity, 
+                       BOOL upcase,
+                       int  penalty, 
+                       int  penext,
+                       char *align1, 
+                       char *align2,
+                       int  *align_len)
+{
+   LINALIGN la;
+   int      score;
+
+   *align_len = 0;
+   if((length1 < 1) || (length2 < 1))
+      return(0);
+
+   la.seq1     = seq1;
+   la.seq2     = seq2;
+   la.align1   = align1;
+   la.align2   = align2;
+   la.length1  = length1;
+   la.length2  = length2;
+   la.identity = identity;
+   la.upcase   = upcase;
+   la.penalty  = penalty;
+   la.penext   = penext;
+   la.profile  = NULL;
+   la.ctx      = ctx;
+   
+   score = LinAlignRun(&la);
+   *align_len = la.ai;
+   return(score);
+}
+
+
+/************************************************************************/
+/*>static void BandAlignColumn(LINALIGN *la, int *M, int kmin, int kmax,
+                               int j, int *Dv, int *Dc)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in,out] *la       Linear-space alignment (la->dirn holds the 
+                            banded path directions)
+   \param[in,out] *M        Banded score matrix
+   \param[in]     kmin      First diagonal (i-j) in the band
+   \param[in]     kmax      Last diagonal in the band
+   \param[in]     j         Column (offset into second sequence)
+   \param[in,out] *Dv       Best gap score along each row
+   \param[in,out] *Dc       Column from which Dv comes (-1 if none yet)
+
+   Fills the cells of column j within the band exactly as 
+   LinAlignColumn() does, taking cells outside the band as unreachable.
+   The directions are stored as in LinAlignColumn().
+
+-  16.10.26 Original
+*/
+static void BandAlignColumn(LINALIGN *la, int *M, int kmin, int kmax, 
+                            int j, int *Dv, int *Dc)
+{
+   int  i, ilo, ihi,
+        dia, right, down, 
+        rcell = 0, 
+        dcell, 
+        Rv    = 0, 
+        cand,
+        n1    = la->length1,
+        n2    = la->length2,
+        width = kmax - kmin + 1;
+   long cell;
+   BOOL haveR = FALSE;
+
+   ilo = MAX(0,    j + kmin);
+   ihi = MIN(n1-1, j + kmax);
+
+   /* Bottom row and right hand column are just the residue scores      */
+   if(j == n2-1)
+   {
+      for(i=ilo; i<=ihi; i++)
+         M[BANDCELL(kmin, width, i, j)] = LinAlignScore(la, i, j);
+      return;
+   }
+   if(ihi == n1-1)
+   {
+      M[BANDCELL(kmin, width, ihi, j)] = LinAlignScore(la, ihi, j);
+      ihi--;
+   }
+
+   for(i=ihi; i>=ilo; i--)
+   {
+      cell = BANDCELL(kmin, width, i, j);
+      dia  = M[BANDCELL(kmin, width, i+1, j+1)];
+
+      /* Best score to right of diagonal. Rows above the band come 
+         first and are skipped
+      */
+      if(i == n1-2)
+      {
+         right = 0;
+         rcell = i+2;
+      }
+      else
+      {
+         if(INBAND(kmin, kmax, i+2, j+1))
+         {
+            cand = M[BANDCELL(kmin, width, i+2, j+1)] - la->penalty;
+            if(!haveR || (cand >= Rv - la->penext))
+            {
+               Rv    = cand;
+               rcell = i+2;
+               haveR = TRUE;
+            }
+            else
+            {
+               Rv   -= la->penext;
+            }
+         }
+         right = haveR ? Rv : ALIGN_BANDNEG;
+      }
+
+      /* Best score below diagonal. Only the first column in which the
+         row is in the band has no candidate
+      */
+      if(j == n2-2)
+      {
+         down  = 0;
+         dcell = j+2;
+      }
+      else
+      {
+         if(INBAND(kmin, kmax, i+1, j+2))
+         {
+            cand = M[BANDCELL(kmin, width, i+1, j+2)] - la->penalty;
+            if((Dc[i] < 0) || (cand >= Dv[i] - la->penext))
+            {
+               Dv[i] = cand;
+               Dc[i] = j+2;
+            }
+            else
+            {
+               Dv[i] -= la->penext;
+            }
+         }
+         else
+         {
+            Dc[i] = -1;
          }
+         down  = (Dc[i] < 0) ? ALIGN_BANDNEG : Dv[i];
+         dcell = Dc[i];
+      }
+
+      /* Set score to best of these                                     */
+      if(dia >= MAX(right, down))
+      {
+         M[cell]        = dia;
+         la->dirn[cell] = 0;
+      }
+      else if(right > down)
+      {
+         M[cell]        = right;
+         la->dirn[cell] = rcell;
+      }
+      else
+      {
+         M[cell]        = down;
+         la->dirn[cell] = -dcell;
       }
-   } 
-   
-   score = TraceBack(matrix, dirn, length1, length2,
-                     seq1, seq2, align1, align2, align_len);
+      
+      M[cell] += LinAlignScore(la, i, j);
+   }
+}
 
-   if(verbose)
+
+/************************************************************************/
+/*>static void BandAlignWalk(LINALIGN *la, int kmin, int kmax)
+   -----------------------------------------------------------
+*//**
+
+   \param[in,out] *la       Linear-space alignment (la->dirn holds the 
+                            banded path directions)
+   \param[in]     kmin      First diagonal (i-j) in the band
+   \param[in]     kmax      Last diagonal in the band
+
+   Follows the path from the cell set by LinAlignStart() building the
+   alignment as LinAlignWalk() does.
+
+-  16.10.26 Original
+-  16.10.26 No longer reports whether the path reached the edge of the
+            band. BandAlignExact() checks the result instead
+*/
+static void BandAlignWalk(LINALIGN *la, int kmin, int kmax)
+{
+   int  n1    = la->length1,
+        n2    = la->length2,
+        width = kmax - kmin + 1,
+        next;
+   char *seq1   = la->seq1,
+        *seq2   = la->seq2,
+        *align1 = la->align1,
+        *align2 = la->align2;
+
+   while(!la->done)
    {
-      printf("Matrix:\n-------\n");
-      for(j=0; j<length2;j++)
+      next = la->dirn[BANDCELL(kmin, width, la->i, la->j)];
+      la->i++;
+      la->j++;
+      
+      if(next > 0)
       {
-         for(i=0; i<length1; i++)
+         /* Gap in seq2                                                 */
+         while((la->i < next) && (la->i < n1-1))
          {
-            printf("%3d ",matrix[i][j]);
+            align1[la->ai]   = seq1[la->i++];
+            align2[la->ai++] = '-';
          }
-         printf("\n");
       }
-
-      printf("Path:\n-----\n");
-      for(j=0; j<length2;j++)
+      else if(next < 0)
       {
-         for(i=0; i<length1; i++)
+         /* Gap in seq1                                                 */
+         while((la->j < -next) && (la->j < n2-1))
          {
-            printf("(%3d,%3d) ",dirn[i][j].x,dirn[i][j].y);
+            align1[la->ai]   = '-';
+            align2[la->ai++] = seq2[la->j++];
          }
-         printf("\n");
       }
+
+      align1[la->ai]   = seq1[la->i];
+      align2[la->ai++] = seq2[la->j];
+      la->done = !((la->i < n1-1) && (la->j < n2-1));
    }
-    
-   blFreeArray2D((char **)matrix, maxdim, maxdim);
-   blFreeArray2D((char **)dirn,   maxdim, maxdim);
-    
-   return(score);
 }
 
 
 /************************************************************************/
-/*>BOOL blReadMDM(char *mdmfile)
-   -----------------------------
+/*>static int BandAlignRun(LINALIGN *la, int kmin, int kmax, 
+                           BOOL *exact)
+   ---------------------------------------------------------
 *//**
 
-   \param[in]     *mdmfile    Mutation data matrix filename
-   \return                      Success?
-   
-   Read mutation data matrix into static global arrays. The matrix may
-   have comments at the start introduced with a ! in the first column.
-   The matrix must be complete (i.e. a triangular matrix will not
-   work). A line describing the residue types must appear, and may
-   be placed before or after the matrix itself
-
--  07.10.92 Original
--  18.03.94 getc() -> fgetc()
--  24.11.94 Automatically looks in DATAENV if not found in current 
-            directory
--  28.02.95 Modified to read any size MDM and allow comments
-            Also allows the list of aa types before or after the actual
-            matrix
--  26.07.95 Removed unused variables
--  06.02.03 Fixed for new version of GetWord()
--  07.04.09 Completely re-written to allow it to read BLAST style matrix
-            files as well as the ones used previously
-            Allow comments introduced with # as well as !
-            Uses MAXWORD rather than hardcoded 16
--  07.07.14 Use bl prefix for functions By: CTP
+   \param[in,out] *la       Linear-space alignment with the sequences,
+                            scoring and output set up
+   \param[in]     kmin      First diagonal (i-j) in the band
+   \param[in]     kmax      Last diagonal in the band
+   \param[out]    *exact    Is the alignment the same as that from the
+                            whole matrix? (see BandAlignExact())
+   \return                  Alignment score (0 if out of memory)
+
+   Fills the band storing the scores and path directions, then finds 
+   the start of the path and follows it. On return la->ai is the 
+   alignment length (0 if out of memory).
+
+-  16.10.26 Original
+-  16.10.26 Checks the result with BandAlignExact() rather than 
+            reporting whether the path reached the edge of the band
 */
-BOOL blReadMDM(char *mdmfile)
+static int BandAlignRun(LINALIGN *la, int kmin, int kmax, BOOL *exact)
 {
-   FILE *mdm = NULL;
-   int  i, j, k, row, tmpStoreSize;
-   char buffer[MAXBUFF],
-        word[MAXWORD],
-        *p,
-        **tmpStore;
-   BOOL noenv;
-
-   if((mdm=blOpenFile(mdmfile, DATAENV, "r", &noenv))==NULL)
-   {
-      return(FALSE);
-   }
-
-   /* First read the file to determine the dimensions                   */
-   while(fgets(buffer,MAXBUFF,mdm))
+   int  *M    = NULL,
+        *Dv   = NULL,
+        *Dc   = NULL,
+        *col0 = NULL,
+        *row0 = NULL,
+        n1    = la->length1,
+        n2    = la->length2,
+        score = 0,
+        i, j;
+   long ncells = (long)n2 * (long)(kmax - kmin + 1);
+
+   *exact   = FALSE;
+   la->ai   = 0;
+   la->dirn = NULL;
+   
+   if(((M        = (int *)malloc(ncells * sizeof(int)))!=NULL) &&
+      ((la->dirn = (int *)malloc(ncells * sizeof(int)))!=NULL) &&
+      ((Dv       = (int *)malloc(n1 * sizeof(int)))!=NULL)     &&
+      ((Dc       = (int *)malloc(n1 * sizeof(int)))!=NULL)     &&
+      ((col0     = (int *)malloc(n1 * sizeof(int)))!=NULL)     &&
+      ((row0     = (int *)malloc(n2 * sizeof(int)))!=NULL))
    {
-      TERMINATE(buffer);
-      KILLLEADSPACES(p,buffer);
+      for(i=0; i<n1; i++)
+         Dc[i] = -1;
+      for(j=n2-1; j>=0; j--)
+         BandAlignColumn(la, M, kmin, kmax, j, Dv, Dc);
 
-      /* First line which is non-blank and non-comment                  */
-      if(strlen(p) && p[0] != '!' && p[0] != '#')
+      /* First column and row, with cells outside the band unreachable  */
+      for(i=0; i<n1; i++)
       {
-         sMDMSize = 0;
-         for(p = buffer; p!=NULL;)
-         {
-            p = blGetWord(p, word, MAXWORD);
-            /* Increment counter if this is numeric                     */
-            if(isdigit(word[0]) || 
-               ((word[0] == '-')&&(isdigit(word[1]))))
-               sMDMSize++;
-         }
-         if(sMDMSize)
-            break;
+         col0[i] = INBAND(kmin, kmax, i, 0) ? 
+                   M[BANDCELL(kmin, kmax-kmin+1, i, 0)] : ALIGN_BANDNEG;
+      }
+      for(j=0; j<n2; j++)
+      {
+         row0[j] = INBAND(kmin, kmax, 0, j) ? 
+                   M[BANDCELL(kmin, kmax-kmin+1, 0, j)] : ALIGN_BANDNEG;
       }
+
+      score    = LinAlignStart(la, col0, row0);
+      BandAlignWalk(la, kmin, kmax);
+      LinAlignFinish(la);
+
+      /* The path directions and gap scores are no longer needed so are
+         reused for the check
+      */
+      *exact   = BandAlignExact(la, la->dirn, Dv, kmin, kmax, score);
    }
+   
+   if(M        != NULL) free(M);
+   if(la->dirn != NULL) free(la->dirn);
+   if(Dv       != NULL) free(Dv);
+   if(Dc       != NULL) free(Dc);
+   if(col0     != NULL) free(col0);
+   if(row0     != NULL) free(row0);
+   la->dirn = NULL;
+   
+   return(score);
+}
 
-   /* Allocate memory for the MDM and the AA List                       */
-   if((sMDMScore = (int **)blArray2D(sizeof(int),sMDMSize,sMDMSize))==NULL)
+
+/************************************************************************/
+/*>static BOOL BandAlignExact(LINALIGN *la, int *F, int *D, int kmin, 
+                              int kmax, int score)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]     *la       Linear-space alignment
+   \param[out]    *F        Space for the band of the matrix
+   \param[out]    *D        Space for length1 integers
+   \param[in]     kmin      First diagonal (i-j) in the band
+   \param[in]     kmax      Last diagonal in the band
+   \param[in]     score     Best score within the band
+   \return                  Is the best alignment within the band?
+
+   Checks that no alignment which leaves the band could score as well 
+   as the best one within it. If none can, the alignment from the band
+   is the same as that from the whole matrix.
+
+   An alignment which leaves the band either starts outside it or 
+   leaves it, with a gap, from a cell in the band having come only 
+   through cells in the band. The best score of the part in the band is
+   found by filling the band forwards (into F). The score of the rest
+   is at most the sum, over the remaining residues of either sequence,
+   of the best score each residue has against any residue in the other
+   sequence (see BandBestSums()). If for every cell in the band, and 
+   for the starts outside it, this bound is below the score, the result
+   is exact. Otherwise it may not be.
+
+   If the gap penalties are negative, no bound can be given so the 
+   result is only exact if the band covers the whole matrix.
+
+-  16.10.26 Original
+*/
+static BOOL BandAlignExact(LINALIGN *la, int *F, int *D, int kmin, 
+                           int kmax, int score)
+{
+   int  n1     = la->length1,
+        n2     = la->length2,
+        width  = kmax - kmin + 1,
+        *best1 = NULL,
+        *best2 = NULL,
+        i, j, ilo, ihi,
+        io, jo,
+        R, cand, prev, bound;
+   long cell;
+   BOOL exact  = TRUE;
+
+   /* No cells outside the band                                         */
+   if((kmin <= -(n2-1)) && (kmax >= n1-1))
+      return(TRUE);
+   if((la->penalty < 0) || (la->penext < 0))
       return(FALSE);
-   if((sMDM_AAList = (char *)malloc((sMDMSize+1)*sizeof(char)))==NULL)
+   
+   if(((best1 = BandBestSums(la, TRUE))  == NULL) ||
+      ((best2 = BandBestSums(la, FALSE)) == NULL))
    {
-      blFreeArray2D((char **)sMDMScore, sMDMSize, sMDMSize);
+      if(best1 != NULL) free(best1);
       return(FALSE);
    }
 
-   /* Allocate temporary storage for a row from the matrix              */
-   tmpStoreSize = 2*sMDMSize;
-   if((tmpStore = (char **)blArray2D(sizeof(char), tmpStoreSize, MAXWORD))
-      ==NULL)
-   {
-      free(sMDM_AAList);
-      blFreeArray2D((char **)sMDMScore, sMDMSize, sMDMSize);
-      return(FALSE);
-   }
+   /* Alignments starting in the first column or row outside the band   */
+   if(((kmax+1 < n1) && (MIN(best1[kmax+1], best2[0]) >= score)) ||
+      ((1-kmin < n2) && (MIN(best1[0], best2[1-kmin]) >= score)))
+      exact = FALSE;
 
-   /* Fill the matrix with zeros                                        */
-   for(i=0; i<sMDMSize; i++)
-   {
-      for(j=0; j<sMDMSize; j++)
-      {
-         sMDMScore[i][j] = 0;
-      }
-   }
+   /* D[i] is the best score for a gap in seq1 ending in row i          */
+   for(i=0; i<n1; i++)
+      D[i] = ALIGN_BANDNEG;
 
-   /* Rewind the file and read the actual data                          */
-   rewind(mdm);
-   row = 0;
-   while(fgets(buffer,MAXBUFF,mdm))
+   for(j=0; (j<n2) && exact; j++)
    {
-      int Numeric;
-      
-      TERMINATE(buffer);
-      KILLLEADSPACES(p,buffer);
+      ilo = MAX(0,    j + kmin);
+      ihi = MIN(n1-1, j + kmax);
+      R   = ALIGN_BANDNEG;
 
-      /* Check line is non-blank and non-comment                        */
-      if(strlen(p) && p[0] != '!' && p[0] != '#')
+      for(i=ilo; i<=ihi; i++)
       {
-         Numeric = 0;
-         for(p = buffer, i = 0; p!=NULL && i<tmpStoreSize; i++)
+         cell = BANDCELL(kmin, width, i, j);
+
+         if((i == 0) || (j == 0))
          {
-            p = blGetWord(p, tmpStore[i], MAXWORD);
-            /* Incremement Numeric counter if it's a numeric field      */
-            if(isdigit(tmpStore[i][0]) || 
-               ((tmpStore[i][0] == '-')&&(isdigit(tmpStore[i][1]))))
+            prev = 0;
+         }
+         else
+         {
+            /* Diagonal, which is always in the band                    */
+            prev = F[BANDCELL(kmin, width, i-1, j-1)];
+
+            /* Gap in seq2 from column j-1                              */
+            if(INBAND(kmin, kmax, i-2, j-1) && (i >= 2))
             {
-               Numeric++;
+               cand = F[BANDCELL(kmin, width, i-2, j-1)] - la->penalty;
+               R    = MAX(R - la->penext, cand);
+            }
+            else
+            {
+               R   -= la->penext;
+            }
+            R    = MAX(R, ALIGN_BANDNEG);
+            prev = MAX(prev, R);
+
+            /* Gap in seq1 along row i-1                                */
+            if(INBAND(kmin, kmax, i-1, j-2) && (j >= 2))
+            {
+               cand    = F[BANDCELL(kmin, width, i-1, j-2)] - 
+                         la->penalty;
+               D[i-1]  = MAX(D[i-1] - la->penext, cand);
+            }
+            else
+            {
+               D[i-1] -= la->penext;
             }
+            D[i-1] = MAX(D[i-1], ALIGN_BANDNEG);
+            prev   = MAX(prev, D[i-1]);
          }
+         F[cell] = prev + LinAlignScore(la, i, j);
 
-         /* No numeric fields so it is the amino acid names             */
-         if(Numeric == 0)
+         /* Nearest cells outside the band reachable with a gap from 
+            here, since the bounds fall the further on they are
+         */
+         io = j + kmax + 2;
+         if((io < n1) && (j+1 < n2))
          {
-            for(j = 0; j<i && j<sMDMSize; j++)
+            bound = F[cell] - la->penalty - (io-i-2) * la->penext +
+                    MIN(best1[io], best2[j+1]);
+            if(bound >= score)
             {
-               sMDM_AAList[j] = tmpStore[j][0];
+               exact = FALSE;
+               break;
             }
          }
-         else
+         jo = i - kmin + 2;
+         if((jo < n2) && (i+1 < n1))
          {
-            /* There were numeric fields, so copy them into the matrix,
-               skipping any non-numeric fields
-               j counts the input fields
-               k counts the fields in sMDMScore
-               row counts the row in sMDMScore
-            */
-            for(j=0, k=0; j<i && k<sMDMSize; j++)
+            bound = F[cell] - la->penalty - (jo-j-2) * la->penext +
+                    MIN(best1[i+1], best2[jo]);
+            if(bound >= score)
             {
-               if(isdigit(tmpStore[j][0]) || 
-                  ((tmpStore[j][0] == '-')&&(isdigit(tmpStore[j][1]))))
-               {
-                  sscanf(tmpStore[j],"%d",&(sMDMScore[row][k]));
-                  k++;
-               }
+               exact = FALSE;
+               break;
             }
-            
-            row++;
          }
       }
    }
-   fclose(mdm);
-   blFreeArray2D((char **)tmpStore, tmpStoreSize, MAXWORD);
-   
-   return(TRUE);
-}
-
-
-/************************************************************************/
-/*>static int SearchForBest(int **matrix, int length1, int length2, 
-                            int *BestI, int *BestJ, char *seq1, 
-                            char *seq2, char *align1, char *align2)
-   ----------------------------------------------------------------
-*//**
-
-   \param[in]     **matrix   N&W matrix
-   \param[in]     length1    Length of first sequence
-   \param[in]     length2    Length of second sequence
-   \param[in]     *BestI     x position of highest score
-   \param[in]     *BestJ     y position of highest score
-   \param[in]     *seq1      First sequence
-   \param[in]     *seq2      Second sequence
-   \param[out]    *align1    First sequence with end aligned correctly
-   \param[out]    *align2    Second sequence with end aligned correctly
-   \return                     Alignment length thus far
-
-   Searches the outside of the matrix for the best score and starts the
-   alignment by putting in any starting - characters.
-
--  08.10.92 Original extracted from Align()
-*/
-static int SearchForBest(int  **matrix, 
-                         int  length1, 
-                         int  length2, 
-                         int  *BestI, 
-                         int  *BestJ,
-                         char *seq1, 
-                         char *seq2, 
-                         char *align1, 
-                         char *align2)
-{
-   int   ai, 
-         besti,   bestj, 
-         i,       j;
-   
-   /* Now search the outside of the matrix for the highest scoring cell */
-   ai    = 0;
-   besti = 0;
-   for(i = 1; i < length1; i++) 
-   {
-      if(matrix[i][0] > matrix[besti][0]) besti = i;
-   }
-   bestj = 0;
-   for(j = 1; j < length2; j++)
-   {
-      if(matrix[0][j] > matrix[0][bestj]) bestj = j;
-   }
-   if(matrix[besti][0] > matrix[0][bestj])
-   {
-      *BestI = besti;
-      *BestJ = 0;
-      for(i=0; i<*BestI; i++)
-      {
-         align1[ai] = seq1[i];
-         align2[ai++] = '-';
-      }
-   }
-   else
-   {
-      *BestI = 0;
-      *BestJ = bestj;
-      for(j=0; j<*BestJ; j++)
-      {
-         align1[ai] = '-';
-         align2[ai++] = seq2[j];
-      }
-   }
-   return(ai);
-}
 
+   free(best1);
+   free(best2);
+   return(exact);
+}
 
-/************************************************************************/
-/*>static int TraceBack(int **matrix, XY **dirn, 
-                        int length1, int length2, 
-                        char *seq1, char *seq2, char *align1, 
-                        char *align2, int *align_len)
-   ----------------------------------------------------------
-*//**
-   \param[in]     **matrix   N&W matrix
-   \param[in]     **dirn     Direction Matrix
-   \param[in]     length1    Length of first sequence
-   \param[in]     length2    Length of second sequence
-   \param[in]     *seq1      First sequence
-   \param[in]     *seq2      Second sequence
-   \param[out]    *align1    First sequence aligned
-   \param[out]    *align2    Second sequence aligned
-   \param[out]    *align_len Aligned sequence length
-   \return                     Alignment score
-
-   Does the traceback to find the aligment.
 
--  08.10.92 Original extracted from Align(). Rewritten to do tracing
-            correctly.
--  09.10.92 Changed to call SearchForBest(). Nor returns score rather than
-            length.
--  06.03.00 Recoded to take the path matrix which is calculated within
-            the main affinealign() routine rather than calculating the
-            path as we go. penalty parameter removed as this is no longer
-            needed. dirn parameter added.
--  28.09.00 Fixed bug where last inserts were printed properly if one chain
-            ended first
-*/
-static int TraceBack(int  **matrix, 
-                     XY   **dirn,
-                     int  length1, 
-                     int  length2, 
-                     char *seq1, 
-                     char *seq2, 
-                     char *align1, 
-                     char *align2, 
-                     int  *align_len)
-{
-   int   i,    j, 
-         ai, 
-         BestI,BestJ;
-   XY    nextCell;
+/************************************************************************/
+/*>static int *BandBestSums(LINALIGN *la, BOOL first)
+   --------------------------------------------------
+*//**
 
-   ai = SearchForBest(matrix, length1, length2, &BestI, &BestJ, 
-                       seq1, seq2, align1, align2);
+   \param[in]     *la       Linear-space alignment
+   \param[in]     first     TRUE: for the first sequence
+                            FALSE: for the second sequence
+   \return                  Array of length+1 sums (NULL if out of
+                            memory)
 
-   /* Now trace back to find the alignment                              */
-   i            = BestI;
-   j            = BestJ;
-   align1[ai]   = seq1[i];
-   align2[ai++] = seq2[j];
+   For each position, finds the best score of the residue there against
+   any residue in the other sequence (or 0 if that is higher). Returns
+   the sums of these from each position to the end of the sequence, so
+   element i is an upper bound on the score of aligning the sequence 
+   from position i onwards. Each residue type is only scored once
+   against each residue type in the other sequence.
 
-   while(i < length1-1 && j < length2-1)
+-  16.10.26 Original
+*/
+static int *BandBestSums(LINALIGN *la, BOOL first)
+{
+   int  *sums,
+        *other,
+        bestres[256],
+        nother = 0,
+        seen[256],
+        length  = first ? la->length1 : la->length2,
+        olength = first ? la->length2 : la->length1,
+        i, k, sc;
+   char *seq    = first ? la->seq1 : la->seq2,
+        *oseq   = first ? la->seq2 : la->seq1;
+
+   if((sums = (int *)malloc((length+1) * sizeof(int)))==NULL)
+      return(NULL);
+   if((other = (int *)malloc(olength * sizeof(int)))==NULL)
    {
-      nextCell.x = dirn[i][j].x;
-      nextCell.y = dirn[i][j].y;
-      if((nextCell.x == i+1) && (nextCell.y == j+1))
-      {
-         /* We are inheriting from the diagonal                         */
-         i++;
-         j++;
-      }
-      else if(nextCell.y == j+1)
+      free(sums);
+      return(NULL);
+   }
+
+   /* A position of each residue type in the other sequence             */
+   for(k=0; k<256; k++)
+   {
+      seen[k]    = FALSE;
+      bestres[k] = -1;
+   }
+   for(i=0; i<olength; i++)
+   {
+      if(!seen[(unsigned char)oseq[i]])
       {
-         /* We are inheriting from the off-diagonal inserting a gap in
-            the y-sequence (seq2)
-         */
-         i++;
-         j++;
-         while((i < nextCell.x) && (i < length1-1))
-         {
-            align1[ai] = seq1[i++];
-            align2[ai++] = '-';
-         }
+         seen[(unsigned char)oseq[i]] = TRUE;
+         other[nother++] = i;
       }
-      else if(nextCell.x == i+1)
+   }
+
+   sums[length] = 0;
+   for(i=length-1; i>=0; i--)
+   {
+      if(bestres[(unsigned char)seq[i]] < 0)
       {
-         /* We are inheriting from the off-diagonal inserting a gap in
-            the x-sequence (seq1)
-         */
-         i++;
-         j++;
-         while((j < nextCell.y) && (j < length2-1))
+         bestres[(unsigned char)seq[i]] = 0;
+         for(k=0; k<nother; k++)
          {
-            align1[ai] = '-';
-            align2[ai++] = seq2[j++];
+            sc = first ? LinAlignScore(la, i, other[k]) :
+                         LinAlignScore(la, other[k], i);
+            if(sc > bestres[(unsigned char)seq[i]])
+               bestres[(unsigned char)seq[i]] = sc;
          }
       }
-      else
-      {
-         /* Cockup!                                                     */
-         fprintf(stderr,"align.c/TraceBack() internal error\n");
-      }
-      
-      align1[ai]   = seq1[i];
-      align2[ai++] = seq2[j];
+      sums[i] = sums[i+1] + bestres[(unsigned char)seq[i]];
    }
 
-   /* If one sequence finished first, fill in the end with insertions   */
-   if(i < length1-1)
+   free(other);
+   return(sums);
+}
+
+
+/************************************************************************/
+/*>static int BandedAlign(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                          char *seq2, int length2, BOOL identity, 
+                          BOOL upcase, int penalty, int penext, int band,
+                          char *align1, char *align2, int *align_len)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *ctx          Alignment context for the MDM
+   
+   Other parameters and return as blAffinealignBanded()
+
+   Does the work for blAffinealignBanded() and blAffinealignBandedCtx()
+
+-  16.10.26 Original
+-  16.10.26 Widens the band until BandAlignExact() says the result is
+            exact
+*/
+static int BandedAlign(ALIGNCONTEXT *ctx,
+                       char *seq1, 
+                       int  length1, 
+                       char *seq2, 
+                       int  length2, 
+                       BOOL identity, 
+                       BOOL upcase,
+                       int  penalty, 
+                       int  penext,
+                       int  band,
+                       char *align1, 
+                       char *align2,
+                       int  *align_len)
+{
+   LINALIGN la;
+   int      kmin, kmax,
+            score = 0;
+   BOOL     exact = FALSE;
+
+   *align_len = 0;
+   if((length1 < 1) || (length2 < 1))
+      return(0);
+   if(band < 1)
+      band = ALIGN_BANDWIDTH;
+
+   la.seq1     = seq1;
+   la.seq2     = seq2;
+   la.align1   = align1;
+   la.align2   = align2;
+   la.length1  = length1;
+   la.length2  = length2;
+   la.identity = identity;
+   la.upcase   = upcase;
+   la.penalty  = penalty;
+   la.penext   = penext;
+   la.profile  = NULL;
+   la.ctx      = ctx;
+   la.ai       = 0;
+
+   /* Look up the residues in the MDM once                              */
+   la.code1 = la.code2 = NULL;
+   if(!identity)
    {
-      for(j=i+1; j<length1; j++)
+      if(((la.code1 = EncodeSeq(ctx, seq1, length1, upcase))==NULL) ||
+         ((la.code2 = EncodeSeq(ctx, seq2, length2, upcase))==NULL))
       {
-         align1[ai]   = seq1[j];
-         align2[ai++] = '-';
+         if(la.code1 != NULL) free(la.code1);
+         return(0);
       }
    }
-   else if(j < length2-1)
+
+   while(!exact)
    {
-      for(i=j+1; i<length2; i++)
+      /* Diagonals between the two ends plus band either side, clipped
+         to the matrix
+      */
+      kmin = MAX(MIN(0, length1-length2) - band, -(length2-1));
+      kmax = MIN(MAX(0, length1-length2) + band, length1-1);
+
+      /* If the band is the whole matrix and that is too big to store,
+         use the linear-space code
+      */
+      if((kmin == -(length2-1)) && (kmax == length1-1) &&
+         (((long)length1 * (long)length2) > ALIGN_MAXFULLCELLS))
       {
-         align1[ai]   = '-';
-         align2[ai++] = seq2[i];
+         if(la.code1 != NULL) free(la.code1);
+         if(la.code2 != NULL) free(la.code2);
+         return(LinearAlign(ctx, seq1, length1, seq2, length2, identity,
+                            upcase, penalty, penext, 
+                            align1, align2, align_len));
       }
+      
+      score = BandAlignRun(&la, kmin, kmax, &exact);
+      if(la.ai == 0)
+         break;
+
+      band *= 2;
    }
-   
-   *align_len = ai;
-   
-   return(matrix[BestI][BestJ]);
+
+   if(la.code1 != NULL) free(la.code1);
+   if(la.code2 != NULL) free(la.code2);
+
+   *align_len = la.ai;
+   return(score);
 }
 
 
 /************************************************************************/
-/*>int blCalcMDMScore(char resa, char resb)
-   ----------------------------------------
+/*>int blCalcMDMScoreCtx(ALIGNCONTEXT *ctx, char resa, char resb)
+   --------------------------------------------------------------
 *//**
 
+   \param[in,out] *ctx      Alignment context (NULL for the default)
    \param[in]     resa      First residue
    \param[in]     resb      Second residue
    \return                      score
 
-   Calculate score from static globally stored mutation data matrix
+   Calculate score from the mutation data matrix in an alignment context
 
 -  07.10.92 Adapted from NIMR-written original
 -  24.11.94 Only gives 10 warnings
@@ -1209,47 +3226,114 @@ static int TraceBack(int  **matrix,
             reference causing a potential core dump
 -  11.07.96 Name changed from calcscore() and now non-static
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Renamed from blCalcMDMScore() and takes an alignment context
+            which also holds the warning count
+-  16.10.26 Uses the residue index rather than searching the residues
+-  16.10.26 Body moved to CalcMDMScoreWarn() with its own warning count
 */
-int blCalcMDMScore(char resa, char resb)
+int blCalcMDMScoreCtx(ALIGNCONTEXT *ctx, char resa, char resb)
+{
+   ctx = CONTEXT(ctx);
+   return(CalcMDMScoreWarn(ctx, resa, resb, 
+                           &(ctx->nwarn[ALIGN_WARN_SCORE])));
+}
+
+/************************************************************************/
+/*>static int CalcMDMScoreWarn(ALIGNCONTEXT *ctx, char resa, char resb,
+                               int *nwarn)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]     *ctx      Alignment context
+   \param[in]     resa      First residue
+   \param[in]     resb      Second residue
+   \param[in,out] *nwarn    Count of warnings given
+   \return                  score
+
+   Does the work for blCalcMDMScoreCtx() and blCalcMDMScoreUCCtx(),
+   each of which has its own count of the warnings given for residues
+   not in the matrix.
+
+-  16.10.26 Original split from blCalcMDMScoreCtx()
+*/
+static int CalcMDMScoreWarn(ALIGNCONTEXT *ctx, char resa, char resb,
+                            int *nwarn)
 {
    int        i,j;
-   static int NWarn = 0;
    BOOL       Warned = FALSE;
 
-   for(i=0;i<sMDMSize;i++)
-   {
-      if(resa==sMDM_AAList[i]) break;
-   }
-   if(i==sMDMSize) 
+   if((i = MDMINDEX(ctx, resa)) < 0)
    {
-      if(NWarn < 10)
+      if(*nwarn < 10)
          printf("Residue %c not found in matrix\n",resa);
-      else if(NWarn == 10)
+      else if(*nwarn == 10)
          printf("More residues not found in matrix...\n");
       Warned = TRUE;
    }
-   for(j=0;j<sMDMSize;j++)
-   {
-      if(resb==sMDM_AAList[j]) break;
-   }
-   if(j==sMDMSize) 
+   if((j = MDMINDEX(ctx, resb)) < 0)
    {
-      if(NWarn < 10)
+      if(*nwarn < 10)
          printf("Residue %c not found in matrix\n",resb);
-      else if(NWarn == 10)
+      else if(*nwarn == 10)
          printf("More residues not found in matrix...\n");
       Warned = TRUE;
    }
    
    if(Warned)
    { 
-      NWarn++;
+      (*nwarn)++;
       return(0);
    }
 
-   return(sMDMScore[i][j]);
+   return(ctx->score[i][j]);
+}
+
+/************************************************************************/
+/*>int blCalcMDMScore(char resa, char resb)
+   ----------------------------------------
+*//**
+
+   \param[in]     resa      First residue
+   \param[in]     resb      Second residue
+   \return                      score
+
+   Calculate score from the mutation data matrix in the default 
+   alignment context
+
+-  07.10.92 Adapted from NIMR-written original
+-  16.10.26 Now a wrapper to blCalcMDMScoreCtx()
+*/
+int blCalcMDMScore(char resa, char resb)
+{
+   return(blCalcMDMScoreCtx(NULL, resa, resb));
 }                               
 
+/************************************************************************/
+/*>int blCalcMDMScoreUCCtx(ALIGNCONTEXT *ctx, char resa, char resb)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in,out] *ctx      Alignment context (NULL for the default)
+   \param[in]     resa      First residue
+   \param[in]     resb      Second residue
+   \return                      score
+
+   As blCalcMDMScoreCtx() but upcases the residues first
+
+-  16.10.26 Original based on blCalcMDMScoreUC()
+-  16.10.26 Has its own warning count
+*/
+int blCalcMDMScoreUCCtx(ALIGNCONTEXT *ctx, char resa, char resb)
+{
+   ctx  = CONTEXT(ctx);
+   resa = (islower(resa)?toupper(resa):resa);
+   resb = (islower(resb)?toupper(resb):resb);
+
+   return(CalcMDMScoreWarn(ctx, resa, resb, 
+                           &(ctx->nwarn[ALIGN_WARN_SCOREUC])));
+}
+
+
 /************************************************************************/
 /*>int blCalcMDMScoreUC(char resa, char resb)
    ------------------------------------------
@@ -1259,7 +3343,8 @@ int blCalcMDMScore(char resa, char resb)
    \param[in]     resb      Second residue
    \return                      score
 
-   Calculate score from static globally stored mutation data matrix
+   Calculate score from the mutation data matrix in the default 
+   alignment context
 
 -  07.10.92 Adapted from NIMR-written original
 -  24.11.94 Only gives 10 warnings
@@ -1269,79 +3354,47 @@ int blCalcMDMScore(char resa, char resb)
 -  11.07.96 Name changed from calcscore() and now non-static
 -  27.02.07 As CalcMDMScore() but upcases characters before comparison
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Now a wrapper to blCalcMDMScoreUCCtx()
 */
 int blCalcMDMScoreUC(char resa, char resb)
 {
-   int        i,j;
-   static int NWarn = 0;
-   BOOL       Warned = FALSE;
-
-   resa = (islower(resa)?toupper(resa):resa);
-   resb = (islower(resb)?toupper(resb):resb);
-
-   for(i=0;i<sMDMSize;i++)
-   {
-      if(resa==sMDM_AAList[i]) break;
-   }
-   if(i==sMDMSize) 
-   {
-      if(NWarn < 10)
-         printf("Residue %c not found in matrix\n",resa);
-      else if(NWarn == 10)
-         printf("More residues not found in matrix...\n");
-      Warned = TRUE;
-   }
-   for(j=0;j<sMDMSize;j++)
-   {
-      if(resb==sMDM_AAList[j]) break;
-   }
-   if(j==sMDMSize) 
-   {
-      if(NWarn < 10)
-         printf("Residue %c not found in matrix\n",resb);
-      else if(NWarn == 10)
-         printf("More residues not found in matrix...\n");
-      Warned = TRUE;
-   }
-   
-   if(Warned)
-   { 
-      NWarn++;
-      return(0);
-   }
-
-   return(sMDMScore[i][j]);
+   return(blCalcMDMScoreUCCtx(NULL, resa, resb));
 }                               
 
 /************************************************************************/
-/*>int blZeroMDM(void)
-   -------------------
+/*>int blZeroMDMCtx(ALIGNCONTEXT *ctx)
+   ----------------------------------
 *//**
 
+   \param[in,out] *ctx      Alignment context (NULL for the default)
    \return                   Maximum value in modified matrix
 
    Modifies all values in the MDM such that the minimum value is 0
 -  17.09.96 Original
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Renamed from blZeroMDM() and takes an alignment context
 */
-int blZeroMDM(void)
+int blZeroMDMCtx(ALIGNCONTEXT *ctx)
 {
-   int MinVal = sMDMScore[0][0],
-       MaxVal = sMDMScore[0][0],
+   int MinVal, MaxVal,
        i, j;
 
+   ctx    = CONTEXT(ctx);
+   MinVal = ctx->score[0][0];
+   MaxVal = ctx->score[0][0];
+
    /* Find the minimum and maximum values on the matrix                 */
-   for(i=0; i<sMDMSize; i++)
+   for(i=0; i<ctx->size; i++)
    {
-      for(j=0; j<sMDMSize; j++)
+      for(j=0; j<ctx->size; j++)
       {
-         if(sMDMScore[i][j] < MinVal)
+         if(ctx->score[i][j] < MinVal)
          {
-            MinVal = sMDMScore[i][j];
+            MinVal = ctx->score[i][j];
          }
-         else if(sMDMScore[i][j] > MaxVal)
+         else if(ctx->score[i][j] > MaxVal)
          {
-            MaxVal = sMDMScore[i][j];
+            MaxVal = ctx->score[i][j];
          }
       }
    }
@@ -1349,11 +3402,11 @@ int blZeroMDM(void)
    /* Now subtract the MinVal from all cells in the matrix so it starts
       at zero.
    */
-   for(i=0; i<sMDMSize; i++)
+   for(i=0; i<ctx->size; i++)
    {
-      for(j=0; j<sMDMSize; j++)
+      for(j=0; j<ctx->size; j++)
       {
-         sMDMScore[i][j] -= MinVal;
+         ctx->score[i][j] -= MinVal;
       }
    }
    
@@ -1362,10 +3415,29 @@ int blZeroMDM(void)
 }
 
 /************************************************************************/
-/*>void blSetMDMScoreWeight(char resa, char resb, REAL weight)
-   -----------------------------------------------------------
+/*>int blZeroMDM(void)
+   -------------------
+*//**
+
+   \return                   Maximum value in modified matrix
+
+   Modifies all values in the MDM in the default alignment context such
+   that the minimum value is 0
+-  17.09.96 Original
+-  16.10.26 Now a wrapper to blZeroMDMCtx()
+*/
+int blZeroMDM(void)
+{
+   return(blZeroMDMCtx(NULL));
+}
+
+/************************************************************************/
+/*>void blSetMDMScoreWeightCtx(ALIGNCONTEXT *ctx, char resa, char resb,
+                                REAL weight)
+   ---------------------------------------------------------------------
 *//**
 
+   \param[in,out] *ctx      Alignment context (NULL for the default)
    \param[in]     resa      First residue
    \param[in]     resb      Second residue
    \param[in]     weight    Weight to apply
@@ -1373,53 +3445,69 @@ int blZeroMDM(void)
    Apply a weight to a particular amino acid substitution
 
 -  26.08.14 Original   By: ACRM
+-  16.10.26 Renamed from blSetMDMScoreWeight() and takes an alignment
+            context. Uses the residue index
 */
-void blSetMDMScoreWeight(char resa, char resb, REAL weight)
+void blSetMDMScoreWeightCtx(ALIGNCONTEXT *ctx, char resa, char resb, 
+                            REAL weight)
 {
    int        i,j;
-   static int NWarn = 0;
    BOOL       Warned = FALSE;
 
+   ctx = CONTEXT(ctx);
+
    resa = (islower(resa)?toupper(resa):resa);
    resb = (islower(resb)?toupper(resb):resb);
 
-   for(i=0;i<sMDMSize;i++)
+   if((i = MDMINDEX(ctx, resa)) < 0)
    {
-      if(resa==sMDM_AAList[i]) break;
-   }
-   if(i==sMDMSize) 
-   {
-      if(NWarn < 10)
+      if(ctx->nwarn[ALIGN_WARN_WEIGHT] < 10)
          printf("Residue %c not found in matrix\n",resa);
-      else if(NWarn == 10)
+      else if(ctx->nwarn[ALIGN_WARN_WEIGHT] == 10)
          printf("More residues not found in matrix...\n");
       Warned = TRUE;
    }
-   for(j=0;j<sMDMSize;j++)
-   {
-      if(resb==sMDM_AAList[j]) break;
-   }
-   if(j==sMDMSize) 
+   if((j = MDMINDEX(ctx, resb)) < 0)
    {
-      if(NWarn < 10)
+      if(ctx->nwarn[ALIGN_WARN_WEIGHT] < 10)
          printf("Residue %c not found in matrix\n",resb);
-      else if(NWarn == 10)
+      else if(ctx->nwarn[ALIGN_WARN_WEIGHT] == 10)
          printf("More residues not found in matrix...\n");
       Warned = TRUE;
    }
    
    if(Warned)
    { 
-      NWarn++;
+      ctx->nwarn[ALIGN_WARN_WEIGHT]++;
       return;
    }
 
-   sMDMScore[i][j] *= weight;
+   ctx->score[i][j] *= weight;
    if(i != j)
    {
-      sMDMScore[j][i] *= weight;
+      ctx->score[j][i] *= weight;
    }
 }
+
+/************************************************************************/
+/*>void blSetMDMScoreWeight(char resa, char resb, REAL weight)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     resa      First residue
+   \param[in]     resb      Second residue
+   \param[in]     weight    Weight to apply
+
+   Apply a weight to a particular amino acid substitution in the default
+   alignment context
+
+-  26.08.14 Original   By: ACRM
+-  16.10.26 Now a wrapper to blSetMDMScoreWeightCtx()
+*/
+void blSetMDMScoreWeight(char resa, char resb, REAL weight)
+{
+   blSetMDMScoreWeightCtx(NULL, resa, resb, weight);
+}
             
       
 #ifdef DEMO   
@@ -1434,17 +3522,17 @@ int main(int argc, char **argv)
    
    ReadMDM("pet91.mat");
 
-   for(i=0; i<sMDMSize; i++)
+   for(i=0; i<sDefaultContext.size; i++)
    {
-      printf("  %c", sMDM_AAList[i]);
+      printf("  %c", sDefaultContext.residues[i]);
    }
    printf("\n");
    
-   for(i=0; i<sMDMSize; i++)
+   for(i=0; i<sDefaultContext.size; i++)
    {
-      for(j=0; j<sMDMSize; j++)
+      for(j=0; j<sDefaultContext.size; j++)
       {
-         printf("%3d", sMDMScore[i][j]);
+         printf("%3d", sDefaultContext.score[i][j]);
       }
       printf("\n");
    }
@@ -1462,3 +3550,45 @@ int main(int argc, char **argv)
    return(0);
 }
 #endif
+
+
+/************************************************************************/
+/*>char *blGetMDMResiduesCtx(ALIGNCONTEXT *ctx, int *nres)
+   ------------------------------------------------------
+*//**
+
+   \param[in]     *ctx      Alignment context (NULL for the default)
+   \param[out]    *nres     Number of residue types in the MDM
+   \return                  Residue types (not NUL terminated) in the
+                            order of the rows of the MDM
+
+   Gives the residue types of the matrix read by blReadMDMCtx() so that
+   scores may be tabulated (e.g. by blBuildAlignProfile()). The array
+   must not be modified or freed.
+
+-  16.10.26 Original
+*/
+char *blGetMDMResiduesCtx(ALIGNCONTEXT *ctx, int *nres)
+{
+   ctx   = CONTEXT(ctx);
+   *nres = ctx->size;
+   return(ctx->residues);
+}
+
+
+/************************************************************************/
+/*>char *blGetMDMResidues(int *nres)
+   ---------------------------------
+*//**
+
+   \param[out]    *nres     Number of residue types in the MDM
+   \return                  Residue types (not NUL terminated)
+
+   As blGetMDMResiduesCtx() for the default alignment context
+
+-  16.10.26 Original
+*/
+char *blGetMDMResidues(int *nres)
+{
+   return(blGetMDMResiduesCtx(NULL, nres));
+}
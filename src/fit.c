@@ -3,8 +3,8 @@
 
    \file       fit.c
    
-   \version    V1.7
-   \date       17.07.14
+   \version    V1.10
+   \date       16.10.26
    \brief      Perform least squares fitting of coordinate sets
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
@@ -39,6 +39,10 @@
    This code performs least squares fitting of two coordinate set using
    the method of McLachlan as modified by Sutcliffe.
 
+   The quaternion characteristic polynomial (QCP) method of Theobald is
+   also provided. This is a closed form solution which is faster and
+   can give the RMSD without calculating the rotation matrix.
+
 **************************************************************************
 
    Usage:
@@ -46,6 +50,10 @@
    Passed two coordinate arrays both centred around the origin and,
    optionally, an array of weights, returns a rotation matrix.
 
+   blQCPfit() takes the same parameters as blMatfit(). blQCPfitRMSD()
+   also returns the RMSD and the matrix is optional. blQCPrmsd() just
+   returns the RMSD.
+
 **************************************************************************
 
    Revision History:
@@ -58,6 +66,14 @@
 -  V1.5  03.04.09 Initialize clep in qikfit() By: CTP
 -  V1.6  07.07.14 Use bl prefix for functions By: CTP
 -  V1.7  17.07.14 Removed unused varables  By: ACRM
+-  V1.8  16.10.26 Added QCP fitting
+-  V1.9  16.10.26 Added blQCPInnerRMSD()
+-  V1.10 16.10.26 Added blQCPInnerFit()
+-  V1.11 16.10.26 QCP falls back to the blMatfit() method when the 
+                  eigenvalue doesn't converge or the eigenvector is 
+                  degenerate (e.g. two points or collinear sets). The
+                  eigenvector cutoff is relative to the scale of the
+                  coordinates
 
 *************************************************************************/
 /* Doxygen
@@ -69,6 +85,24 @@
    length n. Optionally weighted with the wt1 array if wt1 is not NULL.
    If column is set the matrix will be returned column-wise rather 
    than row-wise.
+
+   #FUNCTION  blQCPfit()
+   As blMatfit() but uses the QCP method
+
+   #FUNCTION  blQCPfitRMSD()
+   Fits using the QCP method returning the RMSD and, optionally, the
+   rotation matrix
+
+   #FUNCTION  blQCPrmsd()
+   Calculates the RMSD after fitting using the QCP method without
+   calculating the rotation matrix
+
+   #FUNCTION  blQCPInnerRMSD()
+   Calculates the QCP RMSD from precalculated inner products
+
+   #FUNCTION  blQCPInnerFit()
+   Calculates the QCP RMSD and, optionally, the rotation matrix from
+   precalculated inner products
 */
 /************************************************************************/
 /* Includes
@@ -86,6 +120,14 @@
 #define SMALL  1.0e-20     /* Convergence cutoffs                       */
 #define SMALSN 1.0e-10
 
+#define QCP_EVALPREC 1.0e-11   /* QCP eigenvalue convergence            */
+#define QCP_EVECPREC 1.0e-12   /* QCP degenerate eigenvector cutoff,
+                                  relative to the 6th power of the
+                                  eigenvalue bound                      */
+#define QCP_ROOTPREC 1.0e-6    /* QCP repeated eigenvalue cutoff on the
+                                  derivative relative to e0 cubed       */
+#define QCP_MAXITER  50        /* Max QCP Newton-Raphson iterations     */
+
 /************************************************************************/
 /* Globals
 */
@@ -94,6 +136,10 @@
 /* Prototypes
 */
 static void qikfit(REAL umat[3][3], REAL rm[3][3], BOOL column);
+static BOOL QCPMaxEigenvalue(REAL A[3][3], REAL e0, REAL *eval);
+static BOOL QCPRotation(REAL A[3][3], REAL eval, REAL e0, REAL rm[3][3],
+                        BOOL column);
+static REAL QCPFallback(REAL A[3][3], REAL rm[3][3], BOOL column);
 
 /************************************************************************/
 /*>BOOL blMatfit(COOR *x1, COOR *x2, REAL rm[3][3], int n,
@@ -392,3 +438,515 @@ static void qikfit(REAL  umat[3][3],
             rm[i][j] = rot[i][j];
    }
 }
+
+
+/************************************************************************/
+/*>BOOL blQCPfit(COOR *x1, COOR *x2, REAL rm[3][3], int n,
+                 REAL *wt1, BOOL column)
+   -------------------------------------------------------
+*//**
+
+   \param[in]     *x1         First (fixed) array of coordinates
+   \param[in]     *x2         Second (mobile) array of coordinates
+   \param[in]     n           Number of coordinates
+   \param[in]     *wt1        Weight array or NULL
+   \param[in]     column      TRUE: Output a column-wise matrix (as used
+                                 by FRODO)
+                              FALSE: Output a standard row-wise matrix.
+   \param[out]    rm          Returned rotation matrix
+   \return                    TRUE:  success
+                              FALSE: error
+
+   A drop-in replacement for blMatfit() using the closed form 
+   quaternion characteristic polynomial (QCP) method of Theobald (2005)
+   Acta Cryst. A61, 478-480 with the rotation calculation of Liu et al.
+   (2010) J. Comput. Chem. 31, 1561-1563. The coordinates must be 
+   centred around the origin.
+
+-  16.10.26 Original
+*/
+BOOL blQCPfit(COOR *x1, COOR *x2, REAL rm[3][3], int n, REAL *wt1, 
+              BOOL column)
+{
+   REAL rmsd;
+   
+   return(blQCPfitRMSD(x1, x2, n, wt1, rm, column, &rmsd));
+}
+
+
+/************************************************************************/
+/*>REAL blQCPrmsd(COOR *x1, COOR *x2, int n, REAL *wt1)
+   ----------------------------------------------------
+*//**
+
+   \param[in]     *x1         First array of coordinates
+   \param[in]     *x2         Second array of coordinates
+   \param[in]     n           Number of coordinates
+   \param[in]     *wt1        Weight array or NULL
+   \return                    The RMSD after optimal superposition
+                              (-1 on error)
+
+   Calculates the minimum (weighted) RMSD between two coordinate sets
+   centred around the origin using QCP. The rotation matrix is not
+   calculated.
+
+-  16.10.26 Original
+*/
+REAL blQCPrmsd(COOR *x1, COOR *x2, int n, REAL *wt1)
+{
+   REAL rmsd;
+   
+   if(!blQCPfitRMSD(x1, x2, n, wt1, NULL, FALSE, &rmsd))
+      return((REAL)(-1.0));
+   return(rmsd);
+}
+
+
+/************************************************************************/
+/*>BOOL blQCPfitRMSD(COOR *x1, COOR *x2, int n, REAL *wt1, 
+                     REAL rm[3][3], BOOL column, REAL *rmsd)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]     *x1         First (fixed) array of coordinates
+   \param[in]     *x2         Second (mobile) array of coordinates
+   \param[in]     n           Number of coordinates
+   \param[in]     *wt1        Weight array or NULL
+   \param[out]    rm          Returned rotation matrix. May be NULL if
+                              only the RMSD is needed
+   \param[in]     column      TRUE: Output a column-wise matrix
+                              FALSE: Output a standard row-wise matrix.
+   \param[out]    *rmsd       The (weighted) RMSD after fitting
+   \return                    TRUE:  success
+                              FALSE: error
+
+   Fits x2 to x1, both centred around the origin, using QCP. The 
+   largest eigenvalue of the 4x4 key matrix is found by Newton-Raphson
+   on its characteristic polynomial, which gives the RMSD directly. The
+   rotation is only built from the corresponding eigenvector if rm is
+   not NULL. The rotation is the same as that from blMatfit() to within
+   the convergence limits of the two methods. Where the eigenvalue is 
+   repeated so QCP can't give a unique eigenvector (two points or a
+   collinear set), the blMatfit() method is used instead.
+
+-  16.10.26 Original
+*/
+BOOL blQCPfitRMSD(COOR *x1, COOR *x2, int n, REAL *wt1, 
+                  REAL rm[3][3], BOOL column, REAL *rmsd)
+{
+   REAL A[3][3],
+        g1 = 0.0,
+        g2 = 0.0,
+        wsum = 0.0;
+   int  i, j;
+
+   if(n<2)
+      return(FALSE);
+
+   for(i=0; i<3; i++)
+      for(j=0; j<3; j++)
+         A[i][j] = 0.0;
+
+   /* Build the correlation matrix and the inner products               */
+   for(j=0; j<n; j++)
+   {
+      REAL w  = (wt1 != NULL) ? wt1[j] : (REAL)1.0,
+           wx = w * x1[j].x,
+           wy = w * x1[j].y,
+           wz = w * x1[j].z;
+
+      g1 += wx * x1[j].x + wy * x1[j].y + wz * x1[j].z;
+      g2 += w * (x2[j].x * x2[j].x + 
+                 x2[j].y * x2[j].y + 
+                 x2[j].z * x2[j].z);
+      
+      A[0][0] += wx * x2[j].x;
+      A[0][1] += wx * x2[j].y;
+      A[0][2] += wx * x2[j].z;
+      A[1][0] += wy * x2[j].x;
+      A[1][1] += wy * x2[j].y;
+      A[1][2] += wy * x2[j].z;
+      A[2][0] += wz * x2[j].x;
+      A[2][1] += wz * x2[j].y;
+      A[2][2] += wz * x2[j].z;
+      wsum    += w;
+   }
+   return(blQCPInnerFit(A, g1, g2, wsum, rm, column, rmsd));
+}
+
+
+/************************************************************************/
+/*>REAL blQCPInnerRMSD(REAL A[3][3], REAL g1, REAL g2, REAL wsum)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     A           Correlation matrix: sum of (weighted)
+                              x1[i] * x2[j] products
+   \param[in]     g1          Sum of (weighted) squared coordinates of x1
+   \param[in]     g2          Sum of (weighted) squared coordinates of x2
+   \param[in]     wsum        Sum of the weights (or number of atoms)
+   \return                    The RMSD after optimal superposition
+                              (-1 on error)
+
+   The QCP RMSD calculation from precalculated inner products. Used 
+   when many pairs of structures are compared so that g1 and g2 need 
+   only be calculated once for each structure.
+
+-  16.10.26 Original
+-  16.10.26 Uses blQCPInnerFit() so that degenerate cases fall back
+            to the blMatfit() method. Returns -1 if wsum is not positive
+*/
+REAL blQCPInnerRMSD(REAL A[3][3], REAL g1, REAL g2, REAL wsum)
+{
+   REAL rmsd;
+
+   if(!blQCPInnerFit(A, g1, g2, wsum, NULL, FALSE, &rmsd))
+      return((REAL)(-1.0));
+   return(rmsd);
+}
+
+
+/************************************************************************/
+/*>BOOL blQCPInnerFit(REAL A[3][3], REAL g1, REAL g2, REAL wsum,
+                      REAL rm[3][3], BOOL column, REAL *rmsd)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]     A           Correlation matrix: sum of (weighted)
+                              x1[i] * x2[j] products
+   \param[in]     g1          Sum of (weighted) squared coordinates of x1
+   \param[in]     g2          Sum of (weighted) squared coordinates of x2
+   \param[in]     wsum        Sum of the weights (or number of atoms)
+   \param[out]    rm          Rotation matrix (may be NULL)
+   \param[in]     column      Return the matrix column-wise
+   \param[out]    *rmsd       The RMSD after optimal superposition
+   \return                    Success?
+
+   As blQCPInnerRMSD(), but also gives the rotation matrix as returned 
+   by blQCPfit()
+
+   If the eigenvalue doesn't converge, or its eigenvector can't be 
+   found because the eigenvalue is repeated, the rotation and RMSD 
+   come from the blMatfit() method instead.
+
+-  16.10.26 Original
+-  16.10.26 Falls back to the blMatfit() method for degenerate cases
+*/
+BOOL blQCPInnerFit(REAL A[3][3], REAL g1, REAL g2, REAL wsum,
+                   REAL rm[3][3], BOOL column, REAL *rmsd)
+{
+   REAL e0 = (g1 + g2) * 0.5,
+        eval,
+        rot[3][3];
+
+   if(wsum <= 0.0)
+      return(FALSE);
+
+   if(!QCPMaxEigenvalue(A, e0, &eval) ||
+      ((rm != NULL) && !QCPRotation(A, eval, e0, rm, column)))
+   {
+      eval = QCPFallback(A, ((rm != NULL) ? rm : rot), column);
+   }
+
+   *rmsd = sqrt(ABS(2.0 * (e0 - eval) / wsum));
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static REAL QCPMaxEigenvalue(REAL A[3][3], REAL e0)
+   ---------------------------------------------------
+*//**
+
+   \param[in]     A           Correlation matrix
+   \param[in]     e0          Upper bound on the eigenvalue (half the
+                              sum of the inner products)
+   \param[out]    *eval       Largest eigenvalue of the key matrix
+   \return                    Converged?
+
+   Finds the largest eigenvalue of the 4x4 QCP key matrix by 
+   Newton-Raphson on its characteristic polynomial starting from e0.
+   The eigenvalue must lie between 0 and e0; anything else (including 
+   NaN) means it has failed. If the largest eigenvalue is repeated, the
+   derivative of the polynomial vanishes there. The step can then be 
+   0/0 and, even when it isn't, the root can only be found to about the
+   square root of the machine precision, so this is also treated as
+   failure.
+
+-  16.10.26 Original
+-  16.10.26 Returns success. Detects a repeated root
+*/
+static BOOL QCPMaxEigenvalue(REAL A[3][3], REAL e0, REAL *eval)
+{
+   REAL Sxx = A[0][0], Sxy = A[0][1], Sxz = A[0][2],
+        Syx = A[1][0], Syy = A[1][1], Syz = A[1][2],
+        Szx = A[2][0], Szy = A[2][1], Szz = A[2][2],
+        Sxx2 = Sxx*Sxx, Syy2 = Syy*Syy, Szz2 = Szz*Szz,
+        Sxy2 = Sxy*Sxy, Syz2 = Syz*Syz, Sxz2 = Sxz*Sxz,
+        Syx2 = Syx*Syx, Szy2 = Szy*Szy, Szx2 = Szx*Szx,
+        SyzSzymSyySzz2       = 2.0*(Syz*Szy - Syy*Szz),
+        Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2,
+        Sxy2Sxz2Syx2Szx2     = Sxy2 + Sxz2 - Syx2 - Szx2,
+        SxzpSzx = Sxz + Szx,
+        SyzpSzy = Syz + Szy,
+        SxypSyx = Sxy + Syx,
+        SyzmSzy = Syz - Szy,
+        SxzmSzx = Sxz - Szx,
+        SxymSyx = Sxy - Syx,
+        SxxpSyy = Sxx + Syy,
+        SxxmSyy = Sxx - Syy,
+        c0, c1, c2,
+        ev   = e0,
+        tol  = QCP_EVALPREC * e0,
+        oldEval, x2, a, b, deriv = 0.0;
+   BOOL converged = FALSE;
+   int  i;
+
+   /* Coefficients of the characteristic polynomial                     */
+   c2 = -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 + Sxz2 + Szx2 + 
+                Syz2 + Szy2);
+   c1 =  8.0 * (Sxx*Syz*Szy + Syy*Szx*Sxz + Szz*Sxy*Syx - 
+                Sxx*Syy*Szz - Syz*Szx*Sxy - Szy*Syx*Sxz);
+   c0 = Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2
+      + (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2) * 
+        (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2)
+      + (-(SxzpSzx)*(SyzmSzy) + (SxymSyx)*(SxxmSyy-Szz)) * 
+        (-(SxzmSzx)*(SyzpSzy) + (SxymSyx)*(SxxmSyy+Szz))
+      + (-(SxzpSzx)*(SyzpSzy) - (SxypSyx)*(SxxpSyy-Szz)) * 
+        (-(SxzmSzx)*(SyzmSzy) - (SxypSyx)*(SxxpSyy+Szz))
+      + ( (SxypSyx)*(SyzpSzy) + (SxzpSzx)*(SxxmSyy+Szz)) * 
+        (-(SxymSyx)*(SyzmSzy) + (SxzpSzx)*(SxxpSyy+Szz))
+      + ( (SxypSyx)*(SyzmSzy) + (SxzmSzx)*(SxxmSyy-Szz)) * 
+        (-(SxymSyx)*(SyzpSzy) + (SxzmSzx)*(SxxpSyy-Szz));
+
+   /* Newton-Raphson from the upper bound                               */
+   for(i=0; i<QCP_MAXITER; i++)
+   {
+      oldEval = ev;
+      x2      = ev * ev;
+      b       = (x2 + c2) * ev;
+      a       = b + c1;
+      deriv   = 2.0 * x2 * ev + b + a;
+      if(deriv == 0.0)                     /* At a repeated root        */
+         break;
+      ev -= (a * ev + c0) / deriv;
+      if(ABS(ev - oldEval) < ABS(QCP_EVALPREC * ev))
+      {
+         converged = TRUE;
+         break;
+      }
+   }
+
+   *eval = ev;
+   
+   /* This also rejects NaN since comparisons with it are false         */
+   if(!converged || !((ev >= -tol) && (ev <= e0 + tol)))
+      return(FALSE);
+
+   /* Reject a repeated root                                            */
+   x2    = ev * ev;
+   deriv = 4.0 * x2 * ev + 2.0 * c2 * ev + c1;
+   if(ABS(deriv) <= QCP_ROOTPREC * e0 * e0 * e0)
+      return(FALSE);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void QCPRotation(REAL A[3][3], REAL eval, REAL rm[3][3],
+                           BOOL column)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]     A           Correlation matrix
+   \param[in]     eval        Largest eigenvalue of the key matrix
+   \param[in]     e0          Upper bound on the eigenvalue. Sets the
+                              scale for the degeneracy test
+   \param[out]    rm          Rotation matrix
+   \param[in]     column      TRUE: Create a column-wise matrix
+   \return                    FALSE if the eigenvector is degenerate
+
+   Finds the eigenvector (quaternion) for the largest eigenvalue from 
+   the cofactors of the shifted key matrix and converts it to a 
+   rotation matrix. If one column of cofactors is degenerate, the next
+   is tried. The cofactors scale as the cube of the matrix elements so
+   the test is made relative to e0 to the 6th power. If all columns 
+   are degenerate (a repeated eigenvalue), FALSE is returned and rm is 
+   not set.
+
+-  16.10.26 Original
+-  16.10.26 Degeneracy test is relative to the scale of the matrix.
+            Returns FALSE rather than the identity matrix if degenerate
+*/
+static BOOL QCPRotation(REAL A[3][3], REAL eval, REAL e0, REAL rm[3][3],
+                        BOOL column)
+{
+   REAL Sxx = A[0][0], Sxy = A[0][1], Sxz = A[0][2],
+        Syx = A[1][0], Syy = A[1][1], Syz = A[1][2],
+        Szx = A[2][0], Szy = A[2][1], Szz = A[2][2],
+        a11, a12, a13, a14, a21, a22, a23, a24,
+        a31, a32, a33, a34, a41, a42, a43, a44,
+        a3344_4334, a3244_4234, a3243_4233,
+        a3143_4133, a3144_4134, a3142_4132,
+        q1, q2, q3, q4, qsqr, normq,
+        a2, x2, y2, z2, xy, az, zx, ay, yz, ax,
+        evecprec,
+        rot[3][3];
+   int  i, j;
+
+   evecprec = e0 * e0 * e0;
+   evecprec = QCP_EVECPREC * evecprec * evecprec;
+
+   a11 = Sxx + Syy + Szz - eval;
+   a12 = Syz - Szy;
+   a13 = Szx - Sxz;
+   a14 = Sxy - Syx;
+   a21 = a12;
+   a22 = Sxx - Syy - Szz - eval;
+   a23 = Sxy + Syx;
+   a24 = Sxz + Szx;
+   a31 = a13;
+   a32 = a23;
+   a33 = Syy - Sxx - Szz - eval;
+   a34 = Syz + Szy;
+   a41 = a14;
+   a42 = a24;
+   a43 = a34;
+   a44 = Szz - Sxx - Syy - eval;
+
+   a3344_4334 = a33*a44 - a43*a34;
+   a3244_4234 = a32*a44 - a42*a34;
+   a3243_4233 = a32*a43 - a42*a33;
+   a3143_4133 = a31*a43 - a41*a33;
+   a3144_4134 = a31*a44 - a41*a34;
+   a3142_4132 = a31*a42 - a41*a32;
+
+   q1 =  a22*a3344_4334 - a23*a3244_4234 + a24*a3243_4233;
+   q2 = -a21*a3344_4334 + a23*a3144_4134 - a24*a3143_4133;
+   q3 =  a21*a3244_4234 - a22*a3144_4134 + a24*a3142_4132;
+   q4 = -a21*a3243_4233 + a22*a3143_4133 - a23*a3142_4132;
+   qsqr = q1*q1 + q2*q2 + q3*q3 + q4*q4;
+
+   if(qsqr <= evecprec)
+   {
+      q1 =  a12*a3344_4334 - a13*a3244_4234 + a14*a3243_4233;
+      q2 = -a11*a3344_4334 + a13*a3144_4134 - a14*a3143_4133;
+      q3 =  a11*a3244_4234 - a12*a3144_4134 + a14*a3142_4132;
+      q4 = -a11*a3243_4233 + a12*a3143_4133 - a13*a3142_4132;
+      qsqr = q1*q1 + q2*q2 + q3*q3 + q4*q4;
+
+      if(qsqr <= evecprec)
+      {
+         REAL a1324_1423 = a13*a24 - a14*a23, 
+              a1224_1422 = a12*a24 - a14*a22,
+              a1223_1322 = a12*a23 - a13*a22, 
+              a1124_1421 = a11*a24 - a14*a21,
+              a1123_1321 = a11*a23 - a13*a21, 
+              a1122_1221 = a11*a22 - a12*a21;
+
+         q1 =  a42*a1324_1423 - a43*a1224_1422 + a44*a1223_1322;
+         q2 = -a41*a1324_1423 + a43*a1124_1421 - a44*a1123_1321;
+         q3 =  a41*a1224_1422 - a42*a1124_1421 + a44*a1122_1221;
+         q4 = -a41*a1223_1322 + a42*a1123_1321 - a43*a1122_1221;
+         qsqr = q1*q1 + q2*q2 + q3*q3 + q4*q4;
+
+         if(qsqr <= evecprec)
+         {
+            q1 =  a32*a1324_1423 - a33*a1224_1422 + a34*a1223_1322;
+            q2 = -a31*a1324_1423 + a33*a1124_1421 - a34*a1123_1321;
+            q3 =  a31*a1224_1422 - a32*a1124_1421 + a34*a1122_1221;
+            q4 = -a31*a1223_1322 + a32*a1123_1321 - a33*a1122_1221;
+            qsqr = q1*q1 + q2*q2 + q3*q3 + q4*q4;
+         }
+      }
+   }
+
+   if(qsqr <= evecprec)
+      return(FALSE);
+   
+   normq = sqrt(qsqr);
+   q1 /= normq;
+   q2 /= normq;
+   q3 /= normq;
+   q4 /= normq;
+
+   a2 = q1*q1;
+   x2 = q2*q2;
+   y2 = q3*q3;
+   z2 = q4*q4;
+   xy = q2*q3;
+   az = q1*q4;
+   zx = q4*q2;
+   ay = q1*q3;
+   yz = q3*q4;
+   ax = q1*q2;
+
+   rot[0][0] = a2 + x2 - y2 - z2;
+   rot[0][1] = 2.0 * (xy + az);
+   rot[0][2] = 2.0 * (zx - ay);
+   rot[1][0] = 2.0 * (xy - az);
+   rot[1][1] = a2 - x2 + y2 - z2;
+   rot[1][2] = 2.0 * (yz + ax);
+   rot[2][0] = 2.0 * (zx + ay);
+   rot[2][1] = 2.0 * (yz - ax);
+   rot[2][2] = a2 - x2 - y2 + z2;
+
+   /* Copy rotation matrix for output. rot[][] is the transpose of the 
+      matrix as used by blMatfit() and blApplyMatrixPDB()
+   */
+   if(column)
+   {
+      for(i=0;i<3;i++)
+         for(j=0;j<3;j++)
+            rm[i][j] = rot[i][j];
+   }
+   else
+   {
+      for(i=0;i<3;i++)
+         for(j=0;j<3;j++)
+            rm[j][i] = rot[i][j];
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static REAL QCPFallback(REAL A[3][3], REAL rm[3][3], BOOL column)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]     A           Correlation matrix
+   \param[out]    rm          Rotation matrix
+   \param[in]     column      TRUE: Create a column-wise matrix
+   \return                    The equivalent of the largest eigenvalue 
+                              of the key matrix
+
+   Used by the QCP code when it can't find the eigenvalue or the 
+   eigenvector. Fits with the blMatfit() method and returns the sum of
+   the products of the fitted coordinates, which is the value that the 
+   largest eigenvalue would have had.
+
+-  16.10.26 Original
+*/
+static REAL QCPFallback(REAL A[3][3], REAL rm[3][3], BOOL column)
+{
+   REAL umat[3][3],
+        sum = 0.0;
+   int  i, j;
+
+   /* qikfit() modifies the matrix it's given                           */
+   for(i=0; i<3; i++)
+      for(j=0; j<3; j++)
+         umat[i][j] = A[i][j];
+
+   qikfit(umat, rm, column);
+
+   for(i=0; i<3; i++)
+      for(j=0; j<3; j++)
+         sum += (column ? rm[j][i] : rm[i][j]) * A[j][i];
+
+   return(sum);
+}
@@ -3,8 +3,8 @@
 
    \file       fit.h
    
-   \version    V1.4
-   \date       14.08.14
+   \version    V1.7
+   \date       16.10.26
    \brief      Include file for least squares fitting
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1993-2014
@@ -53,6 +53,9 @@
                   prototypes for renamed functions. By: CTP
 -  V1.4  14.08.14 Moved deprecated function prototypes to deprecated.h 
                   By: CTP
+-  V1.5  16.10.26 Added QCP fitting prototypes
+-  V1.6  16.10.26 Added blQCPInnerRMSD()
+-  V1.7  16.10.26 Added blQCPInnerFit()
 
 *************************************************************************/
 #ifndef _FIT_H
@@ -64,6 +67,14 @@
 /* Prototypes for functions defined in fit.c                            */
 BOOL blMatfit(COOR *x1, COOR *x2, REAL rm[3][3], int n, REAL *wt1, 
               BOOL column);
+BOOL blQCPfit(COOR *x1, COOR *x2, REAL rm[3][3], int n, REAL *wt1, 
+              BOOL column);
+BOOL blQCPfitRMSD(COOR *x1, COOR *x2, int n, REAL *wt1, 
+                  REAL rm[3][3], BOOL column, REAL *rmsd);
+REAL blQCPrmsd(COOR *x1, COOR *x2, int n, REAL *wt1);
+REAL blQCPInnerRMSD(REAL A[3][3], REAL g1, REAL g2, REAL wsum);
+BOOL blQCPInnerFit(REAL A[3][3], REAL g1, REAL g2, REAL wsum,
+                   REAL rm[3][3], BOOL column, REAL *rmsd);
 
 /************************************************************************/
 /* Include deprecated functions                                         */
@@ -3,8 +3,8 @@
 
    \file       general.h
    
-   \version    V1.15
-   \date       14.08.14
+   \version    V1.16
+   \date       16.10.26
    \brief      Header file for general purpose routines
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1994-2014
@@ -64,6 +64,7 @@
                   prototypes for renamed functions. By: CTP
 -  V1.15 14.08.14 Moved deprecated function prototypes to deprecated.h 
                   By: CTP
+-  V1.16 16.10.26 Added blGzipStream() and blUncompressedStream()
 
 *************************************************************************/
 #ifndef _GENERAL_H
@@ -112,6 +113,8 @@ void blIndexReal(REAL *arrin, int *indx, int n);
 
 FILE *blOpenOrPipe(char *filename);
 int blCloseOrPipe(FILE *fp);
+FILE *blGzipStream(FILE *fp, char *mode, BOOL closefp);
+FILE *blUncompressedStream(FILE *fp, char *tmpfile);
 
 BOOL blWrapString(char *in, char *out, int maxlen);
 BOOL blWrapPrint(FILE *out, char *string);
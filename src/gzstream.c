@@ -0,0 +1,774 @@
+/************************************************************************/
+/**
+
+   \file       gzstream.c
+   
+   \version    V1.2
+   \date       16.10.26
+   \brief      In-process gzip compression and decompression of FILE streams
+   
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural & Molecular Biology,
+               University College London,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+               
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a 
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+   Provides stdio FILE streams which inflate or deflate a gzip stream
+   in-process using zlib, so callers can carry on using fgets(), 
+   fprintf(), etc. without a gunzip/gzip subprocess or a temporary 
+   file.
+
+   The streams are built with fopencookie() (GNU C library) or funopen()
+   (BSD and Mac OS X). Where neither is available, or ZLIB_SUPPORT is 
+   not defined, blGzipStream() returns NULL and blUncompressedStream()
+   falls back to the old method of piping through gunzip into a 
+   temporary file.
+
+   Decompressing streams may be rewound (rewind(), fseek(fp,0,SEEK_SET))
+   and can seek to any position by re-inflating from the start if 
+   needed. If the underlying file cannot seek (e.g. a pipe), the 
+   compressed data are kept in memory so the stream can be replayed.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+   Requires linking with -lz when ZLIB_SUPPORT is defined
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  16.10.26 Original
+-  V1.1  16.10.26 Only data that fails at the header of a further gzip
+                  member is ignored as trailing garbage. Corrupt or
+                  truncated data within a member is a read error
+-  V1.2  16.10.26 The gzip header structure is cleared before each use
+                  so that zlib does not copy a stored filename, extra
+                  field or comment through uninitialised pointers
+
+*************************************************************************/
+/* Doxygen
+   -------
+   #GROUP    General Programming
+   #SUBGROUP File IO
+   #FUNCTION  blGzipStream()
+   Opens a FILE stream which decompresses (mode "r") or compresses 
+   (mode "w") gzip data on another FILE stream in-process
+
+   #FUNCTION  blUncompressedStream()
+   Given a file which may be gzipped or compress'd, returns a stream
+   from which the uncompressed data can be read
+*/
+/************************************************************************/
+/* Includes
+*/
+#define _GNU_SOURCE  /* Required for fopencookie()                      */
+#include "port.h"    /* Required before stdio.h                         */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+
+#include "SysDefs.h"
+#include "macros.h"
+#include "general.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define GZ_BUFFER       16384   /* Size of (de)compression buffers      */
+#define GZ_REPLAY_CHUNK 65536   /* Growth of the replay buffer          */
+
+#if defined(ZLIB_SUPPORT) && defined(__GLIBC__)
+#   define GZ_FOPENCOOKIE
+#elif defined(ZLIB_SUPPORT) && (defined(__APPLE__)   || \
+                                defined(__FreeBSD__) || \
+                                defined(__NetBSD__)  || \
+                                defined(__OpenBSD__))
+#   define GZ_FUNOPEN
+#endif
+
+/************************************************************************/
+/* Type definitions
+*/
+#if defined(GZ_FOPENCOOKIE) || defined(GZ_FUNOPEN)
+typedef struct
+{
+   z_stream      zs;
+   gz_header     head;          /* Header of the current gzip member    */
+   FILE          *fp;           /* Underlying (compressed) file         */
+   long          start,         /* Offset of the gzip data in fp or -1  */
+                 pos,           /* Uncompressed bytes delivered         */
+                 nreplay,       /* Compressed bytes kept for replay     */
+                 maxreplay,     /* Size of replay buffer                */
+                 replaypos;     /* Read position within replay buffer   */
+   unsigned char *replay,       /* Compressed data from unseekable file */
+                 buffer[GZ_BUFFER];
+   BOOL          writing,
+                 closefp,       /* Close fp when the stream is closed   */
+                 newmember,     /* Reading a member after the first     */
+                 eof;
+}  GZSTREAM;
+#endif
+
+/************************************************************************/
+/* Prototypes
+*/
+#if defined(GZ_FOPENCOOKIE) || defined(GZ_FUNOPEN)
+static long GzRead(GZSTREAM *gz, char *buf, long size);
+static long GzWrite(GZSTREAM *gz, const char *buf, long size);
+static long GzSeek(GZSTREAM *gz, long offset, int whence);
+static int  GzClose(GZSTREAM *gz);
+static long GzFillInput(GZSTREAM *gz);
+static BOOL GzRestart(GZSTREAM *gz);
+static void GzGetHeader(GZSTREAM *gz);
+#endif
+
+/* _GNU_SOURCE gives us popen() and pclose() with glibc                 */
+#if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS) && \
+    !defined(__APPLE__) && !defined(__GLIBC__)
+FILE *popen(char *, char *);
+int  pclose(FILE *);
+#endif
+
+#ifdef GZ_FOPENCOOKIE
+static ssize_t GzCookieRead(void *cookie, char *buf, size_t size);
+static ssize_t GzCookieWrite(void *cookie, const char *buf, size_t size);
+static int     GzCookieSeek(void *cookie, off64_t *offset, int whence);
+static int     GzCookieClose(void *cookie);
+#endif
+#ifdef GZ_FUNOPEN
+static int     GzFunRead(void *cookie, char *buf, int size);
+static int     GzFunWrite(void *cookie, const char *buf, int size);
+static fpos_t  GzFunSeek(void *cookie, fpos_t offset, int whence);
+static int     GzFunClose(void *cookie);
+#endif
+
+
+/************************************************************************/
+/*>FILE *blGzipStream(FILE *fp, char *mode, BOOL closefp)
+   ------------------------------------------------------
+*//**
+
+   \param[in]     *fp        Stream containing (or to receive) gzip data
+   \param[in]     *mode      "r" to decompress, "w" to compress
+   \param[in]     closefp    Close fp when the new stream is closed
+   \return                   New stream or NULL if not supported or
+                             out of memory
+
+   Opens a stdio stream which inflates the gzip data read from fp, or
+   deflates everything written to it onto fp. Concatenated gzip members
+   are read as one stream, as gunzip does. Close with fclose().
+
+-  16.10.26 Original
+-  16.10.26 Uses GzGetHeader() so the header structure is cleared
+*/
+FILE *blGzipStream(FILE *fp, char *mode, BOOL closefp)
+{
+#if defined(GZ_FOPENCOOKIE) || defined(GZ_FUNOPEN)
+   GZSTREAM *gz;
+   FILE     *stream;
+   int      ret;
+#  ifdef GZ_FOPENCOOKIE
+   cookie_io_functions_t functions;
+#  endif
+
+   if((gz = (GZSTREAM *)malloc(sizeof(GZSTREAM)))==NULL)
+      return(NULL);
+
+   gz->fp        = fp;
+   gz->pos       = 0;
+   gz->nreplay   = 0;
+   gz->maxreplay = 0;
+   gz->replaypos = 0;
+   gz->replay    = NULL;
+   gz->writing   = (mode[0] == 'w');
+   gz->closefp   = closefp;
+   gz->eof       = FALSE;
+   gz->newmember = FALSE;
+   gz->zs.zalloc = Z_NULL;
+   gz->zs.zfree  = Z_NULL;
+   gz->zs.opaque = Z_NULL;
+   gz->zs.next_in  = Z_NULL;
+   gz->zs.avail_in = 0;
+
+   /* 15 bits of window plus 16 for a gzip rather than zlib header      */
+   if(gz->writing)
+   {
+      gz->start = (-1);
+      ret = deflateInit2(&(gz->zs), Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         15+16, 8, Z_DEFAULT_STRATEGY);
+      gz->zs.next_out  = gz->buffer;
+      gz->zs.avail_out = GZ_BUFFER;
+   }
+   else
+   {
+      gz->start = ftell(fp);
+      ret = inflateInit2(&(gz->zs), 15+16);
+      if(ret == Z_OK)
+         GzGetHeader(gz);
+   }
+   
+   if(ret != Z_OK)
+   {
+      free(gz);
+      return(NULL);
+   }
+
+#  ifdef GZ_FOPENCOOKIE
+   functions.read  = GzCookieRead;
+   functions.write = GzCookieWrite;
+   functions.seek  = GzCookieSeek;
+   functions.close = GzCookieClose;
+   stream = fopencookie(gz, (gz->writing ? "w" : "r"), functions);
+#  else
+   stream = funopen(gz, 
+                    (gz->writing ? NULL : GzFunRead),
+                    (gz->writing ? GzFunWrite : NULL),
+                    GzFunSeek, GzFunClose);
+#  endif
+
+   if(stream == NULL)
+   {
+      if(gz->writing)
+         deflateEnd(&(gz->zs));
+      else
+         inflateEnd(&(gz->zs));
+      free(gz);
+   }
+   return(stream);
+#else
+   return(NULL);
+#endif
+}
+
+
+/************************************************************************/
+/*>FILE *blUncompressedStream(FILE *fp, char *tmpfile)
+   ---------------------------------------------------
+*//**
+
+   \param[in]     *fp        Input file, possibly compressed
+   \param[out]    *tmpfile   Name of temporary file if one had to be 
+                             used (at least 80 chars). Empty string 
+                             otherwise
+   \return                   Stream of uncompressed data. NULL on error
+
+   Checks the signature at the start of the file. If it isn't compressed,
+   fp is returned. gzip files are decompressed in-process by 
+   blGzipStream(). Unix compress'd files, and gzip files where 
+   blGzipStream() is not available, are piped through gunzip into a 
+   temporary file (only if GUNZIP_SUPPORT is defined) which is then 
+   opened.
+
+   If the returned stream is not fp, the caller should fclose() it, and
+   if tmpfile is not empty it should unlink() tmpfile.
+
+   This is the check and decompression used by blDoReadPDB() and 
+   blReadWholePDB().
+
+-  16.10.26 Original - from code in blDoReadPDB()
+*/
+FILE *blUncompressedStream(FILE *fp, char *tmpfile)
+{
+#if defined(GUNZIP_SUPPORT) || defined(ZLIB_SUPPORT)
+   int      signature[3];
+   BOOL     gzip     = FALSE,
+            compress = FALSE;
+   FILE     *stream  = NULL;
+#  if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS)
+   FILE     *pipe;
+   int      ch;
+#  endif
+#  ifndef SINGLE_CHAR_FILECHECK
+   int      i;
+#  endif
+#endif
+
+   tmpfile[0] = '\0';
+
+#if defined(GUNZIP_SUPPORT) || defined(ZLIB_SUPPORT)
+   /* See whether this is a gzipped file                                */
+#  ifndef SINGLE_CHAR_FILECHECK
+   /* Default three character filetype check                            */
+   for(i=0; i<3; i++)
+      signature[i] = fgetc(fp);
+   for(i=2; i>=0; i--)
+      ungetc(signature[i], fp);
+   if((signature[0] == (int)0x1F) &&     /* gzip                        */
+      (signature[1] == (int)0x8B) &&
+      (signature[2] == (int)0x08))
+   {
+      gzip = TRUE;
+   }
+   else if((signature[0] == (int)0x1F) &&    /* compress                */
+           (signature[1] == (int)0x9D) &&
+           (signature[2] == (int)0x90))
+   {
+      compress = TRUE;
+   }
+#  else
+   /* Single character filetype check - assume gzip                     */
+   signature[0] = fgetc(fp);
+   ungetc(signature[0], fp);
+   if(signature[0] == (int)0x1F) gzip = TRUE;
+#  endif
+
+   if(!gzip && !compress)
+      return(fp);
+
+   /* Try decompressing in-process                                      */
+   if(gzip && ((stream = blGzipStream(fp, "r", FALSE)) != NULL))
+      return(stream);
+
+#  if defined(GUNZIP_SUPPORT) && !defined(MS_WINDOWS)
+   /* Otherwise open gunzip as a pipe and send the data through that 
+      into a temporary file
+   */
+   sprintf(tmpfile,"gunzip >/tmp/readpdb_%d",(int)getpid());
+   if((pipe = (FILE *)popen(tmpfile,"w"))==NULL)
+   {
+      tmpfile[0] = '\0';
+      return(NULL);
+   }
+   while((ch=fgetc(fp))!=EOF)
+      fputc(ch, pipe);
+   pclose(pipe);
+
+   /* We now reopen the temporary file as our input file                */
+   sprintf(tmpfile,"/tmp/readpdb_%d",(int)getpid());
+   stream = fopen(tmpfile,"r");
+#  endif
+
+   return(stream);
+#else
+   return(fp);
+#endif
+}
+
+
+#if defined(GZ_FOPENCOOKIE) || defined(GZ_FUNOPEN)
+/************************************************************************/
+/*>static long GzRead(GZSTREAM *gz, char *buf, long size)
+   ------------------------------------------------------
+*//**
+
+   \param[in,out] *gz       Stream
+   \param[out]    *buf      Buffer for uncompressed data
+   \param[in]     size      Size of buffer
+   \return                  Bytes placed in buffer, 0 at end of file,
+                            -1 on error
+
+   Inflates data from the underlying file until we have something to 
+   return. Data which fails before the header of a second or later gzip 
+   member has been read is trailing garbage and is ignored, as gunzip 
+   does. Anything else which fails to inflate, or which ends part way 
+   through a member, is an error. Data inflated before the error are
+   returned first; the error is reported by the next call.
+
+-  16.10.26 Original
+-  16.10.26 Data errors are only ignored at the start of a new member.
+            Truncation within a member is an error
+-  16.10.26 Uses GzGetHeader() so the header structure is cleared
+*/
+static long GzRead(GZSTREAM *gz, char *buf, long size)
+{
+   int ret;
+   
+   gz->zs.next_out  = (unsigned char *)buf;
+   gz->zs.avail_out = (unsigned int)size;
+
+   while((gz->zs.avail_out == (unsigned int)size) && !gz->eof)
+   {
+      if((gz->zs.avail_in == 0) && (GzFillInput(gz) == 0))
+      {
+         /* Input ran out. That's only the end of file if the file was
+            empty or what follows the last member is too short to be
+            a gzip header
+         */
+         if((gz->zs.total_in == 0) ||
+            (gz->newmember && (gz->head.done != 1)))
+         {
+            gz->eof = TRUE;
+            break;
+         }
+         return(-1);                       /* Truncated member          */
+      }
+
+      ret = inflate(&(gz->zs), Z_NO_FLUSH);
+      if(ret == Z_STREAM_END)
+      {
+         /* End of a gzip member. If there's more data, it should be
+            another member
+         */
+         if((gz->zs.avail_in == 0) && (GzFillInput(gz) == 0))
+         {
+            gz->eof = TRUE;
+         }
+         else
+         {
+            inflateReset(&(gz->zs));
+            GzGetHeader(gz);
+            gz->newmember = TRUE;
+         }
+      }
+      else if((ret == Z_DATA_ERROR) && gz->newmember && 
+              (gz->head.done != 1))
+      {
+         /* Trailing garbage after a complete member - ignore it as
+            gunzip does. head.done is 1 only once a valid member header
+            has been read; it is -1 if the data aren't gzip at all
+         */
+         gz->eof = TRUE;
+      }
+      else if((ret != Z_OK) && (ret != Z_BUF_ERROR))
+      {
+         /* Return what we have; the error recurs on the next call     */
+         if(gz->zs.avail_out != (unsigned int)size)
+            break;
+         return(-1);
+      }
+   }
+
+   size -= (long)gz->zs.avail_out;
+   gz->pos += size;
+   return(size);
+}
+
+
+/************************************************************************/
+/*>static long GzFillInput(GZSTREAM *gz)
+   -------------------------------------
+*//**
+
+   \param[in,out] *gz       Stream
+   \return                  Number of compressed bytes made available
+
+   Refills the compressed input buffer, either from the replay buffer or
+   from the underlying file. If the file can't seek, what is read is 
+   kept so that we can rewind.
+
+-  16.10.26 Original
+*/
+static long GzFillInput(GZSTREAM *gz)
+{
+   long nread;
+   
+   if(gz->replaypos < gz->nreplay)
+   {
+      nread = MIN(GZ_BUFFER, gz->nreplay - gz->replaypos);
+      memcpy(gz->buffer, gz->replay + gz->replaypos, nread);
+      gz->replaypos += nread;
+   }
+   else
+   {
+      nread = (long)fread(gz->buffer, 1, GZ_BUFFER, gz->fp);
+      if((gz->start < 0) && (nread > 0))
+      {
+         if(gz->nreplay + nread > gz->maxreplay)
+         {
+            unsigned char *replay;
+            long          maxreplay = gz->maxreplay + 
+                                      MAX(nread, GZ_REPLAY_CHUNK);
+            
+            if((replay = (unsigned char *)realloc(gz->replay, maxreplay))
+               == NULL)
+               return(0);
+            gz->replay    = replay;
+            gz->maxreplay = maxreplay;
+         }
+         memcpy(gz->replay + gz->nreplay, gz->buffer, nread);
+         gz->nreplay  += nread;
+         gz->replaypos = gz->nreplay;
+      }
+   }
+
+   gz->zs.next_in  = gz->buffer;
+   gz->zs.avail_in = (unsigned int)nread;
+   return(nread);
+}
+
+
+/************************************************************************/
+/*>static BOOL GzRestart(GZSTREAM *gz)
+   -----------------------------------
+*//**
+
+   \param[in,out] *gz       Stream
+   \return                  Success
+
+   Goes back to the start of the compressed data
+
+-  16.10.26 Original
+-  16.10.26 Uses GzGetHeader() so the header structure is cleared
+*/
+static BOOL GzRestart(GZSTREAM *gz)
+{
+   if(gz->start >= 0)
+   {
+      if(fseek(gz->fp, gz->start, SEEK_SET))
+         return(FALSE);
+   }
+   else
+   {
+      gz->replaypos = 0;
+   }
+
+   inflateReset(&(gz->zs));
+   GzGetHeader(gz);
+   gz->zs.avail_in = 0;
+   gz->pos         = 0;
+   gz->newmember   = FALSE;
+   gz->eof         = FALSE;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void GzGetHeader(GZSTREAM *gz)
+   -------------------------------------
+*//**
+
+   \param[in,out] *gz       Stream
+
+   Asks zlib to report the header of the next gzip member in gz->head.
+   The structure is cleared first. With the name, extra and comment
+   pointers set to Z_NULL, zlib skips those fields rather than copying
+   them into buffers that have not been provided.
+
+-  16.10.26 Original
+*/
+static void GzGetHeader(GZSTREAM *gz)
+{
+   memset(&(gz->head), 0, sizeof(gz->head));
+   gz->head.name    = Z_NULL;
+   gz->head.extra   = Z_NULL;
+   gz->head.comment = Z_NULL;
+   inflateGetHeader(&(gz->zs), &(gz->head));
+}
+
+
+/************************************************************************/
+/*>static long GzSeek(GZSTREAM *gz, long offset, int whence)
+   ---------------------------------------------------------
+*//**
+
+   \param[in,out] *gz       Stream
+   \param[in]     offset    Offset in the uncompressed data
+   \param[in]     whence    SEEK_SET or SEEK_CUR
+   \return                  New position or -1 on error
+
+   Seeks in the uncompressed data. Seeking backwards means starting
+   again from the beginning; seeking forwards inflates and discards.
+   SEEK_END is not supported.
+
+-  16.10.26 Original
+*/
+static long GzSeek(GZSTREAM *gz, long offset, int whence)
+{
+   char skip[GZ_BUFFER];
+   long n;
+   
+   if(whence == SEEK_CUR)
+      offset += gz->pos;
+   else if(whence != SEEK_SET)
+      return(-1);
+
+   if(gz->writing)
+      return((offset == gz->pos) ? gz->pos : -1);
+
+   if(offset < 0)
+      return(-1);
+   
+   if((offset < gz->pos) && !GzRestart(gz))
+      return(-1);
+
+   while(gz->pos < offset)
+   {
+      if((n = GzRead(gz, skip, MIN(GZ_BUFFER, offset - gz->pos))) <= 0)
+         return(-1);
+   }
+   return(gz->pos);
+}
+
+
+/************************************************************************/
+/*>static long GzWrite(GZSTREAM *gz, const char *buf, long size)
+   -------------------------------------------------------------
+*//**
+
+   \param[in,out] *gz       Stream
+   \param[in]     *buf      Data to compress
+   \param[in]     size      Number of bytes
+   \return                  Bytes accepted (0 on error)
+
+   Deflates data onto the underlying file
+
+-  16.10.26 Original
+*/
+static long GzWrite(GZSTREAM *gz, const char *buf, long size)
+{
+   gz->zs.next_in  = (unsigned char *)buf;
+   gz->zs.avail_in = (unsigned int)size;
+
+   while(gz->zs.avail_in)
+   {
+      if(deflate(&(gz->zs), Z_NO_FLUSH) == Z_STREAM_ERROR)
+         return(0);
+      if(gz->zs.avail_out == 0)
+      {
+         if(fwrite(gz->buffer, 1, GZ_BUFFER, gz->fp) != GZ_BUFFER)
+            return(0);
+         gz->zs.next_out  = gz->buffer;
+         gz->zs.avail_out = GZ_BUFFER;
+      }
+   }
+   gz->pos += size;
+   return(size);
+}
+
+
+/************************************************************************/
+/*>static int GzClose(GZSTREAM *gz)
+   --------------------------------
+*//**
+
+   \param[in,out] *gz       Stream
+   \return                  0 on success, EOF on error
+
+   Finishes the gzip stream if writing, frees everything and closes the
+   underlying file if we own it.
+
+-  16.10.26 Original
+*/
+static int GzClose(GZSTREAM *gz)
+{
+   int  ret    = 0,
+        zret;
+   long nbytes;
+   
+   if(gz->writing)
+   {
+      do
+      {
+         zret   = deflate(&(gz->zs), Z_FINISH);
+         nbytes = GZ_BUFFER - (long)gz->zs.avail_out;
+         if((nbytes > 0) &&
+            (fwrite(gz->buffer, 1, nbytes, gz->fp) != (size_t)nbytes))
+            ret = EOF;
+         gz->zs.next_out  = gz->buffer;
+         gz->zs.avail_out = GZ_BUFFER;
+      }  while(zret == Z_OK);
+      
+      if(zret != Z_STREAM_END)
+         ret = EOF;
+      deflateEnd(&(gz->zs));
+   }
+   else
+   {
+      inflateEnd(&(gz->zs));
+   }
+   
+   if(gz->closefp)
+   {
+      if(fclose(gz->fp))
+         ret = EOF;
+   }
+   else if(gz->writing)
+   {
+      fflush(gz->fp);
+   }
+
+   if(gz->replay != NULL)
+      free(gz->replay);
+   free(gz);
+   return(ret);
+}
+#endif
+
+
+#ifdef GZ_FOPENCOOKIE
+/************************************************************************/
+/* fopencookie() callbacks
+*/
+static ssize_t GzCookieRead(void *cookie, char *buf, size_t size)
+{
+   return((ssize_t)GzRead((GZSTREAM *)cookie, buf, (long)size));
+}
+
+static ssize_t GzCookieWrite(void *cookie, const char *buf, size_t size)
+{
+   return((ssize_t)GzWrite((GZSTREAM *)cookie, buf, (long)size));
+}
+
+static int GzCookieSeek(void *cookie, off64_t *offset, int whence)
+{
+   long pos;
+   
+   if((pos = GzSeek((GZSTREAM *)cookie, (long)*offset, whence)) < 0)
+      return(-1);
+   *offset = (off64_t)pos;
+   return(0);
+}
+
+static int GzCookieClose(void *cookie)
+{
+   return(GzClose((GZSTREAM *)cookie));
+}
+#endif
+
+
+#ifdef GZ_FUNOPEN
+/************************************************************************/
+/* funopen() callbacks
+*/
+static int GzFunRead(void *cookie, char *buf, int size)
+{
+   return((int)GzRead((GZSTREAM *)cookie, buf, (long)size));
+}
+
+static int GzFunWrite(void *cookie, const char *buf, int size)
+{
+   long ret = GzWrite((GZSTREAM *)cookie, buf, (long)size);
+   return((ret == 0 && size != 0) ? -1 : (int)ret);
+}
+
+static fpos_t GzFunSeek(void *cookie, fpos_t offset, int whence)
+{
+   return((fpos_t)GzSeek((GZSTREAM *)cookie, (long)offset, whence));
+}
+
+static int GzFunClose(void *cookie)
+{
+   return(GzClose((GZSTREAM *)cookie));
+}
+#endif
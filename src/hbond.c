@@ -4,8 +4,8 @@
 
    \file       hbond.c
    
-   \version    V1.7
-   \date       07.07.14
+   \version    V1.10
+   \date       16.10.26
    \brief      Report whether two residues are H-bonded using
                Baker & Hubbard criteria
    
@@ -46,7 +46,17 @@
    NOTE, explicit hydrogens must be added to the PDB linked list before
    calling this routine.
 
-   The only external entry points are IsHBonded() and ValidHBond()
+   The main external entry points are IsHBonded() and ValidHBond()
+
+   blFindHBonds() finds all the H-bonds in a structure. This is much
+   faster than calling blIsHBonded() for every pair of residues and
+   reports the atoms involved.
+
+   There is no static state so all the routines may be called from 
+   several threads at once (providing the PDB linked lists are not
+   being modified). blResetHBondIter(), blNextSidechainHBDonor() and
+   blNextSidechainHBAcceptor() step through the sidechain donors and
+   acceptors of a residue using an explicit iterator.
 
 **************************************************************************
 
@@ -62,6 +72,12 @@
 -  V1.5  17.01.06 Added IsMCDonorHBonded() and IsMCAcceptorHBonded()
 -  V1.6  20.03.14 Updated message in Demo code. By: CTP
 -  V1.7  07.07.14 Use bl prefix for functions By: CTP
+-  V1.8  16.10.26 Added blFindHBonds()
+-  V1.9  16.10.26 Sidechain donor/acceptor searches use an explicit
+                  HBONDITER rather than static variables so the code is
+                  reentrant
+-  V1.10 16.10.26 Backbone donor and acceptor searches compare the
+                  residue and atom codes
 
 *************************************************************************/
 /* Doxygen
@@ -81,11 +97,25 @@
    #FUNCTION  blIsMCAcceptorHBonded()
    Determines whether 2 residues are H-bonded with the first 
    residue being a mainchain acceptor
+
+   #FUNCTION  blFindHBonds()
+   Finds all the H-bonds in a structure
+
+   #FUNCTION  blResetHBondIter()
+   Resets an iterator over the sidechain donors or acceptors of a 
+   residue
+
+   #FUNCTION  blNextSidechainHBDonor()
+   Finds the next sidechain donor in a residue
+
+   #FUNCTION  blNextSidechainHBAcceptor()
+   Finds the next sidechain acceptor in a residue
 */
 /************************************************************************/
 /* Includes
 */
 #include <math.h>
+#include <stdlib.h>
 #include "MathType.h"
 #include "SysDefs.h"
 #include "pdb.h"
@@ -101,6 +131,24 @@
 #define DADISTSQ (DADIST*DADIST)
 #define HADIST 2.5
 #define HADISTSQ (HADIST*HADIST)
+#define HBATOM_ALLOCQUANT 256
+
+/* Donors and acceptors found in a residue by blFindHBonds()            */
+typedef struct
+{
+   PDB *res,
+       *AtomH,
+       *AtomD;
+   int type;                /* HBOND_BACK1 or HBOND_SIDE1               */
+}  HBDONOR;
+
+typedef struct
+{
+   PDB *res,
+       *AtomA,
+       *AtomP;
+   int type;                /* HBOND_BACK2 or HBOND_SIDE2               */
+}  HBACCEPTOR;
 
 
 /************************************************************************/
@@ -113,8 +161,15 @@
 */
 static BOOL FindBackboneAcceptor(PDB *res, PDB **AtomA, PDB **AtomP);
 static BOOL FindBackboneDonor(PDB *res, PDB **AtomH, PDB **AtomD);
-static BOOL FindSidechainAcceptor(PDB *res, PDB **AtomA, PDB **AtomP);
-static BOOL FindSidechainDonor(PDB *res, PDB **AtomH, PDB **AtomD);
+static BOOL FindHBondAtoms(PDB *pdb, int *acceptorOf,
+                           HBDONOR **donors, int *ndonors,
+                           HBACCEPTOR **acceptors, int *nacceptors);
+static BOOL AddHBDonor(HBDONOR **donors, int *ndonors, int *maxDonors,
+                       PDB *res, PDB *AtomH, PDB *AtomD, int type);
+static BOOL AddHBAcceptor(HBACCEPTOR **acceptors, int *nacceptors,
+                          int *maxAcceptors, PDB *res, PDB *AtomA, 
+                          PDB *AtomP, int type, int *acceptorOf,
+                          int resStart);
 
 
 /************************************************************************/
@@ -164,6 +219,8 @@ int blIsHBonded(PDB *res1, PDB *res2, int type)
        *AtomD,              /* The hydrogen donor                       */
        *AtomA,              /* The acceptor                             */
        *AtomP;              /* The acceptor's antecedent                */
+   HBONDITER iter1,         /* Iterators over res1 and res2 sidechains  */
+             iter2;
 
    /* Find H-bonds involving the backbone of res1                       */
    if(ISSET(type, HBOND_BACK1))
@@ -180,9 +237,9 @@ int blIsHBonded(PDB *res1, PDB *res2, int type)
          }
          if(ISSET(type, HBOND_SIDE2))
          {
-            /* Clear internal flags                                     */
-            FindSidechainAcceptor(NULL, NULL, NULL);
-            while(FindSidechainAcceptor(res2, &AtomA, &AtomP))
+            /* Reset the iterator                                      */
+            blResetHBondIter(&iter2);
+            while(blNextSidechainHBAcceptor(&iter2, res2, &AtomA, &AtomP))
             {
                if(blValidHBond(AtomH, AtomD, AtomA, AtomP))
                   return(HBOND_BACK1|HBOND_SIDE2);
@@ -201,9 +258,9 @@ int blIsHBonded(PDB *res1, PDB *res2, int type)
          }
          if(ISSET(type, HBOND_SIDE2))
          {
-            /* Clear internal flags                                     */
-            FindSidechainDonor(NULL, NULL, NULL);
-            while(FindSidechainDonor(res2, &AtomH, &AtomD))
+            /* Reset the iterator                                      */
+            blResetHBondIter(&iter2);
+            while(blNextSidechainHBDonor(&iter2, res2, &AtomH, &AtomD))
             {
                if(blValidHBond(AtomH, AtomD, AtomA, AtomP))
                   return(HBOND_BACK1|HBOND_SIDE2);
@@ -215,9 +272,9 @@ int blIsHBonded(PDB *res1, PDB *res2, int type)
    /* Find H-bonds involving sidechain of res1                          */
    if(ISSET(type, HBOND_SIDE1))
    {
-      /* Clear internal flags                                           */
-      FindSidechainDonor(NULL, NULL, NULL);
-      while(FindSidechainDonor(res1, &AtomH, &AtomD))
+      /* Reset the iterator                                            */
+      blResetHBondIter(&iter1);
+      while(blNextSidechainHBDonor(&iter1, res1, &AtomH, &AtomD))
       {
          if(ISSET(type, HBOND_BACK2))
          {
@@ -229,18 +286,18 @@ int blIsHBonded(PDB *res1, PDB *res2, int type)
          }
          if(ISSET(type, HBOND_SIDE2))
          {
-            /* Clear internal flags                                     */
-            FindSidechainAcceptor(NULL, NULL, NULL);
-            while(FindSidechainAcceptor(res2, &AtomA, &AtomP))
+            /* Reset the iterator                                      */
+            blResetHBondIter(&iter2);
+            while(blNextSidechainHBAcceptor(&iter2, res2, &AtomA, &AtomP))
             {
                if(blValidHBond(AtomH, AtomD, AtomA, AtomP))
                   return(HBOND_SIDE1|HBOND_SIDE2);
             }
          }
       }
-      /* Clear internal flags                                           */
-      FindSidechainAcceptor(NULL, NULL, NULL);
-      while(FindSidechainAcceptor(res1, &AtomA, &AtomP))
+      /* Reset the iterator                                            */
+      blResetHBondIter(&iter1);
+      while(blNextSidechainHBAcceptor(&iter1, res1, &AtomA, &AtomP))
       {
          if(ISSET(type, HBOND_BACK2))
          {
@@ -252,9 +309,9 @@ int blIsHBonded(PDB *res1, PDB *res2, int type)
          }
          if(ISSET(type, HBOND_SIDE2))
          {
-            /* Clear internal flags                                     */
-            FindSidechainDonor(NULL, NULL, NULL);
-            while(FindSidechainDonor(res2, &AtomH, &AtomD))
+            /* Reset the iterator                                      */
+            blResetHBondIter(&iter2);
+            while(blNextSidechainHBDonor(&iter2, res2, &AtomH, &AtomD))
             {
                if(blValidHBond(AtomH, AtomD, AtomA, AtomP))
                   return(HBOND_SIDE1|HBOND_SIDE2);
@@ -362,6 +419,7 @@ BOOL blValidHBond(PDB *AtomH, PDB *AtomD, PDB *AtomA, PDB *AtomP)
 
 -  25.01.96 Original    By: ACRM
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Compares the atom code for the carbonyl C   By: ACRM
 */
 static BOOL FindBackboneAcceptor(PDB *res, PDB **AtomA, PDB **AtomP)
 {
@@ -384,7 +442,7 @@ static BOOL FindBackboneAcceptor(PDB *res, PDB **AtomA, PDB **AtomP)
          !strncmp(p->atnam,"O1  ",4) ||
          !strncmp(p->atnam,"O2  ",4))
          *AtomA = p;
-      if(!strncmp(p->atnam,"C   ",4))
+      if(ATNAMCODEMATCH(p, PDBATOM_C, "C   "))
          *AtomP = p;
    }
 
@@ -410,13 +468,14 @@ static BOOL FindBackboneAcceptor(PDB *res, PDB **AtomA, PDB **AtomP)
 -  25.01.96 Original    By: ACRM
 -  03.01.06 Returns FALSE if this is a proline
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Compares residue and atom codes   By: ACRM
 */
 static BOOL FindBackboneDonor(PDB *res, PDB **AtomH, PDB **AtomD)
 {
    PDB *p,
        *NextRes;
 
-   if((res == NULL) || (!strncmp(res->resnam, "PRO", 3)))
+   if((res == NULL) || RESNAMCODEMATCH(res, PDBRES_PRO, "PRO"))
    {
       return(FALSE);
    }
@@ -427,9 +486,9 @@ static BOOL FindBackboneDonor(PDB *res, PDB **AtomH, PDB **AtomD)
    NextRes = blFindNextResidue(res);
    for(p=res; p!=NextRes; NEXT(p))
    {
-      if(!strncmp(p->atnam,"H   ",4))
+      if(ATNAMCODEMATCH(p, PDBATOM_H, "H   "))
          *AtomH = p;
-      if(!strncmp(p->atnam,"N   ",4))
+      if(ATNAMCODEMATCH(p, PDBATOM_N, "N   "))
          *AtomD = p;
    }
 
@@ -441,10 +500,35 @@ static BOOL FindBackboneDonor(PDB *res, PDB **AtomH, PDB **AtomD)
 
 
 /************************************************************************/
-/*>static BOOL FindSidechainAcceptor(PDB *res, PDB **AtomA, PDB **AtomP)
-   ---------------------------------------------------------------------
+/*>void blResetHBondIter(HBONDITER *iter)
+   --------------------------------------
+*//**
+
+   \param[out]    *iter     Iterator
+
+   Resets an iterator before stepping through the sidechain donors or
+   acceptors of a new residue with blNextSidechainHBDonor() or
+   blNextSidechainHBAcceptor()
+
+-  16.10.26 Original (from the reset code in FindSidechainAcceptor())
+*/
+void blResetHBondIter(HBONDITER *iter)
+{
+   iter->p       = NULL;
+   iter->prev    = NULL;
+   iter->pprev   = NULL;
+   iter->nextRes = NULL;
+   iter->first   = TRUE;
+}
+
+
+/************************************************************************/
+/*>BOOL blNextSidechainHBAcceptor(HBONDITER *iter, PDB *res, 
+                                  PDB **AtomA, PDB **AtomP)
+   -------------------------------------------------------------
 *//**
 
+   \param[in,out] *iter      Iterator
    \param[in]     *res       Pointer to residue of interest
    \param[out]    **AtomA    The acceptor atom
    \param[out]    **AtomP    The antecedent (previous) atom
@@ -453,7 +537,9 @@ static BOOL FindBackboneDonor(PDB *res, PDB **AtomH, PDB **AtomD)
    Finds pointers to sidechain acceptor atoms. Each call will return
    a new set of atoms till all are found.
 
-   Call with all parameters set to NULL before each new residue
+   Call blResetHBondIter() before each new residue. All the state is
+   held in the iterator so any number of iterations may be in progress
+   at once in different threads.
 
 -  25.01.96 Original    By: ACRM
 -  09.02.96 Added #ifdef'd code to allow AE1/AE2 AD1/AD2
@@ -461,35 +547,26 @@ static BOOL FindBackboneDonor(PDB *res, PDB **AtomH, PDB **AtomD)
             the antecedent for the NE2 and ND2 atoms respectively, it
             would find OE1/OD1 rather than CD/CG. (See pprev code)
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Was static FindSidechainAcceptor(). The static variables
+            are now in an HBONDITER
 */
-static BOOL FindSidechainAcceptor(PDB *res, PDB **AtomA, PDB **AtomP)
+BOOL blNextSidechainHBAcceptor(HBONDITER *iter, PDB *res, 
+                               PDB **AtomA, PDB **AtomP)
 {
-   static PDB  *p     = NULL,
-               *prev  = NULL,
-               *pprev = NULL,
-               *NextRes;
-   static BOOL First = TRUE;
-   
    if(res == NULL)
-   {
-      /* Clear statics                                                  */
-      p      = NULL;
-      prev   = NULL;
-      /* ACRM+++ 18.08.05 */
-      pprev  = NULL;
-      First  = TRUE;
-      
       return(FALSE);
-   }
-   if(First)
+
+   if(iter->first)
    {
-      First   = FALSE;
-      p       = res;
-      NextRes = blFindNextResidue(res);
+      iter->first   = FALSE;
+      iter->p       = res;
+      iter->nextRes = blFindNextResidue(res);
    }
 
-   for( ; p!=NextRes; NEXT(p))
+   for( ; iter->p!=iter->nextRes; NEXT(iter->p))
    {
+      PDB *p = iter->p;
+      
       if((p->atnam[0] == 'O' && strncmp(p->atnam, "O   ", 4)
                              && strncmp(p->atnam, "O1  ", 4)
                              && strncmp(p->atnam, "O2  ", 4)
@@ -500,26 +577,26 @@ static BOOL FindSidechainAcceptor(PDB *res, PDB **AtomA, PDB **AtomP)
          (p->atnam[0] == 'N' && strncmp(p->atnam, "N   ", 4)))
       {
          *AtomA = p;
-         *AtomP = prev;
+         *AtomP = iter->prev;
 
 /* ACRM+++ 18.08.05 */
          if((*AtomP) && 
             ((*AtomP)->atnam_raw[2] == (*AtomA)->atnam_raw[2]))
          {
-            *AtomP = pprev;
+            *AtomP = iter->pprev;
          }
-         pprev  = prev;
+         iter->pprev = iter->prev;
 /* ACRM=== */
 
-         prev   = p;
-         NEXT(p);
+         iter->prev  = p;
+         NEXT(iter->p);
 
          return(TRUE);
       }
       /* ACRM+++ 18.08.05 */
-      pprev  = prev;
+      iter->pprev = iter->prev;
 
-      prev = p;
+      iter->prev  = p;
    }
 
    return(FALSE);
@@ -527,10 +604,12 @@ static BOOL FindSidechainAcceptor(PDB *res, PDB **AtomA, PDB **AtomP)
 
 
 /************************************************************************/
-/*>static BOOL FindSidechainDonor(PDB *res, PDB **AtomH, PDB **AtomD)
-   ------------------------------------------------------------------
+/*>BOOL blNextSidechainHBDonor(HBONDITER *iter, PDB *res, 
+                               PDB **AtomH, PDB **AtomD)
+   ----------------------------------------------------------
 *//**
 
+   \param[in,out] *iter      Iterator
    \param[in]     *res       Pointer to residue of interest
    \param[out]    **AtomH    The hydrogen
    \param[out]    **AtomD    The 'donor' atom
@@ -539,7 +618,9 @@ static BOOL FindSidechainAcceptor(PDB *res, PDB **AtomA, PDB **AtomP)
    Finds pointers to sidechain donor atoms. Each call will return
    a new set of atoms till all are found.
 
-   Call with all parameters set to NULL before each new residue
+   Call blResetHBondIter() before each new residue. All the state is
+   held in the iterator so any number of iterations may be in progress
+   at once in different threads.
 
 -  25.01.96 Original    By: ACRM
 -  09.02.96 Added #ifdef'd code to allow AE1/AE2 AD1/AD2
@@ -549,56 +630,49 @@ static BOOL FindSidechainAcceptor(PDB *res, PDB **AtomA, PDB **AtomP)
             Also fixed a bug where a lone residue occurs which appears
             to have just a hydrogen.
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Was static FindSidechainDonor(). The static variables
+            are now in an HBONDITER
 */
-static BOOL FindSidechainDonor(PDB *res, PDB **AtomH, PDB **AtomD)
+BOOL blNextSidechainHBDonor(HBONDITER *iter, PDB *res, 
+                            PDB **AtomH, PDB **AtomD)
 {
-   static PDB  *p    = NULL,
-               *prev = NULL,
-               *NextRes;
-   static BOOL First = TRUE;
-   
    if(res == NULL)
-   {
-      /* Clear statics                                                  */
-      p     = NULL;
-      prev  = NULL;
-      First = TRUE;
-      
       return(FALSE);
-   }
-   if(First)
+
+   if(iter->first)
    {
-      First   = FALSE;
-      p       = res;
-      NextRes = blFindNextResidue(res);
+      iter->first   = FALSE;
+      iter->p       = res;
+      iter->nextRes = blFindNextResidue(res);
    }
 
-   for( ; p!=NextRes; NEXT(p))
+   for( ; iter->p!=iter->nextRes; NEXT(iter->p))
    {
 #ifdef ALLOW_AXN
-      if(p->atnam[0] == 'A')
+      if(iter->p->atnam[0] == 'A')
       {
-         *AtomD = p;
-         *AtomH = NULL;
-         prev   = p;
-         NEXT(p);
+         *AtomD     = iter->p;
+         *AtomH     = NULL;
+         iter->prev = iter->p;
+         NEXT(iter->p);
 
          return(TRUE);
       }
 #endif
-      if(p->atnam[0] == 'H' && strncmp(p->atnam, "H   ", 4))
+      if(iter->p->atnam[0] == 'H' && strncmp(iter->p->atnam, "H   ", 4))
       {
-         *AtomH = p;
-         *AtomD = prev;
+         *AtomH = iter->p;
+         *AtomD = iter->prev;
 
          if(*AtomD == NULL)
             continue;
          
          /* Step over any multiple hydrogens                            */
-         while((p!=NULL) && (p!=NextRes) && (p->atnam[0] == 'H'))
+         while((iter->p!=NULL) && (iter->p!=iter->nextRes) && 
+               (iter->p->atnam[0] == 'H'))
          {
-            prev = p;
-            NEXT(p);
+            iter->prev = iter->p;
+            NEXT(iter->p);
          }
 
          /* If the donor is an oxygen or a nitrogen on a lysine, the 
@@ -614,7 +688,7 @@ static BOOL FindSidechainDonor(PDB *res, PDB **AtomH, PDB **AtomD)
          
          return(TRUE);
       }
-      prev = p;
+      iter->prev = iter->p;
    }
 
    return(FALSE);
@@ -650,6 +724,7 @@ int blIsMCDonorHBonded(PDB *res1, PDB *res2, int type)
        *AtomD,              /* The hydrogen donor                       */
        *AtomA,              /* The acceptor                             */
        *AtomP;              /* The acceptor's antecedent                */
+   HBONDITER iter;          /* Iterator over res2 sidechain             */
 
    /* Find H-bonds involving the backbone of res1                       */
    if(FindBackboneDonor(res1, &AtomH, &AtomD))
@@ -664,9 +739,9 @@ int blIsMCDonorHBonded(PDB *res1, PDB *res2, int type)
       }
       if(ISSET(type, HBOND_SIDE2))
       {
-         /* Clear internal flags                                     */
-         FindSidechainAcceptor(NULL, NULL, NULL);
-         while(FindSidechainAcceptor(res2, &AtomA, &AtomP))
+         /* Reset the iterator                                      */
+         blResetHBondIter(&iter);
+         while(blNextSidechainHBAcceptor(&iter, res2, &AtomA, &AtomP))
          {
             if(blValidHBond(AtomH, AtomD, AtomA, AtomP))
                return(HBOND_SIDE2);
@@ -707,6 +782,7 @@ int blIsMCAcceptorHBonded(PDB *res1, PDB *res2, int type)
        *AtomD,              /* The hydrogen donor                       */
        *AtomA,              /* The acceptor                             */
        *AtomP;              /* The acceptor's antecedent                */
+   HBONDITER iter;          /* Iterator over res2 sidechain             */
 
    /* Find H-bonds involving the backbone of res1                       */
    if(FindBackboneAcceptor(res1, &AtomA, &AtomP))
@@ -721,9 +797,9 @@ int blIsMCAcceptorHBonded(PDB *res1, PDB *res2, int type)
       }
       if(ISSET(type, HBOND_SIDE2))
       {
-         /* Clear internal flags                                     */
-         FindSidechainDonor(NULL, NULL, NULL);
-         while(FindSidechainDonor(res2, &AtomH, &AtomD))
+         /* Reset the iterator                                      */
+         blResetHBondIter(&iter);
+         while(blNextSidechainHBDonor(&iter, res2, &AtomH, &AtomD))
          {
             if(blValidHBond(AtomH, AtomD, AtomA, AtomP))
                return(HBOND_BACK1|HBOND_SIDE2);
@@ -738,6 +814,324 @@ int blIsMCAcceptorHBonded(PDB *res1, PDB *res2, int type)
 
 
 
+/************************************************************************/
+/*>HBONDPAIR *blFindHBonds(PDB *pdb, int type, int *nhbonds)
+   ---------------------------------------------------------
+*//**
+
+   \param[in]     *pdb      PDB linked list (with explicit hydrogens)
+   \param[in]     type      HBond types to report (as for blIsHBonded()
+                            with the donor as the first residue)
+   \param[out]    *nhbonds  Number of H-bonds found (-1 if out of 
+                            memory)
+   \return                  Linked list of H-bonds (NULL if none or out
+                            of memory). Free with 
+                            FREELIST(hbonds, HBONDPAIR)
+
+   Finds all the H-bonds between residues in a structure using the same
+   donor and acceptor atoms and the same criteria as blIsHBonded() and
+   blValidHBond(). Each donor/acceptor atom pair is reported with the
+   residue pointers and the type flags. HBOND_BACK1 or HBOND_SIDE1 
+   describe the donor and HBOND_BACK2 or HBOND_SIDE2 the acceptor. Only
+   H-bonds whose flags are all set in type are reported, so
+   HBOND_ANY gives everything while HBOND_BACKBONE gives backbone
+   donors to any acceptor plus sidechain donors to backbone acceptors.
+   H-bonds within a residue are not reported.
+
+   The donors and acceptors of each residue are found once and the 
+   candidate acceptors for each donor are found from a cell list, so 
+   the time taken is proportional to the size of the structure rather
+   than to the square of the number of residues.
+
+-  16.10.26 Original
+*/
+HBONDPAIR *blFindHBonds(PDB *pdb, int type, int *nhbonds)
+{
+   PDBCELLLIST *cl;
+   HBDONOR     *donors    = NULL;
+   HBACCEPTOR  *acceptors = NULL;
+   HBONDPAIR   *hbonds    = NULL,
+               *hb        = NULL;
+   int         *acceptorOf = NULL,
+               *atoms      = NULL,
+               maxatoms    = 0,
+               ndonors     = 0,
+               nacceptors  = 0,
+               natoms, i, j, k, hbtype;
+   BOOL        ok = FALSE;
+
+   *nhbonds = 0;
+   if((cl = blBuildPDBCellList(pdb, DADIST)) == NULL)
+      return(NULL);
+   natoms = cl->coords->natoms;
+
+   if((acceptorOf = (int *)malloc(natoms * sizeof(int))) == NULL)
+      goto cleanup;
+   if(!FindHBondAtoms(pdb, acceptorOf, &donors, &ndonors, 
+                      &acceptors, &nacceptors))
+      goto cleanup;
+
+   for(i=0; i<ndonors; i++)
+   {
+      HBDONOR *d     = &(donors[i]);
+      REAL    cutoff = DADIST;
+      VEC3F   centre;
+      int     nfound;
+      
+      /* H...A must be < HADIST so D...A < D-H + HADIST                 */
+      if(d->AtomH != NULL)
+         cutoff = MAX(cutoff, DIST(d->AtomH, d->AtomD) + HADIST);
+
+      centre.x = d->AtomD->x;
+      centre.y = d->AtomD->y;
+      centre.z = d->AtomD->z;
+      if((nfound = blFindPDBPointNeighbours(cl, centre, cutoff, 
+                                            &atoms, &maxatoms)) < 0)
+         goto cleanup;
+
+      for(j=0; j<nfound; j++)
+      {
+         HBACCEPTOR *a;
+         
+         if((k = acceptorOf[atoms[j]]) < 0)
+            continue;
+         a = &(acceptors[k]);
+         
+         hbtype = d->type | a->type;
+         if((a->res == d->res) || ((hbtype & type) != hbtype))
+            continue;
+         
+         if(blValidHBond(d->AtomH, d->AtomD, a->AtomA, a->AtomP))
+         {
+            if(hbonds == NULL)
+            {
+               INIT(hbonds, HBONDPAIR);
+               hb = hbonds;
+            }
+            else
+            {
+               ALLOCNEXT(hb, HBONDPAIR);
+            }
+            if(hb == NULL)
+               goto cleanup;
+            
+            hb->donorRes    = d->res;
+            hb->acceptorRes = a->res;
+            hb->AtomH       = d->AtomH;
+            hb->AtomD       = d->AtomD;
+            hb->AtomA       = a->AtomA;
+            hb->AtomP       = a->AtomP;
+            hb->type        = hbtype;
+            (*nhbonds)++;
+         }
+      }
+   }
+   ok = TRUE;
+
+cleanup:
+   blFreePDBCellList(cl);
+   if(acceptorOf != NULL) free(acceptorOf);
+   if(donors     != NULL) free(donors);
+   if(acceptors  != NULL) free(acceptors);
+   if(atoms      != NULL) free(atoms);
+   if(!ok)
+   {
+      FREELIST(hbonds, HBONDPAIR);
+      *nhbonds = (-1);
+   }
+   
+   return(hbonds);
+}
+
+
+/************************************************************************/
+/*>static BOOL FindHBondAtoms(PDB *pdb, int *acceptorOf,
+                              HBDONOR **donors, int *ndonors,
+                              HBACCEPTOR **acceptors, int *nacceptors)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]     *pdb         PDB linked list
+   \param[out]    *acceptorOf  For each atom (in list order), the index
+                               into acceptors or -1
+   \param[out]    **donors     Allocated array of donors
+   \param[out]    *ndonors     Number of donors
+   \param[out]    **acceptors  Allocated array of acceptors
+   \param[out]    *nacceptors  Number of acceptors
+   \return                     Success?
+
+   Finds the donors and acceptors in every residue with the routines
+   used by blIsHBonded()
+
+-  16.10.26 Original
+*/
+static BOOL FindHBondAtoms(PDB *pdb, int *acceptorOf,
+                           HBDONOR **donors, int *ndonors,
+                           HBACCEPTOR **acceptors, int *nacceptors)
+{
+   PDB  *res,
+        *nextRes,
+        *p,
+        *AtomH, *AtomD, *AtomA, *AtomP;
+   int  resStart = 0,
+        maxDonors = 0,
+        maxAcceptors = 0,
+        natoms = 0;
+   HBONDITER iter;
+
+   *donors     = NULL;
+   *acceptors  = NULL;
+   *ndonors    = 0;
+   *nacceptors = 0;
+
+   for(res=pdb; res!=NULL; res=nextRes)
+   {
+      nextRes = blFindNextResidue(res);
+      for(p=res; p!=nextRes; NEXT(p))
+         acceptorOf[natoms++] = (-1);
+
+      if(FindBackboneDonor(res, &AtomH, &AtomD))
+      {
+         if(!AddHBDonor(donors, ndonors, &maxDonors, res, AtomH, AtomD,
+                        HBOND_BACK1))
+            return(FALSE);
+      }
+      blResetHBondIter(&iter);
+      while(blNextSidechainHBDonor(&iter, res, &AtomH, &AtomD))
+      {
+         if(!AddHBDonor(donors, ndonors, &maxDonors, res, AtomH, AtomD,
+                        HBOND_SIDE1))
+            return(FALSE);
+      }
+
+      if(FindBackboneAcceptor(res, &AtomA, &AtomP))
+      {
+         if(!AddHBAcceptor(acceptors, nacceptors, &maxAcceptors, res, 
+                           AtomA, AtomP, HBOND_BACK2, acceptorOf, 
+                           resStart))
+            return(FALSE);
+      }
+      blResetHBondIter(&iter);
+      while(blNextSidechainHBAcceptor(&iter, res, &AtomA, &AtomP))
+      {
+         if(!AddHBAcceptor(acceptors, nacceptors, &maxAcceptors, res, 
+                           AtomA, AtomP, HBOND_SIDE2, acceptorOf, 
+                           resStart))
+            return(FALSE);
+      }
+
+      resStart = natoms;
+   }
+   
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL AddHBDonor(HBDONOR **donors, int *ndonors, int *maxDonors,
+                          PDB *res, PDB *AtomH, PDB *AtomD, int type)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in,out] **donors    Array of donors (expanded as needed)
+   \param[in,out] *ndonors    Number of donors
+   \param[in,out] *maxDonors  Size of the array
+   \param[in]     *res        Residue
+   \param[in]     *AtomH      The hydrogen (or NULL)
+   \param[in]     *AtomD      The donor
+   \param[in]     type        HBOND_BACK1 or HBOND_SIDE1
+   \return                    Success?
+
+   Adds a donor to the array
+
+-  16.10.26 Original
+*/
+static BOOL AddHBDonor(HBDONOR **donors, int *ndonors, int *maxDonors,
+                       PDB *res, PDB *AtomH, PDB *AtomD, int type)
+{
+   if(*ndonors >= *maxDonors)
+   {
+      HBDONOR *d;
+      
+      *maxDonors += HBATOM_ALLOCQUANT;
+      if((d = (HBDONOR *)realloc(*donors, *maxDonors * sizeof(HBDONOR)))
+         == NULL)
+         return(FALSE);
+      *donors = d;
+   }
+   
+   (*donors)[*ndonors].res   = res;
+   (*donors)[*ndonors].AtomH = AtomH;
+   (*donors)[*ndonors].AtomD = AtomD;
+   (*donors)[*ndonors].type  = type;
+   (*ndonors)++;
+   
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL AddHBAcceptor(HBACCEPTOR **acceptors, int *nacceptors,
+                             int *maxAcceptors, PDB *res, PDB *AtomA, 
+                             PDB *AtomP, int type, int *acceptorOf,
+                             int resStart)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in,out] **acceptors    Array of acceptors (expanded as needed)
+   \param[in,out] *nacceptors    Number of acceptors
+   \param[in,out] *maxAcceptors  Size of the array
+   \param[in]     *res           Residue
+   \param[in]     *AtomA         The acceptor
+   \param[in]     *AtomP         The antecedent (or NULL)
+   \param[in]     type           HBOND_BACK2 or HBOND_SIDE2
+   \param[in,out] *acceptorOf    Acceptor index of each atom
+   \param[in]     resStart       Index of the first atom of res
+   \return                       Success?
+
+   Adds an acceptor to the array and records its index against the
+   acceptor atom
+
+-  16.10.26 Original
+*/
+static BOOL AddHBAcceptor(HBACCEPTOR **acceptors, int *nacceptors,
+                          int *maxAcceptors, PDB *res, PDB *AtomA, 
+                          PDB *AtomP, int type, int *acceptorOf,
+                          int resStart)
+{
+   PDB *p;
+   
+   if(*nacceptors >= *maxAcceptors)
+   {
+      HBACCEPTOR *a;
+      
+      *maxAcceptors += HBATOM_ALLOCQUANT;
+      if((a = (HBACCEPTOR *)realloc(*acceptors, 
+                                    *maxAcceptors * sizeof(HBACCEPTOR)))
+         == NULL)
+         return(FALSE);
+      *acceptors = a;
+   }
+   
+   (*acceptors)[*nacceptors].res   = res;
+   (*acceptors)[*nacceptors].AtomA = AtomA;
+   (*acceptors)[*nacceptors].AtomP = AtomP;
+   (*acceptors)[*nacceptors].type  = type;
+
+   /* The acceptor is always in this residue                            */
+   for(p=res; p!=NULL; NEXT(p), resStart++)
+   {
+      if(p == AtomA)
+      {
+         acceptorOf[resStart] = *nacceptors;
+         break;
+      }
+   }
+   (*nacceptors)++;
+   
+   return(TRUE);
+}
+
       
    
    
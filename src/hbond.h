@@ -3,8 +3,8 @@
 
    \file       hbond.h
    
-   \version    V1.3
-   \date       14.08.14
+   \version    V1.5
+   \date       16.10.26
    \brief      Header file for hbond determining code
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1996-2014
@@ -52,6 +52,8 @@
                   prototypes for renamed functions. By: CTP
 -  V1.3  14.08.14 Moved deprecated function prototypes to deprecated.h 
                   By: CTP
+-  V1.4  16.10.26 Added blFindHBonds()
+-  V1.5  16.10.26 Added HBONDITER and the iterator functions
 
 *************************************************************************/
 #ifndef _hbond_h
@@ -74,6 +76,36 @@
 
 #define HBOND_ANY (HBOND_BACK1 | HBOND_BACK2 | HBOND_SIDE1 | HBOND_SIDE2)
 
+/************************************************************************/
+/* Structure types
+*/
+/* An H-bond found by blFindHBonds(). The type flags use BACK1/SIDE1 for
+   the donor and BACK2/SIDE2 for the acceptor
+*/
+typedef struct _hbondpair
+{
+   struct _hbondpair *next;
+   PDB *donorRes,           /* First atom of the donor residue          */
+       *acceptorRes,        /* First atom of the acceptor residue       */
+       *AtomH,              /* The hydrogen (NULL if not placed)        */
+       *AtomD,              /* The hydrogen donor                       */
+       *AtomA,              /* The acceptor                             */
+       *AtomP;              /* The acceptor's antecedent (or NULL)      */
+   int type;
+}  HBONDPAIR;
+
+/* Iterator used by blNextSidechainHBDonor() and 
+   blNextSidechainHBAcceptor(). Reset with blResetHBondIter()
+*/
+typedef struct
+{
+   PDB  *p,
+        *prev,
+        *pprev,
+        *nextRes;
+   BOOL first;
+}  HBONDITER;
+
 /************************************************************************/
 /* Prototypes
 */
@@ -81,6 +113,12 @@ int  blIsHBonded(PDB *res1, PDB *res2, int type);
 BOOL blValidHBond(PDB *AtomH, PDB *AtomD, PDB *AtomA, PDB *AtomP);
 int blIsMCDonorHBonded(PDB *res1, PDB *res2, int type);
 int blIsMCAcceptorHBonded(PDB *res1, PDB *res2, int type);
+HBONDPAIR *blFindHBonds(PDB *pdb, int type, int *nhbonds);
+void blResetHBondIter(HBONDITER *iter);
+BOOL blNextSidechainHBDonor(HBONDITER *iter, PDB *res, 
+                            PDB **AtomH, PDB **AtomD);
+BOOL blNextSidechainHBAcceptor(HBONDITER *iter, PDB *res, 
+                               PDB **AtomA, PDB **AtomP);
 
 
 /************************************************************************/
@@ -3,8 +3,8 @@
 
    \file       openorpipe.c
    
-   \version    V1.10
-   \date       17.07.14
+   \version    V1.11
+   \date       16.10.26
    \brief      Open a file for writing unless the filename starts with
                a | in which case open as a pipe
    
@@ -61,6 +61,8 @@
 -  V1.9  07.07.14 Use bl prefix for functions By: CTP
 -  V1.10 17.07.14 Added 'stdout' as a special file which maps to 
                   standard output
+-  V1.11 16.10.26 Files ending in .gz are compressed in-process with
+                  blGzipStream()
 
 *************************************************************************/
 /* Doxygen
@@ -69,7 +71,7 @@
    #SUBGROUP File IO
    #FUNCTION  blOpenOrPipe()
    Opens a file for writing unless the filename begins with a | in which
-   case it is opened as a pipe.
+   case it is opened as a pipe. Files ending in .gz are gzip compressed.
 
    #FUNCTION  blCloseOrPipe()
    Attempts to close a file pointer as a pipe.
@@ -86,6 +88,7 @@
 #include <signal.h>
 #include <string.h>
 #include "macros.h"
+#include "general.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -98,6 +101,8 @@
 /************************************************************************/
 /* Prototypes
 */
+static FILE *OpenGzOrFile(char *fnam);
+
 #if !defined(__APPLE__) && !defined(MS_WINDOWS)
 FILE *popen(char *, char *);
 #endif
@@ -114,7 +119,9 @@ int  pclose(FILE *);
    \return                        A file pointer
 
    Opens a file for writing unless the filename begins with a | in which
-   case it is opened as a pipe.
+   case it is opened as a pipe. If the filename ends in .gz, the output
+   is gzip compressed in-process (if supported) so there is no need for
+   a '| gzip > file.gz' pipe.
 
    Broken pipe signals are ignored.
 
@@ -124,6 +131,7 @@ int  pclose(FILE *);
 -  28.01.05 Added NOPIPE define
 -  07.07.14 Use bl prefix for functions By: CTP
 -  17.07.14 Added special 'stdout' file By: ACRM
+-  16.10.26 Added gzip compression of .gz files
 */
 FILE *blOpenOrPipe(char *filename)
 {
@@ -134,7 +142,7 @@ FILE *blOpenOrPipe(char *filename)
       return(stdout);
 
 #ifdef NOPIPE
-   return(fopen(fnam, "w"));
+   return(OpenGzOrFile(fnam));
 #else
    if(fnam[0] == '|')
    {
@@ -145,11 +153,42 @@ FILE *blOpenOrPipe(char *filename)
    }
    else
    {
-      return(fopen(fnam, "w"));
+      return(OpenGzOrFile(fnam));
    }
 #endif
 }
 
+/************************************************************************/
+/*>static FILE *OpenGzOrFile(char *fnam)
+   -------------------------------------
+*//**
+
+   \param[in]     *fnam      Filename
+   \return                   A file pointer
+
+   Opens a file for writing. If the name ends in .gz and in-process
+   compression is available, the returned stream gzips the output.
+
+-  16.10.26 Original
+*/
+static FILE *OpenGzOrFile(char *fnam)
+{
+   FILE *fp,
+        *gz;
+   int  len = strlen(fnam);
+
+   if((fp = fopen(fnam, "w"))==NULL)
+      return(NULL);
+   
+   if((len > 3) && !strcmp(fnam+len-3, ".gz"))
+   {
+      if((gz = blGzipStream(fp, "w", TRUE))!=NULL)
+         return(gz);
+   }
+   
+   return(fp);
+}
+
 /************************************************************************/
 /*>int blCloseOrPipe(FILE *fp)
    ---------------------------
@@ -3,8 +3,8 @@
 
    \file       pdb.h
    
-   \version    V1.67
-   \date       24.10.14
+   \version    V1.83
+   \date       16.10.26
    \brief      Include file for pdb routines
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin, UCL, Reading 1993-2014
@@ -153,6 +153,31 @@
                   input PDB list.
 -  V1.66 17.09.14 Commented the fields of the PDB structure
 -  V1.67 24.10.14 Added ExtractZoneSpecPDB()
+-  V1.68 16.10.26 Added blReadPDBMapped() and blDoReadPDBMapped()
+-  V1.69 16.10.26 Added PDBMODELREADER and blOpenPDBModelReader(),
+                  blReadNextPDBModel(), blClosePDBModelReader()
+-  V1.70 16.10.26 Added PDBMODELINDEX and the model index functions
+-  V1.71 16.10.26 Added BPDBFILE and the binary .bpdb functions
+-  V1.72 16.10.26 Added PDBARENA, gPDBArena, the arena functions and the
+                  INITPDB(), ALLOCNEXTPDB() and FREEPDBLIST() macros
+-  V1.73 16.10.26 Added PDBCOORDS and the coordinate view functions
+-  V1.74 16.10.26 Added PDBCELLLIST and the cell list neighbour functions
+-  V1.75 16.10.26 Added blRMSDMatrixPDB() and blWriteRMSDMatrixPDB()
+-  V1.76 16.10.26 Added FITTARGET and the fit target functions
+-  V1.77 16.10.26 Added PDBRESINDEX and the indexed residue lookups
+-  V1.78 16.10.26 Added array-backed PDBSTRUCT fields and 
+                  blAllocPDBStructureArray()
+-  V1.79 16.10.26 Added PDBSELECTION and the compiled atom selection
+                  functions
+-  V1.80 16.10.26 Added rescode, atcode and elemcode to PDB with the
+                  PDBRES_, PDBATOM_ and PDBELEM_ codes. ISWATER() uses 
+                  the residue code when it is set
+-  V1.81 16.10.26 Added PDBLITE, PDBLITEATOM and the compact atom table
+-  V1.82 16.10.26 PDBLITE chain index is 16-bit and chains[] grows
+-  V1.83 16.10.26 gPDBArena is local to each thread. PDBSLAB has its
+                  owning arena and address index entries in place of 
+                  the chain of live arenas
+                  functions
 
 *************************************************************************/
 #ifndef _PDB_H
@@ -226,6 +251,9 @@ typedef struct pdb_entry
    char chain[8];            /* Chain label                             */
    char element[8];          /* Element type                            */
    char altpos;              /* Alternate position indicator            */
+   short rescode,            /* Interned codes for resnam, atnam and    */
+         atcode,             /* element. Set by the readers - see       */
+         elemcode;           /* PDBCodes.c                              */
 }  PDB;
 
 typedef struct pdbresidue
@@ -234,6 +262,8 @@ typedef struct pdbresidue
    PDB               *start, *stop;
    APTR              *extras;
    int               resnum;
+   int               startatom, /* Index of start in PDBSTRUCT atoms[]  */
+                     stopatom;  /* Index of stop (array-backed only)    */
    char              chain[8];
    char              insert[8];
    char              resnam[8];
@@ -246,16 +276,41 @@ typedef struct pdbchain
    PDB             *start, *stop;
    PDBRESIDUE      *residues;
    APTR            *extras;
+   int             startres,    /* Index of residues in residueArray[]  */
+                   nres,        /* Number of residues                   */
+                   startatom,   /* Index of start in atoms[]            */
+                   stopatom;    /* Index of stop (array-backed only)    */
    char            chain[8];
 } PDBCHAIN;
 
+/* Hierarchical view of a PDB linked list. blAllocPDBStructure() builds
+   linked lists of chains and residues. blAllocPDBStructureArray() 
+   builds them in arrays in a single allocation, with the chains in 
+   chainArray[], the residues of all chains in residueArray[] and the 
+   atoms in atoms[]. The array fields are NULL and the counts 0 for the
+   linked list version
+*/
 typedef struct
 {
-   PDB      *pdb;
-   PDBCHAIN *chains;
-   APTR     *extras;
+   PDB        *pdb;
+   PDBCHAIN   *chains;
+   APTR       *extras;
+   PDBCHAIN   *chainArray;      /* Chains (array-backed only)           */
+   PDBRESIDUE *residueArray;    /* Residues of all chains in order      */
+   PDB        **atoms;          /* Atoms in order                       */
+   int        nchains,
+              nresidues,
+              natoms;
 } PDBSTRUCT;
 
+/* Chain k, residue i of chain k and residue r overall of a PDBSTRUCT 
+   from blAllocPDBStructureArray()
+*/
+#define PDBSTRUCT_CHAIN(s, k)      (&((s)->chainArray[(k)]))
+#define PDBSTRUCT_RESIDUE(s, k, i)                                      \
+   (&((s)->residueArray[(s)->chainArray[(k)].startres + (i)]))
+#define PDBSTRUCT_RESIDUEN(s, r)   (&((s)->residueArray[(r)]))
+
 
 #define SELECT(x,w) (x) = (char *)malloc(5 * sizeof(char)); \
                     if((x) != NULL) strncpy((x),(w),5)
@@ -280,6 +335,211 @@ typedef struct _wholepdb
    int        natoms;
 }  WHOLEPDB;
 
+/* Reads the models of a multi-model file one at a time. Fields are 
+   private to ReadPDB.c apart from ModelNum
+*/
+typedef struct
+{
+   FILE       *fp,         /* Stream being read (may be decompressing)  */
+              *fpin;       /* Stream supplied by the caller             */
+   void       *xmlDoc,     /* PDBML document (xmlDoc *)                 */
+              *xmlNext;    /* First atom_site of the next model         */
+   int        ModelNum,    /* Number of the model last returned         */
+              OccRank;
+   BOOL       AllAtoms,
+              pdbml,
+              multi,       /* An ENDMDL has been seen                   */
+              done;
+   char       tmpfile[80];
+}  PDBMODELREADER;
+
+/* File offsets of the models in a multi-model file                     */
+typedef struct
+{
+   long       *offset,     /* Start of each model                       */
+              filesize;    /* Size of the file indexed                  */
+   int        nmodels;
+}  PDBMODELINDEX;
+
+/* An opened binary .bpdb file. See BPDB.c                              */
+#define BPDB_VERSION 1
+typedef struct
+{
+   unsigned char *buffer;  /* The mapped file                           */
+   long       length;      /* Size of the file                          */
+   int        natoms,
+              nheader,     /* Number of WHOLEPDB header lines           */
+              ntrailer,    /* Number of WHOLEPDB trailer lines          */
+              recsize;     /* Size of each atom record                  */
+}  BPDBFILE;
+
+/* Entry in the address index used to find the slab holding a node.
+   See PDBArena.c
+*/
+typedef struct _pdbslabentry
+{
+   struct _pdbslabentry *next;
+   struct _pdbslab      *slab;
+   unsigned long        chunk; /* Address range covered by this entry  */
+}  PDBSLABENTRY;
+
+/* A slab of contiguous PDB nodes within a PDBARENA. See PDBArena.c     */
+typedef struct _pdbslab
+{
+   struct _pdbslab  *next;
+   struct _pdbarena *arena;    /* Arena owning this slab                */
+   PDBSLABENTRY     *entries;  /* Its entries in the address index      */
+   PDB        *nodes;
+   int        nused,       /* Nodes handed out so far                   */
+              nalloc,      /* Nodes in this slab                        */
+              nentries;    /* Entries in the address index              */
+}  PDBSLAB;
+
+/* An arena from which PDB nodes are allocated in bulk                  */
+typedef struct _pdbarena
+{
+   PDBSLAB    *slabs;      /* Slab currently being filled first         */
+   PDB        *freed;      /* Nodes released individually for re-use    */
+   long       nnodes;      /* Nodes currently in use                    */
+   int        slabsize;    /* Nodes per slab                            */
+}  PDBARENA;
+
+/* Structure-of-arrays view of the coordinates in a PDB linked list.
+   See PDBCoords.c
+*/
+typedef struct
+{
+   REAL       *x,
+              *y,
+              *z;
+   PDB        **atom;      /* The PDB node for each coordinate          */
+   int        natoms;
+}  PDBCOORDS;
+
+/* Uniform grid over the atoms of a PDB linked list. See CellList.c     */
+typedef struct
+{
+   PDBCOORDS  *coords;     /* Atom coordinates and nodes                */
+   int        *cellStart,  /* Start of each cell in cellAtoms[]         */
+              *cellAtoms,  /* Atom indexes sorted by cell               */
+              *cellOf;     /* Cell of each atom (-1 if no coordinates)  */
+   unsigned int *mark,     /* Per-atom query markers                    */
+              stamp;
+   REAL       cellsize,
+              xmin, ymin, zmin;
+   int        nx, ny, nz,
+              ncells;
+}  PDBCELLLIST;
+
+/* Hash index of the residues in a PDB linked list. See ResIndex.c     */
+typedef struct
+{
+   PDB        *pdb,        /* The linked list indexed                   */
+              **start,     /* First atom of each residue                */
+              **stop;      /* Atom after each residue (NULL at the end) */
+   int        *bucket,     /* First residue in each hash bucket or -1   */
+              *next,       /* Next residue in the same bucket or -1     */
+              nres,        /* Number of residues                        */
+              nbuckets;
+}  PDBRESINDEX;
+
+/* Compiled atom selection and its result. See AtomSelect.c            */
+typedef unsigned long PDBSELBITS;
+#define PDBSEL_WORDBITS   (8 * sizeof(PDBSELBITS))
+#define PDBSEL_NWORDS(n)  (((n) + PDBSEL_WORDBITS - 1) / PDBSEL_WORDBITS)
+
+typedef struct
+{
+   struct pdbselop *ops;   /* The compiled program                      */
+   PDBSELBITS *work,       /* Stack of bitsets used in evaluation       */
+              *result;     /* Bit per atom from the last evaluation     */
+   int        nops,
+              depth,       /* Bitsets needed on the stack               */
+              maxwords,    /* Words allocated per bitset                */
+              nwords,      /* Words used per bitset                     */
+              natoms,      /* Atoms in the last structure evaluated     */
+              nselected;   /* Atoms selected                            */
+}  PDBSELECTION;
+
+/* Is atom i selected by the last evaluation of a PDBSELECTION?         */
+#define PDBSELECTED(sel, i)                                             \
+   ((((sel)->result[(i) / PDBSEL_WORDBITS]) >>                          \
+     ((i) % PDBSEL_WORDBITS)) & 1UL)
+
+/* Compact atom table for very large structures. See PDBLite.c         */
+#define PDBLITE_MAXCHAINS 65536
+
+typedef struct
+{
+   int   atnum,            /* Atom number                               */
+         resnum;           /* Residue number                            */
+   float occ,              /* Occupancy                                 */
+         bval;             /* B-value                                   */
+   char  atnam[4],         /* Atom name, left justified. The names are  */
+         atnam_raw[4],     /* not terminated; a name shorter than the   */
+         resnam[4],        /* field is padded with NULs                 */
+         element[2],
+         insert,           /* Insert code                               */
+         altpos;           /* Alternate position indicator              */
+   unsigned short chain;   /* Index into the PDBLITE chains[] labels    */
+   unsigned char hetatm;   /* TRUE for a HETATM record                  */
+   signed char formal_charge,
+         rescode,          /* Codes as in the PDB structure             */
+         atcode,
+         elemcode;
+}  PDBLITEATOM;
+
+typedef struct
+{
+   PDBLITEATOM *atoms;     /* Atom records                              */
+   REAL        *x,         /* Coordinates, stored separately from the   */
+               *y,         /* atom records                              */
+               *z;
+   int         natoms,
+               maxatoms,   /* Space allocated                           */
+               nchains,    /* Chain labels used                         */
+               maxchains,  /* Space allocated for chain labels          */
+               lastchain;  /* Last chain label matched                  */
+   char        (*chains)[8];  /* Chain labels                           */
+}  PDBLITE;
+
+/* Chain label of atom i of a PDBLITE                                   */
+#define PDBLITE_CHAIN(lite, i) ((lite)->chains[(lite)->atoms[(i)].chain])
+
+/* Atom selections for blRMSDMatrixPDB() and blWriteRMSDMatrixPDB()    */
+#define RMSD_ATOMS_ALL  0
+#define RMSD_ATOMS_CA   1
+#define RMSD_ATOMS_NCAC 2
+#define RMSD_ATOMS_CACB 3
+
+/* Pre-centred reference structure for repeated fitting. See FitTarget.c*/
+typedef struct
+{
+   COOR  *coor;            /* Centred coordinates of the selected atoms */
+   REAL  *weights;         /* Weights (NULL if unweighted)              */
+   VEC3F CofG,             /* Centre of geometry of the selected atoms  */
+         wsumCoor;         /* Sum of the weighted centred coordinates   */
+   REAL  g,                /* Weighted sum of squares of the coordinates*/
+         wsum;             /* Sum of the weights                        */
+   int   ncoor,
+         atoms;            /* RMSD_ATOMS_ selection                     */
+}  FITTARGET;
+
+/* Index of the RMSD between models i and j (i<j) in the array returned
+   by blRMSDMatrixPDB()
+*/
+#define RMSDMATRIX_INDEX(i, j, n) \
+   ((long)(i) * (long)(n) - ((long)(i) * (long)((i)+1)) / 2 + \
+    (long)((j) - (i) - 1))
+
+/* Arena-aware versions of INIT(), ALLOCNEXT() and FREELIST() for PDB
+   linked lists. These take nodes from gPDBArena when it is set
+*/
+#define INITPDB(x)      do { (x) = blAllocPDB(); } while(0)
+#define ALLOCNEXTPDB(x) do { (x)->next = blAllocPDB(); (x) = (x)->next; } \
+                        while(0)
+#define FREEPDBLIST(x)  do { blFreePDB(x); (x) = NULL; } while(0)
+
 /* This is designed to cause an error message which prints this line
    It has been tested with gcc and Irix cc and does as required in
    both cases
@@ -326,15 +586,76 @@ typedef struct
                      p->formal_charge  =   0; \
                      p->partial_charge = 0.0; \
                      strcpy(p->element,"  "); \
+                     p->rescode = p->atcode = p->elemcode = \
+                        PDBCODE_UNSET; \
                      p->atomType = NULL
 
-#define ISWATER(z)   (!strncmp((z)->resnam,"HOH",3) || \
-                      !strncmp((z)->resnam,"OH2",3) || \
-                      !strncmp((z)->resnam,"OHH",3) || \
-                      !strncmp((z)->resnam,"DOD",3) || \
-                      !strncmp((z)->resnam,"OD2",3) || \
-                      !strncmp((z)->resnam,"ODD",3) || \
-                      !strncmp((z)->resnam,"WAT",3))
+/* Interned codes for residue names, atom names and elements. See 
+   PDBCodes.c. Element codes are atomic numbers
+*/
+#define PDBCODE_UNSET    0     /* Not set - use the strings             */
+#define PDBCODE_OTHER    (-1)  /* Not in the table                      */
+
+#define PDBRES_ALA   1
+#define PDBRES_CYS   2
+#define PDBRES_ASP   3
+#define PDBRES_GLU   4
+#define PDBRES_PHE   5
+#define PDBRES_GLY   6
+#define PDBRES_HIS   7
+#define PDBRES_ILE   8
+#define PDBRES_LYS   9
+#define PDBRES_LEU   10
+#define PDBRES_MET   11
+#define PDBRES_ASN   12
+#define PDBRES_PRO   13
+#define PDBRES_GLN   14
+#define PDBRES_ARG   15
+#define PDBRES_SER   16
+#define PDBRES_THR   17
+#define PDBRES_VAL   18
+#define PDBRES_TRP   19
+#define PDBRES_TYR   20
+#define PDBRES_UNK   39
+#define PDBRES_HOH   40        /* Waters are PDBRES_HOH...PDBRES_WAT    */
+#define PDBRES_WAT   46
+
+#define PDBATOM_N    1
+#define PDBATOM_CA   2
+#define PDBATOM_C    3
+#define PDBATOM_O    4
+#define PDBATOM_OXT  5
+#define PDBATOM_CB   6
+#define PDBATOM_H    7
+#define PDBATOM_HA   8
+
+#define PDBELEM_H    1
+#define PDBELEM_C    6
+#define PDBELEM_N    7
+#define PDBELEM_O    8
+#define PDBELEM_S    16
+
+#define ISWATERCODE(c) ((c) >= PDBRES_HOH && (c) <= PDBRES_WAT)
+
+/* Compare the name of a PDB record with a name and its code. The code
+   is used if it has been set, otherwise the first 4 (atom) or 3 
+   (residue) characters of the string
+*/
+#define ATNAMCODEMATCH(p, code, name)                                   \
+   ((p)->atcode ? ((p)->atcode == (code)) :                             \
+                  !strncmp((p)->atnam, (name), 4))
+#define RESNAMCODEMATCH(p, code, name)                                  \
+   ((p)->rescode ? ((p)->rescode == (code)) :                           \
+                   !strncmp((p)->resnam, (name), 3))
+
+#define ISWATER(z)   ((z)->rescode ? ISWATERCODE((z)->rescode) :        \
+                      (!strncmp((z)->resnam,"HOH",3) || \
+                       !strncmp((z)->resnam,"OH2",3) || \
+                       !strncmp((z)->resnam,"OHH",3) || \
+                       !strncmp((z)->resnam,"DOD",3) || \
+                       !strncmp((z)->resnam,"OD2",3) || \
+                       !strncmp((z)->resnam,"ODD",3) || \
+                       !strncmp((z)->resnam,"WAT",3)))
 
 #define CHAINMATCH(chain1,chain2) !strcmp(chain1,chain2)
 
@@ -416,6 +737,23 @@ typedef struct
    extern BOOL gPDBXML;
 #endif
 
+/* The current arena is local to each thread where the compiler allows */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#  define PDBARENA_THREADLOCAL _Thread_local
+#elif defined(__GNUC__)
+#  define PDBARENA_THREADLOCAL __thread
+#elif defined(_MSC_VER)
+#  define PDBARENA_THREADLOCAL __declspec(thread)
+#else
+#  define PDBARENA_THREADLOCAL
+#endif
+
+#ifdef PDBARENA_MAIN
+   PDBARENA_THREADLOCAL PDBARENA *gPDBArena = NULL;
+#else
+   extern PDBARENA_THREADLOCAL PDBARENA *gPDBArena;
+#endif
+
 #ifdef WRITEPDB_MAIN
    int gPDBXMLForce = FORCEXML_NOFORCE;
 #else
@@ -433,11 +771,113 @@ PDB *blReadPDBOccRank(FILE *fp, int *natom, int OccRank);
 PDB *blReadPDBAtomsOccRank(FILE *fp, int *natom, int OccRank);
 PDB *blDoReadPDB(FILE *fp, int  *natom, BOOL AllAtoms, int OccRank, 
                  int ModelNum);
+PDB *blReadPDBMapped(char *filename, int *natom);
+PDB *blDoReadPDBMapped(char *filename, int *natom, BOOL AllAtoms, 
+                       int OccRank, int ModelNum);
 PDB *blDoReadPDBML(FILE *fp, int  *natom, BOOL AllAtoms, int OccRank, 
                    int ModelNum);
+PDBMODELREADER *blOpenPDBModelReader(FILE *fp, BOOL AllAtoms, 
+                                     int OccRank);
+PDB *blReadNextPDBModel(PDBMODELREADER *reader, int *natom);
+void blClosePDBModelReader(PDBMODELREADER *reader);
+PDBMODELINDEX *blBuildPDBModelIndex(FILE *fp);
+BOOL blWritePDBModelIndex(FILE *fp, PDBMODELINDEX *index);
+PDBMODELINDEX *blReadPDBModelIndex(FILE *fp);
+PDBMODELINDEX *blGetPDBModelIndex(char *filename, BOOL save);
+PDB *blDoReadPDBIndexed(FILE *fp, PDBMODELINDEX *index, int *natom, 
+                        BOOL AllAtoms, int OccRank, int ModelNum);
+void blFreePDBModelIndex(PDBMODELINDEX *index);
 BOOL blCheckFileFormatPDBML(FILE *fp);
 
 BOOL blWritePDB(FILE *fp, PDB  *pdb);
+BOOL blWriteBPDB(FILE *fp, PDB *pdb);
+BOOL blWriteWholeBPDB(FILE *fp, WHOLEPDB *wpdb);
+PDB *blReadBPDB(FILE *fp, int *natom);
+WHOLEPDB *blReadWholeBPDB(FILE *fp);
+BPDBFILE *blOpenBPDB(char *filename);
+BOOL blGetBPDBAtom(BPDBFILE *bpdb, int atom, PDB *p);
+PDB *blBPDBToPDB(BPDBFILE *bpdb, int first, int count, int *natom);
+STRINGLIST *blGetBPDBHeader(BPDBFILE *bpdb);
+STRINGLIST *blGetBPDBTrailer(BPDBFILE *bpdb);
+void blCloseBPDB(BPDBFILE *bpdb);
+PDBARENA *blNewPDBArena(int slabsize);
+void blFreePDBArena(PDBARENA *arena);
+void blResetPDBArena(PDBARENA *arena);
+PDBARENA *blUsePDBArena(PDBARENA *arena);
+PDB *blAllocPDB(void);
+BOOL blPDBInArena(PDB *p);
+void blFreePDBNode(PDB *p);
+void blFreePDB(PDB *pdb);
+PDBCOORDS *blGetPDBCoords(PDB *pdb);
+void blRefreshPDBCoords(PDBCOORDS *coords);
+void blPutPDBCoords(PDBCOORDS *coords);
+void blFreePDBCoords(PDBCOORDS *coords);
+void blApplyMatrixPDBCoords(PDBCOORDS *coords, REAL matrix[3][3]);
+void blTranslatePDBCoords(PDBCOORDS *coords, VEC3F tvect);
+void blGetCofGPDBCoords(PDBCOORDS *coords, VEC3F *cg);
+void blOriginPDBCoords(PDBCOORDS *coords);
+void blRotatePDBCoords(PDBCOORDS *coords, REAL matrix[3][3]);
+REAL blCalcRMSPDBCoords(PDBCOORDS *coords1, PDBCOORDS *coords2);
+REAL blDistPDBCoords(PDBCOORDS *coords1, int i, PDBCOORDS *coords2, int j);
+PDBCELLLIST *blBuildPDBCellList(PDB *pdb, REAL cellsize);
+void blFreePDBCellList(PDBCELLLIST *cl);
+int blFindPDBPointNeighbours(PDBCELLLIST *cl, VEC3F point, REAL dist,
+                             int **atoms, int *maxatoms);
+int blFindPDBAtomNeighbours(PDBCELLLIST *cl, PDB *atom, REAL dist,
+                            int **atoms, int *maxatoms);
+int blFindPDBResidueNeighbours(PDBCELLLIST *cl, PDB *pRes, REAL dist,
+                               int **atoms, int *maxatoms);
+PDBRESINDEX *blBuildPDBResIndex(PDB *pdb);
+void blFreePDBResIndex(PDBRESINDEX *index);
+int blFindPDBResIndex(PDBRESINDEX *index, char *chain, int resnum,
+                      char *insert);
+PDB *blFindResidueIndexed(PDBRESINDEX *index, char *chain, int resnum,
+                          char *insert);
+PDB *blFindResidueSpecIndexed(PDBRESINDEX *index, char *resspec);
+PDB *blFindHetatmResidueIndexed(PDBRESINDEX *index, char *chain,
+                                int resnum, char *insert);
+PDB *blFindHetatmResidueSpecIndexed(PDBRESINDEX *index, char *resspec);
+BOOL blFindZonePDBIndexed(PDBRESINDEX *index, int start, 
+                          char *startinsert, int stop, char *stopinsert,
+                          char *chain, int mode, PDB **pdb_start, 
+                          PDB **pdb_stop);
+PDB *blExtractZonePDBAsCopyIndexed(PDBRESINDEX *index, char *chain1, 
+                                   int resnum1, char *insert1, 
+                                   char *chain2, int resnum2, 
+                                   char *insert2);
+PDBSELECTION *blCompilePDBSelection(char *expr, int *errpos);
+void blFreePDBSelection(PDBSELECTION *sel);
+int blEvalPDBSelection(PDBSELECTION *sel, PDB *pdb);
+int blGetPDBSelectionIndexes(PDBSELECTION *sel, int **atoms,
+                             int *maxatoms);
+PDB *blCopyPDBSelection(PDBSELECTION *sel, PDB *pdb, int *natom);
+PDBLITE *blAllocPDBLite(int maxatoms);
+BOOL blResizePDBLite(PDBLITE *lite, int maxatoms);
+void blFreePDBLite(PDBLITE *lite);
+BOOL blAppendPDBLite(PDBLITE *lite, PDB *p);
+void blGetPDBLiteAtom(PDBLITE *lite, int i, PDB *p);
+PDBLITE *blPDBToPDBLite(PDB *pdb);
+PDB *blPDBLiteToPDB(PDBLITE *lite, int *natom);
+PDBLITE *blReadPDBLite(FILE *fp);
+PDBLITE *blDoReadPDBLite(FILE *fp, BOOL AllAtoms, int OccRank, 
+                         int ModelNum);
+PDBLITE *blReadPDBLiteMapped(char *filename);
+PDBLITE *blDoReadPDBLiteMapped(char *filename, BOOL AllAtoms, 
+                               int OccRank, int ModelNum);
+REAL *blRMSDMatrixPDB(PDB **models, int nmodels, int atoms, 
+                      int nthreads);
+BOOL blWriteRMSDMatrixPDB(FILE *fp, PDB **models, int nmodels, 
+                          int atoms, int nthreads);
+FITTARGET *blCreateFitTarget(const PDB *ref, int atoms);
+FITTARGET *blCreateFitTargetCoor(const COOR *coor, int ncoor, 
+                                 const REAL *weights);
+void blFreeFitTarget(FITTARGET *target);
+BOOL blFitTargetRMSD(const FITTARGET *target, const PDB *mobile,
+                     REAL *rmsd, REAL rm[3][3]);
+BOOL blFitTargetRMSDCoor(const FITTARGET *target, const COOR *coor,
+                         int ncoor, REAL *rmsd, REAL rm[3][3]);
+BOOL blSuperposeOnFitTarget(const FITTARGET *target, PDB *mobile,
+                            REAL *rmsd, REAL rm[3][3]);
 void blWriteAsPDB(FILE *fp, PDB  *pdb);
 void blWriteAsPDBML(FILE *fp, PDB  *pdb);
 BOOL blFormatCheckWritePDB(PDB *pdb);
@@ -555,9 +995,18 @@ PDB *blFindAtomWildcardInRes(PDB *pdb, char *pattern);
 PDB *blDupeResiduePDB(PDB *in);
 PDB *blStripWatersPDBAsCopy(PDB *pdbin, int *natom);
 PDBSTRUCT *blAllocPDBStructure(PDB *pdb);
+PDBSTRUCT *blAllocPDBStructureArray(PDB *pdb);
 PDB *blFindNextChain(PDB *pdb);
 void blFreePDBStructure(PDBSTRUCT *pdbstruct);
 void blSetElementSymbolFromAtomName(char *element, char * atom_name);
+int blGetResCode(char *resnam);
+int blGetAtomCode(char *atnam);
+int blGetElementCode(char *element);
+char *blResCodeName(int code);
+char *blAtomCodeName(int code);
+char *blElementCodeName(int code);
+void blSetPDBCodes(PDB *p);
+void blSetPDBListCodes(PDB *pdb);
 
 /************************************************************************/
 /* Include deprecated functions                                         */
@@ -3,8 +3,8 @@
 
    \file       port.h
    
-   \version    V1.2
-   \date       03.04.09
+   \version    V1.4
+   \date       16.10.26
    \brief      Port-specific defines to allow us to use things like 
                popen() in a clean compile
    
@@ -52,6 +52,8 @@
 -  V1.1  17.03.09  Added Mac OS X and Windows. By: CTP
 -  V1.2  03.04.09  Added check for linux whether _POSIX_SOURCE already
                    defined and added further checks for MS_WINDOWS
+-  V1.3  16.10.26  Windows also defines NOMMAP
+-  V1.4  16.10.26  Windows also defines NOTHREADS
 
 *************************************************************************/
 /***
@@ -108,4 +110,6 @@
     defined(msdos)     || defined(__msdos__)
 #   define MS_WINDOWS 1
 #   define NOPIPE
+#   define NOMMAP
+#   define NOTHREADS
 #endif
@@ -3,8 +3,8 @@
 
    \file       rsc.c
    
-   \version    V1.13
-   \date       15.08.14
+   \version    V1.14
+   \date       16.10.26
    \brief      Modify sequence of a PDB linked list
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1992-2005
@@ -71,6 +71,8 @@
 -  V1.11 03.06.05 Added altpos
 -  V1.12 07.07.14 Use bl prefix for functions By: CTP
 -  V1.13 15.08.14 Updated ReadRefCoords() to use CLEAR_PDB() By: CTP
+-  V1.14 16.10.26 PDB nodes are allocated and freed with the arena-aware
+                  blAllocPDB() and blFreePDB() routines
 
 *************************************************************************/
 /* Defines required for includes
@@ -578,12 +580,12 @@ static int ReplaceGly(PDB  *ResStart,
          
          if(parent_mc == NULL)               /* Initialise start of list*/
          {
-            INIT(parent_mc,PDB);
+            INITPDB(parent_mc);
             q = parent_mc;
          }
          else                                /* Next item in list       */
          {
-            ALLOCNEXT(q,PDB);
+            ALLOCNEXTPDB(q);
          }
          
          /* Check allocation                                            */
@@ -616,12 +618,12 @@ static int ReplaceGly(PDB  *ResStart,
          
          if(ref_mc == NULL)                  /* Initialise start of list*/
          {
-            INIT(ref_mc,PDB);
+            INITPDB(ref_mc);
             q = ref_mc;
          }
          else                                /* Next item in list       */
          {
-            ALLOCNEXT(q,PDB);
+            ALLOCNEXTPDB(q);
          }
          
          /* Check allocation                                            */
@@ -657,9 +659,9 @@ static int ReplaceGly(PDB  *ResStart,
                                ResStart->insert,ResStart->chain);
 
 Cleanup:
-   if(reference != NULL)   FREELIST(reference, PDB);
-   if(ref_mc    != NULL)   FREELIST(ref_mc,    PDB);
-   if(parent_mc != NULL)   FREELIST(parent_mc, PDB);
+   if(reference != NULL)   FREEPDBLIST(reference);
+   if(ref_mc    != NULL)   FREEPDBLIST(ref_mc);
+   if(parent_mc != NULL)   FREEPDBLIST(parent_mc);
 
    return(retval);
 }
@@ -787,7 +789,7 @@ static int InsertSC(PDB  *insert,
          strcmp(p->atnam, "O   ") &&
          strcmp(p->atnam, "CB  "))
       {
-         ALLOCNEXT(start, PDB);
+         ALLOCNEXTPDB(start);
          if(start == NULL) return(1);
          blCopyPDB(start, p);
       }
@@ -795,7 +797,7 @@ static int InsertSC(PDB  *insert,
       /* Insert the CB if required                                      */
       if(doCB && !strcmp(p->atnam,"CB  "))
       {
-         ALLOCNEXT(start, PDB);
+         ALLOCNEXTPDB(start);
          if(start == NULL) return(1);
          blCopyPDB(start, p);
       }
@@ -870,12 +872,12 @@ static int Replace(PDB  *ResStart,
          
          if(parent_mc == NULL)               /* Initialise start of list*/
          {
-            INIT(parent_mc,PDB);
+            INITPDB(parent_mc);
             q = parent_mc;
          }
          else                                /* Next item in list       */
          {
-            ALLOCNEXT(q,PDB);
+            ALLOCNEXTPDB(q);
          }
          
          /* Check allocation                                            */
@@ -912,12 +914,12 @@ static int Replace(PDB  *ResStart,
          
          if(ref_mc == NULL)                  /* Initialise start of list*/
          {
-            INIT(ref_mc,PDB);
+            INITPDB(ref_mc);
             q = ref_mc;
          }
          else                                /* Next item in list       */
          {
-            ALLOCNEXT(q,PDB);
+            ALLOCNEXTPDB(q);
          }
          
          /* Check allocation                                            */
@@ -976,9 +978,9 @@ static int Replace(PDB  *ResStart,
                                ResStart->insert,ResStart->chain);
    
 Cleanup:
-   if(reference != NULL)   FREELIST(reference, PDB);
-   if(ref_mc    != NULL)   FREELIST(ref_mc,    PDB);
-   if(parent_mc != NULL)   FREELIST(parent_mc, PDB);
+   if(reference != NULL)   FREEPDBLIST(reference);
+   if(ref_mc    != NULL)   FREEPDBLIST(ref_mc);
+   if(parent_mc != NULL)   FREEPDBLIST(parent_mc);
 
    return(retval);
 }
@@ -1031,18 +1033,18 @@ static PDB *ReadRefCoords(FILE *fp,
       {
          if(pdb == NULL)                     /* Initialise PDB list     */
          {
-            INIT(pdb, PDB);
+            INITPDB(pdb);
             p = pdb;
          }
          else                                /* Allocate next record    */
          {
-            ALLOCNEXT(p, PDB);
+            ALLOCNEXTPDB(p);
          }
          
          /* Check allocation                                            */
          if(p==NULL)
          {
-            if(pdb!=NULL) FREELIST(pdb,PDB);
+            if(pdb!=NULL) FREEPDBLIST(pdb);
             return(NULL);
          }
          
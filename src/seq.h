@@ -3,8 +3,8 @@
 
    \file       seq.h
    
-   \version    V2.14
-   \date       26.08.14
+   \version    V2.20
+   \date       16.10.26
    \brief      Header file for sequence handling
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1991-2014
@@ -66,6 +66,13 @@
 -  V2.13 14.08.14 Moved deprecated function prototypes to deprecated.h 
                   By: CTP
 -  V2.14 26.08.14 Added blSetMDMScoreWeight()
+-  V2.15 16.10.26 Added blAffinealignLinear()
+-  V2.16 16.10.26 Added ALIGNPROFILE and query profile alignment
+-  V2.17 16.10.26 Added ALIGNCONTEXT
+-  V2.18 16.10.26 Added residue index to ALIGNCONTEXT
+-  V2.19 16.10.26 Added blAffinealignBanded()
+-  V2.20 16.10.26 ALIGNCONTEXT keeps a warning count for each of the
+                  routines that gave warnings, as the static counts did
 
 *************************************************************************/
 #ifndef _SEQ_H
@@ -97,6 +104,49 @@ typedef struct
         source[160];
 }  SEQINFO;
 
+/* Alignment context: a mutation data matrix, gap penalties and work
+   space reused between alignments
+*/
+#define ALIGN_WARN_SCORE   0 /* nwarn[] for blCalcMDMScoreCtx()          */
+#define ALIGN_WARN_SCOREUC 1 /* nwarn[] for blCalcMDMScoreUCCtx()        */
+#define ALIGN_WARN_WEIGHT  2 /* nwarn[] for blSetMDMScoreWeightCtx()     */
+#define ALIGN_WARN_NUMERIC 3 /* nwarn[] for blNumericCalcMDMScoreCtx()   */
+#define ALIGN_NWARN        4
+
+typedef struct
+{
+   int  **score,            /* Mutation data matrix                     */
+        **matrix,           /* Work space: N&W score matrix             */
+        size,               /* Residue types in the matrix              */
+        penalty,            /* Gap insertion penalty                    */
+        penext,             /* Gap extension penalty                    */
+        nwarn[ALIGN_NWARN], /* Warnings given for unknown residues by
+                               each routine (ALIGN_WARN_*)              */
+        workDim,            /* Dimension of the work space              */
+        index[256];         /* MDM row for each residue character or -1 */
+   char *residues,          /* Residue types (not NUL terminated)       */
+        **dirn;             /* Work space: N&W path matrix              */
+}  ALIGNCONTEXT;
+
+/* Query profile for aligning one sequence against many. The scores are
+   for the query reversed: score[row[res]*length + length-1-i] is the 
+   score of query position i against residue res
+*/
+typedef struct
+{
+   char  *seq,              /* Query sequence (not copied)              */
+         *stripedMem;       /* Allocated memory for striped             */
+   int   *score,            /* Profile scores                           */
+         row[256],          /* Profile row for each residue             */
+         length,            /* Query length                             */
+         nrows,             /* Rows in the profile                      */
+         segLen,            /* Vectors per column in striped            */
+         maxScore;          /* Largest absolute score                   */
+   short *striped;          /* 16-bit striped profile or NULL           */
+   BOOL  identity,
+         upcase;
+}  ALIGNPROFILE;
+
 extern BOOL gBioplibSeqNucleicAcid;
 
 #define blPDB2Seq(x)         blDoPDB2Seq((x), FALSE, FALSE, FALSE)
@@ -130,6 +180,14 @@ int blAffinealignuc(char *seq1, int  length1, char *seq2, int  length2,
                     BOOL verbose, BOOL identity, int  penalty, int penext,
                     char *align1, char *align2, int  *align_len);
 int blCalcMDMScoreUC(char resa, char resb);
+int blAffinealignLinear(char *seq1, int length1, char *seq2, int length2, 
+                        BOOL identity, BOOL upcase, int penalty, 
+                        int penext, char *align1, char *align2, 
+                        int *align_len);
+int blAffinealignBanded(char *seq1, int length1, char *seq2, int length2, 
+                        BOOL identity, BOOL upcase, int penalty, 
+                        int penext, int band, char *align1, char *align2,
+                        int *align_len);
 BOOL blReadMDM(char *mdmfile);
 int blZeroMDM(void);
 char blDNAtoAA(char *dna);
@@ -142,6 +200,49 @@ int blNumericAffineAlign(int *seq1, int length1, int *seq2, int length2,
                          int penext, int *align1, int *align2, 
                          int *align_len);
 void blSetMDMScoreWeight(char resa, char resb, REAL weight);
+char *blGetMDMResidues(int *nres);
+ALIGNCONTEXT *blCreateAlignContext(int penalty, int penext);
+void blFreeAlignContext(ALIGNCONTEXT *ctx);
+BOOL blReadMDMCtx(ALIGNCONTEXT *ctx, char *mdmfile);
+int blCalcMDMScoreCtx(ALIGNCONTEXT *ctx, char resa, char resb);
+int blCalcMDMScoreUCCtx(ALIGNCONTEXT *ctx, char resa, char resb);
+int blZeroMDMCtx(ALIGNCONTEXT *ctx);
+void blSetMDMScoreWeightCtx(ALIGNCONTEXT *ctx, char resa, char resb, 
+                            REAL weight);
+char *blGetMDMResiduesCtx(ALIGNCONTEXT *ctx, int *nres);
+int blAffinealignCtx(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                     char *seq2, int length2, BOOL verbose, 
+                     BOOL identity, char *align1, char *align2, 
+                     int *align_len);
+int blAffinealignucCtx(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                       char *seq2, int length2, BOOL verbose, 
+                       BOOL identity, char *align1, char *align2, 
+                       int *align_len);
+int blAffinealignLinearCtx(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                           char *seq2, int length2, BOOL identity, 
+                           BOOL upcase, char *align1, char *align2, 
+                           int *align_len);
+int blAffinealignBandedCtx(ALIGNCONTEXT *ctx, char *seq1, int length1, 
+                           char *seq2, int length2, BOOL identity, 
+                           BOOL upcase, int band, char *align1, 
+                           char *align2, int *align_len);
+BOOL blNumericReadMDMCtx(ALIGNCONTEXT *ctx, char *mdmfile);
+int blNumericCalcMDMScoreCtx(ALIGNCONTEXT *ctx, int resa, int resb);
+int blNumericAffineAlignCtx(ALIGNCONTEXT *ctx, int *seq1, int length1, 
+                            int *seq2, int length2, BOOL verbose, 
+                            BOOL identity, int *align1, int *align2, 
+                            int *align_len);
+ALIGNPROFILE *blBuildAlignProfileCtx(ALIGNCONTEXT *ctx, char *seq, 
+                                     int length, BOOL identity, 
+                                     BOOL upcase);
+ALIGNPROFILE *blBuildAlignProfile(char *seq, int length, BOOL identity,
+                                  BOOL upcase);
+void blFreeAlignProfile(ALIGNPROFILE *profile);
+int blAffinealignScore(ALIGNPROFILE *profile, char *seq2, int length2, 
+                       int penalty, int penext);
+int blAffinealignProfile(ALIGNPROFILE *profile, char *seq2, int length2, 
+                         int penalty, int penext, char *align1, 
+                         char *align2, int *align_len);
 
 
 /************************************************************************/
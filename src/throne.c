@@ -3,7 +3,7 @@
 
    \file       throne.c
    
-   \version    V1.9
+   \version    V1.10
    \date       07.07.14
    \brief      Convert between 1 and 3 letter aa codes
    
@@ -69,6 +69,8 @@
                   table. By: CTP
                   PYL translates to O, SEC translates to U.
 -  V1.9  07.07.14 Use bl prefix for functions By: CTP
+-  V1.10 16.10.26 blThrone() and blThronex() use the residue codes from
+                  PDBCodes.c
 
 *************************************************************************/
 /* Doxygen
@@ -91,6 +93,7 @@
 */
 #include <string.h>
 #include "SysDefs.h"
+#include "pdb.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -106,6 +109,9 @@
    Also, nucleic acids must come *after* amino acids.
 */
 /* Don't forget to fix NUMAAKNOWN if adding to this table!              */
+/* The residue codes in PDBCodes.c follow the same order, so code-1 
+   indexes these tables
+*/
 static char sTab1[]    = {'A','C','D','E','F',
                           'G','H','I','K','L',
                           'M','N','P','Q','R',
@@ -149,10 +155,12 @@ BOOL gBioplibSeqNucleicAcid = FALSE;
 -  11.03.94 Modified to handle ASX and GLX in the tables
 -  25.07.95 Added handling of gBioplibSeqNucleicAcid
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Looks up the residue code rather than searching the table
+            By: ACRM
 */
 char blThrone(char *three)
 {
-   int j;
+   int code;
 
    if(three[0] == ' ' && three[1] == ' ')
       gBioplibSeqNucleicAcid = TRUE;
@@ -162,8 +170,9 @@ char blThrone(char *three)
    if(three[2] == 'X')
       return('X');
 
-   for(j=0;j<NUMAAKNOWN;j++)
-      if(!strncmp(sTab3[j],three,3)) return(sTab1[j]);
+   code = blGetResCode(three);
+   if((code > 0) && (code <= NUMAAKNOWN))
+      return(sTab1[code-1]);
 
    /* Only get here if the three letter code was not found              */
    return('X');
@@ -184,18 +193,21 @@ char blThrone(char *three)
 -  29.09.92 Original    By: ACRM
 -  25.07.95 Added handling of gBioplibSeqNucleicAcid
 -  07.07.14 Use bl prefix for functions By: CTP
+-  16.10.26 Looks up the residue code rather than searching the table
+            By: ACRM
 */
 char blThronex(char *three)
 {
-   int j;
+   int code;
 
    if(three[0] == ' ' && three[1] == ' ')
       gBioplibSeqNucleicAcid = TRUE;
    else
       gBioplibSeqNucleicAcid = FALSE;
 
-   for(j=0;j<NUMAAKNOWN;j++)
-      if(!strncmp(sTab3[j],three,3)) return(sTab1[j]);
+   code = blGetResCode(three);
+   if((code > 0) && (code <= NUMAAKNOWN))
+      return(sTab1[code-1]);
 
    /* Only get here if the three letter code was not found              */
    return('X');